@@ -30,11 +30,46 @@ extern "C" {
   
 struct SQLFunctionCtx;
 
+// the maximum number of pages of one vnode that are queued for the streaming merge
+#define MAX_NUM_OF_STREAM_PAGES 4
+
+/*
+ * Results retrieved from one vnode. Each page is sorted once it is full, and the consecutive pages that keep the
+ * order are chained into one sorted run, so each run rather than each page becomes an input of the loser tree.
+ * Pages are kept in memory until the share of this vnode in the memory budget of query (queryBufferSize) is
+ * used up, and then all of them are moved into the disk-based buffer.
+ *
+ * If the results of vnode are ordered as a whole, the pages are consumed by the merge as they arrive (stream).
+ * pPageList is a queue of at most maxPages pages then, and the fetch from vnode is paused once it is full.
+ */
+typedef struct SLocalDataBuf {
+  tExtMemBuffer * pExtMemBuffer;  // disk-based buffer
+  tFilePage *     pCurPage;       // page that is filled by the retrieved rows
+  tFilePage *     pLastPage;      // copy of the last sorted page, used after data are moved to disk or in stream
+  SArray *        pPageList;      // sorted pages in memory, tFilePage*
+  SArray *        pRunList;       // index of the first page of each sorted run in pPageList, int32_t
+  int64_t         numOfElems;
+  int64_t         maxInMemSize;
+  bool            onDisk;
+  bool            stream;         // pages are merged as they arrive
+  bool            ready;          // first page is queued or all results are retrieved, only accessed by fetch
+  bool            completed;      // no more pages will be queued
+  bool            paused;         // the fetch from vnode is paused until the queue is not full
+  bool            waiting;        // the merge is suspended until the next page is queued
+  int32_t         maxPages;
+  int32_t         code;           // error code of the retrieval, if it is completed due to failure
+  pthread_mutex_t mutex;          // guards pPageList and the states above in stream
+} SLocalDataBuf;
+
 typedef struct SLocalDataSource {
   tExtMemBuffer *pMemBuffer;
+  SLocalDataBuf *pDataBuf;       // the results of vnode that are merged as they arrive, NULL otherwise
+  tFilePage **   pMemPages;      // pages of the sorted run in memory, NULL if the run is loaded from disk
+  int32_t        numOfMemPages;
   int32_t        flushoutIdx;
   int32_t        pageId;
   int32_t        rowIdx;
+  tFilePage *    pPage;          // current page, points to filePage if the run is loaded from disk
   tFilePage      filePage;
 } SLocalDataSource;
 
@@ -62,7 +97,7 @@ typedef struct SLocalReducer {
   bool                   hasUnprocessedRow;
   tOrderDescriptor *     pDesc;
   SColumnModel *         resColModel;
-  tExtMemBuffer **       pExtMemBuffer;      // disk-based buffer
+  SLocalDataBuf **       pLocalDataBuf;      // results of each vnode
   SFillInfo*             pFillInfo;          // interpolation support structure
   char *                 pFinalRes;          // result data after interpo
   tFilePage *            discardData;
@@ -70,41 +105,64 @@ typedef struct SLocalReducer {
   bool                   discard;
   int32_t                offset;             // limit offset value
   bool                   orderPrjOnSTable;   // projection query on stable
+  bool                   starved;            // the page of winner is used up, and its next page is not loaded yet
+  bool                   suspended;          // the merge is suspended in the middle, until the next page arrives
+  struct SSubqueryState *pState;             // sub-queries that are still retrieving, only for streaming merge
 } SLocalReducer;
 
 typedef struct SSubqueryState {
   int32_t  numOfRemain;         // the number of remain unfinished subquery
   int32_t  numOfTotal;          // the number of total sub-queries
   uint64_t numOfRetrievedRows;  // total number of points in this query
+  int32_t  numOfReady;          // the number of sub-queries whose first page is ready to merge, only for stream
+  bool     merging;             // the streaming merge is started, and holds one of numOfRemain until it is freed
 } SSubqueryState;
 
 typedef struct SRetrieveSupport {
-  tExtMemBuffer **  pExtMemBuffer;     // for build loser tree
+  SLocalDataBuf **  pLocalDataBuf;     // for build loser tree
   tOrderDescriptor *pOrderDescriptor;
   SColumnModel *    pFinalColModel;    // colModel for final result
   SSubqueryState *  pState;
   int32_t           subqueryIndex;     // index of current vnode in vnode list
   SSqlObj *         pParentSqlObj;
-  tFilePage *       localBuffer;       // temp buffer, there is a buffer for each vnode to
   uint32_t          numOfRetry;        // record the number of retry times
   pthread_mutex_t   queryMutex;
 } SRetrieveSupport;
 
-int32_t tscLocalReducerEnvCreate(SSqlObj *pSql, tExtMemBuffer ***pMemBuffer, tOrderDescriptor **pDesc,
+int32_t tscLocalReducerEnvCreate(SSqlObj *pSql, SLocalDataBuf ***pDataBuf, tOrderDescriptor **pDesc,
                                  SColumnModel **pFinalModel, uint32_t nBufferSize);
 
-void tscLocalReducerEnvDestroy(tExtMemBuffer **pMemBuffer, tOrderDescriptor *pDesc, SColumnModel *pFinalModel,
+void tscLocalReducerEnvDestroy(SLocalDataBuf **pDataBuf, tOrderDescriptor *pDesc, SColumnModel *pFinalModel,
                                int32_t numOfVnodes);
 
-int32_t saveToBuffer(tExtMemBuffer *pMemoryBuf, tOrderDescriptor *pDesc, tFilePage *pPage, void *data,
-                     int32_t numOfRows, int32_t orderType);
+int32_t saveToBuffer(SLocalDataBuf *pDataBuf, tOrderDescriptor *pDesc, void *data, int32_t numOfRows,
+                     int32_t orderType);
 
-int32_t tscFlushTmpBuffer(tExtMemBuffer *pMemoryBuf, tOrderDescriptor *pDesc, tFilePage *pPage, int32_t orderType);
+int32_t tscFlushTmpBuffer(SLocalDataBuf *pDataBuf, tOrderDescriptor *pDesc, int32_t orderType);
+
+/**
+ * no more pages of the vnode will be queued for the streaming merge
+ * @param pDataBuf
+ * @param code      error code if the retrieval is failed
+ * @return          true if the merge is suspended to wait for the pages of this vnode, and needs to be resumed
+ */
+bool tscSetLocalDataBufCompleted(SLocalDataBuf *pDataBuf, int32_t code);
+
+/**
+ * discard all the results in buffer, before retrieving them from vnode again
+ * @param pDataBuf
+ */
+void tscClearLocalDataBuf(SLocalDataBuf *pDataBuf);
 
 /*
- * create local reducer to launch the second-stage reduce process at client site
+ * create local reducer to launch the second-stage reduce process at client site.
+ *
+ * If the results of each vnode are ordered as a whole, e.g., those of an interval query without group by, the
+ * reducer is created once the first page of every vnode arrives, and each vnode is one input of the loser tree that
+ * is fed by its queue of pages. Otherwise, e.g., the results of a projection query are sorted by each table only, it
+ * is created after the results of all vnodes are retrieved, and each sorted run is one input of the loser tree.
  */
-void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrderDescriptor *pDesc,
+void tscCreateLocalReducer(SLocalDataBuf **pDataBuf, int32_t numOfBuffer, tOrderDescriptor *pDesc,
                            SColumnModel *finalModel, SSqlObj* pSql);
 
 void tscDestroyLocalReducer(SSqlObj *pSql);
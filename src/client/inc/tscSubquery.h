@@ -34,10 +34,15 @@ int32_t tscHandleMasterJoinQuery(SSqlObj* pSql);
 
 int32_t tscHandleMasterSTableQuery(SSqlObj *pSql);
 
+void tscResumeRetrieveFromDnode(SSqlObj *pSql, int32_t subqueryIndex);
+
+bool tscReleaseSTableSubqueries(SSqlObj *pSql);
+
 int32_t tscHandleMultivnodeInsert(SSqlObj *pSql);
 
 void tscBuildResFromSubqueries(SSqlObj *pSql);
 void **doSetResultRowData(SSqlObj *pSql, bool finalResult);
+int32_t doSetResultBlockData(SSqlObj *pSql, TAOS_COLUMN_BIND *columns);
 
 #ifdef __cplusplus
 }
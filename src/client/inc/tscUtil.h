@@ -53,6 +53,18 @@ typedef struct SParsedDataColInfo {
   bool           hasVal[TSDB_MAX_COLUMNS];
 } SParsedDataColInfo;
 
+/*
+ * the values of one table in the insert sql. The segment is only located during parsing the sql, and the values
+ * of different tables are converted into the data blocks afterwards in parallel.
+ */
+typedef struct SDataSegment {
+  int32_t                  index;       // sequence of the segment in the sql string
+  char*                    start;       // the first row of values
+  char*                    end;         // the position next to the last row of values
+  STableDataBlocks*        pDataBlock;
+  SParsedDataColInfo*      pColInfo;    // NULL if all columns are assigned values in sequence
+} SDataSegment;
+
 typedef struct STidTags {
   int64_t  uid;
   int32_t  tid;
@@ -92,6 +104,19 @@ int32_t tscCreateDataBlock(size_t initialSize, int32_t rowSize, int32_t startOff
 void tscDestroyDataBlock(STableDataBlocks* pDataBlock);
 void tscSortRemoveDataBlockDupRows(STableDataBlocks* dataBuf);
 
+/**
+ * convert the values of segments into data blocks. The segments of different data blocks are parsed in parallel,
+ * while the segments of the same data block are parsed in sequence.
+ *
+ * @param pSched        scheduler to parse the segments in parallel, all segments are parsed by the caller if NULL
+ * @param numOfThreads  number of threads to parse the segments, including the caller
+ * @param pSegments     SArray<SDataSegment>, sorted by data block afterwards
+ * @param msg           error message of the first failed segment in the sql string
+ * @return
+ */
+int32_t tscParseDataSegments(void* pSched, int32_t numOfThreads, SArray* pSegments, char* msg);
+void*   tscDestroyDataSegments(SArray* pSegments);
+
 SParamInfo* tscAddParamToDataBlock(STableDataBlocks* pDataBlock, char type, uint8_t timePrec, short bytes,
                                    uint32_t offset);
 
@@ -217,6 +242,22 @@ void tscClearSubqueryInfo(SSqlCmd* pCmd);
 
 int  tscGetSTableVgroupInfo(SSqlObj* pSql, int32_t clauseIndex);
 int  tscGetTableMeta(SSqlObj* pSql, STableMetaInfo* pTableMetaInfo);
+
+/**
+ * same as tscGetTableMeta, but wait for the response of mnode if the table meta is not cached
+ * @param pSql
+ * @param pTableMetaInfo
+ * @return
+ */
+int32_t tscGetTableMetaSync(SSqlObj* pSql, STableMetaInfo* pTableMetaInfo);
+
+/**
+ * retrieve the metas of all child tables of a super table from mnode page by page, and put them into the local cache
+ * @param pSql
+ * @param pTableMetaInfo  the info with the full name of the super table
+ * @return
+ */
+int32_t tscLoadSTableChildrenMeta(SSqlObj* pSql, STableMetaInfo* pTableMetaInfo);
 int  tscGetMeterMetaEx(SSqlObj* pSql, STableMetaInfo* pTableMetaInfo, bool createIfNotExists);
 
 void tscResetForNextRetrieve(SSqlRes* pRes);
@@ -60,9 +60,23 @@ typedef struct STableMeta {
   SCMVgroupInfo vgroupInfo;
   int32_t       sid;       // the index of one table in a virtual node
   uint64_t      uid;       // unique id of a table
+  uint64_t      suid;      // unique id of the super table, only for child table
   SSchema       schema[];  // if the table is TSDB_CHILD_TABLE, schema is acquired by super table meta info
 } STableMeta;
 
+/*
+ * the meta of a child table prefetched along with its super table. The schema is not kept, the complete meta is built
+ * from the cached meta of the super table when the child table is accessed.
+ */
+typedef struct SChildTableMeta {
+  uint64_t uid;
+  uint64_t suid;
+  int32_t  sid;
+  int32_t  vgId;
+  int16_t  sversion;
+  int16_t  tversion;
+} SChildTableMeta;
+
 typedef struct STableMetaInfo {
   STableMeta *  pTableMeta;      // table meta, cached in client side and acquired by name
   SVgroupsInfo *vgroupList;
@@ -239,6 +253,7 @@ typedef struct {
   int32_t      batchSize;    // for parameter ('?') binding and batch processing
   int32_t      numOfParams;
   SArray      *pDataBlocks;  // SArray<STableDataBlocks*> submit data blocks after parsing sql
+  SArray      *pDataSegments;  // SArray<SDataSegment> values located but not parsed yet, NULL if parsed in place
 } SSqlCmd;
 
 typedef struct SResRec {
@@ -246,6 +261,34 @@ typedef struct SResRec {
   int numOfTotal;
 } SResRec;
 
+#define TSDB_RES_BLOCK_ROWS 4096  // rows of the block if the results are copied row by row
+
+// the buffers of the block returned by taos_fetch_block_columns
+typedef struct SResBlock {
+  int32_t          capacity;  // rows that the buffers can hold
+  int32_t          numOfCols;
+  char **          data;      // values of nchar and arithmetic columns, or all columns if copied row by row
+  unsigned long ** length;
+  char **          isNull;
+} SResBlock;
+
+// a column of the encoded result block, see qresultEncode.h
+typedef struct SResDecodeCol {
+  int32_t inputOffset;  // offset of the column head in the encoded block
+  int32_t offset;       // offset of the column in a row, the decoded column starts at data + offset * numOfRows
+  bool    decoded;
+} SResDecodeCol;
+
+// the columns of the encoded result block are decoded into pRes->data on their first access
+typedef struct SResDecoder {
+  char *        pRsp;     // the retrieve response holding the encoded block
+  char *        pOutput;  // the data of the decoded response
+  int32_t       numOfRows;
+  int32_t       numOfCols;
+  int32_t       numOfDecoded;
+  SResDecodeCol cols[];
+} SResDecoder;
+
 typedef struct {
   int64_t               numOfRows;                  // num of results in current retrieved
   int64_t               numOfTotal;                 // num of total results
@@ -270,6 +313,8 @@ typedef struct {
   char **               buffer;  // Buffer used to put multibytes encoded using unicode (wchar_t)
   SColumnIndex *        pColumnIndex;
   SArithmeticSupport*   pArithSup;   // support the arithmetic expression calculation on agg functions
+  SResBlock *           pBlock;
+  SResDecoder *         pDecoder;  // not NULL if some columns of the retrieved block are not decoded yet
   
   struct SLocalReducer *pLocalReducer;
 } SSqlRes;
@@ -366,6 +411,17 @@ void    tscRestoreSQLFuncForSTableQuery(SQueryInfo *pQueryInfo);
 
 int32_t tscCreateResPointerInfo(SSqlRes *pRes, SQueryInfo *pQueryInfo);
 void    tscDestroyResPointerInfo(SSqlRes *pRes);
+int32_t tscCreateResBlock(SSqlRes *pRes, SQueryInfo *pQueryInfo, int32_t numOfRows, bool copyAll);
+void    tscDestroyResBlock(SSqlRes *pRes);
+
+/**
+ * decode the column of the retrieved block which starts at pRes->data + offset * numOfRows, if it is not decoded yet
+ * @param pRes
+ * @param offset    offset of the column in a row, i.e., the offset of SSqlExpr
+ */
+void tscDecodeResColumn(SSqlRes *pRes, int32_t offset);
+void tscDecodeResBlock(SSqlRes *pRes);
+void tscDestroyResDecoder(SSqlRes *pRes);
 
 void tscResetSqlCmdObj(SSqlCmd *pCmd);
 
@@ -414,8 +470,14 @@ int32_t tscToSQLCmd(SSqlObj *pSql, struct SSqlInfo *pInfo);
 void    tscGetResultColumnChr(SSqlRes *pRes, SFieldInfo* pFieldInfo, int32_t column);
 
 extern void *    tscCacheHandle;
+extern void *    tscChildMetaHandle;
+extern void *    tscSTableVersions;
+extern void *    tscVgroupInfos;
+extern pthread_mutex_t tscSTableVersionMutex;
 extern void *    tscTmr;
 extern void *    tscQhandle;
+extern void *    tscMergeQhandle;
+extern void *    tscParseQhandle;
 extern int       tscKeepConn[];
 extern int       tsInsertHeadSize;
 extern int       tscNumOfThreads;
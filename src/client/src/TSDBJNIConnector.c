@@ -72,6 +72,10 @@ jmethodID g_rowdataSetStringFp;
 jmethodID g_rowdataSetTimestampFp;
 jmethodID g_rowdataSetByteArrayFp;
 
+jclass    g_blockdataClass;
+jmethodID g_blockdataResetFp;
+jmethodID g_blockdataSetColumnFp;
+
 #define JNI_SUCCESS          0
 #define JNI_TDENGINE_ERROR  -1
 #define JNI_CONNECTION_NULL -2
@@ -129,6 +133,13 @@ void jniGetGlobalMethod(JNIEnv *env) {
   g_rowdataSetByteArrayFp = (*env)->GetMethodID(env, g_rowdataClass, "setByteArray", "(I[B)V");
   (*env)->DeleteLocalRef(env, rowdataClass);
 
+  jclass blockdataClass = (*env)->FindClass(env, "com/taosdata/jdbc/TSDBResultSetBlockData");
+  g_blockdataClass = (*env)->NewGlobalRef(env, blockdataClass);
+  g_blockdataResetFp = (*env)->GetMethodID(env, g_blockdataClass, "reset", "(II)V");
+  g_blockdataSetColumnFp = (*env)->GetMethodID(env, g_blockdataClass, "setColumn",
+                                               "(ILjava/nio/ByteBuffer;ILjava/nio/ByteBuffer;Ljava/nio/ByteBuffer;)V");
+  (*env)->DeleteLocalRef(env, blockdataClass);
+
   atomic_store_32(&__init, 2);
   jniTrace("native method register finished");
 }
@@ -310,11 +321,7 @@ JNIEXPORT jint JNICALL Java_com_taosdata_jdbc_TSDBJNIConnector_getErrCodeImp(JNI
     return (jint)TSDB_CODE_TSC_INVALID_CONNECTION;
   }
 
-  if ((void *)tres == NULL) {
-    jniError("jobj:%p, conn:%p, resultset is null", jobj, tscon);
-    return JNI_RESULT_SET_NULL;
-  }
-
+  // without result set, it is the error code of the last failed call of this thread, e.g., insertBlockImp
   TAOS_RES *pSql = (TAOS_RES *)tres;
 
   return (jint)taos_errno(pSql);
@@ -535,6 +542,171 @@ JNIEXPORT jint JNICALL Java_com_taosdata_jdbc_TSDBJNIConnector_fetchRowImp(JNIEn
   return JNI_SUCCESS;
 }
 
+/*
+ * the columns of the block are exposed by direct byte buffers referring to the buffers of the result, so the values
+ * are decoded in java without being copied, until the next block is fetched
+ */
+JNIEXPORT jint JNICALL Java_com_taosdata_jdbc_TSDBJNIConnector_fetchBlockImp(JNIEnv *env, jobject jobj, jlong con,
+                                                                             jlong res, jobject blockobj) {
+  TAOS *tscon = (TAOS *)con;
+  if (tscon == NULL) {
+    jniError("jobj:%p, connection is closed", jobj);
+    return JNI_CONNECTION_NULL;
+  }
+
+  TAOS_RES *result = (TAOS_RES *)res;
+  if (result == NULL) {
+    jniError("jobj:%p, conn:%p, resultset is null", jobj, tscon);
+    return JNI_RESULT_SET_NULL;
+  }
+
+  int num_fields = taos_num_fields(result);
+  if (num_fields == 0) {
+    jniError("jobj:%p, conn:%p, resultset:%p, fields size is %d", jobj, tscon, (void *)res, num_fields);
+    return JNI_NUM_OF_FIELDS_0;
+  }
+
+  TAOS_COLUMN_BIND *columns = calloc(num_fields, sizeof(TAOS_COLUMN_BIND));
+  if (columns == NULL) {
+    jniError("jobj:%p, conn:%p, can not alloc memory", jobj, tscon);
+    return JNI_OUT_OF_MEMORY;
+  }
+
+  int numOfRows = taos_fetch_block_columns(result, columns);
+  if (numOfRows == 0) {
+    free(columns);
+
+    int tserrno = taos_errno(result);
+    if (tserrno == 0) {
+      jniTrace("jobj:%p, conn:%p, resultset:%p, fields size is %d, fetch block to the end", jobj, tscon, (void *)res,
+               num_fields);
+      return JNI_FETCH_END;
+    } else {
+      jniTrace("jobj:%p, conn:%p, interruptted query", jobj, tscon);
+      return JNI_RESULT_SET_NULL;
+    }
+  }
+
+  (*env)->CallVoidMethod(env, blockobj, g_blockdataResetFp, numOfRows, (jint)sizeof(unsigned long));
+
+  for (int i = 0; i < num_fields; i++) {
+    TAOS_COLUMN_BIND *pBind = &columns[i];
+
+    // the last binary or nchar value may be shorter than buffer_length
+    jlong   capacity = (jlong)(numOfRows - 1) * pBind->buffer_length +
+                     ((pBind->length != NULL) ? pBind->length[numOfRows - 1] : pBind->buffer_length);
+    jobject data = (*env)->NewDirectByteBuffer(env, pBind->buffer, capacity);
+    jobject isNull = (*env)->NewDirectByteBuffer(env, pBind->is_null, numOfRows);
+    jobject length = NULL;
+    if (pBind->length != NULL) {
+      length = (*env)->NewDirectByteBuffer(env, pBind->length, numOfRows * sizeof(unsigned long));
+    }
+
+    (*env)->CallVoidMethod(env, blockobj, g_blockdataSetColumnFp, i, data, (jint)pBind->buffer_length, length, isNull);
+
+    (*env)->DeleteLocalRef(env, data);
+    (*env)->DeleteLocalRef(env, isNull);
+    if (length != NULL) (*env)->DeleteLocalRef(env, length);
+  }
+
+  free(columns);
+  return numOfRows;
+}
+
+/*
+ * insert the values in direct byte buffers into one table by taos_insert_columns, the lengths of binary and nchar
+ * values are int32 values, and the null flags are bytes, both are optional. Returns the number of rows inserted, and
+ * the error code is kept in terrno for getErrCodeImp and getErrMsgImp if JNI_TDENGINE_ERROR is returned.
+ */
+JNIEXPORT jint JNICALL Java_com_taosdata_jdbc_TSDBJNIConnector_insertBlockImp(
+    JNIEnv *env, jobject jobj, jlong con, jbyteArray jtable, jint numOfRows, jintArray jtypes, jintArray jbytes,
+    jobjectArray jdata, jobjectArray jlengths, jobjectArray jnulls) {
+  TAOS *tscon = (TAOS *)con;
+  if (tscon == NULL) {
+    jniError("jobj:%p, connection is already closed", jobj);
+    return JNI_CONNECTION_NULL;
+  }
+
+  if (jtable == NULL || jtypes == NULL || jbytes == NULL || jdata == NULL) {
+    jniError("jobj:%p, conn:%p, table or columns is null", jobj, tscon);
+    return JNI_SQL_NULL;
+  }
+
+  jsize numOfCols = (*env)->GetArrayLength(env, jtypes);
+  jsize len = (*env)->GetArrayLength(env, jtable);
+
+  char *            table = calloc(1, len + 1);
+  TAOS_COLUMN_BIND *columns = calloc(numOfCols, sizeof(TAOS_COLUMN_BIND));
+  unsigned long *   lengths = calloc((size_t)numOfCols * numOfRows, sizeof(unsigned long));
+  jint *            types = (*env)->GetIntArrayElements(env, jtypes, NULL);
+  jint *            bytes = (*env)->GetIntArrayElements(env, jbytes, NULL);
+
+  jint ret = JNI_OUT_OF_MEMORY;
+  if (table == NULL || columns == NULL || lengths == NULL || types == NULL || bytes == NULL) {
+    jniError("jobj:%p, conn:%p, can not alloc memory", jobj, tscon);
+    goto _end;
+  }
+
+  (*env)->GetByteArrayRegion(env, jtable, 0, len, (jbyte *)table);
+
+  for (int i = 0; i < numOfCols; ++i) {
+    jobject data = (*env)->GetObjectArrayElement(env, jdata, i);
+    jobject length = (jlengths != NULL) ? (*env)->GetObjectArrayElement(env, jlengths, i) : NULL;
+    jobject isNull = (jnulls != NULL) ? (*env)->GetObjectArrayElement(env, jnulls, i) : NULL;
+
+    columns[i].buffer_type = types[i];
+    columns[i].buffer = (data != NULL) ? (*env)->GetDirectBufferAddress(env, data) : NULL;
+    columns[i].buffer_length = bytes[i];
+    columns[i].is_null = (isNull != NULL) ? (*env)->GetDirectBufferAddress(env, isNull) : NULL;
+
+    if (length != NULL) {
+      int32_t *pLength = (*env)->GetDirectBufferAddress(env, length);
+      columns[i].length = lengths + (size_t)i * numOfRows;
+      for (int j = 0; j < numOfRows; ++j) {
+        columns[i].length[j] = (unsigned long)pLength[j];
+      }
+    }
+
+    if (data != NULL) (*env)->DeleteLocalRef(env, data);
+    if (length != NULL) (*env)->DeleteLocalRef(env, length);
+    if (isNull != NULL) (*env)->DeleteLocalRef(env, isNull);
+
+    if (columns[i].buffer == NULL) {
+      jniError("jobj:%p, conn:%p, column:%d is not a direct buffer", jobj, tscon, i);
+      ret = JNI_SQL_NULL;
+      goto _end;
+    }
+  }
+
+  TAOS_TABLE_BIND bind = {.table_name = table, .num_of_rows = numOfRows, .columns = columns};
+  TAOS_RES *      pSql = taos_insert_columns(tscon, &bind, 1);
+  if (pSql == NULL) {
+    jniError("jobj:%p, conn:%p, table:%s, code:%s", jobj, tscon, table, tstrerror(terrno));
+    ret = JNI_TDENGINE_ERROR;
+    goto _end;
+  }
+
+  int32_t code = taos_errno(pSql);
+  if (code != TSDB_CODE_SUCCESS) {
+    jniError("jobj:%p, conn:%p, table:%s, code:%s, msg:%s", jobj, tscon, table, tstrerror(code), taos_errstr(pSql));
+    ret = JNI_TDENGINE_ERROR;
+  } else {
+    ret = taos_affected_rows(pSql);
+    jniTrace("jobj:%p, conn:%p, table:%s, affect rows:%d", jobj, tscon, table, ret);
+  }
+
+  taos_free_result(pSql);
+  terrno = code;
+
+_end:
+  if (types != NULL) (*env)->ReleaseIntArrayElements(env, jtypes, types, JNI_ABORT);
+  if (bytes != NULL) (*env)->ReleaseIntArrayElements(env, jbytes, bytes, JNI_ABORT);
+  free(lengths);
+  free(columns);
+  free(table);
+  return ret;
+}
+
 JNIEXPORT jint JNICALL Java_com_taosdata_jdbc_TSDBJNIConnector_closeConnectionImp(JNIEnv *env, jobject jobj,
                                                                                   jlong con) {
   TAOS *tscon = (TAOS *)con;
@@ -17,12 +17,13 @@
 #include "qast.h"
 #include "qextbuffer.h"
 #include "qfill.h"
-#include "qhistogram.h"
 #include "qpercentile.h"
 #include "qsyntaxtreefunction.h"
+#include "qtdigest.h"
 #include "qtsbuf.h"
 #include "taosdef.h"
 #include "taosmsg.h"
+#include "tglobal.h"
 #include "tscLog.h"
 #include "tscSubquery.h"
 #include "tscompression.h"
@@ -132,7 +133,7 @@ typedef struct SLeastsquareInfo {
 } SLeastsquareInfo;
 
 typedef struct SAPercentileInfo {
-  SHistogramInfo *pHisto;
+  STDigest *pDigest;
 } SAPercentileInfo;
 
 typedef struct STSCompInfo {
@@ -234,7 +235,7 @@ int32_t getResultDataInfo(int32_t dataType, int32_t dataBytes, int32_t functionI
       return TSDB_CODE_SUCCESS;
     } else if (functionId == TSDB_FUNC_APERCT) {
       *type = TSDB_DATA_TYPE_BINARY;
-      *bytes = sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1) + sizeof(SHistogramInfo) + sizeof(SAPercentileInfo);
+      *bytes = TDIGEST_SIZE(TDIGEST_COMPRESSION) + sizeof(SAPercentileInfo);
       *interBytes = *bytes;
       
       return TSDB_CODE_SUCCESS;
@@ -265,8 +266,7 @@ int32_t getResultDataInfo(int32_t dataType, int32_t dataBytes, int32_t functionI
   } else if (functionId == TSDB_FUNC_APERCT) {
     *type = TSDB_DATA_TYPE_DOUBLE;
     *bytes = sizeof(double);
-    *interBytes =
-        sizeof(SAPercentileInfo) + sizeof(SHistogramInfo) + sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1);
+    *interBytes = sizeof(SAPercentileInfo) + TDIGEST_SIZE(TDIGEST_COMPRESSION);
     return TSDB_CODE_SUCCESS;
   } else if (functionId == TSDB_FUNC_TWA) {
     *type = TSDB_DATA_TYPE_DOUBLE;
@@ -2447,8 +2447,10 @@ static bool percentile_function_setup(SQLFunctionCtx *pCtx) {
   // tOrderDesc object
   tOrderDescriptor *pDesc = tOrderDesCreate(&orderIdx, NUMOFCOLS, pModel, TSDB_ORDER_DESC);
   
+  // values are selected in memory until they exceed the query buffer size, then spilled into buckets
+  int64_t maxSelBufSize = tsQueryBufferSize * 1048576L;
   ((SPercentileInfo *)(pResInfo->interResultBuf))->pMemBucket =
-      tMemBucketCreate(1024, MAX_AVAILABLE_BUFFER_SIZE, pCtx->inputBytes, pCtx->inputType, pDesc);
+      tMemBucketCreate(1024, MAX_AVAILABLE_BUFFER_SIZE, maxSelBufSize, pCtx->inputBytes, pCtx->inputType, pDesc);
   
   return true;
 }
@@ -2510,11 +2512,16 @@ static void percentile_finalizer(SQLFunctionCtx *pCtx) {
 static SAPercentileInfo *getAPerctInfo(SQLFunctionCtx *pCtx) {
   SResultInfo *pResInfo = GET_RES_INFO(pCtx);
   
+  SAPercentileInfo *pInfo = NULL;
   if (pResInfo->superTableQ && pCtx->currentStage != SECONDARY_STAGE_MERGE) {
-    return (SAPercentileInfo*) pCtx->aOutputBuf;
+    pInfo = (SAPercentileInfo*) pCtx->aOutputBuf;
   } else {
-    return pResInfo->interResultBuf;
+    pInfo = pResInfo->interResultBuf;
   }
+  
+  // the result buffer may be moved, e.g., the page is evicted and loaded again
+  pInfo->pDigest = (STDigest*) ((char *)pInfo + sizeof(SAPercentileInfo));
+  return pInfo;
 }
 
 static bool apercentile_function_setup(SQLFunctionCtx *pCtx) {
@@ -2523,9 +2530,7 @@ static bool apercentile_function_setup(SQLFunctionCtx *pCtx) {
   }
   
   SAPercentileInfo *pInfo = getAPerctInfo(pCtx);
-  
-  char *tmp = (char *)pInfo + sizeof(SAPercentileInfo);
-  pInfo->pHisto = tHistogramCreateFrom(tmp, MAX_HISTOGRAM_BIN);
+  tDigestCreateFrom(pInfo->pDigest, TDIGEST_COMPRESSION);
   return true;
 }
 
@@ -2565,7 +2570,7 @@ static void apercentile_function(SQLFunctionCtx *pCtx) {
         break;
     }
     
-    tHistogramAdd(&pInfo->pHisto, v);
+    tDigestAdd(pInfo->pDigest, v);
   }
   
   if (!pCtx->hasNull) {
@@ -2610,42 +2615,29 @@ static void apercentile_function_f(SQLFunctionCtx *pCtx, int32_t index) {
       break;
   }
   
-  tHistogramAdd(&pInfo->pHisto, v);
+  tDigestAdd(pInfo->pDigest, v);
   
   SET_VAL(pCtx, 1, 1);
   pResInfo->hasResult = DATA_SET_FLAG;
 }
 
+/*
+ * The t-digest contains no pointer other than SAPercentileInfo::pDigest, so the intermediate result
+ * from vnode is merged after the pointer is fixed up.
+ */
 static void apercentile_func_merge(SQLFunctionCtx *pCtx) {
   SResultInfo *pResInfo = GET_RES_INFO(pCtx);
   assert(pResInfo->superTableQ);
   
   SAPercentileInfo *pInput = (SAPercentileInfo *)GET_INPUT_CHAR(pCtx);
+  pInput->pDigest = (STDigest*) ((char *)pInput + sizeof(SAPercentileInfo));
   
-  pInput->pHisto = (SHistogramInfo*) ((char *)pInput + sizeof(SAPercentileInfo));
-  pInput->pHisto->elems = (SHistBin*) ((char *)pInput->pHisto + sizeof(SHistogramInfo));
-  
-  if (pInput->pHisto->numOfElems <= 0) {
+  if (pInput->pDigest->totalWeight <= 0) {
     return;
   }
   
-  size_t size = sizeof(SHistogramInfo) + sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1);
-  
-  SAPercentileInfo *pOutput = getAPerctInfo(pCtx);  //(SAPercentileInfo *)pCtx->aOutputBuf;
-  SHistogramInfo *  pHisto = pOutput->pHisto;
-  
-  if (pHisto->numOfElems <= 0) {
-    memcpy(pHisto, pInput->pHisto, size);
-    pHisto->elems = (SHistBin*) ((char *)pHisto + sizeof(SHistogramInfo));
-  } else {
-    pHisto->elems = (SHistBin*) ((char *)pHisto + sizeof(SHistogramInfo));
-    
-    SHistogramInfo *pRes = tHistogramMerge(pHisto, pInput->pHisto, MAX_HISTOGRAM_BIN);
-    memcpy(pHisto, pRes, sizeof(SHistogramInfo) + sizeof(SHistBin) * MAX_HISTOGRAM_BIN);
-    pHisto->elems = (SHistBin*) ((char *)pHisto + sizeof(SHistogramInfo));
-    
-    tHistogramDestroy(&pRes);
-  }
+  SAPercentileInfo *pOutput = getAPerctInfo(pCtx);
+  tDigestMerge(pOutput->pDigest, pInput->pDigest);
   
   SET_VAL(pCtx, 1, 1);
   pResInfo->hasResult = DATA_SET_FLAG;
@@ -2653,27 +2645,14 @@ static void apercentile_func_merge(SQLFunctionCtx *pCtx) {
 
 static void apercentile_func_second_merge(SQLFunctionCtx *pCtx) {
   SAPercentileInfo *pInput = (SAPercentileInfo *)GET_INPUT_CHAR(pCtx);
+  pInput->pDigest = (STDigest*) ((char *)pInput + sizeof(SAPercentileInfo));
   
-  pInput->pHisto = (SHistogramInfo*) ((char *)pInput + sizeof(SAPercentileInfo));
-  pInput->pHisto->elems = (SHistBin*) ((char *)pInput->pHisto + sizeof(SHistogramInfo));
-  
-  if (pInput->pHisto->numOfElems <= 0) {
+  if (pInput->pDigest->totalWeight <= 0) {
     return;
   }
   
   SAPercentileInfo *pOutput = getAPerctInfo(pCtx);
-  SHistogramInfo *  pHisto = pOutput->pHisto;
-  
-  if (pHisto->numOfElems <= 0) {
-    memcpy(pHisto, pInput->pHisto, sizeof(SHistogramInfo) + sizeof(SHistBin) * (MAX_HISTOGRAM_BIN + 1));
-    pHisto->elems = (SHistBin*) ((char *)pHisto + sizeof(SHistogramInfo));
-  } else {
-    pHisto->elems = (SHistBin*) ((char *)pHisto + sizeof(SHistogramInfo));
-    
-    SHistogramInfo *pRes = tHistogramMerge(pHisto, pInput->pHisto, MAX_HISTOGRAM_BIN);
-    tHistogramDestroy(&pOutput->pHisto);
-    pOutput->pHisto = pRes;
-  }
+  tDigestMerge(pOutput->pDigest, pInput->pDigest);
   
   SResultInfo *pResInfo = GET_RES_INFO(pCtx);
   pResInfo->hasResult = DATA_SET_FLAG;
@@ -2685,27 +2664,20 @@ static void apercentile_finalizer(SQLFunctionCtx *pCtx) {
   
   SResultInfo *     pResInfo = GET_RES_INFO(pCtx);
   SAPercentileInfo *pOutput = pResInfo->interResultBuf;
+  pOutput->pDigest = (STDigest*) ((char *)pOutput + sizeof(SAPercentileInfo));
   
   if (pCtx->currentStage == SECONDARY_STAGE_MERGE) {
     if (pResInfo->hasResult == DATA_SET_FLAG) {  // check for null
-      assert(pOutput->pHisto->numOfElems > 0);
+      assert(pOutput->pDigest->totalWeight > 0);
       
-      double  ratio[] = {v};
-      double *res = tHistogramUniform(pOutput->pHisto, ratio, 1);
-      
-      memcpy(pCtx->aOutputBuf, res, sizeof(double));
-      free(res);
+      *(double *)pCtx->aOutputBuf = tDigestQuantile(pOutput->pDigest, v);
     } else {
       setNull(pCtx->aOutputBuf, pCtx->outputType, pCtx->outputBytes);
       return;
     }
   } else {
-    if (pOutput->pHisto->numOfElems > 0) {
-      double ratio[] = {v};
-      
-      double *res = tHistogramUniform(pOutput->pHisto, ratio, 1);
-      memcpy(pCtx->aOutputBuf, res, sizeof(double));
-      free(res);
+    if (pOutput->pDigest->totalWeight > 0) {
+      *(double *)pCtx->aOutputBuf = tDigestQuantile(pOutput->pDigest, v);
     } else {  // no need to free
       setNull(pCtx->aOutputBuf, pCtx->outputType, pCtx->outputBytes);
       return;
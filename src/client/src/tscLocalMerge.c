@@ -21,6 +21,11 @@
 #include "tutil.h"
 #include "tscLog.h"
 #include "tscLocalMerge.h"
+#include "tscSubquery.h"
+#include "ttime.h"
+
+// the minimum number of rows for each partition of the parallel merge of the sorted runs in memory
+#define MIN_ROWS_OF_MERGE_PARTITION 65536
 
 typedef struct SCompareParam {
   SLocalDataSource **pLocalData;
@@ -47,11 +52,11 @@ int32_t treeComparator(const void *pLeft, const void *pRight, void *param) {
   }
 
   if (pParam->groupOrderType == TSDB_ORDER_DESC) {  // desc
-    return compare_d(pDesc, pParam->num, pLocalData[pLeftIdx]->rowIdx, pLocalData[pLeftIdx]->filePage.data,
-                     pParam->num, pLocalData[pRightIdx]->rowIdx, pLocalData[pRightIdx]->filePage.data);
+    return compare_d(pDesc, pParam->num, pLocalData[pLeftIdx]->rowIdx, pLocalData[pLeftIdx]->pPage->data,
+                     pParam->num, pLocalData[pRightIdx]->rowIdx, pLocalData[pRightIdx]->pPage->data);
   } else {
-    return compare_a(pDesc, pParam->num, pLocalData[pLeftIdx]->rowIdx, pLocalData[pLeftIdx]->filePage.data,
-                     pParam->num, pLocalData[pRightIdx]->rowIdx, pLocalData[pRightIdx]->filePage.data);
+    return compare_a(pDesc, pParam->num, pLocalData[pLeftIdx]->rowIdx, pLocalData[pLeftIdx]->pPage->data,
+                     pParam->num, pLocalData[pRightIdx]->rowIdx, pLocalData[pRightIdx]->pPage->data);
   }
 }
 
@@ -98,6 +103,8 @@ static void tscInitSqlContext(SSqlCmd *pCmd, SLocalReducer *pReducer, tOrderDesc
       pCtx->param[2].i64Key = pQueryInfo->order.order;
       pCtx->param[2].nType  = TSDB_DATA_TYPE_BIGINT;
       pCtx->param[1].i64Key = pQueryInfo->order.orderColId;
+    } else if (functionId == TSDB_FUNC_APERCT) {  // the percentile is required by the finalizer
+      tVariantAssign(&pCtx->param[0], &pExpr->param[0]);
     }
 
     SResultInfo *pResInfo = &pReducer->pResInfo[i];
@@ -152,50 +159,191 @@ static SFillColInfo* createFillColInfo(SQueryInfo* pQueryInfo) {
   return pFillCol;
 }
 
-void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrderDescriptor *pDesc,
+/*
+ * If all the sorted runs of the vnodes are in memory, they are merged into one sorted run by the worker threads, so the
+ * loser tree has only one input. The merge of the intermediate results of the same group, the interpolation and the
+ * finalization of the output still run in the caller thread.
+ */
+static void tscMergeSortedRunsInMem(SSqlObj *pSql, SLocalDataBuf **pDataBuf, int32_t numOfBuffer,
+                                    tOrderDescriptor *pDesc) {
+  SSqlCmd *pCmd = &pSql->cmd;
+
+  int32_t numOfRuns = 0;
+  int64_t numOfRows = 0;
+  for (int32_t i = 0; i < numOfBuffer; ++i) {
+    if (pDataBuf[i]->onDisk || pDataBuf[i]->pExtMemBuffer->fileMeta.flushoutData.nLength > 0) {
+      return;
+    }
+
+    numOfRuns += taosArrayGetSize(pDataBuf[i]->pRunList);
+    numOfRows += pDataBuf[i]->numOfElems;
+  }
+
+  int32_t numOfPartitions = (int32_t)MIN(tscNumOfThreads, numOfRows / MIN_ROWS_OF_MERGE_PARTITION);
+  if (tscMergeQhandle == NULL || numOfRuns < 2 || numOfPartitions < 2 || pDesc->orderInfo.numOfCols == 0) {
+    return;
+  }
+
+  SSortedRun *pRuns = calloc(numOfRuns, sizeof(SSortedRun));
+  SArray *    pPageList = taosArrayInit(numOfRows / pDataBuf[0]->pExtMemBuffer->numOfElemsPerPage + 1, POINTER_BYTES);
+  if (pRuns == NULL || pPageList == NULL) {
+    tfree(pRuns);
+    taosArrayDestroy(pPageList);
+    return;
+  }
+
+  int32_t idx = 0;
+  for (int32_t i = 0; i < numOfBuffer; ++i) {
+    size_t numOfPages = taosArrayGetSize(pDataBuf[i]->pPageList);
+    size_t num = taosArrayGetSize(pDataBuf[i]->pRunList);
+
+    for (int32_t j = 0; j < num; ++j) {
+      int32_t startPage = *(int32_t *)taosArrayGet(pDataBuf[i]->pRunList, j);
+      int32_t endPage = (j < num - 1) ? *(int32_t *)taosArrayGet(pDataBuf[i]->pRunList, j + 1) : numOfPages;
+
+      pRuns[idx].pPages = (tFilePage **)taosArrayGet(pDataBuf[i]->pPageList, startPage);
+      pRuns[idx].numOfPages = endPage - startPage;
+      idx += 1;
+    }
+  }
+
+  SQueryInfo *pQueryInfo = tscGetQueryInfoDetail(pCmd, pCmd->clauseIndex);
+  int64_t     st = taosGetTimestampUs();
+
+  int32_t code = tColDataMergeSortedRuns(tscMergeQhandle, numOfPartitions, pDesc,
+                                         pDataBuf[0]->pExtMemBuffer->numOfElemsPerPage, pRuns, numOfRuns,
+                                         pQueryInfo->groupbyExpr.orderType, pPageList);
+  tfree(pRuns);
+
+  if (code != TSDB_CODE_SUCCESS) {
+    tscError("%p failed to merge %d sorted runs in memory, code:%s, merged by loser tree instead", pSql, numOfRuns,
+             tstrerror(code));
+    taosArrayDestroy(pPageList);
+    return;
+  }
+
+  for (int32_t i = 0; i < numOfBuffer; ++i) {
+    tscClearLocalDataBuf(pDataBuf[i]);
+  }
+
+  // the merge result is kept by the first buffer as one sorted run
+  int32_t startPage = 0;
+  taosArrayDestroy(pDataBuf[0]->pPageList);
+  pDataBuf[0]->pPageList = pPageList;
+  taosArrayPush(pDataBuf[0]->pRunList, &startPage);
+  pDataBuf[0]->numOfElems = numOfRows;
+
+  tscTrace("%p %d sorted runs in memory merged by %d partitions, rows:%" PRId64 ", elapsed time:%" PRId64 " us", pSql,
+           numOfRuns, numOfPartitions, numOfRows, taosGetTimestampUs() - st);
+}
+
+/*
+ * take the next queued page of vnode for the streaming merge, and resume the paused fetch from the vnode once the
+ * queue is not full.
+ * @return TSDB_CODE_SUCCESS with *pPage set to NULL if all pages of vnode are merged, or
+ * TSDB_CODE_TSC_ACTION_IN_PROGRESS if the next page has not arrived yet. The reducer is suspended then, and it is
+ * resumed by the fetch which queues the page.
+ */
+static int32_t doTakeQueuedPage(SSqlObj *pSql, SLocalDataBuf *pDataBuf, int32_t idx, SLocalReducer *pReducer,
+                                tFilePage **pPage) {
+  int32_t code = TSDB_CODE_SUCCESS;
+  bool    resume = false;
+
+  *pPage = NULL;
+
+  pthread_mutex_lock(&pDataBuf->mutex);
+
+  if (taosArrayGetSize(pDataBuf->pPageList) > 0) {
+    *pPage = *(tFilePage **)taosArrayGet(pDataBuf->pPageList, 0);
+    taosArrayRemove(pDataBuf->pPageList, 0);
+
+    if (pDataBuf->paused && taosArrayGetSize(pDataBuf->pPageList) < pDataBuf->maxPages) {
+      pDataBuf->paused = false;
+      resume = true;
+    }
+  } else if (!pDataBuf->completed) {
+    assert(pReducer != NULL);
+
+    // the reducer must be ready before the lock is released, since it may be resumed by the fetch at once
+    pDataBuf->waiting = true;
+    pReducer->status = TSC_LOCALREDUCE_READY;
+    code = TSDB_CODE_TSC_ACTION_IN_PROGRESS;
+  } else {
+    code = pDataBuf->code;
+  }
+
+  pthread_mutex_unlock(&pDataBuf->mutex);
+
+  if (resume) {
+    tscResumeRetrieveFromDnode(pSql, idx);
+  }
+
+  return code;
+}
+
+void tscCreateLocalReducer(SLocalDataBuf **pDataBuf, int32_t numOfBuffer, tOrderDescriptor *pDesc,
                            SColumnModel *finalmodel, SSqlObj* pSql) {
   SSqlCmd* pCmd = &pSql->cmd;
   SSqlRes* pRes = &pSql->res;
   
-  if (pMemBuffer == NULL) {
-    tscLocalReducerEnvDestroy(pMemBuffer, pDesc, finalmodel, numOfBuffer);
+  if (pDataBuf == NULL) {
+    tscLocalReducerEnvDestroy(pDataBuf, pDesc, finalmodel, numOfBuffer);
   
-    tscError("%p pMemBuffer is NULL", pMemBuffer);
+    tscError("%p pDataBuf is NULL", pDataBuf);
     pRes->code = TSDB_CODE_TSC_APP_ERROR;
     return;
   }
  
+  /*
+   * in streaming merge, the sub-queries are still retrieving data into the buffers, which are released by the last
+   * sub-query if the reducer is failed to create.
+   */
+  bool stream = (numOfBuffer > 0 && pDataBuf[0]->stream);
+
   if (pDesc->pColumnModel == NULL) {
-    tscLocalReducerEnvDestroy(pMemBuffer, pDesc, finalmodel, numOfBuffer);
+    if (!stream) {
+      tscLocalReducerEnvDestroy(pDataBuf, pDesc, finalmodel, numOfBuffer);
+    }
 
     tscError("%p no local buffer or intermediate result format model", pSql);
     pRes->code = TSDB_CODE_TSC_APP_ERROR;
     return;
   }
 
+  // each vnode is an input of the loser tree in streaming merge, otherwise each sorted run in memory or on disk is
   int32_t numOfFlush = 0;
-  for (int32_t i = 0; i < numOfBuffer; ++i) {
-    int32_t len = pMemBuffer[i]->fileMeta.flushoutData.nLength;
-    if (len == 0) {
-      tscTrace("%p no data retrieved from orderOfVnode:%d", pSql, i + 1);
-      continue;
-    }
+  if (stream) {
+    numOfFlush = numOfBuffer;
+  } else {
+    tscMergeSortedRunsInMem(pSql, pDataBuf, numOfBuffer, pDesc);
 
-    numOfFlush += len;
+    for (int32_t i = 0; i < numOfBuffer; ++i) {
+      int32_t len = pDataBuf[i]->pExtMemBuffer->fileMeta.flushoutData.nLength + taosArrayGetSize(pDataBuf[i]->pRunList);
+      if (len == 0) {
+        tscTrace("%p no data retrieved from orderOfVnode:%d", pSql, i + 1);
+        continue;
+      }
+
+      numOfFlush += len;
+    }
   }
 
   if (numOfFlush == 0 || numOfBuffer == 0) {
-    tscLocalReducerEnvDestroy(pMemBuffer, pDesc, finalmodel, numOfBuffer);
+    tscLocalReducerEnvDestroy(pDataBuf, pDesc, finalmodel, numOfBuffer);
     tscTrace("%p retrieved no data", pSql);
 
     return;
   }
 
-  if (pDesc->pColumnModel->capacity >= pMemBuffer[0]->pageSize) {
+  tExtMemBuffer *pMemBuffer = pDataBuf[0]->pExtMemBuffer;
+  if (pDesc->pColumnModel->capacity >= pMemBuffer->pageSize) {
     tscError("%p Invalid value of buffer capacity %d and page size %d ", pSql, pDesc->pColumnModel->capacity,
-             pMemBuffer[0]->pageSize);
+             pMemBuffer->pageSize);
+
+    if (!stream) {
+      tscLocalReducerEnvDestroy(pDataBuf, pDesc, finalmodel, numOfBuffer);
+    }
 
-    tscLocalReducerEnvDestroy(pMemBuffer, pDesc, finalmodel, numOfBuffer);
     pRes->code = TSDB_CODE_TSC_APP_ERROR;
     return;
   }
@@ -206,12 +354,15 @@ void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrd
   if (pReducer == NULL) {
     tscError("%p failed to create local merge structure, out of memory", pSql);
 
-    tscLocalReducerEnvDestroy(pMemBuffer, pDesc, finalmodel, numOfBuffer);
+    if (!stream) {
+      tscLocalReducerEnvDestroy(pDataBuf, pDesc, finalmodel, numOfBuffer);
+    }
+
     pRes->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
     return;
   }
 
-  pReducer->pExtMemBuffer = pMemBuffer;
+  pReducer->pLocalDataBuf = pDataBuf;
   pReducer->pLocalDataSrc = (SLocalDataSource **)&pReducer[1];
   assert(pReducer->pLocalDataSrc != NULL);
 
@@ -223,10 +374,58 @@ void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrd
 
   int32_t idx = 0;
   for (int32_t i = 0; i < numOfBuffer; ++i) {
-    int32_t numOfFlushoutInFile = pMemBuffer[i]->fileMeta.flushoutData.nLength;
+    tExtMemBuffer *pExtMemBuffer = pDataBuf[i]->pExtMemBuffer;
+
+    if (stream) {
+      SLocalDataSource *ds = (SLocalDataSource *)calloc(1, sizeof(SLocalDataSource));
+      if (ds == NULL) {
+        tscError("%p failed to create merge structure", pSql);
+        pRes->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+        tfree(pReducer);
+        return;
+      }
+
+      ds->pMemBuffer = pExtMemBuffer;
+      ds->pDataBuf = pDataBuf[i];
+      ds->flushoutIdx = -1;
+      ds->pPage = &ds->filePage;
+
+      // the first page of each vnode has arrived, unless it has no results at all
+      tFilePage *pPage = NULL;
+      int32_t    code = doTakeQueuedPage(pSql, pDataBuf[i], i, NULL, &pPage);
+      if (code != TSDB_CODE_SUCCESS) {
+        tscError("%p failed to retrieve from orderOfVnode:%d, code:%s", pSql, i + 1, tstrerror(code));
+        pRes->code = code;
+        tfree(ds);
+
+        for (int32_t j = 0; j < idx; ++j) {
+          if (pReducer->pLocalDataSrc[j]->pPage != &pReducer->pLocalDataSrc[j]->filePage) {
+            tfree(pReducer->pLocalDataSrc[j]->pPage);
+          }
+
+          tfree(pReducer->pLocalDataSrc[j]);
+        }
+
+        tfree(pReducer);
+        return;
+      }
+
+      if (pPage != NULL) {
+        ds->pPage = pPage;
+      } else {
+        ds->rowIdx = -1;
+        ds->pageId = -1;
+        pReducer->numOfCompleted += 1;
+      }
+
+      pReducer->pLocalDataSrc[idx++] = ds;
+      continue;
+    }
+
+    int32_t numOfFlushoutInFile = pExtMemBuffer->fileMeta.flushoutData.nLength;
 
     for (int32_t j = 0; j < numOfFlushoutInFile; ++j) {
-      SLocalDataSource *ds = (SLocalDataSource *)malloc(sizeof(SLocalDataSource) + pMemBuffer[0]->pageSize);
+      SLocalDataSource *ds = (SLocalDataSource *)malloc(sizeof(SLocalDataSource) + pMemBuffer->pageSize);
       if (ds == NULL) {
         tscError("%p failed to create merge structure", pSql);
         pRes->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
@@ -236,14 +435,18 @@ void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrd
       
       pReducer->pLocalDataSrc[idx] = ds;
 
-      ds->pMemBuffer = pMemBuffer[i];
+      ds->pMemBuffer = pExtMemBuffer;
+      ds->pDataBuf = NULL;
+      ds->pMemPages = NULL;
+      ds->numOfMemPages = 0;
       ds->flushoutIdx = j;
       ds->filePage.num = 0;
+      ds->pPage = &ds->filePage;
       ds->pageId = 0;
       ds->rowIdx = 0;
 
       tscTrace("%p load data from disk into memory, orderOfVnode:%d, total:%d", pSql, i + 1, idx + 1);
-      tExtMemBufferLoadData(pMemBuffer[i], &(ds->filePage), j, 0);
+      tExtMemBufferLoadData(pExtMemBuffer, &(ds->filePage), j, 0);
 #ifdef _DEBUG_VIEW
       printf("load data page into mem for build loser tree: %" PRIu64 " rows\n", ds->filePage.num);
       SSrcColumnInfo colInfo[256] = {0};
@@ -252,7 +455,7 @@ void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrd
       tscGetSrcColumnInfo(colInfo, pQueryInfo);
 
       tColModelDisplayEx(pDesc->pColumnModel, ds->filePage.data, ds->filePage.num,
-                         pMemBuffer[0]->numOfElemsPerPage, colInfo);
+                         pMemBuffer->numOfElemsPerPage, colInfo);
 #endif
       
       if (ds->filePage.num == 0) {  // no data in this flush, the index does not increase
@@ -263,6 +466,42 @@ void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrd
       
       idx += 1;
     }
+
+    // the sorted runs in memory are merged without copying any page
+    size_t numOfPages = taosArrayGetSize(pDataBuf[i]->pPageList);
+    size_t numOfRuns = taosArrayGetSize(pDataBuf[i]->pRunList);
+
+    for (int32_t j = 0; j < numOfRuns; ++j) {
+      int32_t startPage = *(int32_t *)taosArrayGet(pDataBuf[i]->pRunList, j);
+      int32_t endPage = (j < numOfRuns - 1) ? *(int32_t *)taosArrayGet(pDataBuf[i]->pRunList, j + 1) : numOfPages;
+
+      SLocalDataSource *ds = (SLocalDataSource *)malloc(sizeof(SLocalDataSource));
+      if (ds == NULL) {
+        tscError("%p failed to create merge structure", pSql);
+        pRes->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+        tfree(pReducer);
+        return;
+      }
+
+      ds->pMemBuffer = pExtMemBuffer;
+      ds->pDataBuf = NULL;
+      ds->pMemPages = (tFilePage **)taosArrayGet(pDataBuf[i]->pPageList, startPage);
+      ds->numOfMemPages = endPage - startPage;
+      ds->flushoutIdx = -1;
+      ds->pPage = ds->pMemPages[0];
+      ds->pageId = 0;
+      ds->rowIdx = 0;
+
+      if (ds->pPage->num == 0) {
+        tfree(ds);
+        continue;
+      }
+
+      pReducer->pLocalDataSrc[idx++] = ds;
+    }
+
+    tscTrace("%p orderOfVnode:%d, %d sorted runs in memory, %d sorted runs on disk, rows:%" PRId64, pSql, i + 1,
+             (int32_t)numOfRuns, numOfFlushoutInFile, pDataBuf[i]->numOfElems);
   }
   
   // no data actually, no need to merge result.
@@ -271,6 +510,17 @@ void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrd
     return;
   }
 
+  // the buffers are released by the last sub-query in streaming merge
+  if (stream && pReducer->numOfCompleted == numOfBuffer) {
+    for (int32_t i = 0; i < numOfBuffer; ++i) {
+      tfree(pReducer->pLocalDataSrc[i]);
+    }
+
+    tfree(pReducer);
+    tscTrace("%p retrieved no data", pSql);
+    return;
+  }
+
   pReducer->numOfBuffer = idx;
 
   SCompareParam *param = malloc(sizeof(SCompareParam));
@@ -291,12 +541,12 @@ void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrd
   // the input data format follows the old format, but output in a new format.
   // so, all the input must be parsed as old format
   pReducer->pCtx = (SQLFunctionCtx *)calloc(tscSqlExprNumOfExprs(pQueryInfo), sizeof(SQLFunctionCtx));
-  pReducer->rowSize = pMemBuffer[0]->nElemSize;
+  pReducer->rowSize = pMemBuffer->nElemSize;
 
   tscRestoreSQLFuncForSTableQuery(pQueryInfo);
   tscFieldInfoUpdateOffset(pQueryInfo);
 
-  if (pReducer->rowSize > pMemBuffer[0]->pageSize) {
+  if (pReducer->rowSize > pMemBuffer->pageSize) {
     assert(false);  // todo fixed row size is larger than the minimum page size;
   }
 
@@ -310,7 +560,7 @@ void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrd
   pReducer->discardData = (tFilePage *)calloc(1, pReducer->rowSize + sizeof(tFilePage));
   pReducer->discard = false;
 
-  pReducer->nResultBufSize = pMemBuffer[0]->pageSize * 16;
+  pReducer->nResultBufSize = pMemBuffer->pageSize * 16;
   pReducer->pResultBuf = (tFilePage *)calloc(1, pReducer->nResultBufSize + sizeof(tFilePage));
 
   pReducer->finalRowSize = tscGetResRowLength(pQueryInfo->exprList);
@@ -384,94 +634,312 @@ void tscCreateLocalReducer(tExtMemBuffer **pMemBuffer, int32_t numOfBuffer, tOrd
   }
 }
 
-static int32_t tscFlushTmpBufferImpl(tExtMemBuffer *pMemoryBuf, tOrderDescriptor *pDesc, tFilePage *pPage,
-                                     int32_t orderType) {
-  if (pPage->num == 0) {
-    return 0;
+static int32_t tscWritePageToDisk(SLocalDataBuf *pDataBuf, tOrderDescriptor *pDesc, tFilePage *pPage,
+                                  bool newRun) {
+  if (tsTotalTmpDirGB != 0 && tsAvailTmpDirGB < tsMinimalTmpDirGB) {
+    tscError("client disk space remain %.3f GB, need at least %.3f GB, stop query", tsAvailTmpDirGB,
+             tsMinimalTmpDirGB);
+    return TSDB_CODE_TSC_NO_DISKSPACE;
   }
 
-  assert(pPage->num <= pDesc->pColumnModel->capacity);
+  // the data must be consecutively put on tFilePage before written to the disk-based buffer
+  int32_t capacity = pDataBuf->pExtMemBuffer->numOfElemsPerPage;
+  tColModelCompact(pDesc->pColumnModel, pPage, capacity);
 
-  // sort before flush to disk, the data must be consecutively put on tFilePage.
-  if (pDesc->orderInfo.numOfCols > 0) {
-    tColDataQSort(pDesc, pPage->num, 0, pPage->num - 1, pPage->data, orderType);
+  if (tExtMemBufferPut(pDataBuf->pExtMemBuffer, pPage->data, pPage->num) < 0) {
+    tscError("failed to save data in temporary buffer");
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
   }
 
-#ifdef _DEBUG_VIEW
-  printf("%" PRIu64 " rows data flushed to disk after been sorted:\n", pPage->num);
-  tColModelDisplay(pDesc->pColumnModel, pPage->data, pPage->num, pPage->num);
-#endif
+  int32_t ret = tExtMemBufferFlush(pDataBuf->pExtMemBuffer);
+  if (ret != TSDB_CODE_SUCCESS) {
+    return ret;
+  }
 
-  // write to cache after being sorted
-  if (tExtMemBufferPut(pMemoryBuf, pPage->data, pPage->num) < 0) {
-    tscError("failed to save data in temporary buffer");
-    return -1;
+  if (!newRun) {
+    tExtMemBufferMergeLastFlushout(pDataBuf->pExtMemBuffer);
   }
 
-  pPage->num = 0;
-  return 0;
+  return TSDB_CODE_SUCCESS;
 }
 
-int32_t tscFlushTmpBuffer(tExtMemBuffer *pMemoryBuf, tOrderDescriptor *pDesc, tFilePage *pPage, int32_t orderType) {
-  int32_t ret = 0;
-  if ((ret = tscFlushTmpBufferImpl(pMemoryBuf, pDesc, pPage, orderType)) != 0) {
-    return ret;
+/*
+ * the memory budget is used up, move all sorted pages in memory to the disk-based buffer, and keep the run
+ * boundaries unchanged.
+ */
+static int32_t tscMoveDataBufToDisk(SLocalDataBuf *pDataBuf, tOrderDescriptor *pDesc) {
+  size_t numOfPages = taosArrayGetSize(pDataBuf->pPageList);
+  size_t numOfRuns = taosArrayGetSize(pDataBuf->pRunList);
+
+  tscTrace("move %d sorted pages in %d runs to disk", (int32_t)numOfPages, (int32_t)numOfRuns);
+
+  pDataBuf->pLastPage = calloc(1, pDataBuf->pExtMemBuffer->pageSize);
+  if (pDataBuf->pLastPage == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
   }
 
-  if ((ret = tExtMemBufferFlush(pMemoryBuf)) != 0) {
-    return ret;
+  int32_t run = 0;
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    tFilePage *pPage = *(tFilePage **)taosArrayGet(pDataBuf->pPageList, i);
+
+    bool newRun = (run < numOfRuns && *(int32_t *)taosArrayGet(pDataBuf->pRunList, run) == i);
+    if (newRun) {
+      run += 1;
+    }
+
+    // all pages in memory are full, so the last one is still available to check the order of next page
+    if (i == numOfPages - 1) {
+      memcpy(pDataBuf->pLastPage, pPage, pDataBuf->pExtMemBuffer->pageSize);
+    }
+
+    int32_t ret = tscWritePageToDisk(pDataBuf, pDesc, pPage, newRun);
+    if (ret != TSDB_CODE_SUCCESS) {
+      return ret;
+    }
   }
 
-  return 0;
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    tFilePage *pPage = *(tFilePage **)taosArrayGet(pDataBuf->pPageList, i);
+    tfree(pPage);
+  }
+
+  taosArrayClear(pDataBuf->pPageList);
+  taosArrayClear(pDataBuf->pRunList);
+
+  pDataBuf->onDisk = true;
+  return TSDB_CODE_SUCCESS;
 }
 
-int32_t saveToBuffer(tExtMemBuffer *pMemoryBuf, tOrderDescriptor *pDesc, tFilePage *pPage, void *data,
-                     int32_t numOfRows, int32_t orderType) {
-  SColumnModel *pModel = pDesc->pColumnModel;
+static bool isPageInOrder(SLocalDataBuf *pDataBuf, tOrderDescriptor *pDesc, tFilePage *pPage, int32_t orderType) {
+  tFilePage *pPrev = NULL;
+  if (pDataBuf->onDisk || pDataBuf->stream) {
+    pPrev = pDataBuf->pLastPage;
+  } else if (taosArrayGetSize(pDataBuf->pPageList) > 0) {
+    pPrev = *(tFilePage **)taosArrayGet(pDataBuf->pPageList, taosArrayGetSize(pDataBuf->pPageList) - 1);
+  }
+
+  if (pPrev == NULL || pPrev->num == 0) {
+    return false;
+  }
+
+  int32_t capacity = pDataBuf->pExtMemBuffer->numOfElemsPerPage;
+  if (orderType == TSDB_ORDER_DESC) {
+    return compare_d(pDesc, capacity, pPrev->num - 1, pPrev->data, capacity, 0, pPage->data) <= 0;
+  } else {
+    return compare_a(pDesc, capacity, pPrev->num - 1, pPrev->data, capacity, 0, pPage->data) <= 0;
+  }
+}
+
+/*
+ * queue the sorted page for the streaming merge. The results of vnode must be ordered as a whole, so the page must
+ * continue the order of the last one.
+ */
+static int32_t tscQueueSortedPage(SLocalDataBuf *pDataBuf, tFilePage *pPage, bool newRun) {
+  int32_t pageSize = pDataBuf->pExtMemBuffer->pageSize;
+
+  if (pDataBuf->pLastPage == NULL) {
+    pDataBuf->pLastPage = calloc(1, pageSize);
+  } else if (newRun) {
+    tscError("results of vnode are not ordered, failed to merge them as they arrive");
+    return TSDB_CODE_TSC_APP_ERROR;
+  }
+
+  tFilePage *pNewPage = calloc(1, pageSize);
+  if (pNewPage == NULL || pDataBuf->pLastPage == NULL) {
+    tfree(pNewPage);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  // keep the queued page to check the order of next page, since it is released once it is merged
+  memcpy(pDataBuf->pLastPage, pPage, pageSize);
 
-  if (pPage->num + numOfRows <= pModel->capacity) {
-    tColModelAppend(pModel, pPage, data, 0, numOfRows, numOfRows);
+  pthread_mutex_lock(&pDataBuf->mutex);
+  taosArrayPush(pDataBuf->pPageList, &pPage);
+  pthread_mutex_unlock(&pDataBuf->mutex);
+
+  pDataBuf->pCurPage = pNewPage;
+  pDataBuf->pCurPage->num = 0;
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * sort the current page, and append it to the current sorted run if it continues the order of the last page,
+ * otherwise start a new run.
+ */
+static int32_t tscFlushTmpBufferImpl(SLocalDataBuf *pDataBuf, tOrderDescriptor *pDesc, int32_t orderType) {
+  tFilePage *pPage = pDataBuf->pCurPage;
+  if (pPage->num == 0) {
     return 0;
   }
 
-  // current buffer is overflow, flush data to extensive buffer
-  int32_t numOfRemainEntries = pModel->capacity - pPage->num;
-  tColModelAppend(pModel, pPage, data, 0, numOfRemainEntries, numOfRows);
+  // the capacity of pDesc->pColumnModel is changed by the streaming merge, so that of buffer is used
+  int32_t capacity = pDataBuf->pExtMemBuffer->numOfElemsPerPage;
+  assert(pPage->num <= capacity && pDataBuf->pExtMemBuffer->pColumnModel->capacity == capacity);
 
-  // current buffer is full, need to flushed to disk
-  assert(pPage->num == pModel->capacity);
-  int32_t code = tscFlushTmpBuffer(pMemoryBuf, pDesc, pPage, orderType);
-  if (code != 0) {
-    return code;
+  // the page is sorted in place with the stride of full page, so it is the input of loser tree without copy
+  if (pDesc->orderInfo.numOfCols > 0) {
+    tColDataQSort(pDesc, capacity, 0, pPage->num - 1, pPage->data, orderType);
   }
 
-  int32_t remain = numOfRows - numOfRemainEntries;
+#ifdef _DEBUG_VIEW
+  printf("%" PRIu64 " rows data flushed after been sorted:\n", pPage->num);
+  tColModelDisplay(pDesc->pColumnModel, pPage->data, pPage->num, capacity);
+#endif
 
-  while (remain > 0) {
-    int32_t numOfWriteElems = 0;
-    if (remain > pModel->capacity) {
-      numOfWriteElems = pModel->capacity;
-    } else {
-      numOfWriteElems = remain;
+  bool newRun = !isPageInOrder(pDataBuf, pDesc, pPage, orderType);
+  if (pDataBuf->stream) {
+    return tscQueueSortedPage(pDataBuf, pPage, newRun);
+  }
+
+  int32_t pageSize = pDataBuf->pExtMemBuffer->pageSize;
+
+  if (!pDataBuf->onDisk && (taosArrayGetSize(pDataBuf->pPageList) + 1) * pageSize > pDataBuf->maxInMemSize) {
+    int32_t ret = tscMoveDataBufToDisk(pDataBuf, pDesc);
+    if (ret != TSDB_CODE_SUCCESS) {
+      return ret;
+    }
+  }
+
+  if (pDataBuf->onDisk) {
+    int32_t ret = tscWritePageToDisk(pDataBuf, pDesc, pPage, newRun);
+    if (ret != TSDB_CODE_SUCCESS) {
+      return ret;
     }
 
-    tColModelAppend(pModel, pPage, data, numOfRows - remain, numOfWriteElems, numOfRows);
+    // keep the written page to check the order of next page
+    pDataBuf->pCurPage = pDataBuf->pLastPage;
+    pDataBuf->pLastPage = pPage;
+  } else {
+    tFilePage *pNewPage = calloc(1, pageSize);
+    if (pNewPage == NULL) {
+      return TSDB_CODE_TSC_OUT_OF_MEMORY;
+    }
+
+    if (newRun) {
+      int32_t startPage = (int32_t)taosArrayGetSize(pDataBuf->pPageList);
+      taosArrayPush(pDataBuf->pRunList, &startPage);
+    }
+
+    taosArrayPush(pDataBuf->pPageList, &pPage);
+    pDataBuf->pCurPage = pNewPage;
+  }
 
+  pDataBuf->pCurPage->num = 0;
+  return 0;
+}
+
+int32_t tscFlushTmpBuffer(SLocalDataBuf *pDataBuf, tOrderDescriptor *pDesc, int32_t orderType) {
+  return tscFlushTmpBufferImpl(pDataBuf, pDesc, orderType);
+}
+
+int32_t saveToBuffer(SLocalDataBuf *pDataBuf, tOrderDescriptor *pDesc, void *data, int32_t numOfRows,
+                     int32_t orderType) {
+  SColumnModel *pModel = pDataBuf->pExtMemBuffer->pColumnModel;
+  pDataBuf->numOfElems += numOfRows;
+
+  int32_t written = 0;
+  while (written < numOfRows) {
+    tFilePage *pPage = pDataBuf->pCurPage;
+
+    int32_t numOfWriteElems = MIN(pModel->capacity - pPage->num, numOfRows - written);
+    tColModelAppend(pModel, pPage, data, written, numOfWriteElems, numOfRows);
+    written += numOfWriteElems;
+
+    // current buffer is full, sort it and save it as a sorted page
     if (pPage->num == pModel->capacity) {
-      if ((code = tscFlushTmpBuffer(pMemoryBuf, pDesc, pPage, orderType)) != TSDB_CODE_SUCCESS) {
+      int32_t code = tscFlushTmpBufferImpl(pDataBuf, pDesc, orderType);
+      if (code != TSDB_CODE_SUCCESS) {
         return code;
       }
-    } else {
-      pPage->num = numOfWriteElems;
     }
+  }
 
-    remain -= numOfWriteElems;
-    numOfRemainEntries += numOfWriteElems;
+  // the rows of streaming merge are queued once they are received, instead of waiting for a full page
+  if (pDataBuf->stream) {
+    return tscFlushTmpBufferImpl(pDataBuf, pDesc, orderType);
   }
 
   return 0;
 }
 
+bool tscSetLocalDataBufCompleted(SLocalDataBuf *pDataBuf, int32_t code) {
+  pthread_mutex_lock(&pDataBuf->mutex);
+
+  pDataBuf->completed = true;
+  pDataBuf->code = code;
+
+  bool waiting = pDataBuf->waiting;
+  pDataBuf->waiting = false;
+
+  pthread_mutex_unlock(&pDataBuf->mutex);
+  return waiting;
+}
+
+void tscClearLocalDataBuf(SLocalDataBuf *pDataBuf) {
+  size_t numOfPages = taosArrayGetSize(pDataBuf->pPageList);
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    tFilePage *pPage = *(tFilePage **)taosArrayGet(pDataBuf->pPageList, i);
+    tfree(pPage);
+  }
+
+  taosArrayClear(pDataBuf->pPageList);
+  taosArrayClear(pDataBuf->pRunList);
+  tExtMemBufferClear(pDataBuf->pExtMemBuffer);
+
+  tfree(pDataBuf->pLastPage);
+  pDataBuf->pCurPage->num = 0;
+  pDataBuf->numOfElems = 0;
+  pDataBuf->onDisk = false;
+}
+
+static SLocalDataBuf *createLocalDataBuf(int32_t elemSize, SColumnModel *pModel, int64_t maxInMemSize, bool stream) {
+  SLocalDataBuf *pDataBuf = calloc(1, sizeof(SLocalDataBuf));
+  if (pDataBuf == NULL) {
+    return NULL;
+  }
+
+  pDataBuf->pExtMemBuffer = createExtMemBuffer(DEFAULT_PAGE_SIZE, elemSize, pModel);
+  pDataBuf->pExtMemBuffer->flushModel = MULTIPLE_APPEND_MODEL;
+
+  pDataBuf->pCurPage = calloc(1, DEFAULT_PAGE_SIZE);
+  pDataBuf->pPageList = taosArrayInit(4, POINTER_BYTES);
+  pDataBuf->pRunList = taosArrayInit(4, sizeof(int32_t));
+  pDataBuf->maxInMemSize = maxInMemSize;
+
+  // the pages in queue are also bounded by the share of queryBufferSize
+  pDataBuf->stream = stream;
+  pDataBuf->maxPages = (int32_t)MAX(1, MIN(MAX_NUM_OF_STREAM_PAGES, maxInMemSize / DEFAULT_PAGE_SIZE));
+  pthread_mutex_init(&pDataBuf->mutex, NULL);
+
+  if (pDataBuf->pCurPage == NULL || pDataBuf->pPageList == NULL || pDataBuf->pRunList == NULL) {
+    destoryExtMemBuffer(pDataBuf->pExtMemBuffer);
+    tfree(pDataBuf->pCurPage);
+    taosArrayDestroy(pDataBuf->pPageList);
+    taosArrayDestroy(pDataBuf->pRunList);
+    pthread_mutex_destroy(&pDataBuf->mutex);
+    tfree(pDataBuf);
+  }
+
+  return pDataBuf;
+}
+
+static void *destroyLocalDataBuf(SLocalDataBuf *pDataBuf) {
+  if (pDataBuf == NULL) {
+    return NULL;
+  }
+
+  tscClearLocalDataBuf(pDataBuf);
+
+  destoryExtMemBuffer(pDataBuf->pExtMemBuffer);
+  taosArrayDestroy(pDataBuf->pPageList);
+  taosArrayDestroy(pDataBuf->pRunList);
+  pthread_mutex_destroy(&pDataBuf->mutex);
+  tfree(pDataBuf->pCurPage);
+  tfree(pDataBuf);
+
+  return NULL;
+}
+
 void tscDestroyLocalReducer(SSqlObj *pSql) {
   if (pSql == NULL) {
     return;
@@ -533,12 +1001,21 @@ void tscDestroyLocalReducer(SSqlObj *pSql) {
     tfree(pLocalReducer->pFinalRes);
     tfree(pLocalReducer->discardData);
 
-    tscLocalReducerEnvDestroy(pLocalReducer->pExtMemBuffer, pLocalReducer->pDesc, pLocalReducer->resColModel,
+    tscLocalReducerEnvDestroy(pLocalReducer->pLocalDataBuf, pLocalReducer->pDesc, pLocalReducer->resColModel,
                               pLocalReducer->numOfVnode);
     for (int32_t i = 0; i < pLocalReducer->numOfBuffer; ++i) {
+      SLocalDataSource *pOneDataSrc = pLocalReducer->pLocalDataSrc[i];
+
+      // the page taken from the queue of vnode in streaming merge
+      if (pOneDataSrc->pDataBuf != NULL && pOneDataSrc->pPage != &pOneDataSrc->filePage) {
+        tfree(pOneDataSrc->pPage);
+      }
+
       tfree(pLocalReducer->pLocalDataSrc[i]);
     }
 
+    tfree(pLocalReducer->pState);
+
     pLocalReducer->numOfBuffer = 0;
     pLocalReducer->numOfCompleted = 0;
     free(pLocalReducer);
@@ -635,7 +1112,37 @@ bool isSameGroup(SSqlCmd *pCmd, SLocalReducer *pReducer, char *pPrev, tFilePage
   return ret == 0;
 }
 
-int32_t tscLocalReducerEnvCreate(SSqlObj *pSql, tExtMemBuffer ***pMemBuffer, tOrderDescriptor **pOrderDesc,
+/*
+ * the results of a vnode are ordered as a whole if they are not grouped by tags, and each time window has one row at
+ * most, so they can be merged as they arrive. The rows of a projection query are ordered by each table only, and
+ * top/bottom generate several rows for one time window. The time windows of a vnode in descending order are not
+ * returned in order across the blocks.
+ */
+static bool isStreamMergeQuery(SQueryInfo *pQueryInfo) {
+  if (pQueryInfo->groupbyExpr.numOfGroupCols > 0 || tscIsProjectionQueryOnSTable(pQueryInfo, 0)) {
+    return false;
+  }
+
+  if (pQueryInfo->order.order == TSDB_ORDER_DESC) {
+    return false;
+  }
+
+  if (pQueryInfo->tsBuf != NULL || TSDB_QUERY_HAS_TYPE(pQueryInfo->type, TSDB_QUERY_TYPE_JOIN_SEC_STAGE)) {
+    return false;
+  }
+
+  size_t size = tscSqlExprNumOfExprs(pQueryInfo);
+  for (int32_t i = 0; i < size; ++i) {
+    int16_t functionId = tscSqlExprGet(pQueryInfo, i)->functionId;
+    if (functionId == TSDB_FUNC_TOP || functionId == TSDB_FUNC_BOTTOM) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int32_t tscLocalReducerEnvCreate(SSqlObj *pSql, SLocalDataBuf ***pDataBuf, tOrderDescriptor **pOrderDesc,
                                  SColumnModel **pFinalModel, uint32_t nBufferSizes) {
   SSqlCmd *pCmd = &pSql->cmd;
   SSqlRes *pRes = &pSql->res;
@@ -647,8 +1154,8 @@ int32_t tscLocalReducerEnvCreate(SSqlObj *pSql, tExtMemBuffer ***pMemBuffer, tOr
   SQueryInfo *    pQueryInfo = tscGetQueryInfoDetail(pCmd, pCmd->clauseIndex);
   STableMetaInfo *pTableMetaInfo = tscGetMetaInfo(pQueryInfo, 0);
 
-  (*pMemBuffer) = (tExtMemBuffer **)malloc(POINTER_BYTES * pSql->numOfSubs);
-  if (*pMemBuffer == NULL) {
+  (*pDataBuf) = (SLocalDataBuf **)calloc(pSql->numOfSubs, POINTER_BYTES);
+  if (*pDataBuf == NULL) {
     tscError("%p failed to allocate memory", pSql);
     pRes->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
     return pRes->code;
@@ -673,17 +1180,29 @@ int32_t tscLocalReducerEnvCreate(SSqlObj *pSql, tExtMemBuffer ***pMemBuffer, tOr
     rlen += pExpr->resBytes;
   }
 
+  // the retrieved rows are sorted in pages of the disk-based buffer, which are also the input of loser tree
   int32_t capacity = 0;
   if (rlen != 0) {
-    capacity = nBufferSizes / rlen;
+    capacity = (nBufferSizes - sizeof(tFilePage)) / rlen;
   }
   
   pModel = createColumnModel(pSchema, size, capacity);
 
-  size_t numOfSubs = pTableMetaInfo->vgroupList->numOfVgroups;
+  // the memory budget is evenly shared by all vnodes
+  size_t  numOfSubs = pTableMetaInfo->vgroupList->numOfVgroups;
+  int64_t maxInMemSize = MAX(tsQueryBufferSize * 1048576L / numOfSubs, nBufferSizes);
+
+  // the results of continuous query or union are merged in the same object again, which is not kept for sub-queries
+  bool stream = (pCmd->numOfClause == 1 && pSql->pStream == NULL && isStreamMergeQuery(pQueryInfo));
+
   for (int32_t i = 0; i < numOfSubs; ++i) {
-    (*pMemBuffer)[i] = createExtMemBuffer(nBufferSizes, rlen, pModel);
-    (*pMemBuffer)[i]->flushModel = MULTIPLE_APPEND_MODEL;
+    (*pDataBuf)[i] = createLocalDataBuf(rlen, pModel, maxInMemSize, stream);
+    if ((*pDataBuf)[i] == NULL) {
+      tscError("%p failed to allocate memory", pSql);
+      pRes->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+      tfree(pSchema);
+      return pRes->code;
+    }
   }
 
   if (createOrderDescriptor(pOrderDesc, pCmd, pModel) != TSDB_CODE_SUCCESS) {
@@ -735,20 +1254,20 @@ int32_t tscLocalReducerEnvCreate(SSqlObj *pSql, tExtMemBuffer ***pMemBuffer, tOr
 }
 
 /**
- * @param pMemBuffer
+ * @param pDataBuf
  * @param pDesc
  * @param pFinalModel
  * @param numOfVnodes
  */
-void tscLocalReducerEnvDestroy(tExtMemBuffer **pMemBuffer, tOrderDescriptor *pDesc, SColumnModel *pFinalModel,
+void tscLocalReducerEnvDestroy(SLocalDataBuf **pDataBuf, tOrderDescriptor *pDesc, SColumnModel *pFinalModel,
                                int32_t numOfVnodes) {
   destroyColumnModel(pFinalModel);
   tOrderDescDestroy(pDesc);
   for (int32_t i = 0; i < numOfVnodes; ++i) {
-    pMemBuffer[i] = destoryExtMemBuffer(pMemBuffer[i]);
+    pDataBuf[i] = destroyLocalDataBuf(pDataBuf[i]);
   }
 
-  tfree(pMemBuffer);
+  tfree(pDataBuf);
 }
 
 /**
@@ -763,7 +1282,10 @@ int32_t loadNewDataFromDiskFor(SLocalReducer *pLocalReducer, SLocalDataSource *p
   pOneInterDataSrc->rowIdx = 0;
   pOneInterDataSrc->pageId += 1;
 
-  if (pOneInterDataSrc->pageId <
+  if (pOneInterDataSrc->pMemPages != NULL && pOneInterDataSrc->pageId < pOneInterDataSrc->numOfMemPages) {
+    pOneInterDataSrc->pPage = pOneInterDataSrc->pMemPages[pOneInterDataSrc->pageId];
+    *needAdjustLoserTree = true;
+  } else if (pOneInterDataSrc->pMemPages == NULL && pOneInterDataSrc->pageId <
       pOneInterDataSrc->pMemBuffer->fileMeta.flushoutData.pFlushoutInfo[pOneInterDataSrc->flushoutIdx].numOfPages) {
     tExtMemBufferLoadData(pOneInterDataSrc->pMemBuffer, &(pOneInterDataSrc->filePage), pOneInterDataSrc->flushoutIdx,
                           pOneInterDataSrc->pageId);
@@ -792,7 +1314,13 @@ void adjustLoserTreeFromNewData(SLocalReducer *pLocalReducer, SLocalDataSource *
    * since it's last record in buffer has been chosen to be processed, as the winner of loser-tree
    */
   bool needToAdjust = true;
-  if (pOneInterDataSrc->filePage.num <= pOneInterDataSrc->rowIdx) {
+  if (pOneInterDataSrc->pPage->num <= pOneInterDataSrc->rowIdx) {
+    // the next page of vnode in streaming merge is taken before next row is chosen, where the merge can be suspended
+    if (pOneInterDataSrc->pDataBuf != NULL) {
+      pLocalReducer->starved = true;
+      return;
+    }
+
     loadNewDataFromDiskFor(pLocalReducer, pOneInterDataSrc, &needToAdjust);
   }
 
@@ -1308,6 +1836,47 @@ static bool isAllSourcesCompleted(SLocalReducer *pLocalReducer) {
   return (pLocalReducer->numOfBuffer == pLocalReducer->numOfCompleted);
 }
 
+/*
+ * the page of winner in streaming merge is used up, load the next page of its vnode and adjust the loser tree.
+ * The status of reducer is set ready if it is failed or suspended.
+ */
+static int32_t loadNewDataFromQueueFor(SSqlObj *pSql, SLocalReducer *pLocalReducer) {
+  SLoserTreeInfo *  pTree = pLocalReducer->pLoserTree;
+  int32_t           idx = pTree->pNode[0].index;
+  SLocalDataSource *pOneDataSrc = pLocalReducer->pLocalDataSrc[idx];
+
+  tFilePage *pPage = NULL;
+  int32_t    code = doTakeQueuedPage(pSql, pOneDataSrc->pDataBuf, idx, pLocalReducer, &pPage);
+  if (code == TSDB_CODE_TSC_ACTION_IN_PROGRESS) {
+    tscTrace("%p merge is suspended until the next page of orderOfVnode:%d arrives", pSql, idx + 1);
+    return code;
+  } else if (code != TSDB_CODE_SUCCESS) {
+    pLocalReducer->status = TSC_LOCALREDUCE_READY;
+    return code;
+  }
+
+  if (pOneDataSrc->pPage != &pOneDataSrc->filePage) {
+    tfree(pOneDataSrc->pPage);
+  }
+
+  if (pPage != NULL) {
+    pOneDataSrc->pPage = pPage;
+    pOneDataSrc->pageId += 1;
+    pOneDataSrc->rowIdx = 0;
+  } else {
+    pLocalReducer->numOfCompleted += 1;
+
+    pOneDataSrc->pPage = &pOneDataSrc->filePage;
+    pOneDataSrc->pageId = -1;
+    pOneDataSrc->rowIdx = -1;
+  }
+
+  pLocalReducer->starved = false;
+  tLoserTreeAdjust(pTree, idx + pLocalReducer->numOfBuffer);
+
+  return TSDB_CODE_SUCCESS;
+}
+
 static bool doBuildFilledResultForGroup(SSqlObj *pSql) {
   SSqlCmd *pCmd = &pSql->cmd;
   SSqlRes *pRes = &pSql->res;
@@ -1423,25 +1992,51 @@ int32_t tscDoLocalMerge(SSqlObj *pSql) {
     return TSDB_CODE_SUCCESS;
   }
 
-  tFilePage *tmpBuffer = pLocalReducer->pTempBuffer;
+  tFilePage *    tmpBuffer = pLocalReducer->pTempBuffer;
+  SLoserTreeInfo *pTree = pLocalReducer->pLoserTree;
+  SColumnModel *  pModel = pLocalReducer->pDesc->pColumnModel;
 
-  if (doHandleLastRemainData(pSql)) {
-    pLocalReducer->status = TSC_LOCALREDUCE_READY;  // set the flag, taos_free_result can release this result.
-    return TSDB_CODE_SUCCESS;
-  }
+  // the streaming merge that is suspended in the loop below continues from where it stopped
+  if (!pLocalReducer->suspended) {
+    if (pLocalReducer->starved) {
+      int32_t code = loadNewDataFromQueueFor(pSql, pLocalReducer);
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+    }
 
-  if (doBuildFilledResultForGroup(pSql)) {
-    pLocalReducer->status = TSC_LOCALREDUCE_READY;  // set the flag, taos_free_result can release this result.
-    return TSDB_CODE_SUCCESS;
-  }
+    if (doHandleLastRemainData(pSql)) {
+      pLocalReducer->status = TSC_LOCALREDUCE_READY;  // set the flag, taos_free_result can release this result.
+      return TSDB_CODE_SUCCESS;
+    }
 
-  SLoserTreeInfo *pTree = pLocalReducer->pLoserTree;
+    if (doBuildFilledResultForGroup(pSql)) {
+      pLocalReducer->status = TSC_LOCALREDUCE_READY;  // set the flag, taos_free_result can release this result.
+      return TSDB_CODE_SUCCESS;
+    }
 
-  // clear buffer
-  handleUnprocessedRow(pCmd, pLocalReducer, tmpBuffer);
-  SColumnModel *pModel = pLocalReducer->pDesc->pColumnModel;
+    // clear buffer
+    handleUnprocessedRow(pCmd, pLocalReducer, tmpBuffer);
+  }
+
+  pLocalReducer->suspended = false;
 
   while (1) {
+    if (pLocalReducer->starved) {
+      // it must be set before the merge is suspended, since it may be resumed by the fetch at once
+      pLocalReducer->suspended = true;
+
+      int32_t code = loadNewDataFromQueueFor(pSql, pLocalReducer);
+      if (code == TSDB_CODE_TSC_ACTION_IN_PROGRESS) {
+        return code;
+      }
+
+      pLocalReducer->suspended = false;
+      if (code != TSDB_CODE_SUCCESS) {
+        return code;
+      }
+    }
+
     if (isAllSourcesCompleted(pLocalReducer)) {
       break;
     }
@@ -1454,7 +2049,7 @@ int32_t tscDoLocalMerge(SSqlObj *pSql) {
     // chosen from loser tree
     SLocalDataSource *pOneDataSrc = pLocalReducer->pLocalDataSrc[pTree->pNode[0].index];
 
-    tColModelAppend(pModel, tmpBuffer, pOneDataSrc->filePage.data, pOneDataSrc->rowIdx, 1,
+    tColModelAppend(pModel, tmpBuffer, pOneDataSrc->pPage->data, pOneDataSrc->rowIdx, 1,
                     pOneDataSrc->pMemBuffer->pColumnModel->capacity);
 
 #if defined(_DEBUG_VIEW)
@@ -29,6 +29,7 @@
 
 #include "tscLog.h"
 #include "tscSubquery.h"
+#include "tsched.h"
 #include "tstoken.h"
 #include "ttime.h"
 
@@ -39,6 +40,12 @@ enum {
   TSDB_USE_CLI_TS = 1,
 };
 
+// the values of insert sql longer than this are parsed by the workers in parallel
+#define TSDB_PARALLEL_PARSE_SQL_LEN (16 * 1024)
+
+// the rows fewer than this are sorted by qsort, instead of radix sort
+#define TSDB_RADIX_SORT_MIN_ROWS 64
+
 static int32_t tscAllocateMemIfNeed(STableDataBlocks *pDataBlock, int32_t rowSize, int32_t * numOfRows);
 
 static int32_t tscToInteger(SSQLToken *pToken, int64_t *value, char **endPtr) {
@@ -627,6 +634,90 @@ static void tsSetBlockInfo(SSubmitBlk *pBlocks, const STableMeta *pTableMeta, in
   pBlocks->numOfRows += numOfRows;
 }
 
+static bool isRowsSorted(const char *pData, int32_t numOfRows, int32_t rowSize) {
+  for (int32_t i = 1; i < numOfRows; ++i) {
+    if (*(TSKEY *)(pData + rowSize * i) < *(TSKEY *)(pData + rowSize * (i - 1))) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+typedef struct SRowKey {
+  uint64_t key;
+  int32_t  index;
+} SRowKey;
+
+/*
+ * LSD radix sort on the timestamp of rows, a byte each pass. The rows of equal timestamps keep the original order.
+ * The keys are sorted first, and then the rows are copied into a new buffer in one pass.
+ */
+static int32_t radixSortRows(STableDataBlocks *dataBuf) {
+  SSubmitBlk *pBlocks = (SSubmitBlk *)dataBuf->pData;
+  int32_t     numOfRows = pBlocks->numOfRows;
+  int32_t     rowSize = dataBuf->rowSize;
+
+  SRowKey *pKeys = malloc(sizeof(SRowKey) * numOfRows * 2);
+  char *   pData = malloc(dataBuf->nAllocSize);
+  if (pKeys == NULL || pData == NULL) {
+    tfree(pKeys);
+    tfree(pData);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  uint32_t counts[sizeof(TSKEY)][256] = {{0}};
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    // flip the sign bit, so the negative timestamps are ordered before the positive ones
+    uint64_t key = ((uint64_t)(*(TSKEY *)(pBlocks->data + rowSize * i))) ^ (1ULL << 63);
+    pKeys[i].key = key;
+    pKeys[i].index = i;
+
+    for (int32_t j = 0; j < sizeof(TSKEY); ++j) {
+      counts[j][(key >> (j * 8)) & 0xFF] += 1;
+    }
+  }
+
+  SRowKey *pSrc = pKeys;
+  SRowKey *pDst = pKeys + numOfRows;
+
+  for (int32_t j = 0; j < sizeof(TSKEY); ++j) {
+    // the byte is identical in all keys, e.g., the high bytes of timestamps within a short period
+    if (counts[j][(pSrc[0].key >> (j * 8)) & 0xFF] == numOfRows) {
+      continue;
+    }
+
+    uint32_t pos[256];
+    uint32_t offset = 0;
+    for (int32_t k = 0; k < 256; ++k) {
+      pos[k] = offset;
+      offset += counts[j][k];
+    }
+
+    for (int32_t i = 0; i < numOfRows; ++i) {
+      pDst[pos[(pSrc[i].key >> (j * 8)) & 0xFF]++] = pSrc[i];
+    }
+
+    SRowKey *p = pSrc;
+    pSrc = pDst;
+    pDst = p;
+  }
+
+  memcpy(pData, dataBuf->pData, sizeof(SSubmitBlk));
+  memset(pData + dataBuf->size, 0, dataBuf->nAllocSize - dataBuf->size);
+
+  char *pRows = pData + sizeof(SSubmitBlk);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    memcpy(pRows + rowSize * i, pBlocks->data + rowSize * pSrc[i].index, rowSize);
+  }
+
+  free(pKeys);
+  free(dataBuf->pData);
+  dataBuf->pData = pData;
+
+  return TSDB_CODE_SUCCESS;
+}
+
 // data block is disordered, sort it in ascending order
 void tscSortRemoveDataBlockDupRows(STableDataBlocks *dataBuf) {
   SSubmitBlk *pBlocks = (SSubmitBlk *)dataBuf->pData;
@@ -640,8 +731,16 @@ void tscSortRemoveDataBlockDupRows(STableDataBlocks *dataBuf) {
   }
 
   if (!dataBuf->ordered) {
+    // the duplicated timestamps mark the block as disordered during parsing, while the rows may be sorted already
+    if (!isRowsSorted(pBlocks->data, pBlocks->numOfRows, dataBuf->rowSize)) {
+      if (pBlocks->numOfRows < TSDB_RADIX_SORT_MIN_ROWS || radixSortRows(dataBuf) != TSDB_CODE_SUCCESS) {
+        qsort(pBlocks->data, pBlocks->numOfRows, dataBuf->rowSize, rowDataCompar);
+      }
+
+      pBlocks = (SSubmitBlk *)dataBuf->pData;
+    }
+
     char *pBlockData = pBlocks->data;
-    qsort(pBlockData, pBlocks->numOfRows, dataBuf->rowSize, rowDataCompar);
 
     int32_t i = 0;
     int32_t j = 1;
@@ -670,6 +769,99 @@ void tscSortRemoveDataBlockDupRows(STableDataBlocks *dataBuf) {
   }
 }
 
+/*
+ * locate the end of the values of one table without converting them. The quoted strings are skipped in the same way
+ * as the tokenizer does, since they may contain the parentheses.
+ */
+static int32_t tsSkipValues(char **str, char *error, int32_t *code) {
+  int32_t numOfRows = 0;
+
+  while (1) {
+    int32_t   index = 0;
+    SSQLToken sToken = tStrGetToken(*str, &index, false, 0, NULL);
+    if (sToken.n == 0 || sToken.type != TK_LP) break;
+
+    char *p = *str + index;
+    while (*p != 0 && *p != ')') {
+      if (*p == '\'' || *p == '"') {
+        char delim = *p;
+        for (++p; *p != 0; ++p) {
+          if (*p == '\\' && p[1] != 0) {
+            ++p;
+          } else if (*p == delim) {
+            if (p[1] != delim) break;
+            ++p;
+          }
+        }
+
+        if (*p == 0) break;
+      }
+
+      ++p;
+    }
+
+    if (*p != ')') {
+      tscInvalidSQLErrMsg(error, ") expected", *str);
+      *code = TSDB_CODE_TSC_INVALID_SQL;
+      return -1;
+    }
+
+    *str = p + 1;
+    numOfRows++;
+  }
+
+  if (numOfRows <= 0) {
+    strcpy(error, "no any data points");
+    *code = TSDB_CODE_TSC_INVALID_SQL;
+    return -1;
+  } else {
+    return numOfRows;
+  }
+}
+
+static bool isDefaultColInfo(SParsedDataColInfo *spd) {
+  if (spd->numOfAssignedCols != spd->numOfCols) {
+    return false;
+  }
+
+  for (int32_t i = 0; i < spd->numOfAssignedCols; ++i) {
+    if (spd->elems[i].colIndex != i) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static int32_t doLocateValues(SSqlCmd *pCmd, STableDataBlocks *dataBuf, char **str, SParsedDataColInfo *spd,
+                              int32_t *totalNum) {
+  SDataSegment seg = {.index = (int32_t)taosArrayGetSize(pCmd->pDataSegments), .start = *str, .pDataBlock = dataBuf};
+
+  int32_t code = TSDB_CODE_TSC_INVALID_SQL;
+  int32_t numOfRows = tsSkipValues(str, pCmd->payload, &code);
+  if (numOfRows <= 0) {
+    return code;
+  }
+
+  seg.end = *str;
+  if (!isDefaultColInfo(spd)) {
+    seg.pColInfo = malloc(sizeof(SParsedDataColInfo));
+    if (seg.pColInfo == NULL) {
+      return TSDB_CODE_TSC_OUT_OF_MEMORY;
+    }
+
+    memcpy(seg.pColInfo, spd, sizeof(SParsedDataColInfo));
+  }
+
+  if (taosArrayPush(pCmd->pDataSegments, &seg) == NULL) {
+    tfree(seg.pColInfo);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  *totalNum += numOfRows;
+  return TSDB_CODE_SUCCESS;
+}
+
 static int32_t doParseInsertStatement(SSqlObj *pSql, void *pTableList, char **str, SParsedDataColInfo *spd,
                                       int32_t *totalNum) {
   SSqlCmd *       pCmd = &pSql->cmd;
@@ -691,6 +883,15 @@ static int32_t doParseInsertStatement(SSqlObj *pSql, void *pTableList, char **st
     return TSDB_CODE_TSC_OUT_OF_MEMORY;
   }
 
+  // the values are converted into the data block along with other tables afterwards
+  if (pCmd->pDataSegments != NULL) {
+    tsSetBlockInfo((SSubmitBlk *)(dataBuf->pData), pTableMeta, 0);
+    dataBuf->vgId = pTableMeta->vgroupInfo.vgId;
+    dataBuf->numOfTables = 1;
+
+    return doLocateValues(pCmd, dataBuf, str, spd, totalNum);
+  }
+
   int32_t code = TSDB_CODE_TSC_INVALID_SQL;
   char *  tmpTokenBuf = calloc(1, 4096);  // used for deleting Escape character: \\, \', \"
   if (NULL == tmpTokenBuf) {
@@ -725,6 +926,207 @@ static int32_t doParseInsertStatement(SSqlObj *pSql, void *pTableList, char **st
   return TSDB_CODE_SUCCESS;
 }
 
+typedef struct SParseSupporter {
+  SDataSegment *pSegments;
+  int32_t       start;     // the first segment of the task
+  int32_t       end;
+  int32_t       code;
+  int32_t       errIndex;  // sequence of the failed segment in the sql string
+  char          msg[512];
+  tsem_t *      pDone;
+} SParseSupporter;
+
+static void doParseDataSegments(SParseSupporter *pSupporter) {
+  char *tmpTokenBuf = calloc(1, 4096);  // used for deleting Escape character: \\, \', \"
+  if (tmpTokenBuf == NULL) {
+    pSupporter->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+    pSupporter->errIndex = pSupporter->pSegments[pSupporter->start].index;
+    return;
+  }
+
+  char               msg[sizeof(pSupporter->msg)] = {0};
+  SParsedDataColInfo spd = {0};
+  STableMeta *       pDefaultMeta = NULL;  // the table of which all columns are assigned in spd
+  STableDataBlocks * pFailedBlock = NULL;
+
+  for (int32_t i = pSupporter->start; i < pSupporter->end; ++i) {
+    SDataSegment *    pSeg = &pSupporter->pSegments[i];
+    STableDataBlocks *pDataBlock = pSeg->pDataBlock;
+    STableMeta *      pTableMeta = pDataBlock->pTableMeta;
+
+    // the other data blocks are still parsed, since they may have an error at an earlier position in sql string
+    if (pDataBlock == pFailedBlock) {
+      continue;
+    }
+
+    SParsedDataColInfo *pColInfo = pSeg->pColInfo;
+    if (pColInfo == NULL) {
+      if (pDefaultMeta != pTableMeta) {
+        STableComInfo tinfo = tscGetTableInfo(pTableMeta);
+
+        memset(&spd, 0, sizeof(spd));
+        tscSetAssignedColumnInfo(&spd, tscGetTableSchema(pTableMeta), tinfo.numOfColumns);
+        pDefaultMeta = pTableMeta;
+      }
+
+      pColInfo = &spd;
+    }
+
+    int32_t maxNumOfRows = 0;
+    int32_t code = tscAllocateMemIfNeed(pDataBlock, pDataBlock->rowSize, &maxNumOfRows);
+
+    char *  str = pSeg->start;
+    int32_t numOfRows = 0;
+    if (code == TSDB_CODE_SUCCESS) {
+      code = TSDB_CODE_TSC_INVALID_SQL;
+      numOfRows = tsParseValues(&str, pDataBlock, pTableMeta, maxNumOfRows, pColInfo, msg, &code, tmpTokenBuf);
+    }
+
+    if (numOfRows > 0 && pDataBlock->numOfParams > 0) {
+      numOfRows = 0;
+      code = tscInvalidSQLErrMsg(msg, "parameters are only allowed in prepared statement", NULL);
+    } else if (numOfRows > 0 && str != pSeg->end) {
+      numOfRows = 0;
+      code = tscInvalidSQLErrMsg(msg, "invalid data or symbol", str);
+    }
+
+    if (numOfRows <= 0) {
+      if (pSupporter->code == TSDB_CODE_SUCCESS || pSeg->index < pSupporter->errIndex) {
+        pSupporter->code = code;
+        pSupporter->errIndex = pSeg->index;
+        strcpy(pSupporter->msg, msg);
+      }
+
+      pFailedBlock = pDataBlock;
+      continue;
+    }
+
+    tsSetBlockInfo((SSubmitBlk *)(pDataBlock->pData), pTableMeta, numOfRows);
+  }
+
+  free(tmpTokenBuf);
+}
+
+static void parseDataSegmentsTask(SSchedMsg *pMsg) {
+  SParseSupporter *pSupporter = pMsg->ahandle;
+  doParseDataSegments(pSupporter);
+  tsem_post(pSupporter->pDone);
+}
+
+static int32_t dataSegmentCompar(const void *lhs, const void *rhs) {
+  const SDataSegment *pLeft = lhs;
+  const SDataSegment *pRight = rhs;
+
+  if (pLeft->pDataBlock != pRight->pDataBlock) {
+    return ((uintptr_t)pLeft->pDataBlock < (uintptr_t)pRight->pDataBlock) ? -1 : 1;
+  }
+
+  if (pLeft->index == pRight->index) {
+    return 0;
+  }
+
+  return (pLeft->index < pRight->index) ? -1 : 1;
+}
+
+int32_t tscParseDataSegments(void *pSched, int32_t numOfThreads, SArray *pSegments, char *msg) {
+  int32_t numOfSegs = (int32_t)taosArrayGetSize(pSegments);
+  if (numOfSegs == 0) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  // the segments of the same data block are adjacent in the order of sql string
+  taosArraySort(pSegments, dataSegmentCompar);
+  SDataSegment *pSegs = taosArrayGet(pSegments, 0);
+
+  int64_t total = 0;
+  int32_t numOfBlocks = 0;
+  for (int32_t i = 0; i < numOfSegs; ++i) {
+    total += pSegs[i].end - pSegs[i].start;
+    if (i == 0 || pSegs[i].pDataBlock != pSegs[i - 1].pDataBlock) {
+      numOfBlocks += 1;
+    }
+  }
+
+  int32_t numOfTasks = (pSched == NULL) ? 1 : MIN(numOfThreads, numOfBlocks);
+  if (numOfTasks < 1) {
+    numOfTasks = 1;
+  }
+
+  SParseSupporter *pSupporters = calloc(numOfTasks, sizeof(SParseSupporter));
+  if (pSupporters == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  // the data blocks are assigned to tasks, balanced by the length of values
+  int32_t t = 0;
+  int64_t len = 0;
+  for (int32_t i = 0; i < numOfSegs; ++i) {
+    bool newBlock = (i > 0 && pSegs[i].pDataBlock != pSegs[i - 1].pDataBlock);
+    if (newBlock && t < numOfTasks - 1 && len >= total * (t + 1) / numOfTasks) {
+      pSupporters[t++].end = i;
+      pSupporters[t].start = i;
+    }
+
+    len += pSegs[i].end - pSegs[i].start;
+  }
+
+  pSupporters[t].end = numOfSegs;
+  numOfTasks = t + 1;
+
+  tsem_t done;
+  tsem_init(&done, 0, 0);
+
+  for (int32_t i = 0; i < numOfTasks; ++i) {
+    pSupporters[i].pSegments = pSegs;
+    pSupporters[i].pDone = &done;
+
+    if (i > 0) {
+      SSchedMsg schedMsg = {.fp = parseDataSegmentsTask, .ahandle = &pSupporters[i]};
+      taosScheduleTask(pSched, &schedMsg);
+    }
+  }
+
+  // the first task is executed by the caller
+  doParseDataSegments(&pSupporters[0]);
+  for (int32_t i = 1; i < numOfTasks; ++i) {
+    tsem_wait(&done);
+  }
+
+  tsem_destroy(&done);
+
+  // report the error of the first failed segment in the sql string
+  SParseSupporter *pFailed = NULL;
+  for (int32_t i = 0; i < numOfTasks; ++i) {
+    if (pSupporters[i].code != TSDB_CODE_SUCCESS && (pFailed == NULL || pSupporters[i].errIndex < pFailed->errIndex)) {
+      pFailed = &pSupporters[i];
+    }
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  if (pFailed != NULL) {
+    code = pFailed->code;
+    strcpy(msg, pFailed->msg);
+  }
+
+  free(pSupporters);
+  return code;
+}
+
+void *tscDestroyDataSegments(SArray *pSegments) {
+  if (pSegments == NULL) {
+    return NULL;
+  }
+
+  size_t size = taosArrayGetSize(pSegments);
+  for (int32_t i = 0; i < size; ++i) {
+    SDataSegment *pSeg = taosArrayGet(pSegments, i);
+    tfree(pSeg->pColInfo);
+  }
+
+  taosArrayDestroy(pSegments);
+  return NULL;
+}
+
 static int32_t tscCheckIfCreateTable(char **sqlstr, SSqlObj *pSql) {
   int32_t   index = 0;
   SSQLToken sToken = {0};
@@ -1045,6 +1447,12 @@ int tsParseInsertSql(SSqlObj *pSql) {
       code = TSDB_CODE_TSC_OUT_OF_MEMORY;
       goto _error;
     }
+
+    // for the large sql, only the tables are resolved in sequence, and the values are parsed in parallel at last
+    if (tscParseQhandle != NULL && pCmd->insertType != TSDB_QUERY_TYPE_STMT_INSERT &&
+        strlen(str) >= TSDB_PARALLEL_PARSE_SQL_LEN) {
+      pCmd->pDataSegments = taosArrayInit(64, sizeof(SDataSegment));
+    }
   } else {
     str = pCmd->curSql;
   }
@@ -1256,6 +1664,13 @@ int tsParseInsertSql(SSqlObj *pSql) {
     }
   }
 
+  if (pCmd->pDataSegments != NULL) {
+    code = tscParseDataSegments(tscParseQhandle, tscNumOfThreads + 1, pCmd->pDataSegments, pCmd->payload);
+    if (code != TSDB_CODE_SUCCESS) {
+      goto _error;
+    }
+  }
+
   // we need to keep the data blocks if there are parameters in the sql
   if (pCmd->numOfParams > 0) {
     goto _clean;
@@ -1278,6 +1693,8 @@ _error:
 _clean:
   taosHashCleanup(pCmd->pTableList);
   pCmd->pTableList = NULL;
+
+  pCmd->pDataSegments = tscDestroyDataSegments(pCmd->pDataSegments);
   
   pCmd->curSql    = NULL;
   pCmd->parseFinished  = 1;
@@ -15,8 +15,12 @@
 #include "os.h"
 
 #include "taos.h"
+#include "hash.h"
 #include "tsclient.h"
 #include "tscUtil.h"
+#include "tschemautil.h"
+#include "tcache.h"
+#include "ttime.h"
 #include "ttimer.h"
 #include "taosmsg.h"
 #include "tstrbuild.h"
@@ -47,11 +51,32 @@ typedef struct SNormalStmt {
 //
 //} SInsertStmt;
 
+/*
+ * insertion into several tables of the same schema, the target table is switched by taos_stmt_set_tbname, and the
+ * parsed row of the prepared sql is the template of all rows bound afterwards.
+ */
+typedef struct SMultiTbStmt {
+  bool              enabled;
+  bool              pending;      // the row bound by taos_stmt_bind_param is not added into the batch yet
+  char*             pTemplate;
+  int32_t           rowSize;
+  bool              allParams;    // all columns are parameters, so the template row is not copied
+  uint32_t          numOfParams;
+  SParamInfo*       params;
+  int32_t           numOfCols;
+  SSchema*          pSchema;
+  char              stableName[TSDB_TABLE_ID_LEN];  // super table in the USING clause
+  STableMetaInfo    tableMetaInfo;  // current target table
+  STableDataBlocks* pBlock;         // data block of current target table, NULL if not created yet
+  SHashObj*         pTableList;     // data blocks of all target tables, by uid
+} SMultiTbStmt;
+
 typedef struct STscStmt {
   bool isInsert;
   STscObj* taos;
   SSqlObj* pSql;
   SNormalStmt normal;
+  SMultiTbStmt mtb;
 } STscStmt;
 
 
@@ -298,7 +323,7 @@ static int doBindParam(char* data, SParamInfo* param, TAOS_BIND* bind) {
       break;
 
     case TSDB_DATA_TYPE_BINARY:
-      if ((*bind->length) > param->bytes) {
+      if ((*bind->length) > param->bytes - VARSTR_HEADER_SIZE) {
         return TSDB_CODE_TSC_INVALID_VALUE;
       }
       size = (short)*bind->length;
@@ -322,6 +347,87 @@ static int doBindParam(char* data, SParamInfo* param, TAOS_BIND* bind) {
   return TSDB_CODE_SUCCESS;
 }
 
+// write the values of one column into numOfRows rows, the value of the first row is written at start
+static int32_t doBindColumn(char* start, int32_t rowSize, int32_t type, int32_t bytes, TAOS_COLUMN_BIND* bind,
+                            int32_t numOfRows) {
+  if (bind->buffer_type != type) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  if (type == TSDB_DATA_TYPE_BINARY || type == TSDB_DATA_TYPE_NCHAR) {
+    for (int32_t i = 0; i < numOfRows; ++i) {
+      char* data = start + rowSize * i;
+      if (bind->is_null != NULL && bind->is_null[i]) {
+        setVardataNull(data, type);
+        continue;
+      }
+
+      char*  val = (char*)bind->buffer + bind->buffer_length * i;
+      size_t len = (bind->length != NULL) ? bind->length[i] : strnlen(val, bind->buffer_length);
+
+      if (type == TSDB_DATA_TYPE_BINARY) {
+        if (len > bytes - VARSTR_HEADER_SIZE) {
+          return TSDB_CODE_TSC_INVALID_VALUE;
+        }
+
+        STR_WITH_SIZE_TO_VARSTR(data, val, len);
+      } else {
+        size_t output = 0;
+        if (!taosMbsToUcs4(val, len, varDataVal(data), bytes - VARSTR_HEADER_SIZE, &output)) {
+          return TSDB_CODE_TSC_INVALID_VALUE;
+        }
+
+        varDataSetLen(data, output);
+      }
+    }
+
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t size = tDataTypeDesc[type].nSize;
+  size_t  stride = (bind->buffer_length == 0) ? size : bind->buffer_length;
+  if (stride < size) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    char* data = start + rowSize * i;
+    if (bind->is_null != NULL && bind->is_null[i]) {
+      setNull(data, type, bytes);
+    } else {
+      memcpy(data, (char*)bind->buffer + stride * i, size);
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t setTableNameOfMetaInfo(SSqlObj* pSql, STableMetaInfo* pTableMetaInfo, const char* name) {
+  char      buf[TSDB_TABLE_ID_LEN] = {0};
+  SSQLToken sToken = {.z = buf, .n = (uint32_t)strnlen(name, TSDB_TABLE_ID_LEN), .type = TK_ID};
+  if (sToken.n == 0 || sToken.n >= TSDB_TABLE_ID_LEN) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  strtolower(buf, name);
+  return tscSetTableFullName(pTableMetaInfo, &sToken, pSql);
+}
+
+// the table meta is acquired from the local cache, or retrieved from mnode synchronously
+static int32_t getTableMetaByName(SSqlObj* pSql, STableMetaInfo* pTableMetaInfo, const char* name) {
+  int32_t code = setTableNameOfMetaInfo(pSql, pTableMetaInfo, name);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  if ((code = tscGetTableMetaSync(pSql, pTableMetaInfo)) != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  // data is only inserted into normal tables and child tables
+  return UTIL_TABLE_IS_SUPER_TABLE(pTableMetaInfo) ? TSDB_CODE_TSC_INVALID_VALUE : TSDB_CODE_SUCCESS;
+}
+
 static int insertStmtBindParam(STscStmt* stmt, TAOS_BIND* bind) {
   SSqlCmd* pCmd = &stmt->pSql->cmd;
 
@@ -467,6 +573,408 @@ static int insertStmtExecute(STscStmt* stmt) {
 
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// functions for insertion into multiple tables by one prepared statement
+
+static int multiTbStmtInit(STscStmt* pStmt) {
+  SSqlCmd*      pCmd = &pStmt->pSql->cmd;
+  SMultiTbStmt* mtb = &pStmt->mtb;
+
+  // only the statement of single table insertion is supported, and no rows are bound yet
+  if (!pStmt->isInsert || pCmd->batchSize > 0 || taosArrayGetSize(pCmd->pDataBlocks) != 1) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  STableDataBlocks* pBlock = taosArrayGetP(pCmd->pDataBlocks, 0);
+  SSubmitBlk*       pSubmit = (SSubmitBlk*)pBlock->pData;
+  if (pBlock->numOfParams == 0 || pSubmit->numOfRows != 1) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  STableComInfo tinfo = tscGetTableInfo(pBlock->pTableMeta);
+
+  mtb->rowSize = pBlock->rowSize;
+  mtb->numOfParams = pBlock->numOfParams;
+  mtb->numOfCols = tinfo.numOfColumns;
+  mtb->pTemplate = malloc(mtb->rowSize);
+  mtb->params = malloc(sizeof(SParamInfo) * mtb->numOfParams);
+  mtb->pSchema = malloc(sizeof(SSchema) * mtb->numOfCols);
+  mtb->pTableList = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), false);
+  if (mtb->pTemplate == NULL || mtb->params == NULL || mtb->pSchema == NULL || mtb->pTableList == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  memcpy(mtb->pTemplate, pSubmit->data, mtb->rowSize);
+  memcpy(mtb->params, pBlock->params, sizeof(SParamInfo) * mtb->numOfParams);
+  memcpy(mtb->pSchema, tscGetTableSchema(pBlock->pTableMeta), sizeof(SSchema) * mtb->numOfCols);
+
+  int32_t bytes = 0;
+  for (uint32_t i = 0; i < mtb->numOfParams; ++i) {
+    bytes += mtb->params[i].bytes;
+  }
+  mtb->allParams = (bytes == mtb->rowSize);
+
+  SQueryInfo* pQueryInfo = tscGetQueryInfoDetail(pCmd, pCmd->clauseIndex);
+  if (pQueryInfo->numOfTables > 1) {
+    STableMetaInfo* pSTableMetaInfo = tscGetMetaInfo(pQueryInfo, 1);
+    if (pSTableMetaInfo->pTableMeta != NULL && UTIL_TABLE_IS_SUPER_TABLE(pSTableMetaInfo)) {
+      tstrncpy(mtb->stableName, pSTableMetaInfo->name, sizeof(mtb->stableName));
+    }
+  }
+
+  // the table in sql is the initial target table, and the parsed template row is removed from its data block
+  tstrncpy(mtb->tableMetaInfo.name, pBlock->tableId, sizeof(mtb->tableMetaInfo.name));
+  mtb->tableMetaInfo.pTableMeta = taosCacheAcquireByData(tscCacheHandle, pBlock->pTableMeta);
+
+  pSubmit->numOfRows = 0;
+  pBlock->size = sizeof(SSubmitBlk);
+  pBlock->ordered = true;
+  pBlock->prevTS = INT64_MIN;
+
+  taosHashPut(mtb->pTableList, (const char*)&pBlock->pTableMeta->uid, sizeof(int64_t), (char*)&pBlock, POINTER_BYTES);
+  mtb->pBlock = pBlock;
+
+  mtb->enabled = true;
+  return TSDB_CODE_SUCCESS;
+}
+
+static void multiTbStmtDestroy(STscStmt* pStmt) {
+  SMultiTbStmt* mtb = &pStmt->mtb;
+
+  tfree(mtb->pTemplate);
+  tfree(mtb->params);
+  tfree(mtb->pSchema);
+  taosHashCleanup(mtb->pTableList);
+  taosCacheRelease(tscCacheHandle, (void**)&(mtb->tableMetaInfo.pTableMeta), false);
+}
+
+// the rows of data block are counted only after all values are bound successfully
+static void multiTbStmtAppendRows(STableDataBlocks* pBlock, int32_t numOfRows) {
+  char* start = pBlock->pData + pBlock->size;
+
+  for (int32_t i = 0; i < numOfRows && pBlock->ordered; ++i) {
+    TSKEY k = *(TSKEY*)(start + pBlock->rowSize * i);
+    if (k <= pBlock->prevTS) {
+      pBlock->ordered = false;
+    }
+
+    pBlock->prevTS = k;
+  }
+
+  pBlock->size += pBlock->rowSize * numOfRows;
+
+  SSubmitBlk* pSubmit = (SSubmitBlk*)pBlock->pData;
+  pSubmit->numOfRows += numOfRows;
+}
+
+static int multiTbStmtAddBatch(STscStmt* pStmt) {
+  SMultiTbStmt* mtb = &pStmt->mtb;
+  if (mtb->pending) {
+    multiTbStmtAppendRows(mtb->pBlock, 1);
+    mtb->pending = false;
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+// get the data block of current target table with enough space for numOfRows more rows
+static int32_t multiTbStmtPrepareBlock(STscStmt* pStmt, int32_t numOfRows, STableDataBlocks** pBlock) {
+  SSqlCmd*      pCmd = &pStmt->pSql->cmd;
+  SMultiTbStmt* mtb = &pStmt->mtb;
+
+  if (mtb->pBlock == NULL) {
+    STableMeta* pTableMeta = mtb->tableMetaInfo.pTableMeta;
+    int32_t code = tscGetDataBlockFromList(mtb->pTableList, pCmd->pDataBlocks, pTableMeta->uid, TSDB_DEFAULT_PAYLOAD_SIZE,
+                                           sizeof(SSubmitBlk), mtb->rowSize, mtb->tableMetaInfo.name, pTableMeta,
+                                           &mtb->pBlock);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+
+    SSubmitBlk* pSubmit = (SSubmitBlk*)mtb->pBlock->pData;
+    pSubmit->tid = pTableMeta->sid;
+    pSubmit->uid = pTableMeta->uid;
+    pSubmit->sversion = pTableMeta->sversion;
+
+    mtb->pBlock->vgId = pTableMeta->vgroupInfo.vgId;
+    mtb->pBlock->numOfTables = 1;
+  }
+
+  STableDataBlocks* pDataBlock = mtb->pBlock;
+  if (((SSubmitBlk*)pDataBlock->pData)->numOfRows + numOfRows > INT16_MAX) {
+    return TSDB_CODE_TSC_INVALID_VALUE;  // too many rows of one table, execute the statement first
+  }
+
+  uint32_t size = pDataBlock->size + mtb->rowSize * numOfRows;
+  if (size > pDataBlock->nAllocSize) {
+    uint32_t nAllocSize = MAX(size, (uint32_t)(pDataBlock->nAllocSize * 1.5));
+    char*    tmp = realloc(pDataBlock->pData, nAllocSize);
+    if (tmp == NULL) {
+      return TSDB_CODE_TSC_OUT_OF_MEMORY;
+    }
+
+    pDataBlock->pData = tmp;
+    pDataBlock->nAllocSize = nAllocSize;
+  }
+
+  *pBlock = pDataBlock;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t multiTbStmtBindTags(SSqlObj* pSql, STableMetaInfo* pSTableMetaInfo, TAOS_BIND* tags) {
+  SSqlCmd* pCmd = &pSql->cmd;
+
+  int32_t code = tscAllocPayload(pCmd, sizeof(STagData));
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  STagData* pTag = (STagData*)pCmd->payload;
+  tstrncpy(pTag->name, pSTableMetaInfo->name, sizeof(pTag->name));
+
+  SSchema* pTagSchema = tscGetTableTagSchema(pSTableMetaInfo->pTableMeta);
+  int32_t  numOfTags = tscGetNumOfTags(pSTableMetaInfo->pTableMeta);
+
+  SParamInfo param = {0};
+  for (int32_t i = 0; i < numOfTags; ++i) {
+    param.type = pTagSchema[i].type;
+    param.bytes = pTagSchema[i].bytes;
+
+    if ((code = doBindParam(pTag->data, &param, &tags[i])) != TSDB_CODE_SUCCESS) {
+      tscTrace("%p tag %d: type mismatch or invalid", pSql, i);
+      return code;
+    }
+
+    param.offset += pTagSchema[i].bytes;
+  }
+
+  pTag->dataLen = htonl(param.offset);
+  pCmd->payloadLen = sizeof(pTag->name) + sizeof(pTag->dataLen) + param.offset;
+  return TSDB_CODE_SUCCESS;
+}
+
+// the table is created from the super table with the tags if it does not exist, the tags are ignored otherwise
+static int32_t getTableMetaAutoCreate(SSqlObj* pSql, STableMetaInfo* pTableMetaInfo, const char* name,
+                                      STableMetaInfo* pSTableMetaInfo, TAOS_BIND* tags) {
+  SSqlCmd* pCmd = &pSql->cmd;
+
+  int32_t code = tscGetTableMetaSync(pSql, pSTableMetaInfo);
+  if (code == TSDB_CODE_SUCCESS) {
+    code = UTIL_TABLE_IS_SUPER_TABLE(pSTableMetaInfo) ? multiTbStmtBindTags(pSql, pSTableMetaInfo, tags)
+                                                      : TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  // the tags in payload are sent along with the table meta request, and the table is created if not exists
+  if (code == TSDB_CODE_SUCCESS) {
+    pCmd->autoCreated = true;
+    code = getTableMetaByName(pSql, pTableMetaInfo, name);
+    pCmd->autoCreated = false;
+  }
+
+  pCmd->payloadLen = 0;
+  return code;
+}
+
+// the new target table shall have the same columns as the prepared table
+static int32_t multiTbStmtCheckSchema(STscStmt* pStmt, STableMetaInfo* pTableMetaInfo) {
+  SMultiTbStmt* mtb = &pStmt->mtb;
+
+  STableComInfo tinfo = tscGetTableInfo(pTableMetaInfo->pTableMeta);
+  SSchema*      pSchema = tscGetTableSchema(pTableMetaInfo->pTableMeta);
+  if (tinfo.numOfColumns != mtb->numOfCols) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  for (int32_t i = 0; i < mtb->numOfCols; ++i) {
+    if (pSchema[i].type != mtb->pSchema[i].type || pSchema[i].bytes != mtb->pSchema[i].bytes) {
+      tscTrace("%p column %d of table %s differs from the prepared table", pStmt->pSql, i, pTableMetaInfo->name);
+      return TSDB_CODE_TSC_INVALID_VALUE;
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * the new table is resolved and checked aside, and replaces the current target table only on success, so the rows
+ * are still bound to the previous table if it fails
+ */
+static int multiTbStmtSetTable(STscStmt* pStmt, const char* name, TAOS_BIND* tags) {
+  SSqlObj*      pSql = pStmt->pSql;
+  SMultiTbStmt* mtb = &pStmt->mtb;
+
+  STableMetaInfo tableMetaInfo = {0};
+  int32_t        code = TSDB_CODE_SUCCESS;
+  if (tags == NULL) {
+    code = getTableMetaByName(pSql, &tableMetaInfo, name);
+  } else if (mtb->stableName[0] == 0) {
+    code = TSDB_CODE_TSC_INVALID_VALUE;  // no super table to create the table
+  } else {
+    STableMetaInfo sTableMetaInfo = {0};
+    tstrncpy(sTableMetaInfo.name, mtb->stableName, sizeof(sTableMetaInfo.name));
+
+    code = getTableMetaAutoCreate(pSql, &tableMetaInfo, name, &sTableMetaInfo, tags);
+    taosCacheRelease(tscCacheHandle, (void**)&(sTableMetaInfo.pTableMeta), false);
+  }
+
+  if (code == TSDB_CODE_SUCCESS) {
+    code = multiTbStmtCheckSchema(pStmt, &tableMetaInfo);
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    taosCacheRelease(tscCacheHandle, (void**)&(tableMetaInfo.pTableMeta), false);
+    return code;
+  }
+
+  multiTbStmtAddBatch(pStmt);
+  mtb->pBlock = NULL;
+
+  taosCacheRelease(tscCacheHandle, (void**)&(mtb->tableMetaInfo.pTableMeta), false);
+  mtb->tableMetaInfo = tableMetaInfo;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int multiTbStmtBindParam(STscStmt* pStmt, TAOS_BIND* bind) {
+  SMultiTbStmt*     mtb = &pStmt->mtb;
+  STableDataBlocks* pBlock = NULL;
+
+  // the pending row is overwritten, as the single table statement does
+  int32_t code = multiTbStmtPrepareBlock(pStmt, 1, &pBlock);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  char* data = pBlock->pData + pBlock->size;
+  memcpy(data, mtb->pTemplate, mtb->rowSize);
+
+  for (uint32_t i = 0; i < mtb->numOfParams; ++i) {
+    SParamInfo* param = mtb->params + i;
+    if ((code = doBindParam(data, param, bind + param->idx)) != TSDB_CODE_SUCCESS) {
+      tscTrace("param %d: type mismatch or invalid", param->idx);
+      return code;
+    }
+  }
+
+  mtb->pending = true;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int multiTbStmtBindParamBatch(STscStmt* pStmt, TAOS_COLUMN_BIND* bind, int32_t numOfRows) {
+  SMultiTbStmt*     mtb = &pStmt->mtb;
+  STableDataBlocks* pBlock = NULL;
+
+  multiTbStmtAddBatch(pStmt);
+
+  int32_t code = multiTbStmtPrepareBlock(pStmt, numOfRows, &pBlock);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  char* start = pBlock->pData + pBlock->size;
+  if (!mtb->allParams) {
+    for (int32_t i = 0; i < numOfRows; ++i) {
+      memcpy(start + mtb->rowSize * i, mtb->pTemplate, mtb->rowSize);
+    }
+  }
+
+  for (uint32_t i = 0; i < mtb->numOfParams; ++i) {
+    SParamInfo* param = mtb->params + i;
+
+    code = doBindColumn(start + param->offset, mtb->rowSize, param->type, param->bytes, bind + param->idx, numOfRows);
+    if (code != TSDB_CODE_SUCCESS) {
+      tscTrace("param %d: type mismatch or invalid", param->idx);
+      return code;
+    }
+  }
+
+  multiTbStmtAppendRows(pBlock, numOfRows);
+  return TSDB_CODE_SUCCESS;
+}
+
+static int multiTbStmtReset(STscStmt* pStmt) {
+  SSqlCmd*      pCmd = &pStmt->pSql->cmd;
+  SMultiTbStmt* mtb = &pStmt->mtb;
+
+  size_t size = taosArrayGetSize(pCmd->pDataBlocks);
+  for (int32_t i = 0; i < size; ++i) {
+    STableDataBlocks* pBlock = taosArrayGetP(pCmd->pDataBlocks, i);
+    pBlock->size = sizeof(SSubmitBlk);
+    pBlock->ordered = true;
+    pBlock->prevTS = INT64_MIN;
+
+    ((SSubmitBlk*)pBlock->pData)->numOfRows = 0;
+  }
+
+  mtb->pending = false;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int multiTbStmtExecute(STscStmt* pStmt) {
+  SSqlObj*      pSql = pStmt->pSql;
+  SSqlCmd*      pCmd = &pSql->cmd;
+  SMultiTbStmt* mtb = &pStmt->mtb;
+
+  multiTbStmtAddBatch(pStmt);
+
+  // the data blocks are consumed by merging, so the target tables get new data blocks afterwards
+  taosHashCleanup(mtb->pTableList);
+  mtb->pTableList = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), false);
+  mtb->pBlock = NULL;
+
+  SArray* pDataBlocks = pCmd->pDataBlocks;
+  pCmd->pDataBlocks = taosArrayInit(4, POINTER_BYTES);
+  if (mtb->pTableList == NULL || pCmd->pDataBlocks == NULL) {
+    tscDestroyBlockArrayList(pDataBlocks);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  // the tables without any rows bound are skipped
+  size_t size = taosArrayGetSize(pDataBlocks);
+  for (int32_t i = 0; i < size; ++i) {
+    STableDataBlocks* pBlock = taosArrayGetP(pDataBlocks, i);
+    if (((SSubmitBlk*)pBlock->pData)->numOfRows > 0) {
+      taosArrayPush(pCmd->pDataBlocks, &pBlock);
+    } else {
+      tscDestroyDataBlock(pBlock);
+    }
+  }
+
+  taosArrayDestroy(pDataBlocks);
+  if (taosArrayGetSize(pCmd->pDataBlocks) == 0) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  // merge according to vgid
+  int32_t code = tscMergeTableDataBlocks(pSql, pCmd->pDataBlocks);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  SSqlRes* pRes = &pSql->res;
+  pRes->numOfRows = 0;
+  pRes->numOfTotal = 0;
+  pRes->numOfClauseTotal = 0;
+  pRes->qhandle = 0;
+
+  // the sub-objects of the last execution have been released
+  tfree(pSql->pSubs);
+  pSql->numOfSubs = 0;
+
+  pSql->cmd.insertType = 0;
+  pSql->fetchFp = waitForQueryRsp;
+  pSql->fp      = (void(*)())tscHandleMultivnodeInsert;
+
+  tscDoQuery(pSql);
+
+  // wait for the callback function to post the semaphore
+  tsem_wait(&pSql->rspSem);
+
+  // the merged data blocks of vnodes have been sent
+  tscDestroyBlockArrayList(pCmd->pDataBlocks);
+  pCmd->pDataBlocks = taosArrayInit(4, POINTER_BYTES);
+  return pSql->res.code;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // interface functions
 
@@ -572,6 +1080,8 @@ int taos_stmt_close(TAOS_STMT* stmt) {
     }
     free(normal->parts);
     free(normal->sql);
+  } else {
+    multiTbStmtDestroy(pStmt);
   }
 
   tscFreeSqlObj(pStmt->pSql);
@@ -579,18 +1089,55 @@ int taos_stmt_close(TAOS_STMT* stmt) {
   return TSDB_CODE_SUCCESS;
 }
 
+int taos_stmt_set_tbname_tags(TAOS_STMT* stmt, const char* name, TAOS_BIND* tags) {
+  STscStmt* pStmt = (STscStmt*)stmt;
+  if (pStmt == NULL || name == NULL || !pStmt->isInsert) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  if (!pStmt->mtb.enabled) {
+    int code = multiTbStmtInit(pStmt);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  }
+
+  return multiTbStmtSetTable(pStmt, name, tags);
+}
+
+int taos_stmt_set_tbname(TAOS_STMT* stmt, const char* name) {
+  return taos_stmt_set_tbname_tags(stmt, name, NULL);
+}
+
 int taos_stmt_bind_param(TAOS_STMT* stmt, TAOS_BIND* bind) {
   STscStmt* pStmt = (STscStmt*)stmt;
   if (pStmt->isInsert) {
-    return insertStmtBindParam(pStmt, bind);
+    return pStmt->mtb.enabled ? multiTbStmtBindParam(pStmt, bind) : insertStmtBindParam(pStmt, bind);
   }
   return normalStmtBindParam(pStmt, bind);
 }
 
+int taos_stmt_bind_param_batch(TAOS_STMT* stmt, TAOS_COLUMN_BIND* bind, int num_of_rows) {
+  STscStmt* pStmt = (STscStmt*)stmt;
+  if (pStmt == NULL || bind == NULL || num_of_rows <= 0 || !pStmt->isInsert) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  // the rows are bound to the table in the prepared sql, if no target table is set
+  if (!pStmt->mtb.enabled) {
+    int code = multiTbStmtInit(pStmt);
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  }
+
+  return multiTbStmtBindParamBatch(pStmt, bind, num_of_rows);
+}
+
 int taos_stmt_add_batch(TAOS_STMT* stmt) {
   STscStmt* pStmt = (STscStmt*)stmt;
   if (pStmt->isInsert) {
-    return insertStmtAddBatch(pStmt);
+    return pStmt->mtb.enabled ? multiTbStmtAddBatch(pStmt) : insertStmtAddBatch(pStmt);
   }
   return TSDB_CODE_COM_OPS_NOT_SUPPORT;
 }
@@ -598,7 +1145,7 @@ int taos_stmt_add_batch(TAOS_STMT* stmt) {
 int taos_stmt_reset(TAOS_STMT* stmt) {
   STscStmt* pStmt = (STscStmt*)stmt;
   if (pStmt->isInsert) {
-    return insertStmtReset(pStmt);
+    return pStmt->mtb.enabled ? multiTbStmtReset(pStmt) : insertStmtReset(pStmt);
   }
   return TSDB_CODE_SUCCESS;
 }
@@ -607,7 +1154,7 @@ int taos_stmt_execute(TAOS_STMT* stmt) {
   int ret = 0;
   STscStmt* pStmt = (STscStmt*)stmt;
   if (pStmt->isInsert) {
-    ret = insertStmtExecute(pStmt);
+    ret = pStmt->mtb.enabled ? multiTbStmtExecute(pStmt) : insertStmtExecute(pStmt);
   } else {
     char* sql = normalStmtBuildSql(pStmt);
     if (sql == NULL) {
@@ -639,3 +1186,667 @@ TAOS_RES *taos_stmt_use_result(TAOS_STMT* stmt) {
   pStmt->pSql = NULL;
   return result;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+// functions for insertion of column bindings, no sql string is constructed and parsed
+
+static int32_t doBindTable(SSqlObj* pSql, STableMetaInfo* pTableMetaInfo, TAOS_TABLE_BIND* pTable,
+                           TAOS_TABLE_TAGS* pTags) {
+  SSqlCmd* pCmd = &pSql->cmd;
+
+  if (pTable->num_of_rows <= 0) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  if (pTags == NULL || pTags->stable_name == NULL) {
+    code = getTableMetaByName(pSql, pTableMetaInfo, pTable->table_name);
+  } else {
+    STableMetaInfo sTableMetaInfo = {0};
+    code = setTableNameOfMetaInfo(pSql, &sTableMetaInfo, pTags->stable_name);
+    if (code == TSDB_CODE_SUCCESS) {
+      code = getTableMetaAutoCreate(pSql, pTableMetaInfo, pTable->table_name, &sTableMetaInfo, pTags->tags);
+    }
+
+    taosCacheRelease(tscCacheHandle, (void**)&(sTableMetaInfo.pTableMeta), false);
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  STableMeta*   pTableMeta = pTableMetaInfo->pTableMeta;
+  STableComInfo tinfo = tscGetTableInfo(pTableMeta);
+  SSchema*      pSchema = tscGetTableSchema(pTableMeta);
+
+  STableDataBlocks* pBlock = NULL;
+  code = tscGetDataBlockFromList(pCmd->pTableList, pCmd->pDataBlocks, pTableMeta->uid, TSDB_DEFAULT_PAYLOAD_SIZE,
+                                 sizeof(SSubmitBlk), tinfo.rowSize, pTableMetaInfo->name, pTableMeta, &pBlock);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  if (((SSubmitBlk*)pBlock->pData)->numOfRows + pTable->num_of_rows > INT16_MAX) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  uint32_t size = pBlock->size + tinfo.rowSize * pTable->num_of_rows;
+  if (size > pBlock->nAllocSize) {
+    char* tmp = realloc(pBlock->pData, size);
+    if (tmp == NULL) {
+      return TSDB_CODE_TSC_OUT_OF_MEMORY;
+    }
+
+    pBlock->pData = tmp;
+    pBlock->nAllocSize = size;
+  }
+
+  // values are written to the rows column by column, so each input array is accessed sequentially
+  char*   start = pBlock->pData + pBlock->size;
+  int32_t offset = 0;
+  for (int32_t i = 0; i < tinfo.numOfColumns; ++i) {
+    TAOS_COLUMN_BIND* bind = &pTable->columns[i];
+    if (i == PRIMARYKEY_TIMESTAMP_COL_INDEX && bind->is_null != NULL) {
+      for (int32_t j = 0; j < pTable->num_of_rows; ++j) {
+        if (bind->is_null[j]) {
+          return TSDB_CODE_TSC_INVALID_VALUE;  // primary timestamp column can not be null
+        }
+      }
+    }
+
+    code = doBindColumn(start + offset, tinfo.rowSize, pSchema[i].type, pSchema[i].bytes, bind, pTable->num_of_rows);
+    if (code != TSDB_CODE_SUCCESS) {
+      tscTrace("%p column %d of table %s: type mismatch or invalid", pSql, i, pTableMetaInfo->name);
+      return code;
+    }
+
+    offset += pSchema[i].bytes;
+  }
+
+  // the rows are sorted and the duplicated timestamps are removed before submit, if not ordered
+  for (int32_t i = 0; i < pTable->num_of_rows && pBlock->ordered; ++i) {
+    TSKEY k = *(TSKEY*)(start + tinfo.rowSize * i);
+    if (k <= pBlock->prevTS) {
+      pBlock->ordered = false;
+    }
+
+    pBlock->prevTS = k;
+  }
+
+  pBlock->size = size;
+  pBlock->vgId = pTableMeta->vgroupInfo.vgId;
+  pBlock->numOfTables = 1;
+
+  SSubmitBlk* pSubmit = (SSubmitBlk*)pBlock->pData;
+  pSubmit->tid = pTableMeta->sid;
+  pSubmit->uid = pTableMeta->uid;
+  pSubmit->sversion = pTableMeta->sversion;
+  pSubmit->numOfRows += pTable->num_of_rows;
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t doBindTables(SSqlObj* pSql, TAOS_TABLE_BIND* tables, TAOS_TABLE_TAGS* tags, int32_t numOfTables) {
+  SSqlCmd* pCmd = &pSql->cmd;
+
+  if (!pSql->pTscObj->writeAuth) {
+    return TSDB_CODE_TSC_NO_WRITE_AUTH;
+  }
+
+  if (tables == NULL || numOfTables <= 0) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  pCmd->command = TSDB_SQL_INSERT;
+
+  SQueryInfo* pQueryInfo = NULL;
+  int32_t     code = tscGetQueryInfoDetailSafely(pCmd, pCmd->clauseIndex, &pQueryInfo);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  TSDB_QUERY_SET_TYPE(pQueryInfo->type, TSDB_QUERY_TYPE_INSERT);
+  STableMetaInfo* pTableMetaInfo = tscAddEmptyMetaInfo(pQueryInfo);
+
+  if ((code = tscAllocPayload(pCmd, TSDB_DEFAULT_PAYLOAD_SIZE)) != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  pCmd->pTableList = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), false);
+  pCmd->pDataBlocks = taosArrayInit(4, POINTER_BYTES);
+  if (pTableMetaInfo == NULL || pCmd->pTableList == NULL || pCmd->pDataBlocks == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 0; i < numOfTables && code == TSDB_CODE_SUCCESS; ++i) {
+    code = doBindTable(pSql, pTableMetaInfo, &tables[i], (tags == NULL) ? NULL : &tags[i]);
+  }
+
+  taosHashCleanup(pCmd->pTableList);
+  pCmd->pTableList = NULL;
+
+  // merge according to vgid
+  if (code == TSDB_CODE_SUCCESS) {
+    code = tscMergeTableDataBlocks(pSql, pCmd->pDataBlocks);
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    pCmd->pDataBlocks = tscDestroyBlockArrayList(pCmd->pDataBlocks);
+  }
+
+  return code;
+}
+
+static SSqlObj* createBindSqlObj(STscObj* pObj, const char* sqlstr) {
+  SSqlObj* pSql = calloc(1, sizeof(SSqlObj));
+  if (pSql == NULL) {
+    terrno = TSDB_CODE_TSC_OUT_OF_MEMORY;
+    tscError("failed to malloc sqlObj");
+    return NULL;
+  }
+
+  tsem_init(&pSql->rspSem, 0, 0);
+  pSql->signature = pSql;
+  pSql->pTscObj   = pObj;
+  pSql->maxRetry  = TSDB_MAX_REPLICA_NUM;
+  pSql->param     = pSql;
+
+  // the sql string is only used in log and duplicated by the sub-objects of insertion
+  pSql->sqlstr = strdup(sqlstr);
+  return pSql;
+}
+
+TAOS_RES* taos_insert_columns(TAOS* taos, TAOS_TABLE_BIND* tables, int num_of_tables) {
+  return taos_insert_columns_auto(taos, tables, NULL, num_of_tables);
+}
+
+TAOS_RES* taos_insert_columns_auto(TAOS* taos, TAOS_TABLE_BIND* tables, TAOS_TABLE_TAGS* tags, int num_of_tables) {
+  STscObj* pObj = (STscObj*)taos;
+  if (pObj == NULL || pObj->signature != pObj) {
+    terrno = TSDB_CODE_TSC_DISCONNECTED;
+    tscError("connection disconnected");
+    return NULL;
+  }
+
+  SSqlObj* pSql = createBindSqlObj(pObj, "insert columns");
+  if (pSql == NULL) {
+    return NULL;
+  }
+
+  SSqlRes* pRes = &pSql->res;
+  pRes->code = (pSql->sqlstr == NULL) ? TSDB_CODE_TSC_OUT_OF_MEMORY : doBindTables(pSql, tables, tags, num_of_tables);
+  if (pRes->code != TSDB_CODE_SUCCESS) {
+    tscError("%p failed to bind the columns of %d tables, code:%s", pSql, num_of_tables, tstrerror(pRes->code));
+    return pSql;
+  }
+
+  pRes->qhandle = 0;
+  pRes->numOfRows = 0;
+  pRes->numOfTotal = 0;
+
+  pSql->fetchFp = waitForQueryRsp;
+  pSql->fp      = (void(*)())tscHandleMultivnodeInsert;
+
+  tscDoQuery(pSql);
+
+  // wait for the callback function to post the semaphore
+  tsem_wait(&pSql->rspSem);
+  return pSql;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// functions for pipelined asynchronous insertion, the rows of each vgroup are accumulated into one submit message
+
+typedef struct SIngestVgroup {
+  int32_t           vgId;
+  int32_t           numOfInFlight;  // submit messages sent to the vgroup, but not acknowledged yet
+  int32_t           numOfRows;      // rows accumulated in pBlock
+  int64_t           firstTime;      // the time when the first accumulated row arrives, in milliseconds
+  STableDataBlocks* pBlock;         // the submit message being accumulated
+} SIngestVgroup;
+
+typedef struct SIngestObj {
+  void*                signature;
+  STscObj*             pTscObj;
+  int32_t              batchRows;
+  int32_t              lingerMs;
+  int32_t              maxInFlight;
+  TAOS_INGEST_CALLBACK fp;
+  void*                param;
+  pthread_mutex_t      mutex;
+  pthread_cond_t       cond;           // signaled when a submit message is acknowledged
+  SArray*              pVgroups;       // SIngestVgroup*, only a few vgroups for one client, so searched linearly
+  int32_t              numOfInFlight;
+  int32_t              code;           // the first error since the last flush
+  bool                 closing;
+  void*                pTimer;
+  T_REF_DECLARE()                      // held by the owner and by the armed timer, see ingestStartTimer
+} SIngestObj;
+
+typedef struct SIngestSupporter {
+  SIngestObj*    pIngest;
+  SIngestVgroup* pVgroup;
+} SIngestSupporter;
+
+static void ingestSubmitCallback(void* param, TAOS_RES* tres, int numOfRows) {
+  SIngestSupporter* pSupporter = (SIngestSupporter*)param;
+  SIngestObj*       pIngest = pSupporter->pIngest;
+  SIngestVgroup*    pVgroup = pSupporter->pVgroup;
+
+  int32_t code = taos_errno(tres);
+  int32_t affectedRows = (code == TSDB_CODE_SUCCESS) ? numOfRows : 0;
+  tscTrace("%p submit to vgId:%d is acknowledged, rows:%d code:%s", tres, pVgroup->vgId, affectedRows, tstrerror(code));
+
+  taos_free_result(tres);
+  tfree(pSupporter);
+
+  if (pIngest->fp != NULL) {
+    (*pIngest->fp)(pIngest, pIngest->param, code, affectedRows);
+  }
+
+  // the ingest object may be released by taos_ingest_close once the last submit message is acknowledged
+  pthread_mutex_lock(&pIngest->mutex);
+  pVgroup->numOfInFlight -= 1;
+  pIngest->numOfInFlight -= 1;
+  if (code != TSDB_CODE_SUCCESS && pIngest->code == TSDB_CODE_SUCCESS) {
+    pIngest->code = code;
+  }
+
+  pthread_cond_broadcast(&pIngest->cond);
+  pthread_mutex_unlock(&pIngest->mutex);
+}
+
+static int32_t createIngestSubmitObj(SIngestObj* pIngest, SIngestVgroup* pVgroup, SSqlObj** pSubmit) {
+  STableDataBlocks* pBlock = pVgroup->pBlock;
+
+  SIngestSupporter* pSupporter = calloc(1, sizeof(SIngestSupporter));
+  SSqlObj*          pNew = createBindSqlObj(pIngest->pTscObj, "ingest");
+  if (pSupporter == NULL || pNew == NULL || pNew->sqlstr == NULL) {
+    tfree(pSupporter);
+    tscFreeSqlObj(pNew);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  pSupporter->pIngest = pIngest;
+  pSupporter->pVgroup = pVgroup;
+
+  pNew->fp = ingestSubmitCallback;
+  pNew->param = pSupporter;
+
+  SSqlCmd* pCmd = &pNew->cmd;
+  pCmd->command = TSDB_SQL_INSERT;
+  pCmd->parseFinished = 1;
+
+  SQueryInfo* pQueryInfo = NULL;
+  int32_t     code = tscGetQueryInfoDetailSafely(pCmd, 0, &pQueryInfo);
+  if (code == TSDB_CODE_SUCCESS) {
+    TSDB_QUERY_SET_TYPE(pQueryInfo->type, TSDB_QUERY_TYPE_INSERT);
+    code = (tscAddEmptyMetaInfo(pQueryInfo) == NULL) ? TSDB_CODE_TSC_OUT_OF_MEMORY : TSDB_CODE_SUCCESS;
+  }
+
+  // allocate the payload in advance, so the accumulated block is kept if failed
+  if (code == TSDB_CODE_SUCCESS) {
+    code = tscAllocPayload(pCmd, pBlock->size + 100);
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    tfree(pSupporter);
+    tscFreeSqlObj(pNew);
+    return code;
+  }
+
+  tscCopyDataBlockToPayload(pNew, pBlock);
+  tscTrace("%p submit to vgId:%d is created, tables:%d rows:%d size:%d", pNew, pVgroup->vgId, pBlock->numOfTables,
+           pVgroup->numOfRows, pBlock->size);
+
+  tscDestroyDataBlock(pBlock);
+  pVgroup->pBlock = NULL;
+  pVgroup->numOfRows = 0;
+
+  *pSubmit = pNew;
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * create the submit message of the accumulated rows of the vgroup. If there are already maxInFlight submit messages
+ * not acknowledged by the vgroup, wait for the acknowledgement, or give up if not allowed to wait. The mutex is held
+ * by the caller, and the created submit message is sent by the caller.
+ */
+static int32_t ingestFlushVgroup(SIngestObj* pIngest, SIngestVgroup* pVgroup, bool wait, SSqlObj** pSubmit) {
+  *pSubmit = NULL;
+
+  while (pVgroup->pBlock != NULL && pVgroup->numOfInFlight >= pIngest->maxInFlight) {
+    if (!wait) {
+      return TSDB_CODE_SUCCESS;
+    }
+
+    pthread_cond_wait(&pIngest->cond, &pIngest->mutex);
+  }
+
+  // the rows may have been flushed by other threads during waiting
+  if (pVgroup->pBlock == NULL) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  int32_t code = createIngestSubmitObj(pIngest, pVgroup, pSubmit);
+  if (code == TSDB_CODE_SUCCESS) {
+    pVgroup->numOfInFlight += 1;
+    pIngest->numOfInFlight += 1;
+  }
+
+  return code;
+}
+
+// send the submit message with the mutex released, the acknowledgement may arrive before tscProcessSql returns
+static void ingestSendSubmit(SIngestObj* pIngest, SSqlObj* pSubmit) {
+  pthread_mutex_unlock(&pIngest->mutex);
+  tscProcessSql(pSubmit);
+  pthread_mutex_lock(&pIngest->mutex);
+}
+
+static int32_t ingestFlushAll(SIngestObj* pIngest) {
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  // the vgroup list may grow while the mutex is released, so it is accessed by index
+  for (int32_t i = 0; i < taosArrayGetSize(pIngest->pVgroups) && code == TSDB_CODE_SUCCESS; ++i) {
+    SIngestVgroup* pVgroup = taosArrayGetP(pIngest->pVgroups, i);
+
+    SSqlObj* pSubmit = NULL;
+    code = ingestFlushVgroup(pIngest, pVgroup, true, &pSubmit);
+    if (pSubmit != NULL) {
+      ingestSendSubmit(pIngest, pSubmit);
+    }
+  }
+
+  return code;
+}
+
+static void ingestRelease(SIngestObj* pIngest) {
+  if (T_REF_DEC(pIngest) > 0) {
+    return;
+  }
+
+  pthread_cond_destroy(&pIngest->cond);
+  pthread_mutex_destroy(&pIngest->mutex);
+
+  tscTrace("%p ingest object is released", pIngest);
+  free(pIngest);
+}
+
+static void ingestTimerFp(void* param, void* tmrId);
+
+// must be called with the mutex locked. taosTmrStop cannot wait for a callback which has fired, so each armed timer
+// holds a reference which is released by its callback, or here if it is canceled before it fires
+static void ingestStartTimer(SIngestObj* pIngest, int32_t mseconds) {
+  T_REF_INC(pIngest);
+  if (taosTmrReset(ingestTimerFp, mseconds, pIngest, tscTmr, &pIngest->pTimer)) {
+    T_REF_DEC(pIngest);
+  }
+
+  if (pIngest->pTimer == NULL) {
+    T_REF_DEC(pIngest);
+    tscError("%p failed to start the linger timer", pIngest);
+  }
+}
+
+static void ingestTimerFp(void* param, void* tmrId) {
+  SIngestObj* pIngest = (SIngestObj*)param;
+
+  pthread_mutex_lock(&pIngest->mutex);
+  if (pIngest->closing || pIngest->pTimer != tmrId) {
+    pthread_mutex_unlock(&pIngest->mutex);
+    ingestRelease(pIngest);
+    return;
+  }
+
+  // the submit messages are sent after the timer is reset, the ingest object is not accessed after unlock
+  SArray* pSubmits = taosArrayInit(4, POINTER_BYTES);
+
+  int64_t now = taosGetTimestampMs();
+  int32_t next = pIngest->lingerMs;
+  for (int32_t i = 0; i < taosArrayGetSize(pIngest->pVgroups); ++i) {
+    SIngestVgroup* pVgroup = taosArrayGetP(pIngest->pVgroups, i);
+    if (pVgroup->pBlock == NULL) {
+      continue;
+    }
+
+    int64_t elapsed = now - pVgroup->firstTime;
+    if (elapsed >= pIngest->lingerMs && pSubmits != NULL) {
+      SSqlObj* pSubmit = NULL;
+      int32_t  code = ingestFlushVgroup(pIngest, pVgroup, false, &pSubmit);
+      if (pSubmit != NULL) {
+        taosArrayPush(pSubmits, &pSubmit);
+      } else if (code != TSDB_CODE_SUCCESS) {
+        tscError("%p failed to flush the rows of vgId:%d, code:%s", pIngest, pVgroup->vgId, tstrerror(code));
+      }
+    }
+
+    // the vgroup is checked again soon, if the submit is blocked by the rows in flight
+    if (pVgroup->pBlock != NULL) {
+      next = MAX(MIN(next, pIngest->lingerMs - elapsed), MSECONDS_PER_TICK * 2);
+    }
+  }
+
+  ingestStartTimer(pIngest, next);
+  pthread_mutex_unlock(&pIngest->mutex);
+
+  for (int32_t i = 0; i < taosArrayGetSize(pSubmits); ++i) {
+    tscProcessSql(taosArrayGetP(pSubmits, i));
+  }
+
+  taosArrayDestroy(pSubmits);
+  ingestRelease(pIngest);
+}
+
+static int32_t ingestGetVgroup(SIngestObj* pIngest, int32_t vgId, SIngestVgroup** pVgroup) {
+  for (int32_t i = 0; i < taosArrayGetSize(pIngest->pVgroups); ++i) {
+    *pVgroup = taosArrayGetP(pIngest->pVgroups, i);
+    if ((*pVgroup)->vgId == vgId) {
+      return TSDB_CODE_SUCCESS;
+    }
+  }
+
+  *pVgroup = calloc(1, sizeof(SIngestVgroup));
+  if (*pVgroup == NULL || taosArrayPush(pIngest->pVgroups, pVgroup) == NULL) {
+    tfree(*pVgroup);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  (*pVgroup)->vgId = vgId;
+  return TSDB_CODE_SUCCESS;
+}
+
+// append the table blocks in the merged vnode block to the accumulated submit message of the vgroup
+static int32_t ingestAppendBlock(SIngestVgroup* pVgroup, STableDataBlocks** pBlock) {
+  STableDataBlocks* pSrc = *pBlock;
+
+  int32_t numOfRows = 0;
+  char*   p = pSrc->pData + pSrc->headerSize;
+  for (int32_t i = 0; i < pSrc->numOfTables; ++i) {
+    SSubmitBlk* pSubmitBlk = (SSubmitBlk*)p;
+    numOfRows += htons(pSubmitBlk->numOfRows);
+    p += sizeof(SSubmitBlk) + htonl(pSubmitBlk->len);
+  }
+
+  if (pVgroup->pBlock == NULL) {  // take over the vnode block directly
+    pVgroup->pBlock = pSrc;
+    pVgroup->firstTime = taosGetTimestampMs();
+    *pBlock = NULL;
+  } else {
+    STableDataBlocks* pDst = pVgroup->pBlock;
+    uint32_t          len = pSrc->size - pSrc->headerSize;
+
+    if (pDst->size + len > pDst->nAllocSize) {
+      uint32_t size = MAX(pDst->nAllocSize * 1.5, pDst->size + len);
+      char*    tmp = realloc(pDst->pData, size);
+      if (tmp == NULL) {
+        return TSDB_CODE_TSC_OUT_OF_MEMORY;
+      }
+
+      pDst->pData = tmp;
+      pDst->nAllocSize = size;
+    }
+
+    memcpy(pDst->pData + pDst->size, pSrc->pData + pSrc->headerSize, len);
+    pDst->size += len;
+    pDst->numOfTables += pSrc->numOfTables;
+  }
+
+  pVgroup->numOfRows += numOfRows;
+  return TSDB_CODE_SUCCESS;
+}
+
+TAOS_INGEST* taos_ingest_open(TAOS* taos, int batch_rows, int linger_ms, int max_in_flight, TAOS_INGEST_CALLBACK fp,
+                              void* param) {
+  STscObj* pObj = (STscObj*)taos;
+  if (pObj == NULL || pObj->signature != pObj) {
+    terrno = TSDB_CODE_TSC_DISCONNECTED;
+    tscError("connection disconnected");
+    return NULL;
+  }
+
+  if (batch_rows <= 0 || linger_ms < 0 || max_in_flight <= 0) {
+    terrno = TSDB_CODE_TSC_INVALID_VALUE;
+    tscError("invalid ingest options, batch rows:%d linger:%d max in flight:%d", batch_rows, linger_ms, max_in_flight);
+    return NULL;
+  }
+
+  SIngestObj* pIngest = calloc(1, sizeof(SIngestObj));
+  if (pIngest == NULL || (pIngest->pVgroups = taosArrayInit(4, POINTER_BYTES)) == NULL) {
+    tfree(pIngest);
+    terrno = TSDB_CODE_TSC_OUT_OF_MEMORY;
+    tscError("failed to malloc ingest object");
+    return NULL;
+  }
+
+  pIngest->signature = pIngest;
+  pIngest->pTscObj = pObj;
+  pIngest->batchRows = batch_rows;
+  pIngest->lingerMs = linger_ms;
+  pIngest->maxInFlight = max_in_flight;
+  pIngest->fp = fp;
+  pIngest->param = param;
+
+  T_REF_INC(pIngest);
+
+  pthread_mutex_init(&pIngest->mutex, NULL);
+  pthread_cond_init(&pIngest->cond, NULL);
+
+  if (linger_ms > 0) {
+    pthread_mutex_lock(&pIngest->mutex);
+    ingestStartTimer(pIngest, linger_ms);
+    pthread_mutex_unlock(&pIngest->mutex);
+  }
+
+  tscTrace("%p ingest object is created, batch rows:%d linger:%dms max in flight:%d", pIngest, batch_rows, linger_ms,
+           max_in_flight);
+  return pIngest;
+}
+
+int taos_ingest_write(TAOS_INGEST* ingest, TAOS_TABLE_BIND* tables, int num_of_tables) {
+  return taos_ingest_write_auto(ingest, tables, NULL, num_of_tables);
+}
+
+int taos_ingest_write_auto(TAOS_INGEST* ingest, TAOS_TABLE_BIND* tables, TAOS_TABLE_TAGS* tags, int num_of_tables) {
+  SIngestObj* pIngest = (SIngestObj*)ingest;
+  if (pIngest == NULL || pIngest->signature != pIngest) {
+    return TSDB_CODE_TSC_APP_ERROR;
+  }
+
+  // the columns are bound without lock, so several threads may write concurrently
+  SSqlObj* pSql = createBindSqlObj(pIngest->pTscObj, "ingest");
+  if (pSql == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  int32_t code = (pSql->sqlstr == NULL) ? TSDB_CODE_TSC_OUT_OF_MEMORY : doBindTables(pSql, tables, tags, num_of_tables);
+  if (code == TSDB_CODE_SUCCESS) {
+    SArray* pBlockList = pSql->cmd.pDataBlocks;
+
+    pthread_mutex_lock(&pIngest->mutex);
+    for (int32_t i = 0; i < taosArrayGetSize(pBlockList) && code == TSDB_CODE_SUCCESS; ++i) {
+      STableDataBlocks** pBlock = taosArrayGet(pBlockList, i);
+
+      // the vgroup of the merged vnode block is only recorded in its table meta
+      SIngestVgroup* pVgroup = NULL;
+      code = ingestGetVgroup(pIngest, (*pBlock)->pTableMeta->vgroupInfo.vgId, &pVgroup);
+      if (code == TSDB_CODE_SUCCESS) {
+        code = ingestAppendBlock(pVgroup, pBlock);
+      }
+
+      if (code == TSDB_CODE_SUCCESS && pVgroup->numOfRows >= pIngest->batchRows) {
+        SSqlObj* pSubmit = NULL;
+        code = ingestFlushVgroup(pIngest, pVgroup, true, &pSubmit);
+        if (pSubmit != NULL) {
+          ingestSendSubmit(pIngest, pSubmit);
+        }
+      }
+    }
+
+    pthread_mutex_unlock(&pIngest->mutex);
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    tscError("%p failed to write the columns of %d tables, code:%s", pIngest, num_of_tables, tstrerror(code));
+  }
+
+  tscFreeSqlObj(pSql);
+  return code;
+}
+
+int taos_ingest_flush(TAOS_INGEST* ingest) {
+  SIngestObj* pIngest = (SIngestObj*)ingest;
+  if (pIngest == NULL || pIngest->signature != pIngest) {
+    return TSDB_CODE_TSC_APP_ERROR;
+  }
+
+  pthread_mutex_lock(&pIngest->mutex);
+
+  int32_t code = ingestFlushAll(pIngest);
+  while (pIngest->numOfInFlight > 0) {
+    pthread_cond_wait(&pIngest->cond, &pIngest->mutex);
+  }
+
+  if (code == TSDB_CODE_SUCCESS) {
+    code = pIngest->code;
+  }
+
+  pIngest->code = TSDB_CODE_SUCCESS;
+  pthread_mutex_unlock(&pIngest->mutex);
+
+  return code;
+}
+
+void taos_ingest_close(TAOS_INGEST* ingest) {
+  SIngestObj* pIngest = (SIngestObj*)ingest;
+  if (pIngest == NULL || pIngest->signature != pIngest) {
+    return;
+  }
+
+  // a timer callback which has fired finds the closing flag set, and only releases its reference
+  pthread_mutex_lock(&pIngest->mutex);
+  pIngest->closing = true;
+  if (taosTmrStopA(&pIngest->pTimer)) {
+    T_REF_DEC(pIngest);
+  }
+  pthread_mutex_unlock(&pIngest->mutex);
+
+  int32_t code = taos_ingest_flush(ingest);
+  if (code != TSDB_CODE_SUCCESS) {
+    tscError("%p failed to flush the ingest object before close, code:%s", pIngest, tstrerror(code));
+  }
+
+  // the rows failed to be flushed are discarded
+  for (int32_t i = 0; i < taosArrayGetSize(pIngest->pVgroups); ++i) {
+    SIngestVgroup* pVgroup = taosArrayGetP(pIngest->pVgroups, i);
+    tscDestroyDataBlock(pVgroup->pBlock);
+    free(pVgroup);
+  }
+
+  taosArrayDestroy(pIngest->pVgroups);
+  pIngest->pVgroups = NULL;
+
+  tscTrace("%p ingest object is closed", pIngest);
+  pIngest->signature = NULL;
+  ingestRelease(pIngest);
+}
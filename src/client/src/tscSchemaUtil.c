@@ -161,6 +161,12 @@ STableMeta* tscCreateTableMetaFromMsg(STableMetaMsg* pTableMetaMsg, size_t* size
   pTableMeta->tversion = pTableMetaMsg->tversion;
   
   memcpy(pTableMeta->schema, pTableMetaMsg->schema, schemaSize);
+
+  char *pSuid = (char *)pTableMetaMsg->schema + schemaSize;
+  if (pTableMeta->tableType == TSDB_CHILD_TABLE &&
+      pSuid + sizeof(uint64_t) <= (char *)pTableMetaMsg + pTableMetaMsg->contLen) {
+    memcpy(&pTableMeta->suid, pSuid, sizeof(pTableMeta->suid));
+  }
   
   int32_t numOfTotalCols = pTableMeta->tableInfo.numOfColumns;
   for(int32_t i = 0; i < numOfTotalCols; ++i) {
@@ -14,6 +14,7 @@
  */
 
 #include "os.h"
+#include "qresultEncode.h"
 #include "qsqltype.h"
 #include "tcache.h"
 #include "trpc.h"
@@ -248,7 +249,7 @@ void tscProcessMsgFromServer(SRpcMsg *rpcMsg, SRpcIpSet *pIpSet) {
         rpcMsg->code = TSDB_CODE_RPC_NOT_READY;
         rpcFreeCont(rpcMsg->pCont);
         return;
-      } else if (pCmd->command == TSDB_SQL_META) {
+      } else if (pCmd->command == TSDB_SQL_META || pCmd->command == TSDB_SQL_STABLE_CHILDREN) {
         // get table meta query will not retry, do nothing
       } else {
         tscWarn("%p it shall renew table meta, code:%s, retry:%d", pSql, tstrerror(rpcMsg->code), ++pSql->retry);
@@ -352,7 +353,8 @@ int doProcessSql(SSqlObj *pSql) {
       pCmd->command == TSDB_SQL_CONNECT ||
       pCmd->command == TSDB_SQL_HB ||
       pCmd->command == TSDB_SQL_META ||
-      pCmd->command == TSDB_SQL_STABLEVGROUP) {
+      pCmd->command == TSDB_SQL_STABLEVGROUP ||
+      pCmd->command == TSDB_SQL_STABLE_CHILDREN) {
     pRes->code = tscBuildMsg[pCmd->command](pSql, NULL);
   }
   
@@ -413,6 +415,13 @@ void tscKillSTableQuery(SSqlObj *pSql) {
     return;
   }
 
+  // the sub-queries of streaming merge may have been released, and they abort the retrieval due to res.code
+  SLocalReducer *pLocalReducer = pSql->res.pLocalReducer;
+  if (pCmd->command == TSDB_SQL_RETRIEVE_LOCALMERGE && pLocalReducer != NULL && pLocalReducer->pState != NULL) {
+    tscTrace("%p super table query cancelled", pSql);
+    return;
+  }
+
   for (int i = 0; i < pSql->numOfSubs; ++i) {
     SSqlObj *pSub = pSql->pSubs[i];
     if (pSub == NULL) {
@@ -635,7 +644,7 @@ int tscBuildQueryMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
   pQueryMsg->numOfGroupCols = htons(pQueryInfo->groupbyExpr.numOfGroupCols);
   pQueryMsg->numOfTags      = htonl(numOfTags);
   pQueryMsg->tagNameRelType = htons(pQueryInfo->tagCond.relType);
-  pQueryMsg->queryType      = htonl(pQueryInfo->type);
+  pQueryMsg->queryType      = htonl(pQueryInfo->type | TSDB_QUERY_TYPE_ENCODE_RESULT);  // ignored by old servers
   
   size_t numOfOutput = tscSqlExprNumOfExprs(pQueryInfo);
   pQueryMsg->numOfOutput = htons(numOfOutput);
@@ -1393,7 +1402,13 @@ int tscProcessRetrieveLocalMergeRsp(SSqlObj *pSql) {
   SSqlRes *pRes = &pSql->res;
   SSqlCmd *pCmd = &pSql->cmd;
 
-  pRes->code = tscDoLocalMerge(pSql);
+  // the streaming merge is suspended to wait for the results of vnode, and it is resumed once they arrive
+  int32_t ret = tscDoLocalMerge(pSql);
+  if (ret == TSDB_CODE_TSC_ACTION_IN_PROGRESS) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  pRes->code = ret;
   SQueryInfo *pQueryInfo = tscGetQueryInfoDetail(pCmd, pCmd->clauseIndex);
 
   if (pRes->code == TSDB_CODE_SUCCESS && pRes->numOfRows > 0) {
@@ -1613,9 +1628,154 @@ int tscBuildHeartBeatMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
   return TSDB_CODE_SUCCESS;
 }
 
-int tscProcessTableMetaRsp(SSqlObj *pSql) {
-  STableMetaMsg *pMetaMsg = (STableMetaMsg *)pSql->res.pRsp;
+typedef struct SSTableVersion {
+  int16_t sversion;
+  int16_t tversion;
+  char    name[TSDB_TABLE_ID_LEN];  // name of the super table, empty if its meta is not received yet
+} SSTableVersion;
+
+/*
+ * record the latest versions of the super table known by the client, the versions are acquired from the meta of the
+ * super table or any of its child tables.
+ */
+static void tscUpdateSTableVersion(STableMeta *pTableMeta, const char *name) {
+  if (pTableMeta->tableType != TSDB_SUPER_TABLE && pTableMeta->tableType != TSDB_CHILD_TABLE) {
+    return;
+  }
+
+  uint64_t suid = (pTableMeta->tableType == TSDB_SUPER_TABLE) ? pTableMeta->uid : pTableMeta->suid;
+
+  pthread_mutex_lock(&tscSTableVersionMutex);
+
+  SSTableVersion *pVersion = taosHashGet(tscSTableVersions, &suid, sizeof(suid));
+  if (pVersion == NULL) {
+    SSTableVersion version = {.sversion = pTableMeta->sversion, .tversion = pTableMeta->tversion};
+    taosHashPut(tscSTableVersions, &suid, sizeof(suid), &version, sizeof(version));
+    pVersion = taosHashGet(tscSTableVersions, &suid, sizeof(suid));
+  } else {
+    pVersion->sversion = MAX(pVersion->sversion, pTableMeta->sversion);
+    pVersion->tversion = MAX(pVersion->tversion, pTableMeta->tversion);
+  }
+
+  if (pVersion != NULL && pTableMeta->tableType == TSDB_SUPER_TABLE) {
+    tstrncpy(pVersion->name, name, sizeof(pVersion->name));
+  }
+
+  pthread_mutex_unlock(&tscSTableVersionMutex);
+}
+
+static bool tscIsSTableVersionOutOfDate(uint64_t suid, int16_t sversion, int16_t tversion) {
+  bool outOfDate = false;
+  pthread_mutex_lock(&tscSTableVersionMutex);
+
+  SSTableVersion *pVersion = taosHashGet(tscSTableVersions, &suid, sizeof(suid));
+  if (pVersion != NULL) {
+    outOfDate = (sversion < pVersion->sversion || tversion < pVersion->tversion);
+  }
+
+  pthread_mutex_unlock(&tscSTableVersionMutex);
+  return outOfDate;
+}
 
+// the cached meta of a child table is out of date once its super table has been altered
+static bool tscIsTableMetaOutOfDate(STableMeta *pTableMeta) {
+  if (pTableMeta->tableType != TSDB_CHILD_TABLE) {
+    return false;
+  }
+
+  return tscIsSTableVersionOutOfDate(pTableMeta->suid, pTableMeta->sversion, pTableMeta->tversion);
+}
+
+/*
+ * build the meta of a prefetched child table from the cached meta of its super table, the built meta is put into cache
+ * as the one retrieved from mnode. NULL is returned if the meta of the super table or the vgroup is not available, or
+ * they are of different versions, and the meta of the child table will be retrieved from mnode then.
+ */
+static STableMeta *tscBuildChildTableMeta(SSqlObj *pSql, char *name) {
+  SChildTableMeta *pChild = (SChildTableMeta *)taosCacheAcquireByName(tscChildMetaHandle, name);
+  if (pChild == NULL) {
+    return NULL;
+  }
+
+  if (tscIsSTableVersionOutOfDate(pChild->suid, pChild->sversion, pChild->tversion)) {
+    tscTrace("%p prefetched meta of %s is out of date, sversion:%d, tversion:%d, discard it", pSql, name,
+             pChild->sversion, pChild->tversion);
+    taosCacheRelease(tscChildMetaHandle, (void **)&pChild, true);
+    return NULL;
+  }
+
+  char          stableName[TSDB_TABLE_ID_LEN] = {0};
+  SCMVgroupInfo vgroupInfo = {0};
+
+  pthread_mutex_lock(&tscSTableVersionMutex);
+
+  SSTableVersion *pVersion = taosHashGet(tscSTableVersions, &pChild->suid, sizeof(pChild->suid));
+  if (pVersion != NULL) {
+    tstrncpy(stableName, pVersion->name, sizeof(stableName));
+  }
+
+  SCMVgroupInfo *pVgroup = taosHashGet(tscVgroupInfos, &pChild->vgId, sizeof(pChild->vgId));
+  if (pVgroup != NULL) {
+    vgroupInfo = *pVgroup;
+  }
+
+  pthread_mutex_unlock(&tscSTableVersionMutex);
+
+  STableMeta *pSTableMeta = NULL;
+  if (stableName[0] != 0 && vgroupInfo.vgId == pChild->vgId) {
+    pSTableMeta = (STableMeta *)taosCacheAcquireByName(tscCacheHandle, stableName);
+  }
+
+  if (pSTableMeta == NULL || pSTableMeta->uid != pChild->suid || pSTableMeta->sversion != pChild->sversion ||
+      pSTableMeta->tversion != pChild->tversion) {
+    taosCacheRelease(tscCacheHandle, (void **)&pSTableMeta, false);
+    taosCacheRelease(tscChildMetaHandle, (void **)&pChild, false);
+    return NULL;
+  }
+
+  size_t schemaSize = (pSTableMeta->tableInfo.numOfColumns + pSTableMeta->tableInfo.numOfTags) * sizeof(SSchema);
+  size_t size = sizeof(STableMeta) + schemaSize;
+
+  STableMeta *pTableMeta = malloc(size);
+  if (pTableMeta != NULL) {
+    memcpy(pTableMeta, pSTableMeta, size);
+    pTableMeta->tableType = TSDB_CHILD_TABLE;
+    pTableMeta->sid = pChild->sid;
+    pTableMeta->uid = pChild->uid;
+    pTableMeta->suid = pChild->suid;
+    pTableMeta->vgroupInfo = vgroupInfo;
+  }
+
+  taosCacheRelease(tscCacheHandle, (void **)&pSTableMeta, false);
+  taosCacheRelease(tscChildMetaHandle, (void **)&pChild, false);
+
+  if (pTableMeta == NULL) {
+    return NULL;
+  }
+
+  STableMeta *pCachedMeta = taosCachePut(tscCacheHandle, name, pTableMeta, size, tsTableMetaKeepTimer);
+  free(pTableMeta);
+
+  tscTrace("%p table meta of %s is built from the meta of its super table", pSql, name);
+  return pCachedMeta;
+}
+
+static STableMeta *tscAcquireTableMeta(SSqlObj *pSql, char *name) {
+  STableMeta *pTableMeta = (STableMeta *)taosCacheAcquireByName(tscCacheHandle, name);
+  if (pTableMeta != NULL && tscIsTableMetaOutOfDate(pTableMeta)) {
+    tscTrace("%p table meta of %s is out of date, sversion:%d, tversion:%d, discard it", pSql, name,
+             pTableMeta->sversion, pTableMeta->tversion);
+    taosCacheRelease(tscCacheHandle, (void **)&pTableMeta, true);
+  }
+
+  if (pTableMeta == NULL) {
+    pTableMeta = tscBuildChildTableMeta(pSql, name);
+  }
+
+  return pTableMeta;
+}
+
+static int32_t tscConvertTableMetaMsg(STableMetaMsg *pMetaMsg) {
   pMetaMsg->sid = htonl(pMetaMsg->sid);
   pMetaMsg->sversion = htons(pMetaMsg->sversion);
   pMetaMsg->tversion = htons(pMetaMsg->tversion);
@@ -1659,11 +1819,32 @@ int tscProcessTableMetaRsp(SSqlObj *pSql) {
     pSchema++;
   }
 
+  // the uid of super table follows the schema of child table, it is absent if the mnode is of old version
+  if (pMetaMsg->tableType == TSDB_CHILD_TABLE &&
+      (char *)pSchema + sizeof(uint64_t) <= (char *)pMetaMsg + pMetaMsg->contLen) {
+    uint64_t suid = 0;
+    memcpy(&suid, pSchema, sizeof(suid));
+    suid = htobe64(suid);
+    memcpy(pSchema, &suid, sizeof(suid));
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+int tscProcessTableMetaRsp(SSqlObj *pSql) {
+  STableMetaMsg *pMetaMsg = (STableMetaMsg *)pSql->res.pRsp;
+
+  int32_t code = tscConvertTableMetaMsg(pMetaMsg);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
   size_t size = 0;
   STableMeta* pTableMeta = tscCreateTableMetaFromMsg(pMetaMsg, &size);
-  
+
   // todo add one more function: taosAddDataIfNotExists();
   STableMetaInfo *pTableMetaInfo = tscGetTableMetaInfoFromCmd(&pSql->cmd, 0, 0);
+  tscUpdateSTableVersion(pTableMeta, pTableMetaInfo->name);
   assert(pTableMetaInfo->pTableMeta == NULL);
 
   pTableMetaInfo->pTableMeta =
@@ -1830,6 +2011,111 @@ int tscProcessSTableVgroupRsp(SSqlObj *pSql) {
   return pSql->res.code;
 }
 
+typedef struct SSTableChildrenParam {
+  tsem_t  rspSem;
+  int32_t code;
+  int32_t vgId;         // the position to retrieve the next page, 0 if all child tables are retrieved
+  int32_t sid;
+  int32_t numOfTables;  // the number of child tables in the last page
+} SSTableChildrenParam;
+
+int tscBuildSTableChildrenMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
+  SSqlCmd *pCmd = &pSql->cmd;
+  SSTableChildrenParam *pParam = pSql->param;
+
+  STableMetaInfo *pTableMetaInfo = tscGetTableMetaInfoFromCmd(pCmd, 0, 0);
+
+  SCMSTableChildrenMsg *pChildrenMsg = (SCMSTableChildrenMsg *)pCmd->payload;
+  tstrncpy(pChildrenMsg->tableId, pTableMetaInfo->name, sizeof(pChildrenMsg->tableId));
+  pChildrenMsg->vgId = htonl(pParam->vgId);
+  pChildrenMsg->sid = htonl(pParam->sid);
+  pChildrenMsg->numOfTables = htonl(TSDB_MAX_CHILDREN_PER_PAGE);
+
+  pCmd->msgType = TSDB_MSG_TYPE_CM_STABLE_CHILDREN;
+  pCmd->payloadLen = sizeof(SCMSTableChildrenMsg);
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * the schema of super table is sent once in each page and cached once as the meta of the super table. Only the ids and
+ * versions are cached for every child table, its complete meta is built from the meta of super table when accessed.
+ */
+int tscProcessSTableChildrenRsp(SSqlObj *pSql) {
+  SSqlRes *             pRes = &pSql->res;
+  SSTableChildrenParam *pParam = pSql->param;
+
+  SCMSTableChildrenRsp *pRsp = (SCMSTableChildrenRsp *)pRes->pRsp;
+  int32_t numOfTables = htonl(pRsp->numOfTables);
+  int32_t numOfVgroups = htonl(pRsp->numOfVgroups);
+  int32_t metaLen = htonl(pRsp->metaLen);
+
+  STableMetaMsg *pMetaMsg = (STableMetaMsg *)(pRes->pRsp + sizeof(SCMSTableChildrenRsp));
+  int32_t code = tscConvertTableMetaMsg(pMetaMsg);
+  if (code != TSDB_CODE_SUCCESS) {
+    pRes->code = code;
+    return code;
+  }
+
+  size_t size = 0;
+  STableMeta* pTableMeta = tscCreateTableMetaFromMsg(pMetaMsg, &size);
+
+  STableMetaInfo *pTableMetaInfo = tscGetTableMetaInfoFromCmd(&pSql->cmd, 0, 0);
+  tscUpdateSTableVersion(pTableMeta, pTableMetaInfo->name);
+
+  void *p = taosCachePut(tscCacheHandle, pTableMetaInfo->name, pTableMeta, size, tsTableMetaKeepTimer);
+  taosCacheRelease(tscCacheHandle, &p, false);
+
+  SChildTableMeta child = {
+      .suid = pTableMeta->uid, .sversion = pTableMeta->sversion, .tversion = pTableMeta->tversion};
+  free(pTableMeta);
+
+  SCMVgroupInfo *pVgroups = (SCMVgroupInfo *)((char *)pMetaMsg + metaLen);
+
+  pthread_mutex_lock(&tscSTableVersionMutex);
+  for (int32_t i = 0; i < numOfVgroups; ++i) {
+    pVgroups[i].vgId = htonl(pVgroups[i].vgId);
+    for (int32_t j = 0; j < pVgroups[i].numOfIps; ++j) {
+      pVgroups[i].ipAddr[j].port = htons(pVgroups[i].ipAddr[j].port);
+    }
+
+    taosHashPut(tscVgroupInfos, &pVgroups[i].vgId, sizeof(pVgroups[i].vgId), &pVgroups[i], sizeof(SCMVgroupInfo));
+  }
+  pthread_mutex_unlock(&tscSTableVersionMutex);
+
+  SCMChildTableInfo *pChildren = (SCMChildTableInfo *)(pVgroups + numOfVgroups);
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    int32_t vgIndex = htonl(pChildren[i].vgIndex);
+    if (vgIndex < 0 || vgIndex >= numOfVgroups) {
+      tscError("%p invalid vgroup index:%d of child table:%s", pSql, vgIndex, pChildren[i].tableId);
+      code = TSDB_CODE_TSC_INVALID_VALUE;
+      break;
+    }
+
+    child.sid = htonl(pChildren[i].sid);
+    child.uid = htobe64(pChildren[i].uid);
+    child.vgId = pVgroups[vgIndex].vgId;
+
+    p = taosCachePut(tscChildMetaHandle, pChildren[i].tableId, &child, sizeof(child), tsTableMetaKeepTimer);
+    if (p == NULL) {
+      code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+      break;
+    }
+
+    taosCacheRelease(tscChildMetaHandle, &p, false);
+  }
+
+  pParam->vgId = htonl(pRsp->vgId);
+  pParam->sid = htonl(pRsp->sid);
+  pParam->numOfTables = numOfTables;
+
+  tscTrace("%p recv %d child tables of %s in %d vgroups, next vgId:%d, sid:%d", pSql, numOfTables,
+           pTableMetaInfo->name, numOfVgroups, pParam->vgId, pParam->sid);
+
+  pRes->code = code;
+  return code;
+}
+
 /*
  * current process do not use the cache at all
  */
@@ -1934,12 +2220,16 @@ int tscProcessUseDbRsp(SSqlObj *pSql) {
 
 int tscProcessDropDbRsp(SSqlObj *UNUSED_PARAM(pSql)) {
   taosCacheEmpty(tscCacheHandle);
+  taosCacheEmpty(tscChildMetaHandle);
   return 0;
 }
 
 int tscProcessDropTableRsp(SSqlObj *pSql) {
   STableMetaInfo *pTableMetaInfo = tscGetTableMetaInfoFromCmd(&pSql->cmd, 0, 0);
 
+  SChildTableMeta *pChild = taosCacheAcquireByName(tscChildMetaHandle, pTableMetaInfo->name);
+  taosCacheRelease(tscChildMetaHandle, (void **)&pChild, true);
+
   STableMeta *pTableMeta = taosCacheAcquireByName(tscCacheHandle, pTableMetaInfo->name);
   if (pTableMeta == NULL) {
     /* not in cache, abort */
@@ -1981,6 +2271,7 @@ int tscProcessAlterTableMsgRsp(SSqlObj *pSql) {
     if (isSuperTable) {  // if it is a super table, reset whole query cache
       tscTrace("%p reset query cache since table:%s is stable", pSql, pTableMetaInfo->name);
       taosCacheEmpty(tscCacheHandle);
+      taosCacheEmpty(tscChildMetaHandle);
     }
   }
 
@@ -2004,14 +2295,85 @@ int tscProcessQueryRsp(SSqlObj *pSql) {
   return 0;
 }
 
+/*
+ * the columnar encoded result block is replaced by a response msg in the fixed-width layout, so the column data is
+ * accessed in the same way as the un-encoded one. Each column is decoded by tscDecodeResColumn on its first access,
+ * and the columns which are never accessed are not decoded.
+ */
+static int32_t tscCreateResDecoder(SSqlObj *pSql) {
+  SSqlRes *pRes = &pSql->res;
+
+  SRetrieveTableRsp *pRetrieve = (SRetrieveTableRsp *)pRes->pRsp;
+  int32_t            numOfRows = htonl(pRetrieve->numOfRows);
+  int32_t            inputLen = pRes->rspLen - sizeof(SRetrieveTableRsp);
+
+  int32_t encodedLen = 0;
+  int32_t size = qGetDecodedResultSize(pRetrieve->data, inputLen, numOfRows, &encodedLen);
+  if (size < 0) {
+    tscError("%p invalid encoded result block, rsp len:%d", pSql, pRes->rspLen);
+    return TSDB_CODE_TSC_APP_ERROR;
+  }
+
+  // the info of tables follows the result block, which is kept as is
+  int32_t remain = inputLen - encodedLen;
+  int32_t rspLen = sizeof(SRetrieveTableRsp) + size + remain;
+  int32_t numOfCols = htonl(*(int32_t *)pRetrieve->data);
+
+  SRetrieveTableRsp *pNew = malloc(rspLen);
+  SResDecoder *      pDecoder = calloc(1, sizeof(SResDecoder) + numOfCols * sizeof(SResDecodeCol));
+  if (pNew == NULL || pDecoder == NULL) {
+    tfree(pNew);
+    tfree(pDecoder);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  int32_t inputOffset = sizeof(int32_t);
+  int32_t offset = 0;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    int32_t bytes = 0;
+    pDecoder->cols[i].inputOffset = inputOffset;
+    pDecoder->cols[i].offset = offset;
+
+    inputOffset += qGetEncodedColumnLen(pRetrieve->data + inputOffset, &bytes);
+    offset += bytes;
+  }
+
+  memcpy(pNew, pRetrieve, sizeof(SRetrieveTableRsp));
+  memcpy(pNew->data + size, pRetrieve->data + encodedLen, remain);
+  pNew->compressed = 0;
+
+  pDecoder->pRsp = pRes->pRsp;
+  pDecoder->pOutput = pNew->data;
+  pDecoder->numOfRows = numOfRows;
+  pDecoder->numOfCols = numOfCols;
+
+  tscTrace("%p encoded result block, rows:%d, encoded len:%d, decoded len:%d", pSql, numOfRows, encodedLen, size);
+
+  pRes->pRsp = (char *)pNew;
+  pRes->rspLen = rspLen;
+  pRes->pDecoder = pDecoder;
+  return TSDB_CODE_SUCCESS;
+}
+
 int tscProcessRetrieveRspFromNode(SSqlObj *pSql) {
   SSqlRes *pRes = &pSql->res;
   SSqlCmd *pCmd = &pSql->cmd;
 
+  // the columns of the previous block which are not accessed are discarded
+  tscDestroyResDecoder(pRes);
+
   SRetrieveTableRsp *pRetrieve = (SRetrieveTableRsp *)pRes->pRsp;
+  if (pRetrieve->compressed) {
+    pRes->code = tscCreateResDecoder(pSql);
+    if (pRes->code != TSDB_CODE_SUCCESS) {
+      return pRes->code;
+    }
+
+    pRetrieve = (SRetrieveTableRsp *)pRes->pRsp;
+  }
 
   pRes->numOfRows = htonl(pRetrieve->numOfRows);
-  pRes->precision = htons(pRetrieve->precision);
+  pRes->precision = pRetrieve->precision;
   pRes->offset    = htobe64(pRetrieve->offset);
   pRes->useconds  = htobe64(pRetrieve->useconds);
   pRes->completed = (pRetrieve->completed == 1);
@@ -2065,7 +2427,7 @@ int tscProcessRetrieveRspFromLocal(SSqlObj *pSql) {
 
 void tscTableMetaCallBack(void *param, TAOS_RES *res, int code);
 
-static int32_t getTableMetaFromMgmt(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo) {
+static int32_t getTableMetaFromMgmt(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo, void (*fp)(), void *param) {
   SSqlObj *pNew = calloc(1, sizeof(SSqlObj));
   if (NULL == pNew) {
     tscError("%p malloc failed for new sqlobj to get table meta", pSql);
@@ -2097,15 +2459,15 @@ static int32_t getTableMetaFromMgmt(SSqlObj *pSql, STableMetaInfo *pTableMetaInf
   pNew->cmd.payloadLen = pSql->cmd.payloadLen;
   tscTrace("%p new pSqlObj:%p to get tableMeta, auto create:%d", pSql, pNew, pNew->cmd.autoCreated);
 
-  pNew->fp = tscTableMetaCallBack;
-  pNew->param = pSql;
-
-  int32_t code = tscProcessSql(pNew);
-  if (code == TSDB_CODE_SUCCESS) {
-    code = TSDB_CODE_TSC_ACTION_IN_PROGRESS;  // notify upper application that current process need to be terminated
-  }
+  pNew->fp = fp;
+  pNew->param = param;
 
-  return code;
+  /*
+   * the error of processing the new sql object is also reported by the callback function, so notify upper
+   * application that current process need to be terminated in any case
+   */
+  tscProcessSql(pNew);
+  return TSDB_CODE_TSC_ACTION_IN_PROGRESS;
 }
 
 int32_t tscGetTableMeta(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo) {
@@ -2116,7 +2478,7 @@ int32_t tscGetTableMeta(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo) {
     taosCacheRelease(tscCacheHandle, (void **)&(pTableMetaInfo->pTableMeta), false);
   }
   
-  pTableMetaInfo->pTableMeta = (STableMeta *)taosCacheAcquireByName(tscCacheHandle, pTableMetaInfo->name);
+  pTableMetaInfo->pTableMeta = tscAcquireTableMeta(pSql, pTableMetaInfo->name);
   if (pTableMetaInfo->pTableMeta != NULL) {
     STableComInfo tinfo = tscGetTableInfo(pTableMetaInfo->pTableMeta);
     tscTrace("%p retrieve table Meta from cache, the number of columns:%d, numOfTags:%d, %p", pSql, tinfo.numOfColumns,
@@ -2125,7 +2487,111 @@ int32_t tscGetTableMeta(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo) {
     return TSDB_CODE_SUCCESS;
   }
   
-  return getTableMetaFromMgmt(pSql, pTableMetaInfo);
+  return getTableMetaFromMgmt(pSql, pTableMetaInfo, tscTableMetaCallBack, pSql);
+}
+
+typedef struct SSyncMetaParam {
+  tsem_t  rspSem;
+  int32_t code;
+} SSyncMetaParam;
+
+static void tscSyncTableMetaCallBack(void *param, TAOS_RES *res, int code) {
+  SSyncMetaParam *pParam = (SSyncMetaParam *)param;
+
+  // the sql object of table meta is freed automatically after this callback
+  pParam->code = (code < 0) ? code : TSDB_CODE_SUCCESS;
+  tsem_post(&pParam->rspSem);
+}
+
+int32_t tscGetTableMetaSync(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo) {
+  assert(strlen(pTableMetaInfo->name) != 0);
+
+  if (pTableMetaInfo->pTableMeta != NULL) {
+    taosCacheRelease(tscCacheHandle, (void **)&(pTableMetaInfo->pTableMeta), false);
+  }
+
+  pTableMetaInfo->pTableMeta = tscAcquireTableMeta(pSql, pTableMetaInfo->name);
+  if (pTableMetaInfo->pTableMeta != NULL) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  SSyncMetaParam param = {.code = TSDB_CODE_SUCCESS};
+  tsem_init(&param.rspSem, 0, 0);
+
+  int32_t code = getTableMetaFromMgmt(pSql, pTableMetaInfo, tscSyncTableMetaCallBack, &param);
+  if (code == TSDB_CODE_TSC_ACTION_IN_PROGRESS) {
+    tsem_wait(&param.rspSem);
+    code = param.code;
+  }
+
+  tsem_destroy(&param.rspSem);
+  if (code != TSDB_CODE_SUCCESS) {
+    return code;
+  }
+
+  // the table meta has been put into the local cache by the response of mnode
+  pTableMetaInfo->pTableMeta = (STableMeta *)taosCacheAcquireByName(tscCacheHandle, pTableMetaInfo->name);
+  return (pTableMetaInfo->pTableMeta != NULL) ? TSDB_CODE_SUCCESS : TSDB_CODE_TSC_APP_ERROR;
+}
+
+static void tscSTableChildrenCallBack(void *param, TAOS_RES *res, int code) {
+  SSTableChildrenParam *pParam = (SSTableChildrenParam *)param;
+
+  // the sql object is freed automatically after this callback
+  pParam->code = (code < 0) ? code : TSDB_CODE_SUCCESS;
+  tsem_post(&pParam->rspSem);
+}
+
+int32_t tscLoadSTableChildrenMeta(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo) {
+  assert(strlen(pTableMetaInfo->name) != 0);
+
+  SSTableChildrenParam param = {.code = TSDB_CODE_SUCCESS};
+  tsem_init(&param.rspSem, 0, 0);
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  int64_t numOfTables = 0;
+
+  do {
+    SSqlObj *pNew = calloc(1, sizeof(SSqlObj));
+    if (pNew == NULL) {
+      code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+      break;
+    }
+
+    pNew->pTscObj = pSql->pTscObj;
+    pNew->signature = pNew;
+    pNew->cmd.command = TSDB_SQL_STABLE_CHILDREN;
+
+    SQueryInfo *pNewQueryInfo = NULL;
+    if ((code = tscGetQueryInfoDetailSafely(&pNew->cmd, 0, &pNewQueryInfo)) != TSDB_CODE_SUCCESS ||
+        (code = tscAllocPayload(&pNew->cmd, TSDB_DEFAULT_PAYLOAD_SIZE)) != TSDB_CODE_SUCCESS) {
+      tscFreeSqlObj(pNew);
+      break;
+    }
+
+    STableMetaInfo *pNewMeterMetaInfo = tscAddEmptyMetaInfo(pNewQueryInfo);
+    tstrncpy(pNewMeterMetaInfo->name, pTableMetaInfo->name, sizeof(pNewMeterMetaInfo->name));
+
+    pNew->fp = tscSTableChildrenCallBack;
+    pNew->param = &param;
+    param.numOfTables = 0;
+
+    tscTrace("%p new pSqlObj:%p to get child tables of %s from vgId:%d, sid:%d", pSql, pNew, pTableMetaInfo->name,
+             param.vgId, param.sid);
+
+    // the error is also reported by the callback function
+    tscProcessSql(pNew);
+    tsem_wait(&param.rspSem);
+
+    code = param.code;
+    numOfTables += param.numOfTables;
+  } while (code == TSDB_CODE_SUCCESS && param.vgId != 0);
+
+  tsem_destroy(&param.rspSem);
+
+  tscTrace("%p %" PRId64 " child table metas of %s are loaded, code:%s", pSql, numOfTables, pTableMetaInfo->name,
+           tstrerror(code));
+  return code;
 }
 
 int tscGetMeterMetaEx(SSqlObj *pSql, STableMetaInfo *pTableMetaInfo, bool createIfNotExists) {
@@ -2152,7 +2618,7 @@ int tscRenewTableMeta(SSqlObj *pSql, char *tableId) {
   }
 
   taosCacheRelease(tscCacheHandle, (void **)&(pTableMetaInfo->pTableMeta), true);
-  return getTableMetaFromMgmt(pSql, pTableMetaInfo);
+  return getTableMetaFromMgmt(pSql, pTableMetaInfo, tscTableMetaCallBack, pSql);
 }
 
 static bool allVgroupInfoRetrieved(SSqlCmd* pCmd, int32_t clauseIndex) {
@@ -2242,6 +2708,7 @@ void tscInitMsgsFp() {
   tscBuildMsg[TSDB_SQL_META] = tscBuildTableMetaMsg;
   tscBuildMsg[TSDB_SQL_STABLEVGROUP] = tscBuildSTableVgroupMsg;
   tscBuildMsg[TSDB_SQL_MULTI_META] = tscBuildMultiMeterMetaMsg;
+  tscBuildMsg[TSDB_SQL_STABLE_CHILDREN] = tscBuildSTableChildrenMsg;
 
   tscBuildMsg[TSDB_SQL_HB] = tscBuildHeartBeatMsg;
   tscBuildMsg[TSDB_SQL_SHOW] = tscBuildShowMsg;
@@ -2260,6 +2727,7 @@ void tscInitMsgsFp() {
   tscProcessMsgRsp[TSDB_SQL_META] = tscProcessTableMetaRsp;
   tscProcessMsgRsp[TSDB_SQL_STABLEVGROUP] = tscProcessSTableVgroupRsp;
   tscProcessMsgRsp[TSDB_SQL_MULTI_META] = tscProcessMultiMeterMetaRsp;
+  tscProcessMsgRsp[TSDB_SQL_STABLE_CHILDREN] = tscProcessSTableChildrenRsp;
 
   tscProcessMsgRsp[TSDB_SQL_SHOW] = tscProcessShowRsp;
   tscProcessMsgRsp[TSDB_SQL_RETRIEVE] = tscProcessRetrieveRspFromNode;  // rsp handled by same function.
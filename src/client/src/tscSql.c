@@ -370,6 +370,25 @@ int taos_fetch_block_impl(TAOS_RES *res, TAOS_ROW *rows) {
   return (pQueryInfo->order.order == TSDB_ORDER_DESC) ? pRes->numOfRows : -pRes->numOfRows;
 }
 
+static bool tscNeedFetchMore(SSqlObj *pSql) {
+  SSqlCmd *pCmd = &pSql->cmd;
+  SSqlRes *pRes = &pSql->res;
+
+  return (pRes->completed != true || hasMoreVnodesToTry(pSql)) &&
+         (pCmd->command == TSDB_SQL_RETRIEVE ||
+          pCmd->command == TSDB_SQL_RETRIEVE_LOCALMERGE ||
+          pCmd->command == TSDB_SQL_TABLE_JOIN_RETRIEVE ||
+          pCmd->command == TSDB_SQL_FETCH ||
+          pCmd->command == TSDB_SQL_SHOW ||
+          pCmd->command == TSDB_SQL_SELECT ||
+          pCmd->command == TSDB_SQL_DESCRIBE_TABLE ||
+          pCmd->command == TSDB_SQL_SERV_STATUS ||
+          pCmd->command == TSDB_SQL_CURRENT_DB ||
+          pCmd->command == TSDB_SQL_SERV_VERSION ||
+          pCmd->command == TSDB_SQL_CLI_VERSION ||
+          pCmd->command == TSDB_SQL_CURRENT_USER);
+}
+
 TAOS_ROW taos_fetch_row(TAOS_RES *res) {
   SSqlObj *pSql = (SSqlObj *)res;
   if (pSql == NULL || pSql->signature != pSql) {
@@ -387,19 +406,7 @@ TAOS_ROW taos_fetch_row(TAOS_RES *res) {
   }
   
   // current data set are exhausted, fetch more data from node
-  if (pRes->row >= pRes->numOfRows && (pRes->completed != true || hasMoreVnodesToTry(pSql)) &&
-      (pCmd->command == TSDB_SQL_RETRIEVE ||
-       pCmd->command == TSDB_SQL_RETRIEVE_LOCALMERGE ||
-       pCmd->command == TSDB_SQL_TABLE_JOIN_RETRIEVE ||
-       pCmd->command == TSDB_SQL_FETCH ||
-       pCmd->command == TSDB_SQL_SHOW ||
-       pCmd->command == TSDB_SQL_SELECT ||
-       pCmd->command == TSDB_SQL_DESCRIBE_TABLE ||
-       pCmd->command == TSDB_SQL_SERV_STATUS ||
-       pCmd->command == TSDB_SQL_CURRENT_DB ||
-       pCmd->command == TSDB_SQL_SERV_VERSION ||
-       pCmd->command == TSDB_SQL_CLI_VERSION ||
-       pCmd->command == TSDB_SQL_CURRENT_USER )) {
+  if (pRes->row >= pRes->numOfRows && tscNeedFetchMore(pSql)) {
     taos_fetch_rows_a(res, waitForRetrieveRsp, pSql->pTscObj);
     sem_wait(&pSql->rspSem);
   }
@@ -407,6 +414,94 @@ TAOS_ROW taos_fetch_row(TAOS_RES *res) {
   return doSetResultRowData(pSql, true);
 }
 
+// the values are copied row by row if they are not located in the retrieved block, like the results of join
+static int tscCopyResultRows(SSqlObj *pSql, TAOS_COLUMN_BIND *columns) {
+  SSqlCmd *pCmd = &pSql->cmd;
+  SSqlRes *pRes = &pSql->res;
+
+  SQueryInfo *pQueryInfo = tscGetQueryInfoDetail(pCmd, pCmd->clauseIndex);
+  int32_t     code = tscCreateResBlock(pRes, pQueryInfo, TSDB_RES_BLOCK_ROWS, true);
+  if (code != TSDB_CODE_SUCCESS) {
+    pRes->code = code;
+    return 0;
+  }
+
+  SResBlock * pBlock = pRes->pBlock;
+  TAOS_FIELD *fields = taos_fetch_fields(pSql);
+  int         numOfFields = taos_num_fields(pSql);
+  int         numOfRows = 0;
+
+  TAOS_ROW row = NULL;
+  while (numOfRows < TSDB_RES_BLOCK_ROWS && (row = taos_fetch_row(pSql)) != NULL) {
+    int *length = taos_fetch_lengths(pSql);
+
+    for (int i = 0; i < numOfFields; ++i) {
+      char *pDest = pBlock->data[i] + numOfRows * fields[i].bytes;
+      bool  isVar = (fields[i].type == TSDB_DATA_TYPE_BINARY || fields[i].type == TSDB_DATA_TYPE_NCHAR);
+
+      pBlock->isNull[i][numOfRows] = (row[i] == NULL);
+      if (row[i] == NULL) {
+        if (isVar) pBlock->length[i][numOfRows] = 0;
+      } else if (isVar) {
+        int32_t len = MIN(length[i], fields[i].bytes);
+        memcpy(pDest, row[i], len);
+        pBlock->length[i][numOfRows] = len;
+      } else {
+        memcpy(pDest, row[i], fields[i].bytes);
+      }
+    }
+
+    numOfRows++;
+  }
+
+  for (int i = 0; i < numOfFields && numOfRows > 0; ++i) {
+    bool isVar = (fields[i].type == TSDB_DATA_TYPE_BINARY || fields[i].type == TSDB_DATA_TYPE_NCHAR);
+
+    columns[i].buffer_type = fields[i].type;
+    columns[i].buffer = pBlock->data[i];
+    columns[i].buffer_length = fields[i].bytes;
+    columns[i].length = isVar ? pBlock->length[i] : NULL;
+    columns[i].is_null = pBlock->isNull[i];
+  }
+
+  return numOfRows;
+}
+
+int taos_fetch_block_columns(TAOS_RES *res, TAOS_COLUMN_BIND *columns) {
+  SSqlObj *pSql = (SSqlObj *)res;
+  if (pSql == NULL || pSql->signature != pSql) {
+    terrno = TSDB_CODE_TSC_DISCONNECTED;
+    return 0;
+  }
+
+  SSqlCmd *pCmd = &pSql->cmd;
+  SSqlRes *pRes = &pSql->res;
+
+  if (pRes->qhandle == 0 ||
+      pCmd->command == TSDB_SQL_RETRIEVE_EMPTY_RESULT ||
+      pCmd->command == TSDB_SQL_INSERT) {
+    return 0;
+  }
+
+  SQueryInfo *pQueryInfo = tscGetQueryInfoDetail(pCmd, pCmd->clauseIndex);
+  bool        inPlace = (pCmd->command != TSDB_SQL_TABLE_JOIN_RETRIEVE);
+  for (int32_t i = 0; inPlace && i < tscNumOfFields(pQueryInfo); ++i) {
+    SFieldSupInfo *pSup = tscFieldInfoGetSupp(&pQueryInfo->fieldsInfo, i);
+    inPlace = (pSup->pSqlExpr != NULL || pSup->pArithExprInfo != NULL);
+  }
+
+  if (!inPlace) {
+    return tscCopyResultRows(pSql, columns);
+  }
+
+  if (pRes->row >= pRes->numOfRows && tscNeedFetchMore(pSql)) {
+    taos_fetch_rows_a(res, waitForRetrieveRsp, pSql->pTscObj);
+    sem_wait(&pSql->rspSem);
+  }
+
+  return doSetResultBlockData(pSql, columns);
+}
+
 int taos_fetch_block(TAOS_RES *res, TAOS_ROW *rows) {
 #if 0
   SSqlObj *pSql = (SSqlObj *)res;
@@ -514,6 +609,12 @@ void taos_free_result(TAOS_RES *res) {
     return;
   }
   
+  // the super table query is freed by the last sub-query, if any of them are still retrieving for streaming merge
+  if (!tscReleaseSTableSubqueries(pSql)) {
+    tscTrace("%p sqlObj will be freed after sub-queries are released", pSql);
+    return;
+  }
+
   // The semaphore can not be changed while freeing async sub query objects.
   SSqlRes *pRes = &pSql->res;
   if (pRes == NULL || pRes->qhandle == 0) {
@@ -891,3 +992,50 @@ int taos_load_table_info(TAOS *taos, const char *tableNameList) {
 
   return pRes->code;
 }
+
+int taos_load_stable_meta(TAOS *taos, const char *stable_name) {
+  STscObj *pObj = (STscObj *)taos;
+  if (pObj == NULL || pObj->signature != pObj) {
+    terrno = TSDB_CODE_TSC_DISCONNECTED;
+    return TSDB_CODE_TSC_DISCONNECTED;
+  }
+
+  if (stable_name == NULL) {
+    terrno = TSDB_CODE_TSC_INVALID_VALUE;
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  SSqlObj* pSql = calloc(1, sizeof(SSqlObj));
+  if (pSql == NULL) {
+    terrno = TSDB_CODE_TSC_OUT_OF_MEMORY;
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  tsem_init(&pSql->rspSem, 0, 0);
+  pSql->signature = pSql;
+  pSql->pTscObj = pObj;
+
+  char           buf[TSDB_TABLE_ID_LEN] = {0};
+  SSQLToken      sToken = {.z = buf, .n = (uint32_t)strnlen(stable_name, TSDB_TABLE_ID_LEN), .type = TK_ID};
+  STableMetaInfo tableMetaInfo = {0};
+
+  int32_t code = TSDB_CODE_TSC_INVALID_TABLE_ID_LENGTH;
+  if (sToken.n > 0 && sToken.n < TSDB_TABLE_ID_LEN) {
+    strtolower(buf, stable_name);
+    code = tscAllocPayload(&pSql->cmd, TSDB_DEFAULT_PAYLOAD_SIZE);
+  }
+
+  if (code == TSDB_CODE_SUCCESS) {
+    code = tscSetTableFullName(&tableMetaInfo, &sToken, pSql);
+  }
+
+  if (code == TSDB_CODE_SUCCESS) {
+    code = tscLoadSTableChildrenMeta(pSql, &tableMetaInfo);
+  }
+
+  tscTrace("%p load child table metas of %s, code:%s pObj:%p", pSql, stable_name, tstrerror(code), pObj);
+  tscFreeSqlObj(pSql);
+
+  terrno = code;
+  return code;
+}
@@ -671,6 +671,7 @@ static void tidTagRetrieveCallback(void* param, TAOS_RES* tres, int32_t numOfRow
 
     pSupporter->pIdTagList = tmp;
 
+    tscDecodeResBlock(pRes);
     memcpy(pSupporter->pIdTagList + pSupporter->totalLen, pRes->data, validLen);
     pSupporter->totalLen += validLen;
     pSupporter->num += pRes->numOfRows;
@@ -767,6 +768,7 @@ static void tsCompRetrieveCallback(void* param, TAOS_RES* tres, int32_t numOfRow
   }
 
   if (numOfRows > 0) {  // write the compressed timestamp to disk file
+    tscDecodeResBlock(pRes);
     fwrite(pRes->data, pRes->numOfRows, 1, pSupporter->f);
     fclose(pSupporter->f);
     pSupporter->f = NULL;
@@ -1337,8 +1339,6 @@ static void doCleanupSubqueries(SSqlObj *pSql, int32_t numOfSubs, SSubqueryState
     
     SRetrieveSupport* pSupport = pSub->param;
     
-    tfree(pSupport->localBuffer);
-    
     pthread_mutex_unlock(&pSupport->queryMutex);
     pthread_mutex_destroy(&pSupport->queryMutex);
     
@@ -1360,7 +1360,7 @@ int32_t tscHandleMasterSTableQuery(SSqlObj *pSql) {
     return pRes->code;
   }
   
-  tExtMemBuffer **  pMemoryBuf = NULL;
+  SLocalDataBuf **  pDataBuf = NULL;
   tOrderDescriptor *pDesc = NULL;
   SColumnModel *    pModel = NULL;
   
@@ -1374,11 +1374,11 @@ int32_t tscHandleMasterSTableQuery(SSqlObj *pSql) {
   pSql->numOfSubs = pTableMetaInfo->vgroupList->numOfVgroups;
   assert(pSql->numOfSubs > 0);
   
-  int32_t ret = tscLocalReducerEnvCreate(pSql, &pMemoryBuf, &pDesc, &pModel, nBufferSize);
+  int32_t ret = tscLocalReducerEnvCreate(pSql, &pDataBuf, &pDesc, &pModel, nBufferSize);
   if (ret != 0) {
     pRes->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
     tscQueueAsyncRes(pSql);
-    tfree(pMemoryBuf);
+    tfree(pDataBuf);
     return ret;
   }
   
@@ -1399,17 +1399,10 @@ int32_t tscHandleMasterSTableQuery(SSqlObj *pSql) {
       break;
     }
     
-    trs->pExtMemBuffer = pMemoryBuf;
+    trs->pLocalDataBuf = pDataBuf;
     trs->pOrderDescriptor = pDesc;
     trs->pState = pState;
     
-    trs->localBuffer = (tFilePage *)calloc(1, nBufferSize + sizeof(tFilePage));
-    if (trs->localBuffer == NULL) {
-      tscError("%p failed to malloc buffer for local buffer, orderOfSub:%d, reason:%s", pSql, i, strerror(errno));
-      tfree(trs);
-      break;
-    }
-    
     trs->subqueryIndex = i;
     trs->pParentSqlObj = pSql;
     trs->pFinalColModel = pModel;
@@ -1424,7 +1417,6 @@ int32_t tscHandleMasterSTableQuery(SSqlObj *pSql) {
     SSqlObj *pNew = tscCreateSqlObjForSubquery(pSql, trs, NULL);
     if (pNew == NULL) {
       tscError("%p failed to malloc buffer for subObj, orderOfSub:%d, reason:%s", pSql, i, strerror(errno));
-      tfree(trs->localBuffer);
       tfree(trs);
       break;
     }
@@ -1443,13 +1435,13 @@ int32_t tscHandleMasterSTableQuery(SSqlObj *pSql) {
     tscError("%p failed to prepare subquery structure and launch subqueries", pSql);
     pRes->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
     
-    tscLocalReducerEnvDestroy(pMemoryBuf, pDesc, pModel, pSql->numOfSubs);
+    tscLocalReducerEnvDestroy(pDataBuf, pDesc, pModel, pSql->numOfSubs);
     doCleanupSubqueries(pSql, i, pState);
     return pRes->code;   // free all allocated resource
   }
   
   if (pRes->code == TSDB_CODE_TSC_QUERY_CANCELLED) {
-    tscLocalReducerEnvDestroy(pMemoryBuf, pDesc, pModel, pSql->numOfSubs);
+    tscLocalReducerEnvDestroy(pDataBuf, pDesc, pModel, pSql->numOfSubs);
     doCleanupSubqueries(pSql, i, pState);
     return pRes->code;
   }
@@ -1472,8 +1464,6 @@ static void tscFreeSubSqlObj(SRetrieveSupport *trsupport, SSqlObj *pSql) {
     taos_free_result(pSql);
   }
   
-  tfree(trsupport->localBuffer);
-  
   pthread_mutex_unlock(&trsupport->queryMutex);
   pthread_mutex_destroy(&trsupport->queryMutex);
   
@@ -1483,6 +1473,212 @@ static void tscFreeSubSqlObj(SRetrieveSupport *trsupport, SSqlObj *pSql) {
 static void tscRetrieveFromDnodeCallBack(void *param, TAOS_RES *tres, int numOfRows);
 static void tscHandleSubqueryError(SRetrieveSupport *trsupport, SSqlObj *pSql, int numOfRows);
 
+void tscResumeRetrieveFromDnode(SSqlObj *pSql, int32_t subqueryIndex) {
+  SSqlObj *         pSub = pSql->pSubs[subqueryIndex];
+  SRetrieveSupport *trsupport = pSub->param;
+
+  // the query is failed or cancelled while the fetch is paused, abort the retrieval directly
+  if (pSql->res.code != TSDB_CODE_SUCCESS) {
+    tscRetrieveFromDnodeCallBack(trsupport, pSub, 0);
+  } else {
+    tscTrace("%p sub:%p resume retrieve, orderOfSub:%d", pSql, pSub, subqueryIndex);
+    taos_fetch_rows_a(pSub, tscRetrieveFromDnodeCallBack, trsupport);
+  }
+}
+
+static void tscResumePausedSubqueries(SSqlObj *pSql, SLocalDataBuf **pDataBuf, int32_t numOfBuffer) {
+  for (int32_t i = 0; i < numOfBuffer; ++i) {
+    bool resume = false;
+
+    pthread_mutex_lock(&pDataBuf[i]->mutex);
+    if (pDataBuf[i]->paused) {
+      pDataBuf[i]->paused = false;
+      resume = true;
+    }
+    pthread_mutex_unlock(&pDataBuf[i]->mutex);
+
+    if (resume) {
+      tscResumeRetrieveFromDnode(pSql, i);
+    }
+  }
+}
+
+bool tscReleaseSTableSubqueries(SSqlObj *pSql) {
+  SLocalReducer *pLocalReducer = pSql->res.pLocalReducer;
+  if (pLocalReducer == NULL || pLocalReducer->pState == NULL) {
+    return true;
+  }
+
+  SSubqueryState *pState = pLocalReducer->pState;
+  atomic_val_compare_exchange_32(&pSql->res.code, TSDB_CODE_SUCCESS, TSDB_CODE_TSC_QUERY_CANCELLED);
+
+  // the merge is not resumed by the sub-queries any more, and the paused ones abort the retrieval
+  for (int32_t i = 0; i < pLocalReducer->numOfVnode; ++i) {
+    SLocalDataBuf *pDataBuf = pLocalReducer->pLocalDataBuf[i];
+
+    pthread_mutex_lock(&pDataBuf->mutex);
+    pDataBuf->waiting = false;
+    pthread_mutex_unlock(&pDataBuf->mutex);
+  }
+
+  tscResumePausedSubqueries(pSql, pLocalReducer->pLocalDataBuf, pLocalReducer->numOfVnode);
+
+  int32_t remain = atomic_sub_fetch_32(&pState->numOfRemain, 1);
+  if (remain > 0) {
+    tscTrace("%p %d subqueries are still retrieving, free it after they are released", pSql, remain);
+    return false;
+  }
+
+  return true;
+}
+
+/*
+ * the first page of vnode is queued, or it has no results at all.
+ * @return true if the buffers of all vnodes are ready, so that the streaming merge can start
+ */
+static bool tscSetLocalDataBufReady(SRetrieveSupport *trsupport) {
+  SLocalDataBuf *pDataBuf = trsupport->pLocalDataBuf[trsupport->subqueryIndex];
+  if (pDataBuf->ready) {
+    return false;
+  }
+
+  pDataBuf->ready = true;
+  return atomic_add_fetch_32(&trsupport->pState->numOfReady, 1) == trsupport->pState->numOfTotal;
+}
+
+/*
+ * start the streaming merge, while the sub-queries are still retrieving. The first block of results is returned to
+ * app without waiting for all vnodes, and the reducer holds one of numOfRemain until the query is freed by app.
+ */
+static void tscStartStreamMerge(SRetrieveSupport *trsupport, SSqlObj *pSql) {
+  SSqlObj *       pPObj = trsupport->pParentSqlObj;
+  SSubqueryState *pState = trsupport->pState;
+
+  // the failure is reported by the last sub-query
+  if (pPObj->res.code != TSDB_CODE_SUCCESS) {
+    return;
+  }
+
+  tscTrace("%p first pages of %d vnodes retrieved, NumOfRows:%" PRId64 ", start to merge as they arrive", pPObj,
+           pState->numOfTotal, pState->numOfRetrievedRows);
+
+  SQueryInfo *pPQueryInfo = tscGetQueryInfoDetail(&pPObj->cmd, 0);
+  tscClearInterpInfo(pPQueryInfo);
+
+  tscCreateLocalReducer(trsupport->pLocalDataBuf, pState->numOfTotal, trsupport->pOrderDescriptor,
+                        trsupport->pFinalColModel, pPObj);
+
+  SLocalReducer *pLocalReducer = pPObj->res.pLocalReducer;
+  if (pLocalReducer == NULL) {
+    // no results at all, or failed to create the reducer, the paused sub-queries need to abort
+    if (pPObj->res.code != TSDB_CODE_SUCCESS) {
+      tscResumePausedSubqueries(pPObj, trsupport->pLocalDataBuf, pState->numOfTotal);
+    }
+
+    return;
+  }
+
+  pState->merging = true;
+  atomic_add_fetch_32(&pState->numOfRemain, 1);
+  pLocalReducer->pState = pState;
+
+  pPObj->res.precision = pSql->res.precision;
+  pPObj->res.numOfRows = 0;
+  pPObj->res.row = 0;
+
+  pPObj->cmd.command = TSDB_SQL_RETRIEVE_LOCALMERGE;
+  (*pPObj->fp)(pPObj->param, pPObj, 0);
+}
+
+/*
+ * the sub-query of streaming merge is completed or failed. It is freed before it is counted, since the super table
+ * query may be released once all sub-queries are done.
+ */
+static void tscStreamSubqueryDone(SRetrieveSupport *trsupport, SSqlObj *pSql, bool resumeMerge) {
+  SSqlObj *         pPObj = trsupport->pParentSqlObj;
+  SSubqueryState *  pState = trsupport->pState;
+  SLocalDataBuf **  pDataBuf = trsupport->pLocalDataBuf;
+  tOrderDescriptor *pDesc = trsupport->pOrderDescriptor;
+  SColumnModel *    pFinalModel = trsupport->pFinalColModel;
+  int32_t           idx = trsupport->subqueryIndex;
+
+  tscFreeSubSqlObj(trsupport, pSql);
+
+  // the merge is suspended to wait for this vnode, resume it to take the remain pages or the error
+  if (resumeMerge) {
+    tscProcessSql(pPObj);
+  }
+
+  int32_t remain = -1;
+  if ((remain = atomic_sub_fetch_32(&pState->numOfRemain, 1)) > 0) {
+    tscTrace("%p sub:%p orderOfSub:%d freed, finished subqueries:%d", pPObj, pSql, idx, pState->numOfTotal - remain);
+    return;
+  }
+
+  // the super table query has been freed by app, and it is released with the buffers now
+  if (pState->merging) {
+    tscTrace("%p all subqueries are released, free the super table query", pPObj);
+    tscFreeSqlObj(pPObj);
+    return;
+  }
+
+  tscTrace("%p retrieve from %d vnodes completed, code:%s", pPObj, pState->numOfTotal, tstrerror(pPObj->res.code));
+
+  tscLocalReducerEnvDestroy(pDataBuf, pDesc, pFinalModel, pState->numOfTotal);
+  tfree(pState);
+
+  pPObj->res.numOfRows = 0;
+  pPObj->res.row = 0;
+
+  pPObj->cmd.command = TSDB_SQL_RETRIEVE_LOCALMERGE;
+  if (pPObj->res.code == TSDB_CODE_SUCCESS) {
+    (*pPObj->fp)(pPObj->param, pPObj, 0);
+  } else {
+    tscQueueAsyncRes(pPObj);
+  }
+}
+
+/*
+ * the block retrieved from vnode is queued for the streaming merge. The fetch from vnode is paused if the merge falls
+ * behind, and resumed by the merge once it takes the queued page.
+ */
+static void tscStreamRetrieveFromDnode(SRetrieveSupport *trsupport, SSqlObj *pSql) {
+  SSqlObj *      pPObj = trsupport->pParentSqlObj;
+  int32_t        idx = trsupport->subqueryIndex;
+  SLocalDataBuf *pDataBuf = trsupport->pLocalDataBuf[idx];
+
+  if (tscSetLocalDataBufReady(trsupport)) {
+    tscStartStreamMerge(trsupport, pSql);
+  }
+
+  /*
+   * if the merge is suspended to wait for this vnode, the fetch goes on after the merge is resumed. Otherwise, this
+   * sub-query may be resumed and released by the merge at any time once it is paused.
+   */
+  pthread_mutex_lock(&pDataBuf->mutex);
+
+  bool waiting = pDataBuf->waiting;
+  pDataBuf->waiting = false;
+  pDataBuf->paused = (!waiting && taosArrayGetSize(pDataBuf->pPageList) >= pDataBuf->maxPages);
+
+  bool paused = pDataBuf->paused;
+  pthread_mutex_unlock(&pDataBuf->mutex);
+
+  pthread_mutex_unlock(&trsupport->queryMutex);
+
+  if (paused) {
+    tscTrace("%p sub:%p retrieve is paused, %d pages in queue at least, orderOfSub:%d", pPObj, pSql,
+             pDataBuf->maxPages, idx);
+    return;
+  }
+
+  if (waiting) {
+    tscProcessSql(pPObj);
+  }
+
+  taos_fetch_rows_a(pSql, tscRetrieveFromDnodeCallBack, trsupport);
+}
+
 static void tscAbortFurtherRetryRetrieval(SRetrieveSupport *trsupport, TAOS_RES *tres, int32_t code) {
 // set no disk space error info
 #ifdef WINDOWS
@@ -1506,12 +1702,13 @@ static void tscAbortFurtherRetryRetrieval(SRetrieveSupport *trsupport, TAOS_RES
 }
 
 void tscHandleSubqueryError(SRetrieveSupport *trsupport, SSqlObj *pSql, int numOfRows) {
-  SSqlObj *pParentSql = trsupport->pParentSqlObj;
-  int32_t  subqueryIndex = trsupport->subqueryIndex;
+  SSqlObj *      pParentSql = trsupport->pParentSqlObj;
+  int32_t        subqueryIndex = trsupport->subqueryIndex;
+  SLocalDataBuf *pDataBuf = trsupport->pLocalDataBuf[subqueryIndex];
   
   assert(pSql != NULL);
   SSubqueryState* pState = trsupport->pState;
-  assert(pState->numOfRemain <= pState->numOfTotal && pState->numOfRemain >= 0 && pParentSql->numOfSubs == pState->numOfTotal);
+  assert(pState->numOfRemain <= pState->numOfTotal + pState->merging && pState->numOfRemain >= 0 && pParentSql->numOfSubs == pState->numOfTotal);
   
   // retrieved in subquery failed. OR query cancelled in retrieve phase.
   if (taos_errno(pSql) == TSDB_CODE_SUCCESS && pParentSql->res.code != TSDB_CODE_SUCCESS) {
@@ -1531,15 +1728,15 @@ void tscHandleSubqueryError(SRetrieveSupport *trsupport, SSqlObj *pSql, int numO
     tscError("%p sub:%p abort further retrieval due to other queries failure,orderOfSub:%d,code:%d", pParentSql, pSql,
              subqueryIndex, pParentSql->res.code);
   } else {
-    if (trsupport->numOfRetry++ < MAX_NUM_OF_SUBQUERY_RETRY && pParentSql->res.code == TSDB_CODE_SUCCESS) {
+    // the results of vnode can not be retrieved again, if any of them have been merged
+    bool retry = (!pDataBuf->stream || pDataBuf->numOfElems == 0);
+
+    if (retry && trsupport->numOfRetry++ < MAX_NUM_OF_SUBQUERY_RETRY && pParentSql->res.code == TSDB_CODE_SUCCESS) {
       /*
        * current query failed, and the retry count is less than the available
        * count, retry query clear previous retrieved data, then launch a new sub query
        */
-      tExtMemBufferClear(trsupport->pExtMemBuffer[subqueryIndex]);
-      
-      // clear local saved number of results
-      trsupport->localBuffer->num = 0;
+      tscClearLocalDataBuf(trsupport->pLocalDataBuf[subqueryIndex]);
       pthread_mutex_unlock(&trsupport->queryMutex);
       
       tscTrace("%p sub:%p retrieve failed, code:%s, orderOfSub:%d, retry:%d", trsupport->pParentSqlObj, pSql,
@@ -1564,6 +1761,14 @@ void tscHandleSubqueryError(SRetrieveSupport *trsupport, SSqlObj *pSql, int numO
     }
   }
 
+  // the merge gets the error once it reaches this vnode, and the paused sub-queries abort the retrieval as well
+  if (pDataBuf->stream) {
+    bool waiting = tscSetLocalDataBufCompleted(pDataBuf, pParentSql->res.code);
+    tscResumePausedSubqueries(pParentSql, trsupport->pLocalDataBuf, pState->numOfTotal);
+
+    return tscStreamSubqueryDone(trsupport, pSql, waiting);
+  }
+
   int32_t remain = -1;
   if ((remain = atomic_sub_fetch_32(&pState->numOfRemain, 1)) > 0) {
     tscTrace("%p sub:%p orderOfSub:%d freed, finished subqueries:%d", pParentSql, pSql, trsupport->subqueryIndex,
@@ -1577,7 +1782,7 @@ void tscHandleSubqueryError(SRetrieveSupport *trsupport, SSqlObj *pSql, int numO
       tstrerror(pParentSql->res.code));
 
   // release allocated resource
-  tscLocalReducerEnvDestroy(trsupport->pExtMemBuffer, trsupport->pOrderDescriptor, trsupport->pFinalColModel,
+  tscLocalReducerEnvDestroy(trsupport->pLocalDataBuf, trsupport->pOrderDescriptor, trsupport->pFinalColModel,
                             pState->numOfTotal);
   
   tfree(trsupport->pState);
@@ -1605,35 +1810,27 @@ static void tscAllDataRetrievedFromDnode(SRetrieveSupport *trsupport, SSqlObj* p
   
   STableMetaInfo* pTableMetaInfo = pQueryInfo->pTableMetaInfo[0];
   
-  // data in from current vnode is stored in cache and disk
-  uint32_t numOfRowsFromSubquery = trsupport->pExtMemBuffer[idx]->numOfTotalElems + trsupport->localBuffer->num;
-    tscTrace("%p sub:%p all data retrieved from ip:%s, vgId:%d, numOfRows:%d, orderOfSub:%d", pPObj, pSql,
-        pTableMetaInfo->vgroupList->vgroups[0].ipAddr[0].fqdn, pTableMetaInfo->vgroupList->vgroups[0].vgId,
-        numOfRowsFromSubquery, idx);
-  
-  tColModelCompact(pDesc->pColumnModel, trsupport->localBuffer, pDesc->pColumnModel->capacity);
+  // data in from current vnode is stored in memory, and on disk if the memory budget is used up
+  SLocalDataBuf *pDataBuf = trsupport->pLocalDataBuf[idx];
+  tscTrace("%p sub:%p all data retrieved from ip:%s, vgId:%d, numOfRows:%" PRId64 ", orderOfSub:%d", pPObj, pSql,
+           pTableMetaInfo->vgroupList->vgroups[0].ipAddr[0].fqdn, pTableMetaInfo->vgroupList->vgroups[0].vgId,
+           pDataBuf->numOfElems, idx);
 
-#ifdef _DEBUG_VIEW
-  printf("%" PRIu64 " rows data flushed to disk:\n", trsupport->localBuffer->num);
-    SSrcColumnInfo colInfo[256] = {0};
-    tscGetSrcColumnInfo(colInfo, pQueryInfo);
-    tColModelDisplayEx(pDesc->pColumnModel, trsupport->localBuffer->data, trsupport->localBuffer->num,
-                       trsupport->localBuffer->num, colInfo);
-#endif
-  
-  if (tsTotalTmpDirGB != 0 && tsAvailTmpDirGB < tsMinimalTmpDirGB) {
-    tscError("%p sub:%p client disk space remain %.3f GB, need at least %.3f GB, stop query", pPObj, pSql,
-             tsAvailTmpDirGB, tsMinimalTmpDirGB);
-    tscAbortFurtherRetryRetrieval(trsupport, pSql, TSDB_CODE_TSC_NO_DISKSPACE);
-    return;
-  }
-  
-  // each result for a vnode is ordered as an independant list,
-  // then used as an input of loser tree for disk-based merge routine
-  int32_t code = tscFlushTmpBuffer(trsupport->pExtMemBuffer[idx], pDesc, trsupport->localBuffer, pQueryInfo->groupbyExpr.orderType);
+  // each result for a vnode is ordered as several sorted runs,
+  // then each run is used as an input of loser tree for the merge routine
+  int32_t code = tscFlushTmpBuffer(pDataBuf, pDesc, pQueryInfo->groupbyExpr.orderType);
   if (code != 0) { // set no disk space error info, and abort retry
     return tscAbortFurtherRetryRetrieval(trsupport, pSql, code);
   }
+
+  if (pDataBuf->stream) {
+    bool waiting = tscSetLocalDataBufCompleted(pDataBuf, TSDB_CODE_SUCCESS);
+    if (tscSetLocalDataBufReady(trsupport)) {
+      tscStartStreamMerge(trsupport, pSql);
+    }
+
+    return tscStreamSubqueryDone(trsupport, pSql, waiting);
+  }
   
   int32_t remain = -1;
   if ((remain = atomic_sub_fetch_32(&pState->numOfRemain, 1)) > 0) {
@@ -1644,7 +1841,7 @@ static void tscAllDataRetrievedFromDnode(SRetrieveSupport *trsupport, SSqlObj* p
   }
   
   // all sub-queries are returned, start to local merge process
-  pDesc->pColumnModel->capacity = trsupport->pExtMemBuffer[idx]->numOfElemsPerPage;
+  pDesc->pColumnModel->capacity = pDataBuf->pExtMemBuffer->numOfElemsPerPage;
   
   tscTrace("%p retrieve from %d vnodes completed.final NumOfRows:%" PRId64 ",start to build loser tree", pPObj,
            pState->numOfTotal, pState->numOfRetrievedRows);
@@ -1652,7 +1849,7 @@ static void tscAllDataRetrievedFromDnode(SRetrieveSupport *trsupport, SSqlObj* p
   SQueryInfo *pPQueryInfo = tscGetQueryInfoDetail(&pPObj->cmd, 0);
   tscClearInterpInfo(pPQueryInfo);
   
-  tscCreateLocalReducer(trsupport->pExtMemBuffer, pState->numOfTotal, pDesc, trsupport->pFinalColModel, pPObj);
+  tscCreateLocalReducer(trsupport->pLocalDataBuf, pState->numOfTotal, pDesc, trsupport->pFinalColModel, pPObj);
   tscTrace("%p build loser tree completed", pPObj);
   
   pPObj->res.precision = pSql->res.precision;
@@ -1685,7 +1882,7 @@ static void tscRetrieveFromDnodeCallBack(void *param, TAOS_RES *tres, int numOfR
   }
   
   SSubqueryState* pState = trsupport->pState;
-  assert(pState->numOfRemain <= pState->numOfTotal && pState->numOfRemain >= 0 && pPObj->numOfSubs == pState->numOfTotal);
+  assert(pState->numOfRemain <= pState->numOfTotal + pState->merging && pState->numOfRemain >= 0 && pPObj->numOfSubs == pState->numOfTotal);
   
   // query process and cancel query process may execute at the same time
   pthread_mutex_lock(&trsupport->queryMutex);
@@ -1711,6 +1908,8 @@ static void tscRetrieveFromDnodeCallBack(void *param, TAOS_RES *tres, int numOfR
       return;
     }
 
+    tscDecodeResBlock(pRes);
+
 #ifdef _DEBUG_VIEW
     printf("received data from vnode: %"PRIu64" rows\n", pRes->numOfRows);
     SSrcColumnInfo colInfo[256] = {0};
@@ -1719,22 +1918,18 @@ static void tscRetrieveFromDnodeCallBack(void *param, TAOS_RES *tres, int numOfR
     tColModelDisplayEx(pDesc->pColumnModel, pRes->data, pRes->numOfRows, pRes->numOfRows, colInfo);
 #endif
     
-    if (tsTotalTmpDirGB != 0 && tsAvailTmpDirGB < tsMinimalTmpDirGB) {
-      tscError("%p sub:%p client disk space remain %.3f GB, need at least %.3f GB, stop query", pPObj, pSql,
-               tsAvailTmpDirGB, tsMinimalTmpDirGB);
-      tscAbortFurtherRetryRetrieval(trsupport, tres, TSDB_CODE_TSC_NO_DISKSPACE);
-      return;
-    }
-    
-    int32_t ret = saveToBuffer(trsupport->pExtMemBuffer[idx], pDesc, trsupport->localBuffer, pRes->data,
-                               pRes->numOfRows, pQueryInfo->groupbyExpr.orderType);
-    if (ret != 0) { // set no disk space error info, and abort retry
-      tscAbortFurtherRetryRetrieval(trsupport, tres, TSDB_CODE_TSC_NO_DISKSPACE);
+    int32_t ret = saveToBuffer(trsupport->pLocalDataBuf[idx], pDesc, pRes->data, pRes->numOfRows,
+                               pQueryInfo->groupbyExpr.orderType);
+    if (ret != 0) { // set no disk space or out of memory error info, and abort retry
+      tscAbortFurtherRetryRetrieval(trsupport, tres, ret);
       
     } else if (pRes->completed) {
       tscAllDataRetrievedFromDnode(trsupport, pSql);
       return;
       
+    } else if (trsupport->pLocalDataBuf[idx]->stream) {
+      tscStreamRetrieveFromDnode(trsupport, pSql);
+
     } else { // continue fetch data from dnode
       pthread_mutex_unlock(&trsupport->queryMutex);
       taos_fetch_rows_a(tres, tscRetrieveFromDnodeCallBack, param);
@@ -1778,7 +1973,7 @@ void tscRetrieveDataRes(void *param, TAOS_RES *tres, int code) {
   SCMVgroupInfo* pVgroup = &pTableMetaInfo->vgroupList->vgroups[0];
   
   SSubqueryState* pState = trsupport->pState;
-  assert(pState->numOfRemain <= pState->numOfTotal && pState->numOfRemain >= 0 && pParentSql->numOfSubs == pState->numOfTotal);
+  assert(pState->numOfRemain <= pState->numOfTotal + pState->merging && pState->numOfRemain >= 0 && pParentSql->numOfSubs == pState->numOfTotal);
 
   // todo set error code
   if (pParentSql->res.code != TSDB_CODE_SUCCESS) {
@@ -2140,6 +2335,7 @@ void **doSetResultRowData(SSqlObj *pSql, bool finalResult) {
         pRes->buffer[i] = malloc(field->bytes);
       }
 
+      tscDecodeResBlock(pRes);
       for(int32_t k = 0; k < pRes->pArithSup->numOfCols; ++k) {
         SSqlExpr* pExpr = tscSqlExprGet(pQueryInfo, k);
         pRes->pArithSup->data[k] = (pRes->data + pRes->numOfRows* pExpr->offset) + pRes->row*pExpr->resBytes;
@@ -2155,6 +2351,125 @@ void **doSetResultRowData(SSqlObj *pSql, bool finalResult) {
   return pRes->tsrow;
 }
 
+static void setArithmeticBlockData(SSqlRes *pRes, SQueryInfo *pQueryInfo, SFieldSupInfo *pSup, int32_t numOfRows,
+                                   char *pOutput) {
+  if (pRes->pArithSup == NULL) {
+    SArithmeticSupport *sas = (SArithmeticSupport *) calloc(1, sizeof(SArithmeticSupport));
+    sas->numOfCols  = tscSqlExprNumOfExprs(pQueryInfo);
+    sas->exprList   = pQueryInfo->exprList;
+    sas->data       = calloc(sas->numOfCols, POINTER_BYTES);
+
+    pRes->pArithSup = sas;
+  }
+
+  pRes->pArithSup->offset = 0;
+  pRes->pArithSup->pArithExpr = pSup->pArithExprInfo;
+
+  tscDecodeResBlock(pRes);
+  for (int32_t k = 0; k < pRes->pArithSup->numOfCols; ++k) {
+    SSqlExpr *pExpr = tscSqlExprGet(pQueryInfo, k);
+    pRes->pArithSup->data[k] = (pRes->data + pRes->numOfRows * pExpr->offset) + pRes->row * pExpr->resBytes;
+  }
+
+  tExprTreeCalcTraverse(pRes->pArithSup->pArithExpr->pExpr, numOfRows, pOutput, pRes->pArithSup, TSDB_ORDER_ASC,
+                        getArithemicInputSrc);
+}
+
+/*
+ * describe all the remaining rows of the current retrieved block by columns, the values are referred in place except
+ * the nchar values, which are converted to the client charset, and the results of arithmetic expressions.
+ */
+int32_t doSetResultBlockData(SSqlObj *pSql, TAOS_COLUMN_BIND *columns) {
+  SSqlCmd *pCmd = &pSql->cmd;
+  SSqlRes *pRes = &pSql->res;
+
+  int32_t numOfRows = (int32_t)(pRes->numOfRows - pRes->row);
+  if (numOfRows <= 0) {
+    return 0;
+  }
+
+  SQueryInfo *pQueryInfo = tscGetQueryInfoDetail(pCmd, pCmd->clauseIndex);
+  int32_t     code = tscCreateResBlock(pRes, pQueryInfo, numOfRows, false);
+  if (code != TSDB_CODE_SUCCESS) {
+    pRes->code = code;
+    return 0;
+  }
+
+  SResBlock *pBlock = pRes->pBlock;
+  size_t     size = tscNumOfFields(pQueryInfo);
+
+  for (int32_t i = 0; i < size; ++i) {
+    SFieldSupInfo *   pSup = tscFieldInfoGetSupp(&pQueryInfo->fieldsInfo, i);
+    TAOS_FIELD *      pField = tscFieldInfoGetField(&pQueryInfo->fieldsInfo, i);
+    TAOS_COLUMN_BIND *pBind = &columns[i];
+    char *            isNullFlag = pBlock->isNull[i];
+
+    char *  pData = NULL;
+    int32_t bytes = pField->bytes;
+    if (pSup->pArithExprInfo != NULL) {
+      pData = pBlock->data[i];
+      setArithmeticBlockData(pRes, pQueryInfo, pSup, numOfRows, pData);
+    } else {
+      bytes = pSup->pSqlExpr->resBytes;
+      tscDecodeResColumn(pRes, pSup->pSqlExpr->offset);
+      pData = pRes->data + pSup->pSqlExpr->offset * pRes->numOfRows + bytes * pRes->row;
+    }
+
+    pBind->buffer_type = pField->type;
+    pBind->buffer = pData;
+    pBind->buffer_length = bytes;
+    pBind->length = NULL;
+    pBind->is_null = isNullFlag;
+
+    if (pField->type != TSDB_DATA_TYPE_BINARY && pField->type != TSDB_DATA_TYPE_NCHAR) {
+      for (int32_t j = 0; j < numOfRows; ++j) {
+        isNullFlag[j] = isNull(pData + j * bytes, pField->type);
+      }
+
+      continue;
+    }
+
+    unsigned long *length = pBlock->length[i];
+    pBind->length = length;
+
+    if (pField->type == TSDB_DATA_TYPE_BINARY) {
+      pBind->buffer = pData + VARSTR_HEADER_SIZE;
+      for (int32_t j = 0; j < numOfRows; ++j) {
+        char *pVal = pData + j * bytes;
+        isNullFlag[j] = isNull(pVal, pField->type);
+        length[j] = isNullFlag[j] ? 0 : varDataLen(pVal);
+      }
+
+      continue;
+    }
+
+    // convert unicode to the client charset, each converted value is not longer than the unicode one
+    char *pOutput = pBlock->data[i];
+    pBind->buffer = pOutput;
+    pBind->buffer_length = pField->bytes;
+
+    for (int32_t j = 0; j < numOfRows; ++j) {
+      char *pVal = pData + j * bytes;
+      isNullFlag[j] = isNull(pVal, pField->type);
+      length[j] = 0;
+
+      if (!isNullFlag[j]) {
+        int32_t len = taosUcs4ToMbs(varDataVal(pVal), varDataLen(pVal), pOutput + j * pField->bytes);
+        if (len >= 0) {
+          length[j] = len;
+        } else {
+          tscError("%p charset:%s to %s. column:%d row:%d convert failed.", pSql, DEFAULT_UNICODE_ENCODEC, tsCharset,
+                   i, pRes->row + j);
+          isNullFlag[j] = 1;
+        }
+      }
+    }
+  }
+
+  pRes->row = (int32_t)pRes->numOfRows;
+  return numOfRows;
+}
+
 static bool tscHasRemainDataInSubqueryResultSet(SSqlObj *pSql) {
   bool     hasData = true;
   SSqlCmd *pCmd = &pSql->cmd;
@@ -16,6 +16,8 @@
 #include "os.h"
 #include "taosmsg.h"
 #include "tcache.h"
+#include "hash.h"
+#include "hashfunc.h"
 #include "trpc.h"
 #include "tsystem.h"
 #include "ttime.h"
@@ -32,8 +34,14 @@
 
 // global, not configurable
 void *  tscCacheHandle;
+void *  tscChildMetaHandle;
+void *  tscSTableVersions;
+void *  tscVgroupInfos;
+pthread_mutex_t tscSTableVersionMutex;
 void *  tscTmr;
 void *  tscQhandle;
+void *  tscMergeQhandle;
+void *  tscParseQhandle;
 void *  tscCheckDiskUsageTmr;
 int     tsInsertHeadSize;
 
@@ -138,6 +146,20 @@ void taos_init_imp() {
     return;
   }
 
+  // the workers to merge the super table query results, which never wait for any other task
+  tscMergeQhandle = taosInitScheduler(queueSize, tscNumOfThreads, "tscMerge");
+  if (NULL == tscMergeQhandle) {
+    tscError("failed to init merge scheduler");
+    return;
+  }
+
+  // the workers to parse the values of large insert sql, which never wait for any other task either
+  tscParseQhandle = taosInitScheduler(queueSize, tscNumOfThreads, "tscParse");
+  if (NULL == tscParseQhandle) {
+    tscError("failed to init parse scheduler");
+    return;
+  }
+
   tscTmr = taosTmrInit(tsMaxConnections * 2, 200, 60000, "TSC");
   if(0 == tscEmbedded){
     taosTmrReset(tscCheckDiskUsage, 10, NULL, tscTmr, &tscCheckDiskUsageTmr);      
@@ -149,6 +171,20 @@ void taos_init_imp() {
 
   if (tscCacheHandle == NULL) {
     tscCacheHandle = taosCacheInit(refreshTime);
+    taosCacheSetMaxSize(tscCacheHandle, (int64_t)tsTableMetaCacheSize * 1024 * 1024);
+  }
+
+  if (tscChildMetaHandle == NULL) {
+    tscChildMetaHandle = taosCacheInit(refreshTime);
+    taosCacheSetMaxSize(tscChildMetaHandle, (int64_t)tsTableMetaCacheSize * 1024 * 1024);
+  }
+
+  // the latest versions of super tables, used to discard the out of date child table metas in cache, and the vgroups
+  // of the prefetched child tables
+  if (tscSTableVersions == NULL) {
+    pthread_mutex_init(&tscSTableVersionMutex, NULL);
+    tscSTableVersions = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), false);
+    tscVgroupInfos = taosHashInit(64, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), false);
   }
 
   tscTrace("client is initialized successfully");
@@ -160,11 +196,33 @@ void taos_cleanup() {
   if (tscCacheHandle != NULL) {
     taosCacheCleanup(tscCacheHandle);
   }
+
+  if (tscChildMetaHandle != NULL) {
+    taosCacheCleanup(tscChildMetaHandle);
+  }
+
+  if (tscSTableVersions != NULL) {
+    taosHashCleanup(tscSTableVersions);
+    taosHashCleanup(tscVgroupInfos);
+    tscSTableVersions = NULL;
+    tscVgroupInfos = NULL;
+    pthread_mutex_destroy(&tscSTableVersionMutex);
+  }
   
   if (tscQhandle != NULL) {
     taosCleanUpScheduler(tscQhandle);
     tscQhandle = NULL;
   }
+
+  if (tscMergeQhandle != NULL) {
+    taosCleanUpScheduler(tscMergeQhandle);
+    tscMergeQhandle = NULL;
+  }
+
+  if (tscParseQhandle != NULL) {
+    taosCleanUpScheduler(tscParseQhandle);
+    tscParseQhandle = NULL;
+  }
   
   taosCloseLog();
   
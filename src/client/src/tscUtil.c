@@ -29,6 +29,7 @@
 #include "tscLog.h"
 #include "tscUtil.h"
 #include "hash.h"
+#include "qresultEncode.h"
 
 static void freeQueryInfoImpl(SQueryInfo* pQueryInfo);
 static void clearAllTableMetaInfo(SQueryInfo* pQueryInfo, const char* address, bool removeFromCache);
@@ -293,9 +294,149 @@ void tscDestroyResPointerInfo(SSqlRes* pRes) {
     tfree(pRes->pArithSup);
   }
   
+  tscDestroyResBlock(pRes);
+  tscDestroyResDecoder(pRes);
   pRes->data = NULL;  // pRes->data points to the buffer of pRsp, no need to free
 }
 
+/*
+ * the values of fixed length columns are referred in pRes->data in place, only the null flags and lengths are
+ * prepared, unless all values are copied row by row
+ */
+int32_t tscCreateResBlock(SSqlRes* pRes, SQueryInfo* pQueryInfo, int32_t numOfRows, bool copyAll) {
+  SResBlock* pBlock = pRes->pBlock;
+  int32_t    numOfCols = tscNumOfFields(pQueryInfo);
+
+  if (pBlock != NULL && pBlock->capacity >= numOfRows && pBlock->numOfCols == numOfCols) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  tscDestroyResBlock(pRes);
+
+  pBlock = calloc(1, sizeof(SResBlock));
+  if (pBlock == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  pRes->pBlock = pBlock;
+  pBlock->capacity = numOfRows;
+  pBlock->numOfCols = numOfCols;
+  pBlock->data = calloc(numOfCols, POINTER_BYTES);
+  pBlock->length = calloc(numOfCols, POINTER_BYTES);
+  pBlock->isNull = calloc(numOfCols, POINTER_BYTES);
+  if (pBlock->data == NULL || pBlock->length == NULL || pBlock->isNull == NULL) {
+    tscDestroyResBlock(pRes);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    SFieldSupInfo* pSup = tscFieldInfoGetSupp(&pQueryInfo->fieldsInfo, i);
+    TAOS_FIELD*    pField = tscFieldInfoGetField(&pQueryInfo->fieldsInfo, i);
+    bool           isVar = (pField->type == TSDB_DATA_TYPE_BINARY || pField->type == TSDB_DATA_TYPE_NCHAR);
+
+    pBlock->isNull[i] = malloc(numOfRows);
+    if (pBlock->isNull[i] == NULL) {
+      tscDestroyResBlock(pRes);
+      return TSDB_CODE_TSC_OUT_OF_MEMORY;
+    }
+
+    if (isVar) {
+      pBlock->length[i] = malloc(numOfRows * sizeof(unsigned long));
+      if (pBlock->length[i] == NULL) {
+        tscDestroyResBlock(pRes);
+        return TSDB_CODE_TSC_OUT_OF_MEMORY;
+      }
+    }
+
+    if (copyAll || pField->type == TSDB_DATA_TYPE_NCHAR || pSup->pArithExprInfo != NULL) {
+      pBlock->data[i] = malloc((size_t)numOfRows * pField->bytes);
+      if (pBlock->data[i] == NULL) {
+        tscDestroyResBlock(pRes);
+        return TSDB_CODE_TSC_OUT_OF_MEMORY;
+      }
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+void tscDestroyResBlock(SSqlRes* pRes) {
+  SResBlock* pBlock = pRes->pBlock;
+  if (pBlock == NULL) {
+    return;
+  }
+
+  for (int32_t i = 0; i < pBlock->numOfCols; ++i) {
+    if (pBlock->data != NULL) tfree(pBlock->data[i]);
+    if (pBlock->length != NULL) tfree(pBlock->length[i]);
+    if (pBlock->isNull != NULL) tfree(pBlock->isNull[i]);
+  }
+
+  tfree(pBlock->data);
+  tfree(pBlock->length);
+  tfree(pBlock->isNull);
+  tfree(pRes->pBlock);
+}
+
+static void doDecodeResColumn(SResDecoder* pDecoder, SResDecodeCol* pCol) {
+  const char* pInput = pDecoder->pRsp + sizeof(SRetrieveTableRsp) + pCol->inputOffset;
+  char*       pOutput = pDecoder->pOutput + pCol->offset * pDecoder->numOfRows;
+
+  if (qDecodeResultColumn(pInput, pDecoder->numOfRows, pOutput) != 0) {
+    SResultColHead* pHead = (SResultColHead*)pInput;
+    tscError("failed to decode the result column at offset:%d, rows:%d, set to null", pCol->offset,
+             pDecoder->numOfRows);
+    setNullN(pOutput, pHead->type, htonl(pHead->bytes), pDecoder->numOfRows);
+  }
+
+  pCol->decoded = true;
+  pDecoder->numOfDecoded += 1;
+}
+
+void tscDecodeResColumn(SSqlRes* pRes, int32_t offset) {
+  SResDecoder* pDecoder = pRes->pDecoder;
+  if (pDecoder == NULL) {
+    return;
+  }
+
+  for (int32_t i = 0; i < pDecoder->numOfCols; ++i) {
+    SResDecodeCol* pCol = &pDecoder->cols[i];
+    if (pCol->offset == offset && !pCol->decoded) {
+      doDecodeResColumn(pDecoder, pCol);
+      break;
+    }
+  }
+
+  // the encoded block is released once all columns are decoded
+  if (pDecoder->numOfDecoded == pDecoder->numOfCols) {
+    tscDestroyResDecoder(pRes);
+  }
+}
+
+void tscDecodeResBlock(SSqlRes* pRes) {
+  SResDecoder* pDecoder = pRes->pDecoder;
+  if (pDecoder == NULL) {
+    return;
+  }
+
+  for (int32_t i = 0; i < pDecoder->numOfCols; ++i) {
+    if (!pDecoder->cols[i].decoded) {
+      doDecodeResColumn(pDecoder, &pDecoder->cols[i]);
+    }
+  }
+
+  tscDestroyResDecoder(pRes);
+}
+
+void tscDestroyResDecoder(SSqlRes* pRes) {
+  if (pRes->pDecoder == NULL) {
+    return;
+  }
+
+  tfree(pRes->pDecoder->pRsp);
+  tfree(pRes->pDecoder);
+}
+
 static void tscFreeQueryInfo(SSqlCmd* pCmd) {
   if (pCmd == NULL || pCmd->numOfClause == 0) {
     return;
@@ -325,7 +466,8 @@ void tscResetSqlCmdObj(SSqlCmd* pCmd) {
   
   taosHashCleanup(pCmd->pTableList);
   pCmd->pTableList = NULL;
-  
+
+  pCmd->pDataSegments = tscDestroyDataSegments(pCmd->pDataSegments);
   pCmd->pDataBlocks = tscDestroyBlockArrayList(pCmd->pDataBlocks);
   
   tscFreeQueryInfo(pCmd);
@@ -648,8 +790,9 @@ int32_t tscMergeTableDataBlocks(SSqlObj* pSql, SArray* pTableDataBlockList) {
       }
     }
 
-    SSubmitBlk* pBlocks = (SSubmitBlk*) pOneTableBlock->pData;
+    // the rows may be moved into a new buffer during sorting
     tscSortRemoveDataBlockDupRows(pOneTableBlock);
+    SSubmitBlk* pBlocks = (SSubmitBlk*) pOneTableBlock->pData;
 
     char* ekey = (char*)pBlocks->data + pOneTableBlock->rowSize*(pBlocks->numOfRows-1);
     
@@ -1410,7 +1553,7 @@ bool tscShouldBeFreed(SSqlObj* pSql) {
 
   // only the table meta and super table vgroup query will free resource automatically
   int32_t command = pSql->cmd.command;
-  if (command == TSDB_SQL_META || command == TSDB_SQL_STABLEVGROUP) {
+  if (command == TSDB_SQL_META || command == TSDB_SQL_STABLEVGROUP || command == TSDB_SQL_STABLE_CHILDREN) {
     return true;
   }
 
@@ -1622,6 +1765,7 @@ void tscResetForNextRetrieve(SSqlRes* pRes) {
 
   pRes->row = 0;
   pRes->numOfRows = 0;
+  tscDestroyResDecoder(pRes);
 }
 
 SSqlObj* createSimpleSubObj(SSqlObj* pSql, void (*fp)(), void* param, int32_t cmd) {
@@ -1697,6 +1841,7 @@ SSqlObj* createSubqueryObj(SSqlObj* pSql, int16_t tableIndex, void (*fp)(), void
   pnCmd->numOfClause = 0;
   pnCmd->clauseIndex = 0;
   pnCmd->pDataBlocks = NULL;
+  pnCmd->pDataSegments = NULL;
   pnCmd->parseFinished = 1;
 
   if (tscAddSubqueryInfo(pnCmd) != TSDB_CODE_SUCCESS) {
@@ -1957,8 +2102,8 @@ bool tscHasReachLimitation(SQueryInfo* pQueryInfo, SSqlRes* pRes) {
 }
 
 bool tscResultsetFetchCompleted(TAOS_RES *result) {
-  SSqlRes* pRes = result;
-  return pRes->completed; 
+  SSqlObj* pSql = result;
+  return pSql->res.completed;
 }
 
 char* tscGetErrorMsgPayload(SSqlCmd* pCmd) { return pCmd->payload; }
@@ -2087,6 +2232,7 @@ void tscGetResultColumnChr(SSqlRes* pRes, SFieldInfo* pFieldInfo, int32_t column
   int32_t type = pInfo->pSqlExpr->resType;
   int32_t bytes = pInfo->pSqlExpr->resBytes;
   
+  tscDecodeResColumn(pRes, pInfo->pSqlExpr->offset);
   char* pData = pRes->data + pInfo->pSqlExpr->offset * pRes->numOfRows + bytes * pRes->row;
   
   if (type == TSDB_DATA_TYPE_NCHAR || type == TSDB_DATA_TYPE_BINARY) {
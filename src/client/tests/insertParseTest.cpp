@@ -0,0 +1,336 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+#include "taos.h"
+#include "tcache.h"
+#include "tsched.h"
+#include "tscUtil.h"
+#include "ttime.h"
+
+namespace {
+const int32_t binaryLen = 16 + VARSTR_HEADER_SIZE;
+const int32_t rowSize = sizeof(int64_t) + sizeof(int32_t) + binaryLen;
+
+// table meta of (ts timestamp, v int, b binary(16)), put into the client cache as the data blocks refer to it
+STableMeta* createTableMeta(const char* name) {
+  if (tscCacheHandle == NULL) {
+    tscCacheHandle = taosCacheInit(10);
+  }
+
+  const int32_t numOfCols = 3;
+  size_t        size = sizeof(STableMeta) + sizeof(SSchema) * numOfCols;
+  STableMeta*   pTableMeta = (STableMeta*)calloc(1, size);
+
+  pTableMeta->tableType = TSDB_NORMAL_TABLE;
+  pTableMeta->tableInfo.numOfColumns = numOfCols;
+  pTableMeta->tableInfo.precision = TSDB_TIME_PRECISION_MILLI;
+  pTableMeta->tableInfo.rowSize = rowSize;
+
+  SSchema* pSchema = pTableMeta->schema;
+  pSchema[0].type = TSDB_DATA_TYPE_TIMESTAMP;
+  pSchema[0].bytes = sizeof(int64_t);
+  pSchema[1].type = TSDB_DATA_TYPE_INT;
+  pSchema[1].bytes = sizeof(int32_t);
+  pSchema[2].type = TSDB_DATA_TYPE_BINARY;
+  pSchema[2].bytes = binaryLen;
+
+  STableMeta* pCached = (STableMeta*)taosCachePut((SCacheObj*)tscCacheHandle, name, pTableMeta, size, 60);
+  free(pTableMeta);
+  return pCached;
+}
+
+void releaseTableMeta(STableMeta* pTableMeta) {
+  taosCacheRelease((SCacheObj*)tscCacheHandle, (void**)&pTableMeta, false);
+}
+
+STableDataBlocks* createDataBlock(STableMeta* pTableMeta, const char* name) {
+  STableDataBlocks* pDataBlock = NULL;
+  tscCreateDataBlock(TSDB_DEFAULT_PAYLOAD_SIZE, rowSize, sizeof(SSubmitBlk), name, pTableMeta, &pDataBlock);
+  return pDataBlock;
+}
+
+// the value of int column is derived from the timestamp, and the binary column keeps the sequence of the row
+void appendRows(STableDataBlocks* pDataBlock, const int64_t* ts, int32_t numOfRows) {
+  if (pDataBlock->nAllocSize - pDataBlock->size < numOfRows * rowSize) {
+    pDataBlock->nAllocSize = pDataBlock->size + numOfRows * rowSize;
+    pDataBlock->pData = (char*)realloc(pDataBlock->pData, pDataBlock->nAllocSize);
+  }
+
+  SSubmitBlk* pBlocks = (SSubmitBlk*)pDataBlock->pData;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    char* row = pDataBlock->pData + pDataBlock->size;
+    *(int64_t*)row = ts[i];
+    *(int32_t*)(row + sizeof(int64_t)) = (int32_t)(ts[i] % 1000);
+
+    char* b = row + sizeof(int64_t) + sizeof(int32_t);
+    varDataSetLen(b, sprintf((char*)varDataVal(b), "%d", pBlocks->numOfRows + i));
+
+    if (i > 0 && ts[i] <= ts[i - 1]) {
+      pDataBlock->ordered = false;
+    }
+
+    pDataBlock->size += rowSize;
+  }
+
+  pDataBlock->tsSource = 1;  // TSDB_USE_CLI_TS
+  pBlocks->numOfRows += numOfRows;
+}
+
+// the rows are strictly ascending, and the row with duplicated timestamp is the first one appended
+void checkSortedRows(STableDataBlocks* pDataBlock, int32_t numOfDistinct) {
+  SSubmitBlk* pBlocks = (SSubmitBlk*)pDataBlock->pData;
+  ASSERT_EQ(pBlocks->numOfRows, numOfDistinct);
+  ASSERT_EQ(pDataBlock->size, sizeof(SSubmitBlk) + rowSize * numOfDistinct);
+
+  for (int32_t i = 0; i < pBlocks->numOfRows; ++i) {
+    char*   row = pBlocks->data + rowSize * i;
+    int64_t ts = *(int64_t*)row;
+    ASSERT_EQ(*(int32_t*)(row + sizeof(int64_t)), (int32_t)(ts % 1000));
+
+    if (i > 0) {
+      ASSERT_GT(ts, *(int64_t*)(row - rowSize));
+    }
+  }
+}
+
+void sortTest(int32_t numOfRows, bool sorted) {
+  STableMeta*       pTableMeta = createTableMeta("db.sort");
+  STableDataBlocks* pDataBlock = createDataBlock(pTableMeta, "db.sort");
+
+  int64_t* ts = (int64_t*)malloc(sizeof(int64_t) * numOfRows);
+  srand(0);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    // negative timestamps and the timestamps across the byte boundaries are included
+    ts[i] = sorted ? (i / 2) * 1000 : (int64_t)(rand() % (numOfRows * 2) - numOfRows / 4) * 1000 + rand() % 3 * 257;
+  }
+
+  appendRows(pDataBlock, ts, numOfRows);
+
+  std::sort(ts, ts + numOfRows);
+  int32_t numOfDistinct = (int32_t)(std::unique(ts, ts + numOfRows) - ts);
+
+  tscSortRemoveDataBlockDupRows(pDataBlock);
+  checkSortedRows(pDataBlock, numOfDistinct);
+
+  // the first row of the same timestamp is kept
+  if (!sorted) {
+    int32_t* seq = (int32_t*)calloc(numOfDistinct, sizeof(int32_t));
+    SSubmitBlk* pBlocks = (SSubmitBlk*)pDataBlock->pData;
+    for (int32_t i = 0; i < numOfDistinct; ++i) {
+      char* b = pBlocks->data + rowSize * i + sizeof(int64_t) + sizeof(int32_t);
+      seq[i] = atoi((char*)varDataVal(b));
+    }
+
+    srand(0);
+    int64_t* orig = (int64_t*)malloc(sizeof(int64_t) * numOfRows);
+    for (int32_t i = 0; i < numOfRows; ++i) {
+      orig[i] = (int64_t)(rand() % (numOfRows * 2) - numOfRows / 4) * 1000 + rand() % 3 * 257;
+    }
+
+    for (int32_t i = 0; i < numOfDistinct; ++i) {
+      for (int32_t j = 0; j < seq[i]; ++j) {
+        ASSERT_NE(orig[j], orig[seq[i]]);
+      }
+    }
+
+    free(orig);
+    free(seq);
+  }
+
+  free(ts);
+  tscDestroyDataBlock(pDataBlock);
+  releaseTableMeta(pTableMeta);
+}
+
+typedef struct STestTable {
+  char              name[TSDB_TABLE_ID_LEN];
+  STableMeta*       pTableMeta;
+  STableDataBlocks* pDataBlock;
+} STestTable;
+
+/*
+ * generate the insert sql in the form of "t0 values (ts, v, 'b') (ts, v, 'b') ... t1 values ...", numOfSegs segments
+ * for each table and the segments of tables are interleaved.
+ */
+char* generateValues(int32_t numOfTables, int32_t numOfSegs, int32_t numOfRows, SArray* pSegments,
+                     STestTable* pTables) {
+  size_t len = (size_t)numOfTables * numOfSegs * (numOfRows + 1) * 64 + 1;
+  char*  sql = (char*)malloc(len);
+  char*  p = sql;
+
+  for (int32_t s = 0; s < numOfSegs; ++s) {
+    for (int32_t t = 0; t < numOfTables; ++t) {
+      p += sprintf(p, "%s values ", pTables[t].name);
+
+      SDataSegment seg = {0};
+      seg.index = (int32_t)taosArrayGetSize(pSegments);
+      seg.pDataBlock = pTables[t].pDataBlock;
+      seg.start = p;
+
+      for (int32_t i = 0; i < numOfRows; ++i) {
+        int64_t ts = 1600000000000L + (int64_t)(s * numOfRows + i) * 1000;
+        p += sprintf(p, "(%" PRId64 ", %d, 'a(%d)b') ", ts, (int32_t)(ts % 1000), s * numOfRows + i);
+      }
+
+      seg.end = p - 1;  // exclude the trailing space
+      taosArrayPush(pSegments, &seg);
+    }
+  }
+
+  return sql;
+}
+
+void createTables(STestTable* pTables, int32_t numOfTables, const char* prefix) {
+  for (int32_t t = 0; t < numOfTables; ++t) {
+    sprintf(pTables[t].name, "db.%s%d", prefix, t);
+    pTables[t].pTableMeta = createTableMeta(pTables[t].name);
+    pTables[t].pDataBlock = createDataBlock(pTables[t].pTableMeta, pTables[t].name);
+  }
+}
+
+void destroyTables(STestTable* pTables, int32_t numOfTables) {
+  for (int32_t t = 0; t < numOfTables; ++t) {
+    tscDestroyDataBlock(pTables[t].pDataBlock);
+    releaseTableMeta(pTables[t].pTableMeta);
+  }
+}
+
+// the data blocks converted by several threads are identical to the ones converted by the caller only
+void parseSegmentsTest() {
+  const int32_t numOfTables = 20;
+  const int32_t numOfSegs = 3;
+  const int32_t numOfRows = 50;
+
+  void* pSched = taosInitScheduler(100, 3, "parse");
+  char  msg[512] = {0};
+
+  STestTable serial[numOfTables];
+  STestTable parallel[numOfTables];
+  createTables(serial, numOfTables, "s");
+  createTables(parallel, numOfTables, "p");
+
+  SArray* pSerialSegs = (SArray*)taosArrayInit(4, sizeof(SDataSegment));
+  SArray* pParallelSegs = (SArray*)taosArrayInit(4, sizeof(SDataSegment));
+  char*   sql1 = generateValues(numOfTables, numOfSegs, numOfRows, pSerialSegs, serial);
+  char*   sql2 = generateValues(numOfTables, numOfSegs, numOfRows, pParallelSegs, parallel);
+
+  ASSERT_EQ(tscParseDataSegments(NULL, 1, pSerialSegs, msg), TSDB_CODE_SUCCESS);
+  ASSERT_EQ(tscParseDataSegments(pSched, 4, pParallelSegs, msg), TSDB_CODE_SUCCESS);
+
+  for (int32_t t = 0; t < numOfTables; ++t) {
+    STableDataBlocks* p1 = serial[t].pDataBlock;
+    STableDataBlocks* p2 = parallel[t].pDataBlock;
+
+    ASSERT_EQ(((SSubmitBlk*)p1->pData)->numOfRows, numOfSegs * numOfRows);
+    ASSERT_EQ(p1->size, p2->size);
+    ASSERT_EQ(memcmp(p1->pData, p2->pData, p1->size), 0);
+    ASSERT_TRUE(p2->ordered);
+    checkSortedRows(p2, numOfSegs * numOfRows);
+  }
+
+  tscDestroyDataSegments(pSerialSegs);
+  tscDestroyDataSegments(pParallelSegs);
+  free(sql1);
+  free(sql2);
+  destroyTables(serial, numOfTables);
+  destroyTables(parallel, numOfTables);
+
+  // the error of the first invalid segment in sql string is reported
+  STestTable tables[numOfTables];
+  createTables(tables, numOfTables, "e");
+
+  SArray* pSegments = (SArray*)taosArrayInit(4, sizeof(SDataSegment));
+  char*   sql = generateValues(numOfTables, numOfSegs, numOfRows, pSegments, tables);
+
+  SDataSegment* pSeg = (SDataSegment*)taosArrayGet(pSegments, numOfTables * 2 + 5);
+  pSeg->start[1] = 'x';
+  pSeg = (SDataSegment*)taosArrayGet(pSegments, numOfTables + 7);
+  pSeg->start[1] = 'y';
+
+  ASSERT_EQ(tscParseDataSegments(pSched, 4, pSegments, msg), TSDB_CODE_TSC_INVALID_SQL);
+  ASSERT_TRUE(strstr(msg, "y600") != NULL);
+
+  tscDestroyDataSegments(pSegments);
+  free(sql);
+  destroyTables(tables, numOfTables);
+
+  taosCleanUpScheduler(pSched);
+}
+
+// parse the values of a large multi-table insert sql by one thread and by several threads
+void parseSegmentsPerfTest(int32_t numOfTables, int32_t numOfRows) {
+  const int32_t numOfThreads = 4;
+  void*         pSched = taosInitScheduler(100, numOfThreads - 1, "parse");
+  char          msg[512] = {0};
+
+  for (int32_t n = 1; n <= numOfThreads; n *= 2) {
+    STestTable* pTables = (STestTable*)calloc(numOfTables, sizeof(STestTable));
+    createTables(pTables, numOfTables, "t");
+
+    SArray* pSegments = (SArray*)taosArrayInit(4, sizeof(SDataSegment));
+    char*   sql = generateValues(numOfTables, 1, numOfRows, pSegments, pTables);
+
+    int64_t st = taosGetTimestampUs();
+    tscParseDataSegments((n == 1) ? NULL : pSched, n, pSegments, msg);
+    int64_t et = taosGetTimestampUs();
+
+    int64_t total = (int64_t)numOfTables * numOfRows;
+    printf("%d tables, %" PRId64 " rows, %zu bytes, %d threads, elapsed time:%" PRId64 " us, %.2f Mrows/sec\n",
+           numOfTables, total, strlen(sql), n, et - st, total / (double)(et - st));
+
+    tscDestroyDataSegments(pSegments);
+    free(sql);
+    destroyTables(pTables, numOfTables);
+    free(pTables);
+  }
+
+  taosCleanUpScheduler(pSched);
+}
+
+void sortPerfTest(int32_t numOfRows) {
+  STableMeta* pTableMeta = createTableMeta("db.sort");
+
+  int64_t* ts = (int64_t*)malloc(sizeof(int64_t) * numOfRows);
+  srand(0);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    ts[i] = 1600000000000L + (rand() % numOfRows) * 1000L;
+  }
+
+  STableDataBlocks* pDataBlock = createDataBlock(pTableMeta, "db.sort");
+  appendRows(pDataBlock, ts, numOfRows);
+
+  int64_t st = taosGetTimestampUs();
+  tscSortRemoveDataBlockDupRows(pDataBlock);
+  int64_t et = taosGetTimestampUs();
+  printf("sort %d disordered rows, elapsed time:%" PRId64 " us\n", numOfRows, et - st);
+  tscDestroyDataBlock(pDataBlock);
+
+  std::sort(ts, ts + numOfRows);
+  pDataBlock = createDataBlock(pTableMeta, "db.sort");
+  appendRows(pDataBlock, ts, numOfRows);
+
+  st = taosGetTimestampUs();
+  tscSortRemoveDataBlockDupRows(pDataBlock);
+  et = taosGetTimestampUs();
+  printf("sort %d ordered rows with duplicated timestamps, elapsed time:%" PRId64 " us\n", numOfRows, et - st);
+  tscDestroyDataBlock(pDataBlock);
+
+  free(ts);
+  releaseTableMeta(pTableMeta);
+}
+}  // namespace
+
+TEST(testCase, insertParseTest) {
+  sortTest(10, false);
+  sortTest(10000, false);
+  sortTest(10000, true);
+  parseSegmentsTest();
+}
+
+TEST(testCase, insertParsePerfTest) {
+  parseSegmentsPerfTest(1000, 100);
+  parseSegmentsPerfTest(10, 10000);
+  sortPerfTest(30000);
+}
@@ -70,6 +70,7 @@ enum {
   TSDB_DEFINE_SQL_TYPE( TSDB_SQL_META, "meta" )
   TSDB_DEFINE_SQL_TYPE( TSDB_SQL_STABLEVGROUP, "stable-vgroup" )
   TSDB_DEFINE_SQL_TYPE( TSDB_SQL_MULTI_META, "multi-meta" )
+  TSDB_DEFINE_SQL_TYPE( TSDB_SQL_STABLE_CHILDREN, "stable-children" )
   TSDB_DEFINE_SQL_TYPE( TSDB_SQL_HB, "heart-beat" )
 
   // SQL below for client local 
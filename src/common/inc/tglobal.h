@@ -65,6 +65,7 @@ extern int32_t tsShellActivityTimer;
 extern int32_t tsVnodePeerHBTimer;
 extern int32_t tsMgmtPeerHBTimer;
 extern int32_t tsTableMetaKeepTimer;
+extern int32_t tsTableMetaCacheSize;
 
 extern float    tsNumOfThreadsPerCore;
 extern float    tsRatioOfQueryThreads;
@@ -94,6 +95,9 @@ extern int32_t tsMaxTables;
 
 extern char tsMqttBrokerAddress[];
 extern char tsMqttBrokerClientId[];
+extern char tsMqttTopicTemplate[];
+extern int32_t tsMqttBatchRows;
+extern int32_t tsMqttLingerMs;
 
 extern int32_t tsMaxConnections;
 
@@ -109,6 +113,7 @@ extern int32_t tsRestRowLimit;
 extern int32_t tsMaxSQLStringLen;
 extern int32_t tsCompressMsgSize;
 extern int32_t tsMaxNumOfOrderedResults;
+extern int32_t tsQueryBufferSize;
 
 extern char tsSocketType[4];
 
@@ -130,6 +135,7 @@ extern int32_t  tsHttpMaxThreads;
 extern int32_t  tsHttpEnableCompress;
 extern int32_t  tsHttpEnableRecordSql;
 extern int32_t  tsTelegrafUseFieldNum;
+extern int32_t  tsTelegrafUseNativeInsert;
 
 extern int32_t  tsTscEnableRecordSql;
 
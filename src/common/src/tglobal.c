@@ -75,6 +75,7 @@ uint16_t tsSyncPort = 6040;
 int32_t tsStatusInterval = 1;         // second
 int32_t tsShellActivityTimer = 3;     // second
 int32_t tsTableMetaKeepTimer = 7200;  // second
+int32_t tsTableMetaCacheSize = 256;   // MB, the maximum memory used by each table meta cache in client
 int32_t tsRpcTimer = 300;
 int32_t tsRpcMaxTime = 600;      // seconds;
 
@@ -144,6 +145,9 @@ int32_t tsdbDebugFlag = 135;
 // one virtual node, to order according to timestamp
 int32_t tsMaxNumOfOrderedResults = 100000;
 
+// the maximum memory size in MB of the intermediate result pages for one query, pages beyond it are spilled to disk
+int32_t tsQueryBufferSize = 64;
+
 /*
  * denote if the server needs to compress response message at the application layer to client, including query rsp,
  * metricmeta rsp, and multi-meter query rsp message body. The client compress the submit message to server.
@@ -186,6 +190,7 @@ int32_t tsHttpMaxThreads = 2;
 int32_t tsHttpEnableCompress = 0;
 int32_t tsHttpEnableRecordSql = 0;
 int32_t tsTelegrafUseFieldNum = 0;
+int32_t tsTelegrafUseNativeInsert = 1;
 
 int32_t  tsTscEnableRecordSql = 0;
 uint32_t tsPublicIpInt = 0;
@@ -200,6 +205,9 @@ char tsLocale[TSDB_LOCALE_LEN] = {0};
 char tsCharset[TSDB_LOCALE_LEN] = {0};  // default encode string
 char tsMqttBrokerAddress[128] = {0}; 
 char tsMqttBrokerClientId[128] = {0};
+char tsMqttTopicTemplate[128] = "+/{db}/{table}";  // the levels of topic after the path of broker address
+int32_t tsMqttBatchRows = 4096;
+int32_t tsMqttLingerMs = 100;
 
 int32_t tsMaxBinaryDisplayWidth = 30;
 
@@ -538,6 +546,16 @@ static void doInitGlobalConfig() {
   cfg.unitType = TAOS_CFG_UTYPE_SECOND;
   taosInitConfigOption(cfg);
 
+  cfg.option = "tableMetaCacheSize";
+  cfg.ptr = &tsTableMetaCacheSize;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_CLIENT;
+  cfg.minValue = 1;
+  cfg.maxValue = 1048576;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_Mb;
+  taosInitConfigOption(cfg);
+
   cfg.option = "minSlidingTime";
   cfg.ptr = &tsMinSlidingTime;
   cfg.valType = TAOS_CFG_VTYPE_INT32;
@@ -728,6 +746,36 @@ static void doInitGlobalConfig() {
   cfg.ptrLength = 126;
   cfg.unitType = TAOS_CFG_UTYPE_NONE;
   taosInitConfigOption(cfg);
+
+  cfg.option = "mqttTopicTemplate";
+  cfg.ptr = tsMqttTopicTemplate;
+  cfg.valType = TAOS_CFG_VTYPE_STRING;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 0;
+  cfg.ptrLength = 126;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "mqttBatchRows";
+  cfg.ptr = &tsMqttBatchRows;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 1;
+  cfg.maxValue = 100000;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "mqttLingerMs";
+  cfg.ptr = &tsMqttLingerMs;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 60000;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
  
   // socket type; udp by default
   cfg.option = "sockettype";
@@ -770,6 +818,16 @@ static void doInitGlobalConfig() {
   cfg.unitType = TAOS_CFG_UTYPE_NONE;
   taosInitConfigOption(cfg);
 
+  cfg.option = "queryBufferSize";
+  cfg.ptr = &tsQueryBufferSize;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 1;
+  cfg.maxValue = 1024 * 1024;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_Mb;
+  taosInitConfigOption(cfg);
+
   // locale & charset
   cfg.option = "timezone";
   cfg.ptr = tsTimezone;
@@ -935,6 +993,16 @@ static void doInitGlobalConfig() {
   cfg.unitType = TAOS_CFG_UTYPE_NONE;
   taosInitConfigOption(cfg);
 
+  cfg.option = "telegrafUseNativeInsert";
+  cfg.ptr = &tsTelegrafUseNativeInsert;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 1;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
   cfg.option = "httpMaxThreads";
   cfg.ptr = &tsHttpMaxThreads;
   cfg.valType = TAOS_CFG_VTYPE_INT32;
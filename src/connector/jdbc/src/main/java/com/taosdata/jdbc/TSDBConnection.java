@@ -57,6 +57,7 @@ public class TSDBConnection implements Connection {
 				Integer.parseInt(info.getProperty(TSDBDriver.PROPERTY_KEY_PORT, "0")),
 				info.getProperty(TSDBDriver.PROPERTY_KEY_DBNAME), info.getProperty(TSDBDriver.PROPERTY_KEY_USER),
 				info.getProperty(TSDBDriver.PROPERTY_KEY_PASSWORD));
+		this.connector.setBatchFetch(Boolean.parseBoolean(info.getProperty(TSDBDriver.PROPERTY_KEY_BATCH_FETCH, "false")));
 	}
 
 	private void connect(String host, int port, String dbName, String user, String password) throws SQLException {
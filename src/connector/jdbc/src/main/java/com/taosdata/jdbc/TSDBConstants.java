@@ -33,6 +33,7 @@ public abstract class TSDBConstants {
 	public static final int JNI_NUM_OF_FIELDS_0 = -4;
 	public static final int JNI_SQL_NULL = -5;
 	public static final int JNI_FETCH_END = -6;
+	public static final int JNI_OUT_OF_MEMORY = -7;
 	
 	public static final int TSDB_DATA_TYPE_NULL = 0;
 	public static final int TSDB_DATA_TYPE_BOOL = 1;
@@ -64,6 +65,8 @@ public abstract class TSDBConstants {
 			return WrapErrMsg("can't execute empty sql!");
 		case JNI_FETCH_END:
 			return WrapErrMsg("fetch to the end of resultset");
+		case JNI_OUT_OF_MEMORY:
+			return WrapErrMsg("out of memory!");
 		default:
 			break;
 		}
@@ -98,6 +98,11 @@ public class TSDBDriver implements java.sql.Driver {
 
     public static final String PROPERTY_KEY_PROTOCOL = "protocol";
 
+    /**
+     * Key for fetching the results block by block rather than row by row, "true" or "false", default is "false"
+     */
+    public static final String PROPERTY_KEY_BATCH_FETCH = "batchfetch";
+
 	/**
 	 * Index for port coming out of parseHostPortPair().
 	 */
@@ -295,6 +300,9 @@ public class TSDBDriver implements java.sql.Driver {
                     break;
                 case PROPERTY_KEY_CONFIG_DIR:
                     urlProps.setProperty(PROPERTY_KEY_CONFIG_DIR, kvPair[1]);
+                    break;
+                case PROPERTY_KEY_BATCH_FETCH:
+                    urlProps.setProperty(PROPERTY_KEY_BATCH_FETCH, kvPair[1]);
                     break;
 			}
 		}
@@ -14,6 +14,8 @@
  *****************************************************************************/
 package com.taosdata.jdbc;
 
+import java.io.UnsupportedEncodingException;
+import java.nio.ByteBuffer;
 import java.sql.SQLException;
 import java.sql.SQLWarning;
 import java.util.List;
@@ -42,6 +44,19 @@ public class TSDBJNIConnector {
     private boolean isResultsetClosed = true;
     private int affectedRows = -1;
 
+    /**
+     * Whether the result sets of this connection are fetched block by block
+     */
+    private boolean batchFetch = false;
+
+    public boolean isBatchFetch() {
+        return this.batchFetch;
+    }
+
+    public void setBatchFetch(boolean batchFetch) {
+        this.batchFetch = batchFetch;
+    }
+
     /**
      * Whether the connection is closed
      */
@@ -149,22 +164,22 @@ public class TSDBJNIConnector {
     private native long executeQueryImp(byte[] sqlBytes, long connection);
 
     /**
-     * Get recent error code by connection
+     * Get recent error code by connection, that of the last failed call on this thread if pSql is null
      */
     public int getErrCode(Long pSql) {
-        return Math.abs(this.getErrCodeImp(this.taos, pSql));
+        return Math.abs(this.getErrCodeImp(this.taos, (pSql == null) ? TSDBConstants.JNI_NULL_POINTER : pSql));
     }
 
-    private native int getErrCodeImp(long connection, Long pSql);
+    private native int getErrCodeImp(long connection, long pSql);
 
     /**
-     * Get recent error message by connection
+     * Get recent error message by connection, that of the last failed call on this thread if pSql is null
      */
     public String getErrMsg(Long pSql) {
-        return this.getErrMsgImp(this.taos, pSql);
+        return this.getErrMsgImp((pSql == null) ? TSDBConstants.JNI_NULL_POINTER : pSql);
     }
 
-    private native String getErrMsgImp(long connection, Long pSql);
+    private native String getErrMsgImp(long pSql);
 
     /**
      * Get resultset pointer
@@ -240,6 +255,46 @@ public class TSDBJNIConnector {
 
     private native int fetchRowImp(long connection, long resultSet, TSDBResultSetRowData rowData);
 
+    /**
+     * Get the rows of one block, returns the number of rows, or a negative code if the rows are exhausted or failed
+     */
+    public int fetchBlock(long resultSet, TSDBResultSetBlockData blockData) {
+        return this.fetchBlockImp(this.taos, resultSet, blockData);
+    }
+
+    private native int fetchBlockImp(long connection, long resultSet, TSDBResultSetBlockData blockData);
+
+    /**
+     * Insert numOfRows rows into one table without sql, the values of column i are in the direct buffer data[i] with
+     * bytes[i] bytes for each value, in the order of the table schema and the native byte order. For binary and nchar
+     * columns, lengths[i] has the int length of each value. isNull[i] has one byte for each value, which is 1 for null.
+     * Both lengths and isNull, or any of their elements, may be null.
+     *
+     * @return the number of rows inserted
+     * @throws SQLException
+     */
+    public int insertBlock(String tableName, int numOfRows, int[] types, int[] bytes, ByteBuffer[] data,
+                           ByteBuffer[] lengths, ByteBuffer[] isNull) throws SQLException {
+        int code = TSDBConstants.JNI_SUCCESS;
+        try {
+            code = this.insertBlockImp(this.taos, tableName.getBytes(TaosGlobalConfig.getCharset()), numOfRows, types,
+                    bytes, data, lengths, isNull);
+        } catch (UnsupportedEncodingException e) {
+            throw new SQLException(TSDBConstants.WrapErrMsg("Unsupported encoding"));
+        }
+
+        if (code == TSDBConstants.JNI_TDENGINE_ERROR) {
+            throw new SQLException(TSDBConstants.WrapErrMsg(this.getErrMsg(null)), "", this.getErrCode(null));
+        } else if (code < 0) {
+            throw new SQLException(TSDBConstants.FixErrMsg(code));
+        }
+
+        return code;
+    }
+
+    private native int insertBlockImp(long connection, byte[] tableName, int numOfRows, int[] types, int[] bytes,
+                                       ByteBuffer[] data, ByteBuffer[] lengths, ByteBuffer[] isNull);
+
     /**
      * Execute close operation from C to release connection pointer by JNI
      *
@@ -47,6 +47,7 @@ public class TSDBResultSet implements ResultSet {
 	private List<ColumnMetaData> columnMetaDataList = new ArrayList<ColumnMetaData>();
 
 	private TSDBResultSetRowData rowData;
+	private TSDBResultSetBlockData blockData;
 
 	private boolean lastWasNull = false;
 	private final int COLUMN_INDEX_START_VALUE = 1;
@@ -106,7 +107,13 @@ public class TSDBResultSet implements ResultSet {
 			throw new SQLException(TSDBConstants.FixErrMsg(TSDBConstants.JNI_NUM_OF_FIELDS_0));
 		}
 
-		this.rowData = new TSDBResultSetRowData(this.columnMetaDataList.size());
+		// with batch fetch, the rows are fetched block by block, and the values of the current row are read from the block
+		if (this.jniConnector.isBatchFetch()) {
+			this.blockData = new TSDBResultSetBlockData(this.columnMetaDataList);
+			this.rowData = this.blockData;
+		} else {
+			this.rowData = new TSDBResultSetRowData(this.columnMetaDataList.size());
+		}
 	}
 
 	public <T> T unwrap(Class<T> iface) throws SQLException {
@@ -118,11 +125,21 @@ public class TSDBResultSet implements ResultSet {
 	}
 
 	public boolean next() throws SQLException {
-		if (rowData != null) {
-			this.rowData.clear();
+		int code;
+		if (this.blockData != null) {
+			if (this.blockData.forward()) {
+				return true;
+			}
+
+			code = this.jniConnector.fetchBlock(this.resultSetPointer, this.blockData);
+		} else {
+			if (rowData != null) {
+				this.rowData.clear();
+			}
+
+			code = this.jniConnector.fetchRow(this.resultSetPointer, this.rowData);
 		}
 
-		int code = this.jniConnector.fetchRow(this.resultSetPointer, this.rowData);
 		if (code == TSDBConstants.JNI_CONNECTION_NULL) {
 			throw new SQLException(TSDBConstants.FixErrMsg(TSDBConstants.JNI_CONNECTION_NULL));
 		} else if (code == TSDBConstants.JNI_RESULT_SET_NULL) {
@@ -131,12 +148,18 @@ public class TSDBResultSet implements ResultSet {
 			throw new SQLException(TSDBConstants.FixErrMsg(TSDBConstants.JNI_NUM_OF_FIELDS_0));
 		} else if (code == TSDBConstants.JNI_FETCH_END) {
 			return false;
+		} else if (code < 0) {
+			throw new SQLException(TSDBConstants.FixErrMsg(code));
 		} else {
 			return true;
 		}
 	}
 
 	public void close() throws SQLException {
+		if (this.blockData != null) {
+			this.blockData.clear();
+		}
+
 		if (this.jniConnector != null) {
 			int code = this.jniConnector.freeResultSet(this.resultSetPointer);
 			if (code == TSDBConstants.JNI_CONNECTION_NULL) {
@@ -0,0 +1,256 @@
+/***************************************************************************
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *****************************************************************************/
+package com.taosdata.jdbc;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+import java.sql.SQLException;
+import java.sql.Timestamp;
+import java.util.Arrays;
+import java.util.List;
+
+/**
+ * The rows of one block fetched by JNI. The values of each column are read from direct byte buffers referring to the
+ * native result, so they are valid until the next block is fetched or the result set is closed. The row data
+ * methods read the values of the current row.
+ */
+public class TSDBResultSetBlockData extends TSDBResultSetRowData {
+	private int numOfRows = 0;
+	private int rowIndex = 0;
+	private int lengthBytes = 8;
+
+	private int[] types;
+	private ByteBuffer[] data;
+	private int[] bytes;
+	private ByteBuffer[] lengths;
+	private ByteBuffer[] isNull;
+
+	public TSDBResultSetBlockData(List<ColumnMetaData> columnMetaDataList) {
+		super(columnMetaDataList.size());
+
+		int colSize = columnMetaDataList.size();
+		this.types = new int[colSize];
+		this.data = new ByteBuffer[colSize];
+		this.bytes = new int[colSize];
+		this.lengths = new ByteBuffer[colSize];
+		this.isNull = new ByteBuffer[colSize];
+
+		for (int i = 0; i < colSize; i++) {
+			this.types[i] = columnMetaDataList.get(i).getColType();
+		}
+	}
+
+	/**
+	 * Called by JNI before the columns of a new block are set, the lengths of binary and nchar values are native
+	 * unsigned long values of lengthBytes bytes
+	 */
+	public void reset(int numOfRows, int lengthBytes) {
+		this.numOfRows = numOfRows;
+		this.rowIndex = 0;
+		this.lengthBytes = lengthBytes;
+	}
+
+	/**
+	 * Called by JNI for each column, the value of row i is at i * bytes of data
+	 */
+	public void setColumn(int col, ByteBuffer data, int bytes, ByteBuffer length, ByteBuffer isNull) {
+		this.data[col] = data.order(ByteOrder.nativeOrder());
+		this.bytes[col] = bytes;
+		this.lengths[col] = (length == null) ? null : length.order(ByteOrder.nativeOrder());
+		this.isNull[col] = isNull;
+	}
+
+	/**
+	 * Move to the next row of the block, returns false if the rows of the block are exhausted
+	 */
+	public boolean forward() {
+		if (this.rowIndex + 1 < this.numOfRows) {
+			this.rowIndex++;
+			return true;
+		}
+
+		this.numOfRows = 0;
+		return false;
+	}
+
+	public int getNumOfRows() {
+		return numOfRows;
+	}
+
+	/**
+	 * Drop the buffers of the block once the native result is freed, called by the constructor of super class too
+	 */
+	@Override
+	public void clear() {
+		this.numOfRows = 0;
+		this.rowIndex = 0;
+
+		if (this.data != null) {
+			Arrays.fill(this.data, null);
+			Arrays.fill(this.lengths, null);
+			Arrays.fill(this.isNull, null);
+		}
+	}
+
+	@Override
+	public boolean wasNull(int col) {
+		return this.isNull[col].get(this.rowIndex) != 0;
+	}
+
+	private int offset(int col) {
+		return this.rowIndex * this.bytes[col];
+	}
+
+	private int length(int col) {
+		if (this.lengthBytes == 8) {
+			return (int) this.lengths[col].getLong(this.rowIndex * 8);
+		} else {
+			return this.lengths[col].getInt(this.rowIndex * 4);
+		}
+	}
+
+	private String readString(int col, int srcType) throws SQLException {
+		ByteBuffer buffer = this.data[col].duplicate();
+		buffer.position(offset(col));
+
+		byte[] value = new byte[length(col)];
+		buffer.get(value);
+
+		if (srcType == TSDBConstants.TSDB_DATA_TYPE_BINARY) {
+			return new String(value, StandardCharsets.UTF_8);
+		}
+
+		try {
+			return new String(value, TaosGlobalConfig.getCharset());
+		} catch (Exception e) {
+			throw new SQLException(TSDBConstants.WrapErrMsg("Unsupported encoding: " + TaosGlobalConfig.getCharset()));
+		}
+	}
+
+	@Override
+	public boolean getBoolean(int col, int srcType) throws SQLException {
+		switch (srcType) {
+		case TSDBConstants.TSDB_DATA_TYPE_BOOL:    return this.data[col].get(offset(col)) == 1;
+		case TSDBConstants.TSDB_DATA_TYPE_FLOAT:
+		case TSDBConstants.TSDB_DATA_TYPE_DOUBLE:  return getDouble(col, srcType) == 1.0;
+		case TSDBConstants.TSDB_DATA_TYPE_TINYINT:
+		case TSDBConstants.TSDB_DATA_TYPE_SMALLINT:
+		case TSDBConstants.TSDB_DATA_TYPE_INT:
+		case TSDBConstants.TSDB_DATA_TYPE_TIMESTAMP:
+		case TSDBConstants.TSDB_DATA_TYPE_BIGINT:  return getLong(col, srcType) == 1L;
+		}
+
+		return Boolean.TRUE;
+	}
+
+	@Override
+	public int getInt(int col, int srcType) throws SQLException {
+		switch (srcType) {
+		case TSDBConstants.TSDB_DATA_TYPE_NCHAR:
+		case TSDBConstants.TSDB_DATA_TYPE_BINARY:  return Integer.parseInt(readString(col, srcType));
+		}
+
+		return (int) getLong(col, srcType);
+	}
+
+	@Override
+	public long getLong(int col, int srcType) throws SQLException {
+		ByteBuffer buffer = this.data[col];
+		int offset = offset(col);
+
+		switch (srcType) {
+		case TSDBConstants.TSDB_DATA_TYPE_BOOL:    return buffer.get(offset) == 1 ? 1 : 0;
+		case TSDBConstants.TSDB_DATA_TYPE_FLOAT:   return (long) buffer.getFloat(offset);
+		case TSDBConstants.TSDB_DATA_TYPE_DOUBLE:  return (long) buffer.getDouble(offset);
+		case TSDBConstants.TSDB_DATA_TYPE_TINYINT: return buffer.get(offset);
+		case TSDBConstants.TSDB_DATA_TYPE_SMALLINT:return buffer.getShort(offset);
+		case TSDBConstants.TSDB_DATA_TYPE_INT:     return buffer.getInt(offset);
+		case TSDBConstants.TSDB_DATA_TYPE_TIMESTAMP:
+		case TSDBConstants.TSDB_DATA_TYPE_BIGINT:  return buffer.getLong(offset);
+		case TSDBConstants.TSDB_DATA_TYPE_NCHAR:
+		case TSDBConstants.TSDB_DATA_TYPE_BINARY:  return Long.parseLong(readString(col, srcType));
+		}
+
+		return 0;
+	}
+
+	@Override
+	public float getFloat(int col, int srcType) throws SQLException {
+		switch (srcType) {
+		case TSDBConstants.TSDB_DATA_TYPE_FLOAT:   return this.data[col].getFloat(offset(col));
+		case TSDBConstants.TSDB_DATA_TYPE_DOUBLE:  return (float) this.data[col].getDouble(offset(col));
+		case TSDBConstants.TSDB_DATA_TYPE_NCHAR:
+		case TSDBConstants.TSDB_DATA_TYPE_BINARY:  return 0;
+		}
+
+		return getLong(col, srcType);
+	}
+
+	@Override
+	public double getDouble(int col, int srcType) throws SQLException {
+		switch (srcType) {
+		case TSDBConstants.TSDB_DATA_TYPE_FLOAT:   return this.data[col].getFloat(offset(col));
+		case TSDBConstants.TSDB_DATA_TYPE_DOUBLE:  return this.data[col].getDouble(offset(col));
+		case TSDBConstants.TSDB_DATA_TYPE_NCHAR:
+		case TSDBConstants.TSDB_DATA_TYPE_BINARY:  return 0;
+		}
+
+		return getLong(col, srcType);
+	}
+
+	@Override
+	public String getString(int col, int srcType) throws SQLException {
+		if (srcType == TSDBConstants.TSDB_DATA_TYPE_BINARY || srcType == TSDBConstants.TSDB_DATA_TYPE_NCHAR) {
+			return readString(col, srcType);
+		} else {
+			return String.valueOf(get(col));
+		}
+	}
+
+	@Override
+	public Timestamp getTimestamp(int col) {
+		return new Timestamp(this.data[col].getLong(offset(col)));
+	}
+
+	@Override
+	public Object get(int col) {
+		if (wasNull(col)) {
+			return null;
+		}
+
+		ByteBuffer buffer = this.data[col];
+		int offset = offset(col);
+
+		try {
+			switch (this.types[col]) {
+			case TSDBConstants.TSDB_DATA_TYPE_BOOL:    return buffer.get(offset) == 1;
+			case TSDBConstants.TSDB_DATA_TYPE_TINYINT: return buffer.get(offset);
+			case TSDBConstants.TSDB_DATA_TYPE_SMALLINT:return buffer.getShort(offset);
+			case TSDBConstants.TSDB_DATA_TYPE_INT:     return buffer.getInt(offset);
+			case TSDBConstants.TSDB_DATA_TYPE_TIMESTAMP:
+			case TSDBConstants.TSDB_DATA_TYPE_BIGINT:  return buffer.getLong(offset);
+			case TSDBConstants.TSDB_DATA_TYPE_FLOAT:   return buffer.getFloat(offset);
+			case TSDBConstants.TSDB_DATA_TYPE_DOUBLE:  return buffer.getDouble(offset);
+			case TSDBConstants.TSDB_DATA_TYPE_NCHAR:
+			case TSDBConstants.TSDB_DATA_TYPE_BINARY:  return readString(col, this.types[col]);
+			}
+		} catch (SQLException e) {
+			e.printStackTrace();
+		}
+
+		return null;
+	}
+}
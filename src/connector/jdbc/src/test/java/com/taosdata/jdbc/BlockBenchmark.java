@@ -0,0 +1,182 @@
+package com.taosdata.jdbc;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.sql.*;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Properties;
+
+/**
+ * Compare inserting by sql with inserting by blocks, and fetching by rows with fetching by blocks. It is not run as a
+ * unit test, run it with the class path of the test classes:
+ * java -Djava.library.path=... com.taosdata.jdbc.BlockBenchmark [host] [rows] [warmup] [iterations]
+ */
+public class BlockBenchmark {
+    static String dbName = "test";
+    static String tName = "bench";
+    static int batchRows = 4096;
+
+    interface Op {
+        void run() throws SQLException;
+    }
+
+    static Connection connection;
+    static Statement statement;
+    static TSDBJNIConnector connector;
+    static int numOfRows;
+    static long startTs = 1496732686000l;
+
+    public static void main(String[] args) throws Exception {
+        String host = args.length > 0 ? args[0] : "localhost";
+        numOfRows = args.length > 1 ? Integer.parseInt(args[1]) : 1000000;
+        int warmup = args.length > 2 ? Integer.parseInt(args[2]) : 2;
+        int iterations = args.length > 3 ? Integer.parseInt(args[3]) : 5;
+
+        Class.forName("com.taosdata.jdbc.TSDBDriver");
+        Properties properties = new Properties();
+        properties.setProperty(TSDBDriver.PROPERTY_KEY_HOST, host);
+        properties.setProperty(TSDBDriver.PROPERTY_KEY_CHARSET, "UTF-8");
+        properties.setProperty(TSDBDriver.PROPERTY_KEY_LOCALE, "en_US.UTF-8");
+        properties.setProperty(TSDBDriver.PROPERTY_KEY_TIME_ZONE, "UTC-8");
+        properties.setProperty(TSDBDriver.PROPERTY_KEY_BATCH_FETCH, "true");
+        connection = DriverManager.getConnection("jdbc:TAOS://" + host + ":0/" + "?user=root&password=taosdata"
+                , properties);
+        statement = connection.createStatement();
+        connector = ((TSDBConnection) connection).getConnection();
+        statement.executeUpdate("create database if not exists " + dbName);
+
+        measure("insert by sql", warmup, iterations, new Op() {
+            public void run() throws SQLException {
+                insertBySql();
+            }
+        });
+        measure("insert by block", warmup, iterations, new Op() {
+            public void run() throws SQLException {
+                insertByBlock();
+            }
+        });
+        measure("fetch by row", warmup, iterations, new Op() {
+            public void run() throws SQLException {
+                fetchByRow();
+            }
+        });
+        measure("fetch by block", warmup, iterations, new Op() {
+            public void run() throws SQLException {
+                fetchByBlock();
+            }
+        });
+
+        statement.executeUpdate("drop table if exists " + dbName + "." + tName);
+        statement.close();
+        connection.close();
+    }
+
+    static void measure(String name, int warmup, int iterations, Op op) throws SQLException {
+        for (int i = 0; i < warmup; i++) {
+            op.run();
+        }
+
+        double[] rates = new double[iterations];
+        double sum = 0;
+        for (int i = 0; i < iterations; i++) {
+            long start = System.nanoTime();
+            op.run();
+            rates[i] = numOfRows / ((System.nanoTime() - start) / 1e9);
+            sum += rates[i];
+        }
+
+        double mean = sum / iterations;
+        double var = 0;
+        for (double r : rates) {
+            var += (r - mean) * (r - mean);
+        }
+        double stddev = iterations > 1 ? Math.sqrt(var / (iterations - 1)) : 0;
+        System.out.printf("%-16s %12.0f +- %10.0f rows/s%n", name, mean, stddev);
+    }
+
+    static void recreateTable() throws SQLException {
+        statement.executeUpdate("drop table if exists " + dbName + "." + tName);
+        statement.executeUpdate("create table " + dbName + "." + tName + " (ts timestamp, k int, v double, s binary(16))");
+    }
+
+    static void insertBySql() throws SQLException {
+        recreateTable();
+        for (int i = 0; i < numOfRows; ) {
+            StringBuilder sql = new StringBuilder("insert into " + dbName + "." + tName + " values");
+            for (int j = 0; j < 1000 && i < numOfRows; j++, i++) {
+                sql.append(" (").append(startTs + i).append(", ").append(i).append(", ").append(i * 0.5)
+                        .append(", 's").append(i % 1000).append("')");
+            }
+            statement.executeUpdate(sql.toString());
+        }
+    }
+
+    static void insertByBlock() throws SQLException {
+        recreateTable();
+        ByteBuffer tsBuf = ByteBuffer.allocateDirect(batchRows * 8).order(ByteOrder.nativeOrder());
+        ByteBuffer kBuf = ByteBuffer.allocateDirect(batchRows * 4).order(ByteOrder.nativeOrder());
+        ByteBuffer vBuf = ByteBuffer.allocateDirect(batchRows * 8).order(ByteOrder.nativeOrder());
+        ByteBuffer sBuf = ByteBuffer.allocateDirect(batchRows * 16).order(ByteOrder.nativeOrder());
+        ByteBuffer sLen = ByteBuffer.allocateDirect(batchRows * 4).order(ByteOrder.nativeOrder());
+
+        int[] types = new int[]{TSDBConstants.TSDB_DATA_TYPE_TIMESTAMP, TSDBConstants.TSDB_DATA_TYPE_INT,
+                TSDBConstants.TSDB_DATA_TYPE_DOUBLE, TSDBConstants.TSDB_DATA_TYPE_BINARY};
+        int[] bytes = new int[]{8, 4, 8, 16};
+        ByteBuffer[] data = new ByteBuffer[]{tsBuf, kBuf, vBuf, sBuf};
+        ByteBuffer[] lengths = new ByteBuffer[]{null, null, null, sLen};
+
+        for (int i = 0; i < numOfRows; ) {
+            int rows = Math.min(batchRows, numOfRows - i);
+            for (int j = 0; j < rows; j++, i++) {
+                tsBuf.putLong(j * 8, startTs + i);
+                kBuf.putInt(j * 4, i);
+                vBuf.putDouble(j * 8, i * 0.5);
+                byte[] s = ("s" + i % 1000).getBytes();
+                for (int b = 0; b < s.length; b++) {
+                    sBuf.put(j * 16 + b, s[b]);
+                }
+                sLen.putInt(j * 4, s.length);
+            }
+            connector.insertBlock(dbName + "." + tName, rows, types, bytes, data, lengths, null);
+        }
+    }
+
+    static void fetchByRow() throws SQLException {
+        connector.executeQuery("select * from " + dbName + "." + tName);
+        long resultSet = connector.getResultSet();
+        List<ColumnMetaData> columnMetaData = new ArrayList<ColumnMetaData>();
+        connector.getSchemaMetaData(resultSet, columnMetaData);
+
+        TSDBResultSetRowData rowData = new TSDBResultSetRowData(columnMetaData.size());
+        long sum = 0;
+        while (connector.fetchRow(resultSet, rowData) == TSDBConstants.JNI_SUCCESS) {
+            sum += rowData.getLong(0, TSDBConstants.TSDB_DATA_TYPE_TIMESTAMP);
+            sum += rowData.getInt(1, TSDBConstants.TSDB_DATA_TYPE_INT);
+            sum += (long) rowData.getDouble(2, TSDBConstants.TSDB_DATA_TYPE_DOUBLE);
+            sum += rowData.getString(3, TSDBConstants.TSDB_DATA_TYPE_BINARY).length();
+            rowData.clear();
+        }
+        connector.freeResultSet(resultSet);
+        consume(sum);
+    }
+
+    static void fetchByBlock() throws SQLException {
+        ResultSet resSet = statement.executeQuery("select * from " + dbName + "." + tName);
+        long sum = 0;
+        while (resSet.next()) {
+            sum += resSet.getLong(1);
+            sum += resSet.getInt(2);
+            sum += (long) resSet.getDouble(3);
+            sum += resSet.getString(4).length();
+        }
+        resSet.close();
+        consume(sum);
+    }
+
+    static long sink;
+
+    static void consume(long sum) {
+        sink += sum;
+    }
+}
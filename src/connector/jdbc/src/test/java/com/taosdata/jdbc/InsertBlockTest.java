@@ -0,0 +1,131 @@
+package com.taosdata.jdbc;
+
+import org.junit.AfterClass;
+import org.junit.BeforeClass;
+import org.junit.Test;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.charset.StandardCharsets;
+import java.sql.*;
+import java.util.Properties;
+
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNull;
+import static org.junit.Assert.assertTrue;
+
+public class InsertBlockTest {
+    static Connection connection = null;
+    static Statement statement = null;
+    static Connection batchConnection = null;
+    static Statement batchStatement = null;
+    static String dbName = "test";
+    static String tName = "tb";
+    static String host = "localhost";
+
+    @BeforeClass
+    public static void createDatabaseAndTable() throws SQLException {
+        try {
+            Class.forName("com.taosdata.jdbc.TSDBDriver");
+        } catch (ClassNotFoundException e) {
+            return;
+        }
+        Properties properties = new Properties();
+        properties.setProperty(TSDBDriver.PROPERTY_KEY_HOST, host);
+        properties.setProperty(TSDBDriver.PROPERTY_KEY_CHARSET, "UTF-8");
+        properties.setProperty(TSDBDriver.PROPERTY_KEY_LOCALE, "en_US.UTF-8");
+        properties.setProperty(TSDBDriver.PROPERTY_KEY_TIME_ZONE, "UTC-8");
+
+        connection = DriverManager.getConnection("jdbc:TAOS://" + host + ":0/" + "?user=root&password=taosdata"
+                , properties);
+
+        statement = connection.createStatement();
+
+        properties.setProperty(TSDBDriver.PROPERTY_KEY_BATCH_FETCH, "true");
+        batchConnection = DriverManager.getConnection("jdbc:TAOS://" + host + ":0/" + "?user=root&password=taosdata"
+                , properties);
+        batchStatement = batchConnection.createStatement();
+
+        statement.executeUpdate("create database if not exists " + dbName);
+        statement.executeUpdate("drop table if exists " + dbName + "." + tName);
+        statement.executeUpdate("create table " + dbName + "." + tName + " (ts timestamp, k int, v double, s binary(16))");
+    }
+
+    @Test
+    public void testInsertAndFetchBlock() throws SQLException {
+        int numOfRows = 10000;
+        long ts = 1496732686000l;
+
+        ByteBuffer tsBuf = ByteBuffer.allocateDirect(numOfRows * 8).order(ByteOrder.nativeOrder());
+        ByteBuffer kBuf = ByteBuffer.allocateDirect(numOfRows * 4).order(ByteOrder.nativeOrder());
+        ByteBuffer vBuf = ByteBuffer.allocateDirect(numOfRows * 8).order(ByteOrder.nativeOrder());
+        ByteBuffer sBuf = ByteBuffer.allocateDirect(numOfRows * 16).order(ByteOrder.nativeOrder());
+        ByteBuffer sLen = ByteBuffer.allocateDirect(numOfRows * 4).order(ByteOrder.nativeOrder());
+        ByteBuffer kNull = ByteBuffer.allocateDirect(numOfRows);
+
+        for (int i = 0; i < numOfRows; i++) {
+            tsBuf.putLong(i * 8, ts + i);
+            kBuf.putInt(i * 4, i);
+            vBuf.putDouble(i * 8, i * 0.5);
+            byte[] s = ("s" + i).getBytes(StandardCharsets.UTF_8);
+            for (int j = 0; j < s.length; j++) {
+                sBuf.put(i * 16 + j, s[j]);
+            }
+            sLen.putInt(i * 4, s.length);
+            kNull.put(i, (byte) (i % 10 == 0 ? 1 : 0));
+        }
+
+        TSDBJNIConnector connector = ((TSDBConnection) connection).getConnection();
+        int rows = connector.insertBlock(dbName + "." + tName, numOfRows,
+                new int[]{TSDBConstants.TSDB_DATA_TYPE_TIMESTAMP, TSDBConstants.TSDB_DATA_TYPE_INT,
+                        TSDBConstants.TSDB_DATA_TYPE_DOUBLE, TSDBConstants.TSDB_DATA_TYPE_BINARY},
+                new int[]{8, 4, 8, 16},
+                new ByteBuffer[]{tsBuf, kBuf, vBuf, sBuf},
+                new ByteBuffer[]{null, null, null, sLen},
+                new ByteBuffer[]{null, kNull, null, null});
+        assertEquals(numOfRows, rows);
+
+        // read back row by row, and block by block with batchfetch
+        checkRows(statement, numOfRows, ts);
+        checkRows(batchStatement, numOfRows, ts);
+    }
+
+    private void checkRows(Statement stmt, int numOfRows, long ts) throws SQLException {
+        ResultSet resSet = stmt.executeQuery("select * from " + dbName + "." + tName);
+        int i = 0;
+        while (resSet.next()) {
+            assertEquals(ts + i, resSet.getTimestamp(1).getTime());
+            if (i % 10 == 0) {
+                assertEquals(0, resSet.getInt(2));
+                assertTrue(resSet.wasNull());
+                assertNull(resSet.getObject(2));
+            } else {
+                assertEquals(i, resSet.getInt(2));
+            }
+            assertEquals(i * 0.5, resSet.getDouble(3), 0);
+            assertEquals("s" + i, resSet.getString(4));
+            i++;
+        }
+        resSet.close();
+        assertEquals(numOfRows, i);
+    }
+
+    @Test(expected = SQLException.class)
+    public void testInsertIntoMissingTable() throws SQLException {
+        ByteBuffer tsBuf = ByteBuffer.allocateDirect(8).order(ByteOrder.nativeOrder());
+        tsBuf.putLong(0, 1496732686000l);
+
+        TSDBJNIConnector connector = ((TSDBConnection) connection).getConnection();
+        connector.insertBlock(dbName + ".no_such_table", 1, new int[]{TSDBConstants.TSDB_DATA_TYPE_TIMESTAMP},
+                new int[]{8}, new ByteBuffer[]{tsBuf}, null, null);
+    }
+
+    @AfterClass
+    public static void close() throws Exception {
+        batchStatement.close();
+        batchConnection.close();
+        statement.executeUpdate("drop table if exists " + dbName + "." + tName);
+        statement.close();
+        connection.close();
+    }
+}
@@ -3,6 +3,12 @@ from .constants import FieldType
 from .error import *
 import math
 import datetime
+import array
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
 
 def _convert_millisecond_to_datetime(milli):
     return datetime.datetime.fromtimestamp(milli/1000.0)
@@ -134,6 +140,68 @@ class TaosField(ctypes.Structure):
                 ('type', ctypes.c_char),
                 ('bytes', ctypes.c_short)]
 
+# Corresponding TAOS_COLUMN_BIND structure in C
+class TaosColumnBind(ctypes.Structure):
+    _fields_ = [('buffer_type', ctypes.c_int),
+                ('buffer', ctypes.c_void_p),
+                ('buffer_length', ctypes.c_ulong),
+                ('length', ctypes.POINTER(ctypes.c_ulong)),
+                ('is_null', ctypes.c_void_p)]
+
+# array typecode, numpy dtype and size of the fixed width types
+_COLUMN_TYPES = {
+    FieldType.C_BOOL: ('b', 'int8', 1),
+    FieldType.C_TINYINT: ('b', 'int8', 1),
+    FieldType.C_SMALLINT: ('h', 'int16', 2),
+    FieldType.C_INT: ('i', 'int32', 4),
+    FieldType.C_BIGINT: ('q', 'int64', 8),
+    FieldType.C_FLOAT: ('f', 'float32', 4),
+    FieldType.C_DOUBLE: ('d', 'float64', 8),
+    FieldType.C_TIMESTAMP: ('q', 'int64', 8),
+}
+
+def _ccolumn_to_python(bind, num_of_rows, micro=False, use_numpy=False):
+    """Function to convert the values of one C column to python, the values are copied by memoryview or numpy
+    without touching each value in python, except for binary and nchar values which are decoded to str.
+
+    @rtype: (values, is_null), is_null has one flag for each row which is nonzero for null. With numpy, values and
+            is_null are numpy arrays, timestamps are datetime64 and binary or nchar values are in an object array.
+            Otherwise values is an array.array of int timestamps and numbers, or a list of str, and is_null is bytes.
+    """
+    stride = bind.buffer_length
+    is_null = ctypes.string_at(bind.is_null, num_of_rows)
+
+    if bind.buffer_type in (FieldType.C_BINARY, FieldType.C_NCHAR):
+        lengths = bind.length[:num_of_rows]
+        raw = ctypes.string_at(bind.buffer, (num_of_rows - 1) * stride + lengths[-1])
+        values = [None if is_null[i] else raw[i * stride:i * stride + lengths[i]].decode('utf-8')
+                  for i in range(num_of_rows)]
+        if use_numpy:
+            values = numpy.array(values, dtype=object)
+            is_null = numpy.frombuffer(is_null, dtype=numpy.bool_)
+        return values, is_null
+
+    if bind.buffer_type not in _COLUMN_TYPES:
+        raise DatabaseError("Invalid data type returned from database")
+
+    typecode, dtype, size = _COLUMN_TYPES[bind.buffer_type]
+    cbuf = (ctypes.c_char * ((num_of_rows - 1) * stride + size)).from_address(bind.buffer)
+
+    if use_numpy:
+        values = numpy.ndarray((num_of_rows, ), dtype=dtype, buffer=cbuf, strides=(stride, )).copy()
+        if bind.buffer_type == FieldType.C_BOOL:
+            values = values.astype(numpy.bool_)
+        elif bind.buffer_type == FieldType.C_TIMESTAMP:
+            values = values.view('datetime64[us]' if micro else 'datetime64[ms]')
+        return values, numpy.frombuffer(is_null, dtype=numpy.bool_)
+
+    values = array.array(typecode)
+    if stride == size:
+        values.frombytes(cbuf)
+    else:
+        values.frombytes(b''.join(cbuf[i * stride:i * stride + size] for i in range(num_of_rows)))
+    return values, is_null
+
 # C interface class
 class CTaosInterface(object):
 
@@ -333,6 +401,24 @@ class CTaosInterface(object):
 
         return blocks, abs(num_of_rows)
 
+    @staticmethod
+    def fetchBlockColumns(result, fields, use_numpy=False):
+        """Fetch the rows of one block column by column, see _ccolumn_to_python for the values of each column.
+        """
+        columns = (TaosColumnBind * len(fields))()
+        num_of_rows = CTaosInterface.libtaos.taos_fetch_block_columns(result, columns)
+
+        if num_of_rows == 0:
+            errno = CTaosInterface.libtaos.taos_errno(result)
+            if errno != 0:
+                raise OperationalError(CTaosInterface.errStr(result), errno)
+            return None, 0
+
+        isMicro = (CTaosInterface.libtaos.taos_result_precision(result) == FieldType.C_TIMESTAMP_MICRO)
+        blocks = [_ccolumn_to_python(columns[i], num_of_rows, isMicro, use_numpy) for i in range(len(fields))]
+
+        return blocks, num_of_rows
+
     @staticmethod
     def freeResult(result):
         CTaosInterface.libtaos.taos_free_result(result)
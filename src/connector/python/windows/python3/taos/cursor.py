@@ -1,5 +1,7 @@
-from .cinterface import CTaosInterface
+from .cinterface import CTaosInterface, numpy, _COLUMN_TYPES
 from .error import *
+from .constants import FieldType
+import array
 
 class TDengineCursor(object):
     """Database cursor which is used to manage the context of a fetch operation.
@@ -150,7 +152,53 @@ class TDengineCursor(object):
         
         return list(map(tuple, zip(*buffer)))
 
+    def fetch_columns(self, use_numpy=None):
+        """Fetch all (remaining) rows of a query result column by column, returning a list of (values, is_null) for
+        each column. With numpy, which is used if it is installed unless use_numpy is False, values and is_null are
+        numpy arrays, e.g. numpy.ma.masked_array(values, is_null) for the masked column, and timestamps are
+        datetime64. Otherwise values is an array.array or a list of str, and is_null is bytes. Rows may be fetched by
+        either fetchall or fetch_columns, but not both.
+        """
+        if self._result is None or self._fields is None:
+            raise OperationalError("Invalid use of fetch_columns")
+
+        if use_numpy is None:
+            use_numpy = numpy is not None
+        elif use_numpy and numpy is None:
+            raise InterfaceError("numpy is not installed")
 
+        chunks = [[] for i in range(len(self._fields))]
+        self._rowcount = 0
+        while True:
+            block, num_of_rows = CTaosInterface.fetchBlockColumns(
+                self._result, self._fields, use_numpy)
+            if num_of_rows == 0:
+                break
+            self._rowcount += num_of_rows
+            for i in range(len(self._fields)):
+                chunks[i].append(block[i])
+
+        return [self._concat_column(i, chunks[i], use_numpy) for i in range(len(self._fields))]
+
+    def _concat_column(self, col, chunks, use_numpy):
+        """Concatenate the values of one column fetched in blocks.
+        """
+        if len(chunks) == 1:
+            return chunks[0]
+
+        ftype = self._fields[col]['type']
+        isString = ftype not in _COLUMN_TYPES
+        if use_numpy:
+            if len(chunks) == 0:
+                return (numpy.array([], dtype=object if isString else _COLUMN_TYPES[ftype][1]),
+                        numpy.array([], dtype=numpy.bool_))
+            return (numpy.concatenate([values for values, is_null in chunks]),
+                    numpy.concatenate([is_null for values, is_null in chunks]))
+
+        values = [] if isString else array.array(_COLUMN_TYPES[ftype][0])
+        for v, is_null in chunks:
+            values.extend(v)
+        return values, b''.join([is_null for v, is_null in chunks])
 
     def nextset(self):
         """
@@ -28,6 +28,7 @@ typedef void    TAOS_RES;
 typedef void    TAOS_SUB;
 typedef void    TAOS_STREAM;
 typedef void    TAOS_STMT;
+typedef void    TAOS_INGEST;
 
 // Data type definition
 #define TSDB_DATA_TYPE_NULL       0     // 1 bytes
@@ -80,14 +81,74 @@ typedef struct TAOS_BIND {
   int *          error;        // unused
 } TAOS_BIND;
 
+// values of one column for all rows, the value of row i is at buffer + i * buffer_length
+typedef struct TAOS_COLUMN_BIND {
+  int            buffer_type;
+  void *         buffer;
+  unsigned long  buffer_length;  // size of each value, the maximum length for binary and nchar
+  unsigned long *length;         // actual length of each binary or nchar value, NULL if terminated by '\0'
+  char *         is_null;        // null flag of each row, NULL if there is no null value
+} TAOS_COLUMN_BIND;
+
 TAOS_STMT *taos_stmt_init(TAOS *taos);
 int        taos_stmt_prepare(TAOS_STMT *stmt, const char *sql, unsigned long length);
 int        taos_stmt_bind_param(TAOS_STMT *stmt, TAOS_BIND *bind);
+
+/*
+ * the rows bound afterwards are inserted into the named table, which has the same schema as the table in the
+ * prepared sql. With tags, the table is created from the super table in the USING clause if it does not exist.
+ */
+int        taos_stmt_set_tbname(TAOS_STMT *stmt, const char *name);
+int        taos_stmt_set_tbname_tags(TAOS_STMT *stmt, const char *name, TAOS_BIND *tags);
+
+// bind the values of num_of_rows rows at once, one TAOS_COLUMN_BIND for each parameter
+int        taos_stmt_bind_param_batch(TAOS_STMT *stmt, TAOS_COLUMN_BIND *bind, int num_of_rows);
+
 int        taos_stmt_add_batch(TAOS_STMT *stmt);
 int        taos_stmt_execute(TAOS_STMT *stmt);
 TAOS_RES * taos_stmt_use_result(TAOS_STMT *stmt);
 int        taos_stmt_close(TAOS_STMT *stmt);
 
+typedef struct TAOS_TABLE_BIND {
+  const char *      table_name;  // [db_name.]table_name
+  int               num_of_rows;
+  TAOS_COLUMN_BIND *columns;     // all columns of the table in the order of the table schema
+} TAOS_TABLE_BIND;
+
+/*
+ * insert the values of typed arrays into several tables without constructing and parsing sql string,
+ * at most 32767 rows for each table in one call. The result is checked by taos_errno and taos_affected_rows,
+ * and must be freed by taos_free_result.
+ */
+DLL_EXPORT TAOS_RES *taos_insert_columns(TAOS *taos, TAOS_TABLE_BIND *tables, int num_of_tables);
+
+typedef struct TAOS_TABLE_TAGS {
+  const char *stable_name;  // [db_name.]stable_name, NULL if the table is not created automatically
+  TAOS_BIND * tags;         // all tags of the super table in the order of the super table schema
+} TAOS_TABLE_TAGS;
+
+/*
+ * same as taos_insert_columns, and the table of tables[i] is created from the super table with the tags of tags[i]
+ * if it does not exist, like the USING clause of insert sql. The tags are ignored if the table exists.
+ */
+DLL_EXPORT TAOS_RES *taos_insert_columns_auto(TAOS *taos, TAOS_TABLE_BIND *tables, TAOS_TABLE_TAGS *tags, int num_of_tables);
+
+/*
+ * pipelined asynchronous insertion. The rows written are accumulated in one submit message per vgroup, which is sent
+ * once batch_rows rows are accumulated, or linger_ms milliseconds after its first row arrives (never if 0). At most
+ * max_in_flight submit messages are not acknowledged for each vgroup, taos_ingest_write blocks until a submit message
+ * is acknowledged when the limit is reached. The acknowledgement of each submit message is reported to fp, which
+ * must not call taos_ingest_write/flush/close. taos_ingest_flush sends all accumulated rows and waits for the
+ * acknowledgements, and returns the first error since the last flush.
+ */
+typedef void (*TAOS_INGEST_CALLBACK)(TAOS_INGEST *ingest, void *param, int code, int affected_rows);
+DLL_EXPORT TAOS_INGEST *taos_ingest_open(TAOS *taos, int batch_rows, int linger_ms, int max_in_flight, TAOS_INGEST_CALLBACK fp, void *param);
+DLL_EXPORT int          taos_ingest_write(TAOS_INGEST *ingest, TAOS_TABLE_BIND *tables, int num_of_tables);
+// same as taos_ingest_write, and the missing tables are created like taos_insert_columns_auto
+DLL_EXPORT int          taos_ingest_write_auto(TAOS_INGEST *ingest, TAOS_TABLE_BIND *tables, TAOS_TABLE_TAGS *tags, int num_of_tables);
+DLL_EXPORT int          taos_ingest_flush(TAOS_INGEST *ingest);
+DLL_EXPORT void         taos_ingest_close(TAOS_INGEST *ingest);
+
 DLL_EXPORT TAOS_RES *taos_query(TAOS *taos, const char *sql);
 DLL_EXPORT TAOS_ROW taos_fetch_row(TAOS_RES *res);
 DLL_EXPORT int taos_result_precision(TAOS_RES *res);  // get the time precision of result
@@ -101,6 +162,15 @@ DLL_EXPORT int taos_print_row(char *str, TAOS_ROW row, TAOS_FIELD *fields, int n
 DLL_EXPORT void taos_stop_query(TAOS_RES *res);
 
 int taos_fetch_block(TAOS_RES *res, TAOS_ROW *rows);
+
+/*
+ * fetch the remaining rows of the current block, or the next block if the current one is exhausted. The values of
+ * column i are described by columns[i] like taos_stmt_bind_param_batch: the value of row j is at
+ * buffer + j * buffer_length, the binary and nchar values are not terminated and their lengths are in length, and
+ * is_null is never NULL. The buffers belong to the result, and are valid until the next fetch. Returns the number of
+ * rows, 0 if all rows are fetched or an error occurs, which is checked by taos_errno.
+ */
+DLL_EXPORT int taos_fetch_block_columns(TAOS_RES *res, TAOS_COLUMN_BIND *columns);
 int taos_validate_sql(TAOS *taos, const char *sql);
 
 int* taos_fetch_lengths(TAOS_RES *res);
@@ -130,6 +200,13 @@ DLL_EXPORT void taos_close_stream(TAOS_STREAM *tstr);
 
 DLL_EXPORT int taos_load_table_info(TAOS *taos, const char* tableNameList);
 
+/*
+ * prefetch the metas of all child tables of a super table into the local cache, so the later insertions into any of
+ * these tables do not need to retrieve the table meta from mnode one by one. The cached metas expire as other table
+ * metas do, and are discarded once the client finds that the super table has been altered.
+ */
+DLL_EXPORT int taos_load_stable_meta(TAOS *taos, const char *stable_name);
+
 #ifdef __cplusplus
 }
 #endif
@@ -260,6 +260,7 @@ void tsDataSwap(void *pLeft, void *pRight, int32_t type, int32_t size);
 
 #define TSDB_TBNAME_COLUMN_INDEX       (-1)
 #define TSDB_MULTI_METERMETA_MAX_NUM    100000  // maximum batch size allowed to load metermeta
+#define TSDB_MAX_CHILDREN_PER_PAGE      10000   // maximum number of child table meta in one page
 
 #define TSDB_MIN_CACHE_BLOCK_SIZE       1
 #define TSDB_MAX_CACHE_BLOCK_SIZE       128     // 128MB for each vnode
@@ -338,6 +339,7 @@ void tsDataSwap(void *pLeft, void *pRight, int32_t type, int32_t size);
 #define TSDB_QUERY_TYPE_INSERT                        0x100u    // insert type
 #define TSDB_QUERY_TYPE_MULTITABLE_QUERY              0x200u
 #define TSDB_QUERY_TYPE_STMT_INSERT                   0x800u    // stmt insert type
+#define TSDB_QUERY_TYPE_ENCODE_RESULT                0x1000u    // client decodes the results encoded by column
 
 #define TSDB_QUERY_HAS_TYPE(x, _type)         (((x) & (_type)) != 0)
 #define TSDB_QUERY_SET_TYPE(x, _type)         ((x) |= (_type))
@@ -90,7 +90,7 @@ TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_CM_KILL_STREAM, "kill-stream" )
 TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_CM_KILL_CONN, "kill-conn" )
 TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_CM_CONFIG_DNODE, "cm-config-dnode" ) 
 TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_CM_HEARTBEAT, "heartbeat" )
-TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_DUMMY8, "dummy8" )
+TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_CM_STABLE_CHILDREN, "stable-children" )
 TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_DUMMY9, "dummy9" )
 TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_DUMMY10, "dummy10" )
 TAOS_DEFINE_MESSAGE_TYPE( TSDB_MSG_TYPE_DUMMY11, "dummy11" )
@@ -481,8 +481,13 @@ typedef struct {
 
 typedef struct SRetrieveTableRsp {
   int32_t numOfRows;
-  int8_t  completed;  // all results are returned to client
-  int16_t precision;
+  int8_t  completed;   // all results are returned to client
+  /*
+   * the two bytes were int16_t precision in network byte order, whose high byte is always 0 in the responses of the
+   * old servers, and the old clients never ask for the encoded results, so the layout is compatible both ways
+   */
+  int8_t  compressed;  // data are encoded by column, see qresultEncode.h
+  int8_t  precision;
   int64_t offset;  // updated offset value for multi-vnode projection query
   int64_t useconds;
   char    data[];
@@ -661,7 +666,7 @@ typedef struct STableMetaMsg {
   int32_t       sid;
   uint64_t      uid;
   SCMVgroupInfo vgroup;
-  SSchema       schema[];
+  SSchema       schema[];  // followed by the uid of the super table, only for child table
 } STableMetaMsg;
 
 typedef struct SMultiTableMeta {
@@ -670,6 +675,32 @@ typedef struct SMultiTableMeta {
   STableMetaMsg metas[];
 } SMultiTableMeta;
 
+/*
+ * the meta of all child tables of a super table is retrieved page by page, ordered by vgId and sid
+ * rsp format: | SCMSTableChildrenRsp | STableMetaMsg of super table | SCMVgroupInfo[] | SCMChildTableInfo[] |
+ */
+typedef struct {
+  char    tableId[TSDB_TABLE_ID_LEN];  // super table id
+  int32_t vgId;                        // the children after (vgId, sid) are retrieved, both are 0 for the first page
+  int32_t sid;
+  int32_t numOfTables;                 // the maximum number of children in one page
+} SCMSTableChildrenMsg;
+
+typedef struct {
+  int32_t numOfTables;
+  int32_t numOfVgroups;
+  int32_t vgId;     // the position of the next page, 0 if all children are retrieved
+  int32_t sid;
+  int32_t metaLen;  // the length of the super table meta, the schema is shared by all children
+} SCMSTableChildrenRsp;
+
+typedef struct {
+  char     tableId[TSDB_TABLE_ID_LEN];
+  int32_t  vgIndex;  // index of the vgroup in the response
+  int32_t  sid;
+  uint64_t uid;
+} SCMChildTableInfo;
+
 typedef struct {
   int32_t dataLen;
   char name[TSDB_TABLE_ID_LEN];
@@ -51,6 +51,15 @@ typedef struct SRpcMsg {
   void   *ahandle;  //app handle set by client, for debug purpose
 } SRpcMsg;
 
+typedef struct SRpcCompStat {
+  int64_t numOfComps;    // number of msgs compressed
+  int64_t origBytes;     // size of the compressed msgs before compression
+  int64_t compBytes;     // size of the compressed msgs after compression
+  int64_t compTime;      // microseconds spent on compression, including the tries not applied
+  int64_t numOfDecomps;  // number of msgs decompressed
+  int64_t decompTime;    // microseconds spent on decompression
+} SRpcCompStat;
+
 typedef struct SRpcInit {
   uint16_t localPort; // local port
   char  *label;        // for debug purpose
@@ -85,6 +94,7 @@ int   rpcGetConnInfo(void *thandle, SRpcConnInfo *pInfo);
 void  rpcSendRecv(void *shandle, SRpcIpSet *pIpSet, const SRpcMsg *pReq, SRpcMsg *pRsp);
 int   rpcReportProgress(void *pConn, char *pCont, int contLen);
 void  rpcCancelRequest(void *pContext);
+void  rpcGetCompStat(SRpcCompStat *pReqStat, SRpcCompStat *pRspStat);
 
 #ifdef __cplusplus
 }
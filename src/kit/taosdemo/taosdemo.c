@@ -69,6 +69,7 @@ static struct argp_option options[] = {
   {0, 'O', "order",                    0, "Insert mode--0: In order, 1: Out of order. Default is in order.",                                                  14},
   {0, 'R', "rate",                     0, "Out of order data's rate--if order=1 Default 10, min: 0, max: 50.",                                                14},
   {0, 'D', "delete table",             0, "Delete data methods——0: don't delete, 1: delete by table, 2: delete by stable, 3: delete by database",             14},
+  {0, 'B', 0,                          0, "Insert by binding column values instead of sql string. Only applicable in SYNC mode.",                             14},
   {0}};
 
 /* Used by main to communicate with parse_opt. */
@@ -94,6 +95,7 @@ typedef struct DemoArguments {
   int    order;
   int    rate;
   int    method_of_delete;
+  bool   bind_insert;
   char **arg_list;
 } SDemoArguments;
 
@@ -216,6 +218,9 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
         arguments->method_of_delete = 0;
       }
       break;
+    case 'B':
+      arguments->bind_insert = true;
+      break;
     case OPT_ABORT:
       arguments->abort = 1;
       break;
@@ -253,6 +258,7 @@ typedef struct {
   int data_of_rate;
   int64_t start_time;
   bool do_aggreFunc;
+  bool bind_insert;
 
   sem_t mutex_sem;
   int notFinished;
@@ -294,6 +300,8 @@ void *readMetric(void *sarg);
 
 void *syncWrite(void *sarg);
 
+void *bindWrite(void *sarg);
+
 void *deleteTable();
 
 void *asyncWrite(void *sarg);
@@ -337,6 +345,7 @@ int main(int argc, char *argv[]) {
                                 0,               // order
                                 0,               // rate
                                 0,               // method_of_delete
+                                false,           // bind_insert
                                 NULL             // arg_list
                                 };
 
@@ -563,6 +572,7 @@ int main(int argc, char *argv[]) {
     t_info->start_table_id = last;
     t_info->data_of_order = order;
     t_info->data_of_rate = rate;
+    t_info->bind_insert = arguments.bind_insert;
     t_info->end_table_id = i < b ? last + a : last + a - 1;
     last = t_info->end_table_id + 1;
 
@@ -571,7 +581,7 @@ int main(int argc, char *argv[]) {
     sem_init(&(t_info->lock_sem), 0, 0);
 
     if (query_mode == SYNC) {
-      pthread_create(pids + i, NULL, syncWrite, t_info);
+      pthread_create(pids + i, NULL, t_info->bind_insert ? bindWrite : syncWrite, t_info);
     } else {
       pthread_create(pids + i, NULL, asyncWrite, t_info);
     }
@@ -879,6 +889,110 @@ void *syncWrite(void *sarg) {
   return NULL;
 }
 
+static int getBindType(char *data_type) {
+  if (strcasecmp(data_type, "tinyint") == 0) return TSDB_DATA_TYPE_TINYINT;
+  if (strcasecmp(data_type, "smallint") == 0) return TSDB_DATA_TYPE_SMALLINT;
+  if (strcasecmp(data_type, "int") == 0) return TSDB_DATA_TYPE_INT;
+  if (strcasecmp(data_type, "bigint") == 0) return TSDB_DATA_TYPE_BIGINT;
+  if (strcasecmp(data_type, "float") == 0) return TSDB_DATA_TYPE_FLOAT;
+  if (strcasecmp(data_type, "double") == 0) return TSDB_DATA_TYPE_DOUBLE;
+  if (strcasecmp(data_type, "bool") == 0) return TSDB_DATA_TYPE_BOOL;
+  return TSDB_DATA_TYPE_BINARY;
+}
+
+static void generateBindValue(TAOS_COLUMN_BIND *bind, int row) {
+  char *p = (char *)bind->buffer + bind->buffer_length * row;
+  switch (bind->buffer_type) {
+    case TSDB_DATA_TYPE_TINYINT: *(int8_t *)p = (int8_t)(trand() % 128); break;
+    case TSDB_DATA_TYPE_SMALLINT: *(int16_t *)p = (int16_t)(trand() % 32767); break;
+    case TSDB_DATA_TYPE_INT: *(int32_t *)p = (int32_t)(trand() % 10); break;
+    case TSDB_DATA_TYPE_BIGINT: *(int64_t *)p = trand() % 2147483648; break;
+    case TSDB_DATA_TYPE_FLOAT: *(float *)p = (float)(trand() / 1000.0); break;
+    case TSDB_DATA_TYPE_DOUBLE: *(double *)p = (double)(trand() / 1000000.0); break;
+    case TSDB_DATA_TYPE_BOOL: *(int8_t *)p = trand() & 1; break;
+    default: rand_string(p, (int)bind->buffer_length); break;
+  }
+}
+
+/*
+ * the same workload as syncWrite, but the values of each column are put into a typed array, and inserted by
+ * taos_insert_columns without formatting and parsing the sql string.
+ */
+void *bindWrite(void *sarg) {
+  info *winfo = (info *)sarg;
+  char **data_type = winfo->datatype;
+  int ncols_per_record = winfo->ncols_per_record;
+  int nrows = MIN(winfo->nrecords_per_request, INT16_MAX);
+
+  int c = 0;
+  for (; c < MAX_NUM_DATATYPE; c++) {
+    if (strcasecmp(data_type[c], "") == 0) {
+      break;
+    }
+  }
+
+  if (0 == c) {
+    perror("data type error!");
+    exit(-1);
+  }
+
+  TAOS_COLUMN_BIND *binds = calloc(ncols_per_record + 1, sizeof(TAOS_COLUMN_BIND));
+  binds[0].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+  binds[0].buffer_length = sizeof(int64_t);
+  binds[0].buffer = malloc(sizeof(int64_t) * nrows);
+
+  for (int i = 1; i <= ncols_per_record; i++) {
+    binds[i].buffer_type = getBindType(data_type[(i - 1) % c]);
+    binds[i].buffer_length = (binds[i].buffer_type == TSDB_DATA_TYPE_BINARY) ? winfo->len_of_binary : sizeof(int64_t);
+    binds[i].buffer = malloc(binds[i].buffer_length * nrows);
+  }
+
+  char tb_name[MAX_DB_NAME_SIZE + MAX_TB_NAME_SIZE + 16];
+  TAOS_TABLE_BIND table = {.table_name = tb_name, .num_of_rows = 0, .columns = binds};
+
+  srand(time(NULL));
+  int64_t time_counter = winfo->start_time;
+  for (int i = 0; i < winfo->nrecords_per_table;) {
+    for (int tID = winfo->start_table_id; tID <= winfo->end_table_id; tID++) {
+      int inserted = i;
+      int64_t tmp_time = time_counter;
+      sprintf(tb_name, "%s.%s%d", winfo->db_name, winfo->tb_prefix, tID);
+
+      int k;
+      for (k = 0; k < nrows && inserted < winfo->nrecords_per_table; k++, inserted++) {
+        int rand_num = trand() % 100;
+        if (winfo->data_of_order == 1 && rand_num < winfo->data_of_rate) {
+          ((int64_t *)binds[0].buffer)[k] = tmp_time - trand() % 1000000 + rand_num;
+        } else {
+          ((int64_t *)binds[0].buffer)[k] = (tmp_time += 1000);
+        }
+
+        for (int j = 1; j <= ncols_per_record; j++) {
+          generateBindValue(&binds[j], k);
+        }
+      }
+
+      table.num_of_rows = k;
+      TAOS_RES *res = taos_insert_columns(winfo->taos, &table, 1);
+      if (taos_errno(res) != 0) {
+        fprintf(stderr, "Failed to insert into %s, reason:%s\n", tb_name, taos_errstr(res));
+      }
+      taos_free_result(res);
+
+      if (tID == winfo->end_table_id) {
+        i = inserted;
+        time_counter = tmp_time;
+      }
+    }
+  }
+
+  for (int i = 0; i <= ncols_per_record; i++) {
+    free(binds[i].buffer);
+  }
+  free(binds);
+  return NULL;
+}
+
 void *asyncWrite(void *sarg) {
   info *winfo = (info *)sarg;
 
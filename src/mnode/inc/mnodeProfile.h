@@ -44,6 +44,7 @@ SConnObj *mnodeCreateConn(char *user, uint32_t ip, uint16_t port);
 SConnObj *mnodeAccquireConn(uint32_t connId, char *user, uint32_t ip, uint16_t port);
 void      mnodeReleaseConn(SConnObj *pConn);
 int32_t   mnodeSaveQueryStreamList(SConnObj *pConn, SCMHeartBeatMsg *pHBMsg);
+void      mnodeCancelGetNextConn(void *pIter);
 
 #ifdef __cplusplus
 }
@@ -81,7 +81,7 @@ void mnodeCleanupProfile() {
 }
 
 SConnObj *mnodeCreateConn(char *user, uint32_t ip, uint16_t port) {
-  int32_t connSize = taosHashGetSize(tsMnodeConnCache->pHashTable);
+  int32_t connSize = taosCacheGetSize(tsMnodeConnCache);
   if (connSize > tsMaxShellConns) {
     mError("failed to create conn for user:%s ip:%s:%u, conns:%d larger than maxShellConns:%d, ", user, taosIpStr(ip),
            port, connSize, tsMaxShellConns);
@@ -144,28 +144,31 @@ static void mnodeFreeConn(void *data) {
   mTrace("connId:%d, is destroyed", pConn->connId);
 }
 
-static void *mnodeGetNextConn(SHashMutableIterator *pIter, SConnObj **pConn) {
+static void *mnodeGetNextConn(SCacheIter *pIter, SConnObj **pConn) {
   *pConn = NULL;
 
   if (pIter == NULL) {
-    pIter = taosHashCreateIter(tsMnodeConnCache->pHashTable);
+    pIter = taosCacheCreateIter(tsMnodeConnCache);
   }
 
-  if (!taosHashIterNext(pIter)) {
-    taosHashDestroyIter(pIter);
+  if (!taosCacheIterNext(pIter)) {
+    taosCacheDestroyIter(pIter);
     return NULL;
   }
 
-  SCacheDataNode **pNode = taosHashIterGet(pIter);
-  if (pNode == NULL || *pNode == NULL) {
-    taosHashDestroyIter(pIter);
+  *pConn = (SConnObj *)taosCacheIterGetData(pIter);
+  if (*pConn == NULL) {
+    taosCacheDestroyIter(pIter);
     return NULL;
   }
 
-  *pConn = (SConnObj*)((*pNode)->data);
   return pIter;
 }
 
+void mnodeCancelGetNextConn(void *pIter) {
+  taosCacheDestroyIter(pIter);
+}
+
 static int32_t mnodeGetConnsMeta(STableMetaMsg *pMeta, SShowObj *pShow, void *pConn) {
   SUserObj *pUser = mnodeGetUserFromConn(pConn);
   if (pUser == NULL) return 0;
@@ -212,7 +215,7 @@ static int32_t mnodeGetConnsMeta(STableMetaMsg *pMeta, SShowObj *pShow, void *pC
     pShow->offset[i] = pShow->offset[i - 1] + pShow->bytes[i - 1];
   }
 
-  pShow->numOfRows = taosHashGetSize(tsMnodeConnCache->pHashTable);
+  pShow->numOfRows = taosCacheGetSize(tsMnodeConnCache);
   pShow->rowSize = pShow->offset[cols - 1] + pShow->bytes[cols - 1];
 
   return 0;
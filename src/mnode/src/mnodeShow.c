@@ -212,7 +212,7 @@ static int32_t mnodeProcessRetrieveMsg(SMnodeMsg *pMsg) {
   }
 
   pRsp->numOfRows = htonl(rowsRead);
-  pRsp->precision = htonl(TSDB_TIME_PRECISION_MILLI);  // millisecond time precision
+  pRsp->precision = TSDB_TIME_PRECISION_MILLI;  // millisecond time precision
 
   pMsg->rpcRsp.rsp = pRsp;
   pMsg->rpcRsp.len = size;
@@ -393,7 +393,15 @@ static void *mnodePutShowObj(SShowObj *pShow, int32_t size) {
 
 static void mnodeFreeShowObj(void *data) {
   SShowObj *pShow = data;
-  sdbFreeIter(pShow->pIter);
+
+  // the connections, queries and streams are iterated through the connection cache rather than sdb
+  if (pShow->type == TSDB_MGMT_TABLE_CONNS || pShow->type == TSDB_MGMT_TABLE_QUERIES ||
+      pShow->type == TSDB_MGMT_TABLE_STREAMS) {
+    mnodeCancelGetNextConn(pShow->pIter);
+  } else {
+    sdbFreeIter(pShow->pIter);
+  }
+
   mTrace("%p, show is destroyed", pShow);
 }
 
@@ -28,6 +28,7 @@
 #include "tdataformat.h"
 #include "tgrant.h"
 #include "hash.h"
+#include "tarray.h"
 #include "mnode.h"
 #include "dnode.h"
 #include "mnodeDef.h"
@@ -76,6 +77,7 @@ static int32_t mnodeProcessDropChildTableMsg(SMnodeMsg *pMsg);
 static void    mnodeProcessDropChildTableRsp(SRpcMsg *rpcMsg);
 
 static int32_t mnodeProcessSuperTableVgroupMsg(SMnodeMsg *mnodeMsg);
+static int32_t mnodeProcessSuperTableChildrenMsg(SMnodeMsg *mnodeMsg);
 static int32_t mnodeProcessMultiTableMetaMsg(SMnodeMsg *mnodeMsg);
 static int32_t mnodeProcessTableCfgMsg(SMnodeMsg *mnodeMsg);
 
@@ -572,6 +574,7 @@ int32_t mnodeInitTables() {
   mnodeAddWriteMsgHandle(TSDB_MSG_TYPE_CM_ALTER_TABLE, mnodeProcessAlterTableMsg);
   mnodeAddReadMsgHandle(TSDB_MSG_TYPE_CM_TABLE_META, mnodeProcessTableMetaMsg);
   mnodeAddReadMsgHandle(TSDB_MSG_TYPE_CM_STABLE_VGROUP, mnodeProcessSuperTableVgroupMsg);
+  mnodeAddReadMsgHandle(TSDB_MSG_TYPE_CM_STABLE_CHILDREN, mnodeProcessSuperTableChildrenMsg);
   
   mnodeAddPeerRspHandle(TSDB_MSG_TYPE_MD_CREATE_TABLE_RSP, mnodeProcessCreateChildTableRsp);
   mnodeAddPeerRspHandle(TSDB_MSG_TYPE_MD_DROP_TABLE_RSP, mnodeProcessDropChildTableRsp);
@@ -1343,18 +1346,34 @@ static int32_t mnodeSetSchemaFromSuperTable(SSchema *pSchema, SSuperTableObj *pT
   return (pTable->numOfColumns + pTable->numOfTags) * sizeof(SSchema);
 }
 
-static int32_t mnodeGetSuperTableMeta(SMnodeMsg *pMsg) {
-  SSuperTableObj *pTable = (SSuperTableObj *)pMsg->pTable;
-  STableMetaMsg *pMeta   = rpcMallocCont(sizeof(STableMetaMsg) + sizeof(SSchema) * (TSDB_MAX_TAGS + TSDB_MAX_COLUMNS + 16));
+static void mnodeSetTableVgroupInfo(SCMVgroupInfo *pVgroupInfo, SVgObj *pVgroup) {
+  for (int32_t i = 0; i < pVgroup->numOfVnodes; ++i) {
+    SDnodeObj *pDnode = mnodeGetDnode(pVgroup->vnodeGid[i].dnodeId);
+    if (pDnode == NULL) break;
+    strcpy(pVgroupInfo->ipAddr[i].fqdn, pDnode->dnodeFqdn);
+    pVgroupInfo->ipAddr[i].port = htons(pDnode->dnodePort + TSDB_PORT_DNODESHELL);
+    pVgroupInfo->numOfIps++;
+    mnodeDecDnodeRef(pDnode);
+  }
+  pVgroupInfo->vgId = htonl(pVgroup->vgId);
+}
+
+static void mnodeSetSuperTableMetaMsg(STableMetaMsg *pMeta, SSuperTableObj *pTable, SDbObj *pDb) {
   pMeta->uid          = htobe64(pTable->uid);
   pMeta->sversion     = htons(pTable->sversion);
   pMeta->tversion     = htons(pTable->tversion);
-  pMeta->precision    = pMsg->pDb->cfg.precision;
+  pMeta->precision    = pDb->cfg.precision;
   pMeta->numOfTags    = (uint8_t)pTable->numOfTags;
   pMeta->numOfColumns = htons((int16_t)pTable->numOfColumns);
   pMeta->tableType    = pTable->info.type;
   pMeta->contLen      = sizeof(STableMetaMsg) + mnodeSetSchemaFromSuperTable(pMeta->schema, pTable);
   tstrncpy(pMeta->tableId, pTable->info.tableId, sizeof(pMeta->tableId));
+}
+
+static int32_t mnodeGetSuperTableMeta(SMnodeMsg *pMsg) {
+  SSuperTableObj *pTable = (SSuperTableObj *)pMsg->pTable;
+  STableMetaMsg *pMeta   = rpcMallocCont(sizeof(STableMetaMsg) + sizeof(SSchema) * (TSDB_MAX_TAGS + TSDB_MAX_COLUMNS + 16));
+  mnodeSetSuperTableMetaMsg(pMeta, pTable, pMsg->pDb);
 
   pMsg->rpcRsp.len = pMeta->contLen;
   pMeta->contLen = htons(pMeta->contLen);
@@ -1457,6 +1476,140 @@ static int32_t mnodeProcessSuperTableVgroupMsg(SMnodeMsg *pMsg) {
   }
 }
 
+static int32_t mnodeCompareVgId(const void *pLeft, const void *pRight) {
+  int32_t left = *(int32_t *)pLeft;
+  int32_t right = *(int32_t *)pRight;
+  return (left == right) ? 0 : ((left < right) ? -1 : 1);
+}
+
+/*
+ * retrieve the meta of the child tables of a super table page by page. The children are visited in the order of
+ * (vgId, sid) through the table list of the vgroups, so each page only visits the tables in it.
+ */
+static int32_t mnodeProcessSuperTableChildrenMsg(SMnodeMsg *pMsg) {
+  SCMSTableChildrenMsg *pInfo = pMsg->rpcMsg.pCont;
+  int32_t startVgId = htonl(pInfo->vgId);
+  int32_t startSid = htonl(pInfo->sid);
+  int32_t maxTables = MIN(MAX(htonl(pInfo->numOfTables), 1), TSDB_MAX_CHILDREN_PER_PAGE);
+
+  if (pMsg->pDb == NULL) pMsg->pDb = mnodeGetDbByTableId(pInfo->tableId);
+  if (pMsg->pDb == NULL || pMsg->pDb->status != TSDB_DB_STATUS_READY) {
+    mError("app:%p:%p, stable:%s, failed to get stable children, db not selected", pMsg->rpcMsg.ahandle, pMsg,
+           pInfo->tableId);
+    return TSDB_CODE_MND_DB_NOT_SELECTED;
+  }
+
+  if (pMsg->pTable == NULL) pMsg->pTable = mnodeGetTable(pInfo->tableId);
+  if (pMsg->pTable == NULL || pMsg->pTable->type != TSDB_SUPER_TABLE) {
+    mError("app:%p:%p, stable:%s, not exist while get stable children", pMsg->rpcMsg.ahandle, pMsg, pInfo->tableId);
+    return TSDB_CODE_MND_INVALID_TABLE_NAME;
+  }
+
+  SSuperTableObj *pStable = (SSuperTableObj *)pMsg->pTable;
+  SArray *        pVgIds = taosArrayInit(32, sizeof(int32_t));
+  if (pVgIds == NULL) {
+    return TSDB_CODE_MND_OUT_OF_MEMORY;
+  }
+
+  if (pStable->vgHash != NULL) {
+    SHashMutableIterator *pIter = taosHashCreateIter(pStable->vgHash);
+    while (taosHashIterNext(pIter)) {
+      int32_t *pVgId = taosHashIterGet(pIter);
+      if (*pVgId >= startVgId) {
+        taosArrayPush(pVgIds, pVgId);
+      }
+    }
+
+    taosHashDestroyIter(pIter);
+    taosArraySort(pVgIds, mnodeCompareVgId);
+  }
+
+  size_t numOfVgroups = taosArrayGetSize(pVgIds);
+  int32_t contLen = sizeof(SCMSTableChildrenRsp) + sizeof(STableMetaMsg) +
+                    sizeof(SSchema) * (TSDB_MAX_TAGS + TSDB_MAX_COLUMNS + 16) + sizeof(SCMVgroupInfo) * numOfVgroups +
+                    sizeof(SCMChildTableInfo) * maxTables;
+
+  SCMSTableChildrenRsp *pRsp = rpcMallocCont(contLen);
+  if (pRsp == NULL) {
+    taosArrayDestroy(pVgIds);
+    return TSDB_CODE_MND_OUT_OF_MEMORY;
+  }
+
+  STableMetaMsg *pMeta = (STableMetaMsg *)((char *)pRsp + sizeof(SCMSTableChildrenRsp));
+  mnodeSetSuperTableMetaMsg(pMeta, pStable, pMsg->pDb);
+
+  int32_t metaLen = pMeta->contLen;
+  pMeta->contLen = htons(pMeta->contLen);
+
+  // the children are put after the space reserved for all vgroups, and moved forward at last
+  SCMVgroupInfo *    pVgroups = (SCMVgroupInfo *)((char *)pMeta + metaLen);
+  SCMChildTableInfo *pChildren = (SCMChildTableInfo *)(pVgroups + numOfVgroups);
+
+  int32_t numOfTables = 0;
+  int32_t numOfPageVgroups = 0;
+  int32_t nextVgId = 0;
+  int32_t nextSid = 0;
+
+  for (int32_t i = 0; i < numOfVgroups && numOfTables < maxTables; ++i) {
+    int32_t vgId = *(int32_t *)taosArrayGet(pVgIds, i);
+    SVgObj *pVgroup = mnodeGetVgroup(vgId);
+    if (pVgroup == NULL) continue;
+
+    if (pVgroup->tableList == NULL || pVgroup->pDb == NULL) {
+      mnodeDecVgroupRef(pVgroup);
+      continue;
+    }
+
+    int32_t vgIndex = -1;
+    int32_t sid = (vgId == startVgId) ? startSid + 1 : 1;
+    for (; sid <= pVgroup->pDb->cfg.maxTables && numOfTables < maxTables; ++sid) {
+      SChildTableObj *pTable = pVgroup->tableList[sid - 1];
+      if (pTable == NULL || pTable->superTable != pStable) continue;
+
+      if (vgIndex < 0) {
+        vgIndex = numOfPageVgroups++;
+        memset(&pVgroups[vgIndex], 0, sizeof(SCMVgroupInfo));
+        mnodeSetTableVgroupInfo(&pVgroups[vgIndex], pVgroup);
+      }
+
+      SCMChildTableInfo *pChild = &pChildren[numOfTables++];
+      tstrncpy(pChild->tableId, pTable->info.tableId, TSDB_TABLE_ID_LEN);
+      pChild->vgIndex = htonl(vgIndex);
+      pChild->sid = htonl(pTable->sid);
+      pChild->uid = htobe64(pTable->uid);
+
+      nextVgId = vgId;
+      nextSid = sid;
+    }
+
+    mnodeDecVgroupRef(pVgroup);
+  }
+
+  taosArrayDestroy(pVgIds);
+
+  // all children are retrieved if the page is not full
+  if (numOfTables < maxTables) {
+    nextVgId = 0;
+    nextSid = 0;
+  }
+
+  char *pMsgChildren = (char *)(pVgroups + numOfPageVgroups);
+  memmove(pMsgChildren, pChildren, sizeof(SCMChildTableInfo) * numOfTables);
+
+  pRsp->numOfTables = htonl(numOfTables);
+  pRsp->numOfVgroups = htonl(numOfPageVgroups);
+  pRsp->vgId = htonl(nextVgId);
+  pRsp->sid = htonl(nextSid);
+  pRsp->metaLen = htonl(metaLen);
+
+  pMsg->rpcRsp.rsp = pRsp;
+  pMsg->rpcRsp.len = pMsgChildren + sizeof(SCMChildTableInfo) * numOfTables - (char *)pRsp;
+
+  mTrace("app:%p:%p, stable:%s, %d children in %d vgroups are retrieved, next vgId:%d sid:%d", pMsg->rpcMsg.ahandle,
+         pMsg, pStable->info.tableId, numOfTables, numOfPageVgroups, nextVgId, nextSid);
+  return TSDB_CODE_SUCCESS;
+}
+
 static void mnodeProcessDropSuperTableRsp(SRpcMsg *rpcMsg) {
   mPrint("drop stable rsp received, result:%s", tstrerror(rpcMsg->code));
 }
@@ -1912,6 +2065,11 @@ static int32_t mnodeDoGetChildTableMeta(SMnodeMsg *pMsg, STableMetaMsg *pMeta) {
     pMeta->numOfTags    = (int8_t)pTable->superTable->numOfTags;
     pMeta->numOfColumns = htons((int16_t)pTable->superTable->numOfColumns);
     pMeta->contLen      = sizeof(STableMetaMsg) + mnodeSetSchemaFromSuperTable(pMeta->schema, pTable->superTable);
+
+    // the uid of super table is appended after the schema, so the peers of old version can still parse the message
+    uint64_t suid = htobe64(pTable->superTable->uid);
+    memcpy((char *)pMeta + pMeta->contLen, &suid, sizeof(suid));
+    pMeta->contLen += sizeof(suid);
   } else {
     pMeta->sversion     = htons(pTable->sversion);
     pMeta->tversion     = 0;
@@ -1927,15 +2085,7 @@ static int32_t mnodeDoGetChildTableMeta(SMnodeMsg *pMsg, STableMetaMsg *pMeta) {
     return TSDB_CODE_MND_VGROUP_NOT_EXIST;
   }
 
-  for (int32_t i = 0; i < pMsg->pVgroup->numOfVnodes; ++i) {
-    SDnodeObj *pDnode = mnodeGetDnode(pMsg->pVgroup->vnodeGid[i].dnodeId);
-    if (pDnode == NULL) break;
-    strcpy(pMeta->vgroup.ipAddr[i].fqdn, pDnode->dnodeFqdn);
-    pMeta->vgroup.ipAddr[i].port = htons(pDnode->dnodePort + TSDB_PORT_DNODESHELL);
-    pMeta->vgroup.numOfIps++;
-    mnodeDecDnodeRef(pDnode);
-  }
-  pMeta->vgroup.vgId = htonl(pMsg->pVgroup->vgId);
+  mnodeSetTableVgroupInfo(&pMeta->vgroup, pMsg->pVgroup);
 
   mTrace("app:%p:%p, table:%s, uid:%" PRIu64 " table meta is retrieved", pMsg->rpcMsg.ahandle, pMsg,
          pTable->info.tableId, pTable->uid);
@@ -29,13 +29,15 @@
 #include "httpJson.h"
 
 #define HTTP_MAX_CMD_SIZE           1024
+#define HTTP_WORKER_QUEUE_SIZE      10000
 #define HTTP_MAX_BUFFER_SIZE        1024*1024
 
 #define HTTP_LABEL_SIZE             8
-#define HTTP_MAX_EVENTS             10
-#define HTTP_BUFFER_SIZE            1024*65 //65k
+#define HTTP_MAX_EVENTS             128
+#define HTTP_BUFFER_SIZE            1024*65 //65k, initial read buffer and the limit of http head
 #define HTTP_DECOMPRESS_BUF_SIZE    1024*64
-#define HTTP_STEP_SIZE              1024    //http message get process step by step
+#define HTTP_STEP_SIZE              1024    //free space kept in read buffer before a read
+#define HTTP_LISTEN_BACKLOG         1024
 #define HTTP_MAX_URL                5       //http url stack size
 #define HTTP_METHOD_SCANNER_SIZE    7       //http method fp size
 #define HTTP_GC_TARGET_SIZE         512
@@ -56,6 +58,7 @@
 #define HTTP_REQTYPE_HEARTBEAT      2
 #define HTTP_REQTYPE_SINGLE_SQL     3
 #define HTTP_REQTYPE_MULTI_SQL      4
+#define HTTP_REQTYPE_NATIVE_INSERT  5
 
 #define HTTP_CHECK_BODY_ERROR      -1
 #define HTTP_CHECK_BODY_CONTINUE    0
@@ -160,8 +163,12 @@ typedef struct {
 } HttpBuf;
 
 typedef struct {
-  char              buffer[HTTP_BUFFER_SIZE];
+  char             *buffer;              // grows up to HTTP_MAX_BUFFER_SIZE for large body
   int               bufsize;
+  int               bufcap;
+  int               chunkPos;            // offset of the next chunk to be decoded
+  int               nextPos;             // offset of the pipelined request, 0 if there is none
+  char              nextChar;            // the byte at nextPos, overwritten by the end of current body
   char             *pLast;
   char             *pCur;
   HttpBuf           method;
@@ -184,6 +191,9 @@ typedef struct HttpContext {
   uint8_t      contentEncoding;
   uint8_t      reqType;
   uint8_t      parsed;
+  int32_t      readPending;    // data arrived while the request was handled
+  int32_t      resumeQueued;
+  struct HttpContext *pNextResume;
   char         ipstr[22];
   char         user[TSDB_USER_LEN];  // parsed from auth token or login message
   char         pass[TSDB_PASSWORD_LEN];
@@ -197,15 +207,18 @@ typedef struct HttpContext {
   JsonBuf *    jsonBuf;
   void *       timer;
   HttpEncodeMethod * encodeMethod;
+  void (*nativeInsertFp)(struct HttpContext *pContext);  // run by the worker threads, the client APIs are synchronous
   struct HttpThread *pThread;
 } HttpContext;
 
 typedef struct HttpThread {
   pthread_t       thread;
-  HttpContext *   pHead;
+  HttpContext *   pHead;         // contexts to be resumed, protected by threadMutex
   pthread_mutex_t threadMutex;
   bool            stop;
   int             pollFd;
+  int             listenFd;      // each thread accepts on its own SO_REUSEPORT socket
+  int             notifyFd;      // eventfd to wake up the thread for stop or resume
   int             numOfFds;
   int             threadId;
   char            label[HTTP_LABEL_SIZE];
@@ -216,15 +229,14 @@ typedef struct HttpServer {
   char              label[HTTP_LABEL_SIZE];
   uint32_t          serverIp;
   uint16_t          serverPort;
-  int               fd;
   int               numOfThreads;
   int               methodScannerLen;
   int32_t           requestNum;
   int32_t           status;
-  pthread_t         thread;
   HttpThread *      pThreads;
   void *            contextCache;
   void *            sessionCache;
+  void *            workerQhandle;  // scheduler of the native insertions
   pthread_mutex_t   serverMutex;
   HttpDecodeMethod *methodScanner[HTTP_METHOD_SCANNER_SIZE];
   bool (*processData)(HttpContext *pContext);
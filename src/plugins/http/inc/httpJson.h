@@ -42,6 +42,9 @@ typedef struct {
   char*               lst;
   char                buf[JSON_BUFFER_SIZE];
   struct HttpContext* pContext;
+  int64_t             hourStart;  // the local time of the timestamps in this hour is formatted without localtime
+  char                hourStr[16];  // "YYYY-mm-dd HH", in local time
+  char                zoneStr[8];   // "+hhmm", the utc offset of the hour
 } JsonBuf;
 
 // http response
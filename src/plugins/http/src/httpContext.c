@@ -27,6 +27,7 @@
 #include "httpResp.h"
 #include "httpSql.h"
 #include "httpSession.h"
+#include "httpServer.h"
 
 static void httpRemoveContextFromEpoll(HttpContext *pContext) {
   HttpThread *pThread = pContext->pThread;
@@ -52,6 +53,7 @@ static void httpDestroyContext(void *data) {
   // avoid double free
   httpFreeJsonBuf(pContext);
   httpFreeMultiCmds(pContext);
+  tfree(pContext->parser.buffer);
   
   httpTrace("context:%p, is destroyed, refCount:%d", pContext, pContext->refCount);
   tfree(pContext);
@@ -70,7 +72,7 @@ bool httpInitContexts() {
 void httpCleanupContexts() {
   if (tsHttpServer.contextCache != NULL) {
     SCacheObj *cache = tsHttpServer.contextCache;
-    httpPrint("context cache is cleanuping, size:%zu", taosHashGetSize(cache->pHashTable));
+    httpPrint("context cache is cleanuping, size:%zu", taosCacheGetSize(cache));
     taosCacheCleanup(tsHttpServer.contextCache);
     tsHttpServer.contextCache = NULL;
   }
@@ -157,12 +159,35 @@ bool httpInitContext(HttpContext *pContext) {
   pContext->contentEncoding = HTTP_COMPRESS_IDENTITY;
   pContext->reqType = HTTP_REQTYPE_OTHERS;
   pContext->encodeMethod = NULL;
+  pContext->nativeInsertFp = NULL;
   pContext->timer = NULL;
   memset(&pContext->singleCmd, 0, sizeof(HttpSqlCmd));
 
+  // keep the buffer, and move the pipelined request to the front
   HttpParser *pParser = &pContext->parser;
+  char       *buffer = pParser->buffer;
+  int         bufcap = pParser->bufcap;
+  int         nextLen = 0;
+  if (pParser->nextPos > 0) {
+    nextLen = pParser->bufsize - pParser->nextPos;
+    buffer[pParser->nextPos] = pParser->nextChar;
+    memmove(buffer, buffer + pParser->nextPos, (size_t)nextLen);
+  }
+
+  // shrink the buffer enlarged by a large request
+  if (bufcap > HTTP_BUFFER_SIZE && nextLen < HTTP_BUFFER_SIZE) {
+    char *newBuf = realloc(buffer, HTTP_BUFFER_SIZE);
+    if (newBuf != NULL) {
+      buffer = newBuf;
+      bufcap = HTTP_BUFFER_SIZE;
+    }
+  }
+
   memset(pParser, 0, sizeof(HttpParser));
-  pParser->pCur = pParser->pLast = pParser->buffer;
+  pParser->buffer = buffer;
+  pParser->bufcap = bufcap;
+  pParser->bufsize = nextLen;
+  if (buffer != NULL) buffer[nextLen] = 0;
 
   httpTrace("context:%p, fd:%d, ip:%s, thread:%s, accessTimes:%d, parsed:%d",
           pContext, pContext->fd, pContext->ipstr, pContext->pThread->label, pContext->accessTimes, pContext->parsed);
@@ -180,9 +205,15 @@ void httpCloseContextByApp(HttpContext *pContext) {
   } else {}
 
   if (keepAlive) {
+    // the parser is reset once the response is sent, before the read events are handled again
+    httpInitContext(pContext);
+
     if (httpAlterContextState(pContext, HTTP_CONTEXT_STATE_HANDLING, HTTP_CONTEXT_STATE_READY)) {
       httpTrace("context:%p, fd:%d, ip:%s, last state:handling, keepAlive:true, reuse connect",
               pContext, pContext->fd, pContext->ipstr);
+      if (pContext->parser.bufsize > 0 || atomic_exchange_32(&pContext->readPending, 0) != 0) {
+        httpResumeContext(pContext);
+      }
     } else if (httpAlterContextState(pContext, HTTP_CONTEXT_STATE_DROPPING, HTTP_CONTEXT_STATE_CLOSED)) {
       httpRemoveContextFromEpoll(pContext);
       httpTrace("context:%p, fd:%d, ip:%s, last state:dropping, keepAlive:true, close connect",
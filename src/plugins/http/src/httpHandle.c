@@ -60,6 +60,7 @@ bool httpParseURL(HttpContext* pContext) {
   char* pSeek;
   char* pEnd = strchr(pParser->pLast, ' ');
   if (pEnd == NULL) {
+    httpSendErrorResp(pContext, HTTP_UNSUPPORT_URL);
     return false;
   }
 
@@ -243,66 +244,97 @@ bool httpParseHead(HttpContext* pContext) {
   return true;
 }
 
-bool httpParseChunkedBody(HttpContext* pContext, HttpParser* pParser, bool test) {
-  char*  pEnd = pParser->buffer + pParser->bufsize;
-  char*  pRet = pParser->data.pos;
-  char*  pSize = pParser->data.pos;
-  size_t size = strtoul(pSize, NULL, 16);
-  if (size <= 0) return false;
-
-  while (size > 0) {
-    char* pData = strstr(pSize, "\r\n");
-    if (pData == NULL || pData >= pEnd) return false;
-    pData += 2;
-
-    pSize = strstr(pData, "\r\n");
-    if (pSize == NULL || pSize >= pEnd) return false;
-    if ((size_t)(pSize - pData) != size) return false;
-    pSize += 2;
-
-    if (!test) {
-      memmove(pRet, pData, size);
-      pRet += size;
-    }
+// the bytes behind the request belong to the next pipelined request
+static void httpSetRequestEnd(HttpParser* pParser, char* pReqEnd) {
+  if (pReqEnd < pParser->buffer + pParser->bufsize) {
+    pParser->nextPos = (int)(pReqEnd - pParser->buffer);
+    pParser->nextChar = *pReqEnd;
+  }
+}
 
-    size = strtoul(pSize, NULL, 16);
+static char* httpFindLineEnd(char* pStart, char* pEnd) {
+  for (char* p = pStart; p + 1 < pEnd; ++p) {
+    if (p[0] == '\r' && p[1] == '\n') return p;
   }
+  return NULL;
+}
 
-  if (!test) {
-    *pRet = '\0';
+/*
+ * the chunks are decoded as they arrive, the chunk data is moved ahead so the body is contiguous at data.pos,
+ * data.len is the decoded length, and chunkPos is the offset of the next chunk size line
+ */
+int httpReadChunkedBody(HttpContext* pContext, HttpParser* pParser) {
+  char* pEnd = pParser->buffer + pParser->bufsize;
+  if (pParser->chunkPos == 0) {
+    pParser->chunkPos = (int)(pParser->data.pos - pParser->buffer);
+    pParser->data.len = 0;
   }
 
-  return true;
-}
+  while (1) {
+    char* pSize = pParser->buffer + pParser->chunkPos;
+    char* pData = httpFindLineEnd(pSize, pEnd);
+    if (pData == NULL) break;
+
+    // strtoul skips spaces and accepts a sign, so the size shall start with a hex digit
+    char*  pNum = NULL;
+    errno = 0;
+    size_t size = isxdigit((unsigned char)*pSize) ? strtoul(pSize, &pNum, 16) : 0;
+    if (pNum == NULL || pNum == pSize || errno == ERANGE) {
+      httpError("context:%p, fd:%d, ip:%s, invalid chunk size", pContext, pContext->fd, pContext->ipstr);
+      httpSendErrorResp(pContext, HTTP_PARSE_CHUNKED_BODY_ERROR);
+      return HTTP_CHECK_BODY_ERROR;
+    }
 
-bool httpReadChunkedBody(HttpContext* pContext, HttpParser* pParser) {
-  bool parsedOk = httpParseChunkedBody(pContext, pParser, true);
-  if (parsedOk) {
-    httpParseChunkedBody(pContext, pParser, false);
-    return HTTP_CHECK_BODY_SUCCESS;
-  } else {
-    httpTrace("context:%p, fd:%d, ip:%s, chunked body not finished, continue read", pContext, pContext->fd, pContext->ipstr);
-    if (!httpReadDataImp(pContext)) {
-      httpError("context:%p, fd:%d, ip:%s, read chunked request error", pContext, pContext->fd, pContext->ipstr);
+    // the chunk data and its CRLF shall fit in the buffer after the size line
+    size_t avail = (size_t)(HTTP_MAX_BUFFER_SIZE - (pData + 2 - pParser->buffer));
+    if (avail < 2 || size > avail - 2) {
+      httpError("context:%p, fd:%d, ip:%s, chunk size:%zu too big, limit:%d", pContext, pContext->fd, pContext->ipstr,
+                size, HTTP_MAX_BUFFER_SIZE);
+      httpSendErrorResp(pContext, HTTP_REQUSET_TOO_BIG);
       return HTTP_CHECK_BODY_ERROR;
-    } else {
-      return HTTP_CHECK_BODY_CONTINUE;
     }
+    pData += 2;
+
+    size_t readLen = (size_t)(pEnd - pData);
+    if (readLen < 2 || size > readLen - 2) break;
+    if (pData[size] != '\r' || pData[size + 1] != '\n') {
+      httpError("context:%p, fd:%d, ip:%s, chunk not end with CRLF, size:%zu", pContext, pContext->fd, pContext->ipstr,
+                size);
+      httpSendErrorResp(pContext, HTTP_PARSE_CHUNKED_BODY_ERROR);
+      return HTTP_CHECK_BODY_ERROR;
+    }
+
+    if (size == 0) {
+      httpSetRequestEnd(pParser, pData + 2);
+      pParser->data.pos[pParser->data.len] = 0;
+      return HTTP_CHECK_BODY_SUCCESS;
+    }
+
+    memmove(pParser->data.pos + pParser->data.len, pData, size);
+    pParser->data.len += (int32_t)size;
+    pParser->chunkPos = (int)(pData + size + 2 - pParser->buffer);
   }
+
+  httpTrace("context:%p, fd:%d, ip:%s, chunked body not finished, decoded size:%d, continue read", pContext,
+            pContext->fd, pContext->ipstr, pParser->data.len);
+  return HTTP_CHECK_BODY_CONTINUE;
 }
 
 int httpReadUnChunkedBody(HttpContext* pContext, HttpParser* pParser) {
-  int dataReadLen = pParser->bufsize - (int)(pParser->data.pos - pParser->buffer);
-  if (dataReadLen > pParser->data.len) {
-    httpError("context:%p, fd:%d, ip:%s, un-chunked body length invalid, read size:%d dataReadLen:%d > pContext->data.len:%d",
-              pContext, pContext->fd, pContext->ipstr, pContext->parser.bufsize, dataReadLen, pParser->data.len);
-    httpSendErrorResp(pContext, HTTP_PARSE_BODY_ERROR);
+  int dataOffset = (int)(pParser->data.pos - pParser->buffer);
+  int dataReadLen = pParser->bufsize - dataOffset;
+  if (pParser->data.len < 0 || pParser->data.len >= HTTP_MAX_BUFFER_SIZE - dataOffset) {
+    httpError("context:%p, fd:%d, ip:%s, un-chunked body length invalid, Content-Length:%d, limit:%d", pContext,
+              pContext->fd, pContext->ipstr, pParser->data.len, HTTP_MAX_BUFFER_SIZE);
+    httpSendErrorResp(pContext, HTTP_REQUSET_TOO_BIG);
     return HTTP_CHECK_BODY_ERROR;
   } else if (dataReadLen < pParser->data.len) {
     httpTrace("context:%p, fd:%d, ip:%s, un-chunked body not finished, read size:%d dataReadLen:%d < pContext->data.len:%d, continue read",
               pContext, pContext->fd, pContext->ipstr, pContext->parser.bufsize, dataReadLen, pParser->data.len);
     return HTTP_CHECK_BODY_CONTINUE;
   } else {
+    httpSetRequestEnd(pParser, pParser->data.pos + pParser->data.len);
+    pParser->data.pos[pParser->data.len] = 0;
     return HTTP_CHECK_BODY_SUCCESS;
   }
 }
@@ -313,6 +345,7 @@ bool httpParseRequest(HttpContext* pContext) {
     return true;
   }
 
+  pParser->pCur = pParser->pLast = pParser->buffer;
   httpTrace("context:%p, fd:%d, ip:%s, thread:%s, numOfFds:%d, read size:%d, raw data:\n%s",
            pContext, pContext->fd, pContext->ipstr, pContext->pThread->label, pContext->pThread->numOfFds,
            pContext->parser.bufsize, pContext->parser.buffer);
@@ -54,6 +54,9 @@ int httpWriteBufByFd(struct HttpContext* pContext, const char* buf, int sz) {
     if (len < 0) {
       httpTrace("context:%p, fd:%d, ip:%s, socket write errno:%d, times:%d",
                 pContext, pContext->fd, pContext->ipstr, errno, countWait);
+      if (errno == EINTR) continue;
+      // the peer is gone, retrying only blocks the thread which serves the other connections
+      if (errno != EAGAIN && errno != EWOULDBLOCK) break;
       if (++countWait > HTTP_WRITE_RETRY_TIMES) break;
       taosMsleep(HTTP_WRITE_WAIT_TIME_MS);
       continue;
@@ -67,6 +70,9 @@ int httpWriteBufByFd(struct HttpContext* pContext, const char* buf, int sz) {
     }
   } while (writeLen < sz);
 
+  // the response is broken, the pipelined requests left in the buffer shall not be served on this connection
+  if (writeLen < sz) pContext->httpKeepAlive = HTTP_KEEPALIVE_DISABLE;
+
   return writeLen;
 }
 
@@ -93,9 +99,39 @@ int httpWriteBufNoTrace(struct HttpContext *pContext, const char *buf, int sz) {
   return writeSz;
 }
 
+// the size line, data and tail of a chunk are sent by one system call, the part left is sent by the retries
+static int httpWriteChunk(struct HttpContext* pContext, const char* data, int len) {
+  char         head[24];
+  int          headLen = sprintf(head, "%x\r\n", len);
+  struct iovec iov[3] = {{head, (size_t)headLen}, {(void*)data, (size_t)len}, {"\r\n", 2}};
+  int          written = 0;
+
+  if (pContext->fd > 2) {
+    struct msghdr msg = {0};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 3;
+    written = (int)sendmsg(pContext->fd, &msg, MSG_NOSIGNAL);
+    if (written < 0) written = 0;
+  } else {
+    written = headLen + len + 2;
+  }
+
+  int remain = len;
+  for (int i = 0; i < 3; ++i) {
+    int sz = (int)iov[i].iov_len;
+    int sent = MIN(written, sz);
+    written -= sent;
+    if (sent < sz) {
+      sent += httpWriteBufNoTrace(pContext, (char*)iov[i].iov_base + sent, sz - sent);
+    }
+    if (i == 1) remain = sent;
+  }
+
+  return remain;
+}
+
 int httpWriteJsonBufBody(JsonBuf* buf, bool isTheLast) {
   int remain = 0;
-  char sLen[24];
   uint64_t srcLen = (uint64_t) (buf->lst - buf->buf);
 
   if (buf->pContext->fd <= 0) {
@@ -116,23 +152,22 @@ int httpWriteJsonBufBody(JsonBuf* buf, bool isTheLast) {
       httpTrace("context:%p, fd:%d, ip:%s, no data need dump", buf->pContext, buf->pContext->fd, buf->pContext->ipstr);
       return 0;  // there is no data to dump.
     } else {
-      int len = sprintf(sLen, "%lx\r\n", srcLen);
+      *buf->lst = 0;
       httpTrace("context:%p, fd:%d, ip:%s, write body, chunkSize:%" PRIu64 ", response:\n%s",
                 buf->pContext, buf->pContext->fd, buf->pContext->ipstr, srcLen, buf->buf);
-      httpWriteBufNoTrace(buf->pContext, sLen, len);
-      remain = httpWriteBufNoTrace(buf->pContext, buf->buf, (int) srcLen);
+      remain = httpWriteChunk(buf->pContext, buf->buf, (int) srcLen);
     }
   } else {
-    char compressBuf[JSON_BUFFER_SIZE] = {0};
-    int32_t compressBufLen = JSON_BUFFER_SIZE;
+    // the compressed data may be a little larger than the source, with the headers and the flush markers
+    char compressBuf[JSON_BUFFER_SIZE * 2];
+    int32_t compressBufLen = JSON_BUFFER_SIZE * 2;
+    *buf->lst = 0;
     int ret = httpGzipCompress(buf->pContext, buf->buf, srcLen, compressBuf, &compressBufLen, isTheLast);
     if (ret == 0) {
       if (compressBufLen > 0) {
-        int len = sprintf(sLen, "%x\r\n", compressBufLen);
         httpTrace("context:%p, fd:%d, ip:%s, write body, chunkSize:%" PRIu64 ", compressSize:%d, last:%d, response:\n%s",
                   buf->pContext, buf->pContext->fd, buf->pContext->ipstr, srcLen, compressBufLen, isTheLast, buf->buf);
-        httpWriteBufNoTrace(buf->pContext, sLen, len);
-        remain = httpWriteBufNoTrace(buf->pContext, (const char *) compressBuf, (int) compressBufLen);
+        remain = httpWriteChunk(buf->pContext, (const char *) compressBuf, (int) compressBufLen);
       } else {
         httpTrace("context:%p, fd:%d, ip:%s, last:%d, compress already dumped, response:\n%s",
                 buf->pContext, buf->pContext->fd, buf->pContext->ipstr, isTheLast, buf->buf);
@@ -145,10 +180,8 @@ int httpWriteJsonBufBody(JsonBuf* buf, bool isTheLast) {
     }
   }
 
-  httpWriteBufNoTrace(buf->pContext, "\r\n", 2);
   buf->total += (int) (buf->lst - buf->buf);
   buf->lst = buf->buf;
-  memset(buf->buf, 0, (size_t) buf->size);
   return remain;
 }
 
@@ -186,6 +219,7 @@ void httpInitJsonBuf(JsonBuf* buf, struct HttpContext* pContext) {
   buf->total = 0;
   buf->size = JSON_BUFFER_SIZE;  // option setting
   buf->pContext = pContext;
+  buf->hourStart = INT64_MIN;
   memset(buf->lst, 0, JSON_BUFFER_SIZE);
 
   if (pContext->acceptEncoding == HTTP_COMPRESS_GZIP) {
@@ -252,10 +286,119 @@ void httpJsonStringForTransMean(JsonBuf* buf, char* sVal, int maxLen) {
   httpJsonToken(buf, JsonStrEnd);
 }
 
+static const char httpDigitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// the digits are written backward from the end, return the position of the first digit
+static char* httpFormatUint64(char* end, uint64_t v) {
+  while (v >= 100) {
+    uint64_t q = v / 100;
+    end -= 2;
+    memcpy(end, httpDigitPairs + (v - q * 100) * 2, 2);
+    v = q;
+  }
+
+  if (v >= 10) {
+    end -= 2;
+    memcpy(end, httpDigitPairs + v * 2, 2);
+  } else {
+    *--end = (char)('0' + v);
+  }
+
+  return end;
+}
+
+// the same as "%" PRId64, without the parsing of format string
+static int httpFormatInt64(char* str, int64_t num) {
+  char  tmp[MAX_NUM_STR_SZ];
+  char* end = tmp + sizeof(tmp);
+  char* p = httpFormatUint64(end, (num < 0) ? (0 - (uint64_t)num) : (uint64_t)num);
+  if (num < 0) *--p = '-';
+
+  int len = (int)(end - p);
+  memcpy(str, p, (size_t)len);
+  return len;
+}
+
+// two digits of value less than 100
+static void httpFormatTwoDigits(char* str, int v) { memcpy(str, httpDigitPairs + v * 2, 2); }
+
+/*
+ * the same as "%.*f" for the numbers not larger than 1E10. The fraction is scaled into integer, the error of the
+ * scaling is far less than 1E-6, so the rounding of the last digit is exact unless it is close to the half, which is
+ * left to snprintf.
+ */
+static int httpFormatFixed(char* str, double num, int precision, uint64_t scale) {
+  double   absNum = fabs(num);
+  double   ipart = floor(absNum);
+  double   scaled = (absNum - ipart) * (double)scale;
+  double   fpart = floor(scaled);
+  double   half = scaled - fpart - 0.5;
+  if (half > -1E-6 && half < 1E-6) {
+    return snprintf(str, MAX_NUM_STR_SZ, "%.*f", precision, num);
+  }
+
+  uint64_t ival = (uint64_t)ipart;
+  uint64_t fval = (uint64_t)fpart + (half > 0);
+  if (fval >= scale) {
+    ival++;
+    fval -= scale;
+  }
+
+  char  tmp[MAX_NUM_STR_SZ];
+  char* end = tmp + sizeof(tmp);
+  char* p = httpFormatUint64(end, fval + scale);  // with a leading 1 to keep the zeros of the fraction
+  *p = '.';
+  p = httpFormatUint64(p, ival);
+  if (signbit(num)) *--p = '-';
+
+  int len = (int)(end - p);
+  memcpy(str, p, (size_t)len);
+  return len;
+}
+
 void httpJsonInt64(JsonBuf* buf, int64_t num) {
   httpJsonItemToken(buf);
   httpJsonTestBuf(buf, MAX_NUM_STR_SZ);
-  buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%" PRId64, num);
+  buf->lst += httpFormatInt64(buf->lst, num);
+}
+
+/*
+ * format the local time as "YYYY-mm-dd HH:MM:SS", sep is put between the date and the time. The date and hour of
+ * an hour are cached, so localtime is called once per hour of the timestamps, the changes of utc offset happen on
+ * the hour boundary. The offset of the hour is kept in zoneStr.
+ */
+static int httpFormatLocalTime(JsonBuf* buf, time_t tt, char* str, char sep) {
+  if (tt < buf->hourStart || tt >= buf->hourStart + 3600) {
+    struct tm tm;
+    if (localtime_r(&tt, &tm) == NULL || tm.tm_year + 1900 < 1000 || tm.tm_year + 1900 > 9999) {
+      buf->hourStart = INT64_MIN;
+      return -1;
+    }
+
+    strftime(buf->hourStr, sizeof(buf->hourStr), "%Y-%m-%d %H", &tm);
+    strftime(buf->zoneStr, sizeof(buf->zoneStr), "%z", &tm);
+    buf->hourStart = tt - tm.tm_min * 60 - tm.tm_sec;
+  }
+
+  int seconds = (int)(tt - buf->hourStart);
+  memcpy(str, buf->hourStr, 13);
+  str[10] = sep;
+  str[13] = ':';
+  httpFormatTwoDigits(str + 14, seconds / 60);
+  str[16] = ':';
+  httpFormatTwoDigits(str + 17, seconds % 60);
+  return 19;
+}
+
+// the fraction of second, with 3 or 6 digits
+static int httpFormatSecondFraction(char* str, int64_t fraction, bool us) {
+  char* end = str + (us ? 7 : 4);
+  char* p = httpFormatUint64(end, (uint64_t)fraction + (us ? 1000000 : 1000));
+  *p = '.';
+  return (int)(end - p);
 }
 
 void httpJsonTimestamp(JsonBuf* buf, int64_t t, bool us) {
@@ -267,8 +410,15 @@ void httpJsonTimestamp(JsonBuf* buf, int64_t t, bool us) {
   }
 
   time_t tt = t / precision;
+  int    length = (t >= 0) ? httpFormatLocalTime(buf, tt, ts, ' ') : -1;
+  if (length > 0) {
+    length += httpFormatSecondFraction(ts + length, t % precision, us);
+    httpJsonString(buf, ts, length);
+    return;
+  }
+
   ptm = localtime(&tt);
-  int length = (int) strftime(ts, 35, "%Y-%m-%d %H:%M:%S", ptm);
+  length = (int) strftime(ts, 35, "%Y-%m-%d %H:%M:%S", ptm);
   if (us) {
     length += snprintf(ts + length, 8, ".%06ld", t % precision);
   } else {
@@ -287,8 +437,17 @@ void httpJsonUtcTimestamp(JsonBuf* buf, int64_t t, bool us) {
   }
 
   time_t tt = t / precision;
+  int    length = (t >= 0) ? httpFormatLocalTime(buf, tt, ts, 'T') : -1;
+  if (length > 0) {
+    length += httpFormatSecondFraction(ts + length, t % precision, us);
+    int zoneLen = (int)strlen(buf->zoneStr);
+    memcpy(ts + length, buf->zoneStr, (size_t)zoneLen);
+    httpJsonString(buf, ts, length + zoneLen);
+    return;
+  }
+
   ptm = localtime(&tt);
-  int length = (int) strftime(ts, 40, "%Y-%m-%dT%H:%M:%S", ptm);
+  length = (int) strftime(ts, 40, "%Y-%m-%dT%H:%M:%S", ptm);
   if (us) {
     length += snprintf(ts + length, 8, ".%06ld", t % precision);
   } else {
@@ -302,7 +461,7 @@ void httpJsonUtcTimestamp(JsonBuf* buf, int64_t t, bool us) {
 void httpJsonInt(JsonBuf* buf, int num) {
   httpJsonItemToken(buf);
   httpJsonTestBuf(buf, MAX_NUM_STR_SZ);
-  buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%d", num);
+  buf->lst += httpFormatInt64(buf->lst, num);
 }
 
 void httpJsonFloat(JsonBuf* buf, float num) {
@@ -313,7 +472,7 @@ void httpJsonFloat(JsonBuf* buf, float num) {
   } else if (num > 1E10 || num < -1E10) {
     buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%.5e", num);
   } else {
-    buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%.5f", num);
+    buf->lst += httpFormatFixed(buf->lst, num, 5, 100000);
   }
 }
 
@@ -325,7 +484,7 @@ void httpJsonDouble(JsonBuf* buf, double num) {
   } else if (num > 1E10 || num < -1E10) {
     buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%.9e", num);
   } else {
-    buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%.9f", num);
+    buf->lst += httpFormatFixed(buf->lst, num, 9, 1000000000);
   }
 }
 
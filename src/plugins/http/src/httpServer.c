@@ -33,23 +33,16 @@
 static void httpStopThread(HttpThread* pThread) {
   pThread->stop = true;
 
-  // signal the thread to stop, try graceful method first,
-  // and use pthread_cancel when failed
-  struct epoll_event event = { .events = EPOLLIN };
-  eventfd_t fd = eventfd(1, 0);
-  if (fd == -1) {
-    httpError("%s, failed to create eventfd, will call pthread_cancel instead, which may result in data corruption: %s", pThread->label, strerror(errno));
-    pthread_cancel(pThread->thread);
-  } else if (epoll_ctl(pThread->pollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
-    httpError("%s, failed to call epoll_ctl, will call pthread_cancel instead, which may result in data corruption: %s", pThread->label, strerror(errno));
+  // signal the thread to stop through the eventfd it is waiting on
+  if (eventfd_write(pThread->notifyFd, 1) < 0) {
+    httpError("%s, failed to write eventfd, will call pthread_cancel instead, which may result in data corruption: %s", pThread->label, strerror(errno));
     pthread_cancel(pThread->thread);
   }
 
   pthread_join(pThread->thread, NULL);
-  if (fd != -1) {
-    close(fd);
-  }
 
+  if (pThread->listenFd >= 0) close(pThread->listenFd);
+  close(pThread->notifyFd);
   close(pThread->pollFd);
   pthread_mutex_destroy(&(pThread->threadMutex));
 }
@@ -58,10 +51,9 @@ void httpCleanUpConnect() {
   HttpServer *pServer = &tsHttpServer;
   if (pServer->pThreads == NULL) return;
 
-  pthread_join(pServer->thread, NULL);
   for (int i = 0; i < pServer->numOfThreads; ++i) {
     HttpThread* pThread = pServer->pThreads + i;
-    if (pThread != NULL) {
+    if (pThread->thread != 0) {
       httpStopThread(pThread);
     }
   }
@@ -71,109 +63,316 @@ void httpCleanUpConnect() {
   httpTrace("http server:%s is cleaned up", pServer->label);
 }
 
-bool httpReadDataImp(HttpContext *pContext) {
+void httpStopAccept() {
+  HttpServer *pServer = &tsHttpServer;
+  if (pServer->pThreads == NULL) return;
+
+  for (int i = 0; i < pServer->numOfThreads; ++i) {
+    HttpThread* pThread = pServer->pThreads + i;
+    if (pThread->listenFd >= 0) shutdown(pThread->listenFd, SHUT_RD);
+  }
+}
+
+static void httpRebasePos(char **pos, char *oldBuf, char *newBuf) {
+  if (*pos != NULL) *pos = newBuf + (*pos - oldBuf);
+}
+
+static bool httpGrowBuffer(HttpContext *pContext, int size) {
   HttpParser *pParser = &pContext->parser;
+  if (size <= pParser->bufcap) return true;
 
-  while (pParser->bufsize <= (HTTP_BUFFER_SIZE - HTTP_STEP_SIZE)) {
-    int nread = (int)taosReadSocket(pContext->fd, pParser->buffer + pParser->bufsize, HTTP_STEP_SIZE);
-    if (nread >= 0 && nread < HTTP_STEP_SIZE) {
-      pParser->bufsize += nread;
+  char *buffer = malloc((size_t)size);
+  if (buffer == NULL) {
+    httpError("context:%p, fd:%d, ip:%s, failed to alloc read buffer, size:%d", pContext, pContext->fd, pContext->ipstr,
+              size);
+    return false;
+  }
+
+  char *oldBuf = pParser->buffer;
+  if (oldBuf == NULL) {
+    buffer[0] = 0;
+  } else {
+    memcpy(buffer, oldBuf, (size_t)pParser->bufsize + 1);
+
+    // the parsed positions point into the old buffer
+    httpRebasePos(&pParser->pLast, oldBuf, buffer);
+    httpRebasePos(&pParser->pCur, oldBuf, buffer);
+    httpRebasePos(&pParser->method.pos, oldBuf, buffer);
+    httpRebasePos(&pParser->data.pos, oldBuf, buffer);
+    httpRebasePos(&pParser->token.pos, oldBuf, buffer);
+    for (int i = 0; i < HTTP_MAX_URL; ++i) {
+      httpRebasePos(&pParser->path[i].pos, oldBuf, buffer);
+    }
+    free(oldBuf);
+  }
+
+  httpTrace("context:%p, fd:%d, ip:%s, read buffer grows from %d to %d", pContext, pContext->fd, pContext->ipstr,
+            pParser->bufcap, size);
+  pParser->buffer = buffer;
+  pParser->bufcap = size;
+  return true;
+}
+
+// the buffer is enlarged for the body once the current one is full, or up to Content-Length at once
+static bool httpReserveBody(HttpContext *pContext) {
+  HttpParser *pParser = &pContext->parser;
+  int         size = pParser->bufcap * 2;
+
+  if (pContext->httpChunked == HTTP_UNCUNKED) {
+    size = (int)(pParser->data.pos - pParser->buffer) + pParser->data.len + 1;
+  } else if (pParser->bufcap - pParser->bufsize > HTTP_STEP_SIZE) {
+    return true;
+  }
+
+  if (size > HTTP_MAX_BUFFER_SIZE) size = HTTP_MAX_BUFFER_SIZE;
+  if (size <= pParser->bufsize + 1) {
+    httpError("context:%p, fd:%d, ip:%s, thread:%s, request big than:%d", pContext, pContext->fd, pContext->ipstr,
+              pContext->pThread->label, HTTP_MAX_BUFFER_SIZE);
+    return false;
+  }
+
+  return httpGrowBuffer(pContext, size);
+}
+
+#define HTTP_READ_ERROR    -1
+#define HTTP_READ_DRAINED   0
+#define HTTP_READ_FULL      1
+
+/*
+ * the socket is edge triggered, so read until it is drained or the buffer is full. HTTP_READ_FULL means there may
+ * be data left in the socket.
+ */
+static int httpReadDataImp(HttpContext *pContext) {
+  HttpParser *pParser = &pContext->parser;
+  int         code = HTTP_READ_DRAINED;
+
+  if (pParser->buffer == NULL && !httpGrowBuffer(pContext, HTTP_BUFFER_SIZE)) {
+    return HTTP_READ_ERROR;
+  }
+
+  while (1) {
+    int size = pParser->bufcap - pParser->bufsize - 1;
+    if (size <= 0) {
+      code = HTTP_READ_FULL;
       break;
-    } else if (nread < 0) {
-      if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
-        httpTrace("context:%p, fd:%d, ip:%s, read from socket error:%d, wait another event",
-                  pContext, pContext->fd, pContext->ipstr, errno);
-        break;
-      } else {
-        httpError("context:%p, fd:%d, ip:%s, read from socket error:%d, close connect",
-                  pContext, pContext->fd, pContext->ipstr, errno);
-        return false;
-      }
-    } else {
-      pParser->bufsize += nread;
     }
 
-    if (pParser->bufsize >= (HTTP_BUFFER_SIZE - HTTP_STEP_SIZE)) {
-      httpError("context:%p, fd:%d, ip:%s, thread:%s, request big than:%d",
-                pContext, pContext->fd, pContext->ipstr, pContext->pThread->label, HTTP_BUFFER_SIZE);
-      httpSendErrorResp(pContext, HTTP_REQUSET_TOO_BIG);
-      httpNotifyContextClose(pContext);
-      return false;
+    int nread = (int)taosReadSocket(pContext->fd, pParser->buffer + pParser->bufsize, size);
+    if (nread > 0) {
+      pParser->bufsize += nread;
+      if (nread < size) break;  // a short read drains a stream socket
+    } else if (nread == 0) {
+      break;  // peer closed, EPOLLRDHUP will close the context
+    } else if (errno == EINTR) {
+      continue;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      break;
+    } else {
+      httpError("context:%p, fd:%d, ip:%s, read from socket error:%d, close connect",
+                pContext, pContext->fd, pContext->ipstr, errno);
+      code = HTTP_READ_ERROR;
+      break;
     }
   }
 
   pParser->buffer[pParser->bufsize] = 0;
+  return code;
+}
 
-  return true;
+static bool httpIsHeadReceived(HttpParser *pParser) {
+  return strstr(pParser->buffer, "\r\n\r\n") != NULL;
 }
 
 static bool httpDecompressData(HttpContext *pContext) {
+  HttpParser *pParser = &pContext->parser;
   if (pContext->contentEncoding != HTTP_COMPRESS_GZIP) {
-    httpDump("context:%p, fd:%d, ip:%s, content:%s", pContext, pContext->fd, pContext->ipstr, pContext->parser.data.pos);
+    httpDump("context:%p, fd:%d, ip:%s, content:%s", pContext, pContext->fd, pContext->ipstr, pParser->data.pos);
     return true;
   }
 
-  char   *decompressBuf = calloc(HTTP_DECOMPRESS_BUF_SIZE, 1);
-  int32_t decompressBufLen = HTTP_DECOMPRESS_BUF_SIZE;
-  size_t  bufsize = sizeof(pContext->parser.buffer) - (pContext->parser.data.pos - pContext->parser.buffer) - 1;
-  if (decompressBufLen > (int)bufsize) {
-    decompressBufLen = (int)bufsize;
+  int     dataOffset = (int)(pParser->data.pos - pParser->buffer);
+  int     nextLen = (pParser->nextPos > 0) ? (pParser->bufsize - pParser->nextPos) : 0;
+  int32_t decompressBufLen = MAX(HTTP_DECOMPRESS_BUF_SIZE, pParser->data.len * 16);
+  if (decompressBufLen > HTTP_MAX_BUFFER_SIZE - dataOffset - nextLen - 2) {
+    decompressBufLen = HTTP_MAX_BUFFER_SIZE - dataOffset - nextLen - 2;
+  }
+
+  char *decompressBuf = calloc(decompressBufLen, 1);
+  int   ret = -1;
+  if (decompressBuf != NULL) {
+    ret = httpGzipDeCompress(pParser->data.pos, pParser->data.len, decompressBuf, &decompressBufLen);
   }
 
-  int ret = httpGzipDeCompress(pContext->parser.data.pos, pContext->parser.data.len, decompressBuf, &decompressBufLen);
+  if (ret == 0 && !httpGrowBuffer(pContext, dataOffset + decompressBufLen + nextLen + 2)) {
+    ret = -1;
+  }
 
   if (ret == 0) {
-    memcpy(pContext->parser.data.pos, decompressBuf, decompressBufLen);
-    pContext->parser.data.pos[decompressBufLen] = 0;
+    // the pipelined request is moved behind the decompressed body
+    if (nextLen > 0) {
+      int nextPos = dataOffset + decompressBufLen + 1;
+      pParser->buffer[pParser->nextPos] = pParser->nextChar;
+      memmove(pParser->buffer + nextPos, pParser->buffer + pParser->nextPos, (size_t)nextLen);
+      pParser->nextPos = nextPos;
+      pParser->nextChar = pParser->buffer[nextPos];
+      pParser->bufsize = nextPos + nextLen;
+      pParser->buffer[pParser->bufsize] = 0;
+    } else {
+      pParser->bufsize = dataOffset + decompressBufLen;
+    }
+
+    memcpy(pParser->data.pos, decompressBuf, decompressBufLen);
+    pParser->data.pos[decompressBufLen] = 0;
     httpDump("context:%p, fd:%d, ip:%s, rawSize:%d, decompressSize:%d, content:%s",
-              pContext, pContext->fd, pContext->ipstr, pContext->parser.data.len, decompressBufLen,  decompressBuf);
-    pContext->parser.data.len = decompressBufLen;
+              pContext, pContext->fd, pContext->ipstr, pParser->data.len, decompressBufLen,  decompressBuf);
+    pParser->data.len = decompressBufLen;
   } else {
     httpError("context:%p, fd:%d, ip:%s, failed to decompress data, rawSize:%d, error:%d",
-              pContext, pContext->fd, pContext->ipstr, pContext->parser.data.len, ret);
+              pContext, pContext->fd, pContext->ipstr, pParser->data.len, ret);
   }
 
   free(decompressBuf);
   return ret == 0;
 }
 
+/*
+ * the reference of the context is released here unless the request is complete, the error responses release
+ * it by httpCloseContextByApp
+ */
 static bool httpReadData(HttpContext *pContext) {
-  if (!pContext->parsed) {
-    httpInitContext(pContext);
+  HttpParser *pParser = &pContext->parser;
+
+  while (1) {
+    int code = httpReadDataImp(pContext);
+    if (code == HTTP_READ_ERROR) {
+      httpNotifyContextClose(pContext);
+      httpReleaseContext(pContext);
+      return false;
+    }
+
+    if (!pContext->parsed) {
+      if (!httpIsHeadReceived(pParser)) {
+        if (code == HTTP_READ_FULL) {
+          httpError("context:%p, fd:%d, ip:%s, thread:%s, http head big than:%d", pContext, pContext->fd,
+                    pContext->ipstr, pContext->pThread->label, HTTP_BUFFER_SIZE);
+          httpSendErrorResp(pContext, HTTP_REQUSET_TOO_BIG);
+          httpNotifyContextClose(pContext);
+        } else {
+          httpReleaseContext(pContext);
+        }
+        return false;
+      }
+
+      if (!httpParseRequest(pContext)) {
+        httpNotifyContextClose(pContext);
+        return false;
+      }
+    }
+
+    int ret = httpCheckReadCompleted(pContext);
+    if (ret == HTTP_CHECK_BODY_SUCCESS) {
+      // there may be pipelined requests left in the socket
+      if (code == HTTP_READ_FULL) atomic_store_32(&pContext->readPending, 1);
+      break;
+    } else if (ret == HTTP_CHECK_BODY_ERROR) {
+      httpError("context:%p, fd:%d, ip:%s, failed to read http body, close connect", pContext, pContext->fd,
+                pContext->ipstr);
+      httpNotifyContextClose(pContext);
+      return false;
+    }
+
+    if (!httpReserveBody(pContext)) {
+      httpSendErrorResp(pContext, HTTP_REQUSET_TOO_BIG);
+      httpNotifyContextClose(pContext);
+      return false;
+    }
+
+    if (code != HTTP_READ_FULL) {
+      httpReleaseContext(pContext);
+      return false;
+    }
   }
 
-  if (!httpReadDataImp(pContext)) {
+  httpTrace("context:%p, fd:%d, ip:%s, thread:%s, read size:%d, dataLen:%d", pContext, pContext->fd, pContext->ipstr,
+            pContext->pThread->label, pParser->bufsize, pParser->data.len);
+
+  if (!httpDecompressData(pContext)) {
+    httpSendErrorResp(pContext, HTTP_PARSE_BODY_ERROR);
     httpNotifyContextClose(pContext);
     return false;
   }
 
-  if (!httpParseRequest(pContext)) {
-    httpNotifyContextClose(pContext);
-    return false;
+  return true;
+}
+
+/*
+ * the read events are ignored while a request is handled, the pipelined request and the data arrived meanwhile
+ * are processed by the http thread once the response is sent
+ */
+void httpResumeContext(HttpContext *pContext) {
+  HttpThread *pThread = pContext->pThread;
+  if (atomic_val_compare_exchange_32(&pContext->resumeQueued, 0, 1) != 0) return;
+
+  if (httpGetContext(pContext) == NULL) {
+    atomic_store_32(&pContext->resumeQueued, 0);
+    return;
   }
 
-  int ret = httpCheckReadCompleted(pContext);
-  if (ret == HTTP_CHECK_BODY_CONTINUE) {
-    //httpTrace("context:%p, fd:%d, ip:%s, not finished yet, wait another event", pContext, pContext->fd, pContext->ipstr);
-    return false;
-  } else if (ret == HTTP_CHECK_BODY_SUCCESS){
-    httpTrace("context:%p, fd:%d, ip:%s, thread:%s, read size:%d, dataLen:%d",
-              pContext, pContext->fd, pContext->ipstr, pContext->pThread->label, pContext->parser.bufsize, pContext->parser.data.len);
-    if (httpDecompressData(pContext)) {
-      return true;
-    } else {
-      httpNotifyContextClose(pContext);
-      return false;
-    }
-  } else {
-    httpError("context:%p, fd:%d, ip:%s, failed to read http body, close connect", pContext, pContext->fd, pContext->ipstr);
+  pthread_mutex_lock(&pThread->threadMutex);
+  pContext->pNextResume = pThread->pHead;
+  pThread->pHead = pContext;
+  pthread_mutex_unlock(&pThread->threadMutex);
+
+  eventfd_write(pThread->notifyFd, 1);
+}
+
+// it takes over the reference of the context
+static void httpProcessReadEvent(HttpThread *pThread, HttpContext *pContext) {
+  HttpServer *pServer = &tsHttpServer;
+
+  atomic_store_32(&pContext->readPending, 1);
+  if (!httpAlterContextState(pContext, HTTP_CONTEXT_STATE_READY, HTTP_CONTEXT_STATE_READY)) {
+    httpTrace("context:%p, fd:%d, ip:%s, state:%s, not in ready state, read it later",
+              pContext, pContext->fd, pContext->ipstr, httpContextStateStr(pContext->state));
+    httpReleaseContext(pContext);
+    return;
+  }
+  atomic_store_32(&pContext->readPending, 0);
+
+  if (pServer->status != HTTP_SERVER_RUNNING) {
+    httpTrace("context:%p, fd:%d, ip:%s, state:%s, server is not running, accessed:%d, close connect", pContext,
+              pContext->fd, pContext->ipstr, httpContextStateStr(pContext->state), pContext->accessTimes);
+    httpSendErrorResp(pContext, HTTP_SERVER_OFFLINE);
     httpNotifyContextClose(pContext);
-    return false;
+  } else {
+    if (httpReadData(pContext)) {
+      (*(pThread->processData))(pContext);
+      atomic_fetch_add_32(&pServer->requestNum, 1);
+    }
   }
 }
 
+static void httpProcessResumedContexts(HttpThread *pThread) {
+  eventfd_t value;
+  eventfd_read(pThread->notifyFd, &value);
+
+  pthread_mutex_lock(&pThread->threadMutex);
+  HttpContext *pContext = pThread->pHead;
+  pThread->pHead = NULL;
+  pthread_mutex_unlock(&pThread->threadMutex);
+
+  while (pContext != NULL) {
+    HttpContext *pNext = pContext->pNextResume;
+    pContext->pNextResume = NULL;
+    atomic_store_32(&pContext->resumeQueued, 0);
+    httpProcessReadEvent(pThread, pContext);
+    pContext = pNext;
+  }
+}
+
+static void httpAcceptHttpConnection(HttpThread *pThread);
+
 static void httpProcessHttpData(void *param) {
-  HttpServer  *pServer = &tsHttpServer;
   HttpThread  *pThread = (HttpThread *)param;
   HttpContext *pContext;
   int          fdNum;
@@ -185,8 +384,7 @@ static void httpProcessHttpData(void *param) {
 
   while (1) {
     struct epoll_event events[HTTP_MAX_EVENTS];
-    //-1 means uncertainty, 0-nowait, 1-wait 1 ms, set it from -1 to 1
-    fdNum = epoll_wait(pThread->pollFd, events, HTTP_MAX_EVENTS, 1);
+    fdNum = epoll_wait(pThread->pollFd, events, HTTP_MAX_EVENTS, -1);
     if (pThread->stop) {
       httpTrace("%p, http thread get stop event, exiting...", pThread);
       break;
@@ -194,6 +392,16 @@ static void httpProcessHttpData(void *param) {
     if (fdNum <= 0) continue;
 
     for (int i = 0; i < fdNum; ++i) {
+      if (events[i].data.ptr == &pThread->listenFd) {
+        httpAcceptHttpConnection(pThread);
+        continue;
+      }
+
+      if (events[i].data.ptr == &pThread->notifyFd) {
+        httpProcessResumedContexts(pThread);
+        continue;
+      }
+
       pContext = httpGetContext(events[i].data.ptr);
       if (pContext == NULL) {
         httpError("context:%p, is already released, close connect", events[i].data.ptr);
@@ -230,63 +438,31 @@ static void httpProcessHttpData(void *param) {
         continue;
       }
 
-      if (!httpAlterContextState(pContext, HTTP_CONTEXT_STATE_READY, HTTP_CONTEXT_STATE_READY)) {
-        httpTrace("context:%p, fd:%d, ip:%s, state:%s, not in ready state, ignore read events",
-                pContext, pContext->fd, pContext->ipstr, httpContextStateStr(pContext->state));
-        httpReleaseContext(pContext);
-        continue;
-      }
-
-      if (pServer->status != HTTP_SERVER_RUNNING) {
-        httpTrace("context:%p, fd:%d, ip:%s, state:%s, server is not running, accessed:%d, close connect", pContext,
-                  pContext->fd, pContext->ipstr, httpContextStateStr(pContext->state), pContext->accessTimes);
-        httpSendErrorResp(pContext, HTTP_SERVER_OFFLINE);
-        httpNotifyContextClose(pContext);
-      } else {
-        if (httpReadData(pContext)) {
-          (*(pThread->processData))(pContext);
-          atomic_fetch_add_32(&pServer->requestNum, 1);
-        }
-      }
+      httpProcessReadEvent(pThread, pContext);
     }
   }
 }
 
-static void *httpAcceptHttpConnection(void *arg) {
+static void httpAcceptHttpConnection(HttpThread *pThread) {
   int                connFd = -1;
   struct sockaddr_in clientAddr;
-  int                threadId = 0;
   HttpServer *       pServer = &tsHttpServer;
-  HttpThread *       pThread = NULL;
   HttpContext *      pContext = NULL;
   int                totalFds = 0;
 
-  sigset_t set;
-  sigemptyset(&set);
-  sigaddset(&set, SIGPIPE);
-  pthread_sigmask(SIG_SETMASK, &set, NULL);
-
-  pServer->fd = taosOpenTcpServerSocket(pServer->serverIp, pServer->serverPort);
-
-  if (pServer->fd < 0) {
-    httpError("http server:%s, failed to open http socket, ip:%s:%u error:%s", pServer->label,
-              taosIpStr(pServer->serverIp), pServer->serverPort, strerror(errno));
-    return NULL;
-  } else {
-    httpPrint("http server init success at %u", pServer->serverPort);
-    pServer->status = HTTP_SERVER_RUNNING;
-  }
-
   while (1) {
     socklen_t addrlen = sizeof(clientAddr);
-    connFd = (int)accept(pServer->fd, (struct sockaddr *)&clientAddr, &addrlen);
+    connFd = (int)accept(pThread->listenFd, (struct sockaddr *)&clientAddr, &addrlen);
     if (connFd == -1) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+      if (errno == EINTR || errno == ECONNABORTED) continue;
       if (errno == EINVAL) {
-        httpTrace("http server:%s socket was shutdown, exiting...", pServer->label);
+        httpTrace("http thread:%s socket was shutdown, stop accepting", pThread->label);
+        epoll_ctl(pThread->pollFd, EPOLL_CTL_DEL, pThread->listenFd, NULL);
         break;
       }
-      httpError("http server:%s, accept connect failure, errno:%d reason:%s", pServer->label, errno, strerror(errno));
-      continue;
+      httpError("http thread:%s, accept connect failure, errno:%d reason:%s", pThread->label, errno, strerror(errno));
+      break;
     }
 
     totalFds = 1;
@@ -304,9 +480,6 @@ static void *httpAcceptHttpConnection(void *arg) {
     taosKeepTcpAlive(connFd);
     taosSetNonblocking(connFd, 1);
 
-    // pick up the thread to handle this connection
-    pThread = pServer->pThreads + threadId;
-
     pContext = httpCreateContext(connFd);
     if (pContext == NULL) {
       httpError("fd:%d, ip:%s:%u, no enough resource to allocate http context", connFd, inet_ntoa(clientAddr.sin_addr),
@@ -316,10 +489,12 @@ static void *httpAcceptHttpConnection(void *arg) {
     }
 
     pContext->pThread = pThread;
-    sprintf(pContext->ipstr, "%s:%u", inet_ntoa(clientAddr.sin_addr), htons(clientAddr.sin_port));
-    
+    snprintf(pContext->ipstr, sizeof(pContext->ipstr), "%s:%u", inet_ntoa(clientAddr.sin_addr),
+             htons(clientAddr.sin_port));
+    httpInitContext(pContext);
+
     struct epoll_event event;
-    event.events = EPOLLIN | EPOLLPRI | EPOLLWAKEUP | EPOLLERR | EPOLLHUP | EPOLLRDHUP;
+    event.events = EPOLLIN | EPOLLPRI | EPOLLWAKEUP | EPOLLERR | EPOLLHUP | EPOLLRDHUP | EPOLLET;
     event.data.ptr = pContext;
     if (epoll_ctl(pThread->pollFd, EPOLL_CTL_ADD, connFd, &event) < 0) {
       httpError("context:%p, fd:%d, ip:%s, thread:%s, failed to add http fd for epoll, error:%s", pContext, connFd,
@@ -329,18 +504,55 @@ static void *httpAcceptHttpConnection(void *arg) {
       continue;
     }
 
-    // notify the data process, add into the FdObj list
     atomic_add_fetch_32(&pThread->numOfFds, 1);
     httpTrace("context:%p, fd:%d, ip:%s, thread:%s numOfFds:%d totalFds:%d, accept a new connection", pContext, connFd,
               pContext->ipstr, pThread->label, pThread->numOfFds, totalFds);
+  }
+}
+
+// every http thread listens on the port, the kernel spreads the incoming connections among them
+static int httpOpenListenSocket(HttpServer *pServer) {
+  struct sockaddr_in serverAdd;
+  int                reuse = 1;
 
-    // pick up next thread for next connection
-    threadId++;
-    threadId = threadId % pServer->numOfThreads;
+  int sockFd = (int)socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (sockFd < 0) {
+    httpError("http server:%s, failed to open TCP socket: %d (%s)", pServer->label, errno, strerror(errno));
+    return -1;
   }
 
-  close(pServer->fd);
-  return NULL;
+  bzero((char *)&serverAdd, sizeof(serverAdd));
+  serverAdd.sin_family = AF_INET;
+  serverAdd.sin_addr.s_addr = pServer->serverIp;
+  serverAdd.sin_port = (uint16_t)htons(pServer->serverPort);
+
+  if (taosSetSockOpt(sockFd, SOL_SOCKET, SO_REUSEADDR, (void *)&reuse, sizeof(reuse)) < 0 ||
+      taosSetSockOpt(sockFd, SOL_SOCKET, SO_REUSEPORT, (void *)&reuse, sizeof(reuse)) < 0) {
+    httpError("http server:%s, setsockopt SO_REUSEADDR/SO_REUSEPORT failed: %d (%s)", pServer->label, errno,
+              strerror(errno));
+    close(sockFd);
+    return -1;
+  }
+
+  if (bind(sockFd, (struct sockaddr *)&serverAdd, sizeof(serverAdd)) < 0 || listen(sockFd, HTTP_LISTEN_BACKLOG) < 0) {
+    httpError("http server:%s, failed to listen on ip:%s:%u, error:%s", pServer->label, taosIpStr(pServer->serverIp),
+              pServer->serverPort, strerror(errno));
+    close(sockFd);
+    return -1;
+  }
+
+  taosSetNonblocking(sockFd, 1);
+  return sockFd;
+}
+
+static bool httpAddIntoEpoll(HttpThread *pThread, int fd, int *ptr) {
+  struct epoll_event event = {.events = EPOLLIN};
+  event.data.ptr = ptr;
+  if (epoll_ctl(pThread->pollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+    httpError("http thread:%s, failed to add fd:%d into epoll, error:%s", pThread->label, fd, strerror(errno));
+    return false;
+  }
+  return true;
 }
 
 bool httpInitConnect() {
@@ -353,9 +565,12 @@ bool httpInitConnect() {
 
   HttpThread *pThread = pServer->pThreads;
   for (int i = 0; i < pServer->numOfThreads; ++i) {
-    sprintf(pThread->label, "%s%d", pServer->label, i);
+    if (snprintf(pThread->label, sizeof(pThread->label), "%s%d", pServer->label, i) >= HTTP_LABEL_SIZE) {
+      httpTrace("http thread:%d, label is truncated to %s", i, pThread->label);
+    }
     pThread->processData = pServer->processData;
     pThread->threadId = i;
+    pThread->listenFd = -1;
 
     if (pthread_mutex_init(&(pThread->threadMutex), NULL) < 0) {
       httpError("http thread:%s, failed to init HTTP process data mutex, reason:%s", pThread->label, strerror(errno));
@@ -368,6 +583,22 @@ bool httpInitConnect() {
       return false;
     }
 
+    pThread->notifyFd = eventfd(0, EFD_NONBLOCK);
+    if (pThread->notifyFd < 0) {
+      httpError("http thread:%s, failed to create eventfd, reason:%s", pThread->label, strerror(errno));
+      return false;
+    }
+
+    pThread->listenFd = httpOpenListenSocket(pServer);
+    if (pThread->listenFd < 0) {
+      return false;
+    }
+
+    if (!httpAddIntoEpoll(pThread, pThread->notifyFd, &pThread->notifyFd) ||
+        !httpAddIntoEpoll(pThread, pThread->listenFd, &pThread->listenFd)) {
+      return false;
+    }
+
     pthread_attr_t thattr;
     pthread_attr_init(&thattr);
     pthread_attr_setdetachstate(&thattr, PTHREAD_CREATE_JOINABLE);
@@ -382,15 +613,8 @@ bool httpInitConnect() {
     pThread++;
   }
 
-  pthread_attr_t thattr;
-  pthread_attr_init(&thattr);
-  pthread_attr_setdetachstate(&thattr, PTHREAD_CREATE_JOINABLE);
-  if (pthread_create(&(pServer->thread), &thattr, (void *)httpAcceptHttpConnection, (void *)(pServer)) != 0) {
-    httpError("http server:%s, failed to create Http accept thread, reason:%s", pServer->label, strerror(errno));
-    return false;
-  }
-  pthread_attr_destroy(&thattr);
-
+  pServer->status = HTTP_SERVER_RUNNING;
+  httpPrint("http server init success at %u", pServer->serverPort);
   httpTrace("http server:%s, initialized, ip:%s:%u, numOfThreads:%d", pServer->label, taosIpStr(pServer->serverIp),
             pServer->serverPort, pServer->numOfThreads);
   return true;
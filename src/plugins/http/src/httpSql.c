@@ -16,6 +16,7 @@
 #define _DEFAULT_SOURCE
 #include "os.h"
 #include "tnote.h"
+#include "tsched.h"
 #include "taos.h"
 #include "tsclient.h"
 #include "httpInt.h"
@@ -247,7 +248,8 @@ void httpProcessSingleSqlCallBack(void *param, TAOS_RES *result, int code) {
 
   if (code < 0) {
     SSqlObj *pObj = (SSqlObj *)result;
-    if (code == TSDB_CODE_TSC_INVALID_SQL) {
+    // no sqlObj is created if the sql is rejected before parsing, e.g. too long
+    if (code == TSDB_CODE_TSC_INVALID_SQL && pObj != NULL) {
       httpError("context:%p, fd:%d, ip:%s, user:%s, query error, taos:%p, code:%s, sqlObj:%p, error:%s",
                 pContext, pContext->fd, pContext->ipstr, pContext->user, pContext->session->taos, tstrerror(code), pObj, pObj->cmd.payload);
       httpSendTaosdInvalidSqlErrorResp(pContext, pObj->cmd.payload);
@@ -334,6 +336,27 @@ void httpProcessHeartBeatCmd(HttpContext *pContext) {
   httpCloseContextByApp(pContext);
 }
 
+static void httpProcessNativeInsertInWorker(SSchedMsg *pMsg) {
+  HttpContext *pContext = (HttpContext *)pMsg->ahandle;
+  (pContext->nativeInsertFp)(pContext);
+}
+
+void httpProcessNativeInsertCmd(HttpContext *pContext) {
+  void *workerQhandle = tsHttpServer.workerQhandle;
+  if (workerQhandle == NULL || pContext->nativeInsertFp == NULL) {
+    httpSendErrorResp(pContext, HTTP_SERVER_OFFLINE);
+    return;
+  }
+
+  httpTrace("context:%p, fd:%d, ip:%s, user:%s, schedule native insertion", pContext, pContext->fd, pContext->ipstr,
+            pContext->user);
+
+  SSchedMsg schedMsg = {0};
+  schedMsg.fp = httpProcessNativeInsertInWorker;
+  schedMsg.ahandle = pContext;
+  taosScheduleTask(workerQhandle, &schedMsg);
+}
+
 void httpExecCmd(HttpContext *pContext) {
   switch (pContext->reqType) {
     case HTTP_REQTYPE_LOGIN:
@@ -348,6 +371,9 @@ void httpExecCmd(HttpContext *pContext) {
     case HTTP_REQTYPE_HEARTBEAT:
       httpProcessHeartBeatCmd(pContext);
       break;
+    case HTTP_REQTYPE_NATIVE_INSERT:
+      httpProcessNativeInsertCmd(pContext);
+      break;
     case HTTP_REQTYPE_OTHERS:
       httpCloseContextByApp(pContext);
       break;
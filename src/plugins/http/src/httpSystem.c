@@ -19,6 +19,7 @@
 #include "tglobal.h"
 #include "tsocket.h"
 #include "ttimer.h"
+#include "tsched.h"
 #include "tadmin.h"
 #include "httpInt.h"
 #include "httpContext.h"
@@ -77,6 +78,12 @@ int httpStartSystem() {
     return -1;
   }
 
+  tsHttpServer.workerQhandle = taosInitScheduler(HTTP_WORKER_QUEUE_SIZE, tsHttpServer.numOfThreads, "httpWorker");
+  if (tsHttpServer.workerQhandle == NULL) {
+    httpError("http init workers failed");
+    return -1;
+  }
+
   if (!httpInitConnect()) {
     httpError("http init server failed");
     return -1;
@@ -87,7 +94,11 @@ int httpStartSystem() {
 
 void httpStopSystem() {
   tsHttpServer.status = HTTP_SERVER_CLOSING;
-  shutdown(tsHttpServer.fd, SHUT_RD);
+  httpStopAccept();
+
+  // the workers may be using the schemas of telegraf
+  taosCleanUpScheduler(tsHttpServer.workerQhandle);
+  tsHttpServer.workerQhandle = NULL;
   tgCleanupHandle();
 }
 
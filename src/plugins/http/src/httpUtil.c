@@ -407,38 +407,35 @@ int httpGzipCompressInit(HttpContext *pContext) {
   return 0;
 }
 
+/*
+ * the output of each chunk is flushed, and the dictionary is kept between the chunks of a response. The size of the
+ * compressed chunk is returned by nDestData, 0 if the source is kept by zlib and nothing is output.
+ */
 int httpGzipCompress(HttpContext *pContext, char *srcData, int32_t nSrcData, char *destData, int32_t *nDestData, bool isTheLast) {
-  int err = 0;
-  pContext->gzipStream.next_in = (Bytef *) srcData;
-  pContext->gzipStream.avail_in = (uLong) nSrcData;
-  pContext->gzipStream.next_out = (Bytef *) destData;
-  pContext->gzipStream.avail_out = (uLong) (*nDestData);
-
-  while (pContext->gzipStream.avail_in != 0 && pContext->gzipStream.total_out < (uLong) (*nDestData)) {
-    if (deflate(&pContext->gzipStream, Z_FULL_FLUSH) != Z_OK) {
-      return -1;
-    }
-  }
-
-  if (pContext->gzipStream.avail_in != 0) {
-    return pContext->gzipStream.avail_in;
-  }
+  z_stream *stream = &pContext->gzipStream;
+  stream->next_in = (Bytef *) srcData;
+  stream->avail_in = (uInt) nSrcData;
+  stream->next_out = (Bytef *) destData;
+  stream->avail_out = (uInt) (*nDestData);
 
+  int err = deflate(stream, isTheLast ? Z_FINISH : Z_SYNC_FLUSH);
   if (isTheLast) {
-    for (;;) {
-      if ((err = deflate(&pContext->gzipStream, Z_FINISH)) == Z_STREAM_END) {
-        break;
-      }
-      if (err != Z_OK) {
-        return -2;
-      }
+    if (err != Z_STREAM_END) {
+      deflateEnd(stream);
+      return -2;
     }
 
-    if (deflateEnd(&pContext->gzipStream) != Z_OK) {
+    if (deflateEnd(stream) != Z_OK) {
       return -3;
     }
+  } else if (err != Z_OK && err != Z_BUF_ERROR) {
+    return -1;
+  }
+
+  if (stream->avail_in != 0) {
+    return stream->avail_in;
   }
 
-  *nDestData = (int32_t) (pContext->gzipStream.total_out);
+  *nDestData -= (int32_t) stream->avail_out;
   return 0;
 }
@@ -19,9 +19,15 @@
 #include "taosdef.h"
 #include "taosmsg.h"
 #include "httpInt.h"
+#include "httpContext.h"
 #include "tgHandle.h"
 #include "tgJson.h"
 #include "cJSON.h"
+#include "taos.h"
+#include "taoserror.h"
+#include "tcache.h"
+#include "hash.h"
+#include "tnote.h"
 
 /*
  * taos.telegraf.cfg formats like
@@ -295,6 +301,10 @@ int tgReadSchema(char *fileName) {
   return schemaNum;
 }
 
+#define TG_STABLE_KEEP_TIME 3600  // seconds to keep the schemas of super tables for native insertion
+
+static void *tgStableCache = NULL;
+
 void tgInitHandle(HttpServer *pServer) {
   char fileName[TSDB_FILENAME_LEN*2] = {0};
   sprintf(fileName, "%s/taos.telegraf.cfg", configDir);
@@ -305,11 +315,17 @@ void tgInitHandle(HttpServer *pServer) {
     }
   }
 
+  tgStableCache = taosCacheInit(5);
   httpAddMethod(pServer, &tgDecodeMethod);
 }
 
 void tgCleanupHandle() {
   tgFreeSchemas();
+
+  if (tgStableCache != NULL) {
+    taosCacheCleanup(tgStableCache);
+    tgStableCache = NULL;
+  }
 }
 
 bool tgGetUserFromUrl(HttpContext *pContext) {
@@ -685,6 +701,11 @@ bool tgProcessSingleMetric(HttpContext *pContext, cJSON *metric, char *db) {
       httpAddToSqlCmdBuffer(pContext, "t_%s %s)", tag_name, tag_type);
   }
 
+  // the metric is inserted by column binding, no insert sql is needed
+  if (tsTelegrafUseNativeInsert) {
+    return true;
+  }
+
   // assembling insert sql
   table_cmd->sql = httpAddToSqlCmdBufferNoTerminal(pContext, "import into %s.%s using %s.%s tags(", db,
                                                    httpGetCmdsString(pContext, table_cmd->table), db,
@@ -799,20 +820,19 @@ bool tgProcessSingleMetric(HttpContext *pContext, cJSON *metric, char *db) {
     ]
  }
  */
-bool tgProcessQueryRequest(HttpContext *pContext, char *db) {
-  httpTrace("context:%p, fd:%d, ip:%s, process telegraf query msg", pContext, pContext->fd, pContext->ipstr);
-
+// parse the metrics and assemble the commands, the json is returned to get the values of metrics
+static cJSON *tgParseRequest(HttpContext *pContext, char *db) {
   HttpParser *pParser = &pContext->parser;
   char *      filter = pParser->data.pos;
   if (filter == NULL) {
     httpSendErrorResp(pContext, HTTP_NO_MSG_INPUT);
-    return false;
+    return NULL;
   }
 
   cJSON *root = cJSON_Parse(filter);
   if (root == NULL) {
     httpSendErrorResp(pContext, HTTP_TG_INVALID_JSON);
-    return false;
+    return NULL;
   }
 
   cJSON *metrics = cJSON_GetObjectItem(root, "metrics");
@@ -823,27 +843,27 @@ bool tgProcessQueryRequest(HttpContext *pContext, char *db) {
     if (size <= 0) {
       httpSendErrorResp(pContext, HTTP_TG_METRICS_NULL);
       cJSON_Delete(root);
-      return false;
+      return NULL;
     }
 
     int cmdSize = size * 2 + 1;
     if (cmdSize > HTTP_MAX_CMD_SIZE) {
       httpSendErrorResp(pContext, HTTP_TG_METRICS_SIZE);
       cJSON_Delete(root);
-      return false;
+      return NULL;
     }
 
     if (!httpMallocMultiCmds(pContext, cmdSize, HTTP_BUFFER_SIZE)) {
       httpSendErrorResp(pContext, HTTP_NO_ENOUGH_MEMORY);
       cJSON_Delete(root);
-      return false;
+      return NULL;
     }
 
     HttpSqlCmd *cmd = httpNewSqlCmd(pContext);
     if (cmd == NULL) {
       httpSendErrorResp(pContext, HTTP_NO_ENOUGH_MEMORY);
       cJSON_Delete(root);
-      return false;
+      return NULL;
     }
     cmd->cmdType = HTTP_CMD_TYPE_CREATE_DB;
     cmd->cmdReturnType = HTTP_CMD_RETURN_TYPE_NO_RETURN;
@@ -854,7 +874,7 @@ bool tgProcessQueryRequest(HttpContext *pContext, char *db) {
       if (metric != NULL) {
         if (!tgProcessSingleMetric(pContext, metric, db)) {
           cJSON_Delete(root);
-          return false;
+          return NULL;
         }
       }
     }
@@ -864,14 +884,14 @@ bool tgProcessQueryRequest(HttpContext *pContext, char *db) {
     if (!httpMallocMultiCmds(pContext, 3, HTTP_BUFFER_SIZE)) {
       httpSendErrorResp(pContext, HTTP_NO_ENOUGH_MEMORY);
       cJSON_Delete(root);
-      return false;
+      return NULL;
     }
 
     HttpSqlCmd *cmd = httpNewSqlCmd(pContext);
     if (cmd == NULL) {
       httpSendErrorResp(pContext, HTTP_NO_ENOUGH_MEMORY);
       cJSON_Delete(root);
-      return false;
+      return NULL;
     }
     cmd->cmdType = HTTP_CMD_TYPE_CREATE_DB;
     cmd->cmdReturnType = HTTP_CMD_RETURN_TYPE_NO_RETURN;
@@ -879,10 +899,525 @@ bool tgProcessQueryRequest(HttpContext *pContext, char *db) {
 
     if (!tgProcessSingleMetric(pContext, root, db)) {
       cJSON_Delete(root);
-      return false;
+      return NULL;
+    }
+  }
+
+  return root;
+}
+
+/*
+ * native insertion: the metrics are inserted by the column binding API of client, no sql is assembled and parsed.
+ * It runs in the worker threads, since the client API is synchronous. The schemas of super tables are cached by
+ * name, the metrics of one table are bound as its rows, and the missing tables are created along with the insertion
+ * by the tags of their first metric.
+ */
+
+// the schema of a super table, the columns are followed by the tags
+typedef struct {
+  int32_t numOfColumns;
+  int32_t numOfTags;
+  SSchema schema[];
+} STgStable;
+
+typedef struct {
+  char       name[TSDB_TABLE_ID_LEN];
+  char       stableId[TSDB_TABLE_ID_LEN];
+  STgStable *pStable;
+  int32_t    numOfRows;
+  int32_t    firstRow;  // position of the first metric in the row list
+  int32_t    code;
+} STgTable;
+
+static int32_t tgExecSql(HttpContext *pContext, char *sql) {
+  httpDump("context:%p, fd:%d, ip:%s, user:%s, start query, sql:%s", pContext, pContext->fd, pContext->ipstr,
+           pContext->user, sql);
+  taosNotePrintHttp(sql);
+
+  TAOS_RES *result = taos_query(pContext->session->taos, sql);
+  int32_t   code = taos_errno(result);
+  taos_free_result(result);
+  return code;
+}
+
+static uint8_t tgGetDataType(char *name, int32_t len) {
+  for (uint8_t t = TSDB_DATA_TYPE_BOOL; t <= TSDB_DATA_TYPE_NCHAR; ++t) {
+    if (tDataTypeDesc[t].nameLen == len && strncasecmp(tDataTypeDesc[t].aName, name, len) == 0) {
+      return t;
+    }
+  }
+
+  return TSDB_DATA_TYPE_NULL;
+}
+
+// the schema is put into cache, and acquired by the caller
+static int32_t tgDescribeStable(HttpContext *pContext, char *stableId, STgStable **ppStable) {
+  char sql[TSDB_TABLE_ID_LEN + 16];
+  snprintf(sql, sizeof(sql), "describe %s", stableId);
+
+  TAOS_RES *result = taos_query(pContext->session->taos, sql);
+  int32_t   code = taos_errno(result);
+  if (code != TSDB_CODE_SUCCESS) {
+    taos_free_result(result);
+    return code;
+  }
+
+  STgStable *pStable = calloc(1, sizeof(STgStable) + sizeof(SSchema) * TSDB_MAX_COLUMNS);
+  if (pStable == NULL) {
+    taos_free_result(result);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  // field, type, length and note of each column, the note of tags is TAG
+  TAOS_ROW row;
+  while (pStable->numOfColumns + pStable->numOfTags < TSDB_MAX_COLUMNS && (row = taos_fetch_row(result)) != NULL) {
+    int *    length = taos_fetch_lengths(result);
+    SSchema *pSchema = &pStable->schema[pStable->numOfColumns + pStable->numOfTags];
+
+    int32_t nameLen = MIN(length[0], TSDB_COL_NAME_LEN - 1);
+    memcpy(pSchema->name, row[0], nameLen);
+    pSchema->name[nameLen] = 0;
+    pSchema->type = tgGetDataType(row[1], length[1]);
+    pSchema->bytes = (int16_t)(*(int32_t *)row[2]);
+
+    if (length[3] > 0) {
+      pStable->numOfTags++;
+    } else {
+      pStable->numOfColumns++;
+    }
+  }
+
+  taos_free_result(result);
+
+  size_t size = sizeof(STgStable) + sizeof(SSchema) * (pStable->numOfColumns + pStable->numOfTags);
+  *ppStable = taosCachePut(tgStableCache, stableId, pStable, size, TG_STABLE_KEEP_TIME);
+  free(pStable);
+
+  if (*ppStable == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  httpTrace("context:%p, fd:%d, ip:%s, stable:%s, columns:%d tags:%d, schema is cached", pContext, pContext->fd,
+            pContext->ipstr, stableId, (*ppStable)->numOfColumns, (*ppStable)->numOfTags);
+  return TSDB_CODE_SUCCESS;
+}
+
+// the database and the super table are created if they do not exist
+static STgStable *tgAcquireStable(HttpContext *pContext, HttpSqlCmd *stableCmd, char *stableId, int32_t *code) {
+  STgStable *pStable = taosCacheAcquireByName(tgStableCache, stableId);
+  if (pStable != NULL) {
+    return pStable;
+  }
+
+  *code = tgDescribeStable(pContext, stableId, &pStable);
+  if (*code == TSDB_CODE_MND_INVALID_DB || *code == TSDB_CODE_MND_DB_NOT_SELECTED) {
+    httpTrace("context:%p, fd:%d, ip:%s, describe %s failed, try create database", pContext, pContext->fd,
+              pContext->ipstr, stableId);
+    *code = tgExecSql(pContext, httpGetCmdsString(pContext, pContext->multiCmds->cmds[0].sql));
+    if (*code == TSDB_CODE_SUCCESS) {
+      *code = TSDB_CODE_MND_INVALID_TABLE_NAME;
+    }
+  }
+
+  if (*code == TSDB_CODE_MND_INVALID_TABLE_NAME) {
+    httpTrace("context:%p, fd:%d, ip:%s, describe %s failed, try create stable", pContext, pContext->fd,
+              pContext->ipstr, stableId);
+    *code = tgExecSql(pContext, httpGetCmdsString(pContext, stableCmd->sql));
+    if (*code == TSDB_CODE_SUCCESS) {
+      *code = tgDescribeStable(pContext, stableId, &pStable);
+    }
+  }
+
+  return (*code == TSDB_CODE_SUCCESS) ? pStable : NULL;
+}
+
+// the columns and tags are named by the fields and tags of metrics, prefixed by f_ and t_
+static char *tgGetItemName(SSchema *pSchema, char *prefix) {
+  return (strncasecmp(pSchema->name, prefix, 2) == 0) ? pSchema->name + 2 : NULL;
+}
+
+static SSchema *tgFindSchema(SSchema *pSchema, int32_t num, char *prefix, char *name) {
+  for (int32_t i = 0; i < num; ++i) {
+    char *itemName = tgGetItemName(&pSchema[i], prefix);
+    if (itemName != NULL && strcasecmp(itemName, name) == 0) {
+      return &pSchema[i];
+    }
+  }
+
+  return NULL;
+}
+
+// the boolean tags are stored as tinyint, and the null tags are compatible with all types
+static bool tgIsValueCompatible(uint8_t type, cJSON *value) {
+  if (value->type == cJSON_NULL) {
+    return true;
+  } else if (type == TSDB_DATA_TYPE_BINARY || type == TSDB_DATA_TYPE_NCHAR) {
+    return value->type == cJSON_String;
+  } else if (type == TSDB_DATA_TYPE_NULL) {
+    return false;
+  } else {
+    return value->type == cJSON_Number || value->type == cJSON_True || value->type == cJSON_False;
+  }
+}
+
+// every field and tag of the metric shall have a column or tag of compatible type in the super table
+static int32_t tgCheckMetric(STgStable *pStable, cJSON *metric) {
+  cJSON *fields = cJSON_GetObjectItem(metric, "fields");
+  int    fieldsSize = cJSON_GetArraySize(fields);
+  for (int i = 0; i < fieldsSize; ++i) {
+    cJSON *  field = cJSON_GetArrayItem(fields, i);
+    SSchema *pSchema = tgFindSchema(pStable->schema + 1, pStable->numOfColumns - 1, "f_", field->string);
+    if (pSchema == NULL || !tgIsValueCompatible(pSchema->type, field)) {
+      return TSDB_CODE_TSC_INVALID_VALUE;
+    }
+  }
+
+  cJSON *tags = cJSON_GetObjectItem(metric, "tags");
+  int    tagsSize = cJSON_GetArraySize(tags);
+  for (int i = 0; i < tagsSize; ++i) {
+    cJSON *  tag = cJSON_GetArrayItem(tags, i);
+    SSchema *pSchema = tgFindSchema(pStable->schema + pStable->numOfColumns, pStable->numOfTags, "t_", tag->string);
+    if (pSchema != NULL && !tgIsValueCompatible(pSchema->type, tag)) {
+      return TSDB_CODE_TSC_INVALID_VALUE;
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+static void tgSetNumberValue(char *data, uint8_t type, cJSON *value) {
+  int64_t ival = (value->type == cJSON_Number) ? value->valueint : (value->type == cJSON_True);
+  double  dval = (value->type == cJSON_Number) ? value->valuedouble : (value->type == cJSON_True);
+
+  switch (type) {
+    case TSDB_DATA_TYPE_BOOL:
+      *(int8_t *)data = (int8_t)(dval != 0);
+      break;
+    case TSDB_DATA_TYPE_TINYINT:
+      *(int8_t *)data = (int8_t)ival;
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      *(int16_t *)data = (int16_t)ival;
+      break;
+    case TSDB_DATA_TYPE_INT:
+      *(int32_t *)data = (int32_t)ival;
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      *(float *)data = (float)dval;
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      *(double *)data = dval;
+      break;
+    default:  // bigint and timestamp
+      *(int64_t *)data = ival;
+      break;
+  }
+}
+
+// the value of row i is the item named by name in objects[i], null if there is no such item
+static int32_t tgBindColumn(TAOS_COLUMN_BIND *bind, uint8_t type, cJSON **objects, int32_t numOfRows, char *name) {
+  bind->buffer_type = type;
+
+  if (type == TSDB_DATA_TYPE_BINARY || type == TSDB_DATA_TYPE_NCHAR) {
+    size_t maxLen = 1;
+    for (int32_t i = 0; i < numOfRows && name != NULL; ++i) {
+      cJSON *value = cJSON_GetObjectItem(objects[i], name);
+      if (value != NULL) maxLen = MAX(maxLen, strlen(value->valuestring));
+    }
+
+    bind->buffer_length = maxLen;
+    bind->length = calloc(numOfRows, sizeof(unsigned long));
+    if (bind->length == NULL) {
+      return TSDB_CODE_TSC_OUT_OF_MEMORY;
+    }
+  } else {
+    bind->buffer_length = tDataTypeDesc[type].nSize;
+  }
+
+  bind->buffer = calloc(numOfRows, bind->buffer_length);
+  bind->is_null = calloc(numOfRows, sizeof(char));
+  if (bind->buffer == NULL || bind->is_null == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    char * data = (char *)bind->buffer + bind->buffer_length * i;
+    cJSON *value = (name == NULL) ? NULL : cJSON_GetObjectItem(objects[i], name);
+    if (value == NULL) {
+      bind->is_null[i] = 1;
+    } else if (bind->length != NULL) {
+      bind->length[i] = strlen(value->valuestring);
+      memcpy(data, value->valuestring, bind->length[i]);
+    } else {
+      tgSetNumberValue(data, type, value);
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+// the binds of tags are followed by 8 bytes for the numeric value of each tag
+static TAOS_BIND *tgBindTags(STgStable *pStable, cJSON *metric, unsigned long *lengths, int *isNull) {
+  int32_t    numOfTags = pStable->numOfTags;
+  TAOS_BIND *binds = calloc(numOfTags, sizeof(TAOS_BIND) + sizeof(int64_t));
+  if (binds == NULL) {
+    return NULL;
+  }
+
+  cJSON *tags = cJSON_GetObjectItem(metric, "tags");
+  char * values = (char *)(binds + numOfTags);
+  for (int32_t i = 0; i < numOfTags; ++i) {
+    SSchema *  pSchema = &pStable->schema[pStable->numOfColumns + i];
+    TAOS_BIND *bind = &binds[i];
+    char *     name = tgGetItemName(pSchema, "t_");
+    cJSON *    tag = (name == NULL) ? NULL : cJSON_GetObjectItem(tags, name);
+
+    bind->buffer_type = pSchema->type;
+    bind->length = &lengths[i];
+    bind->is_null = &isNull[i];
+    isNull[i] = (tag == NULL || tag->type == cJSON_NULL);
+
+    if (isNull[i]) {
+      continue;
+    } else if (tag->type == cJSON_String) {
+      bind->buffer = tag->valuestring;
+      lengths[i] = strlen(tag->valuestring);
+    } else {
+      bind->buffer = values + sizeof(int64_t) * i;
+      tgSetNumberValue(bind->buffer, pSchema->type, tag);
+    }
+  }
+
+  return binds;
+}
+
+static int32_t tgBindTable(STgTable *pTable, cJSON **metrics, TAOS_TABLE_BIND *pBind, TAOS_TABLE_TAGS *pTags,
+                           unsigned long *tagLengths, int *tagNull) {
+  STgStable *pStable = pTable->pStable;
+  int32_t    numOfRows = pTable->numOfRows;
+
+  pBind->table_name = pTable->name;
+  pBind->num_of_rows = numOfRows;
+  pBind->columns = calloc(pStable->numOfColumns, sizeof(TAOS_COLUMN_BIND));
+
+  pTags->stable_name = pTable->stableId;
+  pTags->tags = tgBindTags(pStable, metrics[0], tagLengths, tagNull);
+
+  cJSON **fields = malloc(numOfRows * POINTER_BYTES);
+  if (pBind->columns == NULL || pTags->tags == NULL || fields == NULL) {
+    free(fields);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  int32_t code = tgBindColumn(pBind->columns, pStable->schema[0].type, metrics, numOfRows, "timestamp");
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    fields[i] = cJSON_GetObjectItem(metrics[i], "fields");
+  }
+
+  for (int32_t c = 1; c < pStable->numOfColumns && code == TSDB_CODE_SUCCESS; ++c) {
+    SSchema *pSchema = &pStable->schema[c];
+    code = tgBindColumn(pBind->columns + c, pSchema->type, fields, numOfRows, tgGetItemName(pSchema, "f_"));
+  }
+
+  free(fields);
+  return code;
+}
+
+static void tgFreeTableBind(STgTable *pTable, TAOS_TABLE_BIND *pBind, TAOS_TABLE_TAGS *pTags) {
+  for (int32_t c = 0; pBind->columns != NULL && c < pTable->pStable->numOfColumns; ++c) {
+    free(pBind->columns[c].buffer);
+    free(pBind->columns[c].length);
+    free(pBind->columns[c].is_null);
+  }
+
+  free(pBind->columns);
+  free(pTags->tags);
+}
+
+static int32_t tgInsertTables(HttpContext *pContext, TAOS_TABLE_BIND *binds, TAOS_TABLE_TAGS *tags, int32_t num) {
+  TAOS_RES *result = taos_insert_columns_auto(pContext->session->taos, binds, tags, num);
+  int32_t   code = taos_errno(result);
+  taos_free_result(result);
+  return code;
+}
+
+// the tables are inserted at once, and one by one if failed, to find the tables failed
+static void tgInsertMetrics(HttpContext *pContext, STgTable *tables, int32_t numOfTables, cJSON **rows) {
+  TAOS_TABLE_BIND *binds = calloc(numOfTables, sizeof(TAOS_TABLE_BIND));
+  TAOS_TABLE_TAGS *tags = calloc(numOfTables, sizeof(TAOS_TABLE_TAGS));
+  STgTable **      pTables = calloc(numOfTables, POINTER_BYTES);
+  unsigned long *  tagLengths = calloc(numOfTables * TSDB_MAX_TAGS, sizeof(unsigned long));
+  int *            tagNull = calloc(numOfTables * TSDB_MAX_TAGS, sizeof(int));
+  int32_t          num = 0;
+
+  for (int32_t t = 0; t < numOfTables; ++t) {
+    STgTable *pTable = &tables[t];
+    if (binds == NULL || tags == NULL || pTables == NULL || tagLengths == NULL || tagNull == NULL) {
+      pTable->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+    }
+
+    if (pTable->code != TSDB_CODE_SUCCESS || pTable->numOfRows == 0) {
+      continue;
+    }
+
+    pTable->code = tgBindTable(pTable, rows + pTable->firstRow, binds + num, tags + num, tagLengths + num * TSDB_MAX_TAGS,
+                               tagNull + num * TSDB_MAX_TAGS);
+    pTables[num++] = pTable;
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  for (int32_t i = 0; i < num; ++i) {
+    if (pTables[i]->code != TSDB_CODE_SUCCESS) code = pTables[i]->code;
+  }
+
+  if (num > 0 && code == TSDB_CODE_SUCCESS) {
+    code = tgInsertTables(pContext, binds, tags, num);
+    httpTrace("context:%p, fd:%d, ip:%s, user:%s, insert %d tables, code:%s", pContext, pContext->fd, pContext->ipstr,
+              pContext->user, num, tstrerror(code));
+  }
+
+  for (int32_t i = 0; i < num && code != TSDB_CODE_SUCCESS; ++i) {
+    if (pTables[i]->code == TSDB_CODE_SUCCESS) {
+      pTables[i]->code = (num == 1) ? code : tgInsertTables(pContext, binds + i, tags + i, 1);
+    }
+
+    if (pTables[i]->code != TSDB_CODE_SUCCESS) {
+      httpError("context:%p, fd:%d, ip:%s, user:%s, failed to insert table:%s, code:%s", pContext, pContext->fd,
+                pContext->ipstr, pContext->user, pTables[i]->name, tstrerror(pTables[i]->code));
     }
   }
 
+  for (int32_t i = 0; i < num; ++i) {
+    tgFreeTableBind(pTables[i], binds + i, tags + i);
+  }
+
+  free(binds);
+  free(tags);
+  free(pTables);
+  free(tagLengths);
+  free(tagNull);
+}
+
+static void tgBuildNativeInsertJson(HttpContext *pContext, int32_t numOfMetrics) {
+  HttpSqlCmd *cmds = pContext->multiCmds->cmds;
+
+  tgInitQueryJson(pContext);
+  for (int32_t m = 0; m < numOfMetrics; ++m) {
+    HttpSqlCmd *tableCmd = &cmds[2 + 2 * m];
+    tgStartQueryJson(pContext, tableCmd, NULL);
+    if (tableCmd->code == TSDB_CODE_SUCCESS) {
+      tgBuildSqlAffectRowsJson(pContext, tableCmd, 1);
+    }
+    tgStopQueryJson(pContext, tableCmd);
+  }
+  tgCleanQueryJson(pContext);
+}
+
+static void tgProcessNativeInsert(HttpContext *pContext) {
+  char * db = pContext->parser.path[TG_DB_URL_POS].pos;
+  cJSON *root = tgParseRequest(pContext, db);
+  if (root == NULL) {
+    return;
+  }
+
+  cJSON *   metrics = cJSON_GetObjectItem(root, "metrics");
+  int32_t   numOfMetrics = (metrics != NULL) ? cJSON_GetArraySize(metrics) : 1;
+  int32_t   numOfTables = 0;
+  STgTable *tables = calloc(numOfMetrics, sizeof(STgTable));
+  int32_t * tableIndex = calloc(numOfMetrics, sizeof(int32_t));  // -1 if the metric is rejected
+  cJSON **  rows = calloc(numOfMetrics, POINTER_BYTES);
+  SHashObj *pHash = taosHashInit(numOfMetrics, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false);
+
+  if (tables == NULL || tableIndex == NULL || rows == NULL || pHash == NULL) {
+    httpSendErrorResp(pContext, HTTP_NO_ENOUGH_MEMORY);
+    goto _end;
+  }
+
+  // the commands of metric m are the create stable command at 1 + 2 * m, and the insert command at 2 + 2 * m
+  HttpSqlCmd *cmds = pContext->multiCmds->cmds;
+  for (int32_t m = 0; m < numOfMetrics; ++m) {
+    HttpSqlCmd *tableCmd = &cmds[2 + 2 * m];
+    char *      tableName = httpGetCmdsString(pContext, tableCmd->table);
+    int32_t *   pIndex = taosHashGet(pHash, tableName, strlen(tableName));
+
+    if (pIndex == NULL) {
+      STgTable *pTable = &tables[numOfTables];
+      snprintf(pTable->name, sizeof(pTable->name), "%s.%s", db, tableName);
+      snprintf(pTable->stableId, sizeof(pTable->stableId), "%s.%s", db, httpGetCmdsString(pContext, tableCmd->stable));
+      pTable->pStable = tgAcquireStable(pContext, &cmds[1 + 2 * m], pTable->stableId, &pTable->code);
+
+      taosHashPut(pHash, tableName, strlen(tableName), &numOfTables, sizeof(int32_t));
+      pIndex = &numOfTables;
+    }
+
+    STgTable *pTable = &tables[*pIndex];
+    tableIndex[m] = *pIndex;
+    if (*pIndex == numOfTables) numOfTables++;
+
+    if (pTable->code == TSDB_CODE_SUCCESS) {
+      cJSON *metric = (metrics != NULL) ? cJSON_GetArrayItem(metrics, m) : root;
+      tableCmd->code = tgCheckMetric(pTable->pStable, metric);
+      if (tableCmd->code != TSDB_CODE_SUCCESS) {
+        tableIndex[m] = -1;
+        continue;
+      }
+    }
+
+    pTable->numOfRows++;
+  }
+
+  for (int32_t t = 1; t < numOfTables; ++t) {
+    tables[t].firstRow = tables[t - 1].firstRow + tables[t - 1].numOfRows;
+  }
+
+  for (int32_t t = 0; t < numOfTables; ++t) {
+    tables[t].numOfRows = 0;
+  }
+
+  for (int32_t m = 0; m < numOfMetrics; ++m) {
+    if (tableIndex[m] < 0) continue;
+    STgTable *pTable = &tables[tableIndex[m]];
+    rows[pTable->firstRow + pTable->numOfRows++] = (metrics != NULL) ? cJSON_GetArrayItem(metrics, m) : root;
+  }
+
+  tgInsertMetrics(pContext, tables, numOfTables, rows);
+
+  for (int32_t m = 0; m < numOfMetrics; ++m) {
+    if (tableIndex[m] >= 0) cmds[2 + 2 * m].code = tables[tableIndex[m]].code;
+  }
+
+  tgBuildNativeInsertJson(pContext, numOfMetrics);
+  httpCloseContextByApp(pContext);
+
+_end:
+  // the schema is reloaded after the failure, in case that the super table is altered
+  for (int32_t t = 0; t < numOfTables; ++t) {
+    taosCacheRelease(tgStableCache, (void **)&tables[t].pStable, tables[t].code != TSDB_CODE_SUCCESS);
+  }
+
+  taosHashCleanup(pHash);
+  free(tables);
+  free(tableIndex);
+  free(rows);
+  cJSON_Delete(root);
+}
+
+bool tgProcessQueryRequest(HttpContext *pContext, char *db) {
+  httpTrace("context:%p, fd:%d, ip:%s, process telegraf query msg", pContext, pContext->fd, pContext->ipstr);
+
+  // the request is parsed and inserted by a worker thread
+  if (tsTelegrafUseNativeInsert) {
+    pContext->reqType = HTTP_REQTYPE_NATIVE_INSERT;
+    pContext->encodeMethod = &tgQueryMethod;
+    pContext->nativeInsertFp = tgProcessNativeInsert;
+    return true;
+  }
+
+  cJSON *root = tgParseRequest(pContext, db);
+  if (root == NULL) {
+    return false;
+  }
+
   cJSON_Delete(root);
 
   pContext->reqType = HTTP_REQTYPE_MULTI_SQL;
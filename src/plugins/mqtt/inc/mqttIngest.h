@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_MQTT_INGEST_H
+#define TDENGINE_MQTT_INGEST_H
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "mqttPayload.h"
+
+typedef struct {
+  int64_t numOfMsgs;
+  int64_t numOfFailedMsgs;     // not matched with the template, or failed to be decoded or written
+  int64_t numOfRows;           // rows acknowledged by vnodes
+  int64_t numOfFailedSubmits;  // submit messages rejected by vnodes
+} SMqttIngestStatis;
+
+/*
+ * the messages are decoded into typed rows and written to the ingest object of client, which accumulates the rows
+ * into one submit message per vgroup, and sends it once batchRows rows are accumulated or lingerMs milliseconds later.
+ * The connection is owned by the caller, and mqttIngestMessage shall be called by one thread.
+ */
+void *  mqttOpenIngest(TAOS *taos, SMqttTopicTemplate *pTmpl, int32_t batchRows, int32_t lingerMs);
+int32_t mqttIngestMessage(void *handle, const char *topic, int32_t topicLen, const char *payload, int32_t payloadLen);
+int32_t mqttFlushIngest(void *handle);
+void    mqttCloseIngest(void *handle);
+void    mqttGetIngestStatis(void *handle, SMqttIngestStatis *pStatis);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -18,8 +18,68 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
-char  split(char str[], char delims[], char** p_p_cmd_part, int max);
-char* converJsonToSql(char* json, char* _dbname, char* _tablename);
+
+#include "os.h"
+#include "taos.h"
+#include "taosdef.h"
+#include "taosmsg.h"
+
+#define MQTT_MAX_TOPIC_LEVELS 16
+
+enum {
+  MQTT_LEVEL_LITERAL,
+  MQTT_LEVEL_ANY,     // +
+  MQTT_LEVEL_DB,      // {db}
+  MQTT_LEVEL_STABLE,  // {stable}
+  MQTT_LEVEL_TABLE,   // {table}
+};
+
+/*
+ * the template maps the levels of topic to the database, super table and table, like "+/{db}/{stable}/{table}".
+ * The levels are matched after the prefix, which is the path of broker address.
+ */
+typedef struct {
+  char    prefix[TSDB_TABLE_NAME_LEN];
+  int32_t prefixLen;
+  int32_t numOfLevels;
+  int8_t  types[MQTT_MAX_TOPIC_LEVELS];
+  char *  literals[MQTT_MAX_TOPIC_LEVELS];  // pointed to str, for literal levels
+  char    str[TSDB_TABLE_NAME_LEN];
+} SMqttTopicTemplate;
+
+typedef struct {
+  char db[TSDB_DB_NAME_LEN];
+  char stable[TSDB_TABLE_NAME_LEN];  // empty if the template has no {stable}
+  char table[TSDB_TABLE_NAME_LEN];
+} SMqttTopic;
+
+// the schema of the table, or the super table if the child tables are created automatically
+typedef struct {
+  int32_t numOfColumns;
+  int32_t numOfTags;
+  SSchema schema[];  // the columns are followed by the tags
+} SMqttSchema;
+
+// the rows decoded from one message, the values of each column are in a typed array
+typedef struct {
+  int32_t           numOfRows;
+  int32_t           numOfColumns;
+  TAOS_COLUMN_BIND *columns;
+  int32_t           numOfTags;
+  TAOS_BIND *       tags;        // NULL if not required
+  unsigned long *   tagLengths;
+  int *             tagNull;
+  int64_t *         tagValues;   // the numeric values of tags, the strings refer to the json
+  void *            pJson;
+} SMqttRows;
+
+int32_t mqttParseTopicTemplate(const char *path, const char *str, SMqttTopicTemplate *pTmpl);
+void    mqttGetTopicFilter(SMqttTopicTemplate *pTmpl, char *filter, int32_t size);
+bool    mqttMatchTopic(SMqttTopicTemplate *pTmpl, const char *topic, int32_t len, SMqttTopic *pTopic);
+
+int32_t mqttDecodePayload(SMqttSchema *pSchema, bool withTags, const char *payload, int32_t len, SMqttRows *pRows);
+void    mqttFreeRows(SMqttRows *pRows);
+
 #ifdef __cplusplus
 }
 #endif
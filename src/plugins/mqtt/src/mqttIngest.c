@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "taos.h"
+#include "taoserror.h"
+#include "tcache.h"
+#include "tutil.h"
+#include "mqttLog.h"
+#include "mqttIngest.h"
+
+#define MQTT_SCHEMA_KEEP_TIME 3600  // seconds to keep the schemas of tables and super tables
+#define MQTT_MAX_IN_FLIGHT    4     // submit messages not acknowledged for each vgroup
+
+typedef struct {
+  TAOS *             taos;
+  TAOS_INGEST *      ingest;
+  SCacheObj *        schemaCache;
+  SMqttTopicTemplate tmpl;
+  SMqttIngestStatis  statis;
+} SMqttIngest;
+
+static void mqttIngestCallback(TAOS_INGEST *ingest, void *param, int code, int affectedRows) {
+  SMqttIngest *pIngest = (SMqttIngest *)param;
+
+  if (code != TSDB_CODE_SUCCESS) {
+    atomic_add_fetch_64(&pIngest->statis.numOfFailedSubmits, 1);
+    mqttError("failed to submit the rows of mqtt messages, code:%s", tstrerror(code));
+  } else {
+    atomic_add_fetch_64(&pIngest->statis.numOfRows, affectedRows);
+  }
+}
+
+static uint8_t mqttGetDataType(char *name, int32_t len) {
+  for (uint8_t t = TSDB_DATA_TYPE_BOOL; t <= TSDB_DATA_TYPE_NCHAR; ++t) {
+    if (tDataTypeDesc[t].nameLen == len && strncasecmp(tDataTypeDesc[t].aName, name, len) == 0) {
+      return t;
+    }
+  }
+
+  return TSDB_DATA_TYPE_NULL;
+}
+
+// the schema is put into cache, and acquired by the caller
+static int32_t mqttDescribeTable(SMqttIngest *pIngest, char *name, SMqttSchema **ppSchema) {
+  char sql[TSDB_TABLE_ID_LEN + 16];
+  snprintf(sql, sizeof(sql), "describe %s", name);
+
+  TAOS_RES *result = taos_query(pIngest->taos, sql);
+  int32_t   code = taos_errno(result);
+  if (code != TSDB_CODE_SUCCESS) {
+    taos_free_result(result);
+    return code;
+  }
+
+  SMqttSchema *pSchema = calloc(1, sizeof(SMqttSchema) + sizeof(SSchema) * TSDB_MAX_COLUMNS);
+  if (pSchema == NULL) {
+    taos_free_result(result);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  // field, type, length and note of each column, the note of tags is TAG
+  TAOS_ROW row;
+  while (pSchema->numOfColumns + pSchema->numOfTags < TSDB_MAX_COLUMNS && (row = taos_fetch_row(result)) != NULL) {
+    int *    length = taos_fetch_lengths(result);
+    SSchema *pColumn = &pSchema->schema[pSchema->numOfColumns + pSchema->numOfTags];
+
+    int32_t nameLen = MIN(length[0], TSDB_COL_NAME_LEN - 1);
+    memcpy(pColumn->name, row[0], nameLen);
+    pColumn->name[nameLen] = 0;
+    pColumn->type = mqttGetDataType(row[1], length[1]);
+    pColumn->bytes = (int16_t)(*(int32_t *)row[2]);
+
+    if (length[3] > 0) {
+      pSchema->numOfTags++;
+    } else {
+      pSchema->numOfColumns++;
+    }
+  }
+
+  taos_free_result(result);
+
+  size_t size = sizeof(SMqttSchema) + sizeof(SSchema) * (pSchema->numOfColumns + pSchema->numOfTags);
+  *ppSchema = taosCachePut(pIngest->schemaCache, name, pSchema, size, MQTT_SCHEMA_KEEP_TIME);
+  free(pSchema);
+
+  if (*ppSchema == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  mqttTrace("table:%s, columns:%d tags:%d, schema is cached", name, (*ppSchema)->numOfColumns, (*ppSchema)->numOfTags);
+  return TSDB_CODE_SUCCESS;
+}
+
+void *mqttOpenIngest(TAOS *taos, SMqttTopicTemplate *pTmpl, int32_t batchRows, int32_t lingerMs) {
+  SMqttIngest *pIngest = calloc(1, sizeof(SMqttIngest));
+  if (pIngest == NULL) {
+    return NULL;
+  }
+
+  pIngest->taos = taos;
+  pIngest->tmpl = *pTmpl;
+
+  // the literals point to the string of template
+  for (int32_t i = 0; i < pTmpl->numOfLevels; ++i) {
+    if (pTmpl->literals[i] != NULL) {
+      pIngest->tmpl.literals[i] = pIngest->tmpl.str + (pTmpl->literals[i] - pTmpl->str);
+    }
+  }
+
+  pIngest->schemaCache = taosCacheInit(5);
+  pIngest->ingest = taos_ingest_open(taos, batchRows, lingerMs, MQTT_MAX_IN_FLIGHT, mqttIngestCallback, pIngest);
+  if (pIngest->schemaCache == NULL || pIngest->ingest == NULL) {
+    mqttError("failed to open ingest object, reason:%s", tstrerror(terrno));
+    mqttCloseIngest(pIngest);
+    return NULL;
+  }
+
+  mqttPrint("mqtt ingest is opened, template:%s%s batch rows:%d linger:%dms", pTmpl->prefix, pTmpl->str, batchRows,
+            lingerMs);
+  return pIngest;
+}
+
+int32_t mqttIngestMessage(void *handle, const char *topic, int32_t topicLen, const char *payload, int32_t payloadLen) {
+  SMqttIngest *pIngest = (SMqttIngest *)handle;
+  SMqttTopic   t;
+
+  pIngest->statis.numOfMsgs++;
+  if (!mqttMatchTopic(&pIngest->tmpl, topic, topicLen, &t)) {
+    mqttError("topic:%.*s, not matched with template:%s%s", topicLen, topic, pIngest->tmpl.prefix, pIngest->tmpl.str);
+    pIngest->statis.numOfFailedMsgs++;
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  // the schema of super table is used if the table is created automatically
+  bool autoCreate = (t.stable[0] != 0);
+  char tableId[TSDB_TABLE_ID_LEN];
+  char stableId[TSDB_TABLE_ID_LEN];
+  snprintf(tableId, sizeof(tableId), "%s.%s", t.db, t.table);
+  snprintf(stableId, sizeof(stableId), "%s.%s", t.db, t.stable);
+
+  char *       schemaId = autoCreate ? stableId : tableId;
+  int32_t      code = TSDB_CODE_SUCCESS;
+  SMqttSchema *pSchema = taosCacheAcquireByName(pIngest->schemaCache, schemaId);
+  if (pSchema == NULL) {
+    code = mqttDescribeTable(pIngest, schemaId, &pSchema);
+  }
+
+  if (code == TSDB_CODE_SUCCESS) {
+    SMqttRows rows;
+    bool      changed = false;
+    code = mqttDecodePayload(pSchema, autoCreate, payload, payloadLen, &rows);
+    if (code == TSDB_CODE_SUCCESS) {
+      TAOS_TABLE_BIND bind = {.table_name = tableId, .num_of_rows = rows.numOfRows, .columns = rows.columns};
+      TAOS_TABLE_TAGS tags = {.stable_name = stableId, .tags = rows.tags};
+      code = taos_ingest_write_auto(pIngest->ingest, &bind, autoCreate ? &tags : NULL, 1);
+
+      // the schema may be changed, it is described again for the next message
+      changed = (code != TSDB_CODE_SUCCESS);
+    }
+
+    mqttFreeRows(&rows);
+    taosCacheRelease(pIngest->schemaCache, (void **)&pSchema, changed);
+  }
+
+  if (code != TSDB_CODE_SUCCESS) {
+    mqttError("topic:%.*s, failed to ingest the message, code:%s", topicLen, topic, tstrerror(code));
+    pIngest->statis.numOfFailedMsgs++;
+  }
+
+  return code;
+}
+
+int32_t mqttFlushIngest(void *handle) {
+  SMqttIngest *pIngest = (SMqttIngest *)handle;
+  return taos_ingest_flush(pIngest->ingest);
+}
+
+void mqttCloseIngest(void *handle) {
+  SMqttIngest *pIngest = (SMqttIngest *)handle;
+  if (pIngest == NULL) return;
+
+  if (pIngest->ingest != NULL) {
+    taos_ingest_close(pIngest->ingest);
+  }
+
+  if (pIngest->schemaCache != NULL) {
+    taosCacheCleanup(pIngest->schemaCache);
+  }
+
+  mqttPrint("mqtt ingest is closed, messages:%" PRId64 " failed:%" PRId64 " rows:%" PRId64, pIngest->statis.numOfMsgs,
+            pIngest->statis.numOfFailedMsgs, pIngest->statis.numOfRows);
+  free(pIngest);
+}
+
+void mqttGetIngestStatis(void *handle, SMqttIngestStatis *pStatis) {
+  SMqttIngest *pIngest = (SMqttIngest *)handle;
+
+  pStatis->numOfMsgs = pIngest->statis.numOfMsgs;
+  pStatis->numOfFailedMsgs = pIngest->statis.numOfFailedMsgs;
+  pStatis->numOfRows = atomic_load_64(&pIngest->statis.numOfRows);
+  pStatis->numOfFailedSubmits = atomic_load_64(&pIngest->statis.numOfFailedSubmits);
+}
@@ -18,48 +18,357 @@
 #include "cJSON.h"
 #include "string.h"
 #include "taos.h"
+#include "taoserror.h"
+#include "ttime.h"
+#include "tutil.h"
 #include "mqttLog.h"
 #include "os.h"
-char split(char str[], char delims[], char** p_p_cmd_part, int max) {
-  char*  token = strtok(str, delims);
-  char   part_index = 0;
-  char** tmp_part = p_p_cmd_part;
-  while (token) {
-    *tmp_part++ = token;
-    token = strtok(NULL, delims);
-    part_index++;
-    if (part_index >= max) break;
-  }
-  return part_index;
+
+int32_t mqttParseTopicTemplate(const char *path, const char *str, SMqttTopicTemplate *pTmpl) {
+  memset(pTmpl, 0, sizeof(SMqttTopicTemplate));
+
+  // the topics start with "/path/", the same as the former versions
+  if (path == NULL || path[0] == 0) {
+    strcpy(pTmpl->prefix, "/");
+  } else {
+    snprintf(pTmpl->prefix, sizeof(pTmpl->prefix), "/%s/", path);
+  }
+  pTmpl->prefixLen = (int32_t)strlen(pTmpl->prefix);
+
+  tstrncpy(pTmpl->str, str, sizeof(pTmpl->str));
+  char *p = pTmpl->str;
+  while (*p == '/') p++;
+
+  int32_t numOfVars[MQTT_LEVEL_TABLE + 1] = {0};
+  while (*p != 0) {
+    if (pTmpl->numOfLevels >= MQTT_MAX_TOPIC_LEVELS) {
+      return -1;
+    }
+
+    char *end = strchr(p, '/');
+    if (end != NULL) *end = 0;
+
+    int8_t type = MQTT_LEVEL_LITERAL;
+    if (strcmp(p, "+") == 0) {
+      type = MQTT_LEVEL_ANY;
+    } else if (strcmp(p, "{db}") == 0) {
+      type = MQTT_LEVEL_DB;
+    } else if (strcmp(p, "{stable}") == 0) {
+      type = MQTT_LEVEL_STABLE;
+    } else if (strcmp(p, "{table}") == 0) {
+      type = MQTT_LEVEL_TABLE;
+    } else if (*p == 0 || strpbrk(p, "{}+#") != NULL) {
+      return -1;
+    }
+
+    numOfVars[type]++;
+    pTmpl->literals[pTmpl->numOfLevels] = (type == MQTT_LEVEL_LITERAL) ? p : NULL;
+    pTmpl->types[pTmpl->numOfLevels++] = type;
+
+    if (end == NULL) break;
+    p = end + 1;
+  }
+
+  if (numOfVars[MQTT_LEVEL_DB] != 1 || numOfVars[MQTT_LEVEL_TABLE] != 1 || numOfVars[MQTT_LEVEL_STABLE] > 1) {
+    return -1;
+  }
+
+  return 0;
 }
 
-char* converJsonToSql(char* json, char* _dbname, char* _tablename) {
-  cJSON* jPlayload = cJSON_Parse(json);
-  char   _names[102400] = {0};
-  char   _values[102400] = {0};
-  int    i = 0;
-  int    count = cJSON_GetArraySize(jPlayload);
-  for (; i < count; i++)  
-  {
-    cJSON* item = cJSON_GetArrayItem(jPlayload, i);
-    if (cJSON_Object == item->type) {
-      mqttPrint("The item '%s' is not supported", item->string);
-    } else {
-      strcat(_names, item->string);
-      if (i < count - 1) {
-        strcat(_names, ",");
-      }
-      char* __value_json = cJSON_Print(item);
-      strcat(_values, __value_json);
-      free(__value_json);
-      if (i < count - 1) {
-        strcat(_values, ",");
+// the filter to subscribe, the levels after the template are allowed by #
+void mqttGetTopicFilter(SMqttTopicTemplate *pTmpl, char *filter, int32_t size) {
+  int32_t len = snprintf(filter, size, "%s", pTmpl->prefix);
+  for (int32_t i = 0; i < pTmpl->numOfLevels && len < size; ++i) {
+    char *level = (pTmpl->types[i] == MQTT_LEVEL_LITERAL) ? pTmpl->literals[i] : "+";
+    len += snprintf(filter + len, size - len, "%s/", level);
+  }
+
+  if (len < size) {
+    snprintf(filter + len, size - len, "#");
+  }
+}
+
+// the topic of mqtt message is not null-terminated
+bool mqttMatchTopic(SMqttTopicTemplate *pTmpl, const char *topic, int32_t len, SMqttTopic *pTopic) {
+  if (len < pTmpl->prefixLen || strncmp(topic, pTmpl->prefix, pTmpl->prefixLen) != 0) {
+    return false;
+  }
+
+  memset(pTopic, 0, sizeof(SMqttTopic));
+
+  const char *p = topic + pTmpl->prefixLen;
+  const char *end = topic + len;
+  for (int32_t i = 0; i < pTmpl->numOfLevels; ++i) {
+    if (p > end) {
+      return false;
+    }
+
+    const char *q = memchr(p, '/', end - p);
+    if (q == NULL) q = end;
+
+    int32_t levelLen = (int32_t)(q - p);
+    if (levelLen == 0) {
+      return false;
+    }
+
+    char *  dst = NULL;
+    int32_t dstSize = 0;
+    switch (pTmpl->types[i]) {
+      case MQTT_LEVEL_LITERAL:
+        if (strlen(pTmpl->literals[i]) != levelLen || strncmp(pTmpl->literals[i], p, levelLen) != 0) {
+          return false;
+        }
+        break;
+      case MQTT_LEVEL_DB:
+        dst = pTopic->db;
+        dstSize = sizeof(pTopic->db);
+        break;
+      case MQTT_LEVEL_STABLE:
+        dst = pTopic->stable;
+        dstSize = sizeof(pTopic->stable);
+        break;
+      case MQTT_LEVEL_TABLE:
+        dst = pTopic->table;
+        dstSize = sizeof(pTopic->table);
+        break;
+      default:
+        break;
+    }
+
+    if (dst != NULL) {
+      if (levelLen >= dstSize) {
+        return false;
       }
+
+      memcpy(dst, p, levelLen);
+      dst[levelLen] = 0;
+    }
+
+    p = q + 1;
+  }
+
+  return true;
+}
+
+// the boolean values are accepted by the numeric columns, and null is accepted by all columns
+static bool mqttIsValueCompatible(uint8_t type, cJSON *value) {
+  if (cJSON_IsNull(value)) {
+    return true;
+  } else if (type == TSDB_DATA_TYPE_BINARY || type == TSDB_DATA_TYPE_NCHAR) {
+    return cJSON_IsString(value);
+  } else {
+    return cJSON_IsNumber(value) || cJSON_IsBool(value);
+  }
+}
+
+static void mqttSetNumberValue(char *data, uint8_t type, cJSON *value) {
+  int64_t ival = cJSON_IsNumber(value) ? value->valueint : cJSON_IsTrue(value);
+  double  dval = cJSON_IsNumber(value) ? value->valuedouble : cJSON_IsTrue(value);
+
+  switch (type) {
+    case TSDB_DATA_TYPE_BOOL:
+      *(int8_t *)data = (int8_t)(dval != 0);
+      break;
+    case TSDB_DATA_TYPE_TINYINT:
+      *(int8_t *)data = (int8_t)ival;
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      *(int16_t *)data = (int16_t)ival;
+      break;
+    case TSDB_DATA_TYPE_INT:
+      *(int32_t *)data = (int32_t)ival;
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      *(float *)data = (float)dval;
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      *(double *)data = dval;
+      break;
+    default:  // bigint and timestamp
+      *(int64_t *)data = ival;
+      break;
+  }
+}
+
+/*
+ * the value of row i is the item of objects[i] named by the column, null if there is no such item. The rows without
+ * timestamp are stamped with the current time in milliseconds.
+ */
+static int32_t mqttBindColumn(TAOS_COLUMN_BIND *bind, SSchema *pSchema, cJSON **objects, int32_t numOfRows,
+                              bool primaryKey) {
+  uint8_t type = pSchema->type;
+  size_t  maxLen = 1;
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    cJSON *value = cJSON_GetObjectItem(objects[i], pSchema->name);
+    if (value == NULL) {
+      continue;
+    }
+
+    if (!mqttIsValueCompatible(type, value) || (primaryKey && !cJSON_IsNumber(value))) {
+      mqttTrace("column:%s, the value of row %d is not compatible with type %d", pSchema->name, i, type);
+      return TSDB_CODE_TSC_INVALID_VALUE;
+    }
+
+    if (cJSON_IsString(value)) {
+      maxLen = MAX(maxLen, strlen(value->valuestring));
+    }
+  }
+
+  bind->buffer_type = type;
+  if (type == TSDB_DATA_TYPE_BINARY || type == TSDB_DATA_TYPE_NCHAR) {
+    bind->buffer_length = maxLen;
+    bind->length = calloc(numOfRows, sizeof(unsigned long));
+    if (bind->length == NULL) {
+      return TSDB_CODE_TSC_OUT_OF_MEMORY;
+    }
+  } else {
+    bind->buffer_length = tDataTypeDesc[type].nSize;
+  }
+
+  bind->buffer = calloc(numOfRows, bind->buffer_length);
+  bind->is_null = calloc(numOfRows, sizeof(char));
+  if (bind->buffer == NULL || bind->is_null == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  int64_t now = primaryKey ? taosGetTimestampMs() : 0;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    char * data = (char *)bind->buffer + bind->buffer_length * i;
+    cJSON *value = cJSON_GetObjectItem(objects[i], pSchema->name);
+    if (value == NULL && primaryKey) {
+      *(int64_t *)data = now;
+    } else if (value == NULL || cJSON_IsNull(value)) {
+      bind->is_null[i] = 1;
+    } else if (bind->length != NULL) {
+      bind->length[i] = strlen(value->valuestring);
+      memcpy(data, value->valuestring, bind->length[i]);
+    } else {
+      mqttSetNumberValue(data, type, value);
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+// the tags of the table created automatically are the items of the first row
+static int32_t mqttBindTags(SMqttRows *pRows, SSchema *pSchema, int32_t numOfTags, cJSON *object) {
+  pRows->numOfTags = numOfTags;
+  pRows->tags = calloc(numOfTags, sizeof(TAOS_BIND));
+  pRows->tagLengths = calloc(numOfTags, sizeof(unsigned long));
+  pRows->tagNull = calloc(numOfTags, sizeof(int));
+  pRows->tagValues = calloc(numOfTags, sizeof(int64_t));
+  if (pRows->tags == NULL || pRows->tagLengths == NULL || pRows->tagNull == NULL || pRows->tagValues == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = 0; i < numOfTags; ++i) {
+    TAOS_BIND *bind = &pRows->tags[i];
+    cJSON *    tag = cJSON_GetObjectItem(object, pSchema[i].name);
+
+    if (tag != NULL && !mqttIsValueCompatible(pSchema[i].type, tag)) {
+      mqttTrace("tag:%s, the value is not compatible with type %d", pSchema[i].name, pSchema[i].type);
+      return TSDB_CODE_TSC_INVALID_VALUE;
+    }
+
+    bind->buffer_type = pSchema[i].type;
+    bind->length = &pRows->tagLengths[i];
+    bind->is_null = &pRows->tagNull[i];
+    pRows->tagNull[i] = (tag == NULL || cJSON_IsNull(tag));
+
+    if (pRows->tagNull[i]) {
+      continue;
+    } else if (cJSON_IsString(tag)) {
+      bind->buffer = tag->valuestring;
+      pRows->tagLengths[i] = strlen(tag->valuestring);
+    } else {
+      bind->buffer = &pRows->tagValues[i];
+      mqttSetNumberValue(bind->buffer, pSchema[i].type, tag);
+    }
+  }
+
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * the payload is a json object of one row, or an array of rows, like {"ts":1600000000000, "temperature":21.5}. The
+ * items are bound to the columns of the same names, and the items not in the schema are ignored. The rows shall be
+ * freed by mqttFreeRows, even if failed.
+ */
+int32_t mqttDecodePayload(SMqttSchema *pSchema, bool withTags, const char *payload, int32_t len, SMqttRows *pRows) {
+  memset(pRows, 0, sizeof(SMqttRows));
+
+  // the payload of mqtt message is not null-terminated
+  char *json = malloc(len + 1);
+  if (json == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  memcpy(json, payload, len);
+  json[len] = 0;
+
+  cJSON *root = cJSON_Parse(json);
+  free(json);
+  if (root == NULL) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  pRows->pJson = root;
+
+  int32_t numOfRows = cJSON_IsArray(root) ? cJSON_GetArraySize(root) : 1;
+  if (numOfRows <= 0 || numOfRows > INT16_MAX) {
+    return TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  cJSON **objects = malloc(numOfRows * POINTER_BYTES);
+  pRows->columns = calloc(pSchema->numOfColumns, sizeof(TAOS_COLUMN_BIND));
+  if (objects == NULL || pRows->columns == NULL) {
+    free(objects);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  if (cJSON_IsArray(root)) {
+    int32_t i = 0;
+    for (cJSON *item = root->child; item != NULL; item = item->next) {
+      objects[i++] = item;
+      if (!cJSON_IsObject(item)) code = TSDB_CODE_TSC_INVALID_VALUE;
     }
+  } else {
+    objects[0] = root;
+    if (!cJSON_IsObject(root)) code = TSDB_CODE_TSC_INVALID_VALUE;
+  }
+
+  pRows->numOfRows = numOfRows;
+  for (int32_t c = 0; c < pSchema->numOfColumns && code == TSDB_CODE_SUCCESS; ++c) {
+    code = mqttBindColumn(pRows->columns + c, &pSchema->schema[c], objects, numOfRows, c == 0);
+    pRows->numOfColumns = c + 1;
   }
-  cJSON_free(jPlayload);
-  int   sqllen = strlen(_names) + strlen(_values) + strlen(_dbname) + strlen(_tablename) + 1024;
-  char* _sql = calloc(1, sqllen);
-  sprintf(_sql, "INSERT INTO %s.%s (%s) VALUES(%s);", _dbname, _tablename, _names, _values);
-  return _sql;
-}
\ No newline at end of file
+
+  if (code == TSDB_CODE_SUCCESS && withTags) {
+    code = mqttBindTags(pRows, pSchema->schema + pSchema->numOfColumns, pSchema->numOfTags, objects[0]);
+  }
+
+  free(objects);
+  return code;
+}
+
+void mqttFreeRows(SMqttRows *pRows) {
+  for (int32_t c = 0; pRows->columns != NULL && c < pRows->numOfColumns; ++c) {
+    free(pRows->columns[c].buffer);
+    free(pRows->columns[c].length);
+    free(pRows->columns[c].is_null);
+  }
+
+  tfree(pRows->columns);
+  tfree(pRows->tags);
+  tfree(pRows->tagLengths);
+  tfree(pRows->tagNull);
+  tfree(pRows->tagValues);
+
+  if (pRows->pJson != NULL) {
+    cJSON_Delete(pRows->pJson);
+    pRows->pJson = NULL;
+  }
+}
@@ -18,6 +18,7 @@
 #include "cJSON.h"
 #include "mqtt.h"
 #include "mqttInit.h"
+#include "mqttIngest.h"
 #include "mqttLog.h"
 #include "mqttPayload.h"
 #include "os.h"
@@ -30,21 +31,26 @@
 #include "tsocket.h"
 #include "ttimer.h"
 #include "mqttSystem.h"
+
+#define MQTT_RECV_BUF_SIZE (64 * 1024)  // the largest message received, the rows of gateways are published in batch
+
 struct mqtt_client       mqttClient = {0};
 pthread_t                clientDaemonThread = {0};
 void*                    mqttConnect=NULL;
+void*                    mqttIngest = NULL;
+SMqttTopicTemplate       mqttTemplate = {0};
 struct reconnect_state_t recntStatus = {0};
 char*                    topicPath=NULL;
 int                      mttIsRuning = 1;
+static uint8_t           mqttSendBuf[2048];
+static uint8_t           mqttRecvBuf[MQTT_RECV_BUF_SIZE];
 
 int32_t mqttInitSystem() {
   int   rc = 0;
-  uint8_t sendbuf[2048];
-  uint8_t recvbuf[1024];
-  recntStatus.sendbuf = sendbuf;
-  recntStatus.sendbufsz = sizeof(sendbuf);
-  recntStatus.recvbuf = recvbuf;
-  recntStatus.recvbufsz = sizeof(recvbuf);
+  recntStatus.sendbuf = mqttSendBuf;
+  recntStatus.sendbufsz = sizeof(mqttSendBuf);
+  recntStatus.recvbuf = mqttRecvBuf;
+  recntStatus.recvbufsz = sizeof(mqttRecvBuf);
   char* url = tsMqttBrokerAddress;
   recntStatus.user_name = strstr(url, "@") != NULL ? strbetween(url, "//", ":") : NULL;
   recntStatus.password = strstr(url, "@") != NULL ? strbetween(strstr(url, recntStatus.user_name), ":", "@") : NULL;
@@ -72,10 +78,15 @@ int32_t mqttInitSystem() {
 
   topicPath = strbetween(strstr(url, strstr(_begin_hostname, ":") != NULL ? recntStatus.port : recntStatus.hostname),
                          "/", "/");
-  char* _topic = "+/+/+/";
-  int   _tpsize = strlen(topicPath) + strlen(_topic) + 1;
+  if (mqttParseTopicTemplate(topicPath, tsMqttTopicTemplate, &mqttTemplate) != 0) {
+    mqttError("invalid mqttTopicTemplate:%s, the levels shall be literals, + or one of {db}, {stable} and {table}, "
+              "with {db} and {table}", tsMqttTopicTemplate);
+    return -1;
+  }
+
+  int _tpsize = TSDB_TABLE_NAME_LEN * 2;
   recntStatus.topic = calloc(1, _tpsize);
-  sprintf(recntStatus.topic, "/%s/%s", topicPath, _topic);
+  mqttGetTopicFilter(&mqttTemplate, recntStatus.topic, _tpsize);
   recntStatus.client_id = strlen(tsMqttBrokerClientId) < 3 ? tsMqttBrokerClientId : "taos_mqtt";
   mqttConnect = NULL;
   return rc;
@@ -107,6 +118,14 @@ void mqttStopSystem() {
   mttIsRuning = 0;
   usleep(300000U);
   mqttCleanup(EXIT_SUCCESS, mqttClient.socketfd, &clientDaemonThread);
+
+  // the rows accumulated are submitted before the connection is closed
+  mqttCloseIngest(mqttIngest);
+  mqttIngest = NULL;
+  if (mqttConnect != NULL) {
+    taos_close(mqttConnect);
+    mqttConnect = NULL;
+  }
   mqttPrint("mqtt is stoped");
 }
 
@@ -121,43 +140,31 @@ void mqttCleanUpSystem() {
   mqttPrint("mqtt is cleaned up");
 }
 
+// the messages are ingested in the refresher thread, the client is blocked when vnodes can not keep up
 void mqtt_PublishCallback(void** unused, struct mqtt_response_publish* published) {
-  /* note that published->topic_name is NOT null-terminated (here we'll change it to a c-string) */
-  char* topic_name = (char*)malloc(published->topic_name_size + 1);
-  memcpy(topic_name, published->topic_name, published->topic_name_size);
-  topic_name[published->topic_name_size] = '\0';
-  mqttPrint("received publish('%s'): %s", topic_name, (const char*)published->application_message);
-  char _token[128] = {0};
-  char _dbname[128] = {0};
-  char _tablename[128] = {0};
-  if (mqttConnect == NULL) {
-    mqttPrint("connect database");
-    taos_connect_a(NULL, "_root", tsInternalPass, "", 0, mqttInitConnCb, &mqttClient, &mqttConnect);
-  }
-  if (topic_name[1]=='/' &&  strncmp((char*)&topic_name[1], topicPath, strlen(topicPath)) == 0) {
-    char* p_p_cmd_part[5] = {0};
-    char  copystr[1024] = {0};
-    strncpy(copystr, topic_name, MIN(1024, published->topic_name_size));
-    char part_index = split(copystr, "/", p_p_cmd_part, 10);
-    if (part_index < 4) {
-      mqttError("The topic %s is't format '/path/token/dbname/table name/'. for expmle: '/taos/token/db/t'", topic_name);
-    } else {
-      strncpy(_token, p_p_cmd_part[1], 127);
-      strncpy(_dbname, p_p_cmd_part[2], 127);
-      strncpy(_tablename, p_p_cmd_part[3], 127);
-      mqttPrint("part count=%d,access token:%s,database name:%s, table name:%s", part_index, _token, _dbname,
-                _tablename);
-
-      if (mqttConnect != NULL) {
-        char* _sql = converJsonToSql((char*)published->application_message, _dbname, _tablename);
-        mqttPrint("query:%s", _sql);
-        taos_query_a(mqttConnect, _sql, mqttQueryInsertCallback, &mqttClient);
-        mqttPrint("free sql:%s", _sql);
-        free(_sql);
+  const char* topic = (const char*)published->topic_name;
+  int32_t     topicLen = published->topic_name_size;
+
+  mqttTrace("received publish('%.*s'), size:%d", topicLen, topic, (int32_t)published->application_message_size);
+
+  if (mqttIngest == NULL) {
+    if (mqttConnect == NULL) {
+      mqttPrint("connect database");
+      mqttConnect = taos_connect(NULL, "_root", tsInternalPass, "", 0);
+      if (mqttConnect == NULL) {
+        mqttError("failed to connect to database, reason:%s", tstrerror(terrno));
+        return;
       }
     }
+
+    mqttIngest = mqttOpenIngest(mqttConnect, &mqttTemplate, tsMqttBatchRows, tsMqttLingerMs);
+    if (mqttIngest == NULL) {
+      return;
+    }
   }
-  free(topic_name);
+
+  mqttIngestMessage(mqttIngest, topic, topicLen, (const char*)published->application_message,
+                    (int32_t)published->application_message_size);
 }
 
 void* mqttClientRefresher(void* client) {
@@ -175,26 +182,6 @@ void mqttCleanup(int status, int sockfd, pthread_t* client_daemon) {
   if (client_daemon != NULL) pthread_cancel(*client_daemon);
 }
 
-void mqttInitConnCb(void* param, TAOS_RES* result, int32_t code) {
-  if (code < 0) {
-    mqttError("mqtt:%d, connect to database failed, reason:%s", code, tstrerror(code));
-    taos_close(mqttConnect);
-    mqttConnect = NULL;
-    return;
-  }
-  mqttTrace("mqtt:%d, connect to database success, reason:%s", code, tstrerror(code));
-}
-
-void mqttQueryInsertCallback(void* param, TAOS_RES* result, int32_t code) {
-  if (code < 0) {
-    mqttError("mqtt:%d, save data failed, code:%s", code, tstrerror(code));
-  } else if (code == 0) {
-    mqttError("mqtt:%d, save data failed, affect rows:%d", code, code);
-  } else {
-    mqttPrint("mqtt:%d, save data   success, code:%s", code, tstrerror(code));
-  }
-}
-
 void mqttReconnectClient(struct mqtt_client* client, void** reconnect_state_vptr) {
   mqttPrint("reconnect client");
   struct reconnect_state_t* reconnect_state = *((struct reconnect_state_t**)reconnect_state_vptr);
@@ -19,6 +19,7 @@
 
 #include "hash.h"
 #include "qfill.h"
+#include "qgrouphash.h"
 #include "qresultBuf.h"
 #include "qsqlparser.h"
 #include "qtsbuf.h"
@@ -70,7 +71,7 @@ typedef struct SResultRec {
 
 typedef struct SWindowResInfo {
   SWindowResult* pResult;    // result list
-  SHashObj*      hashList;   // hash list for quick access
+  SGroupHashObj* hashList;   // hash list for quick access
   int16_t        type;       // data type for hash key
   int32_t        capacity;   // max capacity
   int32_t        curIndex;   // current start active index
@@ -139,6 +140,7 @@ typedef struct SQuery {
   int64_t          intervalTime;
   int64_t          slidingTime;      // sliding time for sliding window query
   char             slidingTimeUnit;  // interval data type, used for daytime revise
+  int8_t           encodeResult;     // result may be encoded by column, since the client decodes it
   int16_t          precision;
   int16_t          numOfOutput;
   int16_t          fillType;
@@ -176,6 +178,7 @@ typedef struct SQueryRuntimeEnv {
   void*                pQueryHandle;
   void*                pSecQueryHandle;  // another thread for
   SDiskbasedResultBuf* pResultBuf;       // query result buffer based on blocked-wised disk file
+  int32_t              activePageId;     // pinned page of the active window, referenced by the output buffer of pCtx
   bool                 topBotQuery;      // false;
 } SQueryRuntimeEnv;
 
@@ -71,6 +71,11 @@ typedef struct tFilePage {
   char     data[];
 } tFilePage;
 
+typedef struct SSortedRun {
+  tFilePage **pPages;
+  int32_t     numOfPages;
+} SSortedRun;
+
 typedef struct tFilePagesItem {
   struct tFilePagesItem *pNext;
   tFilePage              item;
@@ -151,6 +156,14 @@ int16_t tExtMemBufferPut(tExtMemBuffer *pMemBuffer, void *data, int32_t numOfRow
  */
 int32_t tExtMemBufferFlush(tExtMemBuffer *pMemBuffer);
 
+/**
+ * merge the last flush-out data into the previous one. The flush-out data are consecutive in file, so if the last
+ * flush continues the order of the previous one, both of them can be loaded as one sorted run.
+ *
+ * @param pMemBuffer
+ */
+void tExtMemBufferMergeLastFlushout(tExtMemBuffer *pMemBuffer);
+
 /**
  *
  * remove all data that has been put into buffer, including in buffer or
@@ -238,6 +251,23 @@ int32_t compare_a(tOrderDescriptor *, int32_t numOfRow1, int32_t s1, char *data1
 int32_t compare_d(tOrderDescriptor *, int32_t numOfRow1, int32_t s1, char *data1, int32_t numOfRow2, int32_t s2,
                   char *data2);
 
+/**
+ * merge the sorted runs in memory into one sorted run. The key space is split into ranges by the splitters sampled
+ * from all runs, and each range is merged independently, so the output of all ranges in order is the merge result.
+ *
+ * @param pSched           scheduler to merge the ranges in parallel, all ranges are merged by the caller if NULL
+ * @param numOfPartitions  number of key ranges
+ * @param pDesc            order descriptor
+ * @param capacity         number of rows of the page, which is the column stride of all input and output pages
+ * @param pRuns            sorted runs
+ * @param numOfRuns        number of sorted runs
+ * @param orderType        TSDB_ORDER_ASC or TSDB_ORDER_DESC
+ * @param pPageList        output pages, each one is allocated with sizeof(tFilePage) + capacity * rowSize
+ * @return                 error code
+ */
+int32_t tColDataMergeSortedRuns(void *pSched, int32_t numOfPartitions, tOrderDescriptor *pDesc, int32_t capacity,
+                                SSortedRun *pRuns, int32_t numOfRuns, int32_t orderType, SArray *pPageList);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_QGROUPHASH_H
+#define TDENGINE_QGROUPHASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "os.h"
+
+/**
+ * Open addressing hash table that maps the group key (or the time window start key) to the
+ * slot of the corresponding SWindowResult in SWindowResInfo.
+ *
+ * Keys of fixed-width types (bool, integers, float/double, timestamp) are kept inline in one
+ * int64_t array and probed linearly, so a lookup touches one or two cache lines and never
+ * allocates memory. Keys of binary/nchar type fall back to a copied key buffer per slot.
+ */
+typedef struct SGroupHashObj {
+  int16_t   type;      // data type of key
+  bool      varKey;    // binary/nchar key, compared by memcmp
+  uint32_t  capacity;  // number of slots, always the power of 2
+  uint32_t  size;      // number of keys in hash table
+  int64_t*  keys;      // inline keys, for fixed-width keys only
+  char**    pKeyBuf;   // [int16_t len][key data], for binary/nchar keys only
+  uint32_t* hashVal;   // hash value of each slot, for binary/nchar keys only
+  int32_t*  vals;      // value of each slot, -1 means empty slot
+} SGroupHashObj;
+
+/**
+ * create the group hash table
+ * @param capacity  initial number of keys
+ * @param type      data type of the key
+ * @return
+ */
+SGroupHashObj* tGroupHashInit(int32_t capacity, int16_t type);
+
+/**
+ * put the key/value pair into hash table, the value of existed key is overwritten
+ * @param pHashObj
+ * @param key
+ * @param bytes
+ * @param val       must be non-negative
+ * @return
+ */
+int32_t tGroupHashPut(SGroupHashObj* pHashObj, const char* key, int16_t bytes, int32_t val);
+
+/**
+ * get the value of the key
+ * @param pHashObj
+ * @param key
+ * @param bytes
+ * @return  pointer to the value, or NULL if the key does not exist
+ */
+int32_t* tGroupHashGet(SGroupHashObj* pHashObj, const char* key, int16_t bytes);
+
+/**
+ * probe all keys of one column data block in a batch. The hash values of the whole block are
+ * calculated before probing the table to make the memory access of the slots pipelined.
+ * @param pHashObj
+ * @param pData     column data of the block, each key is bytes long
+ * @param bytes
+ * @param numOfRows
+ * @param pVal      output value for each row, -1 if the key does not exist
+ */
+void tGroupHashGetBatch(SGroupHashObj* pHashObj, const char* pData, int16_t bytes, int32_t numOfRows, int32_t* pVal);
+
+/**
+ * remove the key from hash table
+ * @param pHashObj
+ * @param key
+ * @param bytes
+ */
+void tGroupHashRemove(SGroupHashObj* pHashObj, const char* key, int16_t bytes);
+
+/**
+ * remove all keys from hash table, the capacity remains
+ * @param pHashObj
+ */
+void tGroupHashClear(SGroupHashObj* pHashObj);
+
+/**
+ * the number of keys in hash table
+ * @param pHashObj
+ * @return
+ */
+size_t tGroupHashGetSize(const SGroupHashObj* pHashObj);
+
+void tGroupHashCleanup(SGroupHashObj* pHashObj);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_QGROUPHASH_H
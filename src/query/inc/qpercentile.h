@@ -16,6 +16,10 @@
 #ifndef TDENGINE_QPERCENTILE_H
 #define TDENGINE_QPERCENTILE_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #include "qextbuffer.h"
 
 typedef struct MinMaxEntry {
@@ -58,11 +62,20 @@ typedef struct tMemBucket {
   
   MinMaxEntry nRange;
   
+  /*
+   * all values are kept in one contiguous array of the data type, and the percentile is found by selection,
+   * until the array exceeds maxSelBufSize. Then all values are moved into the buckets.
+   */
+  bool    inMemSelect;
+  char *  pSelBuf;
+  int32_t selBufCapacity;  // number of elements
+  int64_t maxSelBufSize;   // in bytes
+  
   void (*HashFunc)(struct tMemBucket *pBucket, void *value, int16_t *segIdx, int16_t *slotIdx);
 } tMemBucket;
 
-tMemBucket *tMemBucketCreate(int32_t totalSlots, int32_t nBufferSize, int16_t nElemSize, int16_t dataType,
-                             tOrderDescriptor *pDesc);
+tMemBucket *tMemBucketCreate(int32_t totalSlots, int32_t nBufferSize, int64_t maxSelBufSize, int16_t nElemSize,
+                             int16_t dataType, tOrderDescriptor *pDesc);
 
 void tMemBucketDestroy(tMemBucket *pBucket);
 
@@ -74,4 +87,8 @@ void tBucketIntHash(tMemBucket *pBucket, void *value, int16_t *segIdx, int16_t *
 
 void tBucketDoubleHash(tMemBucket *pBucket, void *value, int16_t *segIdx, int16_t *slotIdx);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif  // TDENGINE_QPERCENTILE_H
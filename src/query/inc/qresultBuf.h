@@ -29,31 +29,61 @@ typedef struct SIDList {
   int32_t* pData;
 } SIDList;
 
+typedef struct SPageInfo {
+  char*   pData;   // page data in memory, NULL if the page is evicted to spill file
+  int64_t offset;  // offset in spill file, -1 if the page has never been flushed
+  int32_t pinned;  // pin count, the pinned page can not be evicted
+  int32_t prev;    // LRU list, the most recently used page is at head
+  int32_t next;
+} SPageInfo;
+
+typedef struct SResultBufStatis {
+  int32_t flushPages;     // number of pages written to spill file
+  int32_t loadPages;      // number of pages loaded from spill file
+  int32_t maxInMemPages;  // maximum number of pages in memory
+} SResultBufStatis;
+
 typedef struct SDiskbasedResultBuf {
   int32_t  numOfRowsPerPage;
-  int32_t  numOfPages;
-  int64_t  totalBufSize;
-  int32_t  fd;                  // data file fd
+  int32_t  numOfPages;          // capacity of page table
+  int64_t  totalBufSize;        // size of all allocated pages, either in memory or in spill file
+  int32_t  fd;                  // spill file fd, created when the first page is evicted
+  int64_t  fileSize;            // size of spill file
   int32_t  allocateId;          // allocated page id
   int32_t  incStep;             // minimum allocated pages
-  char*    pBuf;                // mmap buffer pointer
   char*    path;                // file path
-  
+
+  int32_t    inMemPages;        // maximum number of pages kept in memory
+  int32_t    numOfInMemPages;   // number of pages in memory
+  int32_t    lruHead;           // most recently used page id
+  int32_t    lruTail;           // least recently used page id, the victim of eviction
+  SPageInfo* pageTable;         // page info of each allocated page, indexed by page id
+
   uint32_t numOfAllocGroupIds;  // number of allocated id list
   void*    idsTable;            // id hash table
   SIDList* list;                // for each id, there is a page id list
+
+  SResultBufStatis statis;
+  void*            handle;      // QInfo handle, for log only
 } SDiskbasedResultBuf;
 
 #define DEFAULT_INTERN_BUF_PAGE_SIZE (8192L*5)
 
+// pages that are referenced at the same time, e.g. two pages compared in merge, should not evict each other
+#define MIN_INMEM_BUF_PAGES 8
+
 /**
- * create disk-based result buffer
+ * create disk-based result buffer. Pages are kept in memory until the in-memory buffer size is reached,
+ * after that the least recently used unpinned page is evicted to the spill file.
  * @param pResultBuf
- * @param size
+ * @param size          initial number of pages
  * @param rowSize
+ * @param inMemBufSize  maximum size of pages in memory, in bytes
+ * @param handle
  * @return
  */
-int32_t createDiskbasedResultBuffer(SDiskbasedResultBuf** pResultBuf, int32_t size, int32_t rowSize, void* handle);
+int32_t createDiskbasedResultBuffer(SDiskbasedResultBuf** pResultBuf, int32_t size, int32_t rowSize,
+                                    int64_t inMemBufSize, void* handle);
 
 /**
  *
@@ -80,12 +110,27 @@ int32_t getNumOfRowsPerPage(SDiskbasedResultBuf* pResultBuf);
 SIDList getDataBufPagesIdList(SDiskbasedResultBuf* pResultBuf, int32_t groupId);
 
 /**
- * get the specified buffer page by id
+ * get the specified buffer page by id, the page is loaded from spill file if it is evicted.
+ * The returned pointer is valid until more than MIN_INMEM_BUF_PAGES other pages are accessed, unless it is pinned.
+ * @param pResultBuf
+ * @param id
+ * @return the page, or NULL with terrno set if the page fails to be loaded
+ */
+tFilePage* getResBufPage(SDiskbasedResultBuf* pResultBuf, int32_t id);
+
+/**
+ * pin the page in memory, e.g., the output buffer of the active window, until it is unpinned
+ * @param pResultBuf
+ * @param id
+ */
+void pinResBufPage(SDiskbasedResultBuf* pResultBuf, int32_t id);
+
+/**
+ * unpin the page, so it can be evicted again
  * @param pResultBuf
  * @param id
- * @return
  */
-#define GET_RES_BUF_PAGE_BY_ID(buf, id)  ((tFilePage*)((buf)->pBuf + DEFAULT_INTERN_BUF_PAGE_SIZE*(id)))
+void unpinResBufPage(SDiskbasedResultBuf* pResultBuf, int32_t id);
 
 /**
  * get the total buffer size in the format of disk file
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_QRESULTENCODE_H
+#define TDENGINE_QRESULTENCODE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "os.h"
+
+/**
+ * Columnar encoding of the query result block transferred from vnode to client.
+ *
+ * Each column is encoded by the codec of storage engine for its data type (delta-of-delta for
+ * timestamp, simple8b for integers, xor for float/double, LZ4 for binary/nchar), and the
+ * var-length strings are sent without the padding bytes. A column is sent as is, if encoding
+ * does not make it smaller.
+ *
+ * encoded block: [int32_t numOfCols][SResultColHead][column data][SResultColHead][column data]...
+ */
+#define RESULT_ENCODE_RAW    0  // column data are sent as is
+#define RESULT_ENCODE_COMP   1  // column data are compressed by the codec of data type
+#define RESULT_ENCODE_VARSTR 2  // var-length strings without padding, compressed by LZ4
+
+// small blocks are not worth the encoding
+#define RESULT_ENCODE_MIN_ROWS 64
+
+typedef struct SResultColHead {
+  int8_t  type;
+  int8_t  encode;
+  int16_t reserved;
+  int32_t bytes;  // bytes of each value before encoding
+  int32_t len;    // length of encoded column data
+} SResultColHead;
+
+typedef struct SEncodeColumn {
+  int16_t     type;
+  int32_t     bytes;
+  bool        varStr;  // value is in the format of [VarDataLenT][data], i.e., the result of projection
+  const char *pData;
+} SEncodeColumn;
+
+/**
+ * the maximum size of encoded block, the output buffer of qEncodeResultBlock must be no less than it
+ * @param pCols
+ * @param numOfCols
+ * @param numOfRows
+ * @return
+ */
+int32_t qGetEncodedResultMaxSize(const SEncodeColumn *pCols, int32_t numOfCols, int32_t numOfRows);
+
+/**
+ * encode the columns of result block
+ * @param pCols
+ * @param numOfCols
+ * @param numOfRows
+ * @param pOutput
+ * @return  length of the encoded block
+ */
+int32_t qEncodeResultBlock(const SEncodeColumn *pCols, int32_t numOfCols, int32_t numOfRows, char *pOutput);
+
+/**
+ * the size of decoded block, in which each column takes bytes * numOfRows
+ * @param pInput
+ * @param inputLen
+ * @param numOfRows
+ * @param encodedLen    length of the encoded block in the input
+ * @return  -1 if the input is invalid
+ */
+int32_t qGetDecodedResultSize(const char *pInput, int32_t inputLen, int32_t numOfRows, int32_t *encodedLen);
+
+/**
+ * decode the result block into the fixed-width columnar layout
+ * @param pInput
+ * @param numOfRows
+ * @param pOutput   at least qGetDecodedResultSize bytes
+ * @return  0 for success, -1 if the input is invalid
+ */
+int32_t qDecodeResultBlock(const char *pInput, int32_t numOfRows, char *pOutput);
+
+/**
+ * the length of one column in the encoded block, including its head
+ * @param pInput    the head of the column
+ * @param bytes     bytes of each value after decoding
+ * @return
+ */
+int32_t qGetEncodedColumnLen(const char *pInput, int32_t *bytes);
+
+/**
+ * decode one column of the result block, so the columns can be decoded when they are accessed
+ * @param pInput    the head of the column
+ * @param numOfRows
+ * @param pOutput   at least bytes * numOfRows
+ * @return  0 for success, -1 if the input is invalid
+ */
+int32_t qDecodeResultColumn(const char *pInput, int32_t numOfRows, char *pOutput);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_QRESULTENCODE_H
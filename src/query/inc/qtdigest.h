@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_QTDIGEST_H
+#define TDENGINE_QTDIGEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "os.h"
+
+/**
+ * Merging t-digest for the approximate percentile.
+ *
+ * The incoming values are appended to an unmerged buffer in O(1), and the buffer is sorted and
+ * merged into the centroid list when it is full. The size of centroids is bounded by the scale
+ * function k(q) = compression / (2 * PI) * asin(2q - 1), which keeps the centroids small at both
+ * tails, so the error at p99/p999 is much lower than that of the equal-size histogram bins.
+ *
+ * The whole digest, including the unmerged buffer, resides in one fixed-size memory block without
+ * any pointers, so it can be used as the intermediate result of query directly, and transferred
+ * from vnode to client and merged in the local reducer without serialization.
+ */
+#define TDIGEST_COMPRESSION        200
+#define TDIGEST_MAX_CENTROIDS(c)   ((c) * 2)
+#define TDIGEST_BUFFER_CAPACITY(c) ((c) * 2)
+
+typedef struct SCentroid {
+  double  mean;
+  int64_t weight;
+} SCentroid;
+
+typedef struct STDigest {
+  int32_t   compression;
+  int32_t   maxEntries;    // capacity of elems, including the unmerged buffer
+  int32_t   numOfCentroids;
+  int32_t   numOfBuffered; // unmerged values, located after the centroids in elems
+  int64_t   totalWeight;   // weight of both centroids and unmerged values
+  double    min;
+  double    max;
+  SCentroid elems[];
+} STDigest;
+
+#define TDIGEST_SIZE(c) \
+  (sizeof(STDigest) + sizeof(SCentroid) * (TDIGEST_MAX_CENTROIDS(c) + TDIGEST_BUFFER_CAPACITY(c)))
+
+/**
+ * initialize the t-digest in the given buffer, the buffer must be at least TDIGEST_SIZE(compression) bytes
+ * @param pBuf
+ * @param compression
+ * @return
+ */
+STDigest* tDigestCreateFrom(void* pBuf, int32_t compression);
+
+/**
+ * add one value into t-digest
+ * @param pDigest
+ * @param val
+ */
+void tDigestAdd(STDigest* pDigest, double val);
+
+/**
+ * add one value with the weight into t-digest
+ * @param pDigest
+ * @param val
+ * @param weight
+ */
+void tDigestAddWeighted(STDigest* pDigest, double val, int64_t weight);
+
+/**
+ * merge the unmerged buffer into centroids
+ * @param pDigest
+ */
+void tDigestCompress(STDigest* pDigest);
+
+/**
+ * merge the source t-digest into the destination one, the source remains unchanged. The empty
+ * destination is overwritten by the source, so it needs not to be initialized by tDigestCreateFrom
+ * @param pDst
+ * @param pSrc
+ */
+void tDigestMerge(STDigest* pDst, const STDigest* pSrc);
+
+/**
+ * estimate the value at the given percentile
+ * @param pDigest
+ * @param percent   in the range of [0, 100]
+ * @return
+ */
+double tDigestQuantile(STDigest* pDigest, double percent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_QTDIGEST_H
@@ -21,11 +21,14 @@
 #include "qExecutor.h"
 #include "qUtil.h"
 #include "qast.h"
+#include "exception.h"
 #include "qresultBuf.h"
+#include "qresultEncode.h"
 #include "query.h"
 #include "queryLog.h"
 #include "taosmsg.h"
 #include "tdataformat.h"
+#include "tglobal.h"
 #include "tlosertree.h"
 #include "tscUtil.h"  // todo move the function to common module
 #include "tscompression.h"
@@ -355,7 +358,7 @@ static SWindowResult *doSetTimeWindowFromKey(SQueryRuntimeEnv *pRuntimeEnv, SWin
                                              int16_t bytes) {
   SQuery *pQuery = pRuntimeEnv->pQuery;
 
-  int32_t *p1 = (int32_t *) taosHashGet(pWindowResInfo->hashList, pData, bytes);
+  int32_t *p1 = tGroupHashGet(pWindowResInfo->hashList, pData, bytes);
   if (p1 != NULL) {
     pWindowResInfo->curIndex = *p1;
   } else {  // more than the capacity, reallocate the resources
@@ -363,13 +366,14 @@ static SWindowResult *doSetTimeWindowFromKey(SQueryRuntimeEnv *pRuntimeEnv, SWin
       int64_t newCap = pWindowResInfo->capacity * 2;
 
       char *t = realloc(pWindowResInfo->pResult, newCap * sizeof(SWindowResult));
-      if (t != NULL) {
-        pWindowResInfo->pResult = (SWindowResult *)t;
-        memset(&pWindowResInfo->pResult[pWindowResInfo->capacity], 0, sizeof(SWindowResult) * pWindowResInfo->capacity);
-      } else {
-        // todo
+      if (t == NULL) {
+        terrno = TSDB_CODE_QRY_OUT_OF_MEMORY;
+        return NULL;
       }
 
+      pWindowResInfo->pResult = (SWindowResult *)t;
+      memset(&pWindowResInfo->pResult[pWindowResInfo->capacity], 0, sizeof(SWindowResult) * pWindowResInfo->capacity);
+
       for (int32_t i = pWindowResInfo->capacity; i < newCap; ++i) {
         SPosInfo pos = {-1, -1};
         createQueryResultInfo(pQuery, &pWindowResInfo->pResult[i], pRuntimeEnv->stableQuery, &pos);
@@ -377,9 +381,13 @@ static SWindowResult *doSetTimeWindowFromKey(SQueryRuntimeEnv *pRuntimeEnv, SWin
       pWindowResInfo->capacity = newCap;
     }
 
-    // add a new result set for a new group
+    // add a new result set for a new group, a window which cannot be found again is not used
+    if (tGroupHashPut(pWindowResInfo->hashList, pData, bytes, pWindowResInfo->size) != TSDB_CODE_SUCCESS) {
+      terrno = TSDB_CODE_QRY_OUT_OF_MEMORY;
+      return NULL;
+    }
+
     pWindowResInfo->curIndex = pWindowResInfo->size++;
-    taosHashPut(pWindowResInfo->hashList, pData, bytes, (char *)&pWindowResInfo->curIndex, sizeof(int32_t));
   }
 
   return getWindowResult(pWindowResInfo, pWindowResInfo->curIndex);
@@ -442,9 +450,9 @@ static int32_t addNewWindowResultBuf(SWindowResult *pWindowRes, SDiskbasedResult
     pData = getNewDataBuf(pResultBuf, sid, &pageId);
   } else {
     pageId = getLastPageId(&list);
-    pData = GET_RES_BUF_PAGE_BY_ID(pResultBuf, pageId);
+    pData = getResBufPage(pResultBuf, pageId);
 
-    if (pData->num >= numOfRowsPerPage) {
+    if (pData != NULL && pData->num >= numOfRowsPerPage) {
       pData = getNewDataBuf(pResultBuf, sid, &pageId);
       if (pData != NULL) {
         assert(pData->num == 0);  // number of elements must be 0 for new allocated buffer
@@ -472,7 +480,7 @@ static int32_t setWindowOutputBufByKey(SQueryRuntimeEnv *pRuntimeEnv, SWindowRes
 
   SWindowResult *pWindowRes = doSetTimeWindowFromKey(pRuntimeEnv, pWindowResInfo, (char *)&win->skey, TSDB_KEYSIZE);
   if (pWindowRes == NULL) {
-    return -1;
+    THROW(terrno);  // caught by qTableQuery, which aborts the query
   }
 
   // not assign result buffer yet, add new result buffer
@@ -911,7 +919,12 @@ static void blockwiseApplyFunctions(SQueryRuntimeEnv *pRuntimeEnv, SDataStatis *
   tfree(sasArray);
 }
 
-static int32_t setGroupResultOutputBuf(SQueryRuntimeEnv *pRuntimeEnv, char *pData, int16_t type, int16_t bytes) {
+/*
+ * slot is the position of the group in windowResInfo that is already resolved by batch probe of the hash table,
+ * -1 means the group is not known yet.
+ */
+static int32_t setGroupResultOutputBuf(SQueryRuntimeEnv *pRuntimeEnv, char *pData, int16_t type, int16_t bytes,
+                                       int32_t slot) {
   if (isNull(pData, type)) {  // ignore the null value
     return -1;
   }
@@ -931,9 +944,15 @@ static int32_t setGroupResultOutputBuf(SQueryRuntimeEnv *pRuntimeEnv, char *pDat
   }
 
 //  assert(pRuntimeEnv->windowResInfo.hashList->size <= 2);
-  SWindowResult *pWindowRes = doSetTimeWindowFromKey(pRuntimeEnv, &pRuntimeEnv->windowResInfo, pData, bytes);
-  if (pWindowRes == NULL) {
-    return -1;
+  SWindowResult *pWindowRes = NULL;
+  if (slot >= 0) {
+    pRuntimeEnv->windowResInfo.curIndex = slot;
+    pWindowRes = getWindowResult(&pRuntimeEnv->windowResInfo, slot);
+  } else {
+    pWindowRes = doSetTimeWindowFromKey(pRuntimeEnv, &pRuntimeEnv->windowResInfo, pData, bytes);
+    if (pWindowRes == NULL) {
+      THROW(terrno);
+    }
   }
 
   pWindowRes->window.skey = v;
@@ -1068,9 +1087,17 @@ static void rowwiseApplyFunctions(SQueryRuntimeEnv *pRuntimeEnv, SDataStatis *pS
   int16_t type = 0;
   int16_t bytes = 0;
 
-  char *groupbyColumnData = NULL;
+  char    *groupbyColumnData = NULL;
+  int32_t *groupSlot = NULL;
   if (groupbyStateValue) {
     groupbyColumnData = getGroupbyColumnData(pQuery, &type, &bytes, pDataBlock);
+
+    // resolve the existed groups of all rows in current block by one batch probe
+    groupSlot = (groupbyColumnData != NULL) ? malloc(sizeof(int32_t) * pDataBlockInfo->rows) : NULL;
+    if (groupSlot != NULL) {
+      tGroupHashGetBatch(pRuntimeEnv->windowResInfo.hashList, groupbyColumnData, bytes, pDataBlockInfo->rows,
+                         groupSlot);
+    }
   }
 
   for (int32_t k = 0; k < pQuery->numOfOutput; ++k) {
@@ -1158,9 +1185,10 @@ static void rowwiseApplyFunctions(SQueryRuntimeEnv *pRuntimeEnv, SDataStatis *pS
     } else {  // other queries
       // decide which group this rows belongs to according to current state value
       if (groupbyStateValue) {
-        char *val = groupbyColumnData + bytes * offset;
+        char   *val = groupbyColumnData + bytes * offset;
+        int32_t slot = (groupSlot != NULL) ? groupSlot[offset] : -1;
 
-        int32_t ret = setGroupResultOutputBuf(pRuntimeEnv, val, type, bytes);
+        int32_t ret = setGroupResultOutputBuf(pRuntimeEnv, val, type, bytes, slot);
         if (ret != TSDB_CODE_SUCCESS) {  // null data, too many state code
           continue;
         }
@@ -1194,6 +1222,7 @@ static void rowwiseApplyFunctions(SQueryRuntimeEnv *pRuntimeEnv, SDataStatis *pS
     tfree(sasArray[i].data);
   }
 
+  tfree(groupSlot);
   free(sasArray);
 }
 
@@ -1803,7 +1832,11 @@ char *getPosInResultPage(SQueryRuntimeEnv *pRuntimeEnv, int32_t columnIndex, SWi
   assert(pResult != NULL && pRuntimeEnv != NULL);
 
   SQuery    *pQuery = pRuntimeEnv->pQuery;
-  tFilePage *page = GET_RES_BUF_PAGE_BY_ID(pRuntimeEnv->pResultBuf, pResult->pos.pageId);
+  tFilePage *page = getResBufPage(pRuntimeEnv->pResultBuf, pResult->pos.pageId);
+  if (page == NULL) {
+    THROW(terrno);  // caught by qTableQuery, which aborts the query
+  }
+
   int32_t realRowId = pResult->pos.rowId * GET_ROW_PARAM_FOR_MULTIOUTPUT(pQuery, pRuntimeEnv->topBotQuery, pRuntimeEnv->stableQuery);
 
   return ((char *)page->data) + pRuntimeEnv->offset[columnIndex] * pRuntimeEnv->numOfRowsPerPage +
@@ -2526,7 +2559,11 @@ void copyResToQueryResultBuf(SQInfo *pQInfo, SQuery *pQuery) {
 
   int32_t total = 0;
   for (int32_t i = 0; i < list.size; ++i) {
-    tFilePage *pData = GET_RES_BUF_PAGE_BY_ID(pResultBuf, list.pData[i]);
+    tFilePage *pData = getResBufPage(pResultBuf, list.pData[i]);
+    if (pData == NULL) {
+      THROW(terrno);
+    }
+
     total += pData->num;
   }
 
@@ -2534,7 +2571,10 @@ void copyResToQueryResultBuf(SQInfo *pQInfo, SQuery *pQuery) {
 
   int32_t offset = 0;
   for (int32_t num = 0; num < list.size; ++num) {
-    tFilePage *pData = GET_RES_BUF_PAGE_BY_ID(pResultBuf, list.pData[num]);
+    tFilePage *pData = getResBufPage(pResultBuf, list.pData[num]);
+    if (pData == NULL) {
+      THROW(terrno);
+    }
 
     for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
       int32_t bytes = pRuntimeEnv->pCtx[i].outputBytes;
@@ -2597,6 +2637,11 @@ int32_t mergeIntoGroupResultImpl(SQInfo *pQInfo, SArray *pGroup) {
 
   STableQueryInfo **pTableList = malloc(POINTER_BYTES * size);
 
+  // the buffers are freed if the query is aborted during the merge, see qTableQuery
+  int32_t anchor = CLEANUP_GET_ANCHOR();
+  CLEANUP_PUSH_FREE(true, posList);
+  CLEANUP_PUSH_FREE(true, pTableList);
+
   // todo opt for the case of one table per group
   int32_t numOfTables = 0;
   for (int32_t i = 0; i < size; ++i) {
@@ -2610,6 +2655,7 @@ int32_t mergeIntoGroupResultImpl(SQInfo *pQInfo, SArray *pGroup) {
   }
 
   if (numOfTables == 0) {
+    CLEANUP_EXECUTE_TO(anchor, false);
     tfree(posList);
     tfree(pTableList);
 
@@ -2623,8 +2669,10 @@ int32_t mergeIntoGroupResultImpl(SQInfo *pQInfo, SArray *pGroup) {
 
   SLoserTreeInfo *pTree = NULL;
   tLoserTreeCreate(&pTree, numOfTables, &cs, tableResultComparFn);
+  CLEANUP_PUSH_FREE(true, pTree);
 
   SResultInfo *pResultInfo = calloc(pQuery->numOfOutput, sizeof(SResultInfo));
+  CLEANUP_PUSH_FREE(true, pResultInfo);
   setWindowResultInfo(pResultInfo, pQuery, pRuntimeEnv->stableQuery);
   resetMergeResultBuf(pQuery, pRuntimeEnv->pCtx, pResultInfo);
 
@@ -2659,6 +2707,7 @@ int32_t mergeIntoGroupResultImpl(SQInfo *pQInfo, SArray *pGroup) {
       } else {  // copy data to disk buffer
         if (buffer[0]->num == pQuery->rec.capacity) {
           if (flushFromResultBuf(pQInfo) != TSDB_CODE_SUCCESS) {
+            CLEANUP_EXECUTE_TO(anchor, true);
             return -1;
           }
 
@@ -2689,11 +2738,7 @@ int32_t mergeIntoGroupResultImpl(SQInfo *pQInfo, SArray *pGroup) {
     if (flushFromResultBuf(pQInfo) != TSDB_CODE_SUCCESS) {
       qError("QInfo:%p failed to flush data into temp file, abort query", pQInfo);
 
-      tfree(pTree);
-      tfree(pTableList);
-      tfree(posList);
-      tfree(pResultInfo);
-
+      CLEANUP_EXECUTE_TO(anchor, true);
       return -1;
     }
   }
@@ -2706,6 +2751,7 @@ int32_t mergeIntoGroupResultImpl(SQInfo *pQInfo, SArray *pGroup) {
 
   qTrace("QInfo:%p result merge completed for group:%d, elapsed time:%" PRId64 " ms", pQInfo, pQInfo->groupIndex, endt - startt);
 
+  CLEANUP_EXECUTE_TO(anchor, false);
   tfree(pTableList);
   tfree(posList);
   tfree(pTree);
@@ -3281,7 +3327,7 @@ void setExecutionContext(SQInfo *pQInfo, void* pTable, int32_t groupIndex, TSKEY
 
   SWindowResult *pWindowRes = doSetTimeWindowFromKey(pRuntimeEnv, pWindowResInfo, (char *)&groupIndex, sizeof(groupIndex));
   if (pWindowRes == NULL) {
-    return;
+    THROW(terrno);
   }
 
   /*
@@ -3302,8 +3348,26 @@ void setExecutionContext(SQInfo *pQInfo, void* pTable, int32_t groupIndex, TSKEY
   setAdditionalInfo(pQInfo, pTableQueryInfo->pTable, pTableQueryInfo);
 }
 
+/*
+ * the output buffer of pCtx points to the page of the active window until another window is activated,
+ * so the page is pinned in memory in case of being evicted by the result buffer
+ */
+static void setActiveResultPage(SQueryRuntimeEnv *pRuntimeEnv, int32_t pageId) {
+  if (pRuntimeEnv->activePageId == pageId) {
+    return;
+  }
+
+  if (pRuntimeEnv->activePageId >= 0) {
+    unpinResBufPage(pRuntimeEnv->pResultBuf, pRuntimeEnv->activePageId);
+  }
+
+  pinResBufPage(pRuntimeEnv->pResultBuf, pageId);
+  pRuntimeEnv->activePageId = pageId;
+}
+
 void setWindowResOutputBuf(SQueryRuntimeEnv *pRuntimeEnv, SWindowResult *pResult) {
   SQuery *pQuery = pRuntimeEnv->pQuery;
+  setActiveResultPage(pRuntimeEnv, pResult->pos.pageId);
 
   // Note: pResult->pos[i]->num == 0, there is only fixed number of results for each group
   for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
@@ -3329,6 +3393,7 @@ void setWindowResOutputBuf(SQueryRuntimeEnv *pRuntimeEnv, SWindowResult *pResult
 
 void setWindowResOutputBufInitCtx(SQueryRuntimeEnv *pRuntimeEnv, SWindowResult *pResult) {
   SQuery *pQuery = pRuntimeEnv->pQuery;
+  setActiveResultPage(pRuntimeEnv, pResult->pos.pageId);
 
   // Note: pResult->pos[i]->num == 0, there is only fixed number of results for each group
   for (int32_t i = 0; i < pQuery->numOfOutput; ++i) {
@@ -3640,14 +3705,48 @@ bool queryHasRemainResults(SQueryRuntimeEnv* pRuntimeEnv) {
   return false;
 }
 
-static void doCopyQueryResultToMsg(SQInfo *pQInfo, int32_t numOfRows, char *data) {
-  SQuery *pQuery = pQInfo->runtimeEnv.pQuery;
+/*
+ * the result is encoded by column only if the client decodes it, and it is not compressed as a whole by rpc, which
+ * is the case if it is larger than tsCompressMsgSize
+ */
+static bool isResultEncoded(SQuery *pQuery) {
+  return pQuery->encodeResult && pQuery->rec.rows >= RESULT_ENCODE_MIN_ROWS && !isTSCompQuery(pQuery) &&
+         !NEEDTO_COMPRESSS_MSG(pQuery->rowSize * pQuery->rec.rows);
+}
 
+static void setEncodeColumnInfo(SQuery *pQuery, SEncodeColumn *pCols) {
   for (int32_t col = 0; col < pQuery->numOfOutput; ++col) {
-    int32_t bytes = pQuery->pSelectExpr[col].bytes;
+    SExprInfo *pExpr = &pQuery->pSelectExpr[col];
+    int32_t    functionId = pExpr->base.functionId;
 
-    memmove(data, pQuery->sdata[col]->data, bytes * numOfRows);
-    data += bytes * numOfRows;
+    pCols[col].type = pExpr->type;
+    pCols[col].bytes = pExpr->bytes;
+    pCols[col].varStr =
+        (functionId == TSDB_FUNC_PRJ || functionId == TSDB_FUNC_TAGPRJ || functionId == TSDB_FUNC_TAG);
+    pCols[col].pData = pQuery->sdata[col]->data;
+  }
+}
+
+/*
+ * @return  length of the result data in msg
+ */
+static int32_t doCopyQueryResultToMsg(SQInfo *pQInfo, int32_t numOfRows, char *data) {
+  SQuery *pQuery = pQInfo->runtimeEnv.pQuery;
+  char *  start = data;
+
+  if (isResultEncoded(pQuery)) {
+    SEncodeColumn *pCols = calloc(pQuery->numOfOutput, sizeof(SEncodeColumn));
+    setEncodeColumnInfo(pQuery, pCols);
+
+    data += qEncodeResultBlock(pCols, pQuery->numOfOutput, numOfRows, data);
+    tfree(pCols);
+  } else {
+    for (int32_t col = 0; col < pQuery->numOfOutput; ++col) {
+      int32_t bytes = pQuery->pSelectExpr[col].bytes;
+
+      memmove(data, pQuery->sdata[col]->data, bytes * numOfRows);
+      data += bytes * numOfRows;
+    }
   }
 
   int32_t numOfTables = (int32_t)taosArrayGetSize(pQInfo->arrTableIdInfo);
@@ -3674,6 +3773,8 @@ static void doCopyQueryResultToMsg(SQInfo *pQInfo, int32_t numOfRows, char *data
       }
     }
   }
+
+  return (int32_t)(data - start);
 }
 
 int32_t doFillGapsInResults(SQueryRuntimeEnv* pRuntimeEnv, tFilePage **pDst, int32_t *numOfInterpo) {
@@ -3746,6 +3847,12 @@ static void queryCostStatis(SQInfo *pQInfo) {
          "total rows:%"PRId64 ", check rows:%"PRId64, pQInfo, pSummary->elapsedTime, pSummary->totalBlocks,
          pSummary->loadBlockStatis, pSummary->loadBlocks, pSummary->totalRows, pSummary->totalCheckedRows);
 
+  if (pRuntimeEnv->pResultBuf != NULL) {
+    SResultBufStatis *pStatis = &pRuntimeEnv->pResultBuf->statis;
+    qTrace("QInfo:%p :cost summary: result buffer max in-memory pages:%d, flush pages:%d, load pages:%d", pQInfo,
+           pStatis->maxInMemPages, pStatis->flushPages, pStatis->loadPages);
+  }
+
 //  qTrace("QInfo:%p cost: temp file:%d Bytes", pQInfo, pSummary->tmpBufferInDisk);
 //
 //  qTrace("QInfo:%p cost: file:%d, table:%d", pQInfo, pSummary->numOfFiles, pSummary->numOfTables);
@@ -4048,10 +4155,12 @@ int32_t doInitQInfo(SQInfo *pQInfo, void *param, void *tsdb, int32_t vgId, bool
   }
 
   pRuntimeEnv->numOfRowsPerPage = getNumOfRowsInResultPage(pQuery, pRuntimeEnv->topBotQuery, isSTableQuery);
+  pRuntimeEnv->activePageId = -1;
 
   if (isSTableQuery) {
     int32_t rows = getInitialPageNum(pQInfo);
-    code = createDiskbasedResultBuffer(&pRuntimeEnv->pResultBuf, rows, pQuery->rowSize, pQInfo);
+    code = createDiskbasedResultBuffer(&pRuntimeEnv->pResultBuf, rows, pQuery->rowSize, tsQueryBufferSize * 1048576L,
+                                       pQInfo);
     if (code != TSDB_CODE_SUCCESS) {
       return code;
     }
@@ -4070,7 +4179,8 @@ int32_t doInitQInfo(SQInfo *pQInfo, void *param, void *tsdb, int32_t vgId, bool
 
   } else if (isGroupbyNormalCol(pQuery->pGroupbyExpr) || isIntervalQuery(pQuery)) {
     int32_t rows = getInitialPageNum(pQInfo);
-    code = createDiskbasedResultBuffer(&pRuntimeEnv->pResultBuf, rows, pQuery->rowSize, pQInfo);
+    code = createDiskbasedResultBuffer(&pRuntimeEnv->pResultBuf, rows, pQuery->rowSize, tsQueryBufferSize * 1048576L,
+                                       pQInfo);
     if (code != TSDB_CODE_SUCCESS) {
       return code;
     }
@@ -5518,6 +5628,7 @@ static SQInfo *createQInfoImpl(SQueryTableMsg *pQueryMsg, SArray* pTableIdList,
   pQuery->intervalTime    = pQueryMsg->intervalTime;
   pQuery->slidingTime     = pQueryMsg->slidingTime;
   pQuery->slidingTimeUnit = pQueryMsg->slidingTimeUnit;
+  pQuery->encodeResult    = TSDB_QUERY_HAS_TYPE(pQueryMsg->queryType, TSDB_QUERY_TYPE_ENCODE_RESULT);
   pQuery->fillType        = pQueryMsg->fillType;
   pQuery->numOfTags       = pQueryMsg->numOfTags;
   
@@ -5816,7 +5927,7 @@ static size_t getResultSize(SQInfo *pQInfo, int64_t *numOfRows) {
   }
 }
 
-static int32_t doDumpQueryResult(SQInfo *pQInfo, char *data) {
+static int32_t doDumpQueryResult(SQInfo *pQInfo, char *data, int32_t *len) {
   // the remained number of retrieved rows, not the interpolated result
   SQuery *pQuery = pQInfo->runtimeEnv.pQuery;
 
@@ -5845,7 +5956,7 @@ static int32_t doDumpQueryResult(SQInfo *pQInfo, char *data) {
       setQueryStatus(pQuery, QUERY_OVER);
     }
   } else {
-    doCopyQueryResultToMsg(pQInfo, pQuery->rec.rows, data);
+    *len = doCopyQueryResultToMsg(pQInfo, pQuery->rec.rows, data);
   }
 
   pQuery->rec.total += pQuery->rec.rows;
@@ -6008,14 +6119,23 @@ void qTableQuery(qinfo_t qinfo, void (*fp)(void*), void* param) {
 
   qTrace("QInfo:%p query task is launched", pQInfo);
 
-  if (onlyQueryTags(pQInfo->runtimeEnv.pQuery)) {
-    assert(pQInfo->runtimeEnv.pQueryHandle == NULL);
-    buildTagQueryResult(pQInfo);   // todo support the limit/offset
-  } else if (pQInfo->runtimeEnv.stableQuery) {
-    stableQueryImpl(pQInfo);
-  } else {
-    tableQueryImpl(pQInfo);
-  }
+  // a result page that fails to be loaded from the spill file aborts the query with the error
+  TRY(32) {
+    if (onlyQueryTags(pQInfo->runtimeEnv.pQuery)) {
+      assert(pQInfo->runtimeEnv.pQueryHandle == NULL);
+      buildTagQueryResult(pQInfo);   // todo support the limit/offset
+    } else if (pQInfo->runtimeEnv.stableQuery) {
+      stableQueryImpl(pQInfo);
+    } else {
+      tableQueryImpl(pQInfo);
+    }
+  } CATCH(code) {
+    CLEANUP_EXECUTE();
+    qError("QInfo:%p query is aborted, code:%s", pQInfo, tstrerror(code));
+    pQInfo->code = code;
+    pQInfo->runtimeEnv.pQuery->rec.rows = 0;
+    setQueryStatus(pQInfo->runtimeEnv.pQuery, QUERY_OVER);
+  } END_TRY
 
   sem_post(&pQInfo->dataReady);
   qDestroyQueryInfo(pQInfo, fp, param);
@@ -6081,6 +6201,13 @@ int32_t qDumpRetrieveResult(qinfo_t qinfo, SRetrieveTableRsp **pRsp, int32_t *co
   size_t  size = getResultSize(pQInfo, &pQuery->rec.rows);
   size += sizeof(int32_t);
   size += sizeof(STableIdInfo) * taosArrayGetSize(pQInfo->arrTableIdInfo);
+
+  // the header of each encoded column
+  bool encoded = isResultEncoded(pQuery);
+  if (encoded) {
+    size += sizeof(int32_t) + sizeof(SResultColHead) * pQuery->numOfOutput;
+  }
+
   *contLen = size + sizeof(SRetrieveTableRsp);
 
   // todo handle failed to allocate memory
@@ -6096,9 +6223,16 @@ int32_t qDumpRetrieveResult(qinfo_t qinfo, SRetrieveTableRsp **pRsp, int32_t *co
     (*pRsp)->useconds = 0;
   }
   
-  (*pRsp)->precision = htons(pQuery->precision);
+  (*pRsp)->precision = (int8_t)pQuery->precision;
   if (pQuery->rec.rows > 0 && code == TSDB_CODE_SUCCESS) {
-    code = doDumpQueryResult(pQInfo, (*pRsp)->data);
+    int32_t len = 0;
+    code = doDumpQueryResult(pQInfo, (*pRsp)->data, &len);
+
+    // the encoded result is usually much smaller than the estimated size
+    if (encoded) {
+      (*pRsp)->compressed = 1;
+      *contLen = len + sizeof(SRetrieveTableRsp);
+    }
   } else {
     setQueryStatus(pQuery, QUERY_OVER);
     code = pQInfo->code;
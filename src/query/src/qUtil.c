@@ -33,8 +33,7 @@ int32_t initWindowResInfo(SWindowResInfo *pWindowResInfo, SQueryRuntimeEnv *pRun
   
   pWindowResInfo->type = type;
   
-  _hash_fn_t fn = taosGetDefaultHashFunction(type);
-  pWindowResInfo->hashList = taosHashInit(threshold, fn, false);
+  pWindowResInfo->hashList = tGroupHashInit(threshold, type);
   
   pWindowResInfo->curIndex = -1;
   pWindowResInfo->size     = 0;
@@ -76,7 +75,7 @@ void cleanupTimeWindowInfo(SWindowResInfo *pWindowResInfo, int32_t numOfCols) {
     destroyTimeWindowRes(pResult, numOfCols);
   }
   
-  taosHashCleanup(pWindowResInfo->hashList);
+  tGroupHashCleanup(pWindowResInfo->hashList);
   tfree(pWindowResInfo->pResult);
 }
 
@@ -91,12 +90,9 @@ void resetTimeWindowInfo(SQueryRuntimeEnv *pRuntimeEnv, SWindowResInfo *pWindowR
   }
   
   pWindowResInfo->curIndex = -1;
-  taosHashCleanup(pWindowResInfo->hashList);
+  tGroupHashClear(pWindowResInfo->hashList);
   pWindowResInfo->size = 0;
   
-  _hash_fn_t fn = taosGetDefaultHashFunction(pWindowResInfo->type);
-  pWindowResInfo->hashList = taosHashInit(pWindowResInfo->capacity, fn, false);
-  
   pWindowResInfo->startTime = TSKEY_INITIAL_VAL;
   pWindowResInfo->prevSKey = TSKEY_INITIAL_VAL;
 }
@@ -113,7 +109,8 @@ void clearFirstNTimeWindow(SQueryRuntimeEnv *pRuntimeEnv, int32_t num) {
   for (int32_t i = 0; i < num; ++i) {
     SWindowResult *pResult = &pWindowResInfo->pResult[i];
     if (pResult->status.closed) {  // remove the window slot from hash table
-      taosHashRemove(pWindowResInfo->hashList, (const char *)&pResult->window.skey, pWindowResInfo->type);
+      tGroupHashRemove(pWindowResInfo->hashList, (const char *)&pResult->window.skey,
+                       tDataTypeDesc[pWindowResInfo->type].nSize);
     } else {
       break;
     }
@@ -133,16 +130,14 @@ void clearFirstNTimeWindow(SQueryRuntimeEnv *pRuntimeEnv, int32_t num) {
   }
   
   pWindowResInfo->size = remain;
-  printf("---------------size:%ld\n", taosHashGetSize(pWindowResInfo->hashList));
   for (int32_t k = 0; k < pWindowResInfo->size; ++k) {
     SWindowResult *pResult = &pWindowResInfo->pResult[k];
-    int32_t *p = (int32_t *)taosHashGet(pWindowResInfo->hashList, (const char *)&pResult->window.skey,
+    int32_t *p = tGroupHashGet(pWindowResInfo->hashList, (const char *)&pResult->window.skey,
         tDataTypeDesc[pWindowResInfo->type].nSize);
     
     int32_t  v = (*p - num);
     assert(v >= 0 && v <= pWindowResInfo->size);
-    taosHashPut(pWindowResInfo->hashList, (char *)&pResult->window.skey, tDataTypeDesc[pWindowResInfo->type].nSize,
-        (char *)&v, sizeof(int32_t));
+    tGroupHashPut(pWindowResInfo->hashList, (char *)&pResult->window.skey, tDataTypeDesc[pWindowResInfo->type].nSize, v);
   }
   
   pWindowResInfo->curIndex = -1;
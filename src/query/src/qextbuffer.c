@@ -22,6 +22,8 @@
 #include "ttime.h"
 #include "tutil.h"
 #include "queryLog.h"
+#include "tlosertree.h"
+#include "tsched.h"
 
 #define COLMODEL_GET_VAL(data, schema, allrow, rowId, colId) \
   (data + (schema)->pFields[colId].offset * (allrow) + (rowId) * (schema)->pFields[colId].field.bytes)
@@ -291,6 +293,22 @@ int32_t tExtMemBufferFlush(tExtMemBuffer *pMemBuffer) {
   return ret;
 }
 
+void tExtMemBufferMergeLastFlushout(tExtMemBuffer *pMemBuffer) {
+  tFlushoutData *pFlushoutData = &pMemBuffer->fileMeta.flushoutData;
+  if (pMemBuffer->flushModel != MULTIPLE_APPEND_MODEL || pFlushoutData->nLength < 2) {
+    return;
+  }
+
+  tFlushoutInfo *pLast = &pFlushoutData->pFlushoutInfo[pFlushoutData->nLength - 1];
+  tFlushoutInfo *pPrev = &pFlushoutData->pFlushoutInfo[pFlushoutData->nLength - 2];
+  assert(pPrev->startPageId + pPrev->numOfPages == pLast->startPageId);
+
+  pPrev->numOfPages += pLast->numOfPages;
+  memset(pLast, 0, sizeof(tFlushoutInfo));
+
+  pFlushoutData->nLength -= 1;
+}
+
 void tExtMemBufferClear(tExtMemBuffer *pMemBuffer) {
   if (pMemBuffer == NULL || pMemBuffer->numOfTotalElems == 0) {
     return;
@@ -1075,3 +1093,304 @@ void tOrderDescDestroy(tOrderDescriptor *pDesc) {
   destroyColumnModel(pDesc->pColumnModel);
   tfree(pDesc);
 }
+
+typedef struct SRowRef {
+  char *  data;    // page data that the row belongs to
+  int32_t rowIdx;
+} SRowRef;
+
+typedef struct SRunCursor {
+  SSortedRun *pRun;
+  int32_t     pageId;
+  int32_t     rowIdx;
+  int64_t     remain;  // number of rows of this run that belong to the partition
+} SRunCursor;
+
+typedef struct SMergePartition {
+  tOrderDescriptor *pDesc;
+  int32_t           capacity;
+  int32_t           orderType;
+  int32_t           numOfRuns;
+  SRunCursor *      pCursor;
+  SArray *          pPageList;  // output pages of this partition
+  int32_t           code;
+  tsem_t *          pDone;
+} SMergePartition;
+
+static FORCE_INLINE int32_t compareRows(tOrderDescriptor *pDesc, int32_t capacity, int32_t orderType, char *data1,
+                                        int32_t s1, char *data2, int32_t s2) {
+  return (orderType == TSDB_ORDER_DESC) ? compare_d(pDesc, capacity, s1, data1, capacity, s2, data2)
+                                        : compare_a(pDesc, capacity, s1, data1, capacity, s2, data2);
+}
+
+static int32_t sampleComparator(const void *p1, const void *p2, const void *param) {
+  const SMergePartition *pInfo = param;
+  const SRowRef *        pLeft = p1;
+  const SRowRef *        pRight = p2;
+
+  return compareRows(pInfo->pDesc, pInfo->capacity, pInfo->orderType, pLeft->data, pLeft->rowIdx, pRight->data,
+                     pRight->rowIdx);
+}
+
+static int32_t cursorComparator(const void *pLeft, const void *pRight, void *param) {
+  SMergePartition *pInfo = param;
+
+  SRunCursor *pLeftCursor = &pInfo->pCursor[*(int32_t *)pLeft];
+  SRunCursor *pRightCursor = &pInfo->pCursor[*(int32_t *)pRight];
+
+  // exhausted cursor is always the loser
+  if (pLeftCursor->remain == 0) {
+    return 1;
+  }
+
+  if (pRightCursor->remain == 0) {
+    return -1;
+  }
+
+  return compareRows(pInfo->pDesc, pInfo->capacity, pInfo->orderType,
+                     pLeftCursor->pRun->pPages[pLeftCursor->pageId]->data, pLeftCursor->rowIdx,
+                     pRightCursor->pRun->pPages[pRightCursor->pageId]->data, pRightCursor->rowIdx);
+}
+
+// locate the page of the row by its position in the sorted run, pOffset is the number of rows before each page
+static int32_t getPageOfRow(SSortedRun *pRun, int64_t *pOffset, int64_t pos) {
+  int32_t s = 0, e = pRun->numOfPages - 1;
+  while (s < e) {
+    int32_t mid = (s + e + 1) >> 1;
+    if (pOffset[mid] <= pos) {
+      s = mid;
+    } else {
+      e = mid - 1;
+    }
+  }
+
+  return s;
+}
+
+static SRowRef getRowInRun(SSortedRun *pRun, int64_t *pOffset, int64_t pos) {
+  int32_t pageId = getPageOfRow(pRun, pOffset, pos);
+
+  SRowRef ref = {.data = pRun->pPages[pageId]->data, .rowIdx = (int32_t)(pos - pOffset[pageId])};
+  return ref;
+}
+
+// the number of rows in the run that are not greater than the splitter, searching from the position of start
+static int64_t upperBoundInRun(SMergePartition *pInfo, SSortedRun *pRun, int64_t *pOffset, int64_t start,
+                               SRowRef *pSplitter) {
+  int64_t s = start, e = pOffset[pRun->numOfPages];
+  while (s < e) {
+    int64_t mid = s + ((e - s) >> 1);
+    SRowRef ref = getRowInRun(pRun, pOffset, mid);
+
+    if (compareRows(pInfo->pDesc, pInfo->capacity, pInfo->orderType, ref.data, ref.rowIdx, pSplitter->data,
+                    pSplitter->rowIdx) <= 0) {
+      s = mid + 1;
+    } else {
+      e = mid;
+    }
+  }
+
+  return s;
+}
+
+static void doMergePartition(SMergePartition *pInfo) {
+  SColumnModel *pModel = pInfo->pDesc->pColumnModel;
+
+  int64_t total = 0;
+  for (int32_t i = 0; i < pInfo->numOfRuns; ++i) {
+    total += pInfo->pCursor[i].remain;
+  }
+
+  SLoserTreeInfo *pTree = NULL;
+  if (total == 0 || (pInfo->code = tLoserTreeCreate(&pTree, pInfo->numOfRuns, pInfo, cursorComparator)) != 0) {
+    return;
+  }
+
+  size_t     pageSize = sizeof(tFilePage) + (size_t)pInfo->capacity * pModel->rowSize;
+  tFilePage *pOutput = NULL;
+
+  while (total-- > 0) {
+    int32_t     idx = pTree->pNode[0].index;
+    SRunCursor *pCursor = &pInfo->pCursor[idx];
+    tFilePage * pPage = pCursor->pRun->pPages[pCursor->pageId];
+
+    if (pOutput == NULL || pOutput->num >= pInfo->capacity) {
+      pOutput = malloc(pageSize);
+      if (pOutput == NULL) {
+        pInfo->code = TSDB_CODE_QRY_OUT_OF_MEMORY;
+        break;
+      }
+
+      pOutput->num = 0;
+      taosArrayPush(pInfo->pPageList, &pOutput);
+    }
+
+    for (int32_t col = 0; col < pModel->numOfCols; ++col) {
+      char *dst = COLMODEL_GET_VAL(pOutput->data, pModel, pInfo->capacity, pOutput->num, col);
+      char *src = COLMODEL_GET_VAL(pPage->data, pModel, pInfo->capacity, pCursor->rowIdx, col);
+      memcpy(dst, src, pModel->pFields[col].field.bytes);
+    }
+
+    pOutput->num += 1;
+
+    pCursor->remain -= 1;
+    if (++pCursor->rowIdx >= pPage->num) {
+      pCursor->pageId += 1;
+      pCursor->rowIdx = 0;
+    }
+
+    tLoserTreeAdjust(pTree, idx + pTree->numOfEntries);
+  }
+
+  tfree(pTree);
+}
+
+static void mergePartitionTask(SSchedMsg *pMsg) {
+  SMergePartition *pInfo = pMsg->ahandle;
+
+  doMergePartition(pInfo);
+  tsem_post(pInfo->pDone);
+}
+
+int32_t tColDataMergeSortedRuns(void *pSched, int32_t numOfPartitions, tOrderDescriptor *pDesc, int32_t capacity,
+                                SSortedRun *pRuns, int32_t numOfRuns, int32_t orderType, SArray *pPageList) {
+  const int32_t numOfSamplesPerPartition = 8;
+
+  assert(numOfPartitions > 0 && numOfRuns > 0);
+
+  int32_t code = TSDB_CODE_SUCCESS;
+
+  int64_t **pOffset = calloc(numOfRuns, POINTER_BYTES);
+  int64_t * pBound = calloc((size_t)numOfRuns * (numOfPartitions + 1), sizeof(int64_t));
+  SRowRef * pSamples = calloc((size_t)numOfRuns * numOfPartitions * numOfSamplesPerPartition, sizeof(SRowRef));
+
+  SMergePartition *pPartitions = calloc(numOfPartitions, sizeof(SMergePartition));
+  SRunCursor *     pCursor = calloc((size_t)numOfRuns * numOfPartitions, sizeof(SRunCursor));
+
+  tsem_t done;
+  tsem_init(&done, 0, 0);
+
+  if (pOffset == NULL || pBound == NULL || pSamples == NULL || pPartitions == NULL || pCursor == NULL) {
+    code = TSDB_CODE_QRY_OUT_OF_MEMORY;
+    goto _end;
+  }
+
+  for (int32_t i = 0; i < numOfPartitions; ++i) {
+    pPartitions[i] = (SMergePartition){.pDesc = pDesc,
+                                       .capacity = capacity,
+                                       .orderType = orderType,
+                                       .numOfRuns = numOfRuns,
+                                       .pCursor = &pCursor[i * numOfRuns],
+                                       .pDone = &done};
+
+    pPartitions[i].pPageList = taosArrayInit(4, POINTER_BYTES);
+    if (pPartitions[i].pPageList == NULL) {
+      code = TSDB_CODE_QRY_OUT_OF_MEMORY;
+      goto _end;
+    }
+  }
+
+  // sample the rows evenly from each run, and the splitters are chosen from the sorted samples
+  int32_t numOfSamples = 0;
+  for (int32_t i = 0; i < numOfRuns; ++i) {
+    if ((pOffset[i] = malloc(sizeof(int64_t) * (pRuns[i].numOfPages + 1))) == NULL) {
+      code = TSDB_CODE_QRY_OUT_OF_MEMORY;
+      goto _end;
+    }
+
+    pOffset[i][0] = 0;
+    for (int32_t j = 0; j < pRuns[i].numOfPages; ++j) {
+      pOffset[i][j + 1] = pOffset[i][j] + pRuns[i].pPages[j]->num;
+    }
+
+    int64_t numOfRows = pOffset[i][pRuns[i].numOfPages];
+    int32_t num = (int32_t)MIN(numOfRows, numOfPartitions * numOfSamplesPerPartition);
+    for (int32_t j = 0; j < num; ++j) {
+      pSamples[numOfSamples++] = getRowInRun(&pRuns[i], pOffset[i], numOfRows * j / num);
+    }
+  }
+
+  if (numOfSamples > 1) {
+    taosqsort(pSamples, numOfSamples, sizeof(SRowRef), &pPartitions[0], sampleComparator);
+  }
+
+  for (int32_t i = 0; i < numOfRuns; ++i) {
+    int64_t *pRunBound = &pBound[i * (numOfPartitions + 1)];
+    pRunBound[numOfPartitions] = pOffset[i][pRuns[i].numOfPages];
+
+    for (int32_t j = 1; j < numOfPartitions; ++j) {
+      SRowRef *pSplitter = &pSamples[(int64_t)numOfSamples * j / numOfPartitions];
+      pRunBound[j] = upperBoundInRun(&pPartitions[0], &pRuns[i], pOffset[i], pRunBound[j - 1], pSplitter);
+    }
+
+    // rows of one run in the same partition are consecutive, so the cursor starts from the partition boundary
+    for (int32_t j = 0; j < numOfPartitions; ++j) {
+      SRunCursor *p = &pPartitions[j].pCursor[i];
+
+      p->pRun = &pRuns[i];
+      p->remain = pRunBound[j + 1] - pRunBound[j];
+      if (p->remain > 0) {
+        p->pageId = getPageOfRow(&pRuns[i], pOffset[i], pRunBound[j]);
+        p->rowIdx = (int32_t)(pRunBound[j] - pOffset[i][p->pageId]);
+      }
+    }
+  }
+
+  // the caller merges the first partition, and the others are scheduled to the worker threads if available
+  int32_t numOfScheduled = 0;
+  for (int32_t i = 1; i < numOfPartitions; ++i) {
+    if (pSched == NULL) {
+      doMergePartition(&pPartitions[i]);
+    } else {
+      SSchedMsg schedMsg = {.fp = mergePartitionTask, .ahandle = &pPartitions[i]};
+      taosScheduleTask(pSched, &schedMsg);
+      numOfScheduled += 1;
+    }
+  }
+
+  doMergePartition(&pPartitions[0]);
+
+  for (int32_t i = 0; i < numOfScheduled; ++i) {
+    tsem_wait(&done);
+  }
+
+  for (int32_t i = 0; i < numOfPartitions; ++i) {
+    if (pPartitions[i].code != TSDB_CODE_SUCCESS) {
+      code = pPartitions[i].code;
+    }
+  }
+
+  if (code == TSDB_CODE_SUCCESS) {
+    for (int32_t i = 0; i < numOfPartitions; ++i) {
+      SArray *pList = pPartitions[i].pPageList;
+      for (int32_t j = 0; j < taosArrayGetSize(pList); ++j) {
+        taosArrayPush(pPageList, taosArrayGet(pList, j));
+      }
+    }
+  }
+
+_end:
+  for (int32_t i = 0; pPartitions != NULL && i < numOfPartitions; ++i) {
+    SArray *pList = pPartitions[i].pPageList;
+    for (int32_t j = 0; pList != NULL && code != TSDB_CODE_SUCCESS && j < taosArrayGetSize(pList); ++j) {
+      tFilePage *pPage = *(tFilePage **)taosArrayGet(pList, j);
+      tfree(pPage);
+    }
+
+    taosArrayDestroy(pList);
+  }
+
+  for (int32_t i = 0; pOffset != NULL && i < numOfRuns; ++i) {
+    tfree(pOffset[i]);
+  }
+
+  tsem_destroy(&done);
+
+  tfree(pOffset);
+  tfree(pBound);
+  tfree(pSamples);
+  tfree(pPartitions);
+  tfree(pCursor);
+
+  return code;
+}
@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+
+#include "hashfunc.h"
+#include "qgrouphash.h"
+#include "taosdef.h"
+#include "taoserror.h"
+#include "tutil.h"
+
+#define GROUP_HASH_MIN_CAPACITY 16
+#define GROUP_HASH_BATCH_SIZE   64
+#define GROUP_HASH_EMPTY_SLOT   (-1)
+
+// keep the load factor below 0.75 to bound the length of probe sequence
+#define GROUP_HASH_NEED_RESIZE(_h) (((_h)->size + 1) * 4 > (_h)->capacity * 3)
+
+static FORCE_INLINE int64_t groupHashReadKey(const char *key, int16_t bytes) {
+  switch (bytes) {
+    case sizeof(int8_t):  return *(int8_t *)key;
+    case sizeof(int16_t): return *(int16_t *)key;
+    case sizeof(int32_t): return *(int32_t *)key;
+    default:
+      assert(bytes == sizeof(int64_t));
+      return *(int64_t *)key;
+  }
+}
+
+// finalizer of murmur hash 3, which is good enough to scatter the consecutive integer keys
+static FORCE_INLINE uint32_t groupHashIntKey(int64_t key) {
+  uint64_t h = (uint64_t)key;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return (uint32_t)h;
+}
+
+static FORCE_INLINE bool groupHashVarKeyEqual(const char *pBuf, const char *key, int16_t bytes) {
+  return (*(int16_t *)pBuf == bytes) && (memcmp(pBuf + sizeof(int16_t), key, bytes) == 0);
+}
+
+static uint32_t groupHashRoundCapacity(int32_t capacity) {
+  uint32_t n = GROUP_HASH_MIN_CAPACITY;
+  while (n * 3 < (uint32_t)capacity * 4) {
+    n <<= 1;
+  }
+
+  return n;
+}
+
+static int32_t groupHashAllocSlots(SGroupHashObj *pHashObj, uint32_t capacity) {
+  pHashObj->vals = malloc(capacity * sizeof(int32_t));
+  if (pHashObj->vals == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  memset(pHashObj->vals, 0xFF, capacity * sizeof(int32_t));  // all slots are GROUP_HASH_EMPTY_SLOT
+
+  if (pHashObj->varKey) {
+    pHashObj->pKeyBuf = calloc(capacity, POINTER_BYTES);
+    pHashObj->hashVal = calloc(capacity, sizeof(uint32_t));
+    if (pHashObj->pKeyBuf == NULL || pHashObj->hashVal == NULL) {
+      tfree(pHashObj->pKeyBuf);
+      tfree(pHashObj->hashVal);
+      tfree(pHashObj->vals);
+      return TSDB_CODE_QRY_OUT_OF_MEMORY;
+    }
+  } else {
+    pHashObj->keys = malloc(capacity * sizeof(int64_t));
+    if (pHashObj->keys == NULL) {
+      tfree(pHashObj->vals);
+      return TSDB_CODE_QRY_OUT_OF_MEMORY;
+    }
+  }
+
+  pHashObj->capacity = capacity;
+  return TSDB_CODE_SUCCESS;
+}
+
+static int32_t groupHashResize(SGroupHashObj *pHashObj) {
+  uint32_t  oldCap = pHashObj->capacity;
+  int32_t * pOldVals = pHashObj->vals;
+  int64_t * pOldKeys = pHashObj->keys;
+  char **   pOldKeyBuf = pHashObj->pKeyBuf;
+  uint32_t *pOldHashVal = pHashObj->hashVal;
+
+  if (groupHashAllocSlots(pHashObj, oldCap << 1) != TSDB_CODE_SUCCESS) {
+    pHashObj->vals = pOldVals;
+    pHashObj->keys = pOldKeys;
+    pHashObj->pKeyBuf = pOldKeyBuf;
+    pHashObj->hashVal = pOldHashVal;
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  uint32_t mask = pHashObj->capacity - 1;
+  for (uint32_t i = 0; i < oldCap; ++i) {
+    if (pOldVals[i] == GROUP_HASH_EMPTY_SLOT) {
+      continue;
+    }
+
+    uint32_t h = pHashObj->varKey ? pOldHashVal[i] : groupHashIntKey(pOldKeys[i]);
+    uint32_t slot = h & mask;
+    while (pHashObj->vals[slot] != GROUP_HASH_EMPTY_SLOT) {
+      slot = (slot + 1) & mask;
+    }
+
+    pHashObj->vals[slot] = pOldVals[i];
+    if (pHashObj->varKey) {
+      pHashObj->pKeyBuf[slot] = pOldKeyBuf[i];
+      pHashObj->hashVal[slot] = h;
+    } else {
+      pHashObj->keys[slot] = pOldKeys[i];
+    }
+  }
+
+  tfree(pOldVals);
+  tfree(pOldKeys);
+  tfree(pOldKeyBuf);
+  tfree(pOldHashVal);
+  return TSDB_CODE_SUCCESS;
+}
+
+/*
+ * return the slot of the key if it exists, otherwise return the empty slot that terminates the probe sequence
+ */
+static FORCE_INLINE uint32_t groupHashFindIntSlot(const SGroupHashObj *pHashObj, int64_t key, uint32_t h) {
+  uint32_t mask = pHashObj->capacity - 1;
+  uint32_t slot = h & mask;
+
+  while (pHashObj->vals[slot] != GROUP_HASH_EMPTY_SLOT && pHashObj->keys[slot] != key) {
+    slot = (slot + 1) & mask;
+  }
+
+  return slot;
+}
+
+static uint32_t groupHashFindVarSlot(const SGroupHashObj *pHashObj, const char *key, int16_t bytes, uint32_t h) {
+  uint32_t mask = pHashObj->capacity - 1;
+  uint32_t slot = h & mask;
+
+  while (pHashObj->vals[slot] != GROUP_HASH_EMPTY_SLOT) {
+    if (pHashObj->hashVal[slot] == h && groupHashVarKeyEqual(pHashObj->pKeyBuf[slot], key, bytes)) {
+      break;
+    }
+
+    slot = (slot + 1) & mask;
+  }
+
+  return slot;
+}
+
+SGroupHashObj *tGroupHashInit(int32_t capacity, int16_t type) {
+  SGroupHashObj *pHashObj = calloc(1, sizeof(SGroupHashObj));
+  if (pHashObj == NULL) {
+    return NULL;
+  }
+
+  pHashObj->type = type;
+  pHashObj->varKey = IS_VAR_DATA_TYPE(type);
+
+  if (groupHashAllocSlots(pHashObj, groupHashRoundCapacity(capacity)) != TSDB_CODE_SUCCESS) {
+    free(pHashObj);
+    return NULL;
+  }
+
+  return pHashObj;
+}
+
+int32_t tGroupHashPut(SGroupHashObj *pHashObj, const char *key, int16_t bytes, int32_t val) {
+  assert(val >= 0);
+
+  if (GROUP_HASH_NEED_RESIZE(pHashObj) && groupHashResize(pHashObj) != TSDB_CODE_SUCCESS) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  if (!pHashObj->varKey) {
+    int64_t  k = groupHashReadKey(key, bytes);
+    uint32_t slot = groupHashFindIntSlot(pHashObj, k, groupHashIntKey(k));
+    if (pHashObj->vals[slot] == GROUP_HASH_EMPTY_SLOT) {
+      pHashObj->keys[slot] = k;
+      pHashObj->size += 1;
+    }
+
+    pHashObj->vals[slot] = val;
+    return TSDB_CODE_SUCCESS;
+  }
+
+  uint32_t h = MurmurHash3_32(key, bytes);
+  uint32_t slot = groupHashFindVarSlot(pHashObj, key, bytes, h);
+  if (pHashObj->vals[slot] == GROUP_HASH_EMPTY_SLOT) {
+    char *pBuf = malloc(sizeof(int16_t) + bytes);
+    if (pBuf == NULL) {
+      return TSDB_CODE_QRY_OUT_OF_MEMORY;
+    }
+
+    *(int16_t *)pBuf = bytes;
+    memcpy(pBuf + sizeof(int16_t), key, bytes);
+
+    pHashObj->pKeyBuf[slot] = pBuf;
+    pHashObj->hashVal[slot] = h;
+    pHashObj->size += 1;
+  }
+
+  pHashObj->vals[slot] = val;
+  return TSDB_CODE_SUCCESS;
+}
+
+int32_t *tGroupHashGet(SGroupHashObj *pHashObj, const char *key, int16_t bytes) {
+  uint32_t slot = 0;
+
+  if (!pHashObj->varKey) {
+    int64_t k = groupHashReadKey(key, bytes);
+    slot = groupHashFindIntSlot(pHashObj, k, groupHashIntKey(k));
+  } else {
+    slot = groupHashFindVarSlot(pHashObj, key, bytes, MurmurHash3_32(key, bytes));
+  }
+
+  return (pHashObj->vals[slot] == GROUP_HASH_EMPTY_SLOT) ? NULL : &pHashObj->vals[slot];
+}
+
+void tGroupHashGetBatch(SGroupHashObj *pHashObj, const char *pData, int16_t bytes, int32_t numOfRows, int32_t *pVal) {
+  if (pHashObj->varKey) {
+    for (int32_t i = 0; i < numOfRows; ++i) {
+      int32_t *p = tGroupHashGet(pHashObj, pData + bytes * i, bytes);
+      pVal[i] = (p == NULL) ? GROUP_HASH_EMPTY_SLOT : *p;
+    }
+
+    return;
+  }
+
+  int64_t  k[GROUP_HASH_BATCH_SIZE];
+  uint32_t h[GROUP_HASH_BATCH_SIZE];
+  uint32_t mask = pHashObj->capacity - 1;
+
+  for (int32_t start = 0; start < numOfRows; start += GROUP_HASH_BATCH_SIZE) {
+    int32_t num = MIN(numOfRows - start, GROUP_HASH_BATCH_SIZE);
+
+    // calculate the hash value of all keys first, and issue the prefetch of the home slots
+    for (int32_t i = 0; i < num; ++i) {
+      k[i] = groupHashReadKey(pData + bytes * (start + i), bytes);
+      h[i] = groupHashIntKey(k[i]);
+      __builtin_prefetch(&pHashObj->vals[h[i] & mask]);
+      __builtin_prefetch(&pHashObj->keys[h[i] & mask]);
+    }
+
+    for (int32_t i = 0; i < num; ++i) {
+      // rows of the same group are usually consecutive, reuse the result of previous row
+      if (i > 0 && k[i] == k[i - 1]) {
+        pVal[start + i] = pVal[start + i - 1];
+        continue;
+      }
+
+      uint32_t slot = groupHashFindIntSlot(pHashObj, k[i], h[i]);
+      pVal[start + i] = pHashObj->vals[slot];
+    }
+  }
+}
+
+void tGroupHashRemove(SGroupHashObj *pHashObj, const char *key, int16_t bytes) {
+  uint32_t slot = 0;
+  if (!pHashObj->varKey) {
+    int64_t k = groupHashReadKey(key, bytes);
+    slot = groupHashFindIntSlot(pHashObj, k, groupHashIntKey(k));
+  } else {
+    slot = groupHashFindVarSlot(pHashObj, key, bytes, MurmurHash3_32(key, bytes));
+  }
+
+  if (pHashObj->vals[slot] == GROUP_HASH_EMPTY_SLOT) {
+    return;
+  }
+
+  if (pHashObj->varKey) {
+    tfree(pHashObj->pKeyBuf[slot]);
+  }
+
+  pHashObj->vals[slot] = GROUP_HASH_EMPTY_SLOT;
+  pHashObj->size -= 1;
+
+  /*
+   * backward shift deletion: move the following keys of the same cluster into the hole if the hole is
+   * located between their home slot and current slot, so no tombstone is needed.
+   */
+  uint32_t mask = pHashObj->capacity - 1;
+  uint32_t hole = slot;
+  uint32_t next = (slot + 1) & mask;
+
+  while (pHashObj->vals[next] != GROUP_HASH_EMPTY_SLOT) {
+    uint32_t h = pHashObj->varKey ? pHashObj->hashVal[next] : groupHashIntKey(pHashObj->keys[next]);
+    uint32_t home = h & mask;
+
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      pHashObj->vals[hole] = pHashObj->vals[next];
+      if (pHashObj->varKey) {
+        pHashObj->pKeyBuf[hole] = pHashObj->pKeyBuf[next];
+        pHashObj->hashVal[hole] = pHashObj->hashVal[next];
+        pHashObj->pKeyBuf[next] = NULL;
+      } else {
+        pHashObj->keys[hole] = pHashObj->keys[next];
+      }
+
+      pHashObj->vals[next] = GROUP_HASH_EMPTY_SLOT;
+      hole = next;
+    }
+
+    next = (next + 1) & mask;
+  }
+}
+
+void tGroupHashClear(SGroupHashObj *pHashObj) {
+  if (pHashObj == NULL) {
+    return;
+  }
+
+  if (pHashObj->varKey) {
+    for (uint32_t i = 0; i < pHashObj->capacity; ++i) {
+      tfree(pHashObj->pKeyBuf[i]);
+    }
+  }
+
+  memset(pHashObj->vals, 0xFF, pHashObj->capacity * sizeof(int32_t));
+  pHashObj->size = 0;
+}
+
+size_t tGroupHashGetSize(const SGroupHashObj *pHashObj) {
+  return (pHashObj == NULL) ? 0 : pHashObj->size;
+}
+
+void tGroupHashCleanup(SGroupHashObj *pHashObj) {
+  if (pHashObj == NULL) {
+    return;
+  }
+
+  tGroupHashClear(pHashObj);
+
+  tfree(pHashObj->vals);
+  tfree(pHashObj->keys);
+  tfree(pHashObj->pKeyBuf);
+  tfree(pHashObj->hashVal);
+  free(pHashObj);
+}
@@ -238,8 +238,8 @@ void tBucketDoubleHash(tMemBucket *pBucket, void *value, int16_t *segIdx, int16_
   }
 }
 
-tMemBucket *tMemBucketCreate(int32_t totalSlots, int32_t nBufferSize, int16_t nElemSize, int16_t dataType,
-                             tOrderDescriptor *pDesc) {
+tMemBucket *tMemBucketCreate(int32_t totalSlots, int32_t nBufferSize, int64_t maxSelBufSize, int16_t nElemSize,
+                             int16_t dataType, tOrderDescriptor *pDesc) {
   tMemBucket *pBucket = (tMemBucket *)malloc(sizeof(tMemBucket));
   pBucket->nTotalSlots = totalSlots;
   pBucket->nSlotsOfSeg = 1 << 6;  // 64 Segments, 16 slots each seg.
@@ -260,6 +260,11 @@ tMemBucket *tMemBucketCreate(int32_t totalSlots, int32_t nBufferSize, int16_t nE
   pBucket->pSegs = NULL;
   pBucket->pOrderDesc = pDesc;
 
+  pBucket->inMemSelect = (maxSelBufSize > 0);
+  pBucket->pSelBuf = NULL;
+  pBucket->selBufCapacity = 0;
+  pBucket->maxSelBufSize = maxSelBufSize;
+
   switch (pBucket->dataType) {
     case TSDB_DATA_TYPE_INT:
     case TSDB_DATA_TYPE_SMALLINT:
@@ -344,6 +349,7 @@ void tMemBucketDestroy(tMemBucket *pBucket) {
     }
   }
 
+  tfree(pBucket->pSelBuf);
   tfree(pBucket->pSegs);
   tfree(pBucket);
 }
@@ -481,7 +487,7 @@ void tMemBucketUpdateBoundingBox(MinMaxEntry *r, char *data, int32_t dataType) {
  * in memory bucket, we only accept the simple data consecutive put in a row/column
  * no column-model in this case.
  */
-void tMemBucketPut(tMemBucket *pBucket, void *data, int32_t numOfRows) {
+static void tMemBucketPutImpl(tMemBucket *pBucket, void *data, int32_t numOfRows) {
   pBucket->numOfElems += numOfRows;
   int16_t segIdx = 0, slotIdx = 0;
 
@@ -577,6 +583,68 @@ void tMemBucketPut(tMemBucket *pBucket, void *data, int32_t numOfRows) {
   }
 }
 
+/*
+ * move all values in the selection array into buckets, once the array exceeds the memory budget
+ */
+static void tMemBucketSpill(tMemBucket *pBucket) {
+  uTrace("MemBucket:%p,%d values exceed the selection buffer size:%" PRId64 ", move into buckets", pBucket,
+         pBucket->numOfElems, pBucket->maxSelBufSize);
+
+  char *  pSelBuf = pBucket->pSelBuf;
+  int32_t numOfElems = pBucket->numOfElems;
+
+  pBucket->inMemSelect = false;
+  pBucket->pSelBuf = NULL;
+  pBucket->selBufCapacity = 0;
+  pBucket->numOfElems = 0;
+
+  tMemBucketPutImpl(pBucket, pSelBuf, numOfElems);
+  tfree(pSelBuf);
+}
+
+static bool tMemBucketEnsureSelBuf(tMemBucket *pBucket, int32_t numOfRows) {
+  int32_t required = pBucket->numOfElems + numOfRows;
+  if (required <= pBucket->selBufCapacity) {
+    return true;
+  }
+
+  int32_t bytes = tDataTypeDesc[pBucket->dataType].nSize;
+  int64_t newCapacity = MAX(pBucket->selBufCapacity * 2, 4096);
+  while (newCapacity < required) {
+    newCapacity *= 2;
+  }
+
+  newCapacity = MIN(newCapacity, pBucket->maxSelBufSize / bytes);
+  if (newCapacity < required) {
+    return false;
+  }
+
+  char *tmp = realloc(pBucket->pSelBuf, newCapacity * bytes);
+  if (tmp == NULL) {
+    return false;
+  }
+
+  pBucket->pSelBuf = tmp;
+  pBucket->selBufCapacity = (int32_t)newCapacity;
+  return true;
+}
+
+void tMemBucketPut(tMemBucket *pBucket, void *data, int32_t numOfRows) {
+  if (pBucket->inMemSelect) {
+    if (tMemBucketEnsureSelBuf(pBucket, numOfRows)) {
+      int32_t bytes = tDataTypeDesc[pBucket->dataType].nSize;
+      memcpy(pBucket->pSelBuf + pBucket->numOfElems * bytes, data, numOfRows * bytes);
+
+      pBucket->numOfElems += numOfRows;
+      return;
+    }
+
+    tMemBucketSpill(pBucket);
+  }
+
+  tMemBucketPutImpl(pBucket, data, numOfRows);
+}
+
 void releaseBucket(tMemBucket *pMemBucket, int32_t segIdx, int32_t slotIdx) {
   if (segIdx < 0 || segIdx > pMemBucket->numOfSegs || slotIdx < 0) {
     return;
@@ -901,11 +969,103 @@ double getPercentileImpl(tMemBucket *pMemBucket, int32_t count, double fraction)
   return 0;
 }
 
+/*
+ * introselect: quickselect with median-of-three pivot, falls back to sort when the recursion is
+ * too deep. After it returns, a[k] is the k-th smallest value, and no value after k is less than a[k].
+ * The percentile is interpolated between a[k] and the minimum value after k.
+ */
+#define DEFINE_PERCENTILE_SELECT(_name, _type)                                          \
+  static int32_t _name##Compare(const void *p1, const void *p2) {                     \
+    _type v1 = *(const _type *)p1;                                                   \
+    _type v2 = *(const _type *)p2;                                                   \
+    return (v1 == v2) ? 0 : ((v1 < v2) ? -1 : 1);                                    \
+  }                                                                                  \
+                                                                                     \
+  static double _name(_type *a, int32_t num, int32_t k, double fraction) {           \
+    int32_t left = 0, right = num - 1;                                               \
+    int32_t depth = 2 * (int32_t)log2(num);                                          \
+                                                                                     \
+    while (right > left) {                                                           \
+      if (--depth < 0) {                                                             \
+        qsort(&a[left], right - left + 1, sizeof(_type), _name##Compare);            \
+        break;                                                                       \
+      }                                                                              \
+                                                                                     \
+      int32_t mid = left + ((right - left) >> 1);                                    \
+      _type   t;                                                                     \
+      if (a[mid] < a[left]) { t = a[mid]; a[mid] = a[left]; a[left] = t; }           \
+      if (a[right] < a[left]) { t = a[right]; a[right] = a[left]; a[left] = t; }     \
+      if (a[right] < a[mid]) { t = a[right]; a[right] = a[mid]; a[mid] = t; }        \
+                                                                                     \
+      _type   pivot = a[mid];                                                        \
+      int32_t i = left, j = right;                                                   \
+      while (i <= j) {                                                               \
+        while (a[i] < pivot) ++i;                                                    \
+        while (a[j] > pivot) --j;                                                    \
+        if (i <= j) {                                                                \
+          t = a[i]; a[i] = a[j]; a[j] = t;                                           \
+          ++i; --j;                                                                  \
+        }                                                                            \
+      }                                                                              \
+                                                                                     \
+      if (k <= j) {                                                                  \
+        right = j;                                                                   \
+      } else if (k >= i) {                                                           \
+        left = i;                                                                    \
+      } else {                                                                       \
+        break;                                                                       \
+      }                                                                              \
+    }                                                                                \
+                                                                                     \
+    double v = (double)a[k];                                                         \
+    if (fraction == 0 || k + 1 >= num) {                                             \
+      return v;                                                                      \
+    }                                                                                \
+                                                                                     \
+    _type next = a[k + 1];                                                           \
+    for (int32_t x = k + 2; x < num; ++x) {                                          \
+      if (a[x] < next) next = a[x];                                                  \
+    }                                                                                \
+                                                                                     \
+    return (1 - fraction) * v + fraction * (double)next;                             \
+  }
+
+DEFINE_PERCENTILE_SELECT(percentileSelectTinyInt, int8_t)
+DEFINE_PERCENTILE_SELECT(percentileSelectSmallInt, int16_t)
+DEFINE_PERCENTILE_SELECT(percentileSelectInt, int32_t)
+DEFINE_PERCENTILE_SELECT(percentileSelectBigInt, int64_t)
+DEFINE_PERCENTILE_SELECT(percentileSelectFloat, float)
+DEFINE_PERCENTILE_SELECT(percentileSelectDouble, double)
+
+static double getPercentileBySelect(tMemBucket *pMemBucket, int32_t k, double fraction) {
+  char *  p = pMemBucket->pSelBuf;
+  int32_t num = pMemBucket->numOfElems;
+
+  switch (pMemBucket->dataType) {
+    case TSDB_DATA_TYPE_TINYINT:  return percentileSelectTinyInt((int8_t *)p, num, k, fraction);
+    case TSDB_DATA_TYPE_SMALLINT: return percentileSelectSmallInt((int16_t *)p, num, k, fraction);
+    case TSDB_DATA_TYPE_INT:      return percentileSelectInt((int32_t *)p, num, k, fraction);
+    case TSDB_DATA_TYPE_BIGINT:   return percentileSelectBigInt((int64_t *)p, num, k, fraction);
+    case TSDB_DATA_TYPE_FLOAT:    return percentileSelectFloat((float *)p, num, k, fraction);
+    case TSDB_DATA_TYPE_DOUBLE:   return percentileSelectDouble((double *)p, num, k, fraction);
+    default:
+      return 0;
+  }
+}
+
 double getPercentile(tMemBucket *pMemBucket, double percent) {
   if (pMemBucket->numOfElems == 0) {
     return 0.0;
   }
 
+  if (pMemBucket->inMemSelect) {
+    percent = fabs(percent);
+
+    double  percentVal = (percent * (pMemBucket->numOfElems - 1)) / ((double)100.0);
+    int32_t orderIdx = MIN((int32_t)percentVal, pMemBucket->numOfElems - 1);
+    return getPercentileBySelect(pMemBucket, orderIdx, percentVal - orderIdx);
+  }
+
   if (pMemBucket->numOfElems == 1) {  // return the only element
     return findOnlyResult(pMemBucket);
   }
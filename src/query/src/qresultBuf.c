@@ -5,84 +5,178 @@
 #include "tsqlfunction.h"
 #include "queryLog.h"
 
-int32_t createDiskbasedResultBuffer(SDiskbasedResultBuf** pResultBuf, int32_t size, int32_t rowSize, void* handle) {
+#define NO_PAGE (-1)
+
+int32_t createDiskbasedResultBuffer(SDiskbasedResultBuf** pResultBuf, int32_t size, int32_t rowSize,
+                                    int64_t inMemBufSize, void* handle) {
   *pResultBuf = calloc(1, sizeof(SDiskbasedResultBuf));
   SDiskbasedResultBuf* pResBuf = *pResultBuf;
   if (pResBuf == NULL) {
-    return TSDB_CODE_COM_OUT_OF_MEMORY;  
+    return TSDB_CODE_COM_OUT_OF_MEMORY;
   }
-  
+
   pResBuf->numOfRowsPerPage = (DEFAULT_INTERN_BUF_PAGE_SIZE - sizeof(tFilePage)) / rowSize;
   pResBuf->numOfPages = size;
 
   pResBuf->totalBufSize = pResBuf->numOfPages * DEFAULT_INTERN_BUF_PAGE_SIZE;
   pResBuf->incStep = 4;
+  pResBuf->handle = handle;
+
+  pResBuf->inMemPages = (int32_t)(inMemBufSize / DEFAULT_INTERN_BUF_PAGE_SIZE);
+  if (pResBuf->inMemPages < MIN_INMEM_BUF_PAGES) {
+    pResBuf->inMemPages = MIN_INMEM_BUF_PAGES;
+  }
+
+  pResBuf->lruHead = NO_PAGE;
+  pResBuf->lruTail = NO_PAGE;
+  pResBuf->pageTable = calloc(size, sizeof(SPageInfo));
 
   // init id hash table
   pResBuf->idsTable = taosHashInit(size, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), false);
   pResBuf->list = calloc(size, sizeof(SIDList));
   pResBuf->numOfAllocGroupIds = size;
 
+  if (pResBuf->pageTable == NULL || pResBuf->idsTable == NULL || pResBuf->list == NULL) {
+    return TSDB_CODE_QRY_OUT_OF_MEMORY;
+  }
+
+  // the spill file is not created until the in-memory pages are exhausted
   char path[4096] = {0};
   getTmpfilePath("tsdb_q_buf", path);
   pResBuf->path = strdup(path);
+  pResBuf->fd = FD_INITIALIZER;
 
-  pResBuf->fd = open(pResBuf->path, O_CREAT | O_RDWR, 0666);
-  
-  memset(path, 0, tListLen(path));
+  qTrace("QInfo:%p create result buffer, %d pages at most in memory, tmp file:%s", handle, pResBuf->inMemPages,
+         pResBuf->path);
 
-  if (!FD_VALID(pResBuf->fd)) {
-    qError("failed to create tmp file: %s on disk. %s", pResBuf->path, strerror(errno));
-    return TSDB_CODE_QRY_NO_DISKSPACE;
+  return TSDB_CODE_SUCCESS;
+}
+
+int32_t getNumOfResultBufGroupId(SDiskbasedResultBuf* pResultBuf) { return taosHashGetSize(pResultBuf->idsTable); }
+
+int32_t getResBufSize(SDiskbasedResultBuf* pResultBuf) { return pResultBuf->totalBufSize; }
+
+static void lruListRemove(SDiskbasedResultBuf* pResultBuf, int32_t id) {
+  SPageInfo* pInfo = &pResultBuf->pageTable[id];
+
+  if (pInfo->prev != NO_PAGE) {
+    pResultBuf->pageTable[pInfo->prev].next = pInfo->next;
+  } else {
+    pResultBuf->lruHead = pInfo->next;
   }
 
-  int32_t ret = ftruncate(pResBuf->fd, pResBuf->numOfPages * DEFAULT_INTERN_BUF_PAGE_SIZE);
-  if (ret != TSDB_CODE_SUCCESS) {
-    qError("failed to create tmp file: %s on disk. %s", pResBuf->path, strerror(errno));
-    return TSDB_CODE_QRY_NO_DISKSPACE;
+  if (pInfo->next != NO_PAGE) {
+    pResultBuf->pageTable[pInfo->next].prev = pInfo->prev;
+  } else {
+    pResultBuf->lruTail = pInfo->prev;
   }
 
-  pResBuf->pBuf = mmap(NULL, pResBuf->totalBufSize, PROT_READ | PROT_WRITE, MAP_SHARED, pResBuf->fd, 0);
-  if (pResBuf->pBuf == MAP_FAILED) {
-    qError("QInfo:%p failed to map temp file: %s. %s", handle, pResBuf->path, strerror(errno));
-    return TSDB_CODE_QRY_OUT_OF_MEMORY; // todo change error code
+  pInfo->prev = NO_PAGE;
+  pInfo->next = NO_PAGE;
+}
+
+static void lruListPushFront(SDiskbasedResultBuf* pResultBuf, int32_t id) {
+  SPageInfo* pInfo = &pResultBuf->pageTable[id];
+
+  pInfo->prev = NO_PAGE;
+  pInfo->next = pResultBuf->lruHead;
+
+  if (pResultBuf->lruHead != NO_PAGE) {
+    pResultBuf->pageTable[pResultBuf->lruHead].prev = id;
+  } else {
+    pResultBuf->lruTail = id;
   }
 
-  qTrace("QInfo:%p create tmp file for output result, %s, %" PRId64 "bytes", handle, pResBuf->path,
-      pResBuf->totalBufSize);
-  
+  pResultBuf->lruHead = id;
+}
+
+static int32_t openSpillFile(SDiskbasedResultBuf* pResultBuf) {
+  pResultBuf->fd = open(pResultBuf->path, O_CREAT | O_RDWR | O_TRUNC, 0666);
+  if (!FD_VALID(pResultBuf->fd)) {
+    qError("QInfo:%p failed to create tmp file: %s on disk. %s", pResultBuf->handle, pResultBuf->path,
+           strerror(errno));
+    return TSDB_CODE_QRY_NO_DISKSPACE;
+  }
+
+  qTrace("QInfo:%p in-memory result buffer exhausted, create tmp file:%s", pResultBuf->handle, pResultBuf->path);
   return TSDB_CODE_SUCCESS;
 }
 
-int32_t getNumOfResultBufGroupId(SDiskbasedResultBuf* pResultBuf) { return taosHashGetSize(pResultBuf->idsTable); }
+/*
+ * evict the least recently used page that is not pinned, and return its memory for reuse
+ */
+static char* evictOnePage(SDiskbasedResultBuf* pResultBuf) {
+  int32_t id = pResultBuf->lruTail;
+  while (id != NO_PAGE && pResultBuf->pageTable[id].pinned > 0) {
+    id = pResultBuf->pageTable[id].prev;
+  }
 
-int32_t getResBufSize(SDiskbasedResultBuf* pResultBuf) { return pResultBuf->totalBufSize; }
+  if (id == NO_PAGE) {  // all pages in memory are pinned
+    return NULL;
+  }
 
-static int32_t extendDiskFileSize(SDiskbasedResultBuf* pResultBuf, int32_t numOfPages) {
-  assert(pResultBuf->numOfPages * DEFAULT_INTERN_BUF_PAGE_SIZE == pResultBuf->totalBufSize);
+  if (!FD_VALID(pResultBuf->fd) && openSpillFile(pResultBuf) != TSDB_CODE_SUCCESS) {
+    return NULL;
+  }
 
-  int32_t ret = munmap(pResultBuf->pBuf, pResultBuf->totalBufSize);
-  pResultBuf->numOfPages += numOfPages;
+  SPageInfo* pInfo = &pResultBuf->pageTable[id];
+  if (pInfo->offset < 0) {
+    pInfo->offset = pResultBuf->fileSize;
+    pResultBuf->fileSize += DEFAULT_INTERN_BUF_PAGE_SIZE;
+  }
 
-  /*
-   * disk-based output buffer is exhausted, try to extend the disk-based buffer, the available disk space may
-   * be insufficient
-   */
-  ret = ftruncate(pResultBuf->fd, pResultBuf->numOfPages * DEFAULT_INTERN_BUF_PAGE_SIZE);
-  if (ret != 0) {
-    //    dError("QInfo:%p failed to create intermediate result output file:%s. %s", pQInfo, pSupporter->extBufFile,
-    //           strerror(errno));
-    return TSDB_CODE_QRY_NO_DISKSPACE;
+  // the page may be updated through the pointer returned by getResBufPage, so always write it back
+  ssize_t ret = pwrite(pResultBuf->fd, pInfo->pData, DEFAULT_INTERN_BUF_PAGE_SIZE, pInfo->offset);
+  if (ret != DEFAULT_INTERN_BUF_PAGE_SIZE) {
+    qError("QInfo:%p failed to flush page:%d to tmp file: %s. %s", pResultBuf->handle, id, pResultBuf->path,
+           strerror(errno));
+    return NULL;
   }
 
-  pResultBuf->totalBufSize = pResultBuf->numOfPages * DEFAULT_INTERN_BUF_PAGE_SIZE;
-  pResultBuf->pBuf = mmap(NULL, pResultBuf->totalBufSize, PROT_READ | PROT_WRITE, MAP_SHARED, pResultBuf->fd, 0);
+  pResultBuf->statis.flushPages += 1;
+
+  char* pData = pInfo->pData;
+  pInfo->pData = NULL;
+  lruListRemove(pResultBuf, id);
+
+  return pData;
+}
+
+static char* allocPageBuf(SDiskbasedResultBuf* pResultBuf) {
+  if (pResultBuf->numOfInMemPages >= pResultBuf->inMemPages) {
+    char* pData = evictOnePage(pResultBuf);
+    if (pData != NULL) {
+      return pData;
+    }
 
-  if (pResultBuf->pBuf == MAP_FAILED) {
-    //    dError("QInfo:%p failed to map temp file: %s. %s", pQInfo, pSupporter->extBufFile, strerror(errno));
+    // go beyond the memory budget rather than abort the query, if no page can be evicted
+    qWarn("QInfo:%p no page can be evicted, %d pages in memory", pResultBuf->handle, pResultBuf->numOfInMemPages);
+  }
+
+  char* pData = malloc(DEFAULT_INTERN_BUF_PAGE_SIZE);
+  if (pData != NULL) {
+    pResultBuf->numOfInMemPages += 1;
+    if (pResultBuf->statis.maxInMemPages < pResultBuf->numOfInMemPages) {
+      pResultBuf->statis.maxInMemPages = pResultBuf->numOfInMemPages;
+    }
+  }
+
+  return pData;
+}
+
+static int32_t extendPageTable(SDiskbasedResultBuf* pResultBuf, int32_t numOfPages) {
+  int32_t    newSize = pResultBuf->numOfPages + numOfPages;
+  SPageInfo* p = realloc(pResultBuf->pageTable, sizeof(SPageInfo) * newSize);
+  if (p == NULL) {
     return TSDB_CODE_QRY_OUT_OF_MEMORY;
   }
 
+  memset(&p[pResultBuf->numOfPages], 0, sizeof(SPageInfo) * numOfPages);
+
+  pResultBuf->pageTable = p;
+  pResultBuf->numOfPages = newSize;
+  pResultBuf->totalBufSize = pResultBuf->numOfPages * DEFAULT_INTERN_BUF_PAGE_SIZE;
+
   return TSDB_CODE_SUCCESS;
 }
 
@@ -114,7 +208,7 @@ static int32_t addNewGroupId(SDiskbasedResultBuf* pResultBuf, int32_t groupId) {
     assert(p != NULL);
 
     memset(&p[pResultBuf->numOfAllocGroupIds], 0, sizeof(SIDList) * pResultBuf->numOfAllocGroupIds);
-    
+
     pResultBuf->list = p;
     pResultBuf->numOfAllocGroupIds = n;
   }
@@ -132,10 +226,10 @@ static int32_t doRegisterId(SIDList* pList, int32_t id) {
     } else {
       s = pList->alloc << 1u;
     }
-    
+
     int32_t* c = realloc(pList->pData, s * sizeof(int32_t));
     assert(c);
-    
+
     memset(&c[pList->alloc], 0, sizeof(int32_t) * pList->alloc);
 
     pList->pData = c;
@@ -158,23 +252,87 @@ static void registerPageId(SDiskbasedResultBuf* pResultBuf, int32_t groupId, int
 
 tFilePage* getNewDataBuf(SDiskbasedResultBuf* pResultBuf, int32_t groupId, int32_t* pageId) {
   if (noMoreAvailablePages(pResultBuf)) {
-    if (extendDiskFileSize(pResultBuf, pResultBuf->incStep) != TSDB_CODE_SUCCESS) {
+    int32_t inc = MAX(pResultBuf->incStep, pResultBuf->numOfPages);
+    if (extendPageTable(pResultBuf, inc) != TSDB_CODE_SUCCESS) {
       return NULL;
     }
   }
 
+  char* pData = allocPageBuf(pResultBuf);
+  if (pData == NULL) {
+    return NULL;
+  }
+
   // register new id in this group
   *pageId = (pResultBuf->allocateId++);
   registerPageId(pResultBuf, groupId, *pageId);
 
-  tFilePage* page = GET_RES_BUF_PAGE_BY_ID(pResultBuf, *pageId);
-  
+  SPageInfo* pInfo = &pResultBuf->pageTable[*pageId];
+  pInfo->pData = pData;
+  pInfo->offset = -1;
+  pInfo->pinned = 0;
+  lruListPushFront(pResultBuf, *pageId);
+
+  tFilePage* page = (tFilePage*)pData;
+
   // clear memory for the new page
   memset(page, 0, DEFAULT_INTERN_BUF_PAGE_SIZE);
-  
+
   return page;
 }
 
+tFilePage* getResBufPage(SDiskbasedResultBuf* pResultBuf, int32_t id) {
+  assert(id >= 0 && id < pResultBuf->allocateId);
+
+  SPageInfo* pInfo = &pResultBuf->pageTable[id];
+  if (pInfo->pData != NULL) {
+    if (pResultBuf->lruHead != id) {
+      lruListRemove(pResultBuf, id);
+      lruListPushFront(pResultBuf, id);
+    }
+
+    return (tFilePage*)pInfo->pData;
+  }
+
+  // the page has been evicted to spill file, load it
+  char* pData = allocPageBuf(pResultBuf);
+  if (pData == NULL) {
+    terrno = TSDB_CODE_QRY_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  assert(pInfo->offset >= 0);
+  ssize_t ret = pread(pResultBuf->fd, pData, DEFAULT_INTERN_BUF_PAGE_SIZE, pInfo->offset);
+  if (ret != DEFAULT_INTERN_BUF_PAGE_SIZE) {
+    terrno = TAOS_SYSTEM_ERROR(ret < 0 ? errno : EIO);
+    qError("QInfo:%p failed to load page:%d from tmp file: %s. %s", pResultBuf->handle, id, pResultBuf->path,
+           strerror(errno));
+    free(pData);
+    pResultBuf->numOfInMemPages -= 1;
+    return NULL;
+  }
+
+  pResultBuf->statis.loadPages += 1;
+
+  pInfo->pData = pData;
+  lruListPushFront(pResultBuf, id);
+
+  return (tFilePage*)pData;
+}
+
+void pinResBufPage(SDiskbasedResultBuf* pResultBuf, int32_t id) {
+  assert(id >= 0 && id < pResultBuf->allocateId);
+
+  // make sure the page is in memory before it is pinned
+  getResBufPage(pResultBuf, id);
+  pResultBuf->pageTable[id].pinned += 1;
+}
+
+void unpinResBufPage(SDiskbasedResultBuf* pResultBuf, int32_t id) {
+  assert(id >= 0 && id < pResultBuf->allocateId && pResultBuf->pageTable[id].pinned > 0);
+  pResultBuf->pageTable[id].pinned -= 1;
+}
+
 int32_t getNumOfRowsPerPage(SDiskbasedResultBuf* pResultBuf) { return pResultBuf->numOfRowsPerPage; }
 
 SIDList getDataBufPagesIdList(SDiskbasedResultBuf* pResultBuf, int32_t groupId) {
@@ -194,12 +352,19 @@ void destroyResultBuf(SDiskbasedResultBuf* pResultBuf, void* handle) {
 
   if (FD_VALID(pResultBuf->fd)) {
     close(pResultBuf->fd);
+    unlink(pResultBuf->path);
+  }
+
+  qTrace("QInfo:%p disk-based output buffer closed, %" PRId64 " bytes, max in-memory pages:%d, flush pages:%d, "
+         "load pages:%d, tmp file:%s, %" PRId64 " bytes", handle, pResultBuf->totalBufSize,
+         pResultBuf->statis.maxInMemPages, pResultBuf->statis.flushPages, pResultBuf->statis.loadPages,
+         pResultBuf->path, pResultBuf->fileSize);
+
+  for (int32_t i = 0; i < pResultBuf->allocateId; ++i) {
+    tfree(pResultBuf->pageTable[i].pData);
   }
 
-  qTrace("QInfo:%p disk-based output buffer closed, %" PRId64 " bytes, file:%s", handle, pResultBuf->totalBufSize, pResultBuf->path);
-  munmap(pResultBuf->pBuf, pResultBuf->totalBufSize);
-  unlink(pResultBuf->path);
-  
+  tfree(pResultBuf->pageTable);
   tfree(pResultBuf->path);
 
   for (int32_t i = 0; i < pResultBuf->numOfAllocGroupIds; ++i) {
@@ -209,7 +374,7 @@ void destroyResultBuf(SDiskbasedResultBuf* pResultBuf, void* handle) {
 
   tfree(pResultBuf->list);
   taosHashCleanup(pResultBuf->idsTable);
-  
+
   tfree(pResultBuf);
 }
 
@@ -217,7 +382,6 @@ int32_t getLastPageId(SIDList *pList) {
   if (pList == NULL || pList->size <= 0) {
     return -1;
   }
-  
+
   return pList->pData[pList->size - 1];
 }
-
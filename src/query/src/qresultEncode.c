@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+
+#include "qresultEncode.h"
+#include "taosdef.h"
+#include "tscompression.h"
+#include "tutil.h"
+
+// the output of codec may be a little larger than the input in the worst case
+#define ENCODE_BUF_SIZE(_raw) ((_raw) * 2 + 64)
+
+static bool isValidBoolColumn(const char *pData, int32_t numOfRows) {
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    if (pData[i] != 0 && pData[i] != 1 && (uint8_t)pData[i] != TSDB_DATA_BOOL_NULL) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/*
+ * remove the padding of var-length strings, return -1 if any value is not a valid var-length string
+ */
+static int32_t compactVarStrColumn(const SEncodeColumn *pCol, int32_t numOfRows, char *pBuf) {
+  int32_t len = 0;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    const char *pVal = pCol->pData + i * pCol->bytes;
+    if (varDataLen(pVal) < 0 || varDataTLen(pVal) > pCol->bytes) {
+      return -1;
+    }
+
+    memcpy(pBuf + len, pVal, varDataTLen(pVal));
+    len += varDataTLen(pVal);
+  }
+
+  return len;
+}
+
+static int32_t encodeColumn(const SEncodeColumn *pCol, int32_t numOfRows, char *pOutput, char *pBuf, char *pCompBuf) {
+  SResultColHead *pHead = (SResultColHead *)pOutput;
+  char *          pData = pOutput + sizeof(SResultColHead);
+
+  int32_t rawLen = pCol->bytes * numOfRows;
+  int32_t len = -1;
+  int8_t  encode = RESULT_ENCODE_RAW;
+
+  if (pBuf != NULL) {
+    if (pCol->type == TSDB_DATA_TYPE_BINARY || pCol->type == TSDB_DATA_TYPE_NCHAR) {
+      int32_t compactLen = pCol->varStr ? compactVarStrColumn(pCol, numOfRows, pCompBuf) : -1;
+      if (compactLen >= 0) {
+        len = tsCompressStringImp(pCompBuf, compactLen, pBuf, ENCODE_BUF_SIZE(rawLen));
+        encode = RESULT_ENCODE_VARSTR;
+      } else {
+        len = tsCompressStringImp(pCol->pData, rawLen, pBuf, ENCODE_BUF_SIZE(rawLen));
+        encode = RESULT_ENCODE_COMP;
+      }
+    } else if (pCol->type != TSDB_DATA_TYPE_BOOL || isValidBoolColumn(pCol->pData, numOfRows)) {
+      len = (*tDataTypeDesc[pCol->type].compFunc)(pCol->pData, rawLen, numOfRows, pBuf, ENCODE_BUF_SIZE(rawLen),
+                                                  ONE_STAGE_COMP, NULL, 0);
+      encode = RESULT_ENCODE_COMP;
+    }
+  }
+
+  if (len >= 0 && len < rawLen) {
+    memcpy(pData, pBuf, len);
+  } else {
+    len = rawLen;
+    encode = RESULT_ENCODE_RAW;
+    memcpy(pData, pCol->pData, rawLen);
+  }
+
+  pHead->type = (int8_t)pCol->type;
+  pHead->encode = encode;
+  pHead->reserved = 0;
+  pHead->bytes = htonl(pCol->bytes);
+  pHead->len = htonl(len);
+
+  return sizeof(SResultColHead) + len;
+}
+
+int32_t qGetEncodedResultMaxSize(const SEncodeColumn *pCols, int32_t numOfCols, int32_t numOfRows) {
+  int32_t size = sizeof(int32_t) + sizeof(SResultColHead) * numOfCols;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    size += pCols[i].bytes * numOfRows;
+  }
+
+  return size;
+}
+
+int32_t qEncodeResultBlock(const SEncodeColumn *pCols, int32_t numOfCols, int32_t numOfRows, char *pOutput) {
+  int32_t maxRawLen = 0;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    maxRawLen = MAX(maxRawLen, pCols[i].bytes * numOfRows);
+  }
+
+  // all columns are sent as is, if failed to allocate the buffer for encoding
+  char *pBuf = malloc(ENCODE_BUF_SIZE(maxRawLen) * 2);
+  char *pCompBuf = (pBuf == NULL) ? NULL : pBuf + ENCODE_BUF_SIZE(maxRawLen);
+
+  *(int32_t *)pOutput = htonl(numOfCols);
+  int32_t len = sizeof(int32_t);
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    len += encodeColumn(&pCols[i], numOfRows, pOutput + len, pBuf, pCompBuf);
+  }
+
+  tfree(pBuf);
+  return len;
+}
+
+int32_t qGetDecodedResultSize(const char *pInput, int32_t inputLen, int32_t numOfRows, int32_t *encodedLen) {
+  if (inputLen < sizeof(int32_t)) {
+    return -1;
+  }
+
+  int32_t numOfCols = htonl(*(int32_t *)pInput);
+  int32_t offset = sizeof(int32_t);
+  int32_t size = 0;
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    if (offset + sizeof(SResultColHead) > inputLen) {
+      return -1;
+    }
+
+    SResultColHead *pHead = (SResultColHead *)(pInput + offset);
+    offset += sizeof(SResultColHead) + htonl(pHead->len);
+    size += htonl(pHead->bytes) * numOfRows;
+  }
+
+  if (offset > inputLen) {
+    return -1;
+  }
+
+  *encodedLen = offset;
+  return size;
+}
+
+static int32_t decodeVarStrColumn(const char *pInput, int32_t len, int32_t bytes, int32_t numOfRows, char *pOutput) {
+  int32_t rawLen = bytes * numOfRows;
+  char *  pBuf = malloc(rawLen);
+  if (pBuf == NULL) {
+    return -1;
+  }
+
+  int32_t compactLen = tsDecompressStringImp(pInput, len, pBuf, rawLen);
+
+  int32_t offset = 0;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    char *pVal = pBuf + offset;
+    if (offset + VARSTR_HEADER_SIZE > compactLen || offset + varDataTLen(pVal) > compactLen) {
+      free(pBuf);
+      return -1;
+    }
+
+    memcpy(pOutput + i * bytes, pVal, varDataTLen(pVal));
+    offset += varDataTLen(pVal);
+  }
+
+  free(pBuf);
+  return 0;
+}
+
+int32_t qGetEncodedColumnLen(const char *pInput, int32_t *bytes) {
+  SResultColHead *pHead = (SResultColHead *)pInput;
+  *bytes = htonl(pHead->bytes);
+  return sizeof(SResultColHead) + htonl(pHead->len);
+}
+
+int32_t qDecodeResultColumn(const char *pInput, int32_t numOfRows, char *pOutput) {
+  SResultColHead *pHead = (SResultColHead *)pInput;
+  int32_t         bytes = htonl(pHead->bytes);
+  int32_t         len = htonl(pHead->len);
+  int32_t         rawLen = bytes * numOfRows;
+
+  pInput += sizeof(SResultColHead);
+
+  switch (pHead->encode) {
+    case RESULT_ENCODE_RAW:
+      memcpy(pOutput, pInput, rawLen);
+      return 0;
+    case RESULT_ENCODE_COMP:
+      if (!isValidDataType(pHead->type) || pHead->type == TSDB_DATA_TYPE_NULL) {
+        return -1;
+      }
+
+      (*tDataTypeDesc[pHead->type].decompFunc)(pInput, len, numOfRows, pOutput, rawLen, ONE_STAGE_COMP, NULL, 0);
+      return 0;
+    case RESULT_ENCODE_VARSTR:
+      return decodeVarStrColumn(pInput, len, bytes, numOfRows, pOutput);
+    default:
+      return -1;
+  }
+}
+
+int32_t qDecodeResultBlock(const char *pInput, int32_t numOfRows, char *pOutput) {
+  int32_t numOfCols = htonl(*(int32_t *)pInput);
+  pInput += sizeof(int32_t);
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    if (qDecodeResultColumn(pInput, numOfRows, pOutput) != 0) {
+      return -1;
+    }
+
+    int32_t bytes = 0;
+    pInput += qGetEncodedColumnLen(pInput, &bytes);
+    pOutput += bytes * numOfRows;
+  }
+
+  return 0;
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "os.h"
+
+#include "qtdigest.h"
+#include "tutil.h"
+
+/**
+ * implement the merging t-digest based on the paper:
+ * Ted Dunning, Otmar Ertl. Computing Extremely Accurate Quantiles Using t-Digests.
+ * https://arxiv.org/abs/1902.04023
+ */
+
+// scale function k1, and its inverse
+static FORCE_INLINE double tDigestScale(double compression, double q) {
+  return compression / (2 * M_PI) * asin(2 * q - 1);
+}
+
+static FORCE_INLINE double tDigestScaleInverse(double compression, double k) {
+  return (sin(k * (2 * M_PI) / compression) + 1) / 2;
+}
+
+/*
+ * the weight limit of the centroid starting at q, i.e., q of k(q) + 1. k is at most compression / 4, where q is 1,
+ * beyond which the inverse wraps around and shrinks the limit, so the tail centroids would never be merged
+ */
+static FORCE_INLINE double tDigestWeightLimit(double compression, double total, double q) {
+  double k = tDigestScale(compression, MIN(MAX(q, 0), 1)) + 1;
+  return total * tDigestScaleInverse(compression, MIN(k, compression / 4));
+}
+
+static int32_t centroidCompare(const void *p1, const void *p2) {
+  double m1 = ((const SCentroid *)p1)->mean;
+  double m2 = ((const SCentroid *)p2)->mean;
+
+  if (m1 == m2) {
+    return 0;
+  }
+
+  return (m1 < m2) ? -1 : 1;
+}
+
+STDigest *tDigestCreateFrom(void *pBuf, int32_t compression) {
+  STDigest *pDigest = (STDigest *)pBuf;
+  memset(pDigest, 0, sizeof(STDigest));
+
+  pDigest->compression = compression;
+  pDigest->maxEntries = TDIGEST_MAX_CENTROIDS(compression) + TDIGEST_BUFFER_CAPACITY(compression);
+  pDigest->min = DBL_MAX;
+  pDigest->max = -DBL_MAX;
+
+  return pDigest;
+}
+
+void tDigestCompress(STDigest *pDigest) {
+  if (pDigest->numOfBuffered == 0) {
+    return;
+  }
+
+  /*
+   * the unmerged values are placed right after the centroids, so sort them together and then
+   * merge the adjacent ones in place. The write position never goes beyond the read position.
+   */
+  int32_t    num = pDigest->numOfCentroids + pDigest->numOfBuffered;
+  SCentroid *elems = pDigest->elems;
+  qsort(elems, num, sizeof(SCentroid), centroidCompare);
+
+  double total = (double)pDigest->totalWeight;
+  double compression = pDigest->compression;
+
+  double  weightSoFar = 0;
+  double  weightLimit = tDigestWeightLimit(compression, total, 0);
+  int32_t n = 0;
+
+  SCentroid cur = elems[0];
+  for (int32_t i = 1; i < num; ++i) {
+    int64_t proposed = cur.weight + elems[i].weight;
+
+    if (weightSoFar + proposed <= weightLimit) {
+      cur.mean += (elems[i].mean - cur.mean) * elems[i].weight / proposed;
+      cur.weight = proposed;
+    } else {
+      weightSoFar += cur.weight;
+      elems[n++] = cur;
+
+      weightLimit = tDigestWeightLimit(compression, total, weightSoFar / total);
+      cur = elems[i];
+    }
+  }
+
+  elems[n++] = cur;
+
+  pDigest->numOfCentroids = n;
+  pDigest->numOfBuffered = 0;
+}
+
+// merge the value into the nearest one of the sorted centroids, used only if no slot is left after compression
+static void tDigestMergeNearest(STDigest *pDigest, double val, int64_t weight) {
+  SCentroid *elems = pDigest->elems;
+  int32_t    lo = 0;
+  int32_t    hi = pDigest->numOfCentroids - 1;
+
+  while (lo < hi) {
+    int32_t mid = (lo + hi) / 2;
+    if (elems[mid].mean < val) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  if (lo > 0 && val - elems[lo - 1].mean < elems[lo].mean - val) {
+    lo -= 1;
+  }
+
+  SCentroid *pNearest = &elems[lo];
+  pNearest->weight += weight;
+  pNearest->mean += (val - pNearest->mean) * weight / pNearest->weight;
+}
+
+void tDigestAddWeighted(STDigest *pDigest, double val, int64_t weight) {
+  if (pDigest->numOfCentroids + pDigest->numOfBuffered >= pDigest->maxEntries) {
+    tDigestCompress(pDigest);
+  }
+
+  if (pDigest->numOfCentroids >= pDigest->maxEntries) {
+    tDigestMergeNearest(pDigest, val, weight);
+  } else {
+    SCentroid *pEntry = &pDigest->elems[pDigest->numOfCentroids + pDigest->numOfBuffered];
+    pEntry->mean = val;
+    pEntry->weight = weight;
+    pDigest->numOfBuffered += 1;
+  }
+
+  pDigest->totalWeight += weight;
+
+  if (val < pDigest->min) {
+    pDigest->min = val;
+  }
+
+  if (val > pDigest->max) {
+    pDigest->max = val;
+  }
+}
+
+void tDigestAdd(STDigest *pDigest, double val) { tDigestAddWeighted(pDigest, val, 1); }
+
+void tDigestMerge(STDigest *pDst, const STDigest *pSrc) {
+  int32_t num = pSrc->numOfCentroids + pSrc->numOfBuffered;
+  if (num == 0) {
+    return;
+  }
+
+  // the destination may be an empty (even zero-filled) result buffer, take over the source directly
+  if (pDst->totalWeight == 0) {
+    memcpy(pDst, pSrc, TDIGEST_SIZE(pSrc->compression));
+    return;
+  }
+
+  for (int32_t i = 0; i < num; ++i) {
+    tDigestAddWeighted(pDst, pSrc->elems[i].mean, pSrc->elems[i].weight);
+  }
+
+  // the min/max of source may be different from the mean of its first/last centroid
+  pDst->min = MIN(pDst->min, pSrc->min);
+  pDst->max = MAX(pDst->max, pSrc->max);
+}
+
+double tDigestQuantile(STDigest *pDigest, double percent) {
+  tDigestCompress(pDigest);
+
+  int32_t    n = pDigest->numOfCentroids;
+  SCentroid *elems = pDigest->elems;
+  if (n == 0) {
+    return NAN;
+  }
+
+  double total = (double)pDigest->totalWeight;
+  double index = (percent / 100) * total;
+
+  if (n == 1 || index <= 0) {
+    return (index <= 0) ? pDigest->min : elems[0].mean;
+  } else if (index >= total) {
+    return pDigest->max;
+  }
+
+  // the left half of the first centroid, interpolate between min and the centroid
+  double half = elems[0].weight / 2.0;
+  if (index < half) {
+    return pDigest->min + (elems[0].mean - pDigest->min) * (index / half);
+  }
+
+  // interpolate between the mid points of the two adjacent centroids
+  double weightSoFar = half;
+  for (int32_t i = 0; i < n - 1; ++i) {
+    double delta = (elems[i].weight + elems[i + 1].weight) / 2.0;
+
+    if (weightSoFar + delta > index) {
+      double ratio = (index - weightSoFar) / delta;
+      return elems[i].mean + (elems[i + 1].mean - elems[i].mean) * ratio;
+    }
+
+    weightSoFar += delta;
+  }
+
+  // the right half of the last centroid, interpolate between the centroid and max
+  half = elems[n - 1].weight / 2.0;
+  double ratio = (index - weightSoFar) / half;
+  return elems[n - 1].mean + (pDigest->max - elems[n - 1].mean) * MIN(ratio, 1.0);
+}
@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+#include <cassert>
+#include <iostream>
+
+#include "taos.h"
+#include "qextbuffer.h"
+#include "tsched.h"
+#include "tsdb.h"
+#include "ttime.h"
+
+namespace {
+// two consecutive flushes are merged into one run, and loaded back page by page
+void mergeFlushoutTest() {
+  SSchema field = {0};
+  field.type = TSDB_DATA_TYPE_BIGINT;
+  field.bytes = sizeof(int64_t);
+
+  SColumnModel*  pModel = createColumnModel(&field, 1, 1000);
+  tExtMemBuffer* pMemBuffer = createExtMemBuffer(DEFAULT_PAGE_SIZE, sizeof(int64_t), pModel);
+  pMemBuffer->flushModel = MULTIPLE_APPEND_MODEL;
+
+  const int32_t numOfRows = pMemBuffer->numOfElemsPerPage;
+  int64_t*      data = (int64_t*)malloc(sizeof(int64_t) * numOfRows);
+
+  for (int32_t k = 0; k < 3; ++k) {
+    for (int32_t i = 0; i < numOfRows; ++i) {
+      data[i] = (int64_t)k * numOfRows + i;
+    }
+
+    ASSERT_GE(tExtMemBufferPut(pMemBuffer, data, numOfRows), 0);
+    ASSERT_EQ(tExtMemBufferFlush(pMemBuffer), 0);
+  }
+
+  ASSERT_EQ(pMemBuffer->fileMeta.flushoutData.nLength, 3);
+
+  tExtMemBufferMergeLastFlushout(pMemBuffer);
+  tExtMemBufferMergeLastFlushout(pMemBuffer);
+  ASSERT_EQ(pMemBuffer->fileMeta.flushoutData.nLength, 1);
+  ASSERT_EQ(pMemBuffer->fileMeta.flushoutData.pFlushoutInfo[0].numOfPages, 3);
+
+  // nothing to merge with only one flush-out data
+  tExtMemBufferMergeLastFlushout(pMemBuffer);
+  ASSERT_EQ(pMemBuffer->fileMeta.flushoutData.nLength, 1);
+
+  tFilePage* pPage = (tFilePage*)malloc(pMemBuffer->pageSize);
+  for (int32_t k = 0; k < 3; ++k) {
+    ASSERT_TRUE(tExtMemBufferLoadData(pMemBuffer, pPage, 0, k));
+    ASSERT_EQ(pPage->num, numOfRows);
+
+    int64_t* p = (int64_t*)pPage->data;
+    ASSERT_EQ(p[0], (int64_t)k * numOfRows);
+    ASSERT_EQ(p[numOfRows - 1], (int64_t)(k + 1) * numOfRows - 1);
+  }
+
+  free(pPage);
+  free(data);
+
+  destoryExtMemBuffer(pMemBuffer);
+  destroyColumnModel(pModel);
+}
+
+/*
+ * generate the sorted runs in the layout of the vnode results retrieved by the client, each page has the column stride
+ * of capacity. The timestamp column is the order column, and the second column keeps the original sequence of the row.
+ */
+void createSortedRuns(SColumnModel* pModel, int32_t capacity, int32_t numOfRuns, int32_t numOfPages,
+                      int32_t orderType, SSortedRun* pRuns) {
+  for (int32_t i = 0; i < numOfRuns; ++i) {
+    pRuns[i].numOfPages = numOfPages;
+    pRuns[i].pPages = (tFilePage**)calloc(numOfPages, POINTER_BYTES);
+
+    int64_t ts = rand() % 1000;
+    for (int32_t j = 0; j < numOfPages; ++j) {
+      tFilePage* pPage = (tFilePage*)malloc(sizeof(tFilePage) + capacity * pModel->rowSize);
+
+      // the last page of each flush may be not full
+      pPage->num = (j % 3 == 2) ? capacity / 2 : capacity;
+      for (int32_t k = 0; k < pPage->num; ++k) {
+        ts += rand() % 10;
+        ((int64_t*)pPage->data)[k] = (orderType == TSDB_ORDER_ASC) ? ts : -ts;
+        ((int64_t*)(pPage->data + sizeof(int64_t) * capacity))[k] = (int64_t)i * numOfPages * capacity + j * capacity + k;
+      }
+
+      pRuns[i].pPages[j] = pPage;
+    }
+  }
+}
+
+void destroySortedRuns(SSortedRun* pRuns, int32_t numOfRuns) {
+  for (int32_t i = 0; i < numOfRuns; ++i) {
+    for (int32_t j = 0; j < pRuns[i].numOfPages; ++j) {
+      free(pRuns[i].pPages[j]);
+    }
+
+    free(pRuns[i].pPages);
+  }
+}
+
+int64_t checkMergeResult(SArray* pPageList, int32_t capacity, int32_t orderType) {
+  int64_t numOfRows = 0;
+  int64_t prev = (orderType == TSDB_ORDER_ASC) ? INT64_MIN : INT64_MAX;
+
+  for (int32_t i = 0; i < taosArrayGetSize(pPageList); ++i) {
+    tFilePage* pPage = *(tFilePage**)taosArrayGet(pPageList, i);
+    EXPECT_GT(pPage->num, 0);
+
+    for (int32_t k = 0; k < pPage->num; ++k) {
+      int64_t ts = ((int64_t*)pPage->data)[k];
+      EXPECT_TRUE((orderType == TSDB_ORDER_ASC) ? (ts >= prev) : (ts <= prev));
+      prev = ts;
+    }
+
+    numOfRows += pPage->num;
+  }
+
+  return numOfRows;
+}
+
+void destroyPageList(SArray* pPageList) {
+  for (int32_t i = 0; i < taosArrayGetSize(pPageList); ++i) {
+    free(*(tFilePage**)taosArrayGet(pPageList, i));
+  }
+
+  taosArrayDestroy(pPageList);
+}
+
+SColumnModel* createMergeColumnModel(int32_t capacity) {
+  SSchema field[2] = {{0}};
+  field[0].type = TSDB_DATA_TYPE_TIMESTAMP;
+  field[0].bytes = sizeof(int64_t);
+  field[1].type = TSDB_DATA_TYPE_BIGINT;
+  field[1].bytes = sizeof(int64_t);
+
+  return createColumnModel(field, 2, capacity);
+}
+
+// the sorted runs are merged by key ranges, and the output is identical whether the ranges are merged in parallel
+void mergeSortedRunsTest(int32_t orderType) {
+  const int32_t capacity = 1000;
+  const int32_t numOfRuns = 7;
+  const int32_t numOfPages = 20;
+
+  SColumnModel*     pModel = createMergeColumnModel(capacity);
+  int32_t           orderIdx = 0;
+  tOrderDescriptor* pDesc = tOrderDesCreate(&orderIdx, 1, pModel, orderType);
+
+  srand(0);
+  SSortedRun pRuns[numOfRuns] = {{0}};
+  createSortedRuns(pModel, capacity, numOfRuns, numOfPages, orderType, pRuns);
+
+  int64_t total = 0;
+  for (int32_t i = 0; i < numOfRuns; ++i) {
+    for (int32_t j = 0; j < numOfPages; ++j) {
+      total += pRuns[i].pPages[j]->num;
+    }
+  }
+
+  void* pSched = taosInitScheduler(100, 4, "merge");
+
+  SArray* pSerial = (SArray*)taosArrayInit(4, POINTER_BYTES);
+  ASSERT_EQ(tColDataMergeSortedRuns(NULL, 1, pDesc, capacity, pRuns, numOfRuns, orderType, pSerial), 0);
+  ASSERT_EQ(checkMergeResult(pSerial, capacity, orderType), total);
+
+  for (int32_t numOfPartitions = 2; numOfPartitions <= 16; numOfPartitions *= 2) {
+    SArray* pParallel = (SArray*)taosArrayInit(4, POINTER_BYTES);
+    ASSERT_EQ(tColDataMergeSortedRuns(pSched, numOfPartitions, pDesc, capacity, pRuns, numOfRuns, orderType, pParallel), 0);
+    ASSERT_EQ(checkMergeResult(pParallel, capacity, orderType), total);
+
+    // every row appears exactly once in the output
+    char* pFlag = (char*)calloc(1, numOfRuns * numOfPages * capacity);
+    for (int32_t i = 0; i < taosArrayGetSize(pParallel); ++i) {
+      tFilePage* pPage = *(tFilePage**)taosArrayGet(pParallel, i);
+      for (int32_t k = 0; k < pPage->num; ++k) {
+        int64_t seq = ((int64_t*)(pPage->data + sizeof(int64_t) * capacity))[k];
+        ASSERT_EQ(pFlag[seq], 0);
+        pFlag[seq] = 1;
+      }
+    }
+
+    free(pFlag);
+    destroyPageList(pParallel);
+  }
+
+  destroyPageList(pSerial);
+  destroySortedRuns(pRuns, numOfRuns);
+
+  taosCleanUpScheduler(pSched);
+  tOrderDescDestroy(pDesc);
+}
+
+/*
+ * replay the sorted pages retrieved from the vnodes, and compare the time of merging all sorted runs by one thread
+ * and by several threads.
+ */
+void mergeSortedRunsPerfTest(int32_t numOfRuns) {
+  const int32_t capacity = (DEFAULT_PAGE_SIZE - sizeof(tFilePage)) / (sizeof(int64_t) * 2);
+  const int32_t numOfPages = 1024 / numOfRuns;
+  const int32_t numOfThreads = 4;
+
+  SColumnModel*     pModel = createMergeColumnModel(capacity);
+  int32_t           orderIdx = 0;
+  tOrderDescriptor* pDesc = tOrderDesCreate(&orderIdx, 1, pModel, TSDB_ORDER_ASC);
+
+  srand(0);
+  SSortedRun* pRuns = (SSortedRun*)calloc(numOfRuns, sizeof(SSortedRun));
+  createSortedRuns(pModel, capacity, numOfRuns, numOfPages, TSDB_ORDER_ASC, pRuns);
+
+  void* pSched = taosInitScheduler(100, numOfThreads - 1, "merge");
+
+  for (int32_t numOfPartitions = 1; numOfPartitions <= numOfThreads; numOfPartitions *= 2) {
+    SArray* pPageList = (SArray*)taosArrayInit(4, POINTER_BYTES);
+
+    int64_t st = taosGetTimestampUs();
+    tColDataMergeSortedRuns(pSched, numOfPartitions, pDesc, capacity, pRuns, numOfRuns, TSDB_ORDER_ASC, pPageList);
+    int64_t et = taosGetTimestampUs();
+
+    int64_t numOfRows = checkMergeResult(pPageList, capacity, TSDB_ORDER_ASC);
+    printf("%d sorted runs, %" PRId64 " rows, %d partitions, elapsed time:%" PRId64 " us, %.2f Mrows/sec\n", numOfRuns,
+           numOfRows, numOfPartitions, et - st, numOfRows / (double)(et - st));
+
+    destroyPageList(pPageList);
+  }
+
+  taosCleanUpScheduler(pSched);
+  destroySortedRuns(pRuns, numOfRuns);
+  free(pRuns);
+  tOrderDescDestroy(pDesc);
+}
+}  // namespace
+
+TEST(testCase, extMemBufferTest) {
+  mergeFlushoutTest();
+  mergeSortedRunsTest(TSDB_ORDER_ASC);
+  mergeSortedRunsTest(TSDB_ORDER_DESC);
+}
+
+TEST(testCase, extMemBufferPerfTest) {
+  mergeSortedRunsPerfTest(4);
+  mergeSortedRunsPerfTest(64);
+}
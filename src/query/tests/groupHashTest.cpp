@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+#include <sys/time.h>
+#include <cassert>
+#include <iostream>
+
+#include "taos.h"
+#include "hash.h"
+#include "qgrouphash.h"
+#include "ttime.h"
+
+namespace {
+void intKeyTest() {
+  SGroupHashObj* pHashObj = tGroupHashInit(16, TSDB_DATA_TYPE_BIGINT);
+  ASSERT_EQ(tGroupHashGetSize(pHashObj), 0);
+
+  // trigger the resize of hash table several times
+  for (int64_t i = -5000; i < 5000; ++i) {
+    ASSERT_EQ(tGroupHashPut(pHashObj, (const char*)&i, sizeof(int64_t), (int32_t)(i + 5000)), 0);
+  }
+
+  ASSERT_EQ(tGroupHashGetSize(pHashObj), 10000);
+
+  for (int64_t i = -5000; i < 5000; ++i) {
+    int32_t* p = tGroupHashGet(pHashObj, (const char*)&i, sizeof(int64_t));
+    ASSERT_TRUE(p != NULL);
+    ASSERT_EQ(*p, i + 5000);
+  }
+
+  int64_t k = 5000;
+  ASSERT_TRUE(tGroupHashGet(pHashObj, (const char*)&k, sizeof(int64_t)) == NULL);
+
+  // overwrite the existed key
+  k = 1;
+  tGroupHashPut(pHashObj, (const char*)&k, sizeof(int64_t), 1);
+  ASSERT_EQ(tGroupHashGetSize(pHashObj), 10000);
+  ASSERT_EQ(*tGroupHashGet(pHashObj, (const char*)&k, sizeof(int64_t)), 1);
+
+  // the remained keys must be reachable after backward shift deletion
+  for (int64_t i = -5000; i < 5000; i += 2) {
+    tGroupHashRemove(pHashObj, (const char*)&i, sizeof(int64_t));
+  }
+
+  ASSERT_EQ(tGroupHashGetSize(pHashObj), 5000);
+  for (int64_t i = -5000; i < 5000; ++i) {
+    int32_t* p = tGroupHashGet(pHashObj, (const char*)&i, sizeof(int64_t));
+    if (i % 2 == 0) {
+      ASSERT_TRUE(p == NULL);
+    } else {
+      ASSERT_TRUE(p != NULL);
+    }
+  }
+
+  tGroupHashClear(pHashObj);
+  ASSERT_EQ(tGroupHashGetSize(pHashObj), 0);
+  tGroupHashCleanup(pHashObj);
+}
+
+void smallIntKeyTest() {
+  SGroupHashObj* pHashObj = tGroupHashInit(4, TSDB_DATA_TYPE_TINYINT);
+
+  for (int32_t i = -128; i < 128; ++i) {
+    int8_t v = (int8_t)i;
+    tGroupHashPut(pHashObj, (const char*)&v, sizeof(int8_t), i + 128);
+  }
+
+  ASSERT_EQ(tGroupHashGetSize(pHashObj), 256);
+
+  int8_t v = -1;
+  ASSERT_EQ(*tGroupHashGet(pHashObj, (const char*)&v, sizeof(int8_t)), 127);
+  tGroupHashCleanup(pHashObj);
+}
+
+void binaryKeyTest() {
+  SGroupHashObj* pHashObj = tGroupHashInit(16, TSDB_DATA_TYPE_BINARY);
+
+  char key[32] = {0};
+  for (int32_t i = 0; i < 1000; ++i) {
+    memset(key, 0, tListLen(key));
+    sprintf(key, "%d_abc_%d", i, i);
+    tGroupHashPut(pHashObj, key, tListLen(key), i);
+  }
+
+  ASSERT_EQ(tGroupHashGetSize(pHashObj), 1000);
+
+  for (int32_t i = 0; i < 1000; i += 3) {
+    memset(key, 0, tListLen(key));
+    sprintf(key, "%d_abc_%d", i, i);
+    tGroupHashRemove(pHashObj, key, tListLen(key));
+  }
+
+  for (int32_t i = 0; i < 1000; ++i) {
+    memset(key, 0, tListLen(key));
+    sprintf(key, "%d_abc_%d", i, i);
+
+    int32_t* p = tGroupHashGet(pHashObj, key, tListLen(key));
+    if (i % 3 == 0) {
+      ASSERT_TRUE(p == NULL);
+    } else {
+      ASSERT_TRUE(p != NULL);
+      ASSERT_EQ(*p, i);
+    }
+  }
+
+  tGroupHashCleanup(pHashObj);
+}
+
+void batchGetTest() {
+  SGroupHashObj* pHashObj = tGroupHashInit(16, TSDB_DATA_TYPE_INT);
+
+  const int32_t numOfRows = 4096;
+  int32_t*      pData = (int32_t*)malloc(sizeof(int32_t) * numOfRows);
+  int32_t*      pVal = (int32_t*)malloc(sizeof(int32_t) * numOfRows);
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    pData[i] = i / 10;  // consecutive rows share the same key
+  }
+
+  for (int32_t i = 0; i < 100; ++i) {
+    tGroupHashPut(pHashObj, (const char*)&i, sizeof(int32_t), i * 2);
+  }
+
+  tGroupHashGetBatch(pHashObj, (const char*)pData, sizeof(int32_t), numOfRows, pVal);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    if (pData[i] < 100) {
+      ASSERT_EQ(pVal[i], pData[i] * 2);
+    } else {
+      ASSERT_EQ(pVal[i], -1);
+    }
+  }
+
+  free(pData);
+  free(pVal);
+  tGroupHashCleanup(pHashObj);
+}
+
+/*
+ * simulate the group by query on one integer column: one lookup for each row, and insert the new group.
+ * the row count is scaled down from 100M to keep the unit test in a reasonable time.
+ */
+void groupbyPerformanceTest(int32_t numOfGroups) {
+  const int32_t numOfRows = 10000000;
+  const int32_t blockSize = 4096;
+
+  int64_t* pData = (int64_t*)malloc(sizeof(int64_t) * numOfRows);
+  int32_t* pVal = (int32_t*)malloc(sizeof(int32_t) * blockSize);
+
+  srand(0);
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    pData[i] = rand() % numOfGroups;
+  }
+
+  SHashObj* pHashObj = (SHashObj*)taosHashInit(4096, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), false);
+
+  int64_t st = taosGetTimestampUs();
+  int32_t size = 0;
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    int32_t* p = (int32_t*)taosHashGet(pHashObj, (const char*)&pData[i], sizeof(int64_t));
+    if (p == NULL) {
+      taosHashPut(pHashObj, (const char*)&pData[i], sizeof(int64_t), (char*)&size, sizeof(int32_t));
+      size += 1;
+    }
+  }
+
+  int64_t et = taosGetTimestampUs();
+  printf("SHashObj, %d rows, %d groups, elapsed time:%" PRId64 " us, %.2f Mrows/sec\n", numOfRows, size, et - st,
+         numOfRows / (double)(et - st));
+  taosHashCleanup(pHashObj);
+
+  SGroupHashObj* pGroupHash = tGroupHashInit(4096, TSDB_DATA_TYPE_BIGINT);
+
+  st = taosGetTimestampUs();
+  size = 0;
+  for (int32_t start = 0; start < numOfRows; start += blockSize) {
+    int32_t num = MIN(blockSize, numOfRows - start);
+    tGroupHashGetBatch(pGroupHash, (const char*)&pData[start], sizeof(int64_t), num, pVal);
+
+    for (int32_t i = 0; i < num; ++i) {
+      if (pVal[i] < 0 && tGroupHashGet(pGroupHash, (const char*)&pData[start + i], sizeof(int64_t)) == NULL) {
+        tGroupHashPut(pGroupHash, (const char*)&pData[start + i], sizeof(int64_t), size);
+        size += 1;
+      }
+    }
+  }
+
+  et = taosGetTimestampUs();
+  printf("SGroupHashObj, %d rows, %d groups, elapsed time:%" PRId64 " us, %.2f Mrows/sec\n", numOfRows, size,
+         et - st, numOfRows / (double)(et - st));
+  tGroupHashCleanup(pGroupHash);
+
+  free(pData);
+  free(pVal);
+}
+}  // namespace
+
+TEST(testCase, groupHashTest) {
+  intKeyTest();
+  smallIntKeyTest();
+  binaryKeyTest();
+  batchGetTest();
+}
+
+TEST(testCase, groupHashPerfTest) {
+  groupbyPerformanceTest(16);       // low cardinality
+  groupbyPerformanceTest(1000000);  // high cardinality
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+#include "taos.h"
+#include "qpercentile.h"
+#include "ttime.h"
+
+namespace {
+tMemBucket* createBucket(int16_t type, int16_t bytes, int64_t maxSelBufSize) {
+  SSchema       field[1] = {{(uint8_t)type, "k", 0, bytes}};
+  SColumnModel* pModel = createColumnModel(field, 1, 1000);
+
+  int32_t           orderIdx = 0;
+  tOrderDescriptor* pDesc = tOrderDesCreate(&orderIdx, 1, pModel, TSDB_ORDER_DESC);
+  return tMemBucketCreate(1024, 1 << 20, maxSelBufSize, bytes, type, pDesc);
+}
+
+void destroyBucket(tMemBucket* pBucket) {
+  tOrderDescDestroy(pBucket->pOrderDesc);
+  tMemBucketDestroy(pBucket);
+}
+
+// the exact percentile by sorting all values, interpolated between the two adjacent values
+template <typename T>
+double exactPercentile(std::vector<T> v, double percent) {
+  std::sort(v.begin(), v.end());
+
+  double  percentVal = (percent * (v.size() - 1)) / 100.0;
+  int32_t idx = (int32_t)percentVal;
+  if (idx + 1 >= (int32_t)v.size()) {
+    return (double)v[idx];
+  }
+
+  double fraction = percentVal - idx;
+  return (1 - fraction) * (double)v[idx] + fraction * (double)v[idx + 1];
+}
+
+template <typename T>
+void selectTest(int16_t type, int32_t num, int32_t range) {
+  std::vector<T> data(num);
+  for (int32_t i = 0; i < num; ++i) {
+    data[i] = (T)(rand() % range - range / 2);
+  }
+
+  double percents[] = {0, 1, 25, 50, 75, 99, 99.9, 100};
+  for (int32_t i = 0; i < tListLen(percents); ++i) {
+    tMemBucket* pBucket = createBucket(type, sizeof(T), 1L << 30);
+    tMemBucketPut(pBucket, &data[0], num);
+    ASSERT_TRUE(pBucket->inMemSelect);
+
+    ASSERT_DOUBLE_EQ(getPercentile(pBucket, percents[i]), exactPercentile(data, percents[i]));
+    destroyBucket(pBucket);
+  }
+}
+
+// the values are moved into buckets once the selection buffer is full, the result remains the same
+void spillTest() {
+  const int32_t        num = 100000;
+  std::vector<int32_t> data(num);
+
+  tMemBucket* pBucket = createBucket(TSDB_DATA_TYPE_INT, sizeof(int32_t), 4096 * sizeof(int32_t));
+  for (int32_t i = 0; i < num; ++i) {
+    data[i] = rand() % 1000;
+    tMemBucketPut(pBucket, &data[i], 1);
+  }
+
+  ASSERT_FALSE(pBucket->inMemSelect);
+  ASSERT_TRUE(pBucket->pSelBuf == NULL);
+  ASSERT_EQ(pBucket->numOfElems, num);
+  ASSERT_DOUBLE_EQ(getPercentile(pBucket, 50), exactPercentile(data, 50));
+  destroyBucket(pBucket);
+}
+
+// compare the selection with the bucket on the values of one table, the row count is scaled down since the
+// bucket is too slow
+void percentilePerfTest() {
+  const int32_t       num = 200000;
+  std::vector<double> data(num);
+
+  srand(0);
+  for (int32_t i = 0; i < num; ++i) {
+    data[i] = rand() / (double)RAND_MAX * 10000;
+  }
+
+  int64_t maxSelBufSize[] = {1L << 30, 0};
+  double  res[2] = {0};
+
+  for (int32_t i = 0; i < 2; ++i) {
+    int64_t     st = taosGetTimestampUs();
+    tMemBucket* pBucket = createBucket(TSDB_DATA_TYPE_DOUBLE, sizeof(double), maxSelBufSize[i]);
+
+    for (int32_t j = 0; j < num; ++j) {
+      tMemBucketPut(pBucket, &data[j], 1);
+    }
+
+    res[i] = getPercentile(pBucket, 99);
+    int64_t et = taosGetTimestampUs();
+
+    printf("%s, %d values, p99:%f, elapsed time:%" PRId64 " us\n", (i == 0) ? "select" : "bucket", num, res[i],
+           et - st);
+    destroyBucket(pBucket);
+  }
+
+  ASSERT_DOUBLE_EQ(res[0], exactPercentile(data, 99));
+}
+}  // namespace
+
+TEST(testCase, percentileTest) {
+  selectTest<int8_t>(TSDB_DATA_TYPE_TINYINT, 10000, 200);
+  selectTest<int16_t>(TSDB_DATA_TYPE_SMALLINT, 10000, 20000);
+  selectTest<int32_t>(TSDB_DATA_TYPE_INT, 100000, 10);  // lots of duplicated values
+  selectTest<int64_t>(TSDB_DATA_TYPE_BIGINT, 100000, 1000000);
+  selectTest<float>(TSDB_DATA_TYPE_FLOAT, 100000, 1000000);
+  selectTest<double>(TSDB_DATA_TYPE_DOUBLE, 1, 100);
+  selectTest<double>(TSDB_DATA_TYPE_DOUBLE, 100001, 1000000);
+  spillTest();
+}
+
+TEST(testCase, percentilePerfTest) { percentilePerfTest(); }
@@ -3,6 +3,7 @@
 #include <iostream>
 
 #include "taos.h"
+#include "taoserror.h"
 #include "qresultBuf.h"
 #include "tsdb.h"
 
@@ -10,26 +11,111 @@ namespace {
 // simple test
 void simpleTest() {
   SDiskbasedResultBuf* pResultBuf = NULL;
-  int32_t ret = createDiskbasedResultBuffer(&pResultBuf, 1000, 64, NULL);
-  
+  int32_t ret = createDiskbasedResultBuffer(&pResultBuf, 1000, 64, 1024 * 1024, NULL);
+  ASSERT_EQ(ret, 0);
+
   int32_t pageId = 0;
   int32_t groupId = 0;
-  
+
   tFilePage* pBufPage = getNewDataBuf(pResultBuf, groupId, &pageId);
   ASSERT_TRUE(pBufPage != NULL);
-  
-  ASSERT_EQ(getNumOfRowsPerPage(pResultBuf), (16384L - sizeof(int64_t))/64);
-  ASSERT_EQ(getResBufSize(pResultBuf), 1000*16384L);
-  
+
+  ASSERT_EQ(getNumOfRowsPerPage(pResultBuf), (DEFAULT_INTERN_BUF_PAGE_SIZE - sizeof(int64_t))/64);
+  ASSERT_EQ(getResBufSize(pResultBuf), 1000*DEFAULT_INTERN_BUF_PAGE_SIZE);
+
   SIDList list = getDataBufPagesIdList(pResultBuf, groupId);
   ASSERT_EQ(list.size, 1);
-  
+
   ASSERT_EQ(getNumOfResultBufGroupId(pResultBuf), 1);
-  
+
+  destroyResultBuf(pResultBuf, NULL);
+}
+
+// pages beyond the in-memory buffer size are evicted to disk, and loaded back when accessed
+void evictTest() {
+  SDiskbasedResultBuf* pResultBuf = NULL;
+  int32_t ret = createDiskbasedResultBuffer(&pResultBuf, 4, 64, MIN_INMEM_BUF_PAGES * DEFAULT_INTERN_BUF_PAGE_SIZE, NULL);
+  ASSERT_EQ(ret, 0);
+
+  const int32_t numOfPages = MIN_INMEM_BUF_PAGES * 4;
+  int32_t pageId = 0;
+
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    tFilePage* pBufPage = getNewDataBuf(pResultBuf, i % 3, &pageId);
+    ASSERT_TRUE(pBufPage != NULL);
+    ASSERT_EQ(pageId, i);
+
+    pBufPage->num = i;
+    memset(pBufPage->data, i, DEFAULT_INTERN_BUF_PAGE_SIZE - sizeof(tFilePage));
+
+    if (i == 0) {
+      pinResBufPage(pResultBuf, pageId);
+    }
+  }
+
+  ASSERT_EQ(pResultBuf->numOfInMemPages, MIN_INMEM_BUF_PAGES);
+  ASSERT_EQ(pResultBuf->statis.flushPages, numOfPages - MIN_INMEM_BUF_PAGES);
+
+  // the pinned page is never evicted
+  ASSERT_TRUE(pResultBuf->pageTable[0].pData != NULL);
+  unpinResBufPage(pResultBuf, 0);
+
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    tFilePage* pBufPage = getResBufPage(pResultBuf, i);
+    ASSERT_TRUE(pBufPage != NULL);
+    ASSERT_EQ(pBufPage->num, i);
+    ASSERT_EQ(pBufPage->data[100], (char) i);
+  }
+
+  ASSERT_GT(pResultBuf->statis.loadPages, 0);
+  ASSERT_EQ(pResultBuf->statis.maxInMemPages, MIN_INMEM_BUF_PAGES);
+
+  SIDList list = getDataBufPagesIdList(pResultBuf, 1);
+  ASSERT_EQ(list.size, (numOfPages + 1) / 3);
+
+  destroyResultBuf(pResultBuf, NULL);
+}
+
+// a page that fails to be loaded from the spill file is returned as NULL, with terrno set
+void loadFailTest() {
+  SDiskbasedResultBuf* pResultBuf = NULL;
+  int32_t ret = createDiskbasedResultBuffer(&pResultBuf, 4, 64, MIN_INMEM_BUF_PAGES * DEFAULT_INTERN_BUF_PAGE_SIZE, NULL);
+  ASSERT_EQ(ret, 0);
+
+  const int32_t numOfPages = MIN_INMEM_BUF_PAGES * 2;
+  int32_t pageId = 0;
+
+  for (int32_t i = 0; i < numOfPages; ++i) {
+    tFilePage* pBufPage = getNewDataBuf(pResultBuf, 0, &pageId);
+    ASSERT_TRUE(pBufPage != NULL);
+    pBufPage->num = i;
+  }
+
+  int32_t evicted = -1;
+  for (int32_t i = 0; i < numOfPages && evicted < 0; ++i) {
+    if (pResultBuf->pageTable[i].pData == NULL) evicted = i;
+  }
+  ASSERT_GE(evicted, 0);
+
+  // pages are still written to the spill file, but fail to be read from it
+  int32_t fd = open(pResultBuf->path, O_WRONLY);
+  ASSERT_GE(fd, 0);
+  ASSERT_GE(dup2(fd, pResultBuf->fd), 0);
+  close(fd);
+
+  int32_t numOfInMemPages = pResultBuf->numOfInMemPages;
+  terrno = 0;
+  ASSERT_TRUE(getResBufPage(pResultBuf, evicted) == NULL);
+  ASSERT_EQ(terrno, TAOS_SYSTEM_ERROR(EBADF));
+  ASSERT_EQ(pResultBuf->numOfInMemPages, numOfInMemPages - 1);
+  ASSERT_TRUE(pResultBuf->pageTable[evicted].pData == NULL);
+
   destroyResultBuf(pResultBuf, NULL);
 }
 } // namespace
 
 TEST(testCase, resultBufferTest) {
   simpleTest();
+  evictTest();
+  loadFailTest();
 }
@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include <cassert>
+#include <iostream>
+
+#include "taos.h"
+#include "qresultEncode.h"
+#include "taosdef.h"
+#include "ttime.h"
+
+namespace {
+const int32_t numOfCols = 5;
+const int32_t binaryBytes = 64 + VARSTR_HEADER_SIZE;
+
+// the typical result of projection query: ts, int, double, bool, binary(64)
+void createBlock(SEncodeColumn* pCols, int32_t numOfRows) {
+  int16_t types[] = {TSDB_DATA_TYPE_TIMESTAMP, TSDB_DATA_TYPE_INT, TSDB_DATA_TYPE_DOUBLE, TSDB_DATA_TYPE_BOOL,
+                     TSDB_DATA_TYPE_BINARY};
+  int32_t bytes[] = {sizeof(int64_t), sizeof(int32_t), sizeof(double), sizeof(int8_t), binaryBytes};
+
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    pCols[i].type = types[i];
+    pCols[i].bytes = bytes[i];
+    pCols[i].varStr = (types[i] == TSDB_DATA_TYPE_BINARY);
+    pCols[i].pData = (char*)calloc(numOfRows, bytes[i]);
+  }
+
+  srand(0);
+  int64_t* ts = (int64_t*)pCols[0].pData;
+  int32_t* iv = (int32_t*)pCols[1].pData;
+  double*  dv = (double*)pCols[2].pData;
+  int8_t*  bv = (int8_t*)pCols[3].pData;
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    ts[i] = 1500000000000L + i * 1000L;
+    iv[i] = rand() % 100;
+    dv[i] = 20 + (rand() % 1000) / 100.0;
+    bv[i] = (i % 10 == 0) ? TSDB_DATA_BOOL_NULL : (rand() % 2);
+
+    char* pVal = (char*)pCols[4].pData + i * binaryBytes;
+    int32_t len = sprintf((char*)varDataVal(pVal), "device_%d", rand() % 1000);
+    varDataSetLen(pVal, len);
+  }
+
+  setNull((char*)&iv[3], TSDB_DATA_TYPE_INT, sizeof(int32_t));
+  setVardataNull((char*)pCols[4].pData + 5 * binaryBytes, TSDB_DATA_TYPE_BINARY);
+}
+
+void destroyBlock(SEncodeColumn* pCols) {
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    free((void*)pCols[i].pData);
+  }
+}
+
+void encodeTest(int32_t numOfRows) {
+  SEncodeColumn cols[numOfCols];
+  createBlock(cols, numOfRows);
+
+  int32_t maxSize = qGetEncodedResultMaxSize(cols, numOfCols, numOfRows);
+  char*   pEncoded = (char*)malloc(maxSize);
+
+  int32_t len = qEncodeResultBlock(cols, numOfCols, numOfRows, pEncoded);
+  ASSERT_LE(len, maxSize);
+
+  int32_t encodedLen = 0;
+  int32_t size = qGetDecodedResultSize(pEncoded, len, numOfRows, &encodedLen);
+  ASSERT_EQ(encodedLen, len);
+  ASSERT_EQ(size, maxSize - sizeof(int32_t) - sizeof(SResultColHead) * numOfCols);
+
+  char* pDecoded = (char*)calloc(1, size);
+  ASSERT_EQ(qDecodeResultBlock(pEncoded, numOfRows, pDecoded), 0);
+
+  // the decoded column is identical to the original one, except the padding of var-length string
+  char* p = pDecoded;
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    if (cols[i].type == TSDB_DATA_TYPE_BINARY) {
+      for (int32_t j = 0; j < numOfRows; ++j) {
+        const char* pVal = cols[i].pData + j * cols[i].bytes;
+        ASSERT_EQ(memcmp(p + j * cols[i].bytes, pVal, varDataTLen(pVal)), 0);
+      }
+    } else {
+      ASSERT_EQ(memcmp(p, cols[i].pData, cols[i].bytes * numOfRows), 0);
+    }
+
+    p += cols[i].bytes * numOfRows;
+  }
+
+  // the columns decoded one by one in reverse order are the same as the ones decoded as a whole
+  const char* pHeads[numOfCols];
+  const char* pInput = pEncoded + sizeof(int32_t);
+  for (int32_t i = 0; i < numOfCols; ++i) {
+    int32_t bytes = 0;
+    pHeads[i] = pInput;
+    pInput += qGetEncodedColumnLen(pInput, &bytes);
+    ASSERT_EQ(bytes, cols[i].bytes);
+  }
+
+  char*   pColumn = (char*)calloc(1, size);
+  int32_t offset = size;
+  for (int32_t i = numOfCols - 1; i >= 0; --i) {
+    offset -= cols[i].bytes * numOfRows;
+    ASSERT_EQ(qDecodeResultColumn(pHeads[i], numOfRows, pColumn + offset), 0);
+  }
+
+  ASSERT_EQ(memcmp(pColumn, pDecoded, size), 0);
+  free(pColumn);
+
+  // the truncated input is rejected
+  ASSERT_EQ(qGetDecodedResultSize(pEncoded, len / 2, numOfRows, &encodedLen), -1);
+
+  free(pEncoded);
+  free(pDecoded);
+  destroyBlock(cols);
+}
+
+// the binary column which is not var-length string is compressed as a whole
+void nonVarStrTest() {
+  const int32_t numOfRows = 100;
+  char*         pData = (char*)malloc(numOfRows * 32);
+  for (int32_t i = 0; i < numOfRows * 32; ++i) {
+    pData[i] = (char)(i % 7);
+  }
+
+  SEncodeColumn col = {TSDB_DATA_TYPE_BINARY, 32, false, pData};
+  char*         pEncoded = (char*)malloc(qGetEncodedResultMaxSize(&col, 1, numOfRows));
+  qEncodeResultBlock(&col, 1, numOfRows, pEncoded);
+
+  char* pDecoded = (char*)malloc(numOfRows * 32);
+  ASSERT_EQ(qDecodeResultBlock(pEncoded, numOfRows, pDecoded), 0);
+  ASSERT_EQ(memcmp(pData, pDecoded, numOfRows * 32), 0);
+
+  free(pData);
+  free(pEncoded);
+  free(pDecoded);
+}
+
+void encodePerfTest() {
+  const int32_t numOfRows = 4096;
+  const int32_t loops = 200;
+
+  SEncodeColumn cols[numOfCols];
+  createBlock(cols, numOfRows);
+
+  int32_t maxSize = qGetEncodedResultMaxSize(cols, numOfCols, numOfRows);
+  char*   pEncoded = (char*)malloc(maxSize);
+  char*   pDecoded = (char*)malloc(maxSize);
+
+  int32_t len = 0;
+  int64_t st = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) {
+    len = qEncodeResultBlock(cols, numOfCols, numOfRows, pEncoded);
+  }
+  int64_t encodeTime = taosGetTimestampUs() - st;
+
+  st = taosGetTimestampUs();
+  for (int32_t i = 0; i < loops; ++i) {
+    qDecodeResultBlock(pEncoded, numOfRows, pDecoded);
+  }
+  int64_t decodeTime = taosGetTimestampUs() - st;
+
+  int32_t rawSize = maxSize - sizeof(int32_t) - sizeof(SResultColHead) * numOfCols;
+  printf("%d rows, raw:%.1f bytes/row, encoded:%.1f bytes/row, encode:%.2f Mrows/sec, decode:%.2f Mrows/sec\n",
+         numOfRows, rawSize / (double)numOfRows, len / (double)numOfRows,
+         numOfRows * loops / (double)encodeTime, numOfRows * loops / (double)decodeTime);
+
+  ASSERT_LT(len, rawSize / 4);
+
+  free(pEncoded);
+  free(pDecoded);
+  destroyBlock(cols);
+}
+}  // namespace
+
+TEST(testCase, resultEncodeTest) {
+  encodeTest(1);
+  encodeTest(RESULT_ENCODE_MIN_ROWS);
+  encodeTest(4096);
+  nonVarStrTest();
+  encodePerfTest();
+}
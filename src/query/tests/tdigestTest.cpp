@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+#include "taos.h"
+#include "qhistogram.h"
+#include "qtdigest.h"
+#include "ttime.h"
+
+namespace {
+STDigest* createDigest() {
+  void* pBuf = malloc(TDIGEST_SIZE(TDIGEST_COMPRESSION));
+  return tDigestCreateFrom(pBuf, TDIGEST_COMPRESSION);
+}
+
+// the exact value of the percentile, the same definition with tDigestQuantile
+double exactQuantile(const double* pSorted, int32_t num, double percent) {
+  int32_t idx = (int32_t)((percent / 100) * num);
+  return pSorted[std::min(idx, num - 1)];
+}
+
+// the error is measured by the rank of the estimated value, i.e., |q(estimated) - q|
+double rankError(const double* pSorted, int32_t num, double percent, double v) {
+  int64_t rank = std::lower_bound(pSorted, pSorted + num, v) - pSorted;
+  return fabs(rank / (double)num - percent / 100);
+}
+
+void simpleTest() {
+  STDigest* pDigest = createDigest();
+  ASSERT_TRUE(isnan(tDigestQuantile(pDigest, 50)));
+
+  tDigestAdd(pDigest, 10);
+  ASSERT_EQ(tDigestQuantile(pDigest, 0), 10);
+  ASSERT_EQ(tDigestQuantile(pDigest, 50), 10);
+  ASSERT_EQ(tDigestQuantile(pDigest, 100), 10);
+
+  for (int32_t i = 1; i <= 100000; ++i) {
+    tDigestAdd(pDigest, i);
+  }
+
+  ASSERT_EQ(pDigest->totalWeight, 100001);
+  ASSERT_EQ(tDigestQuantile(pDigest, 0), 1);
+  ASSERT_EQ(tDigestQuantile(pDigest, 100), 100000);
+  ASSERT_NEAR(tDigestQuantile(pDigest, 50), 50000, 500);
+  ASSERT_NEAR(tDigestQuantile(pDigest, 99), 99000, 100);
+  ASSERT_NEAR(tDigestQuantile(pDigest, 99.9), 99900, 20);
+
+  // the number of centroids is bounded by the compression
+  ASSERT_LE(pDigest->numOfCentroids, TDIGEST_COMPRESSION);
+  free(pDigest);
+}
+
+// the result of merged digests is close to the one built from all values
+void mergeTest() {
+  const int32_t numOfDigests = 10;
+  const int32_t num = 100000;
+
+  STDigest* pDst = createDigest();
+  double*   pData = (double*)malloc(sizeof(double) * num * numOfDigests);
+
+  srand(0);
+  for (int32_t i = 0; i < numOfDigests; ++i) {
+    STDigest* pSrc = createDigest();
+    for (int32_t j = 0; j < num; ++j) {
+      double v = rand() / (double)RAND_MAX * (i + 1);
+      pData[i * num + j] = v;
+      tDigestAdd(pSrc, v);
+    }
+
+    // the digest is copied as the intermediate result from vnode
+    STDigest* pCopy = (STDigest*)malloc(TDIGEST_SIZE(TDIGEST_COMPRESSION));
+    memcpy(pCopy, pSrc, TDIGEST_SIZE(TDIGEST_COMPRESSION));
+
+    tDigestMerge(pDst, pCopy);
+    free(pSrc);
+    free(pCopy);
+  }
+
+  std::sort(pData, pData + num * numOfDigests);
+  ASSERT_EQ(pDst->totalWeight, num * numOfDigests);
+  ASSERT_EQ(tDigestQuantile(pDst, 0), pData[0]);
+  ASSERT_EQ(tDigestQuantile(pDst, 100), pData[num * numOfDigests - 1]);
+
+  double percents[] = {1, 10, 50, 90, 99, 99.9};
+  for (int32_t i = 0; i < tListLen(percents); ++i) {
+    double v = tDigestQuantile(pDst, percents[i]);
+    ASSERT_LT(rankError(pData, num * numOfDigests, percents[i], v), 0.005);
+  }
+
+  free(pData);
+  free(pDst);
+}
+
+/*
+ * on sorted values the tail centroids used to be never merged, so the compression freed no slot and the values were
+ * written beyond the buffer. The number of centroids shall stay bounded by the compression.
+ */
+void sortedTest(bool ascending) {
+  const int64_t start = 10000000;
+  const int64_t num = 4000000;
+
+  STDigest* pDigest = createDigest();
+  for (int64_t i = 0; i < num; ++i) {
+    tDigestAdd(pDigest, (double)(ascending ? start + i : start + num - 1 - i));
+
+    ASSERT_LE(pDigest->numOfCentroids + pDigest->numOfBuffered, pDigest->maxEntries);
+    ASSERT_LE(pDigest->numOfCentroids, TDIGEST_COMPRESSION);
+  }
+
+  ASSERT_EQ(pDigest->totalWeight, num);
+  ASSERT_EQ(tDigestQuantile(pDigest, 0), start);
+  ASSERT_EQ(tDigestQuantile(pDigest, 100), start + num - 1);
+  ASSERT_NEAR(tDigestQuantile(pDigest, 50), start + num / 2, num * 0.001);
+  ASSERT_NEAR(tDigestQuantile(pDigest, 99), start + num * 0.99, num * 0.001);
+  free(pDigest);
+}
+
+/*
+ * compare the throughput and the tail accuracy of t-digest with the histogram, on the
+ * uniform and the long-tail (exponential) distributions.
+ */
+void compareWithHistogram(bool longTail) {
+  const int32_t num = 1000000;
+  double*       pData = (double*)malloc(sizeof(double) * num);
+
+  srand(0);
+  for (int32_t i = 0; i < num; ++i) {
+    double r = (rand() + 1.0) / ((double)RAND_MAX + 2.0);
+    pData[i] = longTail ? -log(r) * 1000 : r * 1000;
+  }
+
+  STDigest* pDigest = createDigest();
+  int64_t   st = taosGetTimestampUs();
+  for (int32_t i = 0; i < num; ++i) {
+    tDigestAdd(pDigest, pData[i]);
+  }
+  int64_t digestElapsed = taosGetTimestampUs() - st;
+
+  SHistogramInfo* pHisto = NULL;
+  st = taosGetTimestampUs();
+  for (int32_t i = 0; i < num; ++i) {
+    tHistogramAdd(&pHisto, pData[i]);
+  }
+  int64_t histoElapsed = taosGetTimestampUs() - st;
+
+  std::sort(pData, pData + num);
+
+  printf("%s distribution, %d values, t-digest:%" PRId64 " us, histogram:%" PRId64 " us\n",
+         longTail ? "exponential" : "uniform", num, digestElapsed, histoElapsed);
+
+  double percents[] = {50, 99, 99.9};
+  for (int32_t i = 0; i < tListLen(percents); ++i) {
+    double  exact = exactQuantile(pData, num, percents[i]);
+    double  v1 = tDigestQuantile(pDigest, percents[i]);
+    double* v2 = tHistogramUniform(pHisto, &percents[i], 1);
+
+    double e1 = rankError(pData, num, percents[i], v1);
+    double e2 = rankError(pData, num, percents[i], *v2);
+    printf("p%g exact:%f, t-digest:%f (rank error:%f), histogram:%f (rank error:%f)\n", percents[i], exact, v1, e1,
+           *v2, e2);
+
+    ASSERT_LT(e1, 0.001);
+    free(v2);
+  }
+
+  tHistogramDestroy(&pHisto);
+  free(pDigest);
+  free(pData);
+}
+}  // namespace
+
+TEST(testCase, tdigestTest) {
+  simpleTest();
+  mergeTest();
+  sortedTest(true);
+  sortedTest(false);
+}
+
+TEST(testCase, tdigestPerfTest) {
+  compareWithHistogram(false);
+  compareWithHistogram(true);
+}
@@ -26,7 +26,14 @@ extern "C" {
 #define RPC_CONN_TCPC   3
 #define RPC_CONN_TCP    2
 
+#define RPC_COMP_NONE   0
+#define RPC_COMP_LZ4    1
+#define RPC_COMP_ZLIB   2
+
+#define rpcIsReq(type) (type & 1U)
+
 extern int tsRpcOverhead;
+extern int tsRpcLinkCredits;
 
 typedef struct {
   void    *msg;
@@ -43,8 +50,8 @@ typedef struct {
 
 typedef struct {
   char     version:4; // RPC version
-  char     comp:4;    // compression algorithm, 0:no compression 1:lz4
-  char     resflag:2; // reserved bits
+  char     comp:4;    // compression algorithm, 0:no compression 1:lz4 2:zlib
+  char     pcomp:2;   // compression preferred by sender for the msgs it receives, RPC_COMP_XX + 1, 0: not set
   char     spi:3;     // security parameter index
   char     encrypt:3; // encrypt algorithm, 0: no encryption
   uint16_t tranId;    // transcation ID
@@ -29,8 +29,10 @@ void taosStopTcpClient(void *chandle);
 void taosCleanUpTcpClient(void *chandle);
 void *taosOpenTcpClientConnection(void *shandle, void *thandle, uint32_t ip, uint16_t port);
 
+void taosRefTcpConnection(void *chandle);
 void taosCloseTcpConnection(void *chandle);
 int  taosSendTcpData(uint32_t ip, uint16_t port, void *data, int len, void *chandle);
+int64_t taosGetTcpRtt(void *chandle);
 
 #ifdef __cplusplus
 }
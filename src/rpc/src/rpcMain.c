@@ -21,6 +21,9 @@
 #include "ttimer.h"
 #include "tutil.h"
 #include "lz4.h"
+#ifdef USE_ZLIB
+#include "zlib.h"
+#endif
 #include "taoserror.h"
 #include "tsocket.h"
 #include "tglobal.h"
@@ -38,7 +41,14 @@
 #define rpcContFromHead(msg) (msg + sizeof(SRpcHead))
 #define rpcMsgLenFromCont(contLen) (contLen + sizeof(SRpcHead))
 #define rpcContLenFromMsg(msgLen) (msgLen - sizeof(SRpcHead))
-#define rpcIsReq(type) (type & 1U)
+
+#define RPC_COMP_SKIP    32   // msgs sent without compression after a compression does not pay off
+#define RPC_ZLIB_LEVEL   3
+#ifdef USE_ZLIB
+#define RPC_COMP_MAX     RPC_COMP_ZLIB
+#else
+#define RPC_COMP_MAX     RPC_COMP_LZ4
+#endif
 
 typedef struct {
   int      sessions;     // number of sessions allowed
@@ -82,6 +92,7 @@ typedef struct {
   int8_t    oldInUse;   // server IP inUse passed by app
   int8_t    redirect;   // flag to indicate redirect
   int8_t    connType;   // connection type
+  int8_t    compTried;  // compression is already tried on the content
   SRpcMsg  *pRsp;       // for synchronous API
   tsem_t   *pSem;       // for synchronous API
   SRpcIpSet *pSet;      // for synchronous API 
@@ -122,11 +133,19 @@ typedef struct SRpcConn {
   SRpcInfo *pRpc;       // the associated SRpcInfo
   int8_t    connType;   // connection type
   int64_t   lockedBy;   // lock for connection
+  int8_t    peerComp;   // compression preferred by peer, RPC_COMP_XX + 1, 0: unknown
+  int16_t   compSkip;   // number of msgs to be sent without compression
+  int64_t   minRtt;     // min round trip time in microseconds, for client only
   SRpcReqContext *pContext; // request context
 } SRpcConn;
 
 int tsRpcMaxUdpSize = 15000;  // bytes
+int tsRpcLinkCredits = 32;    // max sessions sharing one TCP link, so max requests in flight on it
+int tsRpcWanRtt = 5000;       // microseconds, link with a larger min round trip time is taken as WAN link
 int tsProgressTimer = 100;
+// compression statistics, 0: requests 1: responses
+static SRpcCompStat tsRpcCompStat[2];
+
 // not configurable
 int tsRpcMaxRetry;
 int tsRpcHeadSize;
@@ -174,6 +193,13 @@ void *(*taosOpenConn[])(void *shandle, void *thandle, uint32_t ip, uint16_t port
     taosOpenTcpClientConnection,
 };
 
+void (*taosRefConn[])(void *chandle) = {
+    NULL, 
+    NULL, 
+    taosRefTcpConnection, 
+    taosRefTcpConnection
+};
+
 void (*taosCloseConn[])(void *chandle) = {
     NULL, 
     NULL, 
@@ -183,6 +209,7 @@ void (*taosCloseConn[])(void *chandle) = {
 
 static SRpcConn *rpcOpenConn(SRpcInfo *pRpc, char *peerFqdn, uint16_t peerPort, int8_t connType);
 static void      rpcCloseConn(void *thandle);
+static void      rpcSetConnChandle(SRpcConn *pConn, SRecvInfo *pRecv);
 static SRpcConn *rpcSetupConnToServer(SRpcReqContext *pContext);
 static SRpcConn *rpcAllocateClientConn(SRpcInfo *pRpc);
 static SRpcConn *rpcAllocateServerConn(SRpcInfo *pRpc, SRecvInfo *pRecv);
@@ -202,7 +229,10 @@ static void  rpcProcessIdleTimer(void *param, void *tmrId);
 static void  rpcProcessProgressTimer(void *param, void *tmrId);
 
 static void  rpcFreeMsg(void *msg);
-static int32_t rpcCompressRpcMsg(char* pCont, int32_t contLen);
+static int32_t rpcCompressRpcMsg(char* pCont, int32_t contLen, int8_t comp, SRpcCompStat *pStat);
+static int32_t rpcCompressConnMsg(SRpcConn *pConn, char *pCont, int32_t contLen, SRpcCompStat *pStat);
+static int8_t  rpcGetPreferredComp(SRpcConn *pConn);
+static int32_t rpcRestoreRpcMsg(char *pCont, int32_t contLen);
 static SRpcHead *rpcDecompressRpcMsg(SRpcHead *pHead);
 static int   rpcAddAuthPart(SRpcConn *pConn, char *msg, int msgLen);
 static int   rpcCheckAuthentication(SRpcConn *pConn, char *msg, int msgLen);
@@ -357,12 +387,13 @@ void *rpcSendRequest(void *shandle, const SRpcIpSet *pIpSet, const SRpcMsg *pMsg
   SRpcInfo       *pRpc = (SRpcInfo *)shandle;
   SRpcReqContext *pContext;
 
-  int contLen = rpcCompressRpcMsg(pMsg->pCont, pMsg->contLen);
+  int contLen = pMsg->contLen;
   pContext = (SRpcReqContext *) (pMsg->pCont-sizeof(SRpcHead)-sizeof(SRpcReqContext));
   pContext->ahandle = pMsg->handle;
   pContext->pRpc = (SRpcInfo *)shandle;
   pContext->ipSet = *pIpSet;
   pContext->contLen = contLen;
+  pContext->compTried = 0;
   pContext->pCont = pMsg->pCont;
   pContext->msgType = pMsg->msgType;
   pContext->oldInUse = pIpSet->inUse;
@@ -376,7 +407,7 @@ void *rpcSendRequest(void *shandle, const SRpcIpSet *pIpSet, const SRpcMsg *pMsg
   if (type == TSDB_MSG_TYPE_QUERY || type == TSDB_MSG_TYPE_CM_RETRIEVE
     || type == TSDB_MSG_TYPE_FETCH || type == TSDB_MSG_TYPE_CM_STABLE_VGROUP
     || type == TSDB_MSG_TYPE_CM_TABLES_META || type == TSDB_MSG_TYPE_CM_TABLE_META
-    || type == TSDB_MSG_TYPE_CM_SHOW )
+    || type == TSDB_MSG_TYPE_CM_STABLE_CHILDREN || type == TSDB_MSG_TYPE_CM_SHOW )
     pContext->connType = RPC_CONN_TCPC;
   
   rpcSendReqToServer(pRpc, pContext);
@@ -399,7 +430,7 @@ void rpcSendResponse(const SRpcMsg *pRsp) {
   SRpcHead  *pHead = rpcHeadFromCont(pMsg->pCont);
   char      *msg = (char *)pHead;
 
-  pMsg->contLen = rpcCompressRpcMsg(pMsg->pCont, pMsg->contLen);
+  pMsg->contLen = rpcCompressConnMsg(pConn, pMsg->pCont, pMsg->contLen, tsRpcCompStat + 1);
   msgLen = rpcMsgLenFromCont(pMsg->contLen);
 
   rpcLockConn(pConn);
@@ -424,6 +455,7 @@ void rpcSendResponse(const SRpcMsg *pRsp) {
   pHead->port = htons(pConn->localPort);
   pHead->code = htonl(pMsg->code);
   pHead->ahandle = (uint64_t) pConn->ahandle;
+  if (pConn->peerComp) pHead->pcomp = MIN(pConn->peerComp, RPC_COMP_MAX + 1);  // confirm the compression
  
   // set pConn parameters
   pConn->inType = 0;
@@ -581,6 +613,7 @@ static void rpcReleaseConn(SRpcConn *pConn) {
 
   pConn->user[0] = 0;
   if (taosCloseConn[pConn->connType]) (*taosCloseConn[pConn->connType])(pConn->chandle);
+  pConn->chandle = NULL;
 
   taosTmrStopA(&pConn->pTimer);
   taosTmrStopA(&pConn->pIdleTimer);
@@ -607,6 +640,9 @@ static void rpcReleaseConn(SRpcConn *pConn) {
   pConn->pReqMsg = NULL;
   pConn->reqMsgLen = 0;
   pConn->pContext = NULL;
+  pConn->peerComp = 0;
+  pConn->compSkip = 0;
+  pConn->minRtt = 0;
 
   taosFreeId(pRpc->idPool, pConn->sid);
   tTrace("%s, rpc connection is released", pConn->info);
@@ -623,6 +659,17 @@ static void rpcCloseConn(void *thandle) {
   rpcUnlockConn(pConn);
 }
 
+// the session holds a reference of the TCP link it is on, since the link may be shared by other sessions
+static void rpcSetConnChandle(SRpcConn *pConn, SRecvInfo *pRecv) {
+  if (pConn->chandle == pRecv->chandle) return;
+
+  if (pConn->chandle && taosCloseConn[pConn->connType]) (*taosCloseConn[pConn->connType])(pConn->chandle);
+  if (taosRefConn[pRecv->connType]) (*taosRefConn[pRecv->connType])(pRecv->chandle);
+
+  pConn->chandle = pRecv->chandle;
+  pConn->connType = pRecv->connType;
+}
+
 static SRpcConn *rpcAllocateClientConn(SRpcInfo *pRpc) {
   SRpcConn *pConn = NULL;
 
@@ -791,6 +838,7 @@ static int rpcProcessReqHead(SRpcConn *pConn, SRpcHead *pHead) {
 
     pConn->inTranId = pHead->tranId;
     pConn->inType = pHead->msgType;
+    if (pHead->pcomp) pConn->peerComp = pHead->pcomp & 0x3;
 
     return 0;
 }
@@ -811,6 +859,17 @@ static int rpcProcessRspHead(SRpcConn *pConn, SRpcHead *pHead) {
     return TSDB_CODE_RPC_INVALID_RESPONSE_TYPE;
   }
 
+  /*
+   * min round trip time tells how far the server is, it is used to choose the compression. It is taken from TCP,
+   * since the time from request to response includes the time the server takes to process the request. UDP links
+   * have no such measure, and keep LZ4.
+   */
+  if (pConn->connType == RPC_CONN_TCPC) {
+    int64_t rtt = taosGetTcpRtt(pConn->chandle);
+    if (rtt > 0 && (pConn->minRtt == 0 || rtt < pConn->minRtt)) pConn->minRtt = rtt;
+  }
+  if (pHead->pcomp) pConn->peerComp = pHead->pcomp & 0x3;
+
   taosTmrStopA(&pConn->pTimer);
   pConn->retry = 0;
 
@@ -876,7 +935,7 @@ static SRpcConn *rpcProcessMsgHead(SRpcInfo *pRpc, SRecvInfo *pRecv) {
   }
 
   sid = pConn->sid;
-  pConn->chandle = pRecv->chandle;
+  rpcSetConnChandle(pConn, pRecv);
   pConn->peerIp = pRecv->ip; 
   pConn->peerPort = pRecv->port;
   if (pHead->port) pConn->peerPort = htons(pHead->port); 
@@ -927,23 +986,32 @@ static void rpcReportBrokenLinkToServer(SRpcConn *pConn) {
   if (pRpc->cfp) (*(pRpc->cfp))(&rpcMsg, NULL);
 }
 
-static void rpcProcessBrokenLink(SRpcConn *pConn) {
-  if (pConn == NULL) return;
-  SRpcInfo *pRpc = pConn->pRpc;
-  tTrace("%s, link is broken", pConn->info);
+// a TCP link may be shared by several sessions, all sessions on the broken link are released
+static void rpcProcessBrokenLink(SRpcInfo *pRpc, void *chandle) {
+  if (chandle == NULL) return;
 
-  rpcLockConn(pConn);
+  for (int i = 0; i < pRpc->sessions; ++i) {
+    SRpcConn *pConn = pRpc->connList + i;
+    if (pConn->chandle != chandle || pConn->user[0] == 0) continue;
 
-  if (pConn->outType) {
-    SRpcReqContext *pContext = pConn->pContext;
-    pContext->code = TSDB_CODE_RPC_NETWORK_UNAVAIL;
-    taosTmrStart(rpcProcessConnError, 0, pContext, pRpc->tmrCtrl);
-  }
+    rpcLockConn(pConn);
 
-  if (pConn->inType) rpcReportBrokenLinkToServer(pConn); 
+    if (pConn->chandle == chandle && pConn->user[0]) {
+      tTrace("%s, link is broken", pConn->info);
 
-  rpcReleaseConn(pConn);
-  rpcUnlockConn(pConn);
+      if (pConn->outType) {
+        SRpcReqContext *pContext = pConn->pContext;
+        pContext->code = TSDB_CODE_RPC_NETWORK_UNAVAIL;
+        taosTmrStart(rpcProcessConnError, 0, pContext, pRpc->tmrCtrl);
+      }
+
+      if (pConn->inType) rpcReportBrokenLinkToServer(pConn); 
+
+      rpcReleaseConn(pConn);
+    }
+
+    rpcUnlockConn(pConn);
+  }
 }
 
 static void *rpcProcessMsgFromPeer(SRecvInfo *pRecv) {
@@ -957,7 +1025,7 @@ static void *rpcProcessMsgFromPeer(SRecvInfo *pRecv) {
   pRecv->connType = pRecv->connType | pRpc->connType;  
 
   if (pRecv->msg == NULL) {
-    rpcProcessBrokenLink(pConn);
+    rpcProcessBrokenLink(pRpc, pRecv->chandle);
     return NULL;
   }
 
@@ -1158,6 +1226,22 @@ static void rpcSendReqToServer(SRpcInfo *pRpc, SRpcReqContext *pContext) {
 
   pContext->pConn = pConn;
   pConn->ahandle = pContext->ahandle;
+
+  // the content is compressed once, and compressed again only if it is sent to another server not confirming zlib
+  if (pContext->compTried && pHead->comp > RPC_COMP_LZ4 && pConn->peerComp != pHead->comp + 1) {
+    int32_t origLen = rpcRestoreRpcMsg((char *)pContext->pCont, pContext->contLen);
+    if (origLen > 0) {
+      pContext->contLen = origLen;
+      pContext->compTried = 0;
+    }
+  }
+
+  if (pContext->compTried == 0) {
+    pContext->compTried = 1;
+    pContext->contLen = rpcCompressConnMsg(pConn, (char *)pContext->pCont, pContext->contLen, tsRpcCompStat);
+    msgLen = rpcMsgLenFromCont(pContext->contLen);
+  }
+
   rpcLockConn(pConn);
 
   // set the message header  
@@ -1172,6 +1256,7 @@ static void rpcSendReqToServer(SRpcInfo *pRpc, SRpcReqContext *pContext) {
   pHead->port = 0;
   pHead->linkUid = pConn->linkUid;
   pHead->ahandle = (uint64_t)pConn->ahandle;
+  pHead->pcomp = rpcGetPreferredComp(pConn) + 1;
   memcpy(pHead->user, pConn->user, tListLen(pHead->user));
 
   // set the connection parameters
@@ -1305,36 +1390,84 @@ static void rpcProcessProgressTimer(void *param, void *tmrId) {
   rpcUnlockConn(pConn);
 }
 
-static int32_t rpcCompressRpcMsg(char* pCont, int32_t contLen) {
+// client prefers no compression on loopback, and the compression with higher ratio on WAN links
+static int8_t rpcGetPreferredComp(SRpcConn *pConn) {
+  if ((ntohl(pConn->peerIp) >> 24) == 127) return RPC_COMP_NONE;
+  if (pConn->minRtt >= tsRpcWanRtt) return RPC_COMP_MAX;
+  return RPC_COMP_LZ4;
+}
+
+/*
+ * The compression is chosen per connection: the client sets its preference in each request, and the server
+ * confirms the one it supports in the response. A peer which does not set the preference decompresses LZ4 only.
+ * If a compression does not pay off, following msgs on the connection are not compressed for a while.
+ */
+static int32_t rpcCompressConnMsg(SRpcConn *pConn, char *pCont, int32_t contLen, SRpcCompStat *pStat) {
+  if (!NEEDTO_COMPRESSS_MSG(contLen)) return contLen;
+
+  if (pConn->compSkip > 0) {
+    pConn->compSkip--;
+    return contLen;
+  }
+
+  int8_t comp = RPC_COMP_LZ4;
+  if (pConn->pRpc->connType == TAOS_CONN_CLIENT) {
+    comp = rpcGetPreferredComp(pConn);
+    if (comp > RPC_COMP_LZ4 && pConn->peerComp != comp + 1) comp = RPC_COMP_LZ4;
+  } else if (pConn->peerComp) {
+    comp = MIN(pConn->peerComp - 1, RPC_COMP_MAX);
+  }
+
+  if (comp == RPC_COMP_NONE) return contLen;
+
+  int32_t finalLen = rpcCompressRpcMsg(pCont, contLen, comp, pStat);
+  if (finalLen == contLen) pConn->compSkip = RPC_COMP_SKIP;
+
+  return finalLen;
+}
+
+static int32_t rpcCompressRpcMsg(char* pCont, int32_t contLen, int8_t comp, SRpcCompStat *pStat) {
   SRpcHead  *pHead = rpcHeadFromCont(pCont);
   int32_t    finalLen = 0;
+  int32_t    compLen = 0;
   int        overhead = sizeof(SRpcComp);
   
-  if (!NEEDTO_COMPRESSS_MSG(contLen)) {
-    return contLen;
-  }
-  
   char *buf = malloc (contLen + overhead + 8);  // 8 extra bytes
   if (buf == NULL) {
     tError("failed to allocate memory for rpc msg compression, contLen:%d", contLen);
     return contLen;
   }
   
-  int32_t compLen = LZ4_compress_default(pCont, buf, contLen, contLen + overhead);
+  int64_t st = taosGetTimestampUs();
+  if (comp == RPC_COMP_LZ4) {
+    compLen = LZ4_compress_default(pCont, buf, contLen, contLen + overhead);
+#ifdef USE_ZLIB
+  } else if (comp == RPC_COMP_ZLIB) {
+    uLongf destLen = (uLongf)(contLen + overhead);
+    if (compress2((Bytef *)buf, &destLen, (Bytef *)pCont, (uLong)contLen, RPC_ZLIB_LEVEL) == Z_OK) {
+      compLen = (int32_t)destLen;
+    }
+#endif
+  }
+  atomic_add_fetch_64(&pStat->compTime, taosGetTimestampUs() - st);
   
   /*
    * only the compressed size is less than the value of contLen - overhead, the compression is applied
    * The first four bytes is set to 0, the second four bytes are utilized to keep the original length of message
    */
-  if (compLen < contLen - overhead) {
+  if (compLen > 0 && compLen < contLen - overhead) {
     SRpcComp *pComp = (SRpcComp *)pCont;
     pComp->reserved = 0; 
     pComp->contLen = htonl(contLen); 
     memcpy(pCont + overhead, buf, compLen);
     
-    pHead->comp = 1;
+    pHead->comp = comp;
     //tTrace("compress rpc msg, before:%d, after:%d", contLen, compLen);
     finalLen = compLen + overhead;
+
+    atomic_add_fetch_64(&pStat->numOfComps, 1);
+    atomic_add_fetch_64(&pStat->origBytes, contLen);
+    atomic_add_fetch_64(&pStat->compBytes, finalLen);
   } else {
     finalLen = contLen;
   }
@@ -1343,6 +1476,40 @@ static int32_t rpcCompressRpcMsg(char* pCont, int32_t contLen) {
   return finalLen;
 }
 
+// restore the content compressed for another connection in place, the content buffer holds the original length
+static int32_t rpcRestoreRpcMsg(char *pCont, int32_t contLen) {
+  SRpcHead  *pHead = rpcHeadFromCont(pCont);
+  SRpcComp  *pComp = (SRpcComp *)pCont;
+  int32_t    origLen = htonl(pComp->contLen);
+  int32_t    destLen = -1;
+
+  char *buf = malloc(origLen);
+  if (buf == NULL) {
+    tError("failed to allocate memory to restore rpc msg, contLen:%d", origLen);
+    return -1;
+  }
+
+#ifdef USE_ZLIB
+  int    overhead = sizeof(SRpcComp);
+  uLongf len = (uLongf)origLen;
+  if (pHead->comp == RPC_COMP_ZLIB &&
+      uncompress((Bytef *)buf, &len, (Bytef *)pCont + overhead, (uLong)(contLen - overhead)) == Z_OK) {
+    destLen = (int32_t)len;
+  }
+#endif
+
+  if (destLen == origLen) {
+    memcpy(pCont, buf, origLen);
+    pHead->comp = RPC_COMP_NONE;
+  } else {
+    tError("failed to restore rpc msg, comp:%d contLen:%d", pHead->comp, origLen);
+    destLen = -1;
+  }
+
+  free(buf);
+  return destLen;
+}
+
 static SRpcHead *rpcDecompressRpcMsg(SRpcHead *pHead) {
   int overhead = sizeof(SRpcComp);
   SRpcHead   *pNewHead = NULL;  
@@ -1353,14 +1520,29 @@ static SRpcHead *rpcDecompressRpcMsg(SRpcHead *pHead) {
     // decompress the content
     assert(pComp->reserved == 0);
     int contLen = htonl(pComp->contLen);
+    SRpcCompStat *pStat = tsRpcCompStat + (rpcIsReq(pHead->msgType) ? 0 : 1);
   
     // prepare the temporary buffer to decompress message
     char *temp = (char *)malloc(contLen + RPC_MSG_OVERHEAD);
     pNewHead = (SRpcHead *)(temp + sizeof(SRpcReqContext)); // reserve SRpcReqContext
   
-    if (pNewHead) {
+    if (temp) {
       int compLen = rpcContLenFromMsg(pHead->msgLen) - overhead;
-      int origLen = LZ4_decompress_safe((char*)(pCont + overhead), (char *)pNewHead->content, compLen, contLen);
+      int origLen = -1;
+
+      int64_t st = taosGetTimestampUs();
+      if (pHead->comp == RPC_COMP_LZ4) {
+        origLen = LZ4_decompress_safe((char*)(pCont + overhead), (char *)pNewHead->content, compLen, contLen);
+#ifdef USE_ZLIB
+      } else if (pHead->comp == RPC_COMP_ZLIB) {
+        uLongf destLen = (uLongf)contLen;
+        if (uncompress(pNewHead->content, &destLen, pCont + overhead, (uLong)compLen) == Z_OK) origLen = (int)destLen;
+#endif
+      } else {
+        tError("unsupported compression algorithm:%d", pHead->comp);
+      }
+      atomic_add_fetch_64(&pStat->decompTime, taosGetTimestampUs() - st);
+      atomic_add_fetch_64(&pStat->numOfDecomps, 1);
       assert(origLen == contLen);
     
       memcpy(pNewHead, pHead, sizeof(SRpcHead));
@@ -1376,6 +1558,20 @@ static SRpcHead *rpcDecompressRpcMsg(SRpcHead *pHead) {
   return pHead;
 }
 
+void rpcGetCompStat(SRpcCompStat *pReqStat, SRpcCompStat *pRspStat) {
+  SRpcCompStat *pStat[2] = {pReqStat, pRspStat};
+
+  for (int i = 0; i < 2; ++i) {
+    if (pStat[i] == NULL) continue;
+    pStat[i]->numOfComps = atomic_load_64(&tsRpcCompStat[i].numOfComps);
+    pStat[i]->origBytes = atomic_load_64(&tsRpcCompStat[i].origBytes);
+    pStat[i]->compBytes = atomic_load_64(&tsRpcCompStat[i].compBytes);
+    pStat[i]->compTime = atomic_load_64(&tsRpcCompStat[i].compTime);
+    pStat[i]->numOfDecomps = atomic_load_64(&tsRpcCompStat[i].numOfDecomps);
+    pStat[i]->decompTime = atomic_load_64(&tsRpcCompStat[i].decompTime);
+  }
+}
+
 static int rpcAuthenticateMsg(void *pMsg, int msgLen, void *pAuth, void *pKey) {
   MD5_CTX context;
   int     ret = -1;
@@ -1499,9 +1695,9 @@ static void rpcDecRef(SRpcInfo *pRpc)
 { 
   if (atomic_sub_fetch_8(&pRpc->refCount, 1) == 0) {
     taosHashCleanup(pRpc->hash);
+    rpcCloseConnCache(pRpc->pCache);  // it stops its timer, so it is closed before the timer is cleaned up
     taosTmrCleanUp(pRpc->tmrCtrl);
     taosIdPoolCleanUp(pRpc->idPool);
-    rpcCloseConnCache(pRpc->pCache);
 
     tfree(pRpc->connList);
     pthread_mutex_destroy(&pRpc->mutex);
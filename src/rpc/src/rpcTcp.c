@@ -26,16 +26,40 @@
   #define EPOLLWAKEUP (1u << 29)
 #endif
 
+#define RPC_TCP_READ_SIZE   65536  // size of the read buffer shared by the connections of a thread
+#define RPC_TCP_DIRECT_SIZE 8192   // a message body with more bytes left is read into the message directly
+#define RPC_TCP_MAX_IOVS    64     // max messages coalesced into one writev
+
+// a message waiting to be written, it is owned by the sending thread until it is done
+typedef struct STcpSendReq {
+  void               *data;
+  int                 len;
+  int                 code;
+  bool                done;
+  struct STcpSendReq *next;
+} STcpSendReq;
+
 typedef struct SFdObj {
   void              *signature;
   int                fd;          // TCP socket FD
   int                closedByApp; // 1: already closed by App
+  int32_t            numOfHandles;// number of sessions sharing the link
   void              *thandle;     // handle from upper layer, like TAOS
   uint32_t           ip;
   uint16_t           port;
   struct SThreadObj *pThreadObj;
   struct SFdObj     *prev;
   struct SFdObj     *next;
+  SRpcHead           head;        // partially received message head
+  int32_t            headLen;
+  char              *msg;         // message being received, tsRpcOverhead is reserved ahead
+  int32_t            msgLen;
+  int32_t            recvLen;
+  pthread_mutex_t    sendMutex;
+  pthread_cond_t     sendCond;
+  bool               sending;     // a thread is writing the pending messages
+  STcpSendReq       *sendHead;
+  STcpSendReq       *sendTail;
 } SFdObj;
 
 typedef struct SThreadObj {
@@ -66,6 +90,7 @@ typedef struct {
 static void   *taosProcessTcpData(void *param);
 static SFdObj *taosMallocFdObj(SThreadObj *pThreadObj, int fd);
 static void    taosFreeFdObj(SFdObj *pFdObj);
+static void    taosDestroyFdObj(SFdObj *pFdObj);
 static void    taosReportBrokenLink(SFdObj *pFdObj);
 static void   *taosAcceptTcpConnection(void *arg);
 
@@ -327,8 +352,31 @@ void taosCleanUpTcpClient(void *chandle) {
   tfree(pThreadObj);
 }
 
+/*
+ * Sessions to the same peer share one TCP link, each session keeps one request in flight and is identified by its
+ * session ID in the message head, so the requests on a link are multiplexed. A link grants tsRpcLinkCredits sessions,
+ * once they are all taken, a new link is opened to the peer.
+ */
 void *taosOpenTcpClientConnection(void *shandle, void *thandle, uint32_t ip, uint16_t port) {
   SThreadObj *    pThreadObj = shandle;
+  SFdObj *        pFdObj = NULL;
+  int32_t         numOfHandles = 0;
+
+  pthread_mutex_lock(&pThreadObj->mutex);
+  for (pFdObj = pThreadObj->pHead; pFdObj; pFdObj = pFdObj->next) {
+    if (pFdObj->ip == ip && pFdObj->port == port && pFdObj->closedByApp == 0 &&
+        pFdObj->numOfHandles < tsRpcLinkCredits) {
+      numOfHandles = ++pFdObj->numOfHandles;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&pThreadObj->mutex);
+
+  if (pFdObj) {
+    tTrace("%s %p TCP connection to 0x%x:%hu is shared, FD:%p numOfHandles:%d", pThreadObj->label, thandle, ip, port,
+           pFdObj, numOfHandles);
+    return pFdObj;
+  }
 
   int fd = taosOpenTcpClientSocket(ip, port, pThreadObj->ip);
   if (fd < 0) return NULL;
@@ -341,12 +389,15 @@ void *taosOpenTcpClientConnection(void *shandle, void *thandle, uint32_t ip, uin
     localPort = (uint16_t)ntohs(sin.sin_port);
   }
 
-  SFdObj *pFdObj = taosMallocFdObj(pThreadObj, fd);
+  pFdObj = taosMallocFdObj(pThreadObj, fd);
   
   if (pFdObj) {
+    pthread_mutex_lock(&pThreadObj->mutex);
     pFdObj->thandle = thandle;
+    pFdObj->numOfHandles = 1;
     pFdObj->port = port;
     pFdObj->ip = ip;
+    pthread_mutex_unlock(&pThreadObj->mutex);
     tTrace("%s %p TCP connection to 0x%x:%hu is created, localPort:%hu FD:%p numOfFds:%d", 
             pThreadObj->label, thandle, ip, port, localPort, pFdObj, pThreadObj->numOfFds);
   } else {
@@ -357,24 +408,143 @@ void *taosOpenTcpClientConnection(void *shandle, void *thandle, uint32_t ip, uin
   return pFdObj;
 }
 
+void taosRefTcpConnection(void *chandle) {
+  SFdObj *pFdObj = chandle;
+  if (pFdObj == NULL) return;
+
+  SThreadObj *pThreadObj = pFdObj->pThreadObj;
+  pthread_mutex_lock(&pThreadObj->mutex);
+  pFdObj->numOfHandles++;
+  pthread_mutex_unlock(&pThreadObj->mutex);
+}
+
+// release the link for one session, it is closed when no session uses it any more
 void taosCloseTcpConnection(void *chandle) {
   SFdObj *pFdObj = chandle;
+  bool    destroy = false;
   if (pFdObj == NULL) return;
 
   SThreadObj *pThreadObj = pFdObj->pThreadObj;
-  tTrace("%s %p TCP connection will be closed, FD:%p", pThreadObj->label, pFdObj->thandle, pFdObj); 
+  pthread_mutex_lock(&pThreadObj->mutex);
+
+  if (pFdObj->numOfHandles > 0) pFdObj->numOfHandles--;
+  if (pFdObj->numOfHandles == 0) {
+    if (pFdObj->signature == NULL) {
+      // link is already removed from the thread, it is kept for the sessions only
+      destroy = true;
+    } else if (pFdObj->closedByApp == 0) {
+      tTrace("%s %p TCP connection will be closed, FD:%p", pThreadObj->label, pFdObj->thandle, pFdObj);
+      pFdObj->closedByApp = 1;
+      shutdown(pFdObj->fd, SHUT_WR);
+    }
+  }
+
+  pthread_mutex_unlock(&pThreadObj->mutex);
 
-  // pFdObj->thandle = NULL;
-  pFdObj->closedByApp = 1;
-  shutdown(pFdObj->fd, SHUT_WR);
+  if (destroy) taosDestroyFdObj(pFdObj);
 }
 
-int taosSendTcpData(uint32_t ip, uint16_t port, void *data, int len, void *chandle) {
+// write the messages by one sendmsg, partial writes are continued until all messages are written out
+static int taosWriteTcpMsgs(int fd, struct iovec *iov, int iovcnt) {
+  struct msghdr msgHdr;
+  memset(&msgHdr, 0, sizeof(msgHdr));
+
+  while (iovcnt > 0) {
+    msgHdr.msg_iov = iov;
+    msgHdr.msg_iovlen = (size_t)iovcnt;
+    ssize_t ret = sendmsg(fd, &msgHdr, MSG_NOSIGNAL);
+    if (ret < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    }
+
+    while (iovcnt > 0 && (size_t)ret >= iov->iov_len) {
+      ret -= iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+
+    if (iovcnt > 0) {
+      iov->iov_base = (char *)iov->iov_base + ret;
+      iov->iov_len -= ret;
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * The messages sent to the same connection by several threads at the same time are coalesced: each sender appends
+ * its message to the pending list, and the first one becomes the writer, which writes out all pending messages by
+ * one writev, while others wait. Callers still own their buffers, which are written out when this function returns.
+ */
+// smoothed round trip time of the link measured by TCP in microseconds, -1 if it is not available
+int64_t taosGetTcpRtt(void *chandle) {
   SFdObj *pFdObj = chandle;
+  if (pFdObj == NULL) return -1;
+
+#if defined(LINUX)
+  struct tcp_info info;
+  socklen_t       len = sizeof(info);
+  if (getsockopt(pFdObj->fd, IPPROTO_TCP, TCP_INFO, &info, &len) == 0) return info.tcpi_rtt;
+#endif
+
+  return -1;
+}
+
+int taosSendTcpData(uint32_t ip, uint16_t port, void *data, int len, void *chandle) {
+  SFdObj     *pFdObj = chandle;
+  STcpSendReq req = {.data = data, .len = len, .code = 0, .done = false, .next = NULL};
 
   if (chandle == NULL) return -1;
 
-  return (int)send(pFdObj->fd, data, (size_t)len, 0);
+  pthread_mutex_lock(&pFdObj->sendMutex);
+
+  if (pFdObj->sendTail) {
+    pFdObj->sendTail->next = &req;
+  } else {
+    pFdObj->sendHead = &req;
+  }
+  pFdObj->sendTail = &req;
+
+  while (!req.done) {
+    if (pFdObj->sending) {
+      pthread_cond_wait(&pFdObj->sendCond, &pFdObj->sendMutex);
+      continue;
+    }
+
+    struct iovec iov[RPC_TCP_MAX_IOVS];
+    STcpSendReq *pHead = pFdObj->sendHead;
+    STcpSendReq *pReq = pHead;
+    int          num = 0;
+
+    for (; pReq && num < RPC_TCP_MAX_IOVS; pReq = pReq->next, ++num) {
+      iov[num].iov_base = pReq->data;
+      iov[num].iov_len = (size_t)pReq->len;
+    }
+
+    pFdObj->sendHead = pReq;
+    if (pReq == NULL) pFdObj->sendTail = NULL;
+    pFdObj->sending = true;
+    pthread_mutex_unlock(&pFdObj->sendMutex);
+
+    int code = taosWriteTcpMsgs(pFdObj->fd, iov, num);
+
+    pthread_mutex_lock(&pFdObj->sendMutex);
+    for (pReq = pHead; num > 0; --num) {
+      STcpSendReq *pNext = pReq->next;
+      pReq->code = code;
+      pReq->done = true;
+      pReq = pNext;
+    }
+
+    pFdObj->sending = false;
+    pthread_cond_broadcast(&pFdObj->sendCond);
+  }
+
+  pthread_mutex_unlock(&pFdObj->sendMutex);
+
+  return (req.code == 0) ? len : -1;
 }
 
 static void taosReportBrokenLink(SFdObj *pFdObj) {
@@ -392,7 +562,7 @@ static void taosReportBrokenLink(SFdObj *pFdObj) {
     recvInfo.port = 0;
     recvInfo.shandle = pThreadObj->shandle;
     recvInfo.thandle = pFdObj->thandle;
-    recvInfo.chandle = NULL;
+    recvInfo.chandle = pFdObj;  // all sessions sharing the link are notified
     recvInfo.connType = RPC_CONN_TCP;
     (*(pThreadObj->processData))(&recvInfo);
   } 
@@ -400,63 +570,135 @@ static void taosReportBrokenLink(SFdObj *pFdObj) {
   taosFreeFdObj(pFdObj);
 }
 
-static int taosReadTcpData(SFdObj *pFdObj, SRecvInfo *pInfo) {
-  SRpcHead    rpcHead;
-  int32_t     msgLen, leftLen, retLen, headLen;
-  char       *buffer, *msg;
-
+// pass a completely received message to the upper layer, return true if the FdObj is freed
+static bool taosDeliverTcpMsg(SFdObj *pFdObj) {
   SThreadObj *pThreadObj = pFdObj->pThreadObj;
+  SRecvInfo   recvInfo;
 
-  headLen = taosReadMsg(pFdObj->fd, &rpcHead, sizeof(SRpcHead));
-  if (headLen != sizeof(SRpcHead)) {
-    tTrace("%s %p read error, headLen:%d", pThreadObj->label, pFdObj->thandle, headLen);
-    return -1; 
+  char   *msg = pFdObj->msg;
+  int32_t msgLen = pFdObj->msgLen;
+  pFdObj->msg = NULL;
+  pFdObj->msgLen = 0;
+  pFdObj->recvLen = 0;
+  pFdObj->headLen = 0;
+
+  if (pFdObj->closedByApp) {
+    free(msg - tsRpcOverhead);
+    shutdown(pFdObj->fd, SHUT_WR);
+    return false;
   }
 
-  msgLen = (int32_t)htonl((uint32_t)rpcHead.msgLen);
-  buffer = malloc(msgLen + tsRpcOverhead);
-  if ( NULL == buffer) {
-    tError("%s %p TCP malloc(size:%d) fail", pThreadObj->label, pFdObj->thandle, msgLen);
-    return -1;
+  recvInfo.msg = msg;
+  recvInfo.msgLen = msgLen;
+  recvInfo.ip = pFdObj->ip;
+  recvInfo.port = pFdObj->port;
+  recvInfo.shandle = pThreadObj->shandle;
+  recvInfo.thandle = pFdObj->thandle;
+  recvInfo.chandle = pFdObj;
+  recvInfo.connType = RPC_CONN_TCP;
+
+  void *thandle = (*(pThreadObj->processData))(&recvInfo);
+  if (thandle) {
+    pFdObj->thandle = thandle;
+    return false;
   }
 
-  msg = buffer + tsRpcOverhead;
-  leftLen = msgLen - headLen;
-  retLen = taosReadMsg(pFdObj->fd, msg + headLen, leftLen);
+  // a message failed to be processed shall not close the link still used by other sessions
+  pthread_mutex_lock(&pThreadObj->mutex);
+  int32_t numOfHandles = pFdObj->numOfHandles;
+  pthread_mutex_unlock(&pThreadObj->mutex);
+  if (numOfHandles > 0) return false;
 
-  if (leftLen != retLen) {
-    tError("%s %p read error, leftLen:%d retLen:%d FD:%p", 
-            pThreadObj->label, pFdObj->thandle, leftLen, retLen, pFdObj);
-    free(buffer);
-    return -1;
-  }
+  taosFreeFdObj(pFdObj);
+  return true;
+}
 
-  memcpy(msg, &rpcHead, sizeof(SRpcHead));
-  
-  pInfo->msg = msg;
-  pInfo->msgLen = msgLen;
-  pInfo->ip = pFdObj->ip;
-  pInfo->port = pFdObj->port;
-  pInfo->shandle = pThreadObj->shandle;
-  pInfo->thandle = pFdObj->thandle;
-  pInfo->chandle = pFdObj;
-  pInfo->connType = RPC_CONN_TCP;
+// consume the received bytes, return -1 if the stream is broken, 1 if the FdObj is freed
+static int taosParseTcpData(SFdObj *pFdObj, char *data, int32_t len) {
+  SThreadObj *pThreadObj = pFdObj->pThreadObj;
 
-  if (pFdObj->closedByApp) {
-    free(buffer); 
-    return -1;
+  while (len > 0) {
+    if (pFdObj->msg == NULL) {
+      int32_t size = MIN(len, (int32_t)sizeof(SRpcHead) - pFdObj->headLen);
+      memcpy((char *)&pFdObj->head + pFdObj->headLen, data, (size_t)size);
+      pFdObj->headLen += size;
+      data += size;
+      len -= size;
+
+      if (pFdObj->headLen < sizeof(SRpcHead)) break;
+
+      int32_t msgLen = (int32_t)htonl((uint32_t)pFdObj->head.msgLen);
+      if (msgLen < (int32_t)sizeof(SRpcHead)) {
+        tError("%s %p invalid msgLen:%d FD:%p", pThreadObj->label, pFdObj->thandle, msgLen, pFdObj);
+        return -1;
+      }
+
+      char *buffer = malloc(msgLen + tsRpcOverhead);
+      if (NULL == buffer) {
+        tError("%s %p TCP malloc(size:%d) fail", pThreadObj->label, pFdObj->thandle, msgLen);
+        return -1;
+      }
+
+      pFdObj->msg = buffer + tsRpcOverhead;
+      pFdObj->msgLen = msgLen;
+      pFdObj->recvLen = sizeof(SRpcHead);
+      memcpy(pFdObj->msg, &pFdObj->head, sizeof(SRpcHead));
+    } else {
+      int32_t size = MIN(len, pFdObj->msgLen - pFdObj->recvLen);
+      memcpy(pFdObj->msg + pFdObj->recvLen, data, (size_t)size);
+      pFdObj->recvLen += size;
+      data += size;
+      len -= size;
+    }
+
+    if (pFdObj->recvLen == pFdObj->msgLen) {
+      if (taosDeliverTcpMsg(pFdObj)) return 1;
+    }
   }
 
   return 0;
 }
 
+/*
+ * Read the available data by one recv into the read buffer of the thread, and deliver all messages completed by it,
+ * so many small messages do not cost a malloc-sized read each. A large message body is read into the message
+ * directly. Partially received messages are kept in the FdObj until the next event.
+ */
+static int taosReadTcpData(SFdObj *pFdObj, char *buffer) {
+  SThreadObj *pThreadObj = pFdObj->pThreadObj;
+  ssize_t     len = 0;
+
+  if (pFdObj->msg && pFdObj->msgLen - pFdObj->recvLen >= RPC_TCP_DIRECT_SIZE) {
+    len = recv(pFdObj->fd, pFdObj->msg + pFdObj->recvLen, (size_t)(pFdObj->msgLen - pFdObj->recvLen), 0);
+    if (len > 0) {
+      pFdObj->recvLen += (int32_t)len;
+      if (pFdObj->recvLen == pFdObj->msgLen && taosDeliverTcpMsg(pFdObj)) return 1;
+      return 0;
+    }
+  } else {
+    len = recv(pFdObj->fd, buffer, RPC_TCP_READ_SIZE, 0);
+    if (len > 0) return taosParseTcpData(pFdObj, buffer, (int32_t)len);
+  }
+
+  if (len < 0 && (errno == EINTR || errno == EAGAIN)) return 0;
+
+  tTrace("%s %p read error, len:%d FD:%p(%s)", pThreadObj->label, pFdObj->thandle, (int)len, pFdObj,
+         (len == 0) ? "closed" : strerror(errno));
+  return -1;
+}
+
 #define maxEvents 10
 
 static void *taosProcessTcpData(void *param) {
   SThreadObj        *pThreadObj = param;
   SFdObj            *pFdObj;
   struct epoll_event events[maxEvents];
-  SRecvInfo          recvInfo;
+
+  char *buffer = malloc(RPC_TCP_READ_SIZE);
+  if (buffer == NULL) {
+    tError("%s failed to allocate TCP read buffer", pThreadObj->label);
+    return NULL;
+  }
  
   while (1) {
     int fdNum = epoll_wait(pThreadObj->pollFd, events, maxEvents, -1);
@@ -487,16 +729,14 @@ static void *taosProcessTcpData(void *param) {
         continue;
       }
 
-      if (taosReadTcpData(pFdObj, &recvInfo) < 0) {
+      if (taosReadTcpData(pFdObj, buffer) < 0) {
         shutdown(pFdObj->fd, SHUT_WR); 
         continue;
       }
-
-      pFdObj->thandle = (*(pThreadObj->processData))(&recvInfo);
-      if (pFdObj->thandle == NULL) taosFreeFdObj(pFdObj);
     }
   }
 
+  free(buffer);
   return NULL;
 }
 
@@ -512,10 +752,14 @@ static SFdObj *taosMallocFdObj(SThreadObj *pThreadObj, int fd) {
   pFdObj->fd = fd;
   pFdObj->pThreadObj = pThreadObj;
   pFdObj->signature = pFdObj;
+  pthread_mutex_init(&pFdObj->sendMutex, NULL);
+  pthread_cond_init(&pFdObj->sendCond, NULL);
 
   event.events = EPOLLIN | EPOLLRDHUP;
   event.data.ptr = pFdObj;
   if (epoll_ctl(pThreadObj->pollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+    pthread_mutex_destroy(&pFdObj->sendMutex);
+    pthread_cond_destroy(&pFdObj->sendCond);
     tfree(pFdObj);
     terrno = TAOS_SYSTEM_ERROR(errno); 
     return NULL;
@@ -547,7 +791,6 @@ static void taosFreeFdObj(SFdObj *pFdObj) {
 
   pFdObj->signature = NULL;
   epoll_ctl(pThreadObj->pollFd, EPOLL_CTL_DEL, pFdObj->fd, NULL);
-  taosCloseSocket(pFdObj->fd);
 
   pThreadObj->numOfFds--;
   if (pThreadObj->numOfFds < 0)
@@ -564,10 +807,24 @@ static void taosFreeFdObj(SFdObj *pFdObj) {
     (pFdObj->next)->prev = pFdObj->prev;
   }
 
+  // sessions still holding the link release it later, the socket is kept until then, so its FD is not reused
+  bool destroy = (pFdObj->numOfHandles == 0);
+  if (!destroy) shutdown(pFdObj->fd, SHUT_RDWR);
+
   pthread_mutex_unlock(&pThreadObj->mutex);
 
-  tTrace("%s %p TCP connection is closed, FD:%p numOfFds:%d", 
+  tTrace("%s %p TCP connection is removed, FD:%p numOfFds:%d", 
           pThreadObj->label, pFdObj->thandle, pFdObj, pThreadObj->numOfFds);
 
+  if (destroy) taosDestroyFdObj(pFdObj);
+}
+
+static void taosDestroyFdObj(SFdObj *pFdObj) {
+  tTrace("%s %p TCP connection is closed, FD:%p", pFdObj->pThreadObj->label, pFdObj->thandle, pFdObj);
+
+  taosCloseSocket(pFdObj->fd);
+  if (pFdObj->msg) free(pFdObj->msg - tsRpcOverhead);
+  pthread_mutex_destroy(&pFdObj->sendMutex);
+  pthread_cond_destroy(&pFdObj->sendCond);
   tfree(pFdObj);
 }
@@ -13,6 +13,7 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#define _GNU_SOURCE
 #include "os.h"
 #include "tsocket.h"
 #include "tsystem.h"
@@ -28,6 +29,8 @@
 #define RPC_MAX_UDP_PKTS 1000
 #define RPC_UDP_BUF_TIME 5  // mseconds
 #define RPC_MAX_UDP_SIZE 65480
+#define RPC_UDP_BATCH 16          // max datagrams received or sent by one system call
+#define RPC_UDP_COPY_SIZE 4096    // smaller datagrams are copied out, larger ones take over the receive slot
 
 typedef struct {
   int             index;
@@ -40,7 +43,13 @@ typedef struct {
   void           *shandle;  // handle passed by upper layer during server initialization
   void           *pSet;
   void         *(*processData)(SRecvInfo *pRecv);
-  char           *buffer;  // buffer to receive data
+  char           *slots[RPC_UDP_BATCH];  // receive buffers, each one has tsRpcOverhead reserved ahead
+  char           *sendBuf;  // replies generated by the receiving thread are batched here
+  int             sendLen;
+  int             numOfSends;
+  struct mmsghdr  sendMsgs[RPC_UDP_BATCH];
+  struct iovec    sendIov[RPC_UDP_BATCH];
+  struct sockaddr_in sendAddr[RPC_UDP_BATCH];
 } SUdpConn;
 
 typedef struct {
@@ -56,6 +65,10 @@ typedef struct {
 } SUdpConnSet;
 
 static void *taosRecvUdpData(void *param);
+static void  taosFlushUdpData(SUdpConn *pConn);
+
+// the connection whose received batch is being processed by the current thread
+static threadlocal SUdpConn *tsUdpBatchConn = NULL;
 
 void *taosInitUdpConnection(uint32_t ip, uint16_t port, char *label, int threads, void *fp, void *shandle) {
   SUdpConn    *pConn;
@@ -92,9 +105,9 @@ void *taosInitUdpConnection(uint32_t ip, uint16_t port, char *label, int threads
       break;
     }
 
-    pConn->buffer = malloc(RPC_MAX_UDP_SIZE);
-    if (NULL == pConn->buffer) {
-      tError("%s failed to malloc recv buffer", label);
+    pConn->sendBuf = malloc(RPC_MAX_UDP_SIZE);
+    if (NULL == pConn->sendBuf) {
+      tError("%s failed to malloc send buffer", label);
       break;
     }
 
@@ -145,7 +158,8 @@ void taosStopUdpConnection(void *handle) {
   for (int i = 0; i < pSet->threads; ++i) {
     pConn = pSet->udpConn + i;
     if (pConn->thread) pthread_join(pConn->thread, NULL);
-    tfree(pConn->buffer);
+    for (int j = 0; j < RPC_UDP_BATCH; ++j) tfree(pConn->slots[j]);
+    tfree(pConn->sendBuf);
     // tTrace("%s UDP thread is closed, index:%d", pConn->label, i);
   }
 
@@ -180,55 +194,124 @@ void *taosOpenUdpConnection(void *shandle, void *thandle, uint32_t ip, uint16_t
   return pConn;
 }
 
+/*
+ * datagrams are received in batches by recvmmsg. A large message keeps its receive slot, which is shrunk and handed
+ * over to the RPC layer as it is, and a new slot is allocated for the next batch. Small messages, e.g. heartbeats and
+ * acks, are copied out, since a copy is cheaper than replacing the slot.
+ */
 static void *taosRecvUdpData(void *param) {
   SUdpConn          *pConn = param;
-  struct sockaddr_in sourceAdd;
-  ssize_t            dataLen;
-  unsigned int       addLen;
-  uint16_t           port;
+  struct mmsghdr     msgs[RPC_UDP_BATCH];
+  struct iovec       iov[RPC_UDP_BATCH];
+  struct sockaddr_in sourceAdd[RPC_UDP_BATCH];
   SRecvInfo          recvInfo;
+  bool               closed = false;
 
-  memset(&sourceAdd, 0, sizeof(sourceAdd));
-  addLen = sizeof(sourceAdd);
   tTrace("%s UDP thread is created, index:%d", pConn->label, pConn->index);
-  char *msg = pConn->buffer;
 
-  while (1) {
-    dataLen = recvfrom(pConn->fd, pConn->buffer, RPC_MAX_UDP_SIZE, 0, (struct sockaddr *)&sourceAdd, &addLen);
-    if(dataLen <= 0) {
-      tTrace("%s UDP socket was closed, exiting(%s)", pConn->label, strerror(errno));
-      break;
+  while (!closed) {
+    int numOfSlots = 0;
+    for (; numOfSlots < RPC_UDP_BATCH; ++numOfSlots) {
+      if (pConn->slots[numOfSlots] == NULL) {
+        pConn->slots[numOfSlots] = malloc(RPC_MAX_UDP_SIZE + tsRpcOverhead);
+        if (pConn->slots[numOfSlots] == NULL) break;
+      }
+
+      iov[numOfSlots].iov_base = pConn->slots[numOfSlots] + tsRpcOverhead;  // overhead for SRpcReqContext
+      iov[numOfSlots].iov_len = RPC_MAX_UDP_SIZE;
+
+      memset(&msgs[numOfSlots], 0, sizeof(struct mmsghdr));
+      msgs[numOfSlots].msg_hdr.msg_name = &sourceAdd[numOfSlots];
+      msgs[numOfSlots].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+      msgs[numOfSlots].msg_hdr.msg_iov = &iov[numOfSlots];
+      msgs[numOfSlots].msg_hdr.msg_iovlen = 1;
     }
 
-    port = ntohs(sourceAdd.sin_port);
-
-    if (dataLen < sizeof(SRpcHead)) {
-      tError("%s recvfrom failed(%s)", pConn->label, strerror(errno));
+    if (numOfSlots == 0) {
+      tError("%s failed to allocate memory for UDP receive buffer", pConn->label);
+      taosMsleep(RPC_UDP_BUF_TIME);
       continue;
     }
 
-    char *tmsg = malloc(dataLen + tsRpcOverhead);
-    if (NULL == tmsg) {
-      tError("%s failed to allocate memory, size:%ld", pConn->label, dataLen);
-      continue;
+    int num = recvmmsg(pConn->fd, msgs, numOfSlots, MSG_WAITFORONE, NULL);
+    if (num < 0 && errno == EINTR) continue;
+    if (num <= 0) {
+      tTrace("%s UDP socket was closed, exiting(%s)", pConn->label, strerror(errno));
+      break;
+    }
+
+    tsUdpBatchConn = pConn;
+
+    for (int i = 0; i < num; ++i) {
+      int dataLen = (int)msgs[i].msg_len;
+      if (dataLen == 0) {
+        tTrace("%s UDP socket was closed, exiting", pConn->label);
+        closed = true;
+        break;
+      }
+
+      if (dataLen < sizeof(SRpcHead)) {
+        tError("%s recvmmsg failed, invalid msg length:%d", pConn->label, dataLen);
+        continue;
+      }
+
+      char *tmsg = NULL;
+      if (dataLen >= RPC_UDP_COPY_SIZE) {
+        tmsg = realloc(pConn->slots[i], dataLen + tsRpcOverhead);
+        if (tmsg == NULL) tmsg = pConn->slots[i];
+        pConn->slots[i] = NULL;
+      } else {
+        tmsg = malloc(dataLen + tsRpcOverhead);
+        if (NULL == tmsg) {
+          tError("%s failed to allocate memory, size:%d", pConn->label, dataLen);
+          continue;
+        }
+
+        memcpy(tmsg + tsRpcOverhead, iov[i].iov_base, dataLen);
+      }
+
+      tmsg += tsRpcOverhead;
+      recvInfo.msg = tmsg;
+      recvInfo.msgLen = dataLen;
+      recvInfo.ip = sourceAdd[i].sin_addr.s_addr;
+      recvInfo.port = ntohs(sourceAdd[i].sin_port);
+      recvInfo.shandle = pConn->shandle;
+      recvInfo.thandle = NULL;
+      recvInfo.chandle = pConn;
+      recvInfo.connType = 0;
+      (*(pConn->processData))(&recvInfo);
     }
 
-    tmsg += tsRpcOverhead;  // overhead for SRpcReqContext
-    memcpy(tmsg, msg, dataLen);
-    recvInfo.msg = tmsg;
-    recvInfo.msgLen = dataLen;
-    recvInfo.ip = sourceAdd.sin_addr.s_addr;
-    recvInfo.port = port;
-    recvInfo.shandle = pConn->shandle;
-    recvInfo.thandle = NULL;
-    recvInfo.chandle = pConn;
-    recvInfo.connType = 0;
-    (*(pConn->processData))(&recvInfo);
+    tsUdpBatchConn = NULL;
+    taosFlushUdpData(pConn);
   }
 
   return NULL;
 }
 
+static void taosFlushUdpData(SUdpConn *pConn) {
+  int sent = 0;
+
+  while (sent < pConn->numOfSends) {
+    int ret = sendmmsg(pConn->fd, pConn->sendMsgs + sent, pConn->numOfSends - sent, 0);
+    if (ret < 0 && errno == EINTR) continue;
+    if (ret <= 0) {
+      tError("%s failed to send %d UDP msgs(%s)", pConn->label, pConn->numOfSends - sent, strerror(errno));
+      break;
+    }
+
+    sent += ret;
+  }
+
+  pConn->numOfSends = 0;
+  pConn->sendLen = 0;
+}
+
+/*
+ * the responses sent by the receiving thread of the connection, e.g., the quick responses to the received requests,
+ * are buffered and sent out by sendmmsg after the received batch is processed. Others are sent out at once, since
+ * a request sent from a callback may be waited for before the batch ends.
+ */
 int taosSendUdpData(uint32_t ip, uint16_t port, void *data, int dataLen, void *chandle) {
   SUdpConn *pConn = (SUdpConn *)chandle;
 
@@ -240,8 +323,30 @@ int taosSendUdpData(uint32_t ip, uint16_t port, void *data, int dataLen, void *c
   destAdd.sin_addr.s_addr = ip;
   destAdd.sin_port = htons(port);
 
-  int ret = (int)sendto(pConn->fd, data, (size_t)dataLen, 0, (struct sockaddr *)&destAdd, sizeof(destAdd));
+  if (tsUdpBatchConn != pConn || rpcIsReq(((SRpcHead *)data)->msgType)) {
+    return (int)sendto(pConn->fd, data, (size_t)dataLen, 0, (struct sockaddr *)&destAdd, sizeof(destAdd));
+  }
+
+  if (pConn->numOfSends >= RPC_UDP_BATCH || pConn->sendLen + dataLen > RPC_MAX_UDP_SIZE) {
+    taosFlushUdpData(pConn);
+  }
 
-  return ret;
-}
+  if (dataLen > RPC_MAX_UDP_SIZE) {
+    return (int)sendto(pConn->fd, data, (size_t)dataLen, 0, (struct sockaddr *)&destAdd, sizeof(destAdd));
+  }
 
+  int i = pConn->numOfSends++;
+  memcpy(pConn->sendBuf + pConn->sendLen, data, (size_t)dataLen);
+  pConn->sendAddr[i] = destAdd;
+  pConn->sendIov[i].iov_base = pConn->sendBuf + pConn->sendLen;
+  pConn->sendIov[i].iov_len = (size_t)dataLen;
+
+  memset(&pConn->sendMsgs[i], 0, sizeof(struct mmsghdr));
+  pConn->sendMsgs[i].msg_hdr.msg_name = &pConn->sendAddr[i];
+  pConn->sendMsgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+  pConn->sendMsgs[i].msg_hdr.msg_iov = &pConn->sendIov[i];
+  pConn->sendMsgs[i].msg_hdr.msg_iovlen = 1;
+  pConn->sendLen += dataLen;
+
+  return dataLen;
+}
@@ -20,6 +20,8 @@
 #include "trpc.h"
 #include "taoserror.h"
 
+extern int tsRpcWanRtt;
+
 typedef struct {
   int       index;
   SRpcIpSet ipSet;
@@ -30,6 +32,7 @@ typedef struct {
   sem_t    *pOverSem; 
   pthread_t thread;
   void     *pRpc;
+  int64_t  *latency;  // round trip time of each request in microseconds
 } SInfo;
 
 static void processResponse(SRpcMsg *pMsg, SRpcIpSet *pIpSet) {
@@ -44,6 +47,18 @@ static void processResponse(SRpcMsg *pMsg, SRpcIpSet *pIpSet) {
 
 static int tcount = 0;
 
+static int64_t getTimeInUs() {
+  struct timeval systemTime;
+  gettimeofday(&systemTime, NULL);
+  return (int64_t)systemTime.tv_sec * 1000000 + systemTime.tv_usec;
+}
+
+static int compareLatency(const void *p1, const void *p2) {
+  int64_t v1 = *(int64_t *)p1;
+  int64_t v2 = *(int64_t *)p2;
+  return (v1 == v2) ? 0 : ((v1 < v2) ? -1 : 1);
+}
+
 static void *sendRequest(void *param) {
   SInfo  *pInfo = (SInfo *)param;
   SRpcMsg rpcMsg; 
@@ -57,10 +72,12 @@ static void *sendRequest(void *param) {
     rpcMsg.handle = pInfo;
     rpcMsg.msgType = 1;
     tTrace("thread:%d, send request, contLen:%d num:%d", pInfo->index, pInfo->msgSize, pInfo->num);
+    int64_t st = getTimeInUs();
     rpcSendRequest(pInfo->pRpc, &pInfo->ipSet, &rpcMsg);
     if ( pInfo->num % 20000 == 0 ) 
       tPrint("thread:%d, %d requests have been sent", pInfo->index, pInfo->num);
     sem_wait(&pInfo->rspSem);
+    if (pInfo->latency) pInfo->latency[pInfo->num - 1] = getTimeInUs() - st;
   }
 
   tTrace("thread:%d, it is over", pInfo->index);
@@ -120,6 +137,8 @@ int main(int argc, char *argv[]) {
       appThreads = atoi(argv[++i]); 
     } else if (strcmp(argv[i], "-o")==0 && i < argc-1) {
       tsCompressMsgSize = atoi(argv[++i]); 
+    } else if (strcmp(argv[i], "-r")==0 && i < argc-1) {
+      tsRpcWanRtt = atoi(argv[++i]); 
     } else if (strcmp(argv[i], "-u")==0 && i < argc-1) {
       rpcInit.user = argv[++i];
     } else if (strcmp(argv[i], "-k")==0 && i < argc-1) {
@@ -138,6 +157,7 @@ int main(int argc, char *argv[]) {
       printf("  [-a threads]: number of app threads, default is:%d\n", appThreads);
       printf("  [-n requests]: number of requests per thread, default is:%d\n", numOfReqs);
       printf("  [-o compSize]: compression message size, default is:%d\n", tsCompressMsgSize);
+      printf("  [-r rtt]: min round trip time in us for a WAN link, default is:%d\n", tsRpcWanRtt);
       printf("  [-u user]: user name for the connection, default is:%s\n", rpcInit.user);
       printf("  [-k secret]: password for the connection, default is:%s\n", rpcInit.secret);
       printf("  [-spi SPI]: security parameter index, default is:%d\n", rpcInit.spi);
@@ -172,6 +192,7 @@ int main(int argc, char *argv[]) {
     pInfo->msgSize = msgSize;
     sem_init(&pInfo->rspSem, 0, 0);
     pInfo->pRpc = pRpc;
+    if (numOfReqs > 0) pInfo->latency = (int64_t *)calloc(numOfReqs, sizeof(int64_t));
     pthread_create(&pInfo->thread, &thattr, sendRequest, pInfo);
     pInfo++;
   }
@@ -187,6 +208,29 @@ int main(int argc, char *argv[]) {
   tPrint("it takes %.3f mseconds to send %d requests to server", usedTime, numOfReqs*appThreads);
   tPrint("Performance: %.3f requests per second, msgSize:%d bytes", 1000.0*numOfReqs*appThreads/usedTime, msgSize);
 
+  // latency of all requests, only available if the number of requests is specified
+  pInfo -= appThreads;
+  if (numOfReqs > 0 && pInfo->latency) {
+    int64_t *latency = (int64_t *)calloc((size_t)numOfReqs * appThreads, sizeof(int64_t));
+    for (int i = 0; i < appThreads; ++i) {
+      memcpy(latency + (int64_t)i * numOfReqs, pInfo[i].latency, sizeof(int64_t) * numOfReqs);
+    }
+
+    int64_t total = (int64_t)numOfReqs * appThreads;
+    qsort(latency, (size_t)total, sizeof(int64_t), compareLatency);
+    tPrint("Latency: p50:%" PRId64 " us, p99:%" PRId64 " us, max:%" PRId64 " us", latency[total / 2],
+           latency[total * 99 / 100], latency[total - 1]);
+    free(latency);
+  }
+
+  if (tsCompressMsgSize >= 0) {
+    SRpcCompStat reqStat, rspStat;
+    rpcGetCompStat(&reqStat, &rspStat);
+    tPrint("Compression: requests:%" PRId64 " bytes:%" PRId64 "->%" PRId64 " time:%" PRId64 " us, responses:%" PRId64
+           " decompression time:%" PRId64 " us", reqStat.numOfComps, reqStat.origBytes, reqStat.compBytes,
+           reqStat.compTime, rspStat.numOfDecomps, rspStat.decompTime);
+  }
+
   getchar();
 
   taosCloseLog();
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * concurrency benchmark: each app thread keeps a window of requests in flight over TCP, the requests are
+ * multiplexed on the TCP links shared by the sessions, each link carries tsRpcLinkCredits sessions at most.
+ * It works with rserver.
+ */
+
+#include "os.h"
+#include "tutil.h"
+#include "tglobal.h"
+#include "rpcLog.h"
+#include "trpc.h"
+#include "taosmsg.h"
+#include "taoserror.h"
+
+extern int tsRpcLinkCredits;
+
+typedef struct {
+  int       index;
+  SRpcIpSet ipSet;
+  int       numOfReqs;
+  int       window;
+  int       msgSize;
+  int       numOfErrors;
+  sem_t     rspSem;
+  pthread_t thread;
+  void     *pRpc;
+  int64_t  *latency;  // round trip time of each request in microseconds
+} SInfo;
+
+typedef struct {
+  SInfo  *pInfo;
+  int     seq;
+  int64_t st;
+  int32_t code;
+} SReq;
+
+static int64_t getTimeInUs() {
+  struct timeval systemTime;
+  gettimeofday(&systemTime, NULL);
+  return (int64_t)systemTime.tv_sec * 1000000 + systemTime.tv_usec;
+}
+
+static int compareLatency(const void *p1, const void *p2) {
+  int64_t v1 = *(int64_t *)p1;
+  int64_t v2 = *(int64_t *)p2;
+  return (v1 == v2) ? 0 : ((v1 < v2) ? -1 : 1);
+}
+
+static void processResponse(SRpcMsg *pMsg, SRpcIpSet *pIpSet) {
+  SReq  *pReq = (SReq *)pMsg->handle;
+  SInfo *pInfo = pReq->pInfo;
+
+  tTrace("thread:%d, response is received, seq:%d contLen:%d code:0x%x", pInfo->index, pReq->seq, pMsg->contLen,
+         pMsg->code);
+
+  pInfo->latency[pReq->seq] = getTimeInUs() - pReq->st;
+  pReq->code = pMsg->code;
+  rpcFreeCont(pMsg->pCont);
+  sem_post(&pInfo->rspSem);
+}
+
+static void sendOneRequest(SInfo *pInfo, SReq *pReq, int seq) {
+  SRpcMsg rpcMsg = {0};
+
+  pReq->seq = seq;
+  pReq->st = getTimeInUs();
+  pReq->code = 0;
+
+  rpcMsg.pCont = rpcMallocCont(pInfo->msgSize);
+  rpcMsg.contLen = pInfo->msgSize;
+  rpcMsg.handle = pReq;
+  rpcMsg.msgType = TSDB_MSG_TYPE_QUERY;  // query is always sent over TCP
+  rpcSendRequest(pInfo->pRpc, &pInfo->ipSet, &rpcMsg);
+}
+
+static void *sendRequests(void *param) {
+  SInfo *pInfo = (SInfo *)param;
+  SReq  *reqs = (SReq *)calloc(pInfo->numOfReqs, sizeof(SReq));
+  int    sent = 0;
+
+  tTrace("thread:%d, start to send requests, window:%d", pInfo->index, pInfo->window);
+
+  for (; sent < pInfo->window && sent < pInfo->numOfReqs; ++sent) {
+    reqs[sent].pInfo = pInfo;
+    sendOneRequest(pInfo, reqs + sent, sent);
+  }
+
+  for (int done = 0; done < pInfo->numOfReqs; ++done) {
+    sem_wait(&pInfo->rspSem);
+    if (sent < pInfo->numOfReqs) {
+      reqs[sent].pInfo = pInfo;
+      sendOneRequest(pInfo, reqs + sent, sent);
+      sent++;
+    }
+  }
+
+  for (int i = 0; i < pInfo->numOfReqs; ++i) {
+    if (reqs[i].code != 0) pInfo->numOfErrors++;
+  }
+
+  tTrace("thread:%d, it is over", pInfo->index);
+  free(reqs);
+  return NULL;
+}
+
+int main(int argc, char *argv[]) {
+  SRpcInit  rpcInit;
+  SRpcIpSet ipSet;
+  int       msgSize = 128;
+  int       numOfReqs = 10000;
+  int       appThreads = 1;
+  int       window = 32;
+  char      serverIp[40] = "127.0.0.1";
+  char      secret[TSDB_KEY_LEN] = "mypassword";
+
+  // server info
+  ipSet.numOfIps = 1;
+  ipSet.inUse = 0;
+  ipSet.port[0] = 7000;
+  strcpy(ipSet.fqdn[0], serverIp);
+
+  // client info
+  memset(&rpcInit, 0, sizeof(rpcInit));
+  rpcInit.localPort    = 0;
+  rpcInit.label        = "APP";
+  rpcInit.numOfThreads = 1;
+  rpcInit.cfp          = processResponse;
+  rpcInit.sessions     = 1000;
+  rpcInit.idleTime     = tsShellActivityTimer*1000;
+  rpcInit.user         = "michael";
+  rpcInit.secret       = secret;
+  rpcInit.ckey         = "key";
+  rpcInit.spi          = 1;
+  rpcInit.connType     = TAOS_CONN_CLIENT;
+
+  for (int i=1; i<argc; ++i) {
+    if (strcmp(argv[i], "-p")==0 && i < argc-1) {
+      ipSet.port[0] = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-i") ==0 && i < argc-1) {
+      tstrncpy(ipSet.fqdn[0], argv[++i], sizeof(ipSet.fqdn[0]));
+    } else if (strcmp(argv[i], "-t")==0 && i < argc-1) {
+      rpcInit.numOfThreads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-m")==0 && i < argc-1) {
+      msgSize = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-s")==0 && i < argc-1) {
+      rpcInit.sessions = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-n")==0 && i < argc-1) {
+      numOfReqs = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-a")==0 && i < argc-1) {
+      appThreads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-w")==0 && i < argc-1) {
+      window = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-c")==0 && i < argc-1) {
+      tsRpcLinkCredits = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-d")==0 && i < argc-1) {
+      rpcDebugFlag = atoi(argv[++i]);
+    } else {
+      printf("\nusage: %s [options] \n", argv[0]);
+      printf("  [-i ip]: server IP address, default is:%s\n", serverIp);
+      printf("  [-p port]: server port number, default is:%d\n", ipSet.port[0]);
+      printf("  [-t threads]: number of rpc threads, default is:%d\n", rpcInit.numOfThreads);
+      printf("  [-s sessions]: number of rpc sessions, default is:%d\n", rpcInit.sessions);
+      printf("  [-m msgSize]: message body size, default is:%d\n", msgSize);
+      printf("  [-a threads]: number of app threads, default is:%d\n", appThreads);
+      printf("  [-w window]: number of requests in flight per app thread, default is:%d\n", window);
+      printf("  [-n requests]: number of requests per thread, default is:%d\n", numOfReqs);
+      printf("  [-c credits]: number of sessions sharing one TCP link, default is:%d\n", tsRpcLinkCredits);
+      printf("  [-d debugFlag]: debug flag, default:%d\n", rpcDebugFlag);
+      printf("  [-h help]: print out this help\n\n");
+      exit(0);
+    }
+  }
+
+  if (numOfReqs <= 0 || window <= 0 || tsRpcLinkCredits <= 0) {
+    printf("requests, window and credits shall be positive\n");
+    exit(0);
+  }
+
+  taosInitLog("client.log", 100000, 10);
+
+  void *pRpc = rpcOpen(&rpcInit);
+  if (pRpc == NULL) {
+    tError("failed to initialize RPC");
+    return -1;
+  }
+
+  tPrint("client is initialized, window:%d credits:%d, at least %d TCP links are needed", window, tsRpcLinkCredits,
+         (window * appThreads + tsRpcLinkCredits - 1) / tsRpcLinkCredits);
+
+  SInfo *pInfo = (SInfo *)calloc(appThreads, sizeof(SInfo));
+  int64_t startTime = getTimeInUs();
+
+  for (int i=0; i<appThreads; ++i) {
+    pInfo[i].index = i;
+    pInfo[i].ipSet = ipSet;
+    pInfo[i].numOfReqs = numOfReqs;
+    pInfo[i].window = window;
+    pInfo[i].msgSize = msgSize;
+    pInfo[i].pRpc = pRpc;
+    pInfo[i].latency = (int64_t *)calloc(numOfReqs, sizeof(int64_t));
+    sem_init(&pInfo[i].rspSem, 0, 0);
+    pthread_create(&pInfo[i].thread, NULL, sendRequests, pInfo + i);
+  }
+
+  int numOfErrors = 0;
+  for (int i=0; i<appThreads; ++i) {
+    pthread_join(pInfo[i].thread, NULL);
+    numOfErrors += pInfo[i].numOfErrors;
+  }
+
+  float usedTime = (getTimeInUs() - startTime)/1000.0;  // mseconds
+  int64_t total = (int64_t)numOfReqs * appThreads;
+
+  tPrint("it takes %.3f mseconds to send %" PRId64 " requests to server, errors:%d", usedTime, total, numOfErrors);
+  tPrint("Performance: %.3f requests per second, msgSize:%d bytes", 1000.0*total/usedTime, msgSize);
+
+  int64_t *latency = (int64_t *)calloc((size_t)total, sizeof(int64_t));
+  for (int i = 0; i < appThreads; ++i) {
+    memcpy(latency + (int64_t)i * numOfReqs, pInfo[i].latency, sizeof(int64_t) * numOfReqs);
+    free(pInfo[i].latency);
+    sem_destroy(&pInfo[i].rspSem);
+  }
+
+  qsort(latency, (size_t)total, sizeof(int64_t), compareLatency);
+  tPrint("Latency: p50:%" PRId64 " us, p99:%" PRId64 " us, max:%" PRId64 " us", latency[total / 2],
+         latency[total * 99 / 100], latency[total - 1]);
+
+  free(latency);
+  free(pInfo);
+  rpcClose(pRpc);
+  taosCloseLog();
+
+  return 0;
+}
@@ -29,6 +29,7 @@ typedef struct SCacheStatis {
   int64_t hitCount;
   int64_t totalAccess;
   int64_t refreshCount;
+  int64_t evictCount;
   int32_t numOfCollision;
 } SCacheStatis;
 
@@ -39,7 +40,14 @@ typedef struct SCacheDataNode {
   uint32_t size;         // allocated size for current SCacheDataNode
   uint16_t keySize: 15;
   bool     inTrashCan: 1;// denote if it is in trash or not
+  uint8_t  shardIndex;   // the shard that this node belongs to
+  uint8_t  wheelSlot;    // the slot of timing wheel that this node is linked into
+  int8_t   accessed;     // set when acquired, the node gets a second chance before being evicted
   T_REF_DECLARE()
+  struct SCacheDataNode *pWheelPrev;  // the list of nodes in the same slot of timing wheel
+  struct SCacheDataNode *pWheelNext;
+  struct SCacheDataNode *pLruPrev;    // the list of nodes ordered by the time of being added or given a second chance
+  struct SCacheDataNode *pLruNext;
   char *key;
   char  data[];
 } SCacheDataNode;
@@ -50,34 +58,62 @@ typedef struct STrashElem {
   SCacheDataNode    *pData;
 } STrashElem;
 
+// number of shards in one cache object, must be the power of 2
+#define CACHE_NUM_OF_SHARDS 16
+
+// number of slots in the timing wheel of one shard, each slot spans one refresh interval
+#define CACHE_NUM_OF_WHEEL_SLOTS 64
+
 /*
+ * the keys are distributed into shards by hash value, and each shard has its own hash table, trash and lock, so the
+ * operations on keys in different shards never block each other.
+ *
  * to accommodate the old data which has the same key value of new one in hashList
  * when an new node is put into cache, if an existed one with the same key:
  * 1. if the old one does not be referenced, update it.
  * 2. otherwise, move the old one to pTrash, addedTime the new one.
  *
  * when the node in pTrash does not be referenced, it will be release at the expired expiredTime
+ *
+ * the nodes are linked into the slot of timing wheel by their expired time, so the refresh worker only visits the
+ * slots of elapsed intervals instead of scanning the whole hash table. If a maximum size is set, the nodes not
+ * referenced are evicted in the order of a CLOCK list once the shard exceeds its share of the size, and an acquired
+ * node is given a second chance, which approximates LRU without taking the write lock in acquiring.
  */
-typedef struct {
-  int64_t         totalSize;          // total allocated buffer in this hash table, SCacheObj is not included.
-  int64_t         refreshTime;
-  STrashElem *    pTrash;
-  void *          tmrCtrl;
-  void *          pTimer;
-  SCacheStatis    statistics;
-  SHashObj *      pHashTable;
-  _hash_free_fn_t freeFp;
-  uint32_t        numOfElemsInTrash;  // number of element in trash
-  uint8_t         deleting;           // set the deleting flag to stop refreshing ASAP.
-  pthread_t       refreshWorker;
+typedef struct SCacheShard {
+  int64_t          totalSize;          // total allocated buffer in this shard
+  STrashElem *     pTrash;
+  SHashObj *       pHashTable;
+  SCacheStatis     statistics;
+  uint32_t         numOfElemsInTrash;  // number of element in trash
+  SCacheDataNode * pLruHead;           // the most recently added node
+  SCacheDataNode * pLruTail;
+  SCacheDataNode * wheel[CACHE_NUM_OF_WHEEL_SLOTS];
+  uint64_t         wheelTick;          // the last refresh interval whose slot has been visited
 
 #if defined(LINUX)
   pthread_rwlock_t lock;
 #else
   pthread_mutex_t lock;
 #endif
+} SCacheShard;
+
+typedef struct {
+  int64_t         refreshTime;
+  int64_t         maxSize;            // maximum size of each shard, 0 means no limit
+  _hash_fn_t      hashFp;
+  _hash_free_fn_t freeFp;
+  uint8_t         deleting;           // set the deleting flag to stop refreshing ASAP.
+  pthread_t       refreshWorker;
+  SCacheShard     shards[CACHE_NUM_OF_SHARDS];
 } SCacheObj;
 
+typedef struct SCacheIter {
+  SCacheObj *           pCacheObj;
+  int32_t               shardIndex;
+  SHashMutableIterator *pIter;
+} SCacheIter;
+
 /**
  * initialize the cache object
  * @param refreshTime       refresh operation interval time, the maximum survival time when one element is expired and
@@ -94,6 +130,14 @@ SCacheObj *taosCacheInit(int64_t refreshTimeInSeconds);
  */
 SCacheObj *taosCacheInitWithCb(int64_t refreshTimeInSeconds, void (*freeCb)(void *data));
 
+/**
+ * limit the memory used by the cache, the elements not referenced are evicted in approximately LRU order once the
+ * limit is exceeded
+ * @param pCacheObj     cache object
+ * @param maxSize       maximum size in bytes, 0 means no limit
+ */
+void taosCacheSetMaxSize(SCacheObj *pCacheObj, int64_t maxSize);
+
 /**
  * add data into cache
  *
@@ -115,7 +159,8 @@ void *taosCachePut(SCacheObj *pCacheObj, const char *key, const void *pData, siz
 void *taosCacheAcquireByName(SCacheObj *pCacheObj, const char *key);
 
 /**
- * update the expire time of data in cache 
+ * update the expire time of data in cache. The node stays in its slot of timing wheel until the slot is refreshed, so
+ * an earlier expire time takes effect no sooner than the previous one.
  * @param pCacheObj     cache object
  * @param key           key
  * @param expireTime    new expire time of data
@@ -159,6 +204,31 @@ void taosCacheRelease(SCacheObj *pCacheObj, void **data, bool _remove);
  */
 void taosCacheEmpty(SCacheObj *pCacheObj);
 
+/**
+ * get the number of elements in cache, the elements in trash are not included
+ * @param pCacheObj
+ * @return
+ */
+size_t taosCacheGetSize(SCacheObj *pCacheObj);
+
+/**
+ * get the statistics of all shards in cache
+ * @param pCacheObj
+ * @param pStatis
+ */
+void taosCacheGetStatis(SCacheObj *pCacheObj, SCacheStatis *pStatis);
+
+/**
+ * iterate the elements in cache shard by shard. Same as the iterator of hash table, the elements are not locked
+ * during iteration.
+ * @param pCacheObj
+ * @return
+ */
+SCacheIter *taosCacheCreateIter(SCacheObj *pCacheObj);
+bool        taosCacheIterNext(SCacheIter *pIter);
+void *      taosCacheIterGetData(SCacheIter *pIter);
+void        taosCacheDestroyIter(SCacheIter *pIter);
+
 /**
  * release all allocated memory and destroy the cache object.
  *
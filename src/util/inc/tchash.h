@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_TCHASH_H
+#define TDENGINE_TCHASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "os.h"
+
+/*
+ * Concurrent hash table with 8-byte integer keys, e.g., the vgroup id.
+ *
+ * The entries are kept in one open-addressing array, and the readers never take a lock: each entry carries a version
+ * that is changed before and after the key/data of the entry are overwritten, and a reader retries the entry when the
+ * version it observed was changed during the read. Writers are serialized per key by striped locks, so writers of
+ * different keys proceed in parallel. When the array is rebuilt, all writers are paused, and the old array is freed
+ * after all readers that may still reference it are finished.
+ */
+#define CHASH_NUM_OF_STRIPES 16
+
+typedef struct SCHashEntry {
+  uint32_t version;  // odd during the modification of key/data
+  int8_t   state;
+  uint64_t key;
+  void *   data;
+} SCHashEntry;
+
+typedef struct SCHashTable {
+  size_t      capacity;  // number of slots, power of 2
+  SCHashEntry entries[];
+} SCHashTable;
+
+typedef struct SCHashReaders {
+  int64_t num;
+  char    padding[64 - sizeof(int64_t)];  // avoid false sharing among the reader stripes
+} SCHashReaders;
+
+typedef struct SCHashObj {
+  SCHashTable *   pTable;
+  int64_t         size;           // number of elements in hash table
+  int64_t         numOfOccupied;  // number of slots occupied since the table is built, including the removed ones
+  int32_t         epoch;
+  SCHashReaders   readers[2][CHASH_NUM_OF_STRIPES];  // active readers of the two most recent epochs
+  pthread_mutex_t lock[CHASH_NUM_OF_STRIPES];
+} SCHashObj;
+
+/**
+ * init the concurrent hash table
+ *
+ * @param capacity    initial capacity of the hash table
+ * @return
+ */
+SCHashObj *taosCHashInit(size_t capacity);
+
+/**
+ * return the size of hash table
+ * @param pHashObj
+ * @return
+ */
+size_t taosCHashGetSize(SCHashObj *pHashObj);
+
+/**
+ * put element into hash table, if the element with the same key exists, update it
+ * @param pHashObj
+ * @param key
+ * @param data        the payload pointer, must not be NULL
+ * @return
+ */
+int32_t taosCHashPut(SCHashObj *pHashObj, uint64_t key, void *data);
+
+/**
+ * return the payload pointer with the specified key, the readers are never blocked
+ *
+ * @param pHashObj
+ * @param key
+ * @return            NULL if the key does not exist
+ */
+void *taosCHashGet(SCHashObj *pHashObj, uint64_t key);
+
+/**
+ * remove item with the specified key
+ * @param pHashObj
+ * @param key
+ */
+void taosCHashRemove(SCHashObj *pHashObj, uint64_t key);
+
+/**
+ * invoke the function on the payload of each element, the traversal never blocks the readers or writers, and the
+ * elements put or removed during the traversal may or may not be visited. fp must not put elements into the same
+ * table, since the table is not rebuilt until the traversal is finished.
+ * @param pHashObj
+ * @param fp
+ * @param param       the first argument of fp
+ */
+void taosCHashTraverse(SCHashObj *pHashObj, void (*fp)(void *param, void *data), void *param);
+
+/**
+ * clean up hash table, no readers or writers may access it any more
+ * @param pHashObj
+ */
+void taosCHashCleanup(SCHashObj *pHashObj);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_TCHASH_H
@@ -23,46 +23,124 @@
 #include "hash.h"
 #include "hashfunc.h"
 
-static FORCE_INLINE void __cache_wr_lock(SCacheObj *pCacheObj) {
+static FORCE_INLINE void __cache_wr_lock(SCacheShard *pShard) {
 #if defined(LINUX)
-  pthread_rwlock_wrlock(&pCacheObj->lock);
+  pthread_rwlock_wrlock(&pShard->lock);
 #else
-  pthread_mutex_lock(&pCacheObj->lock);
+  pthread_mutex_lock(&pShard->lock);
 #endif
 }
 
-static FORCE_INLINE void __cache_rd_lock(SCacheObj *pCacheObj) {
+static FORCE_INLINE void __cache_rd_lock(SCacheShard *pShard) {
 #if defined(LINUX)
-  pthread_rwlock_rdlock(&pCacheObj->lock);
+  pthread_rwlock_rdlock(&pShard->lock);
 #else
-  pthread_mutex_lock(&pCacheObj->lock);
+  pthread_mutex_lock(&pShard->lock);
 #endif
 }
 
-static FORCE_INLINE void __cache_unlock(SCacheObj *pCacheObj) {
+static FORCE_INLINE void __cache_unlock(SCacheShard *pShard) {
 #if defined(LINUX)
-  pthread_rwlock_unlock(&pCacheObj->lock);
+  pthread_rwlock_unlock(&pShard->lock);
 #else
-  pthread_mutex_unlock(&pCacheObj->lock);
+  pthread_mutex_unlock(&pShard->lock);
 #endif
 }
 
-static FORCE_INLINE int32_t __cache_lock_init(SCacheObj *pCacheObj) {
+static FORCE_INLINE int32_t __cache_lock_init(SCacheShard *pShard) {
 #if defined(LINUX)
-  return pthread_rwlock_init(&pCacheObj->lock, NULL);
+  return pthread_rwlock_init(&pShard->lock, NULL);
 #else
-  return pthread_mutex_init(&pCacheObj->lock, NULL);
+  return pthread_mutex_init(&pShard->lock, NULL);
 #endif
 }
 
-static FORCE_INLINE void __cache_lock_destroy(SCacheObj *pCacheObj) {
+static FORCE_INLINE void __cache_lock_destroy(SCacheShard *pShard) {
 #if defined(LINUX)
-  pthread_rwlock_destroy(&pCacheObj->lock);
+  pthread_rwlock_destroy(&pShard->lock);
 #else
-  pthread_mutex_destroy(&pCacheObj->lock);
+  pthread_mutex_destroy(&pShard->lock);
 #endif
 }
 
+/*
+ * the low bits of hash value are used to locate the slot in the hash table of shard, so the higher bits are used to
+ * locate the shard.
+ */
+static FORCE_INLINE int32_t taosGetCacheShardIndex(SCacheObj *pCacheObj, const char *key, size_t keyLen) {
+  uint32_t hashVal = (*pCacheObj->hashFp)(key, (uint32_t)keyLen);
+  return (hashVal >> 16) & (CACHE_NUM_OF_SHARDS - 1);
+}
+
+/*
+ * link the node into the slot of the interval in which it expires. The slots of elapsed intervals have been visited,
+ * so the node that has already expired is linked into the slot of next interval.
+ */
+static void taosCacheLinkToWheel(SCacheObj *pCacheObj, SCacheShard *pShard, SCacheDataNode *pNode) {
+  uint64_t tick = MAX(pNode->expiredTime / pCacheObj->refreshTime, pShard->wheelTick + 1);
+
+  pNode->wheelSlot = (uint8_t)(tick % CACHE_NUM_OF_WHEEL_SLOTS);
+  pNode->pWheelPrev = NULL;
+  pNode->pWheelNext = pShard->wheel[pNode->wheelSlot];
+  if (pNode->pWheelNext != NULL) {
+    pNode->pWheelNext->pWheelPrev = pNode;
+  }
+
+  pShard->wheel[pNode->wheelSlot] = pNode;
+}
+
+static void taosCacheUnlinkFromWheel(SCacheShard *pShard, SCacheDataNode *pNode) {
+  if (pNode->pWheelPrev != NULL) {
+    pNode->pWheelPrev->pWheelNext = pNode->pWheelNext;
+  } else {
+    pShard->wheel[pNode->wheelSlot] = pNode->pWheelNext;
+  }
+
+  if (pNode->pWheelNext != NULL) {
+    pNode->pWheelNext->pWheelPrev = pNode->pWheelPrev;
+  }
+
+  pNode->pWheelPrev = pNode->pWheelNext = NULL;
+}
+
+static void taosCacheLinkToLru(SCacheShard *pShard, SCacheDataNode *pNode) {
+  pNode->pLruPrev = NULL;
+  pNode->pLruNext = pShard->pLruHead;
+  if (pShard->pLruHead != NULL) {
+    pShard->pLruHead->pLruPrev = pNode;
+  } else {
+    pShard->pLruTail = pNode;
+  }
+
+  pShard->pLruHead = pNode;
+}
+
+static void taosCacheUnlinkFromLru(SCacheShard *pShard, SCacheDataNode *pNode) {
+  if (pNode->pLruPrev != NULL) {
+    pNode->pLruPrev->pLruNext = pNode->pLruNext;
+  } else {
+    pShard->pLruHead = pNode->pLruNext;
+  }
+
+  if (pNode->pLruNext != NULL) {
+    pNode->pLruNext->pLruPrev = pNode->pLruPrev;
+  } else {
+    pShard->pLruTail = pNode->pLruPrev;
+  }
+
+  pNode->pLruPrev = pNode->pLruNext = NULL;
+}
+
+static FORCE_INLINE void taosCacheLinkNode(SCacheObj *pCacheObj, SCacheShard *pShard, SCacheDataNode *pNode) {
+  taosCacheLinkToWheel(pCacheObj, pShard, pNode);
+  taosCacheLinkToLru(pShard, pNode);
+}
+
+static FORCE_INLINE void taosCacheUnlinkNode(SCacheShard *pShard, SCacheDataNode *pNode) {
+  taosCacheUnlinkFromWheel(pShard, pNode);
+  taosCacheUnlinkFromLru(pShard, pNode);
+}
+
 #if 0
 static FORCE_INLINE void taosFreeNode(void *data) {
   SCacheDataNode *pNode = *(SCacheDataNode **)data;
@@ -84,59 +162,99 @@ static SCacheDataNode *taosCreateCacheNode(const char *key, size_t keyLen, const
 /**
  * addedTime object node into trash, and this object is closed for referencing if it is addedTime to trash
  * It will be removed until the pNode->refCount == 0
- * @param pCacheObj    Cache object
+ * @param pShard  Cache shard
  * @param pNode   Cache slot object
  */
-static void taosAddToTrash(SCacheObj *pCacheObj, SCacheDataNode *pNode);
+static void taosAddToTrash(SCacheShard *pShard, SCacheDataNode *pNode);
 
 /**
  * remove node in trash can
  * @param pCacheObj 
+ * @param pShard
  * @param pElem 
  */
-static void taosRemoveFromTrashCan(SCacheObj *pCacheObj, STrashElem *pElem);
+static void taosRemoveFromTrashCan(SCacheObj *pCacheObj, SCacheShard *pShard, STrashElem *pElem);
 
 /**
  * remove nodes in trash with refCount == 0 in cache
- * @param pNode
  * @param pCacheObj
+ * @param pShard
  * @param force   force model, if true, remove data in trash without check refcount.
  *                may cause corruption. So, forece model only applys before cache is closed
  */
-static void taosTrashCanEmpty(SCacheObj *pCacheObj, bool force);
+static void taosTrashCanEmpty(SCacheObj *pCacheObj, SCacheShard *pShard, bool force);
 
 /**
  * release node
- * @param pCacheObj      cache object
+ * @param pCacheObj cache object
+ * @param pShard    the shard of node
  * @param pNode     data node
  */
-static FORCE_INLINE void taosCacheReleaseNode(SCacheObj *pCacheObj, SCacheDataNode *pNode) {
+static FORCE_INLINE void taosCacheReleaseNode(SCacheObj *pCacheObj, SCacheShard *pShard, SCacheDataNode *pNode) {
   if (pNode->signature != (uint64_t)pNode) {
     uError("key:%s, %p data is invalid, or has been released", pNode->key, pNode);
     return;
   }
   
   int32_t size = pNode->size;
-  taosHashRemove(pCacheObj->pHashTable, pNode->key, pNode->keySize);
+  taosHashRemove(pShard->pHashTable, pNode->key, pNode->keySize);
+  taosCacheUnlinkNode(pShard, pNode);
+  pShard->totalSize -= size;
   
-  uTrace("key:%s is removed from cache,total:%" PRId64 ",size:%dbytes", pNode->key, pCacheObj->totalSize, size);  
+  uTrace("key:%s is removed from cache,total:%" PRId64 ",size:%dbytes", pNode->key, pShard->totalSize, size);  
   if (pCacheObj->freeFp) pCacheObj->freeFp(pNode->data);
   free(pNode);
 }
 
 /**
  * move the old node into trash
- * @param pCacheObj
+ * @param pShard
  * @param pNode
  */
-static FORCE_INLINE void taosCacheMoveToTrash(SCacheObj *pCacheObj, SCacheDataNode *pNode) {
-  taosHashRemove(pCacheObj->pHashTable, pNode->key, pNode->keySize);
-  taosAddToTrash(pCacheObj, pNode);
+static FORCE_INLINE void taosCacheMoveToTrash(SCacheShard *pShard, SCacheDataNode *pNode) {
+  // the key may have been taken by a new node, which must be kept in the hash table
+  if (pNode->inTrashCan) {
+    return;
+  }
+
+  taosHashRemove(pShard->pHashTable, pNode->key, pNode->keySize);
+  taosCacheUnlinkNode(pShard, pNode);
+  taosAddToTrash(pShard, pNode);
+}
+
+/**
+ * evict the nodes not referenced from the tail of CLOCK list until the shard does not exceed its maximum size, the
+ * node acquired since it is added or given the last chance is moved to the head of list instead.
+ * @param pCacheObj
+ * @param pShard
+ */
+static void taosCacheEvictShard(SCacheObj *pCacheObj, SCacheShard *pShard) {
+  size_t numOfNodes = taosHashGetSize(pShard->pHashTable);
+
+  for (size_t i = 0; i < numOfNodes * 2 && pShard->totalSize > pCacheObj->maxSize; ++i) {
+    SCacheDataNode *pNode = pShard->pLruTail;
+    if (pNode == NULL) {
+      break;
+    }
+
+    if (pNode->accessed || T_REF_VAL_GET(pNode) > 0) {
+      pNode->accessed = 0;
+      taosCacheUnlinkFromLru(pShard, pNode);
+      taosCacheLinkToLru(pShard, pNode);
+      continue;
+    }
+
+    uTrace("key:%s %p is evicted from cache, total:%" PRId64 ", max:%" PRId64, pNode->key, pNode, pShard->totalSize,
+           pCacheObj->maxSize);
+    pShard->statistics.evictCount++;
+    taosCacheReleaseNode(pCacheObj, pShard, pNode);
+  }
 }
 
 /**
  * update data in cache
  * @param pCacheObj
+ * @param pShard
  * @param pNode
  * @param key
  * @param keyLen
@@ -144,14 +262,18 @@ static FORCE_INLINE void taosCacheMoveToTrash(SCacheObj *pCacheObj, SCacheDataNo
  * @param dataSize
  * @return
  */
-static SCacheDataNode *taosUpdateCacheImpl(SCacheObj *pCacheObj, SCacheDataNode *pNode, const char *key, int32_t keyLen,
-                                           const void *pData, uint32_t dataSize, uint64_t duration) {
+static SCacheDataNode *taosUpdateCacheImpl(SCacheObj *pCacheObj, SCacheShard *pShard, SCacheDataNode *pNode,
+                                           const char *key, int32_t keyLen, const void *pData, uint32_t dataSize,
+                                           uint64_t duration) {
   SCacheDataNode *pNewNode = NULL;
   
   // only a node is not referenced by any other object, in-place update it
   if (T_REF_VAL_GET(pNode) == 0) {
-    size_t newSize = sizeof(SCacheDataNode) + dataSize + keyLen + 1;
+    size_t  newSize = sizeof(SCacheDataNode) + dataSize + keyLen + 1;
+    uint8_t shardIndex = pNode->shardIndex;
     
+    pShard->totalSize -= pNode->size;
+    taosCacheUnlinkNode(pShard, pNode);
     pNewNode = (SCacheDataNode *)realloc(pNode, newSize);
     if (pNewNode == NULL) {
       return NULL;
@@ -159,6 +281,8 @@ static SCacheDataNode *taosUpdateCacheImpl(SCacheObj *pCacheObj, SCacheDataNode
     
     memset(pNewNode, 0, newSize);
     pNewNode->signature = (uint64_t)pNewNode;
+    pNewNode->size = (uint32_t)newSize;
+    pNewNode->shardIndex = shardIndex;
     memcpy(pNewNode->data, pData, dataSize);
     
     pNewNode->key = (char *)pNewNode + sizeof(SCacheDataNode) + dataSize;
@@ -172,43 +296,51 @@ static SCacheDataNode *taosUpdateCacheImpl(SCacheObj *pCacheObj, SCacheDataNode
     T_REF_INC(pNewNode);
     
     // the address of this node may be changed, so the prev and next element should update the corresponding pointer
-    taosHashPut(pCacheObj->pHashTable, key, keyLen, &pNewNode, sizeof(void *));
+    taosHashPut(pShard->pHashTable, key, keyLen, &pNewNode, sizeof(void *));
+    taosCacheLinkNode(pCacheObj, pShard, pNewNode);
   } else {
-    taosCacheMoveToTrash(pCacheObj, pNode);
+    taosCacheMoveToTrash(pShard, pNode);
     
     pNewNode = taosCreateCacheNode(key, keyLen, pData, dataSize, duration);
     if (pNewNode == NULL) {
       return NULL;
     }
     
+    pNewNode->shardIndex = pNode->shardIndex;
     T_REF_INC(pNewNode);
     
     // addedTime new element to hashtable
-    taosHashPut(pCacheObj->pHashTable, key, keyLen, &pNewNode, sizeof(void *));
+    taosHashPut(pShard->pHashTable, key, keyLen, &pNewNode, sizeof(void *));
+    taosCacheLinkNode(pCacheObj, pShard, pNewNode);
   }
   
+  pShard->totalSize += pNewNode->size;
   return pNewNode;
 }
 
 /**
  * addedTime data into hash table
- * @param key
- * @param pData
- * @param size
  * @param pCacheObj
+ * @param pShard
+ * @param key
  * @param keyLen
- * @param pNode
+ * @param pData
+ * @param dataSize
+ * @param duration
  * @return
  */
-static FORCE_INLINE SCacheDataNode *taosAddToCacheImpl(SCacheObj *pCacheObj, const char *key, size_t keyLen, const void *pData,
-                                                       size_t dataSize, uint64_t duration) {
+static FORCE_INLINE SCacheDataNode *taosAddToCacheImpl(SCacheObj *pCacheObj, SCacheShard *pShard, const char *key,
+                                                       size_t keyLen, const void *pData, size_t dataSize,
+                                                       uint64_t duration) {
   SCacheDataNode *pNode = taosCreateCacheNode(key, keyLen, pData, dataSize, duration);
   if (pNode == NULL) {
     return NULL;
   }
   
   T_REF_INC(pNode);
-  taosHashPut(pCacheObj->pHashTable, key, keyLen, &pNode, sizeof(void *));
+  taosHashPut(pShard->pHashTable, key, keyLen, &pNode, sizeof(void *));
+  taosCacheLinkNode(pCacheObj, pShard, pNode);
+  pShard->totalSize += pNode->size;
   return pNode;
 }
 
@@ -235,26 +367,42 @@ SCacheObj *taosCacheInitWithCb(int64_t refreshTime, void (*freeCb)(void *data))
     return NULL;
   }
   
-  pCacheObj->pHashTable = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false);
-  if (pCacheObj->pHashTable == NULL) {
+  pCacheObj->refreshTime = refreshTime * 1000;
+  uint64_t tick = taosGetTimestampMs() / pCacheObj->refreshTime;
+
+  for (int32_t i = 0; i < CACHE_NUM_OF_SHARDS; ++i) {
+    SCacheShard *pShard = &pCacheObj->shards[i];
+    pShard->wheelTick = tick;
+
+    pShard->pHashTable = taosHashInit(128, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), false);
+    if (pShard->pHashTable == NULL) {
+      uError("failed to allocate memory, reason:%s", strerror(errno));
+      break;
+    }
+
+    if (__cache_lock_init(pShard) != 0) {
+      uError("failed to init lock, reason:%s", strerror(errno));
+      taosHashCleanup(pShard->pHashTable);
+      pShard->pHashTable = NULL;
+      break;
+    }
+  }
+
+  if (pCacheObj->shards[CACHE_NUM_OF_SHARDS - 1].pHashTable == NULL) {
+    for (int32_t i = 0; i < CACHE_NUM_OF_SHARDS && pCacheObj->shards[i].pHashTable != NULL; ++i) {
+      taosHashCleanup(pCacheObj->shards[i].pHashTable);
+      __cache_lock_destroy(&pCacheObj->shards[i]);
+    }
+
     free(pCacheObj);
-    uError("failed to allocate memory, reason:%s", strerror(errno));
     return NULL;
   }
   
   // set free cache node callback function for hash table
   // taosHashSetFreecb(pCacheObj->pHashTable, taosFreeNode);
   
+  pCacheObj->hashFp = taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY);
   pCacheObj->freeFp = freeCb;
-  pCacheObj->refreshTime = refreshTime * 1000;
-
-  if (__cache_lock_init(pCacheObj) != 0) {
-    taosHashCleanup(pCacheObj->pHashTable);
-    free(pCacheObj);
-    
-    uError("failed to init lock, reason:%s", strerror(errno));
-    return NULL;
-  }
 
   pthread_attr_t thattr;
   pthread_attr_init(&thattr);
@@ -270,93 +418,117 @@ SCacheObj *taosCacheInit(int64_t refreshTime) {
   return taosCacheInitWithCb(refreshTime, NULL);
 }
 
+void taosCacheSetMaxSize(SCacheObj *pCacheObj, int64_t maxSize) {
+  if (pCacheObj == NULL || maxSize < 0) {
+    return;
+  }
+
+  // the keys are distributed evenly into shards, so is the limit
+  pCacheObj->maxSize = maxSize / CACHE_NUM_OF_SHARDS;
+}
+
 void *taosCachePut(SCacheObj *pCacheObj, const char *key, const void *pData, size_t dataSize, int duration) {
   SCacheDataNode *pNode;
   
-  if (pCacheObj == NULL || pCacheObj->pHashTable == NULL) {
+  if (pCacheObj == NULL) {
     return NULL;
   }
   
-  size_t keyLen = strlen(key);
+  size_t       keyLen = strlen(key);
+  int32_t      index = taosGetCacheShardIndex(pCacheObj, key, keyLen);
+  SCacheShard *pShard = &pCacheObj->shards[index];
   
-  __cache_wr_lock(pCacheObj);
-  SCacheDataNode **pt = (SCacheDataNode **)taosHashGet(pCacheObj->pHashTable, key, keyLen);
+  __cache_wr_lock(pShard);
+  SCacheDataNode **pt = (SCacheDataNode **)taosHashGet(pShard->pHashTable, key, keyLen);
   SCacheDataNode * pOld = (pt != NULL) ? (*pt) : NULL;
   
   if (pOld == NULL) {  // do addedTime to cache
-    pNode = taosAddToCacheImpl(pCacheObj, key, keyLen, pData, dataSize, duration * 1000L);
+    pNode = taosAddToCacheImpl(pCacheObj, pShard, key, keyLen, pData, dataSize, duration * 1000L);
     if (NULL != pNode) {
-      pCacheObj->totalSize += pNode->size;
-      
+      pNode->shardIndex = (uint8_t)index;
       uTrace("key:%s %p added into cache, added:%" PRIu64 ", expire:%" PRIu64 ", total:%" PRId64 ", size:%" PRId64 " bytes",
-             key, pNode, pNode->addedTime, pNode->expiredTime, pCacheObj->totalSize, dataSize);
+             key, pNode, pNode->addedTime, pNode->expiredTime, pShard->totalSize, dataSize);
     } else {
       uError("key:%s failed to added into cache, out of memory", key);
     }
   } else {  // old data exists, update the node
-    pNode = taosUpdateCacheImpl(pCacheObj, pOld, key, keyLen, pData, dataSize, duration * 1000L);
+    pNode = taosUpdateCacheImpl(pCacheObj, pShard, pOld, key, keyLen, pData, dataSize, duration * 1000L);
     uTrace("key:%s %p exist in cache, updated", key, pNode);
   }
+
+  if (pCacheObj->maxSize > 0 && pShard->totalSize > pCacheObj->maxSize) {
+    taosCacheEvictShard(pCacheObj, pShard);
+  }
   
-  __cache_unlock(pCacheObj);
+  __cache_unlock(pShard);
   
   return (pNode != NULL) ? pNode->data : NULL;
 }
 
 void *taosCacheAcquireByName(SCacheObj *pCacheObj, const char *key) {
-  if (pCacheObj == NULL || taosHashGetSize(pCacheObj->pHashTable) == 0) {
+  if (pCacheObj == NULL) {
     return NULL;
   }
   
-  uint32_t keyLen = (uint32_t)strlen(key);
+  uint32_t     keyLen = (uint32_t)strlen(key);
+  SCacheShard *pShard = &pCacheObj->shards[taosGetCacheShardIndex(pCacheObj, key, keyLen)];
+  if (taosHashGetSize(pShard->pHashTable) == 0) {
+    return NULL;
+  }
   
-  __cache_rd_lock(pCacheObj);
+  __cache_rd_lock(pShard);
   
-  SCacheDataNode **ptNode = (SCacheDataNode **)taosHashGet(pCacheObj->pHashTable, key, keyLen);
+  SCacheDataNode **ptNode = (SCacheDataNode **)taosHashGet(pShard->pHashTable, key, keyLen);
   if (ptNode != NULL) {
     T_REF_INC(*ptNode);
+    (*ptNode)->accessed = 1;
   }
   
-  __cache_unlock(pCacheObj);
+  __cache_unlock(pShard);
   
   if (ptNode != NULL) {
-    atomic_add_fetch_32(&pCacheObj->statistics.hitCount, 1);
+    atomic_add_fetch_64(&pShard->statistics.hitCount, 1);
     uTrace("key:%s is retrieved from cache, %p refcnt:%d", key, (*ptNode), T_REF_VAL_GET(*ptNode));
   } else {
-    atomic_add_fetch_32(&pCacheObj->statistics.missCount, 1);
+    atomic_add_fetch_64(&pShard->statistics.missCount, 1);
     uTrace("key:%s not in cache, retrieved failed", key);
   }
   
-  atomic_add_fetch_32(&pCacheObj->statistics.totalAccess, 1);
+  atomic_add_fetch_64(&pShard->statistics.totalAccess, 1);
   return (ptNode != NULL) ? (*ptNode)->data : NULL;
 }
 
 void* taosCacheUpdateExpireTimeByName(SCacheObj *pCacheObj, const char *key, uint64_t expireTime) {
-  if (pCacheObj == NULL || taosHashGetSize(pCacheObj->pHashTable) == 0) {
+  if (pCacheObj == NULL) {
     return NULL;
   }
   
-  uint32_t keyLen = (uint32_t)strlen(key);
+  uint32_t     keyLen = (uint32_t)strlen(key);
+  SCacheShard *pShard = &pCacheObj->shards[taosGetCacheShardIndex(pCacheObj, key, keyLen)];
+  if (taosHashGetSize(pShard->pHashTable) == 0) {
+    return NULL;
+  }
   
-  __cache_rd_lock(pCacheObj);
+  __cache_rd_lock(pShard);
   
-  SCacheDataNode **ptNode = (SCacheDataNode **)taosHashGet(pCacheObj->pHashTable, key, keyLen);
+  SCacheDataNode **ptNode = (SCacheDataNode **)taosHashGet(pShard->pHashTable, key, keyLen);
   if (ptNode != NULL) {
-     T_REF_INC(*ptNode);
+    T_REF_INC(*ptNode);
+    (*ptNode)->accessed = 1;
     (*ptNode)->expiredTime = expireTime;
   }
   
-  __cache_unlock(pCacheObj);
+  __cache_unlock(pShard);
   
   if (ptNode != NULL) {
-    atomic_add_fetch_32(&pCacheObj->statistics.hitCount, 1);
+    atomic_add_fetch_64(&pShard->statistics.hitCount, 1);
     uTrace("key:%s expireTime is updated in cache, %p refcnt:%d", key, (*ptNode), T_REF_VAL_GET(*ptNode));
   } else {
-    atomic_add_fetch_32(&pCacheObj->statistics.missCount, 1);
+    atomic_add_fetch_64(&pShard->statistics.missCount, 1);
     uTrace("key:%s not in cache, retrieved failed", key);
   }
   
-  atomic_add_fetch_32(&pCacheObj->statistics.totalAccess, 1);
+  atomic_add_fetch_64(&pShard->statistics.totalAccess, 1);
   return (ptNode != NULL) ? (*ptNode)->data : NULL;
 }
 
@@ -401,7 +573,7 @@ void *taosCacheTransfer(SCacheObj *pCacheObj, void **data) {
 }
 
 void taosCacheRelease(SCacheObj *pCacheObj, void **data, bool _remove) {
-  if (pCacheObj == NULL || (*data) == NULL || (taosHashGetSize(pCacheObj->pHashTable) + pCacheObj->numOfElemsInTrash == 0)) {
+  if (pCacheObj == NULL || (*data) == NULL) {
     return;
   }
   
@@ -414,35 +586,108 @@ void taosCacheRelease(SCacheObj *pCacheObj, void **data, bool _remove) {
     return;
   }
   
+  SCacheShard *pShard = &pCacheObj->shards[pNode->shardIndex];
+  if (taosHashGetSize(pShard->pHashTable) + pShard->numOfElemsInTrash == 0) {
+    return;
+  }
+  
   *data = NULL;
   int16_t ref = T_REF_DEC(pNode);
   uTrace("%p data released, refcnt:%d", pNode, ref);
   
   if (_remove) {
-    __cache_wr_lock(pCacheObj);
+    __cache_wr_lock(pShard);
     // pNode may be released immediately by other thread after the reference count of pNode is set to 0,
     // So we need to lock it in the first place.
-    taosCacheMoveToTrash(pCacheObj, pNode);
-    __cache_unlock(pCacheObj);
+    taosCacheMoveToTrash(pShard, pNode);
+    __cache_unlock(pShard);
   }
 }
 
 void taosCacheEmpty(SCacheObj *pCacheObj) {
-  SHashMutableIterator *pIter = taosHashCreateIter(pCacheObj->pHashTable);
-  
-  __cache_wr_lock(pCacheObj);
-  while (taosHashIterNext(pIter)) {
-    if (pCacheObj->deleting == 1) {
-      break;
+  for (int32_t i = 0; i < CACHE_NUM_OF_SHARDS; ++i) {
+    SCacheShard *pShard = &pCacheObj->shards[i];
+    SHashMutableIterator *pIter = taosHashCreateIter(pShard->pHashTable);
+    
+    __cache_wr_lock(pShard);
+    while (taosHashIterNext(pIter)) {
+      if (pCacheObj->deleting == 1) {
+        break;
+      }
+      
+      SCacheDataNode *pNode = *(SCacheDataNode **)taosHashIterGet(pIter);
+      taosCacheMoveToTrash(pShard, pNode);
     }
+    __cache_unlock(pShard);
     
-    SCacheDataNode *pNode = *(SCacheDataNode **)taosHashIterGet(pIter);
-    taosCacheMoveToTrash(pCacheObj, pNode);
+    taosHashDestroyIter(pIter);
+    taosTrashCanEmpty(pCacheObj, pShard, false);
   }
-  __cache_unlock(pCacheObj);
-  
-  taosHashDestroyIter(pIter);
-  taosTrashCanEmpty(pCacheObj, false);
+}
+
+size_t taosCacheGetSize(SCacheObj *pCacheObj) {
+  size_t size = 0;
+  for (int32_t i = 0; i < CACHE_NUM_OF_SHARDS; ++i) {
+    size += taosHashGetSize(pCacheObj->shards[i].pHashTable);
+  }
+
+  return size;
+}
+
+void taosCacheGetStatis(SCacheObj *pCacheObj, SCacheStatis *pStatis) {
+  memset(pStatis, 0, sizeof(SCacheStatis));
+
+  for (int32_t i = 0; i < CACHE_NUM_OF_SHARDS; ++i) {
+    SCacheStatis *p = &pCacheObj->shards[i].statistics;
+    pStatis->missCount += p->missCount;
+    pStatis->hitCount += p->hitCount;
+    pStatis->totalAccess += p->totalAccess;
+    pStatis->evictCount += p->evictCount;
+    pStatis->numOfCollision += p->numOfCollision;
+    pStatis->refreshCount = MAX(pStatis->refreshCount, p->refreshCount);
+  }
+}
+
+SCacheIter *taosCacheCreateIter(SCacheObj *pCacheObj) {
+  SCacheIter *pIter = calloc(1, sizeof(SCacheIter));
+  if (pIter == NULL) {
+    return NULL;
+  }
+
+  pIter->pCacheObj = pCacheObj;
+  pIter->pIter = taosHashCreateIter(pCacheObj->shards[0].pHashTable);
+  return pIter;
+}
+
+bool taosCacheIterNext(SCacheIter *pIter) {
+  while (pIter->pIter != NULL) {
+    if (taosHashIterNext(pIter->pIter)) {
+      return true;
+    }
+
+    taosHashDestroyIter(pIter->pIter);
+    pIter->pIter = NULL;
+
+    if (++pIter->shardIndex < CACHE_NUM_OF_SHARDS) {
+      pIter->pIter = taosHashCreateIter(pIter->pCacheObj->shards[pIter->shardIndex].pHashTable);
+    }
+  }
+
+  return false;
+}
+
+void *taosCacheIterGetData(SCacheIter *pIter) {
+  SCacheDataNode **pNode = taosHashIterGet(pIter->pIter);
+  return (pNode != NULL && *pNode != NULL) ? (*pNode)->data : NULL;
+}
+
+void taosCacheDestroyIter(SCacheIter *pIter) {
+  if (pIter == NULL) {
+    return;
+  }
+
+  taosHashDestroyIter(pIter->pIter);
+  free(pIter);
 }
 
 void taosCacheCleanup(SCacheObj *pCacheObj) {
@@ -482,7 +727,7 @@ SCacheDataNode *taosCreateCacheNode(const char *key, size_t keyLen, const char *
   return pNewNode;
 }
 
-void taosAddToTrash(SCacheObj *pCacheObj, SCacheDataNode *pNode) {
+void taosAddToTrash(SCacheShard *pShard, SCacheDataNode *pNode) {
   if (pNode->inTrashCan) { /* node is already in trash */
     return;
   }
@@ -490,57 +735,58 @@ void taosAddToTrash(SCacheObj *pCacheObj, SCacheDataNode *pNode) {
   STrashElem *pElem = calloc(1, sizeof(STrashElem));
   pElem->pData = pNode;
 
-  pElem->next = pCacheObj->pTrash;
-  if (pCacheObj->pTrash) {
-    pCacheObj->pTrash->prev = pElem;
+  pElem->next = pShard->pTrash;
+  if (pShard->pTrash) {
+    pShard->pTrash->prev = pElem;
   }
 
   pElem->prev = NULL;
-  pCacheObj->pTrash = pElem;
+  pShard->pTrash = pElem;
 
   pNode->inTrashCan = true;
-  pCacheObj->numOfElemsInTrash++;
+  pShard->numOfElemsInTrash++;
 
-  uTrace("key:%s %p move to trash, numOfElem in trash:%d", pNode->key, pNode, pCacheObj->numOfElemsInTrash);
+  uTrace("key:%s %p move to trash, numOfElem in trash:%d", pNode->key, pNode, pShard->numOfElemsInTrash);
 }
 
-void taosRemoveFromTrashCan(SCacheObj *pCacheObj, STrashElem *pElem) {
+void taosRemoveFromTrashCan(SCacheObj *pCacheObj, SCacheShard *pShard, STrashElem *pElem) {
   if (pElem->pData->signature != (uint64_t)pElem->pData) {
     uError("key:sig:0x%" PRIx64 " %p data has been released, ignore", pElem->pData->signature, pElem->pData);
     return;
   }
 
-  pCacheObj->numOfElemsInTrash--;
+  pShard->numOfElemsInTrash--;
   if (pElem->prev) {
     pElem->prev->next = pElem->next;
   } else { /* pnode is the header, update header */
-    pCacheObj->pTrash = pElem->next;
+    pShard->pTrash = pElem->next;
   }
 
   if (pElem->next) {
     pElem->next->prev = pElem->prev;
   }
 
+  pShard->totalSize -= pElem->pData->size;
   pElem->pData->signature = 0;
   if (pCacheObj->freeFp) pCacheObj->freeFp(pElem->pData->data);
   free(pElem->pData);
   free(pElem);
 }
 
-void taosTrashCanEmpty(SCacheObj *pCacheObj, bool force) {
-  __cache_wr_lock(pCacheObj);
+void taosTrashCanEmpty(SCacheObj *pCacheObj, SCacheShard *pShard, bool force) {
+  __cache_wr_lock(pShard);
 
-  if (pCacheObj->numOfElemsInTrash == 0) {
-    if (pCacheObj->pTrash != NULL) {
-      uError("key:inconsistency data in cache, numOfElem in trash:%d", pCacheObj->numOfElemsInTrash);
+  if (pShard->numOfElemsInTrash == 0) {
+    if (pShard->pTrash != NULL) {
+      uError("key:inconsistency data in cache, numOfElem in trash:%d", pShard->numOfElemsInTrash);
     }
-    pCacheObj->pTrash = NULL;
+    pShard->pTrash = NULL;
 
-    __cache_unlock(pCacheObj);
+    __cache_unlock(pShard);
     return;
   }
 
-  STrashElem *pElem = pCacheObj->pTrash;
+  STrashElem *pElem = pShard->pTrash;
 
   while (pElem) {
     T_REF_VAL_CHECK(pElem->pData);
@@ -550,41 +796,82 @@ void taosTrashCanEmpty(SCacheObj *pCacheObj, bool force) {
 
     if (force || (T_REF_VAL_GET(pElem->pData) == 0)) {
       uTrace("key:%s %p removed from trash. numOfElem in trash:%d", pElem->pData->key, pElem->pData,
-             pCacheObj->numOfElemsInTrash - 1);
+             pShard->numOfElemsInTrash - 1);
       STrashElem *p = pElem;
 
       pElem = pElem->next;
-      taosRemoveFromTrashCan(pCacheObj, p);
+      taosRemoveFromTrashCan(pCacheObj, pShard, p);
     } else {
       pElem = pElem->next;
     }
   }
 
-  __cache_unlock(pCacheObj);
+  __cache_unlock(pShard);
 }
 
 void doCleanupDataCache(SCacheObj *pCacheObj) {
-  __cache_wr_lock(pCacheObj);
+  for (int32_t i = 0; i < CACHE_NUM_OF_SHARDS; ++i) {
+    SCacheShard *pShard = &pCacheObj->shards[i];
+    __cache_wr_lock(pShard);
 
-  SHashMutableIterator *pIter = taosHashCreateIter(pCacheObj->pHashTable);
-  while (taosHashIterNext(pIter)) {
-    SCacheDataNode *pNode = *(SCacheDataNode **)taosHashIterGet(pIter);
-    // if (pNode->expiredTime <= expiredTime && T_REF_VAL_GET(pNode) <= 0) {
-    taosCacheReleaseNode(pCacheObj, pNode);
-    //}
-  }
-  taosHashDestroyIter(pIter);
+    SHashMutableIterator *pIter = taosHashCreateIter(pShard->pHashTable);
+    while (taosHashIterNext(pIter)) {
+      SCacheDataNode *pNode = *(SCacheDataNode **)taosHashIterGet(pIter);
+      // if (pNode->expiredTime <= expiredTime && T_REF_VAL_GET(pNode) <= 0) {
+      taosCacheReleaseNode(pCacheObj, pShard, pNode);
+      //}
+    }
+    taosHashDestroyIter(pIter);
 
-  taosHashCleanup(pCacheObj->pHashTable); 
-  __cache_unlock(pCacheObj);
+    taosHashCleanup(pShard->pHashTable); 
+    __cache_unlock(pShard);
 
-  taosTrashCanEmpty(pCacheObj, true);
-  __cache_lock_destroy(pCacheObj);
+    taosTrashCanEmpty(pCacheObj, pShard, true);
+    __cache_lock_destroy(pShard);
+  }
 
   memset(pCacheObj, 0, sizeof(SCacheObj));
   free(pCacheObj);
 }
 
+/*
+ * remove the expired nodes of one shard, only the slots of timing wheel for the intervals elapsed since the last refresh
+ * are visited. Only this shard is locked while the other shards are still available.
+ */
+static void doRefreshCacheShard(SCacheObj *pCacheObj, SCacheShard *pShard, uint64_t expiredTime) {
+  pShard->statistics.refreshCount++;
+
+  uint64_t tick = expiredTime / pCacheObj->refreshTime;
+
+  __cache_wr_lock(pShard);
+
+  // all slots are visited once if the refresh is delayed for more than a round of the wheel
+  uint64_t start = MAX(pShard->wheelTick + 1, tick + 1 - MIN(tick + 1, CACHE_NUM_OF_WHEEL_SLOTS));
+  pShard->wheelTick = MAX(pShard->wheelTick, tick);
+
+  for (uint64_t t = start; t <= tick; ++t) {
+    SCacheDataNode *pNode = pShard->wheel[t % CACHE_NUM_OF_WHEEL_SLOTS];
+
+    while (pNode != NULL) {
+      SCacheDataNode *pNext = pNode->pWheelNext;
+
+      if (pNode->expiredTime <= expiredTime && T_REF_VAL_GET(pNode) <= 0) {
+        taosCacheReleaseNode(pCacheObj, pShard, pNode);
+      } else {
+        // the node expires in the later rounds, or is still referenced and checked again in the next interval
+        taosCacheUnlinkFromWheel(pShard, pNode);
+        taosCacheLinkToWheel(pCacheObj, pShard, pNode);
+      }
+
+      pNode = pNext;
+    }
+  }
+
+  __cache_unlock(pShard);
+
+  taosTrashCanEmpty(pCacheObj, pShard, false);
+}
+
 void* taosCacheRefresh(void *handle) {
   SCacheObj *pCacheObj = (SCacheObj *)handle;
   if (pCacheObj == NULL) {
@@ -610,28 +897,11 @@ void* taosCacheRefresh(void *handle) {
 
     // reset the count value
     count = 0;
-    size_t num = taosHashGetSize(pCacheObj->pHashTable);
-    if (num == 0) {
-      continue;
-    }
-
     uint64_t expiredTime = taosGetTimestampMs();
-    pCacheObj->statistics.refreshCount++;
-
-    SHashMutableIterator *pIter = taosHashCreateIter(pCacheObj->pHashTable);
 
-    __cache_wr_lock(pCacheObj);
-    while (taosHashIterNext(pIter)) {
-      SCacheDataNode *pNode = *(SCacheDataNode **)taosHashIterGet(pIter);
-      if (pNode->expiredTime <= expiredTime && T_REF_VAL_GET(pNode) <= 0) {
-        taosCacheReleaseNode(pCacheObj, pNode);
-      }
+    for (int32_t i = 0; i < CACHE_NUM_OF_SHARDS && !pCacheObj->deleting; ++i) {
+      doRefreshCacheShard(pCacheObj, &pCacheObj->shards[i], expiredTime);
     }
-
-    __cache_unlock(pCacheObj);
-
-    taosHashDestroyIter(pIter);
-    taosTrashCanEmpty(pCacheObj, false);
   }
 
   return NULL;
@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+#include "tchash.h"
+#include "tulog.h"
+#include "tutil.h"
+
+#define CHASH_MIN_CAPACITY 64
+#define CHASH_MAX_LOAD(c) (((c) >> 2) * 3)
+#define CHASH_STRIPE(v) (((v) >> 32) & (CHASH_NUM_OF_STRIPES - 1))
+
+/*
+ * The state of an entry only moves along EMPTY -> CLAIMED -> USED -> DELETED -> CLAIMED -> ..., and never goes back
+ * to EMPTY until the table is rebuilt, so the probe sequence of the readers, which stops at the first EMPTY entry, is
+ * never cut short by the writers.
+ */
+enum {
+  CHASH_ENTRY_EMPTY = 0,
+  CHASH_ENTRY_CLAIMED = 1,  // owned by a writer that is filling the key and data
+  CHASH_ENTRY_USED = 2,
+  CHASH_ENTRY_DELETED = 3,
+};
+
+static threadlocal int32_t tsCHashReaderStripe = -1;
+static int32_t             tsCHashNumOfReaders = 0;
+
+static FORCE_INLINE uint64_t taosCHashKey(uint64_t key) {
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53ULL;
+  key ^= key >> 33;
+  return key;
+}
+
+static FORCE_INLINE int64_t *taosCHashEnterRead(SCHashObj *pHashObj) {
+  if (tsCHashReaderStripe < 0) {
+    tsCHashReaderStripe = atomic_fetch_add_32(&tsCHashNumOfReaders, 1) & (CHASH_NUM_OF_STRIPES - 1);
+  }
+
+  int32_t  epoch = atomic_load_32(&pHashObj->epoch) & 1;
+  int64_t *pNum = &pHashObj->readers[epoch][tsCHashReaderStripe].num;
+  atomic_add_fetch_64(pNum, 1);
+  return pNum;
+}
+
+static FORCE_INLINE void taosCHashLeaveRead(int64_t *pNum) { atomic_sub_fetch_64(pNum, 1); }
+
+/*
+ * wait for the readers of the previous table to leave. Readers that enter after the new table is published only see
+ * the new one, and they register themselves in the new epoch, so the wait is not starved by them.
+ */
+static void taosCHashSynchronize(SCHashObj *pHashObj) {
+  for (int32_t k = 0; k < 2; ++k) {
+    int32_t epoch = atomic_fetch_add_32(&pHashObj->epoch, 1) & 1;
+
+    for (int32_t i = 0; i < CHASH_NUM_OF_STRIPES; ++i) {
+      while (atomic_load_64(&pHashObj->readers[epoch][i].num) != 0) {
+        taosMsleep(0);
+      }
+    }
+  }
+}
+
+static SCHashTable *taosCHashCreateTable(size_t capacity) {
+  SCHashTable *pTable = calloc(1, sizeof(SCHashTable) + capacity * sizeof(SCHashEntry));
+  if (pTable == NULL) {
+    return NULL;
+  }
+
+  pTable->capacity = capacity;
+  return pTable;
+}
+
+// the writer checks the table without any stripe lock, so it must be registered as a reader as well
+static FORCE_INLINE bool taosCHashNeedResize(SCHashObj *pHashObj) {
+  int64_t *pReaders = taosCHashEnterRead(pHashObj);
+
+  SCHashTable *pTable = atomic_load_ptr(&pHashObj->pTable);
+  bool         ret = atomic_load_64(&pHashObj->numOfOccupied) + CHASH_NUM_OF_STRIPES >= CHASH_MAX_LOAD(pTable->capacity);
+
+  taosCHashLeaveRead(pReaders);
+  return ret;
+}
+
+/*
+ * rebuild the table with all writers paused. The capacity is doubled only when the live elements occupy a half of
+ * the table, otherwise the table is rebuilt in the same size to drop the removed entries.
+ */
+static void taosCHashResize(SCHashObj *pHashObj) {
+  for (int32_t i = 0; i < CHASH_NUM_OF_STRIPES; ++i) {
+    pthread_mutex_lock(&pHashObj->lock[i]);
+  }
+
+  if (taosCHashNeedResize(pHashObj)) {
+    SCHashTable *pOld = pHashObj->pTable;
+    size_t       capacity = pOld->capacity;
+    if (pHashObj->size >= (int64_t)(capacity >> 1)) {
+      capacity <<= 1;
+    }
+
+    SCHashTable *pNew = taosCHashCreateTable(capacity);
+    if (pNew == NULL) {
+      uError("failed to resize concurrent hash table to %" PRIu64 " slots", (uint64_t)capacity);
+    } else {
+      size_t mask = capacity - 1;
+      for (size_t i = 0; i < pOld->capacity; ++i) {
+        SCHashEntry *pEntry = &pOld->entries[i];
+        if (pEntry->state != CHASH_ENTRY_USED) {
+          continue;
+        }
+
+        size_t slot = taosCHashKey(pEntry->key) & mask;
+        while (pNew->entries[slot].state != CHASH_ENTRY_EMPTY) {
+          slot = (slot + 1) & mask;
+        }
+
+        pNew->entries[slot].key = pEntry->key;
+        pNew->entries[slot].data = pEntry->data;
+        pNew->entries[slot].state = CHASH_ENTRY_USED;
+      }
+
+      atomic_store_64(&pHashObj->numOfOccupied, pHashObj->size);
+      atomic_store_ptr(&pHashObj->pTable, pNew);
+
+      taosCHashSynchronize(pHashObj);
+      free(pOld);
+    }
+  }
+
+  for (int32_t i = CHASH_NUM_OF_STRIPES - 1; i >= 0; --i) {
+    pthread_mutex_unlock(&pHashObj->lock[i]);
+  }
+}
+
+SCHashObj *taosCHashInit(size_t capacity) {
+  size_t num = CHASH_MIN_CAPACITY;
+  while (num < capacity + (capacity >> 1)) {
+    num <<= 1;
+  }
+
+  SCHashObj *pHashObj = (SCHashObj *)calloc(1, sizeof(SCHashObj));
+  if (pHashObj == NULL) {
+    uError("failed to allocate memory, reason:%s", strerror(errno));
+    return NULL;
+  }
+
+  pHashObj->pTable = taosCHashCreateTable(num);
+  if (pHashObj->pTable == NULL) {
+    uError("failed to allocate memory, reason:%s", strerror(errno));
+    free(pHashObj);
+    return NULL;
+  }
+
+  for (int32_t i = 0; i < CHASH_NUM_OF_STRIPES; ++i) {
+    pthread_mutex_init(&pHashObj->lock[i], NULL);
+  }
+
+  return pHashObj;
+}
+
+size_t taosCHashGetSize(SCHashObj *pHashObj) {
+  if (pHashObj == NULL) {
+    return 0;
+  }
+
+  return (size_t)atomic_load_64(&pHashObj->size);
+}
+
+int32_t taosCHashPut(SCHashObj *pHashObj, uint64_t key, void *data) {
+  if (pHashObj == NULL || data == NULL) {
+    return -1;
+  }
+
+  uint64_t hashVal = taosCHashKey(key);
+  if (taosCHashNeedResize(pHashObj)) {
+    taosCHashResize(pHashObj);
+  }
+
+  pthread_mutex_t *pLock = &pHashObj->lock[CHASH_STRIPE(hashVal)];
+  pthread_mutex_lock(pLock);
+
+  // the table is not replaced while any stripe lock is held
+  SCHashTable *pTable = pHashObj->pTable;
+  size_t       mask = pTable->capacity - 1;
+
+  // the entries of this key are only changed by the holder of its stripe lock
+  for (size_t i = 0; i < pTable->capacity; ++i) {
+    SCHashEntry *pEntry = &pTable->entries[(hashVal + i) & mask];
+    int8_t       state = atomic_load_8(&pEntry->state);
+    if (state == CHASH_ENTRY_EMPTY) {
+      break;
+    }
+
+    if (state == CHASH_ENTRY_USED && pEntry->key == key) {
+      atomic_add_fetch_32(&pEntry->version, 1);
+      atomic_store_ptr(&pEntry->data, data);
+      atomic_add_fetch_32(&pEntry->version, 1);
+
+      pthread_mutex_unlock(pLock);
+      return 0;
+    }
+  }
+
+  // claim the first free entry, which may be contended by the writers of other stripes
+  for (size_t i = 0; i < pTable->capacity; ++i) {
+    SCHashEntry *pEntry = &pTable->entries[(hashVal + i) & mask];
+    int8_t       state = atomic_load_8(&pEntry->state);
+    if (state != CHASH_ENTRY_EMPTY && state != CHASH_ENTRY_DELETED) {
+      continue;
+    }
+
+    if (atomic_val_compare_exchange_8(&pEntry->state, state, CHASH_ENTRY_CLAIMED) != state) {
+      continue;
+    }
+
+    if (state == CHASH_ENTRY_EMPTY) {
+      atomic_add_fetch_64(&pHashObj->numOfOccupied, 1);
+    }
+
+    atomic_add_fetch_32(&pEntry->version, 1);
+    atomic_store_64(&pEntry->key, key);
+    atomic_store_ptr(&pEntry->data, data);
+    atomic_add_fetch_32(&pEntry->version, 1);
+    atomic_store_8(&pEntry->state, CHASH_ENTRY_USED);
+
+    atomic_add_fetch_64(&pHashObj->size, 1);
+    pthread_mutex_unlock(pLock);
+    return 0;
+  }
+
+  pthread_mutex_unlock(pLock);
+  uError("concurrent hash table is full, capacity:%" PRIu64, (uint64_t)pTable->capacity);
+  return -1;
+}
+
+void *taosCHashGet(SCHashObj *pHashObj, uint64_t key) {
+  if (pHashObj == NULL) {
+    return NULL;
+  }
+
+  uint64_t hashVal = taosCHashKey(key);
+  int64_t *pReaders = taosCHashEnterRead(pHashObj);
+
+  SCHashTable *pTable = atomic_load_ptr(&pHashObj->pTable);
+  size_t       mask = pTable->capacity - 1;
+  void *       data = NULL;
+
+  for (size_t i = 0; i < pTable->capacity; ++i) {
+    SCHashEntry *pEntry = &pTable->entries[(hashVal + i) & mask];
+
+    uint32_t version = 0;
+    int8_t   state = 0;
+    uint64_t k = 0;
+    void *   d = NULL;
+
+    do {
+      version = atomic_load_32(&pEntry->version);
+      state = atomic_load_8(&pEntry->state);
+      k = atomic_load_64(&pEntry->key);
+      d = atomic_load_ptr(&pEntry->data);
+    } while ((version & 1) != 0 || version != atomic_load_32(&pEntry->version));
+
+    if (state == CHASH_ENTRY_EMPTY) {
+      break;
+    }
+
+    if (state == CHASH_ENTRY_USED && k == key) {
+      data = d;
+      break;
+    }
+  }
+
+  taosCHashLeaveRead(pReaders);
+  return data;
+}
+
+void taosCHashRemove(SCHashObj *pHashObj, uint64_t key) {
+  if (pHashObj == NULL) {
+    return;
+  }
+
+  uint64_t         hashVal = taosCHashKey(key);
+  pthread_mutex_t *pLock = &pHashObj->lock[CHASH_STRIPE(hashVal)];
+  pthread_mutex_lock(pLock);
+
+  SCHashTable *pTable = pHashObj->pTable;
+  size_t       mask = pTable->capacity - 1;
+
+  for (size_t i = 0; i < pTable->capacity; ++i) {
+    SCHashEntry *pEntry = &pTable->entries[(hashVal + i) & mask];
+    int8_t       state = atomic_load_8(&pEntry->state);
+    if (state == CHASH_ENTRY_EMPTY) {
+      break;
+    }
+
+    // key and data are left intact, a reader that has seen the entry in use still gets a consistent payload
+    if (state == CHASH_ENTRY_USED && pEntry->key == key) {
+      atomic_store_8(&pEntry->state, CHASH_ENTRY_DELETED);
+      atomic_sub_fetch_64(&pHashObj->size, 1);
+      break;
+    }
+  }
+
+  pthread_mutex_unlock(pLock);
+}
+
+void taosCHashTraverse(SCHashObj *pHashObj, void (*fp)(void *param, void *data), void *param) {
+  if (pHashObj == NULL) {
+    return;
+  }
+
+  int64_t *pReaders = taosCHashEnterRead(pHashObj);
+  SCHashTable *pTable = atomic_load_ptr(&pHashObj->pTable);
+
+  for (size_t i = 0; i < pTable->capacity; ++i) {
+    SCHashEntry *pEntry = &pTable->entries[i];
+
+    uint32_t version = 0;
+    int8_t   state = 0;
+    void *   d = NULL;
+
+    do {
+      version = atomic_load_32(&pEntry->version);
+      state = atomic_load_8(&pEntry->state);
+      d = atomic_load_ptr(&pEntry->data);
+    } while ((version & 1) != 0 || version != atomic_load_32(&pEntry->version));
+
+    if (state == CHASH_ENTRY_USED) {
+      (*fp)(param, d);
+    }
+  }
+
+  taosCHashLeaveRead(pReaders);
+}
+
+void taosCHashCleanup(SCHashObj *pHashObj) {
+  if (pHashObj == NULL) {
+    return;
+  }
+
+  for (int32_t i = 0; i < CHASH_NUM_OF_STRIPES; ++i) {
+    pthread_mutex_destroy(&pHashObj->lock[i]);
+  }
+
+  free(pHashObj->pTable);
+  free(pHashObj);
+}
@@ -18,6 +18,14 @@
 #include "taoserror.h"
 #include "tqueue.h"
 
+/*
+ * Each queue is an intrusive multi-producer single-consumer list: the node header is allocated together with the item
+ * by taosAllocateQitem, so writing an item allocates nothing, and producers only exchange the tail pointer without
+ * taking any lock. The consumer side is serialized by the queue mutex, or by the qset mutex if the queue is in a qset.
+ *
+ * The readers of a qset sleep on the semaphore only after they registered themselves in numOfWaiters and found all
+ * queues empty once more, so producers post the semaphore only when someone may be sleeping, instead of once per item.
+ */
 typedef struct STaosQnode {
   int                 type;
   struct STaosQnode  *next;
@@ -27,8 +35,9 @@ typedef struct STaosQnode {
 typedef struct STaosQueue {
   int32_t             itemSize;
   int32_t             numOfItems;
-  struct STaosQnode  *head;
-  struct STaosQnode  *tail;
+  struct STaosQnode  *head;    // owned by the consumer
+  struct STaosQnode  *tail;    // exchanged by the producers
+  struct STaosQnode  *stub;
   struct STaosQueue  *next;    // for queue set
   struct STaosQset   *qset;    // for queue set
   void               *ahandle; // for queue set
@@ -40,7 +49,8 @@ typedef struct STaosQset {
   STaosQueue        *current;
   pthread_mutex_t    mutex;
   int32_t            numOfQueues;
-  int32_t            numOfItems;
+  int32_t            numOfWaiters;
+  int32_t            numOfResumes;
   tsem_t             sem;
 } STaosQset;
 
@@ -50,6 +60,67 @@ typedef struct STaosQall {
   int32_t       itemSize;
   int32_t       numOfItems;
 } STaosQall; 
+
+static void taosPushQnode(STaosQueue *queue, STaosQnode *pNode) {
+  atomic_store_ptr(&pNode->next, NULL);
+  STaosQnode *prev = atomic_exchange_ptr(&queue->tail, pNode);
+  atomic_store_ptr(&prev->next, pNode);
+}
+
+// only called by the consumer, NULL is also returned if a producer has not linked its node yet
+static STaosQnode *taosPopQnode(STaosQueue *queue) {
+  STaosQnode *pNode = queue->head;
+  STaosQnode *pNext = atomic_load_ptr(&pNode->next);
+
+  if (pNode == queue->stub) {
+    if (pNext == NULL) return NULL;
+    queue->head = pNext;
+    pNode = pNext;
+    pNext = atomic_load_ptr(&pNode->next);
+  }
+
+  if (pNext == NULL) {
+    if (pNode != atomic_load_ptr(&queue->tail)) return NULL;
+
+    // the last node can only be taken out after the stub is put behind it
+    taosPushQnode(queue, queue->stub);
+    pNext = atomic_load_ptr(&pNode->next);
+    if (pNext == NULL) return NULL;
+  }
+
+  queue->head = pNext;
+  return pNode;
+}
+
+// move the items of the queue into qall, the nodes are chained by their next pointers. Items written meanwhile are
+// left for the next call, so the consumer is not kept in the loop by busy producers
+static int taosPopAllQnodes(STaosQueue *queue, STaosQall *qall) {
+  STaosQnode *pNode = NULL;
+  STaosQnode *pLast = NULL;
+  int         num = 0;
+  int         max = atomic_load_32(&queue->numOfItems);
+
+  while (num < max && (pNode = taosPopQnode(queue)) != NULL) {
+    if (pLast) {
+      pLast->next = pNode;
+    } else {
+      qall->start = pNode;
+    }
+
+    pLast = pNode;
+    num++;
+  }
+
+  if (num == 0) return 0;
+
+  pLast->next = NULL;
+  qall->current = qall->start;
+  qall->numOfItems = num;
+  qall->itemSize = queue->itemSize;
+  atomic_sub_fetch_32(&queue->numOfItems, num);
+
+  return num;
+}
   
 taos_queue taosOpenQueue() {
   
@@ -59,6 +130,15 @@ taos_queue taosOpenQueue() {
     return NULL;
   }
 
+  queue->stub = (STaosQnode *) calloc(sizeof(STaosQnode), 1);
+  if (queue->stub == NULL) {
+    free(queue);
+    terrno = TSDB_CODE_COM_OUT_OF_MEMORY;
+    return NULL;
+  }
+
+  queue->head = queue->stub;
+  queue->tail = queue->stub;
   pthread_mutex_init(&queue->mutex, NULL);
 
   return queue;
@@ -67,22 +147,19 @@ taos_queue taosOpenQueue() {
 void taosCloseQueue(taos_queue param) {
   if (param == NULL) return;
   STaosQueue *queue = (STaosQueue *)param;
-  STaosQnode *pTemp;
-  STaosQnode *pNode = queue->head;  
-  queue->head = NULL;
+  STaosQnode *pNode;
 
   if (queue->qset) taosRemoveFromQset(queue->qset, queue); 
 
   pthread_mutex_lock(&queue->mutex);
 
-  while (pNode) {
-    pTemp = pNode;
-    pNode = pNode->next;
-    free (pTemp);
+  while ((pNode = taosPopQnode(queue)) != NULL) {
+    free(pNode);
   }
 
   pthread_mutex_unlock(&queue->mutex);
   pthread_mutex_destroy(&queue->mutex);
+  free(queue->stub);
   free(queue);
 }
 
@@ -105,25 +182,15 @@ int taosWriteQitem(taos_queue param, int type, void *item) {
   STaosQueue *queue = (STaosQueue *)param;
   STaosQnode *pNode = (STaosQnode *)(((char *)item) - sizeof(STaosQnode));
   pNode->type = type;
-  pNode->next = NULL;
-
-  pthread_mutex_lock(&queue->mutex);
-
-  if (queue->tail) {
-    queue->tail->next = pNode;
-    queue->tail = pNode;
-  } else {
-    queue->head = pNode;
-    queue->tail = pNode; 
-  }
 
-  queue->numOfItems++;
-  if (queue->qset) atomic_add_fetch_32(&queue->qset->numOfItems, 1);
-  uTrace("item:%p is put into queue:%p, type:%d items:%d", item, queue, type, queue->numOfItems);
+  taosPushQnode(queue, pNode);
+  int32_t num = atomic_add_fetch_32(&queue->numOfItems, 1);
+  uTrace("item:%p is put into queue:%p, type:%d items:%d", item, queue, type, num);
 
-  pthread_mutex_unlock(&queue->mutex);
-
-  if (queue->qset) tsem_post(&queue->qset->sem);
+  // the counter is increased before the waiters are checked, and a reader registers itself before it checks the
+  // counters, so at least one side sees the other one
+  STaosQset *qset = atomic_load_ptr(&queue->qset);
+  if (qset && atomic_load_32(&qset->numOfWaiters) > 0) tsem_post(&qset->sem);
 
   return 0;
 }
@@ -135,17 +202,13 @@ int taosReadQitem(taos_queue param, int *type, void **pitem) {
 
   pthread_mutex_lock(&queue->mutex);
 
-  if (queue->head) {
-      pNode = queue->head;
+  pNode = taosPopQnode(queue);
+  if (pNode) {
       *pitem = pNode->item;
       *type = pNode->type;
-      queue->head = pNode->next;
-      if (queue->head == NULL) 
-        queue->tail = NULL;
-      queue->numOfItems--;
-      if (queue->qset) atomic_sub_fetch_32(&queue->qset->numOfItems, 1);
+      int32_t num = atomic_sub_fetch_32(&queue->numOfItems, 1);
       code = 1;
-      uTrace("item:%p is read out from queue:%p, type:%d items:%d", *pitem, queue, *type, queue->numOfItems);
+      uTrace("item:%p is read out from queue:%p, type:%d items:%d", *pitem, queue, *type, num);
   } 
 
   pthread_mutex_unlock(&queue->mutex);
@@ -168,21 +231,7 @@ int taosReadAllQitems(taos_queue param, taos_qall p2) {
   int         code = 0;
 
   pthread_mutex_lock(&queue->mutex);
-
-  if (queue->head) {
-    memset(qall, 0, sizeof(STaosQall));
-    qall->current = queue->head;
-    qall->start = queue->head;
-    qall->numOfItems = queue->numOfItems;
-    qall->itemSize = queue->itemSize;
-    code = qall->numOfItems;
-
-    queue->head = NULL;
-    queue->tail = NULL;
-    queue->numOfItems = 0;
-    if (queue->qset) atomic_sub_fetch_32(&queue->qset->numOfItems, qall->numOfItems);
-  } 
-
+  code = taosPopAllQnodes(queue, qall);
   pthread_mutex_unlock(&queue->mutex);
   
   return code; 
@@ -234,11 +283,11 @@ void taosCloseQset(taos_qset param) {
   free(qset);
 }
 
-// tsem_post 'qset->sem', so that reader threads waiting for it
-// resumes execution and return, should only be used to signal the
-// thread to exit.
+// a reader thread waiting on the qset resumes execution and returns
+// without any item, should only be used to signal the thread to exit.
 void taosQsetThreadResume(taos_qset param) {
   STaosQset *qset = (STaosQset *)param;
+  atomic_add_fetch_32(&qset->numOfResumes, 1);
   tsem_post(&qset->sem);
 }
 
@@ -254,14 +303,13 @@ int taosAddIntoQset(taos_qset p1, taos_queue p2, void *ahandle) {
   queue->ahandle = ahandle;
   qset->head = queue;
   qset->numOfQueues++;
-
-  pthread_mutex_lock(&queue->mutex);
-  atomic_add_fetch_32(&qset->numOfItems, queue->numOfItems);
-  queue->qset = qset;
-  pthread_mutex_unlock(&queue->mutex);
+  atomic_store_ptr(&queue->qset, qset);
 
   pthread_mutex_unlock(&qset->mutex);
 
+  // items written before the queue is added did not wake up any reader
+  if (atomic_load_32(&queue->numOfItems) > 0) tsem_post(&qset->sem);
+
   return 0;
 }
 
@@ -294,11 +342,7 @@ void taosRemoveFromQset(taos_qset p1, taos_queue p2) {
     if (tqueue) {
       if (qset->current == queue) qset->current = tqueue->next;
       qset->numOfQueues--;
-
-      pthread_mutex_lock(&queue->mutex);
-      atomic_sub_fetch_32(&qset->numOfItems, queue->numOfItems);
-      queue->qset = NULL;
-      pthread_mutex_unlock(&queue->mutex);
+      atomic_store_ptr(&queue->qset, NULL);
     }
   } 
   
@@ -309,88 +353,104 @@ int taosGetQueueNumber(taos_qset param) {
   return ((STaosQset *)param)->numOfQueues;
 }
 
-int taosReadQitemFromQset(taos_qset param, int *type, void **pitem, void **phandle) {
-  STaosQset  *qset = (STaosQset *)param;
-  STaosQnode *pNode = NULL;
-  int         code = 0;
-   
-  tsem_wait(&qset->sem);
-
-  pthread_mutex_lock(&qset->mutex);
-
+// pick the next non-empty queue in a round robin way, must be called with the qset mutex held
+static STaosQueue *taosNextQueueInQset(STaosQset *qset) {
   for(int i=0; i<qset->numOfQueues; ++i) {
     if (qset->current == NULL) 
       qset->current = qset->head;   
     STaosQueue *queue = qset->current;
     if (queue) qset->current = queue->next;
     if (queue == NULL) break;
-    if (queue->head == NULL) continue;
+    if (atomic_load_32(&queue->numOfItems) > 0) return queue;
+  }
+
+  return NULL;
+}
+
+/*
+ * called after nothing was read out from the qset. Return true if the caller shall return without any item since it
+ * is resumed, otherwise return after a wait when the qset may be not empty any more.
+ */
+static bool taosWaitQset(STaosQset *qset) {
+  int32_t numOfResumes = atomic_load_32(&qset->numOfResumes);
+  while (numOfResumes > 0) {
+    int32_t old = atomic_val_compare_exchange_32(&qset->numOfResumes, numOfResumes, numOfResumes - 1);
+    if (old == numOfResumes) return true;
+    numOfResumes = old;
+  }
+
+  atomic_add_fetch_32(&qset->numOfWaiters, 1);
+
+  bool empty = (atomic_load_32(&qset->numOfResumes) == 0);
+  if (empty) {
+    pthread_mutex_lock(&qset->mutex);
+    for (STaosQueue *queue = qset->head; queue; queue = queue->next) {
+      if (atomic_load_32(&queue->numOfItems) > 0) {
+        empty = false;
+        break;
+      }
+    }
+    pthread_mutex_unlock(&qset->mutex);
+  }
+
+  if (empty) {
+    tsem_wait(&qset->sem);
+  } else {
+    // an item may be still in linking by the producer
+    sched_yield();
+  }
+
+  atomic_sub_fetch_32(&qset->numOfWaiters, 1);
+  return false;
+}
 
-    pthread_mutex_lock(&queue->mutex);
+int taosReadQitemFromQset(taos_qset param, int *type, void **pitem, void **phandle) {
+  STaosQset  *qset = (STaosQset *)param;
+  STaosQnode *pNode = NULL;
+  int         code = 0;
+   
+  while (1) {
+    pthread_mutex_lock(&qset->mutex);
+
+    STaosQueue *queue = taosNextQueueInQset(qset);
+    if (queue) pNode = taosPopQnode(queue);
 
-    if (queue->head) {
-        pNode = queue->head;
+    if (pNode) {
         *pitem = pNode->item;
         *type = pNode->type;
         *phandle = queue->ahandle;
-        queue->head = pNode->next;
-        if (queue->head == NULL) 
-          queue->tail = NULL;
-        queue->numOfItems--;
-        atomic_sub_fetch_32(&qset->numOfItems, 1);
+        int32_t num = atomic_sub_fetch_32(&queue->numOfItems, 1);
         code = 1;
-        uTrace("item:%p is read out from queue:%p, type:%d items:%d", *pitem, queue, *type, queue->numOfItems);
+        uTrace("item:%p is read out from queue:%p, type:%d items:%d", *pitem, queue, *type, num);
     } 
 
-    pthread_mutex_unlock(&queue->mutex);
-    if (pNode) break;
-  }
+    pthread_mutex_unlock(&qset->mutex);
 
-  pthread_mutex_unlock(&qset->mutex);
+    if (pNode || taosWaitQset(qset)) break;
+  }
 
   return code; 
 }
 
 int taosReadAllQitemsFromQset(taos_qset param, taos_qall p2, void **phandle) {
   STaosQset  *qset = (STaosQset *)param;
-  STaosQueue *queue;
   STaosQall  *qall = (STaosQall *)p2;
   int         code = 0;
 
-  tsem_wait(&qset->sem);
-  pthread_mutex_lock(&qset->mutex);
+  while (1) {
+    pthread_mutex_lock(&qset->mutex);
 
-  for(int i=0; i<qset->numOfQueues; ++i) {
-    if (qset->current == NULL) 
-      qset->current = qset->head;   
-    queue = qset->current;
-    if (queue) qset->current = queue->next;
-    if (queue == NULL) break;
-    if (queue->head == NULL) continue;
-
-    pthread_mutex_lock(&queue->mutex);
-
-    if (queue->head) {
-      qall->current = queue->head;
-      qall->start = queue->head;
-      qall->numOfItems = queue->numOfItems;
-      qall->itemSize = queue->itemSize;
-      code = qall->numOfItems;
-      *phandle = queue->ahandle;
-          
-      queue->head = NULL;
-      queue->tail = NULL;
-      queue->numOfItems = 0;
-      atomic_sub_fetch_32(&qset->numOfItems, qall->numOfItems);
-      for (int j=1; j<qall->numOfItems; ++j) tsem_wait(&qset->sem);
-    } 
+    STaosQueue *queue = taosNextQueueInQset(qset);
+    if (queue) {
+      code = taosPopAllQnodes(queue, qall);
+      if (code > 0) *phandle = queue->ahandle;
+    }
 
-    pthread_mutex_unlock(&queue->mutex);
+    pthread_mutex_unlock(&qset->mutex);
 
-    if (code != 0) break;  
+    if (code > 0 || taosWaitQset(qset)) break;
   }
 
-  pthread_mutex_unlock(&qset->mutex);
   return code;
 }
 
@@ -401,5 +461,13 @@ int taosGetQueueItemsNumber(taos_queue param) {
 
 int taosGetQsetItemsNumber(taos_qset param) {
   STaosQset *qset = (STaosQset *)param;
-  return qset->numOfItems;
+  int        num = 0;
+
+  pthread_mutex_lock(&qset->mutex);
+  for (STaosQueue *queue = qset->head; queue; queue = queue->next) {
+    num += atomic_load_32(&queue->numOfItems);
+  }
+  pthread_mutex_unlock(&qset->mutex);
+
+  return num;
 }
@@ -132,4 +132,177 @@ TEST(testCase, cache_resize_test) {
   printf("retrieve %d object cost:%" PRIu64 " us,avg:%f\n", num, endTime - startTime, (endTime - startTime)/(double)num);
 
   taosCacheCleanup(pCache);
-}
\ No newline at end of file
+}
+TEST(testCase, cache_shard_test) {
+  auto* pCache = taosCacheInit(1);
+
+  char    key[256] = {0};
+  int32_t num = 1000;
+
+  for (int32_t i = 0; i < num; ++i) {
+    sprintf(key, "shard_%d", i);
+    void* p = taosCachePut(pCache, key, &i, sizeof(int32_t), (i % 2 == 0) ? 1 : 3600);
+    taosCacheRelease(pCache, &p, false);
+  }
+
+  ASSERT_EQ(taosCacheGetSize(pCache), num);
+
+  // all elements are visited exactly once across shards
+  int64_t     sum = 0;
+  int32_t     count = 0;
+  SCacheIter* pIter = taosCacheCreateIter(pCache);
+  while (taosCacheIterNext(pIter)) {
+    sum += *(int32_t*)taosCacheIterGetData(pIter);
+    count++;
+  }
+  taosCacheDestroyIter(pIter);
+
+  ASSERT_EQ(count, num);
+  ASSERT_EQ(sum, (int64_t)num * (num - 1) / 2);
+
+  // the referenced element survives the expiration, and the others with short life are removed
+  int32_t* pd = (int32_t*)taosCacheAcquireByName(pCache, "shard_0");
+  ASSERT_TRUE(pd != NULL);
+
+  sleep(3);
+  ASSERT_EQ(taosCacheGetSize(pCache), num / 2 + 1);
+  ASSERT_EQ(*pd, 0);
+
+  taosCacheRelease(pCache, (void**)&pd, true);
+  ASSERT_TRUE(taosCacheAcquireByName(pCache, "shard_0") == NULL);
+  ASSERT_TRUE(taosCacheAcquireByName(pCache, "shard_2") == NULL);
+
+  int32_t* p1 = (int32_t*)taosCacheAcquireByName(pCache, "shard_1");
+  ASSERT_TRUE(p1 != NULL && *p1 == 1);
+  taosCacheRelease(pCache, (void**)&p1, false);
+
+  SCacheStatis statis = {0};
+  taosCacheGetStatis(pCache, &statis);
+  ASSERT_EQ(statis.hitCount, 2);
+  ASSERT_EQ(statis.totalAccess, 4);
+
+  taosCacheCleanup(pCache);
+}
+
+TEST(testCase, cache_expire_test) {
+  auto* pCache = taosCacheInit(1);
+
+  int32_t v = 1;
+  void*   p = taosCachePut(pCache, "expire_0", &v, sizeof(int32_t), 1);
+
+  // the expired element is kept while referenced, and checked again in the next interval after released
+  sleep(2);
+  ASSERT_EQ(taosCacheGetSize(pCache), 1);
+
+  taosCacheRelease(pCache, &p, false);
+  sleep(2);
+  ASSERT_EQ(taosCacheGetSize(pCache), 0);
+
+  taosCacheCleanup(pCache);
+}
+
+TEST(testCase, cache_evict_test) {
+  auto* pCache = taosCacheInit(10);
+  taosCacheSetMaxSize(pCache, 64 * 1024);
+
+  char    key[32] = {0};
+  char    data[256] = {0};
+  int32_t num = 10000;
+
+  // the referenced element and the frequently accessed one are never evicted
+  void* pKept = taosCachePut(pCache, "kept", data, sizeof(data), 3600);
+
+  for (int32_t i = 0; i < num; ++i) {
+    sprintf(key, "evict_%d", i);
+    void* p = taosCachePut(pCache, key, data, sizeof(data), 3600);
+    ASSERT_TRUE(p != NULL);
+    taosCacheRelease(pCache, &p, false);
+
+    void* pHot = taosCacheAcquireByName(pCache, "evict_0");
+    ASSERT_TRUE(pHot != NULL);
+    taosCacheRelease(pCache, &pHot, false);
+  }
+
+  SCacheStatis statis = {0};
+  taosCacheGetStatis(pCache, &statis);
+  ASSERT_EQ(taosCacheGetSize(pCache) + statis.evictCount, num + 1);
+  ASSERT_LE(taosCacheGetSize(pCache), 64 * 1024 / sizeof(data));
+
+  ASSERT_TRUE(taosCacheAcquireByName(pCache, "evict_1") == NULL);
+
+  void* pHot = taosCacheAcquireByName(pCache, "evict_0");
+  ASSERT_TRUE(pHot != NULL);
+  taosCacheRelease(pCache, &pHot, false);
+
+  taosCacheRelease(pCache, &pKept, false);
+  pKept = taosCacheAcquireByName(pCache, "kept");
+  ASSERT_TRUE(pKept != NULL);
+  taosCacheRelease(pCache, &pKept, false);
+
+  taosCacheCleanup(pCache);
+}
+
+namespace {
+typedef struct SCacheThreadParam {
+  SCacheObj* pCache;
+  int32_t    numOfKeys;
+  int32_t    loops;
+  int64_t    numOfHits;
+} SCacheThreadParam;
+
+void* cacheAccessThread(void* param) {
+  SCacheThreadParam* pParam = (SCacheThreadParam*)param;
+  char               key[32] = {0};
+
+  for (int32_t i = 0; i < pParam->loops; ++i) {
+    sprintf(key, "perf_%d", (int32_t)((i * 7919LL) % pParam->numOfKeys));
+    void* p = taosCacheAcquireByName(pParam->pCache, key);
+    if (p != NULL) {
+      pParam->numOfHits++;
+      taosCacheRelease(pParam->pCache, &p, false);
+    }
+  }
+
+  return NULL;
+}
+}  // namespace
+
+/*
+ * acquire and release the cached elements from several threads concurrently, which is the usage of the table meta
+ * cache in client and the connection cache in mnode.
+ */
+TEST(testCase, cache_concurrent_perf_test) {
+  const int32_t numOfKeys = 10000;
+  const int32_t loops = 1000000;
+
+  auto* pCache = taosCacheInit(10);
+
+  char key[32] = {0};
+  for (int32_t i = 0; i < numOfKeys; ++i) {
+    sprintf(key, "perf_%d", i);
+    void* p = taosCachePut(pCache, key, &i, sizeof(int32_t), 3600);
+    taosCacheRelease(pCache, &p, false);
+  }
+
+  for (int32_t numOfThreads = 1; numOfThreads <= 16; numOfThreads *= 2) {
+    pthread_t         threads[16];
+    SCacheThreadParam params[16];
+
+    uint64_t st = taosGetTimestampUs();
+    for (int32_t i = 0; i < numOfThreads; ++i) {
+      params[i] = {pCache, numOfKeys, loops, 0};
+      pthread_create(&threads[i], NULL, cacheAccessThread, &params[i]);
+    }
+
+    for (int32_t i = 0; i < numOfThreads; ++i) {
+      pthread_join(threads[i], NULL);
+      ASSERT_EQ(params[i].numOfHits, loops);
+    }
+
+    uint64_t el = taosGetTimestampUs() - st;
+    printf("%d threads, %d acquire/release each, elapsed time:%" PRIu64 " us, %.2f Mops/sec\n", numOfThreads, loops, el,
+           (double)numOfThreads * loops / el);
+  }
+
+  taosCacheCleanup(pCache);
+}
@@ -4,6 +4,7 @@
 #include <iostream>
 
 #include "hash.h"
+#include "tchash.h"
 #include "taos.h"
 #include "ttime.h"
 
@@ -132,8 +133,236 @@ void noLockPerformanceTest() {
   taosHashCleanup(hashTable);
 }
 
+void concurrentHashSimpleTest() {
+  SCHashObj* hashTable = taosCHashInit(16);
+  ASSERT_EQ(taosCHashGetSize(hashTable), 0);
+
+  // grow the table several times
+  for (uint64_t i = 1; i <= 10000; ++i) {
+    ASSERT_EQ(taosCHashPut(hashTable, i, (void*)(i * 2)), 0);
+  }
+
+  ASSERT_EQ(taosCHashGetSize(hashTable), 10000);
+  ASSERT_TRUE(taosCHashGet(hashTable, 0) == nullptr);
+  ASSERT_TRUE(taosCHashPut(hashTable, 0, nullptr) < 0);
+
+  for (uint64_t i = 1; i <= 10000; ++i) {
+    ASSERT_EQ((uint64_t)taosCHashGet(hashTable, i), i * 2);
+  }
+
+  // update the existing elements
+  for (uint64_t i = 1; i <= 100; ++i) {
+    ASSERT_EQ(taosCHashPut(hashTable, i, (void*)(i * 3)), 0);
+    ASSERT_EQ((uint64_t)taosCHashGet(hashTable, i), i * 3);
+  }
+
+  ASSERT_EQ(taosCHashGetSize(hashTable), 10000);
+
+  for (uint64_t i = 1; i <= 5000; ++i) {
+    taosCHashRemove(hashTable, i);
+  }
+
+  taosCHashRemove(hashTable, 20000);
+  ASSERT_EQ(taosCHashGetSize(hashTable), 5000);
+
+  for (uint64_t i = 1; i <= 10000; ++i) {
+    void* p = taosCHashGet(hashTable, i);
+    if (i <= 5000) {
+      ASSERT_TRUE(p == nullptr);
+    } else {
+      ASSERT_EQ((uint64_t)p, i * 2);
+    }
+  }
+
+  // the removed entries are reused, and dropped when the table is rebuilt
+  for (int32_t k = 0; k < 100; ++k) {
+    for (uint64_t i = 1; i <= 5000; ++i) {
+      taosCHashPut(hashTable, i + 100000 * (k + 1), (void*)i);
+    }
+
+    for (uint64_t i = 1; i <= 5000; ++i) {
+      taosCHashRemove(hashTable, i + 100000 * (k + 1));
+    }
+  }
+
+  ASSERT_EQ(taosCHashGetSize(hashTable), 5000);
+  ASSERT_LE(hashTable->pTable->capacity, 65536);
+
+  // each remaining element is visited once
+  uint64_t sum = 0;
+  taosCHashTraverse(hashTable, [](void* param, void* data) { *(uint64_t*)param += (uint64_t)data; }, &sum);
+  ASSERT_EQ(sum, (uint64_t)(5001 + 10000) * 5000);
+
+  taosCHashCleanup(hashTable);
+}
+
+typedef struct SHashThreadParam {
+  void*    pHashObj;
+  bool     concurrent;
+  int32_t  numOfKeys;
+  int32_t  loops;
+  int32_t  numOfErrors;
+} SHashThreadParam;
+
+void* hashReadThread(void* param) {
+  SHashThreadParam* pParam = (SHashThreadParam*)param;
+
+  for (int32_t i = 0; i < pParam->loops; ++i) {
+    uint64_t key = (uint64_t)((i * 7919LL) % pParam->numOfKeys) + 1;
+    void*    p = NULL;
+
+    if (pParam->concurrent) {
+      p = taosCHashGet((SCHashObj*)pParam->pHashObj, key);
+    } else {
+      p = taosHashGet((SHashObj*)pParam->pHashObj, (const char*)&key, sizeof(key));
+      p = (p == NULL) ? NULL : *(void**)p;
+    }
+
+    if ((uint64_t)p != key * 2) {
+      pParam->numOfErrors++;
+    }
+  }
+
+  return NULL;
+}
+
+// insert and remove the transient keys, which triggers the rebuilding of the table while the readers are running
+void* hashWriteThread(void* param) {
+  SHashThreadParam* pParam = (SHashThreadParam*)param;
+
+  for (int32_t k = 0; k < pParam->loops; ++k) {
+    for (uint64_t i = 1; i <= 1000; ++i) {
+      uint64_t key = (uint64_t)pParam->numOfKeys * (k + 2) + i;
+      if (pParam->concurrent) {
+        taosCHashPut((SCHashObj*)pParam->pHashObj, key, (void*)key);
+      } else {
+        taosHashPut((SHashObj*)pParam->pHashObj, (const char*)&key, sizeof(key), &key, POINTER_BYTES);
+      }
+    }
+
+    for (uint64_t i = 1; i <= 1000; ++i) {
+      uint64_t key = (uint64_t)pParam->numOfKeys * (k + 2) + i;
+      if (pParam->concurrent) {
+        taosCHashRemove((SCHashObj*)pParam->pHashObj, key);
+      } else {
+        taosHashRemove((SHashObj*)pParam->pHashObj, (const char*)&key, sizeof(key));
+      }
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * look up the keys from several threads while one thread keeps on inserting and removing other keys, which rebuilds
+ * the table under the readers. The lock-free readers are compared with the thread-safe SHashObj.
+ */
 void multithreadsTest() {
-  //todo
+  const int32_t numOfKeys = 100000;
+  const int32_t loops = 1000000;
+
+  for (int32_t c = 0; c < 2; ++c) {
+    bool  concurrent = (c == 1);
+    void* pHashObj = NULL;
+
+    if (concurrent) {
+      pHashObj = taosCHashInit(numOfKeys);
+    } else {
+      pHashObj = taosHashInit(numOfKeys, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), true);
+    }
+
+    for (uint64_t i = 1; i <= numOfKeys; ++i) {
+      void* p = (void*)(i * 2);
+      if (concurrent) {
+        taosCHashPut((SCHashObj*)pHashObj, i, p);
+      } else {
+        taosHashPut((SHashObj*)pHashObj, (const char*)&i, sizeof(i), &p, POINTER_BYTES);
+      }
+    }
+
+    for (int32_t numOfThreads = 1; numOfThreads <= 8; numOfThreads *= 2) {
+      pthread_t        threads[9];
+      SHashThreadParam params[9];
+
+      int64_t st = taosGetTimestampUs();
+      for (int32_t i = 0; i <= numOfThreads; ++i) {
+        params[i] = {pHashObj, concurrent, numOfKeys, (i == 0) ? 50 : loops, 0};
+        pthread_create(&threads[i], NULL, (i == 0) ? hashWriteThread : hashReadThread, &params[i]);
+      }
+
+      for (int32_t i = 0; i <= numOfThreads; ++i) {
+        pthread_join(threads[i], NULL);
+        ASSERT_EQ(params[i].numOfErrors, 0);
+      }
+
+      int64_t el = taosGetTimestampUs() - st;
+      printf("%s hash, %d readers with 1 writer, %d gets each, elapsed time:%" PRId64 " us, %.2f Mops/sec\n",
+             concurrent ? "concurrent" : "rwlock", numOfThreads, loops, el, (double)numOfThreads * loops / el);
+    }
+
+    if (concurrent) {
+      ASSERT_EQ(taosCHashGetSize((SCHashObj*)pHashObj), numOfKeys);
+      taosCHashCleanup((SCHashObj*)pHashObj);
+    } else {
+      ASSERT_EQ(taosHashGetSize((SHashObj*)pHashObj), numOfKeys);
+      taosHashCleanup((SHashObj*)pHashObj);
+    }
+  }
+}
+
+/*
+ * look up a few vgroup ids from several threads, which is the usage of the vnode map of dnode: every message received
+ * by the vnode read and write workers looks up its vnode, while vnodes are rarely created or dropped.
+ */
+void vnodeLookupTest() {
+  const int32_t numOfKeys = 16;
+  const int32_t loops = 2000000;
+
+  for (int32_t c = 0; c < 2; ++c) {
+    bool  concurrent = (c == 1);
+    void* pHashObj = NULL;
+
+    if (concurrent) {
+      pHashObj = taosCHashInit(numOfKeys);
+    } else {
+      pHashObj = taosHashInit(numOfKeys, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BIGINT), true);
+    }
+
+    for (uint64_t i = 1; i <= numOfKeys; ++i) {
+      void* p = (void*)(i * 2);
+      if (concurrent) {
+        taosCHashPut((SCHashObj*)pHashObj, i, p);
+      } else {
+        taosHashPut((SHashObj*)pHashObj, (const char*)&i, sizeof(i), &p, POINTER_BYTES);
+      }
+    }
+
+    for (int32_t numOfThreads = 1; numOfThreads <= 8; numOfThreads *= 2) {
+      pthread_t        threads[8];
+      SHashThreadParam params[8];
+
+      int64_t st = taosGetTimestampUs();
+      for (int32_t i = 0; i < numOfThreads; ++i) {
+        params[i] = {pHashObj, concurrent, numOfKeys, loops, 0};
+        pthread_create(&threads[i], NULL, hashReadThread, &params[i]);
+      }
+
+      for (int32_t i = 0; i < numOfThreads; ++i) {
+        pthread_join(threads[i], NULL);
+        ASSERT_EQ(params[i].numOfErrors, 0);
+      }
+
+      int64_t el = taosGetTimestampUs() - st;
+      printf("%s hash, %d vnode workers, %d gets each, elapsed time:%" PRId64 " us, %.2f Mops/sec\n",
+             concurrent ? "concurrent" : "rwlock", numOfThreads, loops, el, (double)numOfThreads * loops / el);
+    }
+
+    if (concurrent) {
+      taosCHashCleanup((SCHashObj*)pHashObj);
+    } else {
+      taosHashCleanup((SHashObj*)pHashObj);
+    }
+  }
 }
 
 // check the function robustness
@@ -152,5 +381,7 @@ TEST(testCase, hashTest) {
   simpleTest();
   stringKeyTest();
   noLockPerformanceTest();
+  concurrentHashSimpleTest();
   multithreadsTest();
+  vnodeLookupTest();
 }
\ No newline at end of file
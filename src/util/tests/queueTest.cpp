@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "os.h"
+#include "tqueue.h"
+#include "ttime.h"
+#include "tutil.h"
+
+namespace {
+
+typedef struct SQueueTestItem {
+  int32_t producer;
+  int32_t seq;
+  int64_t ts;
+} SQueueTestItem;
+
+typedef struct SProducerParam {
+  taos_queue queue;
+  int32_t    id;
+  int32_t    numOfItems;
+} SProducerParam;
+
+typedef struct SConsumerParam {
+  taos_qset            qset;
+  bool                 readAll;
+  int32_t              numOfProducers;
+  int64_t              numOfItems;
+  int32_t              numOfErrors;
+  std::vector<int64_t> latency;
+} SConsumerParam;
+
+void* produceItems(void* param) {
+  SProducerParam* pParam = (SProducerParam*)param;
+
+  for (int32_t i = 0; i < pParam->numOfItems; ++i) {
+    SQueueTestItem* pItem = (SQueueTestItem*)taosAllocateQitem(sizeof(SQueueTestItem));
+    pItem->producer = pParam->id;
+    pItem->seq = i;
+    pItem->ts = taosGetTimestampUs();
+    taosWriteQitem(pParam->queue, 0, pItem);
+  }
+
+  return NULL;
+}
+
+// each producer writes into one queue only, so the items of a producer must be read out in order
+void consumeItem(SConsumerParam* pParam, std::vector<int32_t>& next, SQueueTestItem* pItem) {
+  if (pItem->seq != next[pItem->producer]) {
+    pParam->numOfErrors++;
+  }
+
+  next[pItem->producer] = pItem->seq + 1;
+  pParam->numOfItems++;
+  if ((pParam->numOfItems & 0x3F) == 0) {
+    pParam->latency.push_back(taosGetTimestampUs() - pItem->ts);
+  }
+
+  taosFreeQitem(pItem);
+}
+
+void* consumeItems(void* param) {
+  SConsumerParam*      pParam = (SConsumerParam*)param;
+  std::vector<int32_t> next(pParam->numOfProducers, 0);
+  taos_qall            qall = taosAllocateQall();
+  int                  type = 0;
+  void*                handle = NULL;
+  SQueueTestItem*      pItem = NULL;
+
+  while (1) {
+    if (pParam->readAll) {
+      int num = taosReadAllQitemsFromQset(pParam->qset, qall, &handle);
+      if (num == 0) break;
+
+      for (int i = 0; i < num; ++i) {
+        taosGetQitem(qall, &type, (void**)&pItem);
+        consumeItem(pParam, next, pItem);
+      }
+    } else {
+      if (taosReadQitemFromQset(pParam->qset, &type, (void**)&pItem, &handle) == 0) break;
+      consumeItem(pParam, next, pItem);
+    }
+  }
+
+  taosFreeQall(qall);
+  return NULL;
+}
+
+/*
+ * several producers write into the queues of one qset, which is read by one worker thread, like the vnode write
+ * queues. The throughput and the latency from writing to reading an item are reported.
+ */
+void queuePerformanceTest(int32_t numOfQueues, int32_t numOfProducers, bool readAll) {
+  const int32_t numOfItems = 200000;
+
+  taos_qset               qset = taosOpenQset();
+  std::vector<taos_queue> queues(numOfQueues);
+  for (int32_t i = 0; i < numOfQueues; ++i) {
+    queues[i] = taosOpenQueue();
+    taosAddIntoQset(qset, queues[i], NULL);
+  }
+
+  SConsumerParam consumer;
+  consumer.qset = qset;
+  consumer.readAll = readAll;
+  consumer.numOfProducers = numOfProducers;
+  consumer.numOfItems = 0;
+  consumer.numOfErrors = 0;
+
+  std::vector<SProducerParam> producers(numOfProducers);
+  std::vector<pthread_t>      threads(numOfProducers);
+
+  int64_t   st = taosGetTimestampUs();
+  pthread_t consumerThread;
+  pthread_create(&consumerThread, NULL, consumeItems, &consumer);
+
+  for (int32_t i = 0; i < numOfProducers; ++i) {
+    producers[i] = {queues[i % numOfQueues], i, numOfItems};
+    pthread_create(&threads[i], NULL, produceItems, &producers[i]);
+  }
+
+  for (int32_t i = 0; i < numOfProducers; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+
+  while (taosGetQsetItemsNumber(qset) > 0) {
+    taosMsleep(1);
+  }
+
+  taosQsetThreadResume(qset);
+  pthread_join(consumerThread, NULL);
+  int64_t el = taosGetTimestampUs() - st;
+
+  ASSERT_EQ(consumer.numOfErrors, 0);
+  ASSERT_EQ(consumer.numOfItems, (int64_t)numOfProducers * numOfItems);
+
+  std::vector<int64_t>& latency = consumer.latency;
+  std::sort(latency.begin(), latency.end());
+  printf("%d producers, %d queues, %s, %" PRId64 " items, elapsed time:%" PRId64
+         " us, %.2f Mitems/sec, latency p50:%" PRId64 " us, p99:%" PRId64 " us\n",
+         numOfProducers, numOfQueues, readAll ? "read all" : "read one", consumer.numOfItems, el,
+         (double)consumer.numOfItems / el, latency[latency.size() / 2], latency[latency.size() * 99 / 100]);
+
+  for (int32_t i = 0; i < numOfQueues; ++i) {
+    taosCloseQueue(queues[i]);
+  }
+
+  taosCloseQset(qset);
+}
+
+void queueSimpleTest() {
+  taos_queue queue = taosOpenQueue();
+  taos_qall  qall = taosAllocateQall();
+  int        type = 0;
+  void*      pItem = NULL;
+
+  ASSERT_EQ(taosReadQitem(queue, &type, &pItem), 0);
+
+  for (int32_t i = 0; i < 10; ++i) {
+    int32_t* p = (int32_t*)taosAllocateQitem(sizeof(int32_t));
+    *p = i;
+    taosWriteQitem(queue, i, p);
+  }
+
+  ASSERT_EQ(taosGetQueueItemsNumber(queue), 10);
+
+  ASSERT_EQ(taosReadQitem(queue, &type, &pItem), 1);
+  ASSERT_EQ(type, 0);
+  ASSERT_EQ(*(int32_t*)pItem, 0);
+  taosFreeQitem(pItem);
+
+  ASSERT_EQ(taosReadAllQitems(queue, qall), 9);
+  ASSERT_EQ(taosGetQueueItemsNumber(queue), 0);
+
+  for (int32_t k = 0; k < 2; ++k) {
+    for (int32_t i = 1; i < 10; ++i) {
+      ASSERT_EQ(taosGetQitem(qall, &type, &pItem), 1);
+      ASSERT_EQ(type, i);
+      ASSERT_EQ(*(int32_t*)pItem, i);
+    }
+
+    ASSERT_EQ(taosGetQitem(qall, &type, &pItem), 0);
+    taosResetQitems(qall);
+  }
+
+  for (int32_t i = 1; i < 10; ++i) {
+    taosGetQitem(qall, &type, &pItem);
+    taosFreeQitem(pItem);
+  }
+
+  ASSERT_EQ(taosReadAllQitems(queue, qall), 0);
+
+  // the items left in the queue are freed when the queue is closed
+  taosWriteQitem(queue, 0, taosAllocateQitem(16));
+  taosFreeQall(qall);
+  taosCloseQueue(queue);
+}
+
+void qsetResumeTest() {
+  taos_qset  qset = taosOpenQset();
+  taos_queue queue = taosOpenQueue();
+  int        type = 0;
+  void*      pItem = NULL;
+  void*      handle = NULL;
+
+  // the item written before the queue is added into qset can be read out
+  taosWriteQitem(queue, 1, taosAllocateQitem(8));
+  taosAddIntoQset(qset, queue, (void*)queue);
+  ASSERT_EQ(taosGetQsetItemsNumber(qset), 1);
+
+  ASSERT_EQ(taosReadQitemFromQset(qset, &type, &pItem, &handle), 1);
+  ASSERT_EQ(type, 1);
+  ASSERT_TRUE(handle == queue);
+  taosFreeQitem(pItem);
+
+  taosQsetThreadResume(qset);
+  ASSERT_EQ(taosReadQitemFromQset(qset, &type, &pItem, &handle), 0);
+
+  taosRemoveFromQset(qset, queue);
+  ASSERT_EQ(taosGetQueueNumber(qset), 0);
+
+  taosCloseQueue(queue);
+  taosCloseQset(qset);
+}
+
+}  // namespace
+
+TEST(testCase, queueTest) {
+  queueSimpleTest();
+  qsetResumeTest();
+
+  queuePerformanceTest(1, 1, false);
+  queuePerformanceTest(1, 4, false);
+  queuePerformanceTest(4, 4, false);
+  queuePerformanceTest(4, 8, true);
+}
@@ -15,7 +15,7 @@
 
 #define _DEFAULT_SOURCE
 #include "os.h"
-#include "hash.h"
+#include "tchash.h"
 #include "taoserror.h"
 #include "taosmsg.h"
 #include "tutil.h"
@@ -32,7 +32,7 @@
 #define TSDB_VNODE_VERSION_CONTENT_LEN 31
 
 static int32_t  tsOpennedVnodes;
-static void    *tsDnodeVnodesHash;
+static SCHashObj *tsDnodeVnodesHash;  // looked up by every message of vnodes, the readers are lock-free
 static void     vnodeCleanUp(SVnodeObj *pVnode);
 static int32_t  vnodeSaveCfg(SMDCreateVnodeMsg *pVnodeCfg);
 static int32_t  vnodeReadCfg(SVnodeObj *pVnode);
@@ -59,7 +59,7 @@ static void vnodeInit() {
   vnodeInitWriteFp();
   vnodeInitReadFp();
 
-  tsDnodeVnodesHash = taosHashInit(TSDB_MAX_VNODES, taosGetDefaultHashFunction(TSDB_DATA_TYPE_INT), true);
+  tsDnodeVnodesHash = taosCHashInit(TSDB_MAX_VNODES);
   if (tsDnodeVnodesHash == NULL) {
     vError("failed to init vnode list");
   }
@@ -69,7 +69,7 @@ int32_t vnodeCreate(SMDCreateVnodeMsg *pVnodeCfg) {
   int32_t code;
   pthread_once(&vnodeModuleInit, vnodeInit);
 
-  SVnodeObj *pTemp = (SVnodeObj *)taosHashGet(tsDnodeVnodesHash, (const char *)&pVnodeCfg->cfg.vgId, sizeof(int32_t));
+  SVnodeObj *pTemp = (SVnodeObj *)taosCHashGet(tsDnodeVnodesHash, (uint32_t)pVnodeCfg->cfg.vgId);
   if (pTemp != NULL) {
     vPrint("vgId:%d, vnode already exist, pVnode:%p", pVnodeCfg->cfg.vgId, pTemp);
     return TSDB_CODE_SUCCESS;
@@ -141,13 +141,12 @@ int32_t vnodeDrop(int32_t vgId) {
     return TSDB_CODE_VND_INVALID_VGROUP_ID;
   }
 
-  SVnodeObj **ppVnode = (SVnodeObj **)taosHashGet(tsDnodeVnodesHash, (const char *)&vgId, sizeof(int32_t));
-  if (ppVnode == NULL || *ppVnode == NULL) {
+  SVnodeObj *pVnode = (SVnodeObj *)taosCHashGet(tsDnodeVnodesHash, (uint32_t)vgId);
+  if (pVnode == NULL) {
     vTrace("vgId:%d, failed to drop, vgId not find", vgId);
     return TSDB_CODE_VND_INVALID_VGROUP_ID;
   }
 
-  SVnodeObj *pVnode = *ppVnode;
   vTrace("vgId:%d, vnode will be dropped", pVnode->vgId);
   pVnode->status = TAOS_VN_STATUS_DELETING;
   vnodeCleanUp(pVnode);
@@ -284,7 +283,7 @@ int32_t vnodeOpen(int32_t vnode, char *rootDir) {
   pVnode->status = TAOS_VN_STATUS_READY;
   vTrace("vgId:%d, vnode is opened in %s, pVnode:%p", pVnode->vgId, rootDir, pVnode);
 
-  taosHashPut(tsDnodeVnodesHash, (const char *)&pVnode->vgId, sizeof(int32_t), (char *)(&pVnode), sizeof(SVnodeObj *));
+  taosCHashPut(tsDnodeVnodesHash, (uint32_t)pVnode->vgId, pVnode);
 
   return TSDB_CODE_SUCCESS;
 }
@@ -299,10 +298,9 @@ int32_t vnodeStartStream(int32_t vnode) {
 }
 
 int32_t vnodeClose(int32_t vgId) {
-  SVnodeObj **ppVnode = (SVnodeObj **)taosHashGet(tsDnodeVnodesHash, (const char *)&vgId, sizeof(int32_t));
-  if (ppVnode == NULL || *ppVnode == NULL) return 0;
+  SVnodeObj *pVnode = (SVnodeObj *)taosCHashGet(tsDnodeVnodesHash, (uint32_t)vgId);
+  if (pVnode == NULL) return 0;
 
-  SVnodeObj *pVnode = *ppVnode;
   vTrace("vgId:%d, vnode will be closed", pVnode->vgId);
   pVnode->status = TAOS_VN_STATUS_CLOSING;
   vnodeCleanUp(pVnode);
@@ -357,7 +355,7 @@ void vnodeRelease(void *pVnodeRaw) {
   vTrace("vgId:%d, vnode is released, vnodes:%d", vgId, count);
 
   if (count <= 0) {
-    taosHashCleanup(tsDnodeVnodesHash);
+    taosCHashCleanup(tsDnodeVnodesHash);
     vnodeModuleInit = PTHREAD_ONCE_INIT;
     tsDnodeVnodesHash = NULL;
   }
@@ -366,14 +364,14 @@ void vnodeRelease(void *pVnodeRaw) {
 void *vnodeGetVnode(int32_t vgId) {
   if (tsDnodeVnodesHash == NULL) return NULL;
 
-  SVnodeObj **ppVnode = (SVnodeObj **)taosHashGet(tsDnodeVnodesHash, (const char *)&vgId, sizeof(int32_t));
-  if (ppVnode == NULL || *ppVnode == NULL) {
+  SVnodeObj *pVnode = (SVnodeObj *)taosCHashGet(tsDnodeVnodesHash, (uint32_t)vgId);
+  if (pVnode == NULL) {
     terrno = TSDB_CODE_VND_INVALID_VGROUP_ID;
     vPrint("vgId:%d, not exist", vgId);
     return NULL;
   }
 
-  return *ppVnode;
+  return pVnode;
 }
 
 void *vnodeAccquireVnode(int32_t vgId) {
@@ -400,7 +398,10 @@ void *vnodeGetWal(void *pVnode) {
   return ((SVnodeObj *)pVnode)->wal;
 }
 
-static void vnodeBuildVloadMsg(SVnodeObj *pVnode, SDMStatusMsg *pStatus) {
+static void vnodeBuildVloadMsg(void *param, void *data) {
+  SDMStatusMsg *pStatus = param;
+  SVnodeObj *   pVnode = data;
+
   if (pVnode->status == TAOS_VN_STATUS_DELETING) return;
   if (pStatus->openVnodes >= TSDB_MAX_VNODES) return;
   int64_t totalStorage, compStorage, pointsWritten = 0;
@@ -418,18 +419,7 @@ static void vnodeBuildVloadMsg(SVnodeObj *pVnode, SDMStatusMsg *pStatus) {
 }
 
 void vnodeBuildStatusMsg(void *param) {
-  SDMStatusMsg *pStatus = param;
-  SHashMutableIterator *pIter = taosHashCreateIter(tsDnodeVnodesHash);
-
-  while (taosHashIterNext(pIter)) {
-    SVnodeObj **pVnode = taosHashIterGet(pIter);
-    if (pVnode == NULL) continue;
-    if (*pVnode == NULL) continue;
-
-    vnodeBuildVloadMsg(*pVnode, pStatus);
-  }
-
-  taosHashDestroyIter(pIter);
+  taosCHashTraverse(tsDnodeVnodesHash, vnodeBuildVloadMsg, param);
 }
 
 void vnodeSetAccess(SDMVgroupAccess *pAccess, int32_t numOfVnodes) {
@@ -448,7 +438,7 @@ void vnodeSetAccess(SDMVgroupAccess *pAccess, int32_t numOfVnodes) {
 
 static void vnodeCleanUp(SVnodeObj *pVnode) {
   // remove from hash, so new messages wont be consumed
-  taosHashRemove(tsDnodeVnodesHash, (const char *)&pVnode->vgId, sizeof(int32_t));
+  taosCHashRemove(tsDnodeVnodesHash, (uint32_t)pVnode->vgId);
 
   // stop replication module
   if (pVnode->sync) {
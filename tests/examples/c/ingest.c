@@ -0,0 +1,140 @@
+// sample code for TDengine pipelined asynchronous insertion API
+// to compile: gcc -o ingest ingest.c -ltaos
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <taos.h>  // include TDengine header file
+
+#define NUM_OF_TABLES 10
+#define ROWS_PER_WRITE 100
+
+static int64_t ackedRows = 0;
+static int     failedBatches = 0;
+
+// called from the client threads once a submit message is acknowledged by the vnode
+void ingest_callback(TAOS_INGEST* ingest, void* param, int code, int affected_rows) {
+  if (code != 0) {
+    __sync_fetch_and_add(&failedBatches, 1);
+  } else {
+    __sync_fetch_and_add(&ackedRows, affected_rows);
+  }
+}
+
+void check_result(TAOS* taos, int64_t expected) {
+  TAOS_RES* res = taos_query(taos, "select count(*) from meters");
+  TAOS_ROW  row = taos_fetch_row(res);
+  int64_t   actual = (row != NULL) ? *(int64_t*)row[0] : 0;
+  printf("%" PRId64 " rows acknowledged, %d batches failed, %" PRId64 " rows expected, %" PRId64 " rows in database\n",
+         ackedRows, failedBatches, expected, actual);
+  taos_free_result(res);
+}
+
+int main(int argc, char* argv[]) {
+  const char* host = "127.0.0.1";
+  const char* user = "root";
+  const char* passwd = "taosdata";
+  int         numOfWrites = 100;
+
+  if (argc > 1) {
+    host = argv[1];
+  }
+
+  if (argc > 2) {
+    numOfWrites = atoi(argv[2]);
+  }
+
+  taos_init();
+
+  TAOS* taos = taos_connect(host, user, passwd, "", 0);
+  if (taos == NULL) {
+    printf("failed to connect to db, reason:%s\n", taos_errstr(taos));
+    exit(1);
+  }
+
+  taos_free_result(taos_query(taos, "drop database if exists test;"));
+  taos_free_result(taos_query(taos, "create database test;"));
+  taos_free_result(taos_query(taos, "use test;"));
+  taos_free_result(taos_query(taos, "create table meters(ts timestamp, current float, voltage int) tags(id int);"));
+
+  char sql[128];
+  char names[NUM_OF_TABLES][16];
+  for (int i = 0; i < NUM_OF_TABLES; i++) {
+    sprintf(names[i], "d%d", i);
+    sprintf(sql, "create table %s using meters tags(%d);", names[i], i);
+    taos_free_result(taos_query(taos, sql));
+  }
+
+  // send a submit message for every 5000 rows of a vgroup, or 100ms after its first row arrives,
+  // and keep at most 4 submit messages without acknowledgement for each vgroup
+  TAOS_INGEST* ingest = taos_ingest_open(taos, 5000, 100, 4, ingest_callback, NULL);
+  if (ingest == NULL) {
+    printf("failed to open ingest object\n");
+    exit(1);
+  }
+
+  int64_t ts[ROWS_PER_WRITE];
+  float   current[ROWS_PER_WRITE];
+  int     voltage[ROWS_PER_WRITE];
+
+  TAOS_COLUMN_BIND columns[3];
+  memset(columns, 0, sizeof(columns));
+  columns[0].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+  columns[0].buffer = ts;
+  columns[0].buffer_length = sizeof(int64_t);
+  columns[1].buffer_type = TSDB_DATA_TYPE_FLOAT;
+  columns[1].buffer = current;
+  columns[1].buffer_length = sizeof(float);
+  columns[2].buffer_type = TSDB_DATA_TYPE_INT;
+  columns[2].buffer = voltage;
+  columns[2].buffer_length = sizeof(int);
+
+  TAOS_TABLE_BIND tables[NUM_OF_TABLES];
+  for (int i = 0; i < NUM_OF_TABLES; i++) {
+    tables[i].table_name = names[i];
+    tables[i].num_of_rows = ROWS_PER_WRITE;
+    tables[i].columns = columns;
+  }
+
+  int64_t start = 1600000000000;
+  for (int i = 0; i < numOfWrites; i++) {
+    for (int j = 0; j < ROWS_PER_WRITE; j++) {
+      ts[j] = start + (int64_t)i * ROWS_PER_WRITE + j;
+      current[j] = 10.0f + j % 10;
+      voltage[j] = 220 + j % 5;
+    }
+
+    // the values are copied before return, so the arrays can be reused at once
+    int code = taos_ingest_write(ingest, tables, NUM_OF_TABLES);
+    if (code != 0) {
+      printf("failed to write rows, code:0x%x\n", code);
+    }
+  }
+
+  int code = taos_ingest_flush(ingest);
+  if (code != 0) {
+    printf("failed to flush rows, code:0x%x\n", code);
+  }
+
+  taos_ingest_close(ingest);
+
+  check_result(taos, (int64_t)numOfWrites * ROWS_PER_WRITE * NUM_OF_TABLES);
+
+  // an ingest object may be closed while its linger timer is firing
+  for (int i = 0; i < 100; i++) {
+    ingest = taos_ingest_open(taos, 5000, 1, 4, NULL, NULL);
+    if (ingest == NULL) {
+      printf("failed to open ingest object\n");
+      exit(1);
+    }
+
+    usleep((i % 10) * 1000);
+    taos_ingest_close(ingest);
+  }
+
+  taos_close(taos);
+  taos_cleanup();
+  return 0;
+}
@@ -199,6 +199,105 @@ int main(int argc, char *argv[])
   taos_free_result(result);
   taos_stmt_close(stmt);
 
+  // insert into several tables created on the fly, the values of each column are bound as an array
+  result = taos_query(taos, "create table st (ts timestamp, v4 int, bin binary(40)) tags (t1 int)");
+  code = taos_errno(result);
+  if (code != 0) {
+    printf("failed to create super table, reason:%s\n", taos_errstr(result));
+    taos_free_result(result);
+    exit(1);
+  }
+  taos_free_result(result);
+
+  const int rowsPerTable = 100;
+  int64_t   tsArr[rowsPerTable];
+  int32_t   v4Arr[rowsPerTable];
+  char      binArr[rowsPerTable][40];
+  char      nullArr[rowsPerTable];
+
+  TAOS_COLUMN_BIND cols[3] = {{0}};
+  cols[0].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+  cols[0].buffer_length = sizeof(int64_t);
+  cols[0].buffer = tsArr;
+  cols[1].buffer_type = TSDB_DATA_TYPE_INT;
+  cols[1].buffer_length = sizeof(int32_t);
+  cols[1].buffer = v4Arr;
+  cols[1].is_null = nullArr;
+  cols[2].buffer_type = TSDB_DATA_TYPE_BINARY;
+  cols[2].buffer_length = sizeof(binArr[0]);
+  cols[2].buffer = binArr;
+
+  int32_t tag = 0;
+  TAOS_BIND tags[1] = {{0}};
+  tags[0].buffer_type = TSDB_DATA_TYPE_INT;
+  tags[0].buffer_length = sizeof(tag);
+  tags[0].buffer = &tag;
+  tags[0].length = &tags[0].buffer_length;
+
+  stmt = taos_stmt_init(taos);
+  code = taos_stmt_prepare(stmt, "insert into d0 using st tags(0) values(?,?,?)", 0);
+  if (code != 0) {
+    printf("failed to execute taos_stmt_prepare. code:0x%x\n", code);
+    exit(1);
+  }
+
+  for (int t = 0; t < 10; ++t) {
+    char name[16];
+    sprintf(name, "d%d", t);
+    tag = t;
+    if ((code = taos_stmt_set_tbname_tags(stmt, name, tags)) != 0) {
+      printf("failed to set table name. code:0x%x\n", code);
+      exit(1);
+    }
+
+    for (int i = 0; i < rowsPerTable; ++i) {
+      tsArr[i] = 1591060628000 + i;
+      v4Arr[i] = t * rowsPerTable + i;
+      nullArr[i] = (i % 10 == 0);
+      sprintf(binArr[i], "%d-%d", t, i);
+    }
+
+    if ((code = taos_stmt_bind_param_batch(stmt, cols, rowsPerTable)) != 0) {
+      printf("failed to bind columns. code:0x%x\n", code);
+      exit(1);
+    }
+  }
+
+  // m1 has other columns, so the table is not switched, and the rows below are still inserted into d9
+  if (taos_stmt_set_tbname(stmt, "m1") == 0 || taos_stmt_set_tbname(stmt, "no_such_table") == 0) {
+    printf("table with other columns or not existing is set.\n");
+    exit(1);
+  }
+
+  for (int i = 0; i < rowsPerTable; ++i) {
+    tsArr[i] = 1591060628000 + rowsPerTable + i;
+  }
+
+  if ((code = taos_stmt_bind_param_batch(stmt, cols, rowsPerTable)) != 0) {
+    printf("failed to bind columns after setting table failed. code:0x%x\n", code);
+    exit(1);
+  }
+
+  if (taos_stmt_execute(stmt) != 0) {
+    printf("failed to execute multi-table insert statement.\n");
+    exit(1);
+  }
+  taos_stmt_close(stmt);
+
+  result = taos_query(taos, "select count(*), count(v4), last(bin) from st");
+  if ((row = taos_fetch_row(result)) != NULL) {
+    taos_print_row(temp, row, taos_fetch_fields(result), taos_num_fields(result));
+    printf("%s\n", temp);
+  }
+  taos_free_result(result);
+
+  result = taos_query(taos, "select count(*) from d9");
+  if ((row = taos_fetch_row(result)) == NULL || *(int64_t *)row[0] != 2 * rowsPerTable) {
+    printf("rows bound after setting table failed are lost.\n");
+    exit(1);
+  }
+  taos_free_result(result);
+
   return getchar();
 }
 
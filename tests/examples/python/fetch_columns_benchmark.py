@@ -0,0 +1,61 @@
+"""
+Compare the throughput of fetching a query result by rows with fetchall, and by columns with fetch_columns, with and
+without numpy.
+
+usage: python3 fetch_columns_benchmark.py [-H host] [-c config] [-n iterations] "select * from db.tb"
+"""
+import argparse
+import time
+import taos
+
+def fetch_rows(cursor):
+    return len(cursor.fetchall())
+
+def fetch_columns_array(cursor):
+    cursor.fetch_columns(use_numpy=False)
+    return cursor.rowcount
+
+def fetch_columns_numpy(cursor):
+    cursor.fetch_columns(use_numpy=True)
+    return cursor.rowcount
+
+def measure(cursor, sql, fetch, iterations):
+    rates = []
+    for i in range(iterations + 1):
+        start = time.time()
+        cursor.execute(sql)
+        rows = fetch(cursor)
+        elapsed = time.time() - start
+
+        # the first iteration warms up the caches of server
+        if i > 0:
+            rates.append(rows / elapsed)
+
+    mean = sum(rates) / len(rates)
+    stddev = (sum([(r - mean) ** 2 for r in rates]) / max(1, len(rates) - 1)) ** 0.5
+    return rows, mean, stddev
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-H', '--host', default='127.0.0.1')
+    parser.add_argument('-c', '--config', default='/etc/taos')
+    parser.add_argument('-n', '--iterations', type=int, default=3)
+    parser.add_argument('sql')
+    args = parser.parse_args()
+
+    conn = taos.connect(host=args.host, user="root", password="taosdata", config=args.config)
+    cursor = conn.cursor()
+
+    methods = [('fetchall', fetch_rows), ('fetch_columns', fetch_columns_array)]
+    try:
+        import numpy
+        methods.append(('fetch_columns numpy', fetch_columns_numpy))
+    except ImportError:
+        print('numpy is not installed, skip fetch_columns with numpy')
+
+    for name, fetch in methods:
+        rows, mean, stddev = measure(cursor, args.sql, fetch, args.iterations)
+        print('%-20s %10d rows %12.0f +- %10.0f rows/s' % (name, rows, mean, stddev))
+
+    cursor.close()
+    conn.close()
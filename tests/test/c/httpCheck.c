@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * check how the http server handles malformed or fragmented requests: each case is sent on a new connection, the
+ * status of the response is compared with the expected one, and a valid request is sent afterwards to make sure the
+ * server is still alive.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "taos.h"
+#include "tulog.h"
+#include "tutil.h"
+#include "tglobal.h"
+
+#define GREEN "\033[1;32m"
+#define RED "\033[1;31m"
+#define NC "\033[0m"
+#define RSP_BUFFER_SIZE 65536
+#define MAX_PARTS 4
+
+typedef struct {
+  char *name;
+  char *parts[MAX_PARTS];  // sent by separate writes with a pause between them
+  int   status;            // expected status of the response
+} SCase;
+
+char serverIp[40] = "127.0.0.1";
+int  port = 6020;
+char auth[128] = "cm9vdDp0YW9zZGF0YQ==";  // root:taosdata
+
+#define CHUNKED_HEAD \
+  "POST /rest/sql HTTP/1.1\r\nHost: localhost\r\nAuthorization: Basic %s\r\nTransfer-Encoding: chunked\r\n\r\n"
+
+static SCase cases[] = {
+    {"valid chunked body", {CHUNKED_HEAD, "16\r\nselect server_status()\r\n0\r\n\r\n"}, 200},
+    {"chunk size wraps around", {CHUNKED_HEAD, "fffffffffffffffe\r\nselect server_status()\r\n0\r\n\r\n"}, 413},
+    {"chunk size overflows", {CHUNKED_HEAD, "1fffffffffffffffff\r\nselect\r\n0\r\n\r\n"}, 409},
+    {"negative chunk size", {CHUNKED_HEAD, "-2\r\nselect server_status()\r\n0\r\n\r\n"}, 409},
+    {"chunk size not hex", {CHUNKED_HEAD, "zz\r\nselect server_status()\r\n0\r\n\r\n"}, 409},
+    {"chunk bigger than buffer", {CHUNKED_HEAD, "100000000\r\nselect server_status()\r\n"}, 413},
+    {"head in two writes",
+     {"POST /rest/sql HTTP/1.1\r\nHost: localhost\r\nAuthorization: Ba",
+      "sic %s\r\nContent-Length: 22\r\n\r\nselect server_status()"},
+     200},
+    {"head in three writes",
+     {"POST /rest/sql HTTP/1.1\r\nHost: loc", "alhost\r\nAuthorization: Basic %s\r\nContent-Length: 22\r\n",
+      "\r\nselect server_status()"},
+     200},
+    {"chunk exceeds buffer left", {CHUNKED_HEAD, "10\r\nselect 123456789\r\nfffff\r\nselect\r\n"}, 413},
+};
+
+static int connectServer() {
+  struct sockaddr_in serverAddr;
+  memset(&serverAddr, 0, sizeof(serverAddr));
+  serverAddr.sin_family = AF_INET;
+  serverAddr.sin_port = htons((uint16_t)port);
+  serverAddr.sin_addr.s_addr = inet_addr(serverIp);
+
+  int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0) return -1;
+
+  if (connect(fd, (struct sockaddr *)&serverAddr, sizeof(serverAddr)) < 0) {
+    close(fd);
+    return -1;
+  }
+
+  int nodelay = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+  struct timeval timeout = {.tv_sec = 5, .tv_usec = 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  return fd;
+}
+
+static bool sendPart(int fd, char *part) {
+  char buf[1024];
+  int  len = snprintf(buf, sizeof(buf), part, auth);
+  int  sent = 0;
+  while (sent < len) {
+    int nwrite = (int)send(fd, buf + sent, len - sent, MSG_NOSIGNAL);
+    if (nwrite <= 0) {
+      if (nwrite < 0 && errno == EINTR) continue;
+      return false;
+    }
+    sent += nwrite;
+  }
+  return true;
+}
+
+// returns the status of the response, 0 if the connection is closed or timed out without a response
+static int readStatus(int fd) {
+  char rsp[RSP_BUFFER_SIZE] = {0};
+  int  len = 0;
+
+  while (len < RSP_BUFFER_SIZE - 1) {
+    int nread = (int)recv(fd, rsp + len, RSP_BUFFER_SIZE - 1 - len, 0);
+    if (nread <= 0) break;
+    len += nread;
+
+    char *pStatus = strstr(rsp, "HTTP/1.1 ");
+    if (pStatus != NULL && strstr(pStatus, "\r\n\r\n") != NULL) return atoi(pStatus + 9);
+  }
+
+  return 0;
+}
+
+static int runCase(SCase *pCase) {
+  int fd = connectServer();
+  if (fd < 0) return -1;
+
+  for (int i = 0; i < MAX_PARTS && pCase->parts[i] != NULL; ++i) {
+    if (i > 0) taosMsleep(200);
+    if (!sendPart(fd, pCase->parts[i])) break;
+  }
+
+  int status = readStatus(fd);
+  close(fd);
+  return status;
+}
+
+void parseArgument(int argc, char *argv[]) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+      printf("Used to check the http server with malformed or fragmented requests\n");
+      printf("        -i  IP address of the server, default is %s\n", serverIp);
+      printf("        -p  Port of the http server, default is %d\n", port);
+      printf("        -a  Basic auth token, default is %s\n", auth);
+      exit(EXIT_SUCCESS);
+    } else if (strcmp(argv[i], "-i") == 0 && i < argc - 1) {
+      tstrncpy(serverIp, argv[++i], sizeof(serverIp));
+    } else if (strcmp(argv[i], "-p") == 0 && i < argc - 1) {
+      port = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-a") == 0 && i < argc - 1) {
+      tstrncpy(auth, argv[++i], sizeof(auth));
+    } else {
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  parseArgument(argc, argv);
+  taos_init();
+
+  SCase *pValid = &cases[0];
+  int    numOfCases = (int)(sizeof(cases) / sizeof(cases[0]));
+  int    numOfFailed = 0;
+
+  for (int i = 0; i < numOfCases; ++i) {
+    int status = runCase(&cases[i]);
+    int alive = runCase(pValid);
+
+    if (status == cases[i].status && alive == pValid->status) {
+      pPrint("%scase:%s, status:%d, passed%s", GREEN, cases[i].name, status, NC);
+    } else {
+      pPrint("%scase:%s, status:%d expected:%d, server status:%d, failed%s", RED, cases[i].name, status,
+             cases[i].status, alive, NC);
+      numOfFailed++;
+    }
+  }
+
+  pPrint("%d cases, %d failed", numOfCases, numOfFailed);
+  return numOfFailed == 0 ? 0 : 1;
+}
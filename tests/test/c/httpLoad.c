@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * load test of the http server: each thread keeps one keep-alive connection, and pipelines a window of requests
+ * on it. The throughput and the latency of the requests are reported. The big chunked responses, e.g. the results
+ * of millions of rows, are received without being kept.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "taos.h"
+#include "tulog.h"
+#include "tutil.h"
+#include "tglobal.h"
+
+#define GREEN "\033[1;32m"
+#define NC "\033[0m"
+#define RSP_BUFFER_SIZE (1024 * 1024)
+
+typedef struct {
+  int       threadIndex;
+  int       fd;
+  int       numOfErrors;
+  int64_t  *latency;  // microseconds of each request
+  int64_t  *sendTime;
+  char     *rspBuf;
+  int       rspLen;
+  int       chunkPos;  // position of the next chunk to parse, 0 if the head is not parsed
+  int64_t   rspBytes;
+  pthread_t thread;
+} SInfo;
+
+char    serverIp[40] = "127.0.0.1";
+int     port = 6020;
+int     numOfThreads = 4;
+int     numOfReqs = 10000;
+int     window = 1;
+char    url[256] = "/rest/sql";
+char    auth[128] = "cm9vdDp0YW9zZGF0YQ==";  // root:taosdata
+char   *body = "select server_status()";
+char   *request = NULL;
+int     reqLen = 0;
+
+static int64_t getTimeInUs() {
+  struct timeval systemTime;
+  gettimeofday(&systemTime, NULL);
+  return (int64_t)systemTime.tv_sec * 1000000 + systemTime.tv_usec;
+}
+
+static int compareLatency(const void *p1, const void *p2) {
+  int64_t v1 = *(int64_t *)p1;
+  int64_t v2 = *(int64_t *)p2;
+  return (v1 == v2) ? 0 : ((v1 < v2) ? -1 : 1);
+}
+
+static int connectServer() {
+  struct sockaddr_in serverAddr;
+  memset(&serverAddr, 0, sizeof(serverAddr));
+  serverAddr.sin_family = AF_INET;
+  serverAddr.sin_port = htons((uint16_t)port);
+  serverAddr.sin_addr.s_addr = inet_addr(serverIp);
+
+  int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (fd < 0) return -1;
+
+  if (connect(fd, (struct sockaddr *)&serverAddr, sizeof(serverAddr)) < 0) {
+    close(fd);
+    return -1;
+  }
+
+  int nodelay = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+  return fd;
+}
+
+/*
+ * return the length of the first response in the buffer, 0 if it is not complete. The chunks after the first one are
+ * dropped once they are received, so the chunked responses of any size can be received into the buffer.
+ */
+static int getResponseLen(SInfo *pInfo) {
+  char *rsp = pInfo->rspBuf;
+  char *pBody = strstr(rsp, "\r\n\r\n");
+  if (pBody == NULL) return 0;
+  pBody += 4;
+
+  char *pLen = strstr(rsp, "Content-Length:");
+  if (pLen != NULL && pLen < pBody) {
+    int total = (int)(pBody - rsp) + atoi(pLen + 15);
+    return (total <= pInfo->rspLen) ? total : 0;
+  }
+
+  if (pInfo->chunkPos == 0) pInfo->chunkPos = (int)(pBody - rsp);
+
+  while (1) {
+    char *pChunk = rsp + pInfo->chunkPos;
+    char *pData = strstr(pChunk, "\r\n");  // the size line is text
+    if (pData == NULL) return 0;
+
+    int size = (int)strtol(pChunk, NULL, 16);
+    int chunkLen = (int)(pData + 2 - pChunk) + size + 2;
+    if (pInfo->chunkPos + chunkLen > pInfo->rspLen) return 0;
+
+    if (size == 0) {
+      int total = pInfo->chunkPos + chunkLen;
+      pInfo->chunkPos = 0;
+      return total;
+    }
+
+    if (pChunk == pBody) {
+      pInfo->chunkPos += chunkLen;
+    } else {
+      pInfo->rspLen -= chunkLen;
+      memmove(pChunk, pChunk + chunkLen, (size_t)(pInfo->rspLen - pInfo->chunkPos));
+      rsp[pInfo->rspLen] = 0;
+    }
+  }
+}
+
+// the body is read from file, e.g. a batch of telegraf metrics
+static char *readBody(char *fileName) {
+  FILE *fp = fopen(fileName, "r");
+  if (fp == NULL) {
+    pError("failed to open %s, reason:%s", fileName, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  fseek(fp, 0, SEEK_END);
+  long size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+
+  char *content = calloc(1, (size_t)size + 1);
+  if (fread(content, 1, (size_t)size, fp) != (size_t)size) {
+    pError("failed to read %s", fileName);
+    exit(EXIT_FAILURE);
+  }
+
+  fclose(fp);
+  return content;
+}
+
+static bool sendRequest(SInfo *pInfo) {
+  int sent = 0;
+  while (sent < reqLen) {
+    int nwrite = (int)send(pInfo->fd, request + sent, reqLen - sent, MSG_NOSIGNAL);
+    if (nwrite <= 0) {
+      if (nwrite < 0 && errno == EINTR) continue;
+      return false;
+    }
+    sent += nwrite;
+  }
+  return true;
+}
+
+static bool readResponse(SInfo *pInfo) {
+  while (1) {
+    int rspLen = getResponseLen(pInfo);
+    if (rspLen > 0) {
+      if (strncmp(pInfo->rspBuf, "HTTP/1.1 200", 12) != 0 || strstr(pInfo->rspBuf, "\"status\":\"succ\"") == NULL) {
+        pInfo->numOfErrors++;
+        if (pInfo->numOfErrors == 1) {
+          pError("thread:%d, error response:%.*s", pInfo->threadIndex, rspLen, pInfo->rspBuf);
+        }
+      }
+
+      pInfo->rspLen -= rspLen;
+      memmove(pInfo->rspBuf, pInfo->rspBuf + rspLen, (size_t)pInfo->rspLen);
+      pInfo->rspBuf[pInfo->rspLen] = 0;
+      return true;
+    }
+
+    if (pInfo->rspLen >= RSP_BUFFER_SIZE - 1) {
+      pError("thread:%d, response is too big", pInfo->threadIndex);
+      return false;
+    }
+
+    int nread = (int)recv(pInfo->fd, pInfo->rspBuf + pInfo->rspLen, RSP_BUFFER_SIZE - 1 - pInfo->rspLen, 0);
+    if (nread <= 0) {
+      pError("thread:%d, connection is broken, reason:%s", pInfo->threadIndex, strerror(errno));
+      return false;
+    }
+
+    pInfo->rspLen += nread;
+    pInfo->rspBuf[pInfo->rspLen] = 0;
+    pInfo->rspBytes += nread;
+  }
+}
+
+void *sendRequests(void *param) {
+  SInfo *pInfo = (SInfo *)param;
+  int    sent = 0;
+  int    received = 0;
+
+  while (received < numOfReqs) {
+    while (sent < numOfReqs && sent - received < window) {
+      pInfo->sendTime[sent % window] = getTimeInUs();
+      if (!sendRequest(pInfo)) {
+        pError("thread:%d, failed to send request, reason:%s", pInfo->threadIndex, strerror(errno));
+        pInfo->numOfErrors += numOfReqs - received;
+        return NULL;
+      }
+      sent++;
+    }
+
+    if (!readResponse(pInfo)) {
+      pInfo->numOfErrors += numOfReqs - received;
+      return NULL;
+    }
+
+    pInfo->latency[received] = getTimeInUs() - pInfo->sendTime[received % window];
+    received++;
+  }
+
+  return NULL;
+}
+
+void printHelp() {
+  char indent[10] = "        ";
+  printf("Used to test the performance of the http server with keep-alive connections and pipelined requests\n");
+
+  printf("%s%s\n", indent, "-i");
+  printf("%s%s%s%s\n", indent, indent, "IP address of the server, default is ", serverIp);
+  printf("%s%s\n", indent, "-p");
+  printf("%s%s%s%d\n", indent, indent, "Port of the http server, default is ", port);
+  printf("%s%s\n", indent, "-t");
+  printf("%s%s%s%d\n", indent, indent, "Number of threads, each keeps one connection, default is ", numOfThreads);
+  printf("%s%s\n", indent, "-n");
+  printf("%s%s%s%d\n", indent, indent, "Number of requests per thread, default is ", numOfReqs);
+  printf("%s%s\n", indent, "-w");
+  printf("%s%s%s%d\n", indent, indent, "Number of pipelined requests in flight per connection, default is ", window);
+  printf("%s%s\n", indent, "-u");
+  printf("%s%s%s%s\n", indent, indent, "URL of the request, default is ", url);
+  printf("%s%s\n", indent, "-s");
+  printf("%s%s%s%s\n", indent, indent, "Body of the request, default is ", body);
+  printf("%s%s\n", indent, "-f");
+  printf("%s%s%s\n", indent, indent, "File of the request body, it overrides -s");
+  printf("%s%s\n", indent, "-c");
+  printf("%s%s%s%s\n", indent, indent, "Configuration directory, default is ", configDir);
+  printf("%s%s\n", indent, "-a");
+  printf("%s%s%s%s\n", indent, indent, "Basic auth token, default is ", auth);
+
+  exit(EXIT_SUCCESS);
+}
+
+void parseArgument(int argc, char *argv[]) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+      printHelp();
+    } else if (strcmp(argv[i], "-i") == 0 && i < argc - 1) {
+      tstrncpy(serverIp, argv[++i], sizeof(serverIp));
+    } else if (strcmp(argv[i], "-p") == 0 && i < argc - 1) {
+      port = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-t") == 0 && i < argc - 1) {
+      numOfThreads = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+      numOfReqs = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-w") == 0 && i < argc - 1) {
+      window = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-u") == 0 && i < argc - 1) {
+      tstrncpy(url, argv[++i], sizeof(url));
+    } else if (strcmp(argv[i], "-s") == 0 && i < argc - 1) {
+      body = argv[++i];
+    } else if (strcmp(argv[i], "-f") == 0 && i < argc - 1) {
+      body = readBody(argv[++i]);
+    } else if (strcmp(argv[i], "-c") == 0 && i < argc - 1) {
+      tstrncpy(configDir, argv[++i], TSDB_FILENAME_LEN);
+    } else if (strcmp(argv[i], "-a") == 0 && i < argc - 1) {
+      tstrncpy(auth, argv[++i], sizeof(auth));
+    } else {
+    }
+  }
+
+  if (numOfThreads <= 0 || numOfReqs <= 0 || window <= 0) {
+    pError("threads, requests and window shall be positive");
+    exit(EXIT_FAILURE);
+  }
+
+  pPrint("%sserver:%s:%d url:%s%s", GREEN, serverIp, port, url, NC);
+  pPrint("%sthreads:%d requests:%d window:%d%s", GREEN, numOfThreads, numOfReqs, window, NC);
+}
+
+int main(int argc, char *argv[]) {
+  parseArgument(argc, argv);
+  taos_init();
+
+  int bodyLen = (int)strlen(body);
+  request = malloc((size_t)bodyLen + 1024);
+  reqLen = snprintf(request, (size_t)bodyLen + 1024,
+                    "POST %s HTTP/1.1\r\nHost: %s\r\nAuthorization: Basic %s\r\nConnection: Keep-Alive\r\n"
+                    "Content-Length: %d\r\n\r\n%s",
+                    url, serverIp, auth, bodyLen, body);
+
+  SInfo *pInfo = (SInfo *)calloc(numOfThreads, sizeof(SInfo));
+  for (int i = 0; i < numOfThreads; ++i) {
+    pInfo[i].threadIndex = i;
+    pInfo[i].fd = connectServer();
+    if (pInfo[i].fd < 0) {
+      pError("thread:%d, failed to connect to %s:%d, reason:%s", i, serverIp, port, strerror(errno));
+      exit(EXIT_FAILURE);
+    }
+    pInfo[i].latency = (int64_t *)calloc(numOfReqs, sizeof(int64_t));
+    pInfo[i].sendTime = (int64_t *)calloc(window, sizeof(int64_t));
+    pInfo[i].rspBuf = (char *)calloc(1, RSP_BUFFER_SIZE);
+  }
+
+  int64_t st = getTimeInUs();
+  for (int i = 0; i < numOfThreads; ++i) {
+    pthread_create(&pInfo[i].thread, NULL, sendRequests, pInfo + i);
+  }
+
+  int     numOfErrors = 0;
+  int64_t rspBytes = 0;
+  for (int i = 0; i < numOfThreads; ++i) {
+    pthread_join(pInfo[i].thread, NULL);
+    numOfErrors += pInfo[i].numOfErrors;
+    rspBytes += pInfo[i].rspBytes;
+  }
+
+  double  seconds = (getTimeInUs() - st) / 1000.0 / 1000.0;
+  int64_t total = (int64_t)numOfReqs * numOfThreads;
+
+  int64_t *latency = (int64_t *)calloc((size_t)total, sizeof(int64_t));
+  for (int i = 0; i < numOfThreads; ++i) {
+    memcpy(latency + (int64_t)i * numOfReqs, pInfo[i].latency, sizeof(int64_t) * numOfReqs);
+    close(pInfo[i].fd);
+    free(pInfo[i].latency);
+    free(pInfo[i].sendTime);
+    free(pInfo[i].rspBuf);
+  }
+
+  qsort(latency, (size_t)total, sizeof(int64_t), compareLatency);
+  pPrint("%s%" PRId64 " requests in %.2f seconds, errors:%d, speed:%.1f requests per second%s", GREEN, total, seconds,
+         numOfErrors, total / seconds, NC);
+  pPrint("%slatency p50:%" PRId64 " us, p99:%" PRId64 " us, max:%" PRId64 " us%s", GREEN, latency[total / 2],
+         latency[total * 99 / 100], latency[total - 1], NC);
+  pPrint("%sresponse:%.2f MB, %.2f MB per second%s", GREEN, rspBytes / 1048576.0, rspBytes / 1048576.0 / seconds, NC);
+
+  free(latency);
+  free(pInfo);
+  return 0;
+}
@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * replay the recorded mqtt messages without broker: the messages are ingested by the same path as the mqtt module
+ * of taosd, or inserted by one sql statement per message for comparison. Each line of the file is a message, the
+ * topic followed by a space and the json payload, like
+ *   /taos/token/db/sensor/d1001 {"ts":1600000000000,"temperature":21.5,"location":"beijing"}
+ * The file is replayed several times, and the timestamps are shifted by the span of the file each time.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "taos.h"
+#include "tulog.h"
+#include "tutil.h"
+#include "tglobal.h"
+#include "cJSON.h"
+#include "mqttIngest.h"
+
+#define GREEN "\033[1;32m"
+#define NC "\033[0m"
+#define MAX_LINE_LEN (64 * 1024)
+
+typedef struct {
+  char *topic;
+  char *payload;
+  int   topicLen;
+  int   payloadLen;
+} SMsg;
+
+char  *fileName = NULL;
+char   path[64] = "taos";
+char   tsName[64] = "ts";
+int    numOfLoops = 1;
+int    sqlMode = 0;
+int    sqlThreads = 8;  // threads inserting by sql, each inserts a part of the messages
+SMsg  *msgs = NULL;
+int    numOfMsgs = 0;
+
+static int64_t getTimeInUs() {
+  struct timeval systemTime;
+  gettimeofday(&systemTime, NULL);
+  return (int64_t)systemTime.tv_sec * 1000000 + systemTime.tv_usec;
+}
+
+// the span of timestamps of the items named tsName, 0 if there is no such item
+static int64_t getTimestampSpan(cJSON **roots, int num) {
+  int64_t minTs = INT64_MAX;
+  int64_t maxTs = INT64_MIN;
+
+  for (int i = 0; i < num; ++i) {
+    cJSON *rows = roots[i];
+    int    numOfRows = cJSON_IsArray(rows) ? cJSON_GetArraySize(rows) : 1;
+    for (int r = 0; r < numOfRows; ++r) {
+      cJSON *ts = cJSON_GetObjectItem(cJSON_IsArray(rows) ? cJSON_GetArrayItem(rows, r) : rows, tsName);
+      if (ts != NULL && cJSON_IsNumber(ts)) {
+        minTs = MIN(minTs, ts->valueint);
+        maxTs = MAX(maxTs, ts->valueint);
+      }
+    }
+  }
+
+  return (minTs <= maxTs) ? maxTs - minTs + 1 : 0;
+}
+
+static void shiftTimestamps(cJSON *rows, int64_t offset) {
+  int numOfRows = cJSON_IsArray(rows) ? cJSON_GetArraySize(rows) : 1;
+  for (int r = 0; r < numOfRows; ++r) {
+    cJSON *ts = cJSON_GetObjectItem(cJSON_IsArray(rows) ? cJSON_GetArrayItem(rows, r) : rows, tsName);
+    if (ts != NULL && cJSON_IsNumber(ts)) {
+      cJSON_SetIntValue(ts, ts->valueint + offset);
+    }
+  }
+}
+
+// the messages of all loops are prepared before replay, so only the ingestion is measured
+static void readMessages() {
+  FILE *fp = fopen(fileName, "r");
+  if (fp == NULL) {
+    pError("failed to open %s, reason:%s", fileName, strerror(errno));
+    exit(EXIT_FAILURE);
+  }
+
+  int     capacity = 1024;
+  int     num = 0;
+  char  **topics = malloc(capacity * POINTER_BYTES);
+  cJSON **roots = malloc(capacity * POINTER_BYTES);
+  char   *line = malloc(MAX_LINE_LEN);
+
+  while (fgets(line, MAX_LINE_LEN, fp) != NULL) {
+    char *sep = strchr(line, ' ');
+    if (sep == NULL) continue;
+
+    *sep = 0;
+    cJSON *root = cJSON_Parse(sep + 1);
+    if (root == NULL) {
+      pError("invalid payload of topic %s", line);
+      continue;
+    }
+
+    if (num >= capacity) {
+      capacity *= 2;
+      topics = realloc(topics, capacity * POINTER_BYTES);
+      roots = realloc(roots, capacity * POINTER_BYTES);
+    }
+
+    topics[num] = strdup(line);
+    roots[num++] = root;
+  }
+
+  fclose(fp);
+  free(line);
+
+  int64_t span = getTimestampSpan(roots, num);
+  numOfMsgs = num * numOfLoops;
+  msgs = calloc(numOfMsgs, sizeof(SMsg));
+
+  for (int loop = 0; loop < numOfLoops; ++loop) {
+    for (int i = 0; i < num; ++i) {
+      SMsg *pMsg = &msgs[loop * num + i];
+      pMsg->topic = topics[i];
+      pMsg->topicLen = (int)strlen(topics[i]);
+      pMsg->payload = cJSON_PrintUnformatted(roots[i]);
+      pMsg->payloadLen = (int)strlen(pMsg->payload);
+      shiftTimestamps(roots[i], span);
+    }
+  }
+
+  for (int i = 0; i < num; ++i) {
+    cJSON_Delete(roots[i]);
+  }
+
+  free(topics);
+  free(roots);
+  pPrint("%s%d messages are read from %s, replayed %d times, timestamp span:%" PRId64 "%s", GREEN, num, fileName,
+         numOfLoops, span, NC);
+}
+
+typedef struct {
+  SMqttTopicTemplate *pTmpl;
+  TAOS               *taos;
+  int                 start;
+  int                 end;
+  int                 numOfErrors;
+  pthread_t           thread;
+} SSqlInfo;
+
+// one insert statement for each message, the way of the former mqtt module, only the existing tables are supported
+static void *insertBySql(void *param) {
+  SSqlInfo *pInfo = (SSqlInfo *)param;
+  int       size = MAX_LINE_LEN * 2;
+  char     *sql = malloc(size);
+
+  for (int i = pInfo->start; i < pInfo->end; ++i) {
+    SMqttTopic t;
+    cJSON     *root = cJSON_Parse(msgs[i].payload);
+    if (!mqttMatchTopic(pInfo->pTmpl, msgs[i].topic, msgs[i].topicLen, &t) || root == NULL || cJSON_IsArray(root)) {
+      pInfo->numOfErrors++;
+      cJSON_Delete(root);
+      continue;
+    }
+
+    int len = snprintf(sql, size, "insert into %s.%s (", t.db, t.table);
+    for (cJSON *item = root->child; item != NULL; item = item->next) {
+      len += snprintf(sql + len, size - len, "%s%s", item->string, (item->next != NULL) ? "," : ") values (");
+    }
+
+    for (cJSON *item = root->child; item != NULL; item = item->next) {
+      char *value = cJSON_PrintUnformatted(item);
+      len += snprintf(sql + len, size - len, "%s%s", value, (item->next != NULL) ? "," : ")");
+      free(value);
+    }
+
+    cJSON_Delete(root);
+
+    TAOS_RES *result = taos_query(pInfo->taos, sql);
+    if (taos_errno(result) != 0) {
+      pError("failed to insert, reason:%s", taos_errstr(result));
+      pInfo->numOfErrors++;
+    }
+    taos_free_result(result);
+  }
+
+  free(sql);
+  return NULL;
+}
+
+static int replayBySql(TAOS *taos, SMqttTopicTemplate *pTmpl) {
+  SSqlInfo *pInfo = calloc(sqlThreads, sizeof(SSqlInfo));
+  int       numOfErrors = 0;
+
+  for (int i = 0; i < sqlThreads; ++i) {
+    pInfo[i].pTmpl = pTmpl;
+    pInfo[i].taos = taos_connect(NULL, "root", "taosdata", NULL, 0);
+    pInfo[i].start = (int)((int64_t)numOfMsgs * i / sqlThreads);
+    pInfo[i].end = (int)((int64_t)numOfMsgs * (i + 1) / sqlThreads);
+    pthread_create(&pInfo[i].thread, NULL, insertBySql, pInfo + i);
+  }
+
+  for (int i = 0; i < sqlThreads; ++i) {
+    pthread_join(pInfo[i].thread, NULL);
+    numOfErrors += pInfo[i].numOfErrors;
+    taos_close(pInfo[i].taos);
+  }
+
+  free(pInfo);
+  return numOfErrors;
+}
+
+void printHelp() {
+  char indent[10] = "        ";
+  printf("Used to replay recorded mqtt messages\n");
+
+  printf("%s%s\n", indent, "-c");
+  printf("%s%s%s%s\n", indent, indent, "Configuration directory, default is ", configDir);
+  printf("%s%s\n", indent, "-f");
+  printf("%s%s%s\n", indent, indent, "The file of recorded messages, one message per line: topic payload");
+  printf("%s%s\n", indent, "-p");
+  printf("%s%s%s%s\n", indent, indent, "The path of topics, default is ", path);
+  printf("%s%s\n", indent, "-t");
+  printf("%s%s%s%s\n", indent, indent, "The template of topics, default is ", tsMqttTopicTemplate);
+  printf("%s%s\n", indent, "-k");
+  printf("%s%s%s%s\n", indent, indent, "The name of timestamp item shifted in each loop, default is ", tsName);
+  printf("%s%s\n", indent, "-n");
+  printf("%s%s%s%d\n", indent, indent, "Number of times to replay the file, default is ", numOfLoops);
+  printf("%s%s\n", indent, "-b");
+  printf("%s%s%s%d\n", indent, indent, "Rows accumulated for each vgroup before submit, default is ", tsMqttBatchRows);
+  printf("%s%s\n", indent, "-l");
+  printf("%s%s%s%d\n", indent, indent, "Milliseconds to linger before submit, default is ", tsMqttLingerMs);
+  printf("%s%s\n", indent, "-q");
+  printf("%s%s%s\n", indent, indent, "Insert by one sql statement per message instead, by 8 threads");
+
+  exit(EXIT_SUCCESS);
+}
+
+void parseArgument(int argc, char *argv[]) {
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+      printHelp();
+    } else if (strcmp(argv[i], "-c") == 0 && i < argc - 1) {
+      tstrncpy(configDir, argv[++i], TSDB_FILENAME_LEN);
+    } else if (strcmp(argv[i], "-f") == 0 && i < argc - 1) {
+      fileName = argv[++i];
+    } else if (strcmp(argv[i], "-p") == 0 && i < argc - 1) {
+      tstrncpy(path, argv[++i], sizeof(path));
+    } else if (strcmp(argv[i], "-t") == 0 && i < argc - 1) {
+      tstrncpy(tsMqttTopicTemplate, argv[++i], 128);
+    } else if (strcmp(argv[i], "-k") == 0 && i < argc - 1) {
+      tstrncpy(tsName, argv[++i], sizeof(tsName));
+    } else if (strcmp(argv[i], "-n") == 0 && i < argc - 1) {
+      numOfLoops = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-b") == 0 && i < argc - 1) {
+      tsMqttBatchRows = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-l") == 0 && i < argc - 1) {
+      tsMqttLingerMs = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-q") == 0) {
+      sqlMode = 1;
+    } else {
+    }
+  }
+
+  if (fileName == NULL || numOfLoops <= 0) {
+    pError("the file of messages shall be given, and the loops shall be positive");
+    exit(EXIT_FAILURE);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  parseArgument(argc, argv);
+  taos_init();
+
+  SMqttTopicTemplate tmpl;
+  if (mqttParseTopicTemplate(path, tsMqttTopicTemplate, &tmpl) != 0) {
+    pError("invalid template:%s", tsMqttTopicTemplate);
+    exit(EXIT_FAILURE);
+  }
+
+  readMessages();
+
+  TAOS *taos = taos_connect(NULL, "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    pError("failed to connect to database, reason:%s", tstrerror(terrno));
+    exit(EXIT_FAILURE);
+  }
+
+  SMqttIngestStatis statis = {0};
+  int64_t           st = getTimeInUs();
+
+  if (sqlMode) {
+    statis.numOfMsgs = numOfMsgs;
+    statis.numOfFailedMsgs = replayBySql(taos, &tmpl);
+  } else {
+    void *ingest = mqttOpenIngest(taos, &tmpl, tsMqttBatchRows, tsMqttLingerMs);
+    if (ingest == NULL) {
+      pError("failed to open ingest object");
+      exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < numOfMsgs; ++i) {
+      mqttIngestMessage(ingest, msgs[i].topic, msgs[i].topicLen, msgs[i].payload, msgs[i].payloadLen);
+    }
+
+    mqttFlushIngest(ingest);
+    mqttGetIngestStatis(ingest, &statis);
+    mqttCloseIngest(ingest);
+  }
+
+  double seconds = (getTimeInUs() - st) / 1000.0 / 1000.0;
+  pPrint("%s%" PRId64 " messages in %.2f seconds by %s, failed:%" PRId64 ", speed:%.1f messages per second%s", GREEN,
+         statis.numOfMsgs, seconds, sqlMode ? "sql" : "ingestion", statis.numOfFailedMsgs, statis.numOfMsgs / seconds,
+         NC);
+  if (!sqlMode) {
+    pPrint("%s%" PRId64 " rows acknowledged, failed submits:%" PRId64 ", speed:%.1f rows per second%s", GREEN,
+           statis.numOfRows, statis.numOfFailedSubmits, statis.numOfRows / seconds, NC);
+  }
+
+  taos_close(taos);
+  return 0;
+}